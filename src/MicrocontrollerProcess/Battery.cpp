@@ -0,0 +1,185 @@
+/************************************************************
+ * @file Battery.cpp
+ * @brief The implementation for the battery governor, which picks how much work the board does from the battery voltage
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Battery.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <atomic>
+#include "Arduino.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The work each mode allows, the critical mode still scans the buttons as often as while idle so a quick press is not missed */
+const BatteryBudget battery_budgets[BATTERY_MODE_COUNT] = {
+  {15, 1, 1, 1}, /* BATTERY_MODE_NORMAL */
+  {8,  2, 1, 2}, /* BATTERY_MODE_SAVER */
+  {3,  4, 2, 4}  /* BATTERY_MODE_CRITICAL */
+};
+
+/* The names printed for each mode, and for a board without the battery divider */
+const char *battery_mode_names[BATTERY_MODE_COUNT] = {"normal", "saver", "critical"};
+const char *battery_no_sensor_name = "none";
+
+/* The governor state, the input core reads the battery while the game core reads the mode */
+std::atomic<int> battery_mode(BATTERY_MODE_NORMAL); /* The current mode */
+long             battery_filtered;                  /* The filtered voltage in mV, scaled up by 2^BATTERY_FILTER_SHIFT */
+unsigned long    battery_mode_changes;              /* The number of times the mode changed since power on */
+bool             battery_sensed;                    /* Indicator for if there is a battery to read, false on a board without the divider */
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Starts the governor from a first reading, going straight to the mode it calls for
+ *
+ * @param voltage: The battery voltage in mV, 0 if the battery is not read
+ * @note A reading below BATTERY_NO_SENSOR is a board without the divider, which stays in the normal mode for good
+ */
+void Battery_Reset(int voltage) {
+  battery_filtered = (long)voltage << BATTERY_FILTER_SHIFT;
+  battery_mode_changes = 0;
+  battery_sensed = (voltage >= BATTERY_NO_SENSOR);
+  if (!battery_sensed) {
+    battery_mode = BATTERY_MODE_NORMAL;
+  }
+  else if (voltage < BATTERY_CRITICAL_ENTER) {
+    battery_mode = BATTERY_MODE_CRITICAL;
+  }
+  else if (voltage < BATTERY_SAVER_ENTER) {
+    battery_mode = BATTERY_MODE_SAVER;
+  }
+  else {
+    battery_mode = BATTERY_MODE_NORMAL;
+  }
+}
+
+/**
+ * Filters a new reading and moves between the modes, only moving back up once the voltage is clear of the threshold
+ * it went down at, so the lighter load of a lower mode letting the cells recover does not flip it straight back
+ *
+ * @param voltage: The battery voltage in mV
+ * @return bool: If the mode changed
+ */
+bool Battery_Update(int voltage) {
+  if (!battery_sensed) {
+    return false;
+  }
+  battery_filtered += voltage - (battery_filtered >> BATTERY_FILTER_SHIFT);
+  int filtered = Battery_GetVoltage();
+
+  int mode = battery_mode;
+  switch (mode) {
+    case BATTERY_MODE_NORMAL:
+      if (filtered < BATTERY_SAVER_ENTER) {
+        mode = BATTERY_MODE_SAVER;
+      }
+      break;
+    case BATTERY_MODE_SAVER:
+      if (filtered < BATTERY_CRITICAL_ENTER) {
+        mode = BATTERY_MODE_CRITICAL;
+      }
+      else if (filtered > BATTERY_SAVER_EXIT) {
+        mode = BATTERY_MODE_NORMAL;
+      }
+      break;
+    case BATTERY_MODE_CRITICAL:
+    default:
+      if (filtered > BATTERY_CRITICAL_EXIT) {
+        mode = BATTERY_MODE_SAVER;
+      }
+      break;
+  }
+
+  if (mode == battery_mode) {
+    return false;
+  }
+  battery_mode = mode;
+  battery_mode_changes++;
+  return true;
+}
+
+/**
+ * Retrieves if there is a battery to read, so its level is only sent to the app when there is one
+ *
+ * @return bool: If the first reading was a battery
+ */
+bool Battery_IsSensed() {
+  return battery_sensed;
+}
+
+/**
+ * Retrieves the current mode
+ *
+ * @return BatteryMode: The mode
+ */
+BatteryMode Battery_GetMode() {
+  return (BatteryMode)battery_mode.load();
+}
+
+/**
+ * Retrieves the work a mode allows
+ *
+ * @param mode: The mode, normally the one last read with Battery_GetMode
+ * @return const BatteryBudget &: The budget of the mode
+ */
+const BatteryBudget &Battery_GetBudget(BatteryMode mode) {
+  return battery_budgets[mode];
+}
+
+/**
+ * Retrieves the filtered battery voltage
+ *
+ * @return int: The voltage in mV
+ */
+int Battery_GetVoltage() {
+  return (int)(battery_filtered >> BATTERY_FILTER_SHIFT);
+}
+
+/**
+ * Works out the charge left from the filtered voltage, treating the discharge curve as a straight line
+ *
+ * @return int: The charge from 0 to 100%
+ */
+int Battery_GetPercent() {
+  int voltage = Battery_GetVoltage();
+  if (voltage <= BATTERY_EMPTY_VOLTAGE) {
+    return 0;
+  }
+  if (voltage >= BATTERY_FULL_VOLTAGE) {
+    return 100;
+  }
+  return (int)((long)(voltage - BATTERY_EMPTY_VOLTAGE) * 100 / (BATTERY_FULL_VOLTAGE - BATTERY_EMPTY_VOLTAGE));
+}
+
+/**
+ * Retrieves the number of times the mode changed, which stays low unless the modes are flapping
+ *
+ * @return unsigned long: The number of mode changes since power on
+ */
+unsigned long Battery_GetModeChanges() {
+  return battery_mode_changes;
+}
+
+/**
+ * Prints the battery state as one CSV line: BATTERY,<normal|saver|critical|none>,<filtered mV>,<percent>,<mode changes>
+ *
+ * @param out: Where to print the line, normally Serial
+ */
+void Battery_Dump(Print &out) {
+  out.print("BATTERY,");
+  out.print(battery_sensed ? battery_mode_names[battery_mode] : battery_no_sensor_name);
+  out.print(',');
+  out.print(Battery_GetVoltage());
+  out.print(',');
+  out.print(Battery_GetPercent());
+  out.print(',');
+  out.println(battery_mode_changes);
+}
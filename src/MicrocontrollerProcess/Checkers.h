@@ -5,6 +5,28 @@
 #ifndef CHECKERS_H
 #define CHECKERS_H
 
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Move.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define CHECKERS_SNAPSHOT_SQUARES (32) /* The number of dark squares, the only ones a piece can stand on */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A game packed into 20 bytes, for keeping it somewhere small such as flash */
+struct CheckersSnapshot {
+  uint8_t squares[CHECKERS_SNAPSHOT_SQUARES / 2]; /* The state of each dark square in row order, two to a byte (low nibble first) */
+  uint8_t active_player;                          /* The active player's turn */
+  Square  jump;                                   /* The square the active player has to keep jumping from, or SQUARE_NONE */
+  uint8_t won;                                    /* Indicator for if there is a winner */
+  uint8_t reserved;                               /* Unused, keeps the size a multiple of 4 bytes */
+};
+
 /*********************************************
  ** Class Declarations and Function Prototypes
  *********************************************/
@@ -17,7 +39,9 @@ class Checkers {
     int  Checkers_GetP2Count();
     int  Checkers_GetActivePlayer();
     int  Checkers_GetWin();
-    int  Checkers_Turn(int from[2], int to[2]);
+    int  Checkers_Turn(Move move);
+    void Checkers_Save(CheckersSnapshot &snapshot);
+    bool Checkers_Load(const CheckersSnapshot &snapshot);
   private:
     /* Members */
     int  board[8][8];     /* The active game map */
@@ -0,0 +1,180 @@
+/************************************************************
+ * @file Hal.cpp
+ * @brief The implementation of the counting hardware abstraction layer backend
+ *
+ * @note The board backend is all inline in Hal.h, so this file is empty unless HAL_COUNTING is defined
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Hal.h"
+
+#if defined(HAL_COUNTING)
+
+/**********************************
+ ** Defines
+ **********************************/
+#define HAL_LED_CHIP_INIT_TRANSFERS (4) /* The display test, scan limit, decode mode and shutdown opcodes sent on start up */
+
+/**********************************
+ ** Global Variables
+ **********************************/
+HalCounters   hal_counters = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+int           hal_pin_modes[HAL_PIN_COUNT];
+int           hal_pin_levels[HAL_PIN_COUNT];
+int           hal_analog_readings[HAL_PIN_COUNT];
+unsigned long hal_time = 0;
+unsigned long hal_free_heap = 0;
+unsigned long hal_largest_free_block = 0;
+unsigned long hal_min_free_heap = 0;
+unsigned long hal_free_stack = 0;
+int           hal_wake_levels[HAL_PIN_COUNT];
+uint8_t       hal_flash[HAL_FLASH_SIZE];
+unsigned long hal_flash_size = HAL_FLASH_SIZE;
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Puts every pin back in its power on state, with nothing pressing the buttons, erases the flash and clears the counters and memory readings
+ *
+ */
+void Hal_Reset() {
+  for (int pin = 0; pin < HAL_PIN_COUNT; pin++) {
+    hal_pin_modes[pin] = -1;
+    hal_pin_levels[pin] = LOW;
+    hal_analog_readings[pin] = HAL_ANALOG_READ_MAX;
+    hal_wake_levels[pin] = -1;
+  }
+
+  hal_time = 0;
+  hal_free_heap = 0;
+  hal_largest_free_block = 0;
+  hal_min_free_heap = 0;
+  hal_free_stack = 0;
+  memset(hal_flash, 0xFF, sizeof(hal_flash));
+  hal_flash_size = HAL_FLASH_SIZE;
+  Hal_ResetCounters();
+}
+
+/**
+ * Clears the counters so the next calls can be measured on their own
+ *
+ */
+void Hal_ResetCounters() {
+  memset(&hal_counters, 0, sizeof(hal_counters));
+}
+
+/**
+ * Sets up a MAX chip the same way LedControl does, counting the start up opcodes it sends
+ *
+ * @param data_pin: The data pin the chip is wired to
+ * @param clk_pin: The clock pin the chip is wired to
+ * @param cs_pin: The chip select pin the chip is wired to
+ * @param num_devices: The number of chips on the chain
+ */
+HalLedChip::HalLedChip(int data_pin, int clk_pin, int cs_pin, int num_devices) {
+  this->data_pin = data_pin;
+  this->num_devices = num_devices;
+  intensity = 0;
+
+  /* LedControl clears the display and sends the rest of the start up opcodes for each chip on the chain */
+  for (int i = 0; i < num_devices; i++) {
+    HalLedChip_Transfer(HAL_LED_CHIP_INIT_TRANSFERS);
+    clearDisplay(i);
+  }
+
+  shut_down = true;
+}
+
+/**
+ * Turns the chip on or puts it into shutdown
+ *
+ * @param addr: The address of the chip on the chain
+ * @param status: If the chip should be shut down
+ */
+void HalLedChip::shutdown(int addr, bool status) {
+  if (addr < 0 || addr >= num_devices) {
+    return;
+  }
+
+  shut_down = status;
+  HalLedChip_Transfer(1);
+}
+
+/**
+ * Sets the brightness of the chip
+ *
+ * @param addr: The address of the chip on the chain
+ * @param intensity: The brightness from 0 to 15
+ */
+void HalLedChip::setIntensity(int addr, int intensity) {
+  if (addr < 0 || addr >= num_devices || intensity < 0 || intensity > 15) {
+    return;
+  }
+
+  this->intensity = intensity;
+  HalLedChip_Transfer(1);
+}
+
+/**
+ * Turns off every LED on the chip, which LedControl does one row at a time
+ *
+ * @param addr: The address of the chip on the chain
+ */
+void HalLedChip::clearDisplay(int addr) {
+  if (addr < 0 || addr >= num_devices) {
+    return;
+  }
+
+  memset(leds, 0, sizeof(leds));
+  HalLedChip_Transfer(HAL_LED_CHIP_SIZE);
+}
+
+/**
+ * Sets a single LED, which LedControl sends as the whole row
+ *
+ * @param addr: The address of the chip on the chain
+ * @param row: The row of the LED
+ * @param col: The column of the LED
+ * @param state: If the LED should be on
+ */
+void HalLedChip::setLed(int addr, int row, int col, bool state) {
+  if (addr < 0 || addr >= num_devices || row < 0 || row >= HAL_LED_CHIP_SIZE || col < 0 || col >= HAL_LED_CHIP_SIZE) {
+    return;
+  }
+
+  leds[row][col] = state;
+  HalLedChip_Transfer(1);
+}
+
+/**
+ * Sets a whole row of LEDs in one opcode, with the first column in the highest bit as LedControl has it
+ *
+ * @param addr: The address of the chip on the chain
+ * @param row: The row of the LEDs
+ * @param value: The LEDs to light in the row
+ */
+void HalLedChip::setRow(int addr, int row, uint8_t value) {
+  if (addr < 0 || addr >= num_devices || row < 0 || row >= HAL_LED_CHIP_SIZE) {
+    return;
+  }
+
+  for (int col = 0; col < HAL_LED_CHIP_SIZE; col++) {
+    leds[row][col] = (value & (0x80 >> col)) != 0;
+  }
+  HalLedChip_Transfer(1);
+}
+
+/**
+ * Counts the opcodes sent to the chain, each of which shifts out an opcode and data byte for every chip on it
+ *
+ * @param count: The number of opcodes sent
+ */
+void HalLedChip::HalLedChip_Transfer(int count) {
+  hal_counters.spi_transfers += count;
+  hal_counters.spi_bytes += count * num_devices * HAL_LED_CHIP_OP_BYTES;
+}
+
+#endif /* HAL_COUNTING */
@@ -0,0 +1,16 @@
+/************************************************************
+ * @file HalConfig.h
+ * @brief The backend selection for the hardware abstraction layer
+ *
+ * @note The Arduino IDE has no per-sketch build flags, so each sketch picks its backend with its own copy
+ *       of this file. The firmware runs on the board, tests define HAL_COUNTING to count their I/O instead.
+ ************************************************************/
+#ifndef HALCONFIG_H
+#define HALCONFIG_H
+
+/**********************************
+ ** Defines
+ **********************************/
+/* #define HAL_COUNTING */ /* Swaps the board for the counting backend */
+
+#endif /* HALCONFIG_H */
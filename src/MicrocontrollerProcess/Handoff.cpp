@@ -0,0 +1,100 @@
+/************************************************************
+ * @file Handoff.cpp
+ * @brief The implementation for passing moves and game state between the input and game cores
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Handoff.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <atomic>
+#include "circular_queue/circular_queue.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* Lock-free single-producer/single-consumer queue of moves for the game core */
+circular_queue<HandoffMove> handoff_moves(HANDOFF_MOVE_QUEUE_SIZE);
+
+/* Double-buffered game snapshot, the game core writes the back buffer then swaps it to the front */
+Checkers                   handoff_snapshots[2];
+std::atomic<int>           handoff_front(0);    /* The index of the snapshot readers should use */
+std::atomic<unsigned long> handoff_sequence(0); /* The number of snapshots that have been started */
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Queues a move for the game core
+ *
+ * @param move: The move to queue
+ * @param trace: The latency trace ID of the move
+ * @return bool: If the move was queued (false if the queue is full)
+ */
+bool Handoff_PushMove(const Move &move, unsigned long trace) {
+  HandoffMove queued;
+  queued.move = move;
+  queued.trace = trace;
+  return handoff_moves.push(queued);
+}
+
+/**
+ * Takes the oldest queued move
+ *
+ * @param move: The move taken from the queue
+ * @param trace: The latency trace ID of the move
+ * @return bool: If there was a move in the queue
+ */
+bool Handoff_PopMove(Move &move, unsigned long &trace) {
+  if (handoff_moves.available() == 0) {
+    return false;
+  }
+
+  HandoffMove queued = handoff_moves.pop();
+  move = queued.move;
+  trace = queued.trace;
+  return true;
+}
+
+/**
+ * Publishes a copy of the game for the other core and the renderer
+ *
+ * @param checker_game: The game to copy
+ * @note Must only be called from one task
+ */
+void Handoff_PublishSnapshot(const Checkers &checker_game) {
+  int back = 1 - handoff_front.load(std::memory_order_relaxed);
+
+  /* Let readers know a snapshot is being written before touching the back buffer */
+  handoff_sequence.fetch_add(1, std::memory_order_acq_rel);
+
+  handoff_snapshots[back] = checker_game;
+
+  /* Swap the finished snapshot to the front */
+  handoff_front.store(back, std::memory_order_release);
+}
+
+/**
+ * Retrieves a copy of the most recently published game
+ *
+ * @return Checkers: The copy of the game
+ */
+Checkers Handoff_GetSnapshot() {
+  Checkers snapshot;
+  unsigned long sequence;
+
+  /* Copy the front buffer, trying again if a new snapshot was started while copying as it may have overwritten it */
+  do {
+    sequence = handoff_sequence.load(std::memory_order_acquire);
+    snapshot = handoff_snapshots[handoff_front.load(std::memory_order_acquire)];
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while (sequence != handoff_sequence.load(std::memory_order_relaxed));
+
+  return snapshot;
+}
@@ -0,0 +1,39 @@
+/************************************************************
+ * @file Handoff.h
+ * @brief The header for passing moves and game state between the input and game cores
+ ************************************************************/
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define HANDOFF_MOVE_QUEUE_SIZE (8) /* The number of moves that can wait for the game core */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A move waiting for the game core */
+struct HandoffMove {
+  Move          move;  /* The move */
+  unsigned long trace; /* The latency trace ID that follows the move to the LEDs */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Move queue functions (one producer on the input core, one consumer on the game core) */
+bool Handoff_PushMove(const Move &move, unsigned long trace);
+bool Handoff_PopMove(Move &move, unsigned long &trace);
+
+/* Game snapshot functions (written by the game core, read from either core) */
+void     Handoff_PublishSnapshot(const Checkers &checker_game);
+Checkers Handoff_GetSnapshot();
+
+#endif /* HANDOFF_H */
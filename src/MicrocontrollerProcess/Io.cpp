@@ -7,14 +7,15 @@
  ** Library Includes
  **********************************/
 #include "Checkers.h"
+#include "Hal.h"
 #include "Io.h"
+#include "Move.h"
 #include "VoiceRecognition.h"
 
 /**********************************
  ** Third Party Libraries Includes
  **********************************/
 #include "Arduino.h"
-#include "LedControl.h"
 
 /**********************************
  ** Defines
@@ -32,6 +33,16 @@
 #define LED_MAX_CHIP_BLUE_PIN          (26)
 #define LED_MAX_CHIP_CS_PIN            (27)
 #define LED_MAX_CHIP_CLK_PIN           (14)
+#define BATTERY_PIN                    (4)
+#define BUTTON_ARRAY_COUNT             (4) /* The number of button array pins, each covering two rows */
+
+/* Game map LED brightness, from 0 to 15 */
+#define LED_MAX_CHIP_INTENSITY     (15) /* The brightness while the game is being played */
+#define LED_MAX_CHIP_DIM_INTENSITY (2)  /* The brightness while nobody is playing, which still shows the game */
+
+/* Battery reading, the pin sits halfway down a divider across the batteries (ADC2 is free as the WiFi radio is never used) */
+#define BATTERY_DIVIDER_RATIO   (2)    /* The battery voltage over the voltage at the pin */
+#define BATTERY_ADC_FULL_SCALE  (3300) /* The voltage at the pin that reads ANALOG_READ_MAX (mV) */
 
 /* Button array thresholds */
 #define BUTTON_THRESHOLD1 (40)
@@ -44,6 +55,11 @@
 #define BUTTON_THRESHOLD8 (3300)
 #define ANALOG_READ_MAX   (4095)
 
+/* Turn indicator timings (ms) */
+#define TURN_INDICATOR_BLINK_TIME   (200)  /* The length of each on/off phase of an invalid move blink */
+#define TURN_INDICATOR_BLINK_PHASES (3)    /* The blink goes off, on, then off before returning to normal */
+#define WINNER_INDICATOR_TIME       (1000) /* The length of each on/off phase of the winner indicator */
+
 /* Colors */
 #define EMPTY_COLOR        (0)
 #define PLAYER1_COLOR      (1)
@@ -55,14 +71,26 @@
  ** Global Variables
  **********************************/
 /* LED Control variables */
-LedControl red_lc = LedControl(LED_MAX_CHIP_RED_PIN, LED_MAX_CHIP_CLK_PIN, LED_MAX_CHIP_CS_PIN, 1);
-LedControl blue_lc = LedControl(LED_MAX_CHIP_BLUE_PIN, LED_MAX_CHIP_CLK_PIN, LED_MAX_CHIP_CS_PIN, 1);
-LedControl green_lc = LedControl(LED_MAX_CHIP_GREEN_PIN, LED_MAX_CHIP_CLK_PIN, LED_MAX_CHIP_CS_PIN, 1);
+HalLedChip red_lc = HalLedChip(LED_MAX_CHIP_RED_PIN, LED_MAX_CHIP_CLK_PIN, LED_MAX_CHIP_CS_PIN, 1);
+HalLedChip blue_lc = HalLedChip(LED_MAX_CHIP_BLUE_PIN, LED_MAX_CHIP_CLK_PIN, LED_MAX_CHIP_CS_PIN, 1);
+HalLedChip green_lc = HalLedChip(LED_MAX_CHIP_GREEN_PIN, LED_MAX_CHIP_CLK_PIN, LED_MAX_CHIP_CS_PIN, 1);
+
+/* Game map brightness variables */
+int  game_map_limit = LED_MAX_CHIP_INTENSITY; /* The brightest the game map may be, lowered to save the battery */
+bool game_map_dimmed = false;                 /* Indicator for if the game map is dimmed while nobody is playing */
+
+/* Turn indicator variables */
+int           blink_player = 0;                    /* The player whose indicator is blinking (0 when not blinking) */
+unsigned long blink_start = 0;                     /* The millis() time the blink started */
+int           turn_indicator_levels[2] = {-1, -1}; /* The last levels written to the turn indicator pins */
 
 /**********************************
  ** Private Function Prototypes
  **********************************/
 void IO_MapToMaxChip(int row, int col, int &max_row, int &max_col);
+void IO_WriteTurnIndicator(int player1_level, int player2_level);
+void IO_WriteHWGameMapIntensity();
+Square IO_ReadButtonArray(int pin, int row);
 
 /**********************************
  ** Function Definitions
@@ -91,233 +119,142 @@ void IO_MapToMaxChip(int row, int col, int &max_row, int &max_col) {
 }
 
 /**
- * Converts a move command string to a form of a 2d integer array
+ * Writes the turn indicator LED pins, skipping pins that already hold the level
  *
- * @param move_string: The move command string being converted
- * @param move_int: The move command returned as a form of a 2d integer array
+ * @param player1_level: The level to set player 1's LED to
+ * @param player2_level: The level to set player 2's LED to
  */
-void IO_ConvertMapToIndices(String (&move_string)[2], int (&move_int)[2][2]) {
-  move_int[0][0] = move_string[0].charAt(0) - 65; /* A is 65 in the ASCII code, corresponds with row 0 */
-  move_int[0][1] = move_string[0].charAt(1) - 49; /* 1 is 49 in the ASCII code, corresponds with column 0 */
-  move_int[1][0] = move_string[1].charAt(0) - 65; /* A is 65 in the ASCII code, corresponds with row 0 */
-  move_int[1][1] = move_string[1].charAt(1) - 49; /* 1 is 49 in the ASCII code, corresponds with column 0 */
+void IO_WriteTurnIndicator(int player1_level, int player2_level) {
+  if (turn_indicator_levels[0] != player1_level) {
+    Hal_DigitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, player1_level);
+    turn_indicator_levels[0] = player1_level;
+  }
+
+  if (turn_indicator_levels[1] != player2_level) {
+    Hal_DigitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, player2_level);
+    turn_indicator_levels[1] = player2_level;
+  }
 }
 
 /**
- * Checks for a voice command and make sure it follows the right format
+ * Sets the brightness of all three LED chips from the battery limit and whether the game map is dimmed
  *
- * @param move_command: The move command being returned
  */
-void IO_GetVoiceRecognitionInput(String (&move_command)[2]) {
-  /* Get voice command from Voice Recognition module */
-  String voice_command;
-  VoiceRecognition_GetInput(voice_command);
-
-  /* Voice commands should be in the format of A1 B2. If not they should be cleared */
-  if ((voice_command.charAt(0) >= 'A' && voice_command.charAt(0) <= 'H') &&
-      (voice_command.charAt(1) >= '1' && voice_command.charAt(1) <= '8') &&
-      (voice_command.charAt(2) == ' ') &&
-      (voice_command.charAt(3) >= 'A' && voice_command.charAt(3) <= 'H') &&
-      (voice_command.charAt(4) >= '1' && voice_command.charAt(4) <= '8')) {
-    /* Array should be cleared */
-    move_command[0] = voice_command.substring(0, 2);
-    move_command[1] = voice_command.substring(3, 5);
+void IO_WriteHWGameMapIntensity() {
+  int intensity = game_map_dimmed ? LED_MAX_CHIP_DIM_INTENSITY : LED_MAX_CHIP_INTENSITY;
+  if (intensity > game_map_limit) {
+    intensity = game_map_limit;
+  }
+
+  red_lc.setIntensity(0, intensity);
+  blue_lc.setIntensity(0, intensity);
+  green_lc.setIntensity(0, intensity);
+}
+
+/**
+ * Reads a button array once and works out which of its buttons is pressed
+ *
+ * @param pin: The analog pin of the button array
+ * @param row: The even row the button array starts on, the odd row after it holds its last four buttons
+ * @return Square: The square of the pressed button, or SQUARE_NONE if the reading is not between two thresholds
+ */
+Square IO_ReadButtonArray(int pin, int row) {
+  const int thresholds[8] = {BUTTON_THRESHOLD1, BUTTON_THRESHOLD2, BUTTON_THRESHOLD3, BUTTON_THRESHOLD4,
+                             BUTTON_THRESHOLD5, BUTTON_THRESHOLD6, BUTTON_THRESHOLD7, BUTTON_THRESHOLD8};
+
+  /* The ADC is slow, so the reading is taken once and compared against every threshold */
+  int reading = Hal_AnalogRead(pin);
+  int button = -1;
+
+  if (reading < thresholds[0]) {
+    button = 0;
+  }
+  else {
+    for (int i = 1; i < 8; i++) {
+      if (reading > thresholds[i - 1] && reading < thresholds[i]) {
+        button = i;
+        break;
+      }
+    }
+  }
+
+  /* The first four buttons are on the even row and the last four are on the odd row */
+  if (button < 0) {
+    return SQUARE_NONE;
+  }
+  else if (button < 4) {
+    return Move_MakeSquare(row, button * 2);
   }
   else {
-    move_command[0] = "";
-    move_command[1] = "";
+    return Move_MakeSquare(row + 1, ((button - 4) * 2) + 1);
   }
 }
 
+/**
+ * Checks for a voice command, which the Voice Recognition module only returns in the right format
+ *
+ * @param move_command: The move command being returned
+ * @return bool: If there was a move command
+ */
+bool IO_GetVoiceRecognitionInput(Move &move_command) {
+  /* Get voice command from Voice Recognition module */
+  return VoiceRecognition_GetInput(move_command);
+}
+
 /**
  * Initializes the button pins
  *
  */
 void IO_InitButton() {
-  pinMode(BUTTON_ARRAY_PIN1, INPUT);
-  pinMode(BUTTON_ARRAY_PIN2, INPUT);
-  pinMode(BUTTON_ARRAY_PIN3, INPUT);
-  pinMode(BUTTON_ARRAY_PIN4, INPUT);
-  pinMode(BUTTON_POWER_PIN, OUTPUT);
+  Hal_PinMode(BUTTON_ARRAY_PIN1, INPUT);
+  Hal_PinMode(BUTTON_ARRAY_PIN2, INPUT);
+  Hal_PinMode(BUTTON_ARRAY_PIN3, INPUT);
+  Hal_PinMode(BUTTON_ARRAY_PIN4, INPUT);
+  Hal_PinMode(BUTTON_POWER_PIN, OUTPUT);
+
+  Hal_DigitalWrite(BUTTON_POWER_PIN, HIGH);
+}
 
-  digitalWrite(BUTTON_POWER_PIN, HIGH);
+/**
+ * Lets a button press wake the board from light sleep
+ *
+ * @note A press pulls its array's pin down by an amount set by its resistor, so only the buttons that pull it below
+ *       the digital low threshold wake the board straight away, the rest are caught by the next timed button scan
+ */
+void IO_InitButtonWakeUp() {
+  Hal_EnableWakePin(BUTTON_ARRAY_PIN1, LOW);
+  Hal_EnableWakePin(BUTTON_ARRAY_PIN2, LOW);
+  Hal_EnableWakePin(BUTTON_ARRAY_PIN3, LOW);
+  Hal_EnableWakePin(BUTTON_ARRAY_PIN4, LOW);
 }
 
 /**
  * Checks if any buttons have been pressed
  *
- * @return String: The string command to return
+ * @return Square: The square of the pressed button, or SQUARE_NONE if no single button is pressed
  */
-String IO_GetButtonInput() {
-  String move_queue = "";
-  bool button1_pressed = true;
-  bool button2_pressed = true;
-  bool button3_pressed = true;
-  bool button4_pressed = true;
-  
-  /* Button array 1 for rows 0 and 1 */
-  if (analogRead(BUTTON_ARRAY_PIN1) < BUTTON_THRESHOLD1) {
-    /* Button for [0, 0] */
-    move_queue = "A1";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN1) > BUTTON_THRESHOLD1 && analogRead(BUTTON_ARRAY_PIN1) < BUTTON_THRESHOLD2) {
-    /* Button for [0, 2] */
-    move_queue = "A3";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN1) > BUTTON_THRESHOLD2 && analogRead(BUTTON_ARRAY_PIN1) < BUTTON_THRESHOLD3) {
-    /* Button for [0, 4] */
-    move_queue = "A5";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN1) > BUTTON_THRESHOLD3 && analogRead(BUTTON_ARRAY_PIN1) < BUTTON_THRESHOLD4) {
-    /* Button for [0, 6] */
-    move_queue = "A7";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN1) > BUTTON_THRESHOLD4 && analogRead(BUTTON_ARRAY_PIN1) < BUTTON_THRESHOLD5) {
-    /* Button for [1, 1] */
-    move_queue = "B2";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN1) > BUTTON_THRESHOLD5 && analogRead(BUTTON_ARRAY_PIN1) < BUTTON_THRESHOLD6) {
-    /* Button for [1, 3] */
-    move_queue = "B4";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN1) > BUTTON_THRESHOLD6 && analogRead(BUTTON_ARRAY_PIN1) < BUTTON_THRESHOLD7) {
-    /* Button for [1, 5] */
-    move_queue = "B6";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN1) > BUTTON_THRESHOLD7 && analogRead(BUTTON_ARRAY_PIN1) < BUTTON_THRESHOLD8) {
-    /* Button for [1, 7] */
-    move_queue = "B8";
-  }
-  else {
-    /* Button in the first row of buttons were not pressed */
-    button1_pressed = false;
-  }
+Square IO_GetButtonInput() {
+  const int button_array_pins[BUTTON_ARRAY_COUNT] = {BUTTON_ARRAY_PIN1, BUTTON_ARRAY_PIN2, BUTTON_ARRAY_PIN3, BUTTON_ARRAY_PIN4};
+  Square button_square = SQUARE_NONE;
+  int pressed_count = 0;
 
-  /* Button array 2 for rows 2 and 3 */
-  if (analogRead(BUTTON_ARRAY_PIN2) < BUTTON_THRESHOLD1) {
-    /* Button for [2, 0] */
-    move_queue = "C1";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN2) > BUTTON_THRESHOLD1 && analogRead(BUTTON_ARRAY_PIN2) < BUTTON_THRESHOLD2) {
-    /* Button for [2, 2] */
-    move_queue = "C3";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN2) > BUTTON_THRESHOLD2 && analogRead(BUTTON_ARRAY_PIN2) < BUTTON_THRESHOLD3) {
-    /* Button for [2, 4] */
-    move_queue = "C5";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN2) > BUTTON_THRESHOLD3 && analogRead(BUTTON_ARRAY_PIN2) < BUTTON_THRESHOLD4) {
-    /* Button for [2, 6] */
-    move_queue = "C7";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN2) > BUTTON_THRESHOLD4 && analogRead(BUTTON_ARRAY_PIN2) < BUTTON_THRESHOLD5) {
-    /* Button for [3, 1] */
-    move_queue = "D2";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN2) > BUTTON_THRESHOLD5 && analogRead(BUTTON_ARRAY_PIN2) < BUTTON_THRESHOLD6) {
-    /* Button for [3, 3] */
-    move_queue = "D4";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN2) > BUTTON_THRESHOLD6 && analogRead(BUTTON_ARRAY_PIN2) < BUTTON_THRESHOLD7) {
-    /* Button for [3, 5] */
-    move_queue = "D6";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN2) > BUTTON_THRESHOLD7 && analogRead(BUTTON_ARRAY_PIN2) < BUTTON_THRESHOLD8) {
-    /* Button for [3, 7] */
-    move_queue = "D8";
-  }
-  else {
-    /* Button in the second row of buttons were not pressed */
-    button2_pressed = false;
-  }
+  /* Each button array covers two rows, array 1 for rows 0 and 1 through to array 4 for rows 6 and 7 */
+  for (int i = 0; i < BUTTON_ARRAY_COUNT; i++) {
+    Square square = IO_ReadButtonArray(button_array_pins[i], i * 2);
 
-  /* Button array 3 for rows 4 and 5 */
-  if (analogRead(BUTTON_ARRAY_PIN3) < BUTTON_THRESHOLD1) {
-    /* Button for [4, 0] */
-    move_queue = "E1";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN3) > BUTTON_THRESHOLD1 && analogRead(BUTTON_ARRAY_PIN3) < BUTTON_THRESHOLD2) {
-    /* Button for [4, 2] */
-    move_queue = "E3";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN3) > BUTTON_THRESHOLD2 && analogRead(BUTTON_ARRAY_PIN3) < BUTTON_THRESHOLD3) {
-    /* Button for [4, 4] */
-    move_queue = "E5";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN3) > BUTTON_THRESHOLD3 && analogRead(BUTTON_ARRAY_PIN3) < BUTTON_THRESHOLD4) {
-    /* Button for [4, 6] */
-    move_queue = "E7";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN3) > BUTTON_THRESHOLD4 && analogRead(BUTTON_ARRAY_PIN3) < BUTTON_THRESHOLD5) {
-    /* Button for [5, 1] */
-    move_queue = "F2";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN3) > BUTTON_THRESHOLD5 && analogRead(BUTTON_ARRAY_PIN3) < BUTTON_THRESHOLD6) {
-    /* Button for [5, 3] */
-    move_queue = "F4";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN3) > BUTTON_THRESHOLD6 && analogRead(BUTTON_ARRAY_PIN3) < BUTTON_THRESHOLD7) {
-    /* Button for [5, 5] */
-    move_queue = "F6";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN3) > BUTTON_THRESHOLD7 && analogRead(BUTTON_ARRAY_PIN3) < BUTTON_THRESHOLD8) {
-    /* Button for [5, 7] */
-    move_queue = "F8";
-  }
-  else {
-    /* Button in the third row of buttons were not pressed */
-    button3_pressed = false;
-  }
-  
-  /* Button array 4 for rows 6 and 7 */
-  if (analogRead(BUTTON_ARRAY_PIN4) < BUTTON_THRESHOLD1) {
-    /* Button for [6, 0] */
-    move_queue = "G1";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN4) > BUTTON_THRESHOLD1 && analogRead(BUTTON_ARRAY_PIN4) < BUTTON_THRESHOLD2) {
-    /* Button for [6, 2] */
-    move_queue = "G3";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN4) > BUTTON_THRESHOLD2 && analogRead(BUTTON_ARRAY_PIN4) < BUTTON_THRESHOLD3) {
-    /* Button for [6, 4] */
-    move_queue = "G5";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN4) > BUTTON_THRESHOLD3 && analogRead(BUTTON_ARRAY_PIN4) < BUTTON_THRESHOLD4) {
-    /* Button for [6, 6] */
-    move_queue = "G7";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN4) > BUTTON_THRESHOLD4 && analogRead(BUTTON_ARRAY_PIN4) < BUTTON_THRESHOLD5) {
-    /* Button for [7, 1] */
-    move_queue = "H2";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN4) > BUTTON_THRESHOLD5 && analogRead(BUTTON_ARRAY_PIN4) < BUTTON_THRESHOLD6) {
-    /* Button for [7, 3] */
-    move_queue = "H4";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN4) > BUTTON_THRESHOLD6 && analogRead(BUTTON_ARRAY_PIN4) < BUTTON_THRESHOLD7) {
-    /* Button for [7, 5] */
-    move_queue = "H6";
-  }
-  else if (analogRead(BUTTON_ARRAY_PIN4) > BUTTON_THRESHOLD7 && analogRead(BUTTON_ARRAY_PIN4) < BUTTON_THRESHOLD8) {
-    /* Button for [7, 7] */
-    move_queue = "H8";
-  }
-  else {
-    /* Button in the fourth row of buttons were not pressed */
-    button4_pressed = false;
+    if (square != SQUARE_NONE) {
+      button_square = square;
+      pressed_count++;
+    }
   }
 
   /* Verify only one output pin is getting one accepted analog reading at a time */
-  if ((button1_pressed == true && button2_pressed == true) || (button1_pressed == true && button3_pressed == true) ||
-      (button1_pressed == true && button4_pressed == true) || (button2_pressed == true && button3_pressed == true) ||
-      (button2_pressed == true && button4_pressed == true) || (button3_pressed == true && button4_pressed == true)) {
-    move_queue = "";
+  if (pressed_count > 1) {
+    button_square = SQUARE_NONE;
   }
 
-  /* Delay to account for button press and debounce */
-  delay(25);
-  
-  return move_queue;
+  /* Debouncing is handled by the caller scanning at a fixed period, so there is no delay here */
+  return button_square;
 }
 
 /**
@@ -325,77 +262,74 @@ String IO_GetButtonInput() {
  *
  */
 void IO_InitTurnIndicator() {
-  pinMode(PLAYER1_TURN_INDICATOR_LED_PIN, OUTPUT);
-  pinMode(PLAYER2_TURN_INDICATOR_LED_PIN, OUTPUT);
+  Hal_PinMode(PLAYER1_TURN_INDICATOR_LED_PIN, OUTPUT);
+  Hal_PinMode(PLAYER2_TURN_INDICATOR_LED_PIN, OUTPUT);
 }
 
 /**
- * Will update the LED indicating the turn indicators throughout each process
+ * Will update the LED indicating the turn indicators throughout each process, showing any blink in progress
  *
  * @param player_turn: The turn of the current player
+ * @param now: The current millis() time
  */
-void IO_SetTurnIndicator(int player_turn) {
+void IO_SetTurnIndicator(int player_turn, unsigned long now) {
+  int level = HIGH;
+
+  /* Work out where the blink is from the time it started so nothing has to wait */
+  if (blink_player == player_turn) {
+    unsigned long phase = (now - blink_start) / TURN_INDICATOR_BLINK_TIME;
+
+    if (phase < TURN_INDICATOR_BLINK_PHASES) {
+      level = (phase % 2 == 0) ? LOW : HIGH;
+    }
+    else {
+      blink_player = 0;
+    }
+  }
+  else {
+    /* The turn changed during the blink */
+    blink_player = 0;
+  }
+
   /* Get player turn from game algorithm and update */
   if (player_turn == 1) {
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, HIGH); /* Set LED1 GPIO pin to high */
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, LOW);  /* Set LED2 GPIO pin to low */
+    IO_WriteTurnIndicator(level, LOW);
   }
   else if (player_turn == 2) {
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, LOW);  /* Set LED1 GPIO pin to low */
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, HIGH); /* Set LED2 GPIO pin to high */
+    IO_WriteTurnIndicator(LOW, level);
   }
 }
 
 /**
- * Will blink the turn indicator if an invalid move is asked for
+ * Will start blinking the turn indicator if an invalid move is asked for, without waiting for the blink to finish
  *
  * @param player_turn: The turn of the current player
+ * @param now: The current millis() time
  */
-void IO_BlinkTurnIndicator(int player_turn) {
-  /* Get player turn from game algorithm and update */
-  if (player_turn == 1) {
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, LOW);
-    delay(200);
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, HIGH);
-    delay(200);
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, LOW);
-    delay(200);
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, HIGH);
-  }
-  else if (player_turn == 2) {
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, LOW);
-    delay(200);
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, HIGH);
-    delay(200);
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, LOW);
-    delay(200);
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, HIGH);
-  }
+void IO_BlinkTurnIndicator(int player_turn, unsigned long now) {
+  blink_player = player_turn;
+  blink_start = now;
+
+  /* Turn the LED off right away, IO_SetTurnIndicator continues the blink */
+  IO_SetTurnIndicator(player_turn, now);
 }
 
 /**
- * Will alternate the turn indicator LED for the winner
+ * Will alternate the turn indicator LED for the winner, based on the time rather than waiting
  *
  * @param winner: The player who won the game
+ * @param now: The current millis() time
  */
-void IO_WinnerTurnIndicator(int winner) {
+void IO_WinnerTurnIndicator(int winner, unsigned long now) {
+  int level = ((now / WINNER_INDICATOR_TIME) % 2 == 0) ? HIGH : LOW;
+
   if (winner == 1) {
-    /* Set LED2 GPIO pin to low */
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, LOW);
-    /* Alternate LED1 GPIO pin to indicate player 1 is winner */
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, HIGH);
-    delay(1000);
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, LOW);
-    delay(1000);
+    /* Alternate LED1 GPIO pin to indicate player 1 is winner, LED2 GPIO pin stays low */
+    IO_WriteTurnIndicator(level, LOW);
   }
   else {
-    /* Set LED1 GPIO pin to low */
-    digitalWrite(PLAYER1_TURN_INDICATOR_LED_PIN, LOW);
-    /* Alternate LED2 GPIO pin to indicate player 2 is winner */
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, HIGH);
-    delay(1000);
-    digitalWrite(PLAYER2_TURN_INDICATOR_LED_PIN, LOW);
-    delay(1000);
+    /* Alternate LED2 GPIO pin to indicate player 2 is winner, LED1 GPIO pin stays low */
+    IO_WriteTurnIndicator(LOW, level);
   }
 }
 
@@ -406,18 +340,18 @@ void IO_WinnerTurnIndicator(int winner) {
 void IO_InitHWGameMap() {
   /* Initialize the red LED max chip (via LED control) */
   red_lc.shutdown(0, false);
-  red_lc.setIntensity(0, 15);
   red_lc.clearDisplay(0);
 
   /* Initialize the blue LED max chip (via LED control) */
   blue_lc.shutdown(0, false);
-  blue_lc.setIntensity(0, 15);
   blue_lc.clearDisplay(0);
 
   /* Initialize the green LED max chip (via LED control) */
   green_lc.shutdown(0, false);
-  green_lc.setIntensity(0, 15);
   green_lc.clearDisplay(0);
+
+  /* Set the brightness of all three chips, which the battery may have already limited */
+  IO_WriteHWGameMapIntensity();
 }
 
 /**
@@ -473,3 +407,32 @@ void IO_SetHWGameMap(Checkers checker_game) {
     }
   }
 }
+
+/**
+ * Dims the game map LEDs while nobody is playing, or brings them back to full brightness
+ *
+ * @param dimmed: Indicator for if the LEDs should be dimmed
+ */
+void IO_DimHWGameMap(bool dimmed) {
+  game_map_dimmed = dimmed;
+  IO_WriteHWGameMapIntensity();
+}
+
+/**
+ * Caps the game map brightness to save the battery, the game map is never brighter than the cap even when not dimmed
+ *
+ * @param intensity: The brightest the game map may be, from 0 to 15
+ */
+void IO_LimitHWGameMap(int intensity) {
+  game_map_limit = (intensity < LED_MAX_CHIP_INTENSITY) ? intensity : LED_MAX_CHIP_INTENSITY;
+  IO_WriteHWGameMapIntensity();
+}
+
+/**
+ * Reads the battery voltage through its divider
+ *
+ * @return int: The battery voltage in mV
+ */
+int IO_GetBatteryVoltage() {
+  return (int)((long)Hal_AnalogRead(BATTERY_PIN) * BATTERY_ADC_FULL_SCALE * BATTERY_DIVIDER_RATIO / ANALOG_READ_MAX);
+}
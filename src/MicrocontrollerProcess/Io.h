@@ -9,6 +9,7 @@
  ** Library Includes
  **********************************/
 #include "Checkers.h"
+#include "Move.h"
 
 /**********************************
  ** Third Party Libraries Includes
@@ -18,24 +19,27 @@
 /**********************************
  ** Function Prototypes
  **********************************/
-/* Helper function for converting board map to integer indices */
-void IO_ConvertMapToIndices(String (&move_string)[2], int (&move_int)[2][2]);
-
 /* Voice Recognition Input functions */
-void IO_GetVoiceRecognitionInput(String (&move_command)[2]);
+bool IO_GetVoiceRecognitionInput(Move &move_command);
 
 /* Button functions */
 void   IO_InitButton();
-String IO_GetButtonInput();
+void   IO_InitButtonWakeUp();
+Square IO_GetButtonInput();
 
 /* Turn Indicator LED functions */
 void IO_InitTurnIndicator();
-void IO_SetTurnIndicator(int player_turn);
-void IO_BlinkTurnIndicator(int player_turn);
-void IO_WinnerTurnIndicator(int winner);
+void IO_SetTurnIndicator(int player_turn, unsigned long now);
+void IO_BlinkTurnIndicator(int player_turn, unsigned long now);
+void IO_WinnerTurnIndicator(int winner, unsigned long now);
 
 /* Game Map LED functions */
 void IO_InitHWGameMap();
 void IO_SetHWGameMap(Checkers checker_game);
+void IO_DimHWGameMap(bool dimmed);
+void IO_LimitHWGameMap(int intensity);
+
+/* Battery functions */
+int IO_GetBatteryVoltage();
 
 #endif /* IO_H */
@@ -0,0 +1,341 @@
+/************************************************************
+ * @file Journal.cpp
+ * @brief The implementation for the journal of moves and game snapshots in flash, so a game survives the batteries being taken out
+ *
+ * @note The records are appended around the flash partition as a ring, so every sector is erased once per lap of the ring
+ *       and wears evenly. The first record of a sector is always a snapshot, so a resume only reads the newest sector:
+ *       the first record of each sector finds it, then the game is loaded from its last snapshot and the moves after
+ *       it are replayed through Checkers_Turn.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Journal.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define JOURNAL_NO_SECTOR (0xFFFFFFFFUL) /* The erased sector offset when no sector has been erased ahead of the journal */
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The CRC-32 (IEEE, reflected) of each nibble, a 16 entry table keeps it small and still a few times faster than a bit at a time */
+const uint32_t journal_crc_table[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/* The journal state */
+unsigned long journal_size;          /* The bytes of flash used, a whole number of sectors (0 if there is no partition) */
+unsigned long journal_head;          /* The offset the next record is written to */
+unsigned long journal_sequence;      /* The sequence number of the next record */
+unsigned long journal_moves;         /* The moves written since the last snapshot */
+unsigned long journal_erased;        /* The offset of the sector erased ahead of the head, or JOURNAL_NO_SECTOR */
+unsigned long journal_erases;        /* The sectors erased since power on */
+unsigned long journal_replayed;      /* The moves replayed by the last resume */
+unsigned long journal_restore_time;  /* How long the last resume took (us) */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+uint32_t Journal_Crc(const uint8_t *data, unsigned long length);
+bool     Journal_Read(unsigned long offset, JournalRecord &record, bool &erased);
+void     Journal_Append(JournalRecord &record);
+void     Journal_Snapshot(Checkers &game);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Works out the CRC-32 of some bytes
+ *
+ * @param data: The bytes
+ * @param length: The number of bytes
+ * @return uint32_t: The CRC-32
+ */
+uint32_t Journal_Crc(const uint8_t *data, unsigned long length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (unsigned long i = 0; i < length; i++) {
+    crc = journal_crc_table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+    crc = journal_crc_table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+/**
+ * Reads a record from flash and checks it
+ *
+ * @param offset: The offset of the record
+ * @param record: The record read
+ * @param erased: Set if the record has never been written
+ * @return bool: If the record was written in full, a record torn by a power loss or never written is not
+ */
+bool Journal_Read(unsigned long offset, JournalRecord &record, bool &erased) {
+  erased = false;
+  if (!Hal_FlashRead(offset, &record, sizeof(record))) {
+    return false;
+  }
+
+  const uint8_t *bytes = (const uint8_t *)&record;
+  erased = true;
+  for (unsigned long i = 0; i < sizeof(record) && erased; i++) {
+    erased = bytes[i] == 0xFF;
+  }
+  if (erased) {
+    return false;
+  }
+
+  return record.crc == Journal_Crc(bytes, sizeof(record) - sizeof(record.crc)) &&
+         (record.type == JOURNAL_RECORD_SNAPSHOT || record.type == JOURNAL_RECORD_MOVE);
+}
+
+/**
+ * Writes a record at the head of the journal, erasing the sector first if the head has just moved into it
+ *
+ * @param record: The record, its sequence number and CRC are filled in
+ */
+void Journal_Append(JournalRecord &record) {
+  if (journal_head % HAL_FLASH_SECTOR_SIZE == 0) {
+    if (journal_head != journal_erased) {
+      Hal_FlashErase(journal_head);
+      journal_erases++;
+    }
+    journal_erased = JOURNAL_NO_SECTOR;
+  }
+
+  record.sequence = journal_sequence;
+  memset(record.reserved, 0, sizeof(record.reserved));
+  record.crc = Journal_Crc((const uint8_t *)&record, sizeof(record) - sizeof(record.crc));
+
+  /* A failed write is the same as one torn by a power loss, the record is skipped by the next resume */
+  Hal_FlashWrite(journal_head, &record, sizeof(record));
+  journal_sequence++;
+  journal_head += JOURNAL_RECORD_SIZE;
+  if (journal_head >= journal_size) {
+    journal_head = 0;
+  }
+}
+
+/**
+ * Writes a snapshot of the game
+ *
+ * @param game: The game
+ */
+void Journal_Snapshot(Checkers &game) {
+  JournalRecord record;
+  record.type = JOURNAL_RECORD_SNAPSHOT;
+  game.Checkers_Save(record.payload.snapshot);
+  Journal_Append(record);
+  journal_moves = 0;
+}
+
+/**
+ * Finds the journal in flash and loads the last game it holds, setting up where the next record goes
+ *
+ * @param game: The game to load into, which may be left changed even if nothing is loaded
+ * @return bool: If a game still being played was loaded, there is no game to carry on if the last one was won or there is no journal
+ */
+bool Journal_Restore(Checkers &game) {
+  unsigned long start = Hal_Micros();
+  JournalRecord record;
+  bool erased;
+
+  journal_size = Hal_FlashSize() / HAL_FLASH_SECTOR_SIZE * HAL_FLASH_SECTOR_SIZE;
+  journal_head = 0;
+  journal_sequence = 0;
+  journal_moves = 0;
+  journal_erased = JOURNAL_NO_SECTOR;
+  journal_erases = 0;
+  journal_replayed = 0;
+  journal_restore_time = 0;
+
+  /* The ring needs a sector to write to while the one before it is still read back */
+  if (journal_size < 2 * HAL_FLASH_SECTOR_SIZE) {
+    journal_size = 0;
+    return false;
+  }
+
+  /* The sector with the newest first record holds the head, a sector that has not been written to since its erase is skipped */
+  unsigned long head_sector = JOURNAL_NO_SECTOR;
+  for (unsigned long sector = 0; sector < journal_size; sector += HAL_FLASH_SECTOR_SIZE) {
+    if (Journal_Read(sector, record, erased) && (head_sector == JOURNAL_NO_SECTOR || record.sequence > journal_sequence)) {
+      head_sector = sector;
+      journal_sequence = record.sequence;
+    }
+  }
+  if (head_sector == JOURNAL_NO_SECTOR) {
+    return false;
+  }
+
+  /* The head is after the last record written to, torn ones included, as a torn record can't be written over */
+  unsigned long last_snapshot = head_sector;
+  unsigned long last_record = head_sector;
+  unsigned long moves = 0;
+  unsigned long slot;
+  for (slot = 1; slot < JOURNAL_SECTOR_RECORDS; slot++) {
+    unsigned long offset = head_sector + slot * JOURNAL_RECORD_SIZE;
+    bool valid = Journal_Read(offset, record, erased);
+    if (erased) {
+      break;
+    }
+
+    /* Only the records following on from the last one are replayed */
+    if (valid && record.sequence == journal_sequence + 1) {
+      journal_sequence = record.sequence;
+      last_record = offset;
+      if (record.type == JOURNAL_RECORD_SNAPSHOT) {
+        last_snapshot = offset;
+        moves = 0;
+      }
+      else {
+        moves++;
+      }
+    }
+  }
+  journal_head = (head_sector + slot * JOURNAL_RECORD_SIZE) % journal_size;
+  journal_sequence++;
+  journal_moves = moves;
+
+  /* Loads the last snapshot and replays the moves after it, each was valid when it was written */
+  bool loaded = Journal_Read(last_snapshot, record, erased) && record.type == JOURNAL_RECORD_SNAPSHOT &&
+                game.Checkers_Load(record.payload.snapshot);
+  uint32_t sequence = record.sequence;
+  for (unsigned long offset = last_snapshot + JOURNAL_RECORD_SIZE; loaded && offset <= last_record; offset += JOURNAL_RECORD_SIZE) {
+    if (Journal_Read(offset, record, erased) && record.sequence == sequence + 1) {
+      sequence = record.sequence;
+      loaded = game.Checkers_Turn(record.payload.move) != 0;
+      journal_replayed++;
+    }
+  }
+
+  journal_restore_time = Hal_Micros() - start;
+  return loaded && game.Checkers_GetWin() == 0;
+}
+
+/**
+ * Starts a new game in the journal, so a resume after this loads it instead of the last one
+ *
+ * @param game: The new game
+ */
+void Journal_NewGame(Checkers &game) {
+  if (journal_size == 0) {
+    return;
+  }
+  Journal_Snapshot(game);
+}
+
+/**
+ * Writes a valid move to the journal, or a snapshot of the game it left if one is due or the move starts a new sector
+ *
+ * @param game: The game after the move
+ * @param move: The move
+ */
+void Journal_RecordMove(Checkers &game, Move move) {
+  if (journal_size == 0) {
+    return;
+  }
+
+  if (journal_moves + 1 >= JOURNAL_SNAPSHOT_PERIOD || journal_head % HAL_FLASH_SECTOR_SIZE == 0) {
+    Journal_Snapshot(game);
+    return;
+  }
+
+  JournalRecord record;
+  record.type = JOURNAL_RECORD_MOVE;
+  memset(&record.payload, 0, sizeof(record.payload));
+  record.payload.move = move;
+  Journal_Append(record);
+  journal_moves++;
+}
+
+/**
+ * Erases the sector the head moves into next ahead of time, so the move that fills the head's sector does not wait on it
+ *
+ * @note An erase stalls the flash for tens of ms, so this is only called while nobody is playing
+ */
+void Journal_Maintain() {
+  if (journal_size == 0 || journal_erased != JOURNAL_NO_SECTOR) {
+    return;
+  }
+
+  /* A head at the start of a sector has not written to it yet */
+  unsigned long next = journal_head;
+  if (next % HAL_FLASH_SECTOR_SIZE != 0) {
+    next = (next / HAL_FLASH_SECTOR_SIZE + 1) * HAL_FLASH_SECTOR_SIZE % journal_size;
+  }
+  Hal_FlashErase(next);
+  journal_erases++;
+  journal_erased = next;
+}
+
+/**
+ * Retrieves if there is a flash partition for the journal
+ *
+ * @return bool: If the journal is kept
+ */
+bool Journal_IsEnabled() {
+  return journal_size != 0;
+}
+
+/**
+ * Retrieves the sequence number of the next record, which is the number of records ever written
+ *
+ * @return unsigned long: The sequence number
+ */
+unsigned long Journal_GetSequence() {
+  return journal_sequence;
+}
+
+/**
+ * Retrieves the number of sectors erased since power on
+ *
+ * @return unsigned long: The number of erases
+ */
+unsigned long Journal_GetErases() {
+  return journal_erases;
+}
+
+/**
+ * Retrieves the number of moves replayed by the last resume
+ *
+ * @return unsigned long: The number of moves
+ */
+unsigned long Journal_GetReplayed() {
+  return journal_replayed;
+}
+
+/**
+ * Retrieves how long the last resume took
+ *
+ * @return unsigned long: The time (us)
+ */
+unsigned long Journal_GetRestoreTime() {
+  return journal_restore_time;
+}
+
+/**
+ * Prints the journal state as a JOURNAL,<enabled|disabled>,<records written>,<head offset>,<erases>,<moves replayed>,<resume us> line
+ *
+ * @param out: Where to print it, such as Serial
+ */
+void Journal_Dump(Print &out) {
+  out.print("JOURNAL,");
+  out.print(Journal_IsEnabled() ? "enabled" : "disabled");
+  out.print(',');
+  out.print(journal_sequence);
+  out.print(',');
+  out.print(journal_head);
+  out.print(',');
+  out.print(journal_erases);
+  out.print(',');
+  out.print(journal_replayed);
+  out.print(',');
+  out.println(journal_restore_time);
+}
@@ -0,0 +1,186 @@
+/************************************************************
+ * @file Latency.cpp
+ * @brief The implementation for tracing each move from its input to the LEDs showing the result
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Latency.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The names of the sources in a dump, in LatencySource order */
+const char *latency_source_names[] = {"button", "voice"};
+
+/* The ring buffer of traces, a trace lives in the slot of its ID modulo LATENCY_TRACE_COUNT */
+LatencyTrace  latency_traces[LATENCY_TRACE_COUNT];
+unsigned long latency_last_id; /* The ID of the newest trace */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+LatencyTrace *Latency_FindTrace(unsigned long id);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Finds a trace in the ring buffer
+ *
+ * @param id: The trace ID
+ * @return LatencyTrace *: The trace, or 0 if it was never started or has been overwritten
+ */
+LatencyTrace *Latency_FindTrace(unsigned long id) {
+  if (id == LATENCY_NO_TRACE) {
+    return 0;
+  }
+
+  LatencyTrace *trace = &latency_traces[id % LATENCY_TRACE_COUNT];
+  return (trace->id == id) ? trace : 0;
+}
+
+/**
+ * Clears every trace
+ *
+ */
+void Latency_Reset() {
+  for (int i = 0; i < LATENCY_TRACE_COUNT; i++) {
+    latency_traces[i].id = LATENCY_NO_TRACE;
+  }
+  latency_last_id = LATENCY_NO_TRACE;
+}
+
+/**
+ * Starts a trace for a move that is being handed to the game core, overwriting the oldest trace
+ *
+ * @param source: Where the move came from
+ * @param input_time: The micros() time the input was read
+ * @param now: The current micros() time
+ * @return unsigned long: The trace ID to pass along with the move
+ */
+unsigned long Latency_Start(LatencySource source, unsigned long input_time, unsigned long now) {
+  unsigned long id = latency_last_id + 1;
+  if (id == LATENCY_NO_TRACE) {
+    id++;
+  }
+
+  LatencyTrace &trace = latency_traces[id % LATENCY_TRACE_COUNT];
+  trace.id = LATENCY_NO_TRACE;
+  trace.source = source;
+  trace.stage = LATENCY_STAGE_QUEUED;
+  trace.valid = false;
+  trace.input_time = input_time;
+  trace.queued_time = now;
+  trace.turn_time = 0;
+  trace.done_time = 0;
+  trace.id = id;
+
+  latency_last_id = id;
+  return id;
+}
+
+/**
+ * Marks a traced move as run by the game algorithm
+ *
+ * @param id: The trace ID passed along with the move
+ * @param valid: If Checkers_Turn accepted the move
+ * @param now: The current micros() time
+ */
+void Latency_Turn(unsigned long id, bool valid, unsigned long now) {
+  LatencyTrace *trace = Latency_FindTrace(id);
+  if (trace == 0 || trace->stage != LATENCY_STAGE_QUEUED) {
+    return;
+  }
+
+  trace->valid = valid;
+  trace->turn_time = now;
+  trace->stage = LATENCY_STAGE_TURN;
+}
+
+/**
+ * Finishes a traced move whose result has just been shown, such as an invalid move blinking the turn indicator
+ *
+ * @param id: The trace ID passed along with the move
+ * @param now: The current micros() time
+ */
+void Latency_Done(unsigned long id, unsigned long now) {
+  LatencyTrace *trace = Latency_FindTrace(id);
+  if (trace == 0 || trace->stage != LATENCY_STAGE_TURN) {
+    return;
+  }
+
+  trace->done_time = now;
+  trace->stage = LATENCY_STAGE_DONE;
+}
+
+/**
+ * Finishes every traced move that was waiting for the game map LEDs, called once they have been shifted out
+ *
+ * @param now: The current micros() time
+ */
+void Latency_Render(unsigned long now) {
+  for (int i = 0; i < LATENCY_TRACE_COUNT; i++) {
+    if (latency_traces[i].id != LATENCY_NO_TRACE && latency_traces[i].stage == LATENCY_STAGE_TURN) {
+      latency_traces[i].done_time = now;
+      latency_traces[i].stage = LATENCY_STAGE_DONE;
+    }
+  }
+}
+
+/**
+ * Retrieves a copy of a trace
+ *
+ * @param id: The trace ID
+ * @param trace: The copy of the trace
+ * @return bool: If the trace is still in the ring buffer
+ */
+bool Latency_GetTrace(unsigned long id, LatencyTrace &trace) {
+  LatencyTrace *found = Latency_FindTrace(id);
+  if (found == 0) {
+    return false;
+  }
+
+  trace = *found;
+  return true;
+}
+
+/**
+ * Prints every finished trace, oldest first, as one CSV line each: LATENCY,<id>,<source>,<valid>,<queued us>,<turn us>,<done us>
+ *
+ * @param out: Where to print the lines, normally Serial
+ * @note Each time is measured from the input, so the last column is the whole input to LED latency
+ */
+void Latency_Dump(Print &out) {
+  for (unsigned long i = LATENCY_TRACE_COUNT; i > 0; i--) {
+    if (latency_last_id < i) {
+      continue;
+    }
+
+    LatencyTrace trace;
+    if (!Latency_GetTrace(latency_last_id - i + 1, trace) || trace.stage != LATENCY_STAGE_DONE) {
+      continue;
+    }
+
+    out.print("LATENCY,");
+    out.print(trace.id);
+    out.print(',');
+    out.print(latency_source_names[trace.source]);
+    out.print(',');
+    out.print(trace.valid ? 1 : 0);
+    out.print(',');
+    out.print(trace.queued_time - trace.input_time);
+    out.print(',');
+    out.print(trace.turn_time - trace.input_time);
+    out.print(',');
+    out.print(trace.done_time - trace.input_time);
+    out.println();
+  }
+}
+
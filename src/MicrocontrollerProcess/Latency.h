@@ -0,0 +1,62 @@
+/************************************************************
+ * @file Latency.h
+ * @brief The header for tracing each move from its input to the LEDs showing the result
+ ************************************************************/
+#ifndef LATENCY_H
+#define LATENCY_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define LATENCY_TRACE_COUNT (16)  /* The number of traces kept, the oldest is overwritten by a new one */
+#define LATENCY_NO_TRACE    (0)   /* The trace ID of a move that is not being traced */
+#define LATENCY_COMMAND     ('l') /* The byte sent over Serial to ask for the finished traces */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* Where a move came from */
+enum LatencySource {
+  LATENCY_SOURCE_BUTTON, /* The second button press of the move */
+  LATENCY_SOURCE_VOICE   /* A command from the voice recognition app */
+};
+
+/* How far a traced move has got */
+enum LatencyStage {
+  LATENCY_STAGE_QUEUED, /* Handed to the game core */
+  LATENCY_STAGE_TURN,   /* Checkers_Turn has run it, waiting for the LEDs */
+  LATENCY_STAGE_DONE    /* The result has been shifted out to the LEDs */
+};
+
+/* The timeline of one move, all times are micros() */
+struct LatencyTrace {
+  unsigned long id;          /* The trace ID, counting up from 1 (LATENCY_NO_TRACE when the slot is unused) */
+  LatencySource source;      /* Where the move came from */
+  LatencyStage  stage;       /* How far the move has got */
+  bool          valid;       /* If Checkers_Turn accepted the move */
+  unsigned long input_time;  /* When the input was read, the button scan or the BLE bytes arriving */
+  unsigned long queued_time; /* When the move was handed to the game core */
+  unsigned long turn_time;   /* When Checkers_Turn returned */
+  unsigned long done_time;   /* When the LEDs showing the result were shifted out */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Tracing functions (traces are started on the input core and finished on the game core) */
+void          Latency_Reset();
+unsigned long Latency_Start(LatencySource source, unsigned long input_time, unsigned long now);
+void          Latency_Turn(unsigned long id, bool valid, unsigned long now);
+void          Latency_Done(unsigned long id, unsigned long now);
+void          Latency_Render(unsigned long now);
+
+/* Reporting functions */
+bool Latency_GetTrace(unsigned long id, LatencyTrace &trace);
+void Latency_Dump(Print &out);
+
+#endif /* LATENCY_H */
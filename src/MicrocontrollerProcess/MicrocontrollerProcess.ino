@@ -7,8 +7,19 @@
 /**********************************
  ** Library Includes
  **********************************/
+#include "Battery.h"
 #include "Checkers.h"
+#include "Hal.h"
+#include "Handoff.h"
 #include "Io.h"
+#include "Journal.h"
+#include "Latency.h"
+#include "Memory.h"
+#include "Move.h"
+#include "Power.h"
+#include "Profiler.h"
+#include "Scheduler.h"
+#include "Trace.h"
 #include "VoiceRecognition.h"
 
 /**********************************
@@ -16,23 +27,436 @@
  **********************************/
 #include "Arduino.h"
 
+/**********************************
+ ** Defines
+ **********************************/
+/* Task periods (ms) */
+#define VOICE_TASK_PERIOD     (50)  /* How often the BLE module is polled for a voice command */
+#define BUTTON_TASK_PERIOD    (25)  /* How often the buttons are scanned, which also debounces them */
+#define GAME_TASK_PERIOD      (5)   /* How often queued moves are sent to the game algorithm */
+#define INDICATOR_TASK_PERIOD (10)  /* How often the turn indicator LEDs are updated */
+#define RENDER_TASK_PERIOD    (50)  /* How often the game map LEDs are updated */
+#define SERIAL_TASK_PERIOD    (100) /* How often Serial is checked for a command */
+#define BATTERY_TASK_PERIOD   (1000) /* How often the battery voltage is read */
+
+/* Task periods while idle (ms), slow enough for the board to light sleep between them */
+#define VOICE_IDLE_PERIOD     (250)  /* The longest a voice command waits to wake the board */
+#define BUTTON_IDLE_PERIOD    (50)   /* Shorter than a quick press, so the buttons that can't wake the board are still seen */
+#define GAME_IDLE_PERIOD      (100)  /* Moves only arrive once the board is awake again */
+#define INDICATOR_IDLE_PERIOD (100)  /* Fast enough for the winner indicator to flash evenly */
+#define RENDER_IDLE_PERIOD    (1000) /* The game map does not change while idle */
+#define SERIAL_IDLE_PERIOD    (250)  /* Bytes sent while the board is asleep are lost, so send a command again if it goes unanswered */
+
+/* Time the buttons are ignored after the turn switches (ms) */
+#define TURN_SWITCH_LOCKOUT (400)
+
+/* Input task settings, the game and render tasks stay in loop() on the Arduino core (core 1) */
+#define INPUT_TASK_CORE       (0)    /* The core the input tasks are pinned to */
+#define INPUT_TASK_STACK_SIZE (4096) /* The stack size of the input task in bytes */
+#define INPUT_TASK_PRIORITY   (1)    /* The FreeRTOS priority of the input task, the same as loop() */
+#define INPUT_TURN_TIMEOUT    (100)  /* The longest loop() waits for the input core to run its tasks while idle (ms) */
+
 /**********************************
  ** Global Variables
  **********************************/
-/* Variables for storing potential moves */
-String first_button_input; /* The string if there is only one button input */
-String move_command[2]; /* The move command broken down into a string array */
-String move_queue;
-int move_int[2][2]; /* 2D array for storing the move to send to the game algorithm */
+/* Input core variables for storing potential moves */
+Square first_button_input; /* The square if there is only one button input */
+Move move_command; /* The move command to send to the game algorithm */
+Square move_queue; /* The square of the most recent button input */
+Square last_button_input; /* The square read on the last button scan, so a held button only counts once */
+int active_player; /* The active player last seen by the input core */
+bool buttons_locked; /* Indicator for if button presses are being ignored after a turn switch */
+int battery_percent; /* The battery level last sent to the app */
+
+/* Game core variables */
 int valid_move;
-int active_player;
+BatteryMode game_battery_mode; /* The battery mode the game and LED tasks were last set up for */
 
-/* The Checkers game containing the board and player information */
+/* The Checkers game containing the board and player information, only touched by the game core */
 Checkers checkers_game;
 
+/* The schedulers running the input tasks (core 0) and the game and LED tasks (core 1) */
+Scheduler input_scheduler;
+Scheduler game_scheduler;
+
+/* The task IDs, so their periods can be changed while idle */
+int voice_task;
+int button_task;
+int game_task;
+int indicator_task;
+int render_task;
+int serial_task;
+
+#if defined(ESP32)
+/* The FreeRTOS tasks running each core's scheduler, which hand each other turns while idle */
+TaskHandle_t input_core_task; /* The input task on core 0 */
+TaskHandle_t game_core_task;  /* The Arduino loop() task on core 1 */
+#endif
+
 /**********************************
  ** Function Definitions
  **********************************/
+/**
+ * Re-enables the buttons once the turn switch lockout is over
+ *
+ * @param now: The current millis() time
+ */
+void Process_UnlockButtonsTask(unsigned long now) {
+  buttons_locked = false;
+}
+
+/**
+ * Locks the buttons for a moment if the game core has switched the turn, so the first player doesn't accidentally button press for the second player
+ *
+ * @param snapshot: The latest copy of the game published by the game core
+ * @param now: The current millis() time
+ */
+void Process_CheckTurnSwitch(Checkers &snapshot, unsigned long now) {
+  if (active_player != snapshot.Checkers_GetActivePlayer()) {
+    active_player = snapshot.Checkers_GetActivePlayer();
+    buttons_locked = true;
+    input_scheduler.Scheduler_AddOneShot(Process_UnlockButtonsTask, TURN_SWITCH_LOCKOUT, now);
+  }
+}
+
+/**
+ * Queues the move command for the game core, starting its latency trace
+ *
+ * @param source: Where the move came from
+ * @param input_time: The micros() time the input was read
+ */
+void Process_QueueMove(LatencySource source, unsigned long input_time) {
+  unsigned long trace = Latency_Start(source, input_time, micros());
+
+  /* If the game core is too far behind the move is dropped, the same as a missed button press */
+  Handoff_PushMove(move_command, trace);
+}
+
+/**
+ * Checks the voice recognition module for a move
+ *
+ * @param now: The current millis() time
+ */
+void Process_VoiceTask(unsigned long now) {
+  /* Voice commands wait while a button move is half entered */
+  if (first_button_input != SQUARE_NONE) {
+    return;
+  }
+
+  /* If there is a move command */
+  unsigned long heap = Memory_BeginStage();
+  unsigned long start = micros();
+  Trace_Enter(TRACE_IO_GET_VOICE_INPUT);
+  bool has_move = IO_GetVoiceRecognitionInput(move_command);
+  Trace_Exit(TRACE_IO_GET_VOICE_INPUT);
+  Profiler_Record(PROFILER_STAGE_VOICE, micros() - start);
+  Memory_EndStage(PROFILER_STAGE_VOICE, heap);
+
+  if (!has_move) {
+    return;
+  }
+
+  /* The module is still polled once there is a winner so the battery level keeps reaching the app, but its commands are ignored */
+  Power_Activity(now);
+  if (Handoff_GetSnapshot().Checkers_GetWin() == 0) {
+    Process_QueueMove(LATENCY_SOURCE_VOICE, VoiceRecognition_GetInputTime());
+  }
+}
+
+/**
+ * Scans the buttons for a move, which takes two different button presses
+ *
+ * @param now: The current millis() time
+ */
+void Process_ButtonTask(unsigned long now) {
+  Checkers snapshot = Handoff_GetSnapshot();
+  Process_CheckTurnSwitch(snapshot, now);
+
+  /* A button only counts when it is first pressed, so one still held down from the last move does not start another */
+  unsigned long heap = Memory_BeginStage();
+  unsigned long start = micros();
+  Trace_Enter(TRACE_IO_GET_BUTTON_INPUT);
+  move_queue = IO_GetButtonInput();
+  Trace_Exit(TRACE_IO_GET_BUTTON_INPUT);
+  Profiler_Record(PROFILER_STAGE_BUTTON, micros() - start);
+  Memory_EndStage(PROFILER_STAGE_BUTTON, heap);
+  if (move_queue != SQUARE_NONE) {
+    Power_Activity(now);
+  }
+  if (move_queue == last_button_input) {
+    move_queue = SQUARE_NONE;
+  }
+  else {
+    last_button_input = move_queue;
+  }
+
+  /* Button presses are ignored once there is a winner or right after a turn switch */
+  if (snapshot.Checkers_GetWin() != 0 || buttons_locked) {
+    move_queue = SQUARE_NONE;
+    return;
+  }
+
+  if (first_button_input == SQUARE_NONE && move_queue != SQUARE_NONE) {
+    /* Store first button input */
+    first_button_input = move_queue;
+  }
+  else if (first_button_input != SQUARE_NONE && move_queue != SQUARE_NONE) {
+    /* If read button is the same as the first move, ignore as debouncing may not be detected yet */
+    if (move_queue != first_button_input) {
+      /* Store the move */
+      move_command = Move_Make(first_button_input, move_queue);
+      first_button_input = SQUARE_NONE;
+      Process_QueueMove(LATENCY_SOURCE_BUTTON, start);
+    }
+  }
+  move_queue = SQUARE_NONE;
+}
+
+/**
+ * Sends any queued moves to the game algorithm and publishes the result for the input core
+ *
+ * @param now: The current millis() time
+ */
+void Process_GameTask(unsigned long now) {
+  Move move;
+  unsigned long trace;
+  bool game_changed = false;
+
+  while (Handoff_PopMove(move, trace)) {
+    /* Moves that were queued before the game was won are dropped */
+    if (checkers_game.Checkers_GetWin() != 0) {
+      continue;
+    }
+
+    /* Make a call to the game algorithm to pass in moves */
+    unsigned long heap = Memory_BeginStage();
+    unsigned long start = micros();
+    Trace_Enter(TRACE_CHECKERS_TURN);
+    valid_move = checkers_game.Checkers_Turn(move);
+    Trace_Exit(TRACE_CHECKERS_TURN);
+    Profiler_Record(PROFILER_STAGE_TURN, micros() - start);
+    Memory_EndStage(PROFILER_STAGE_TURN, heap);
+    Latency_Turn(trace, valid_move != 0, micros());
+
+    /* Blink the turn indicator LED if the move is invalid, which is all the feedback an invalid move gets */
+    if (valid_move == 0) {
+      Trace_Enter(TRACE_IO_BLINK_TURN_INDICATOR);
+      IO_BlinkTurnIndicator(checkers_game.Checkers_GetActivePlayer(), now);
+      Trace_Exit(TRACE_IO_BLINK_TURN_INDICATOR);
+      Latency_Done(trace, micros());
+    }
+    else {
+      /* Only valid moves are journaled, so a resume can replay every one of them */
+      Trace_Enter(TRACE_JOURNAL_RECORD_MOVE);
+      Journal_RecordMove(checkers_game, move);
+      Trace_Exit(TRACE_JOURNAL_RECORD_MOVE);
+      game_changed = true;
+    }
+  }
+
+  if (game_changed) {
+    Handoff_PublishSnapshot(checkers_game);
+  }
+}
+
+/**
+ * Updates the turn indicator LEDs, flashing the winner's LED once there is one
+ *
+ * @param now: The current millis() time
+ */
+void Process_IndicatorTask(unsigned long now) {
+  unsigned long heap = Memory_BeginStage();
+  unsigned long start = micros();
+  if (checkers_game.Checkers_GetWin() == 0) {
+    Trace_Enter(TRACE_IO_SET_TURN_INDICATOR);
+    IO_SetTurnIndicator(checkers_game.Checkers_GetActivePlayer(), now);
+    Trace_Exit(TRACE_IO_SET_TURN_INDICATOR);
+  }
+  else {
+    /* Flash the turn indicator LED based on the winner until restarted */
+    Trace_Enter(TRACE_IO_WINNER_TURN_INDICATOR);
+    IO_WinnerTurnIndicator(checkers_game.Checkers_GetActivePlayer(), now);
+    Trace_Exit(TRACE_IO_WINNER_TURN_INDICATOR);
+  }
+  Profiler_Record(PROFILER_STAGE_INDICATOR, micros() - start);
+  Memory_EndStage(PROFILER_STAGE_INDICATOR, heap);
+}
+
+/**
+ * Updates the game map LEDs
+ *
+ * @param now: The current millis() time
+ */
+void Process_RenderTask(unsigned long now) {
+  unsigned long heap = Memory_BeginStage();
+  unsigned long start = micros();
+  Trace_Enter(TRACE_IO_SET_HW_GAME_MAP);
+  IO_SetHWGameMap(checkers_game);
+  Trace_Exit(TRACE_IO_SET_HW_GAME_MAP);
+  unsigned long shifted_out = micros();
+  Profiler_Record(PROFILER_STAGE_RENDER, shifted_out - start);
+  Memory_EndStage(PROFILER_STAGE_RENDER, heap);
+
+  /* Every move run since the last render is now showing */
+  Latency_Render(shifted_out);
+}
+
+/**
+ * Answers a command sent over Serial, dumps the loop timing histograms every PROFILER_DUMP_PERIOD, samples the heap every MEMORY_TREND_PERIOD
+ * and dumps the trace after a loop overrun
+ *
+ * @param now: The current millis() time
+ */
+void Process_SerialTask(unsigned long now) {
+  int command = (Serial.available() > 0) ? Serial.read() : -1;
+
+  /* Someone at the Serial monitor keeps the board awake so their next commands are not lost */
+  if (command != -1) {
+    Power_Activity(now);
+  }
+
+  Profiler_Poll(Serial, command, now);
+  Memory_Poll(Serial, command, now);
+  if (command == LATENCY_COMMAND) {
+    Latency_Dump(Serial);
+  }
+  else if (command == POWER_COMMAND) {
+    Power_Dump(Serial);
+  }
+  else if (command == BATTERY_COMMAND) {
+    Battery_Dump(Serial);
+  }
+  else if (command == JOURNAL_COMMAND) {
+    Journal_Dump(Serial);
+  }
+
+  /* Either core may have frozen the trace, it is only printed from here so the two cores never print over each other */
+  if (Trace_IsFrozen()) {
+    Trace_Dump(Serial);
+    Trace_Thaw(micros());
+  }
+}
+
+/**
+ * Slows the input tasks down while idle or on a low battery, or brings them back to their normal periods
+ *
+ * @param idle: Indicator for if the board is idle
+ * @param mode: The battery mode
+ * @param now: The current millis() time
+ * @note Only called from the core running the input scheduler
+ */
+void Process_SetInputPeriods(bool idle, BatteryMode mode, unsigned long now) {
+  const BatteryBudget &budget = Battery_GetBudget(mode);
+  input_scheduler.Scheduler_SetPeriod(voice_task, idle ? VOICE_IDLE_PERIOD : VOICE_TASK_PERIOD * budget.voice_scale, now);
+  input_scheduler.Scheduler_SetPeriod(button_task, idle ? BUTTON_IDLE_PERIOD : BUTTON_TASK_PERIOD * budget.button_scale, now);
+}
+
+/**
+ * Slows the game and LED tasks down and dims the game map while idle or on a low battery, or brings them back to normal
+ *
+ * @param idle: Indicator for if the board is idle
+ * @param mode: The battery mode
+ * @param now: The current millis() time
+ * @note Only called from the core running the game scheduler
+ */
+void Process_SetGamePeriods(bool idle, BatteryMode mode, unsigned long now) {
+  const BatteryBudget &budget = Battery_GetBudget(mode);
+  game_scheduler.Scheduler_SetPeriod(game_task, idle ? GAME_IDLE_PERIOD : GAME_TASK_PERIOD, now);
+  game_scheduler.Scheduler_SetPeriod(indicator_task, idle ? INDICATOR_IDLE_PERIOD : INDICATOR_TASK_PERIOD, now);
+  game_scheduler.Scheduler_SetPeriod(render_task, idle ? RENDER_IDLE_PERIOD : RENDER_TASK_PERIOD * budget.render_scale, now);
+  game_scheduler.Scheduler_SetPeriod(serial_task, idle ? SERIAL_IDLE_PERIOD : SERIAL_TASK_PERIOD, now);
+  IO_LimitHWGameMap(budget.led_intensity);
+  IO_DimHWGameMap(idle);
+}
+
+/**
+ * Reads the battery, slowing the input tasks down if the governor changes mode, and passes its level on to the app
+ *
+ * @param now: The current millis() time
+ * @note The game core follows the mode change on its next loop
+ */
+void Process_BatteryTask(unsigned long now) {
+  if (Battery_Update(IO_GetBatteryVoltage())) {
+    Process_SetInputPeriods(Power_IsIdle(), Battery_GetMode(), now);
+  }
+
+  /* Only a change is sent, as each one is an AT command round trip on the BLE module */
+  int percent = Battery_GetPercent();
+  if (percent != battery_percent) {
+    battery_percent = percent;
+    VoiceRecognition_SetBatteryLevel(percent);
+  }
+}
+
+/**
+ * Light sleeps until the next task on either core is due, waking early if a button pulls its array's pin low
+ *
+ */
+void Process_Sleep() {
+  unsigned long now = millis();
+  unsigned long input_time = input_scheduler.Scheduler_GetTimeToNext(now);
+  unsigned long game_time = game_scheduler.Scheduler_GetTimeToNext(now);
+  unsigned long sleep_time = Power_GetSleepTime((input_time < game_time) ? input_time : game_time);
+  if (sleep_time == 0) {
+    return;
+  }
+
+  unsigned long before = micros();
+  bool pin_wake = Hal_LightSleep(sleep_time * 1000);
+  Power_RecordSleep(micros() - before, pin_wake);
+
+  /* Only a button press wakes the board early */
+  if (pin_wake) {
+    Power_Activity(millis());
+  }
+}
+
+#if defined(ESP32)
+/**
+ * Has the input core run its tasks once and waits for it to finish, so the chip never sleeps in the middle of them
+ *
+ * @return bool: If the input core finished in time, the chip must stay awake if it did not
+ */
+bool Process_RunInputCoreTurn() {
+  /* Clear a finish left over from a turn that timed out, so it is not taken for this one */
+  ulTaskNotifyTake(pdTRUE, 0);
+  xTaskNotifyGive(input_core_task);
+  return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(INPUT_TURN_TIMEOUT)) != 0;
+}
+
+/**
+ * The FreeRTOS task running the input tasks on their own core, so slow BLE reads never hold up the game or LEDs
+ *
+ * @param parameters: Unused
+ */
+void Process_InputCoreTask(void *parameters) {
+  bool idle = false;
+
+  for (;;) {
+    if (Power_IsIdle() != idle) {
+      idle = !idle;
+      Process_SetInputPeriods(idle, Battery_GetMode(), millis());
+    }
+
+    /* While idle loop() sleeps the whole chip between tasks, so this core only runs its tasks when handed a turn */
+    if (idle) {
+      if (ulTaskNotifyTake(pdTRUE, 1) != 0) {
+        input_scheduler.Scheduler_Run(millis());
+        xTaskNotifyGive(game_core_task);
+      }
+      continue;
+    }
+
+    unsigned long start = micros();
+    input_scheduler.Scheduler_Run(millis());
+    Trace_CheckDeadline(start, micros());
+
+    /* Yield for a tick so the idle task on this core can feed the watchdog */
+    vTaskDelay(1);
+  }
+}
+#endif
+
 /**
  * Initialize any variables if it hasn't been done already and initialize MCU, makes initial calls
  *
@@ -44,82 +468,96 @@ void setup() {
 
   /* Pin setup */
   IO_InitButton();
+  IO_InitButtonWakeUp();
   IO_InitTurnIndicator();
   IO_InitHWGameMap();
 
+  /* Carry on the game the power was lost in, unless it was won or a button is held down while powering on to start a new one */
+  Square held_button = IO_GetButtonInput();
+  if (held_button != SQUARE_NONE || !Journal_Restore(checkers_game)) {
+    checkers_game = Checkers();
+    Journal_NewGame(checkers_game);
+  }
+
   /* Global variable initializations */
-  first_button_input = "";
-  move_command[0] = "";
-  move_command[1] = "";
-  move_queue = "";
-  active_player = 1;
+  first_button_input = SQUARE_NONE;
+  move_command = Move_Make(SQUARE_NONE, SQUARE_NONE);
+  move_queue = SQUARE_NONE;
+  last_button_input = held_button; /* The button held to start a new game is not the first half of a move */
+  active_player = checkers_game.Checkers_GetActivePlayer();
+  buttons_locked = false;
+
+  /* Start the battery governor from a first reading, so a low battery is saved from the first move, a board without the divider stays in the normal mode */
+  Battery_Reset(BATTERY_SENSE_ENABLED ? IO_GetBatteryVoltage() : 0);
+  game_battery_mode = Battery_GetMode();
+  battery_percent = Battery_GetPercent();
+  if (Battery_IsSensed()) {
+    VoiceRecognition_SetBatteryLevel(battery_percent);
+  }
+
+  /* Give the input core the starting or resumed game before it runs */
+  Handoff_PublishSnapshot(checkers_game);
+
+  /* Task setup */
+  unsigned long now = millis();
+  voice_task = input_scheduler.Scheduler_AddPeriodic(Process_VoiceTask, VOICE_TASK_PERIOD, now);
+  button_task = input_scheduler.Scheduler_AddPeriodic(Process_ButtonTask, BUTTON_TASK_PERIOD, now);
+  game_task = game_scheduler.Scheduler_AddPeriodic(Process_GameTask, GAME_TASK_PERIOD, now);
+  indicator_task = game_scheduler.Scheduler_AddPeriodic(Process_IndicatorTask, INDICATOR_TASK_PERIOD, now);
+  render_task = game_scheduler.Scheduler_AddPeriodic(Process_RenderTask, RENDER_TASK_PERIOD, now);
+  serial_task = game_scheduler.Scheduler_AddPeriodic(Process_SerialTask, SERIAL_TASK_PERIOD, now);
+  if (Battery_IsSensed()) {
+    input_scheduler.Scheduler_AddPeriodic(Process_BatteryTask, BATTERY_TASK_PERIOD, now);
+  }
+  Process_SetInputPeriods(false, game_battery_mode, now);
+  Process_SetGamePeriods(false, game_battery_mode, now);
+  Power_Reset(now);
+
+#if defined(ESP32)
+  game_core_task = xTaskGetCurrentTaskHandle();
+  xTaskCreatePinnedToCore(Process_InputCoreTask, "InputTask", INPUT_TASK_STACK_SIZE, NULL, INPUT_TASK_PRIORITY, &input_core_task, INPUT_TASK_CORE);
+#endif
 }
 
 /**
- * Will loop through the processes and update modules accordingly
+ * Will run any game and LED tasks that are due, never waiting on the ones that aren't, and sleeps between them while idle
  *
  * @note Must be named "loop" so it will repeatedly run on the MCU
  */
 void loop() {
-  /* Check if there is a winner: when there is no winner, the game goes on */
-  if (checkers_game.Checkers_GetWin() == 0) {
-    /* Check the voice recognition module for a move */
-    if (first_button_input == ""){
-      IO_GetVoiceRecognitionInput(move_command);
-    }
-
-    /* If no voice command has been received */
-    if (move_command[0] == "" || move_command[1] == "") {
-      move_queue = IO_GetButtonInput();
-      if (first_button_input == "" && move_queue != "") {
-        /* Store first button input */
-        first_button_input = move_queue;
-        move_queue = "";
-      }
-      else if (first_button_input != "" && move_queue != "") {
-        /* If read button is the same as the first move, ignore as debouncing may not be detected yet */
-        if (move_queue != first_button_input) {
-          /* Store move in array */
-          move_command[0] = first_button_input;
-          move_command[1] = move_queue;
-          first_button_input = "";
-          move_queue = "";
-        }
-      }
-    }
-    /* Clear the first button move (first_button_input) if a voice command gets received */
-    else {
-      first_button_input = "";
-    }
-
-    /* If there is a move command */
-    if (move_command[0] != "" && move_command[1] != "") {
-      /* Convert the string to a 2D integer array to send to the game algorithm */
-      IO_ConvertMapToIndices(move_command, move_int);
+  unsigned long start = micros();
+  unsigned long now = millis();
 
-      /* Make a call to the game algorithm to pass in moves */
-      valid_move = checkers_game.Checkers_Turn(move_int[0], move_int[1]);
-
-      /* Blink the turn indicator LED if the move is invalid */
-      if (valid_move == 0) {
-        IO_BlinkTurnIndicator(checkers_game.Checkers_GetActivePlayer());
-      }
-    }
+  /* Go idle once nobody has played for a while, wake back up on the next input, and follow the battery governor's mode */
+  bool idle_changed = Power_Update(now);
+  BatteryMode battery_mode = Battery_GetMode();
+  if (idle_changed || battery_mode != game_battery_mode) {
+    game_battery_mode = battery_mode;
+    Process_SetGamePeriods(Power_IsIdle(), battery_mode, now);
+  }
+#if !defined(ESP32)
+  if (idle_changed) {
+    Process_SetInputPeriods(Power_IsIdle(), battery_mode, now);
+  }
+#endif
+  bool can_sleep = Power_IsIdle();
 
-    /* Put a delay if the turn gets switched so the first player doesn't accidentally button press for the second player */
-    if (active_player != checkers_game.Checkers_GetActivePlayer()) {
-      active_player = checkers_game.Checkers_GetActivePlayer();
-      delay(400);
-    }
+#if defined(ESP32)
+  if (can_sleep) {
+    can_sleep = Process_RunInputCoreTurn();
+  }
+#else
+  /* Single core boards run the input tasks here as well */
+  input_scheduler.Scheduler_Run(now);
+#endif
+  game_scheduler.Scheduler_Run(now);
 
-    /* Set the turn indicator LEDs */
-    IO_SetTurnIndicator(checkers_game.Checkers_GetActivePlayer());
+  /* Keep the trace leading up to an iteration that ran past its deadline */
+  Trace_CheckDeadline(start, micros());
 
-    /* Set the game map LEDs */
-    IO_SetHWGameMap(checkers_game);
-  }
-  else {
-    /* Flash the turn indicator LED based on the winner until restarted */
-    IO_WinnerTurnIndicator(checkers_game.Checkers_GetActivePlayer());
+  if (can_sleep) {
+    /* Erasing a flash sector stalls both cores, so the journal does it while nobody is playing and outside the deadline */
+    Journal_Maintain();
+    Process_Sleep();
   }
 }
@@ -0,0 +1,462 @@
+/************************************************************
+ * @file Network.cpp
+ * @brief The implementation for the learned evaluation, a small quantized neural network over the pieces on the 32 dark squares
+ *
+ * @note The hot paths, adding a column to an accumulator and the output layer, use SSE2 or AVX2 on x86 hosts and NEON
+ *       on ARM ones, and plain C everywhere else (the ESP32 among them). Every sum fits its integers without
+ *       saturating, so each version gives exactly the same result. Refreshing an accumulator always adds its columns
+ *       up in plain C, so checking the incremental updates against a refresh checks the vector code too.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Network.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#include <string.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define NETWORK_HEADER_SIZE (12) /* The bytes before the weights in a weight file */
+#define NETWORK_SQUARES     (CHECKERS_SNAPSHOT_SQUARES) /* The dark squares, the features of each piece kind */
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The CRC-32 (IEEE, reflected) of each nibble, the same as the journal's */
+const uint32_t network_crc_table[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+uint32_t    Network_Crc(const uint8_t *data, size_t length);
+uint16_t    Network_Read16(const uint8_t *bytes);
+uint32_t    Network_Read32(const uint8_t *bytes);
+void        Network_Write16(uint8_t *bytes, uint16_t value);
+void        Network_Write32(uint8_t *bytes, uint32_t value);
+int         Network_GetFeature(int perspective, int square, int piece);
+inline void Network_AddColumn(int16_t *values, const int16_t *column);
+inline void Network_SubtractColumn(int16_t *values, const int16_t *column);
+void        Network_Apply(const Network &network, NetworkAccumulator &accumulator, int square, int removed, int added);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Works out the CRC-32 of some bytes
+ *
+ * @param data: The bytes
+ * @param length: The number of bytes
+ * @return uint32_t: The CRC-32
+ */
+uint32_t Network_Crc(const uint8_t *data, size_t length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc = network_crc_table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+    crc = network_crc_table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+/**
+ * Reads a little-endian 16-bit number
+ *
+ * @param bytes: The bytes
+ * @return uint16_t: The number
+ */
+uint16_t Network_Read16(const uint8_t *bytes) {
+  return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+/**
+ * Reads a little-endian 32-bit number
+ *
+ * @param bytes: The bytes
+ * @return uint32_t: The number
+ */
+uint32_t Network_Read32(const uint8_t *bytes) {
+  return (uint32_t)Network_Read16(bytes) | ((uint32_t)Network_Read16(bytes + 2) << 16);
+}
+
+/**
+ * Writes a little-endian 16-bit number
+ *
+ * @param bytes: The bytes to write to
+ * @param value: The number
+ */
+void Network_Write16(uint8_t *bytes, uint16_t value) {
+  bytes[0] = (uint8_t)value;
+  bytes[1] = (uint8_t)(value >> 8);
+}
+
+/**
+ * Writes a little-endian 32-bit number
+ *
+ * @param bytes: The bytes to write to
+ * @param value: The number
+ */
+void Network_Write32(uint8_t *bytes, uint32_t value) {
+  Network_Write16(bytes, (uint16_t)value);
+  Network_Write16(bytes + 2, (uint16_t)(value >> 16));
+}
+
+/**
+ * Loads the weights from a weight file, leaving them unchanged if it is not one
+ *
+ * @param network: The weights
+ * @param bytes: The weight file, such as read from a file or kept in flash
+ * @param size: The bytes in it
+ * @return bool: If it was a weight file for this network, undamaged, with every first layer weight in range
+ */
+bool Network_Load(Network &network, const uint8_t *bytes, size_t size) {
+  /* Checks everything before touching the weights, so a damaged file can't leave half a network behind */
+  if (size != NETWORK_FILE_SIZE || Network_Read32(bytes) != NETWORK_MAGIC || Network_Read16(bytes + 4) != NETWORK_VERSION ||
+      Network_Read16(bytes + 6) != NETWORK_INPUTS || Network_Read16(bytes + 8) != NETWORK_HIDDEN ||
+      Network_Read16(bytes + 10) > NETWORK_MAX_SHIFT || Network_Read32(bytes + size - 4) != Network_Crc(bytes, size - 4)) {
+    return false;
+  }
+  const uint8_t *first_layer = bytes + NETWORK_HEADER_SIZE;
+  for (int i = 0; i < (NETWORK_INPUTS + 1) * NETWORK_HIDDEN; i++) {
+    int16_t weight = (int16_t)Network_Read16(first_layer + i * 2);
+    if (weight > NETWORK_MAX_WEIGHT || weight < -NETWORK_MAX_WEIGHT) {
+      return false;
+    }
+  }
+
+  const uint8_t *next = first_layer;
+  for (int i = 0; i < NETWORK_INPUTS; i++) {
+    for (int j = 0; j < NETWORK_HIDDEN; j++, next += 2) {
+      network.feature_weights[i][j] = (int16_t)Network_Read16(next);
+    }
+  }
+  for (int j = 0; j < NETWORK_HIDDEN; j++, next += 2) {
+    network.hidden_biases[j] = (int16_t)Network_Read16(next);
+  }
+  for (int j = 0; j < 2 * NETWORK_HIDDEN; j++, next++) {
+    network.output_weights[j] = (int8_t)*next;
+  }
+  network.output_bias = (int32_t)Network_Read32(next);
+  network.output_shift = Network_Read16(bytes + 10);
+  return true;
+}
+
+/**
+ * Writes the weights as a weight file
+ *
+ * @param network: The weights
+ * @param bytes: The bytes to write it to
+ * @param size: The room there is, at least NETWORK_FILE_SIZE
+ * @return size_t: The bytes written, 0 if there was not room or a weight is out of range for the file
+ */
+size_t Network_Save(const Network &network, uint8_t *bytes, size_t size) {
+  if (size < NETWORK_FILE_SIZE || network.output_shift > NETWORK_MAX_SHIFT) {
+    return 0;
+  }
+
+  /* Only a network the loader takes back is written */
+  for (int j = 0; j < NETWORK_HIDDEN; j++) {
+    for (int i = 0; i <= NETWORK_INPUTS; i++) {
+      int16_t weight = (i < NETWORK_INPUTS) ? network.feature_weights[i][j] : network.hidden_biases[j];
+      if (weight > NETWORK_MAX_WEIGHT || weight < -NETWORK_MAX_WEIGHT) {
+        return 0;
+      }
+    }
+    if (network.output_weights[j] < -128 || network.output_weights[j] > 127 ||
+        network.output_weights[NETWORK_HIDDEN + j] < -128 || network.output_weights[NETWORK_HIDDEN + j] > 127) {
+      return 0;
+    }
+  }
+
+  Network_Write32(bytes, NETWORK_MAGIC);
+  Network_Write16(bytes + 4, NETWORK_VERSION);
+  Network_Write16(bytes + 6, NETWORK_INPUTS);
+  Network_Write16(bytes + 8, NETWORK_HIDDEN);
+  Network_Write16(bytes + 10, network.output_shift);
+  uint8_t *next = bytes + NETWORK_HEADER_SIZE;
+  for (int i = 0; i < NETWORK_INPUTS; i++) {
+    for (int j = 0; j < NETWORK_HIDDEN; j++, next += 2) {
+      Network_Write16(next, (uint16_t)network.feature_weights[i][j]);
+    }
+  }
+  for (int j = 0; j < NETWORK_HIDDEN; j++, next += 2) {
+    Network_Write16(next, (uint16_t)network.hidden_biases[j]);
+  }
+  for (int j = 0; j < 2 * NETWORK_HIDDEN; j++, next++) {
+    *next = (uint8_t)network.output_weights[j];
+  }
+  Network_Write32(next, (uint32_t)network.output_bias);
+  Network_Write32(next + 4, Network_Crc(bytes, NETWORK_FILE_SIZE - 4));
+  return NETWORK_FILE_SIZE;
+}
+
+/**
+ * Finds the feature of a piece on a square, from one player's side of the board
+ *
+ * @param perspective: The player whose side it is from, 0 for player 1 and 1 for player 2
+ * @param square: The square, numbered as in a CheckersSnapshot
+ * @param piece: The piece, 1 to 4
+ * @return int: The feature, 0 to NETWORK_INPUTS less 1
+ * @note Player 2's side is the board turned round, so both players' men move up the rows they see
+ */
+int Network_GetFeature(int perspective, int square, int piece) {
+  int owner = (piece - 1) % 2;
+  int kind = ((owner == perspective) ? 0 : 2) + ((piece >= 3) ? 1 : 0);
+  return kind * NETWORK_SQUARES + ((perspective == 0) ? square : NETWORK_SQUARES - 1 - square);
+}
+
+/**
+ * Adds a first layer column to an accumulator
+ *
+ * @param values: The accumulator
+ * @param column: The column
+ */
+inline void Network_AddColumn(int16_t *values, const int16_t *column) {
+#if defined(__AVX2__)
+  for (int j = 0; j < NETWORK_HIDDEN; j += 16) {
+    __m256i sum = _mm256_add_epi16(_mm256_loadu_si256((const __m256i *)(values + j)), _mm256_loadu_si256((const __m256i *)(column + j)));
+    _mm256_storeu_si256((__m256i *)(values + j), sum);
+  }
+#elif defined(__SSE2__)
+  for (int j = 0; j < NETWORK_HIDDEN; j += 8) {
+    __m128i sum = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(values + j)), _mm_loadu_si128((const __m128i *)(column + j)));
+    _mm_storeu_si128((__m128i *)(values + j), sum);
+  }
+#elif defined(__ARM_NEON)
+  for (int j = 0; j < NETWORK_HIDDEN; j += 8) {
+    vst1q_s16(values + j, vaddq_s16(vld1q_s16(values + j), vld1q_s16(column + j)));
+  }
+#else
+  for (int j = 0; j < NETWORK_HIDDEN; j++) {
+    values[j] += column[j];
+  }
+#endif
+}
+
+/**
+ * Subtracts a first layer column from an accumulator
+ *
+ * @param values: The accumulator
+ * @param column: The column
+ */
+inline void Network_SubtractColumn(int16_t *values, const int16_t *column) {
+#if defined(__AVX2__)
+  for (int j = 0; j < NETWORK_HIDDEN; j += 16) {
+    __m256i difference = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i *)(values + j)), _mm256_loadu_si256((const __m256i *)(column + j)));
+    _mm256_storeu_si256((__m256i *)(values + j), difference);
+  }
+#elif defined(__SSE2__)
+  for (int j = 0; j < NETWORK_HIDDEN; j += 8) {
+    __m128i difference = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(values + j)), _mm_loadu_si128((const __m128i *)(column + j)));
+    _mm_storeu_si128((__m128i *)(values + j), difference);
+  }
+#elif defined(__ARM_NEON)
+  for (int j = 0; j < NETWORK_HIDDEN; j += 8) {
+    vst1q_s16(values + j, vsubq_s16(vld1q_s16(values + j), vld1q_s16(column + j)));
+  }
+#else
+  for (int j = 0; j < NETWORK_HIDDEN; j++) {
+    values[j] -= column[j];
+  }
+#endif
+}
+
+/**
+ * Changes the piece on a square in both players' accumulators
+ *
+ * @param network: The weights
+ * @param accumulator: The accumulators
+ * @param square: The square, numbered as in a CheckersSnapshot
+ * @param removed: The piece taken off it (0 for none)
+ * @param added: The piece put on it (0 for none)
+ */
+void Network_Apply(const Network &network, NetworkAccumulator &accumulator, int square, int removed, int added) {
+  for (int perspective = 0; perspective < 2; perspective++) {
+    if (removed != 0) {
+      Network_SubtractColumn(accumulator.values[perspective], network.feature_weights[Network_GetFeature(perspective, square, removed)]);
+    }
+    if (added != 0) {
+      Network_AddColumn(accumulator.values[perspective], network.feature_weights[Network_GetFeature(perspective, square, added)]);
+    }
+  }
+}
+
+/**
+ * Works out both players' accumulators from the whole board
+ *
+ * @param network: The weights
+ * @param game: The game
+ * @param accumulator: The accumulators
+ */
+void Network_Refresh(const Network &network, Checkers &game, NetworkAccumulator &accumulator) {
+  for (int perspective = 0; perspective < 2; perspective++) {
+    memcpy(accumulator.values[perspective], network.hidden_biases, sizeof(network.hidden_biases));
+  }
+
+  for (int square = 0; square < NETWORK_SQUARES; square++) {
+    int row = square / 4;
+    int piece = game.Checkers_GetBoardAt(row, (square % 4) * 2 + row % 2);
+    for (int perspective = 0; piece != 0 && perspective < 2; perspective++) {
+      const int16_t *column = network.feature_weights[Network_GetFeature(perspective, square, piece)];
+      for (int j = 0; j < NETWORK_HIDDEN; j++) {
+        accumulator.values[perspective][j] += column[j];
+      }
+    }
+  }
+}
+
+/**
+ * Updates the accumulators for a move, from the squares it changed
+ *
+ * @param network: The weights
+ * @param accumulator: The accumulators, for the game before the move
+ * @param before: The game before the move
+ * @param after: The game after the move
+ * @param move: The move
+ * @param change: The squares it changed, for Network_Unmake
+ */
+void Network_Make(const Network &network, NetworkAccumulator &accumulator, Checkers &before, Checkers &after, Move move, NetworkChange &change) {
+  Square squares[NETWORK_MAX_CHANGE] = {move.from, move.to, SQUARE_NONE};
+  int from_row = Move_GetRow(move.from);
+  int to_row = Move_GetRow(move.to);
+  if (from_row < MOVE_BOARD_SIZE && to_row < MOVE_BOARD_SIZE && (from_row - to_row == 2 || to_row - from_row == 2)) {
+    squares[2] = Move_MakeSquare((from_row + to_row) / 2, (Move_GetCol(move.from) + Move_GetCol(move.to)) / 2);
+  }
+
+  change.count = 0;
+  for (int i = 0; i < NETWORK_MAX_CHANGE; i++) {
+    int row = Move_GetRow(squares[i]);
+    int col = Move_GetCol(squares[i]);
+    if (row >= MOVE_BOARD_SIZE) {
+      continue;
+    }
+    int removed = before.Checkers_GetBoardAt(row, col);
+    int added = after.Checkers_GetBoardAt(row, col);
+    if (removed != added) {
+      change.squares[change.count] = (uint8_t)(row * 4 + col / 2);
+      change.before[change.count] = (uint8_t)removed;
+      change.after[change.count] = (uint8_t)added;
+      Network_Apply(network, accumulator, row * 4 + col / 2, removed, added);
+      change.count++;
+    }
+  }
+}
+
+/**
+ * Takes a move back out of the accumulators
+ *
+ * @param network: The weights
+ * @param accumulator: The accumulators, for the game after the move
+ * @param change: The squares the move changed, from Network_Make
+ */
+void Network_Unmake(const Network &network, NetworkAccumulator &accumulator, const NetworkChange &change) {
+  for (int i = change.count - 1; i >= 0; i--) {
+    Network_Apply(network, accumulator, change.squares[i], change.after[i], change.before[i]);
+  }
+}
+
+/**
+ * Evaluates a position from its accumulators
+ *
+ * @param network: The weights
+ * @param accumulator: The accumulators
+ * @param active_player: The active player, 1 or 2
+ * @return int: The score for the active player, in hundredths of a man
+ */
+int Network_Evaluate(const Network &network, const NetworkAccumulator &accumulator, int active_player) {
+  const int16_t *sides[2] = {accumulator.values[active_player - 1], accumulator.values[2 - active_player]};
+  int32_t sum;
+
+#if defined(__AVX2__)
+  __m256i total = _mm256_setzero_si256();
+  for (int side = 0; side < 2; side++) {
+    for (int j = 0; j < NETWORK_HIDDEN; j += 16) {
+      __m256i value = _mm256_loadu_si256((const __m256i *)(sides[side] + j));
+      value = _mm256_min_epi16(_mm256_max_epi16(value, _mm256_setzero_si256()), _mm256_set1_epi16(NETWORK_CLIP));
+      __m256i weight = _mm256_loadu_si256((const __m256i *)(network.output_weights + side * NETWORK_HIDDEN + j));
+      total = _mm256_add_epi32(total, _mm256_madd_epi16(value, weight));
+    }
+  }
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+  sum = _mm_cvtsi128_si32(half);
+#elif defined(__SSE2__)
+  __m128i total = _mm_setzero_si128();
+  for (int side = 0; side < 2; side++) {
+    for (int j = 0; j < NETWORK_HIDDEN; j += 8) {
+      __m128i value = _mm_loadu_si128((const __m128i *)(sides[side] + j));
+      value = _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(NETWORK_CLIP));
+      __m128i weight = _mm_loadu_si128((const __m128i *)(network.output_weights + side * NETWORK_HIDDEN + j));
+      total = _mm_add_epi32(total, _mm_madd_epi16(value, weight));
+    }
+  }
+  total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0x4E));
+  total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0xB1));
+  sum = _mm_cvtsi128_si32(total);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  int32x4_t total = vdupq_n_s32(0);
+  for (int side = 0; side < 2; side++) {
+    for (int j = 0; j < NETWORK_HIDDEN; j += 8) {
+      int16x8_t value = vminq_s16(vmaxq_s16(vld1q_s16(sides[side] + j), vdupq_n_s16(0)), vdupq_n_s16(NETWORK_CLIP));
+      int16x8_t weight = vld1q_s16(network.output_weights + side * NETWORK_HIDDEN + j);
+      total = vmlal_s16(total, vget_low_s16(value), vget_low_s16(weight));
+      total = vmlal_s16(total, vget_high_s16(value), vget_high_s16(weight));
+    }
+  }
+  sum = vaddvq_s32(total);
+#else
+  return Network_EvaluatePlain(network, accumulator, active_player);
+#endif
+
+  return (sum + network.output_bias) / (1 << network.output_shift);
+}
+
+/**
+ * Evaluates a position from its accumulators in plain C, the same as Network_Evaluate on every target
+ *
+ * @param network: The weights
+ * @param accumulator: The accumulators
+ * @param active_player: The active player, 1 or 2
+ * @return int: The score for the active player, in hundredths of a man
+ */
+int Network_EvaluatePlain(const Network &network, const NetworkAccumulator &accumulator, int active_player) {
+  const int16_t *sides[2] = {accumulator.values[active_player - 1], accumulator.values[2 - active_player]};
+  int32_t sum = 0;
+  for (int side = 0; side < 2; side++) {
+    for (int j = 0; j < NETWORK_HIDDEN; j++) {
+      int value = sides[side][j];
+      value = (value < 0) ? 0 : (value > NETWORK_CLIP) ? NETWORK_CLIP : value;
+      sum += value * network.output_weights[side * NETWORK_HIDDEN + j];
+    }
+  }
+  return (sum + network.output_bias) / (1 << network.output_shift);
+}
+
+/**
+ * Retrieves the name of the vector code the build uses
+ *
+ * @return const char *: The name, "none" for plain C
+ */
+const char *Network_GetSimdName() {
+#if defined(__AVX2__)
+  return "AVX2";
+#elif defined(__SSE2__)
+  return "SSE2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  return "NEON";
+#else
+  return "none";
+#endif
+}
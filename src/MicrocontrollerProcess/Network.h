@@ -0,0 +1,80 @@
+/************************************************************
+ * @file Network.h
+ * @brief The header for the learned evaluation, a small quantized neural network over the pieces on the 32 dark squares
+ *
+ * @note Each player has an accumulator, the first layer's outputs from their side of the board (turned round for
+ *       player 2, with their pieces as their own), which a move only changes by the columns of the few squares it
+ *       touches. The evaluation clips both accumulators to 0 to NETWORK_CLIP, the active player's first, and takes
+ *       their dot product with the output weights. The weights take about 8 KB, small enough for the ESP32's RAM.
+ ************************************************************/
+#ifndef NETWORK_H
+#define NETWORK_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stddef.h>
+#include <stdint.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define NETWORK_MAGIC      (0x4E4E4B43UL) /* "CKNN" at the start of a weight file */
+#define NETWORK_VERSION    (1)            /* The version of the weight file format */
+#define NETWORK_INPUTS     (128)          /* The features, own man, own king, other man and other king on each dark square */
+#define NETWORK_HIDDEN     (32)           /* The outputs of the first layer for each player, a multiple of 16 for the vector code */
+#define NETWORK_CLIP       (127)          /* The most a first layer output passes on to the output layer */
+#define NETWORK_MAX_WEIGHT (1024)         /* The largest first layer weight or bias, so 24 pieces never overflow 16 bits */
+#define NETWORK_MAX_SHIFT  (16)           /* The largest output shift */
+#define NETWORK_MAX_CHANGE (3)            /* The most squares a move changes: the square left, the square taken and the one landed on */
+#define NETWORK_FILE_SIZE  (12 + NETWORK_INPUTS * NETWORK_HIDDEN * 2 + NETWORK_HIDDEN * 2 + NETWORK_HIDDEN * 2 + 4 + 4) /* The bytes in a weight file */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The weights, as loaded from a weight file */
+struct Network {
+  int16_t  feature_weights[NETWORK_INPUTS][NETWORK_HIDDEN]; /* The first layer's column for each feature */
+  int16_t  hidden_biases[NETWORK_HIDDEN];                   /* The first layer's biases */
+  int16_t  output_weights[2 * NETWORK_HIDDEN];              /* The output weights, the active player's half first (8-bit in the file) */
+  int32_t  output_bias;                                     /* The output bias */
+  uint16_t output_shift;                                    /* The output is divided by 2 to the power of this, to hundredths of a man */
+};
+
+/* The first layer's outputs for each player, kept up to date move by move */
+struct NetworkAccumulator {
+  int16_t values[2][NETWORK_HIDDEN]; /* Player 1's, then player 2's */
+};
+
+/* The squares a move changed, so it can be taken back */
+struct NetworkChange {
+  int     count;                       /* The number of squares */
+  uint8_t squares[NETWORK_MAX_CHANGE]; /* The squares, numbered as in a CheckersSnapshot */
+  uint8_t before[NETWORK_MAX_CHANGE];  /* The piece on each before the move (0 for none) */
+  uint8_t after[NETWORK_MAX_CHANGE];   /* The piece on each after the move (0 for none) */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Weight file functions */
+bool   Network_Load(Network &network, const uint8_t *bytes, size_t size);
+size_t Network_Save(const Network &network, uint8_t *bytes, size_t size);
+
+/* Accumulator functions */
+void Network_Refresh(const Network &network, Checkers &game, NetworkAccumulator &accumulator);
+void Network_Make(const Network &network, NetworkAccumulator &accumulator, Checkers &before, Checkers &after, Move move, NetworkChange &change);
+void Network_Unmake(const Network &network, NetworkAccumulator &accumulator, const NetworkChange &change);
+
+/* Evaluation functions */
+int         Network_Evaluate(const Network &network, const NetworkAccumulator &accumulator, int active_player);
+int         Network_EvaluatePlain(const Network &network, const NetworkAccumulator &accumulator, int active_player);
+const char *Network_GetSimdName();
+
+#endif /* NETWORK_H */
@@ -0,0 +1,217 @@
+/************************************************************
+ * @file Power.cpp
+ * @brief The implementation for the idle governor, which notices when nobody is playing and measures how much of the idle time is slept
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Power.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <atomic>
+#include "Arduino.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The governor state, the input core reports activity and reads the state while the game core updates it */
+std::atomic<unsigned long> power_last_activity(0); /* The millis() time of the last input */
+std::atomic<bool>          power_idle(false);      /* Indicator for if the board is idle */
+unsigned long              power_last_update;      /* The millis() time of the last update */
+
+/* The duty cycle, counted from power on */
+unsigned long      power_idle_entries; /* The number of times the board went idle */
+unsigned long      power_active_time;  /* The time spent active in ms */
+unsigned long      power_idle_time;    /* The time spent idle in ms */
+unsigned long long power_sleep_total;  /* The time spent in light sleep in us, which would wrap an unsigned long in 71 minutes */
+unsigned long      power_sleeps;       /* The number of light sleeps */
+unsigned long      power_pin_wakes;    /* The number of light sleeps cut short by a wake pin */
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Starts the governor active, with the duty cycle cleared
+ *
+ * @param now: The current millis() time
+ */
+void Power_Reset(unsigned long now) {
+  power_last_activity = now;
+  power_idle = false;
+  power_last_update = now;
+  power_idle_entries = 0;
+  power_active_time = 0;
+  power_idle_time = 0;
+  power_sleep_total = 0;
+  power_sleeps = 0;
+  power_pin_wakes = 0;
+}
+
+/**
+ * Notes an input from a player, which keeps the board active or wakes it on the next update
+ *
+ * @param now: The current millis() time
+ */
+void Power_Activity(unsigned long now) {
+  power_last_activity = now;
+}
+
+/**
+ * Moves the board between active and idle, counting the time spent in each
+ *
+ * @param now: The current millis() time
+ * @return bool: If the board went idle or woke up
+ */
+bool Power_Update(unsigned long now) {
+  bool was_idle = power_idle;
+  if (was_idle) {
+    power_idle_time += now - power_last_update;
+  }
+  else {
+    power_active_time += now - power_last_update;
+  }
+  power_last_update = now;
+
+  /* The subtraction keeps the comparison correct when millis() wraps around */
+  bool idle = (long)(now - power_last_activity.load()) >= POWER_IDLE_TIMEOUT;
+  if (idle == was_idle) {
+    return false;
+  }
+
+  power_idle = idle;
+  if (idle) {
+    power_idle_entries++;
+  }
+  return true;
+}
+
+/**
+ * Retrieves if the board is idle
+ *
+ * @return bool: If the board is idle
+ */
+bool Power_IsIdle() {
+  return power_idle;
+}
+
+/**
+ * Works out how long to sleep before the next task is due
+ *
+ * @param time_to_next: The time until the next task is due in ms
+ * @return unsigned long: The time to sleep in ms, 0 if it is too short to be worth it
+ */
+unsigned long Power_GetSleepTime(unsigned long time_to_next) {
+  if (time_to_next < POWER_MIN_SLEEP) {
+    return 0;
+  }
+  return (time_to_next < POWER_MAX_SLEEP) ? time_to_next : POWER_MAX_SLEEP;
+}
+
+/**
+ * Adds a light sleep to the duty cycle
+ *
+ * @param duration: The time measured asleep in us
+ * @param pin_wake: Indicator for if a wake pin cut the sleep short
+ */
+void Power_RecordSleep(unsigned long duration, bool pin_wake) {
+  power_sleep_total += duration;
+  power_sleeps++;
+  if (pin_wake) {
+    power_pin_wakes++;
+  }
+}
+
+/**
+ * Retrieves the number of times the board went idle
+ *
+ * @return unsigned long: The number of times
+ */
+unsigned long Power_GetIdleEntries() {
+  return power_idle_entries;
+}
+
+/**
+ * Retrieves the time spent active
+ *
+ * @return unsigned long: The time in ms
+ */
+unsigned long Power_GetActiveTime() {
+  return power_active_time;
+}
+
+/**
+ * Retrieves the time spent idle
+ *
+ * @return unsigned long: The time in ms
+ */
+unsigned long Power_GetIdleTime() {
+  return power_idle_time;
+}
+
+/**
+ * Retrieves the time spent in light sleep
+ *
+ * @return unsigned long: The time in ms
+ */
+unsigned long Power_GetSleepTotal() {
+  return (unsigned long)(power_sleep_total / 1000);
+}
+
+/**
+ * Retrieves the number of light sleeps
+ *
+ * @return unsigned long: The number of sleeps
+ */
+unsigned long Power_GetSleeps() {
+  return power_sleeps;
+}
+
+/**
+ * Retrieves the number of light sleeps a wake pin cut short
+ *
+ * @return unsigned long: The number of sleeps
+ */
+unsigned long Power_GetPinWakes() {
+  return power_pin_wakes;
+}
+
+/**
+ * Works out the share of the idle time spent awake
+ *
+ * @return int: The duty cycle in tenths of a percent (0 if the board has not been idle)
+ */
+int Power_GetIdleDutyCycle() {
+  unsigned long asleep = Power_GetSleepTotal();
+  if (power_idle_time == 0 || asleep >= power_idle_time) {
+    return 0;
+  }
+  return (int)(((unsigned long long)(power_idle_time - asleep) * 1000) / power_idle_time);
+}
+
+/**
+ * Prints the duty cycle as one CSV line:
+ * POWER,<active|idle>,<idle entries>,<active ms>,<idle ms>,<asleep ms>,<sleeps>,<pin wakes>,<idle duty cycle in tenths of a percent>
+ *
+ * @param out: Where to print the line, normally Serial
+ */
+void Power_Dump(Print &out) {
+  out.print("POWER,");
+  out.print(power_idle ? "idle" : "active");
+  out.print(',');
+  out.print(power_idle_entries);
+  out.print(',');
+  out.print(power_active_time);
+  out.print(',');
+  out.print(power_idle_time);
+  out.print(',');
+  out.print(Power_GetSleepTotal());
+  out.print(',');
+  out.print(power_sleeps);
+  out.print(',');
+  out.print(power_pin_wakes);
+  out.print(',');
+  out.println(Power_GetIdleDutyCycle());
+}
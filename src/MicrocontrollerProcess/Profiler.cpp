@@ -0,0 +1,160 @@
+/************************************************************
+ * @file Profiler.cpp
+ * @brief The implementation for timing each stage of the loop into log-scale histograms and dumping them over Serial
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Profiler.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The names of the stages in a dump, in ProfilerStage order */
+const char *profiler_stage_names[PROFILER_STAGE_COUNT] = {"voice", "button", "turn", "indicator", "render"};
+
+/* The histograms, which keep counting from power on so a dump always covers the whole run */
+unsigned long profiler_buckets[PROFILER_STAGE_COUNT][PROFILER_BUCKET_COUNT]; /* The number of samples in each bucket */
+unsigned long profiler_max[PROFILER_STAGE_COUNT];                            /* The longest sample of each stage in us */
+
+unsigned long profiler_last_dump; /* The millis() time of the last periodic dump */
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Clears every histogram
+ *
+ */
+void Profiler_Reset() {
+  for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++) {
+    for (int bucket = 0; bucket < PROFILER_BUCKET_COUNT; bucket++) {
+      profiler_buckets[stage][bucket] = 0;
+    }
+    profiler_max[stage] = 0;
+  }
+  profiler_last_dump = 0;
+}
+
+/**
+ * Adds a sample to a stage's histogram
+ *
+ * @param stage: The stage that was timed
+ * @param duration: The time the stage took in us
+ */
+void Profiler_Record(ProfilerStage stage, unsigned long duration) {
+  profiler_buckets[stage][Profiler_GetBucketIndex(duration)]++;
+  if (duration > profiler_max[stage]) {
+    profiler_max[stage] = duration;
+  }
+}
+
+/**
+ * Retrieves the number of samples recorded for a stage
+ *
+ * @param stage: The stage
+ * @return unsigned long: The number of samples
+ */
+unsigned long Profiler_GetCount(ProfilerStage stage) {
+  unsigned long count = 0;
+  for (int bucket = 0; bucket < PROFILER_BUCKET_COUNT; bucket++) {
+    count += profiler_buckets[stage][bucket];
+  }
+  return count;
+}
+
+/**
+ * Retrieves the longest sample recorded for a stage
+ *
+ * @param stage: The stage
+ * @return unsigned long: The longest sample in us
+ */
+unsigned long Profiler_GetMax(ProfilerStage stage) {
+  return profiler_max[stage];
+}
+
+/**
+ * Retrieves the number of samples in one bucket of a stage's histogram
+ *
+ * @param stage: The stage
+ * @param bucket: The bucket index
+ * @return unsigned long: The number of samples
+ */
+unsigned long Profiler_GetBucket(ProfilerStage stage, int bucket) {
+  return profiler_buckets[stage][bucket];
+}
+
+/**
+ * Finds the bucket a sample falls in, which is the number of bits needed to hold it
+ *
+ * @param duration: The sample in us
+ * @return int: The bucket index
+ */
+int Profiler_GetBucketIndex(unsigned long duration) {
+  if (duration == 0) {
+    return 0;
+  }
+
+  int bucket = (int)(sizeof(unsigned long) * 8) - __builtin_clzl(duration);
+  return (bucket < PROFILER_BUCKET_COUNT) ? bucket : PROFILER_BUCKET_COUNT - 1;
+}
+
+/**
+ * Retrieves the name a stage is printed with
+ *
+ * @param stage: The stage
+ * @return const char *: The name
+ */
+const char *Profiler_GetStageName(ProfilerStage stage) {
+  return profiler_stage_names[stage];
+}
+
+/**
+ * Prints every histogram as one CSV line per stage: PROFILE,<stage>,<count>,<max us>,<bucket 0>,...,<bucket 15>
+ *
+ * @param out: Where to print the lines, normally Serial
+ * @note The input core keeps recording while the game core dumps, so a line can be one sample behind its count
+ */
+void Profiler_Dump(Print &out) {
+  for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++) {
+    out.print("PROFILE,");
+    out.print(profiler_stage_names[stage]);
+    out.print(',');
+    out.print(Profiler_GetCount((ProfilerStage)stage));
+    out.print(',');
+    out.print(profiler_max[stage]);
+    for (int bucket = 0; bucket < PROFILER_BUCKET_COUNT; bucket++) {
+      out.print(',');
+      out.print(profiler_buckets[stage][bucket]);
+    }
+    out.println();
+  }
+}
+
+/**
+ * Dumps the histograms if PROFILER_COMMAND was received or the dump period is over
+ *
+ * @param out: Where to print the lines, normally Serial
+ * @param command: The byte received over Serial (-1 if there was none)
+ * @param now: The current millis() time
+ * @return bool: If the histograms were dumped
+ */
+bool Profiler_Poll(Print &out, int command, unsigned long now) {
+  bool requested = (command == PROFILER_COMMAND);
+  bool periodic = (PROFILER_DUMP_PERIOD != 0) && (now - profiler_last_dump >= PROFILER_DUMP_PERIOD);
+  if (periodic) {
+    profiler_last_dump = now;
+  }
+
+  if (requested || periodic) {
+    Profiler_Dump(out);
+    return true;
+  }
+  return false;
+}
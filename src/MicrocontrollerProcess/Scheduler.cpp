@@ -0,0 +1,220 @@
+/************************************************************
+ * @file Scheduler.cpp
+ * @brief The implementation for the cooperative task scheduler
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Scheduler.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * The constructor for a Scheduler object, clears all of the task slots
+ *
+ */
+Scheduler::Scheduler() {
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    tasks[i].callback = 0;
+    tasks[i].period = 0;
+    tasks[i].deadline = 0;
+    tasks[i].active = false;
+    tasks[i].run_count = 0;
+    tasks[i].run_time = 0;
+    tasks[i].max_run_time = 0;
+  }
+}
+
+/**
+ * Stores a task in the first free slot
+ *
+ * @param callback: The function to run
+ * @param period:   The time between runs in ms (0 for a one-shot task)
+ * @param deadline: The millis() time the task is first due
+ * @return int: The slot of the task, or SCHEDULER_NO_TASK if every slot is taken
+ */
+int Scheduler::Scheduler_Add(SchedulerCallback callback, unsigned long period, unsigned long deadline) {
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    if (!tasks[i].active) {
+      tasks[i].callback = callback;
+      tasks[i].period = period;
+      tasks[i].deadline = deadline;
+      tasks[i].run_count = 0;
+      tasks[i].run_time = 0;
+      tasks[i].max_run_time = 0;
+      tasks[i].active = true;
+      return i;
+    }
+  }
+
+  return SCHEDULER_NO_TASK;
+}
+
+/**
+ * Adds a task that runs every period, starting right away
+ *
+ * @param callback: The function to run
+ * @param period:   The time between runs in ms
+ * @param now:      The current millis() time
+ * @return int: The ID of the task, or SCHEDULER_NO_TASK if the scheduler is full
+ */
+int Scheduler::Scheduler_AddPeriodic(SchedulerCallback callback, unsigned long period, unsigned long now) {
+  /* A period of 0 would make this a one-shot task, so run it as often as possible instead */
+  if (period == 0) {
+    period = 1;
+  }
+
+  return Scheduler_Add(callback, period, now);
+}
+
+/**
+ * Adds a task that runs once after a delay, then frees its slot
+ *
+ * @param callback:   The function to run
+ * @param delay_time: The time to wait in ms before running the task
+ * @param now:        The current millis() time
+ * @return int: The ID of the task, or SCHEDULER_NO_TASK if the scheduler is full
+ */
+int Scheduler::Scheduler_AddOneShot(SchedulerCallback callback, unsigned long delay_time, unsigned long now) {
+  return Scheduler_Add(callback, 0, now + delay_time);
+}
+
+/**
+ * Removes a task so it will no longer run
+ *
+ * @param task_id: The ID of the task to remove
+ */
+void Scheduler::Scheduler_Cancel(int task_id) {
+  if (task_id >= 0 && task_id < SCHEDULER_MAX_TASKS) {
+    tasks[task_id].active = false;
+  }
+}
+
+/**
+ * Changes how often a periodic task runs, bringing its next run forward if it is further away than the new period
+ *
+ * @param task_id: The ID of the task
+ * @param period:  The new time between runs in ms
+ * @param now:     The current millis() time
+ */
+void Scheduler::Scheduler_SetPeriod(int task_id, unsigned long period, unsigned long now) {
+  if (task_id < 0 || task_id >= SCHEDULER_MAX_TASKS || !tasks[task_id].active || tasks[task_id].period == 0) {
+    return;
+  }
+
+  tasks[task_id].period = (period == 0) ? 1 : period;
+  if ((long)(tasks[task_id].deadline - now) > (long)tasks[task_id].period) {
+    tasks[task_id].deadline = now + tasks[task_id].period;
+  }
+}
+
+/**
+ * Runs every task whose deadline has passed, never waiting on a task that is not due
+ *
+ * @param now: The current millis() time
+ */
+void Scheduler::Scheduler_Run(unsigned long now) {
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    /* The subtraction keeps the comparison correct when millis() wraps around */
+    if (!tasks[i].active || (long)(now - tasks[i].deadline) < 0) {
+      continue;
+    }
+
+    /* One-shot tasks free their slot before running so the callback can schedule another one */
+    if (tasks[i].period == 0) {
+      tasks[i].active = false;
+    }
+    /* Periodic tasks keep their phase, but skip missed runs instead of running them back to back */
+    else {
+      tasks[i].deadline += tasks[i].period;
+      if ((long)(now - tasks[i].deadline) >= 0) {
+        tasks[i].deadline = now + tasks[i].period;
+      }
+    }
+
+    /* Run the task and account for the time spent in it */
+    unsigned long start_time = micros();
+    tasks[i].callback(now);
+    unsigned long elapsed_time = micros() - start_time;
+
+    tasks[i].run_count++;
+    tasks[i].run_time += elapsed_time;
+    if (elapsed_time > tasks[i].max_run_time) {
+      tasks[i].max_run_time = elapsed_time;
+    }
+  }
+}
+
+/**
+ * Finds how long it is until the next task is due, which is how long the caller can sleep
+ *
+ * @param now: The current millis() time
+ * @return unsigned long: The time in ms (0 if a task is already due, SCHEDULER_NO_WAIT if there are no tasks)
+ */
+unsigned long Scheduler::Scheduler_GetTimeToNext(unsigned long now) {
+  unsigned long time_to_next = SCHEDULER_NO_WAIT;
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    if (!tasks[i].active) {
+      continue;
+    }
+
+    long remaining = (long)(tasks[i].deadline - now);
+    if (remaining <= 0) {
+      return 0;
+    }
+    if ((unsigned long)remaining < time_to_next) {
+      time_to_next = remaining;
+    }
+  }
+
+  return time_to_next;
+}
+
+/**
+ * Retrieves how many times a task has run
+ *
+ * @param task_id: The ID of the task
+ * @return unsigned long: The number of runs
+ */
+unsigned long Scheduler::Scheduler_GetRunCount(int task_id) {
+  if (task_id < 0 || task_id >= SCHEDULER_MAX_TASKS) {
+    return 0;
+  }
+
+  return tasks[task_id].run_count;
+}
+
+/**
+ * Retrieves the total time spent running a task
+ *
+ * @param task_id: The ID of the task
+ * @return unsigned long: The total run time in us
+ */
+unsigned long Scheduler::Scheduler_GetRunTime(int task_id) {
+  if (task_id < 0 || task_id >= SCHEDULER_MAX_TASKS) {
+    return 0;
+  }
+
+  return tasks[task_id].run_time;
+}
+
+/**
+ * Retrieves the longest single run of a task
+ *
+ * @param task_id: The ID of the task
+ * @return unsigned long: The longest run time in us
+ */
+unsigned long Scheduler::Scheduler_GetMaxRunTime(int task_id) {
+  if (task_id < 0 || task_id >= SCHEDULER_MAX_TASKS) {
+    return 0;
+  }
+
+  return tasks[task_id].max_run_time;
+}
@@ -0,0 +1,71 @@
+/************************************************************
+ * @file Trace.h
+ * @brief The header for the ring buffer of recent function entries and exits, frozen and dumped when a loop runs past its deadline
+ ************************************************************/
+#ifndef TRACE_H
+#define TRACE_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define TRACE_EVENT_COUNT   (64)    /* The number of events kept, the oldest is overwritten by a new one */
+#define TRACE_LOOP_DEADLINE (20000) /* The longest a loop iteration may take before the trace is dumped (us, 0 to turn off) */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The traced functions */
+enum TraceId {
+  TRACE_IO_GET_VOICE_INPUT,        /* IO_GetVoiceRecognitionInput */
+  TRACE_IO_GET_BUTTON_INPUT,       /* IO_GetButtonInput */
+  TRACE_IO_SET_TURN_INDICATOR,     /* IO_SetTurnIndicator */
+  TRACE_IO_BLINK_TURN_INDICATOR,   /* IO_BlinkTurnIndicator */
+  TRACE_IO_WINNER_TURN_INDICATOR,  /* IO_WinnerTurnIndicator */
+  TRACE_IO_SET_HW_GAME_MAP,        /* IO_SetHWGameMap */
+  TRACE_CHECKERS_TURN,             /* Checkers_Turn */
+  TRACE_BLE_POLL_RX,               /* Collecting a reply from the BLE module over SPI */
+  TRACE_BLE_REQUEST_RX,            /* Sending a read request to the BLE module over SPI */
+  TRACE_BLE_IS_CONNECTED,          /* Asking the BLE module for its connection state */
+  TRACE_BLE_UPDATE_BATTERY,        /* Sending the battery level to the BLE module */
+  TRACE_JOURNAL_RECORD_MOVE,       /* Journal_RecordMove, writing a move to flash */
+  TRACE_ID_COUNT
+};
+
+/* Whether an event is a function starting or returning */
+enum TraceKind {
+  TRACE_ENTER,
+  TRACE_EXIT
+};
+
+/* One recorded event */
+struct TraceEvent {
+  unsigned long time; /* The micros() time of the event */
+  uint8_t       id;   /* The TraceId of the function */
+  uint8_t       kind; /* The TraceKind of the event */
+  uint8_t       core; /* The core the function ran on */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Recording functions (safe to call from either core) */
+void Trace_Reset();
+void Trace_Record(TraceId id, TraceKind kind, unsigned long now);
+void Trace_Enter(TraceId id);
+void Trace_Exit(TraceId id);
+
+/* Deadline functions */
+bool Trace_CheckDeadline(unsigned long start, unsigned long now);
+bool Trace_IsFrozen();
+void Trace_Thaw(unsigned long now);
+
+/* Reporting functions */
+int  Trace_GetEvents(TraceEvent *events);
+void Trace_Dump(Print &out);
+
+#endif /* TRACE_H */
@@ -6,16 +6,20 @@
 /**********************************
  ** Library Includes
  **********************************/
+#include "Move.h"
+#include "Trace.h"
 #include "VoiceRecognition.h"
 
 /**********************************
  ** Third Party Libraries Includes
  **********************************/
 #include "Adafruit_BLE.h"
+#include "Adafruit_BLEBattery.h"
 #include "Adafruit_BluefruitLE_SPI.h"
 #include "Adafruit_BluefruitLE_UART.h"
 #include "Arduino.h"
 #include "SPI.h"
+#include "circular_queue/circular_queue.h"
 
 /**********************************
  ** Defines
@@ -26,16 +30,72 @@
 #define MODE_LED_BEHAVIOR        ("MODE")
 #define VERBOSE_MODE             (true)
 
+/* Parser settings */
+#define VOICE_RX_BUFFER_SIZE (32) /* The number of bytes read from the BLE module at a time */
+
+/* BLE polling settings (ms) */
+#define VOICE_RX_TIMEOUT            (100)  /* Time to wait for the reply to a read request before asking again */
+#define VOICE_CONNECTION_CHECK_TIME (1000) /* How often the cached connection state is refreshed */
+
+/* Interrupt handlers must be in IRAM on the ESP32 */
+#if !defined(IRAM_ATTR)
+#define IRAM_ATTR
+#endif
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The parser states, a command looks like "A1 B2" and ends with a newline, semicolon or space */
+enum VoiceParseState {
+  VOICE_PARSE_FROM_ROW, /* Waiting for the row letter of the square to move from */
+  VOICE_PARSE_FROM_COL, /* Waiting for the column number of the square to move from */
+  VOICE_PARSE_GAP,      /* Waiting for the space between the two squares */
+  VOICE_PARSE_TO_ROW,   /* Waiting for the row letter of the square to move to */
+  VOICE_PARSE_TO_COL,   /* Waiting for the column number of the square to move to */
+  VOICE_PARSE_END,      /* A move was just parsed, waiting for the space or end after it */
+  VOICE_PARSE_DISCARD   /* Skipping a malformed command until the next newline or semicolon */
+};
+
 /**********************************
  ** Global Variables
  **********************************/
 Adafruit_BluefruitLE_SPI ble(22, 17, 21);
+Adafruit_BLEBattery      ble_battery(ble);
+
+/* BLE polling state, so no call waits on the module */
+volatile bool voice_irq_flag = false;          /* Set by the IRQ line when the module has a reply ready */
+bool          voice_rx_pending = false;        /* Indicator for if a read request is waiting on its reply */
+unsigned long voice_rx_request_time = 0;       /* The millis() time the read request was sent */
+bool          voice_connected = false;         /* The cached connection state */
+unsigned long voice_connection_check_time = 0; /* The millis() time the connection state was last refreshed */
+
+/* Battery service state */
+bool voice_battery_enabled = false; /* Indicator for if the module's battery service is running */
+int  voice_battery_level = -1;      /* The level in % waiting to be sent, -1 once it has been */
+
+/* Parser state, kept between reads so a command can be split across them */
+VoiceParseState      voice_parse_state = VOICE_PARSE_FROM_ROW;
+int                  voice_parse_row = 0;                    /* The row of the square being parsed */
+Move                 voice_parse_move;                       /* The move being parsed */
+char                 voice_rx_buffer[VOICE_RX_BUFFER_SIZE];  /* The bytes most recently read from the BLE module */
+
+/* Moves that have been parsed but not taken yet, along with the micros() time their bytes were read off the module */
+circular_queue<Move>          voice_moves(VOICE_MOVE_QUEUE_SIZE);
+circular_queue<unsigned long> voice_move_times(VOICE_MOVE_QUEUE_SIZE);
+unsigned long                 voice_rx_time = 0;    /* The micros() time of the bytes being parsed */
+unsigned long                 voice_input_time = 0; /* The micros() time of the move last taken */
 
 /**********************************
  ** Private Function Prototypes
  **********************************/
 void VoiceRecognition_OutputError(const __FlashStringHelper *err);
-void VoiceRecognition_ParseMoves(String moves, String &result);
+void VoiceRecognition_IrqHandler();
+bool VoiceRecognition_PollRx();
+bool VoiceRecognition_RequestRx();
+bool VoiceRecognition_IsConnected();
+bool VoiceRecognition_UpdateBattery(int level);
+void VoiceRecognition_ParseByte(char received_data);
+void VoiceRecognition_ParseBytes(const char *received_data, int length);
 
 /**********************************
  ** Function Definitions
@@ -51,28 +111,151 @@ void VoiceRecognition_OutputError(const __FlashStringHelper *err) {
 }
 
 /**
- * Parses a command from the BLE application into a move array of length 2
+ * Flags that the BLE module has a reply ready, the reply is read outside of the interrupt
  *
- * @param moves: The moves from the BLE application to parse
- * @param result: The result of the move to send back
  */
-void VoiceRecognition_ParseMoves(String moves, String &result) {
-  /* Vector to store parsed moves */
-  int index = 0;
-  int start = 0;
-  int space_index = moves.indexOf(' '); /* Find the first space */
-
-  /* Only stores the first five characters and parses for spaces */
-  while ((space_index != -1) && (index < 1)) {
-    /* Get the substring from start to the next space */
-    if (start != space_index) {
-      result = moves.substring(start, moves.indexOf(' ', space_index + 1));
-      index += 1;
-    }
+void IRAM_ATTR VoiceRecognition_IrqHandler() {
+  voice_irq_flag = true;
+}
+
+/**
+ * Collects the reply to a read request from the BLE module, traced as it is an SPI transaction that can stall
+ *
+ * @return bool: If a reply was collected
+ */
+bool VoiceRecognition_PollRx() {
+  Trace_Enter(TRACE_BLE_POLL_RX);
+  bool collected = ble.pollRx();
+  Trace_Exit(TRACE_BLE_POLL_RX);
+  return collected;
+}
+
+/**
+ * Sends a read request to the BLE module, traced as it is an SPI transaction that can stall
+ *
+ * @return bool: If the request was sent
+ */
+bool VoiceRecognition_RequestRx() {
+  Trace_Enter(TRACE_BLE_REQUEST_RX);
+  bool sent = ble.requestRx();
+  Trace_Exit(TRACE_BLE_REQUEST_RX);
+  return sent;
+}
+
+/**
+ * Asks the BLE module for its connection state, traced as it is a full AT command round trip
+ *
+ * @return bool: If the app is connected
+ */
+bool VoiceRecognition_IsConnected() {
+  Trace_Enter(TRACE_BLE_IS_CONNECTED);
+  bool connected = ble.isConnected();
+  Trace_Exit(TRACE_BLE_IS_CONNECTED);
+  return connected;
+}
+
+/**
+ * Sends the battery level to the BLE module's battery service, traced as it is a full AT command round trip
+ *
+ * @param level: The battery level in %
+ * @return bool: If the module took the level
+ */
+bool VoiceRecognition_UpdateBattery(int level) {
+  Trace_Enter(TRACE_BLE_UPDATE_BATTERY);
+  bool updated = ble_battery.update(level);
+  Trace_Exit(TRACE_BLE_UPDATE_BATTERY);
+  return updated;
+}
+
+/**
+ * Steps the command parser by one byte, queueing the move once both squares are received
+ *
+ * @param received_data: The byte received from the BLE application
+ */
+void VoiceRecognition_ParseByte(char received_data) {
+  bool terminator = (received_data == '\n' || received_data == '\r' || received_data == ';');
+  bool separator = (terminator || received_data == ' ');
+
+  /* Row letters may come in lowercase from the speech to text */
+  if (received_data >= 'a' && received_data <= 'h') {
+    received_data = received_data - 'a' + 'A';
+  }
+  bool row = (received_data >= 'A' && received_data <= 'H');
+  bool col = (received_data >= '1' && received_data <= '8');
 
-    /* Move to the next space */
-    start = space_index + 1;
-    space_index = moves.indexOf(' ', start);
+  switch (voice_parse_state) {
+    case VOICE_PARSE_FROM_ROW:
+      /* Skip anything between commands */
+      if (row) {
+        voice_parse_row = received_data - 'A';
+        voice_parse_state = VOICE_PARSE_FROM_COL;
+      }
+      else if (!separator) {
+        voice_parse_state = VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_FROM_COL:
+      if (col) {
+        voice_parse_move.from = Move_MakeSquare(voice_parse_row, received_data - '1');
+        voice_parse_state = VOICE_PARSE_GAP;
+      }
+      else {
+        voice_parse_state = terminator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_GAP:
+      if (received_data == ' ') {
+        voice_parse_state = VOICE_PARSE_TO_ROW;
+      }
+      else {
+        voice_parse_state = terminator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_TO_ROW:
+      if (row) {
+        voice_parse_row = received_data - 'A';
+        voice_parse_state = VOICE_PARSE_TO_COL;
+      }
+      else if (received_data != ' ') {
+        voice_parse_state = terminator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_TO_COL:
+      if (col) {
+        voice_parse_move.to = Move_MakeSquare(voice_parse_row, received_data - '1');
+
+        /* The move is queued right away since the app may not end the last command, if the queue is full it is dropped the same as a missed button press */
+        if (voice_moves.push(voice_parse_move)) {
+          voice_move_times.push(voice_rx_time);
+        }
+        voice_parse_state = VOICE_PARSE_END;
+      }
+      else {
+        voice_parse_state = terminator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_END:
+      /* Anything run into the end of the move is skipped until the next command */
+      voice_parse_state = separator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      break;
+    case VOICE_PARSE_DISCARD:
+    default:
+      if (terminator) {
+        voice_parse_state = VOICE_PARSE_FROM_ROW;
+      }
+      break;
+  }
+}
+
+/**
+ * Runs a block of received bytes through the command parser
+ *
+ * @param received_data: The bytes received from the BLE application
+ * @param length: The number of bytes received
+ */
+void VoiceRecognition_ParseBytes(const char *received_data, int length) {
+  for (int i = 0; i < length; i++) {
+    VoiceRecognition_ParseByte(received_data[i]);
   }
 }
 
@@ -94,6 +277,9 @@ void VoiceRecognition_Init() {
     VoiceRecognition_OutputError(F("Couldn't factory reset"));
   }
 
+  /* Turn on the battery service, which resets the module so it is done before any other setting, the game runs without it if it fails */
+  voice_battery_enabled = ble_battery.begin(true);
+
   /* Disable command echo from Bluefruit */
   ble.echo(false);
 
@@ -102,31 +288,92 @@ void VoiceRecognition_Init() {
 
   /* Set Bluefruit to DATA mode */
   ble.setMode(BLUEFRUIT_MODE_DATA);
+
+  /* Watch the IRQ line so replies are only read once the module has them ready */
+  attachInterrupt(digitalPinToInterrupt(ble.irqPin()), VoiceRecognition_IrqHandler, RISING);
+  voice_connected = ble.isConnected();
+  voice_connection_check_time = millis();
 }
 
 /**
- * Receives checker move from BLE and parse to return to IO
+ * Receives any new data from BLE and returns the oldest parsed checker move
  *
- * @param parsed_checker_move: The String that returns a checker move 
+ * @param checker_move: The parsed checker move
+ * @return bool: If there was a checker move
+ * @note Never waits on the BLE module, a read request is sent and its reply is collected on a later call once IRQ is raised
  */
-void VoiceRecognition_GetInput(String &parsed_checker_move) {
-  String checker_move = "";
-
-  /* Check for data if BLE is connected */
-  if (ble.isConnected()) {
-    while (ble.available()) {
-      /* Read and process incoming data */
-      char received_data = ble.read();
-      checker_move += received_data;
-
-      /* Print the received data */
-      Serial.print("Received Data: ");
-      Serial.println(received_data);
+bool VoiceRecognition_GetInput(Move &checker_move) {
+  unsigned long now = millis();
+
+  /* Collect the reply to the read request once the module raises IRQ, pulling all of its packets into the RX FIFO at once */
+  if (voice_rx_pending) {
+    if (voice_irq_flag) {
+      voice_irq_flag = false;
+      voice_rx_pending = !VoiceRecognition_PollRx();
     }
+
+    /* Ask again if the reply never came, checking the IRQ line in case the edge was missed */
+    if (voice_rx_pending && now - voice_rx_request_time >= VOICE_RX_TIMEOUT) {
+      VoiceRecognition_PollRx();
+      voice_rx_pending = false;
+    }
+  }
+
+  /* Parse whatever is in the RX FIFO, which needs no SPI transfer */
+  int length;
+  voice_rx_time = micros();
+  while ((length = ble.readBuffered((uint8_t *)voice_rx_buffer, VOICE_RX_BUFFER_SIZE)) > 0) {
+    /* Receiving data means there is a connection */
+    voice_connected = true;
+    VoiceRecognition_ParseBytes(voice_rx_buffer, length);
   }
 
-  VoiceRecognition_ParseMoves(checker_move, parsed_checker_move);
+  if (!voice_rx_pending) {
+    /* A new battery level is only sent with no read request waiting, since the reply to the AT command would be mixed into the reply to the read */
+    if (voice_battery_level >= 0) {
+      if (voice_battery_enabled) {
+        VoiceRecognition_UpdateBattery(voice_battery_level);
+      }
+      voice_battery_level = -1;
+    }
 
-  /* Print the parsed move */
-  Serial.println(parsed_checker_move);
+    /* Refresh the cached connection state every so often instead of on every call, since it is a full AT command round trip */
+    if (now - voice_connection_check_time >= VOICE_CONNECTION_CHECK_TIME) {
+      voice_connected = VoiceRecognition_IsConnected();
+      voice_connection_check_time = now;
+    }
+
+    /* Ask for the next data, only while there is a connection to receive it from */
+    if (voice_connected && VoiceRecognition_RequestRx()) {
+      voice_rx_pending = true;
+      voice_rx_request_time = now;
+    }
+  }
+
+  if (voice_moves.available() == 0) {
+    return false;
+  }
+
+  checker_move = voice_moves.pop();
+  voice_input_time = voice_move_times.pop();
+  return true;
+}
+
+/**
+ * Queues the battery level to be sent to the app over the BLE battery service
+ *
+ * @param percent: The battery level from 0 to 100%
+ * @note Sent by the next VoiceRecognition_GetInput call that has no read request waiting, only call from the core polling voice input
+ */
+void VoiceRecognition_SetBatteryLevel(int percent) {
+  voice_battery_level = percent;
+}
+
+/**
+ * Retrieves when the move last returned by VoiceRecognition_GetInput arrived
+ *
+ * @return unsigned long: The micros() time its bytes were read off the BLE module
+ */
+unsigned long VoiceRecognition_GetInputTime() {
+  return voice_input_time;
 }
@@ -507,6 +507,53 @@ void Adafruit_BluefruitLE_SPI::flush(void)
   m_rx_fifo.clear();
 }
 
+/******************************************************************************/
+/*!
+    @brief  Ask Bluefruit for any BLE UART data without waiting for the reply.
+            The reply is collected by pollRx() once the IRQ line is asserted,
+            so the caller never spins in getPacket().
+
+    @return 'true' if the request was sent, otherwise 'false'
+*/
+/******************************************************************************/
+bool Adafruit_BluefruitLE_SPI::requestRx(void)
+{
+  return sendPacket(SDEP_CMDTYPE_BLE_UARTRX, NULL, 0, 0);
+}
+
+/******************************************************************************/
+/*!
+    @brief  If Bluefruit has asserted IRQ, pull every pending SDEP packet into
+            the RX FIFO in one go (as many as the FIFO can hold)
+
+    @return 'true' if a reply was collected, 'false' if IRQ is not asserted or
+            the transfer failed
+*/
+/******************************************************************************/
+bool Adafruit_BluefruitLE_SPI::pollRx(void)
+{
+  if ( !digitalRead(m_irq_pin) ) return false;
+
+  return getResponse();
+}
+
+/******************************************************************************/
+/*!
+    @brief  Copy data already in the RX FIFO without any SPI transaction
+
+    @param[out] buffer
+                Memory location where the data is copied to
+    @param[in]  size
+                Size of buffer
+
+    @return number of bytes copied
+*/
+/******************************************************************************/
+uint16_t Adafruit_BluefruitLE_SPI::readBuffered(uint8_t* buffer, uint16_t size)
+{
+  return m_rx_fifo.read_n(buffer, size);
+}
+
 /******************************************************************************/
 /*!
     @brief  Try to perform an full AT response transfer from Bluefruit, or execute
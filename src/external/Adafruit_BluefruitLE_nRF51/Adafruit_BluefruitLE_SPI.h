@@ -109,6 +109,12 @@ class Adafruit_BluefruitLE_SPI : public Adafruit_BLE
     virtual int  read(void);
     virtual void flush(void);
     virtual int  peek(void);
+
+    // Non-blocking BLE UART RX, the reply is collected once IRQ is asserted
+    int8_t   irqPin(void) { return m_irq_pin; }
+    bool     requestRx(void);
+    bool     pollRx(void);
+    uint16_t readBuffered(uint8_t* buffer, uint16_t size);
 };
 
 #endif
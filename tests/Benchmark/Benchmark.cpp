@@ -0,0 +1,374 @@
+/************************************************************
+ * @file Benchmark.cpp
+ * @brief Runs the host benchmarks, timing each case until it has run long enough to give a stable ns/op and cycles/op
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Benchmark.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**********************************
+ ** Defines
+ **********************************/
+#define BENCHMARK_MAX_REPETITIONS (32)         /* The most times a case can be repeated */
+#define BENCHMARK_MAX_ITERATIONS  (1000000000) /* The most operations a single run of a case can do */
+#define BENCHMARK_MAX_GROWTH      (10)         /* The most the iterations can grow by between runs */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* How the results are printed */
+enum BenchmarkFormat {
+  BENCHMARK_FORMAT_TEXT, /* A table to read */
+  BENCHMARK_FORMAT_CSV,  /* A CSV line per case */
+  BENCHMARK_FORMAT_JSON  /* A JSON document with a context and a result per case */
+};
+
+/* The settings for a run, from the command line */
+struct BenchmarkOptions {
+  const char *filter;      /* Only cases with this in their name are run (0 for every case) */
+  double      min_time;    /* The time each repetition of a case has to run for in s */
+  int         repetitions; /* The number of times each case is run, reporting the median */
+  int         format;      /* The BenchmarkFormat to print the results in */
+  bool        list;        /* Indicator for if the case names are printed instead of run */
+};
+
+/* The result of a case */
+struct BenchmarkResult {
+  const char   *name;           /* The name of the case */
+  unsigned long iterations;     /* The operations in each repetition */
+  double        ns_per_op;      /* The median time per operation in ns */
+  double        cycles_per_op;  /* The CPU cycles per operation in the median repetition */
+  double        wire_ns_per_op; /* The modelled time on the board's wires per operation in ns (0 if not modelled) */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+volatile uint32_t benchmark_sink = 0;
+
+/* Every suite, in the order they run */
+const BenchmarkCase *benchmark_suites[] = {engine_benchmarks, io_benchmarks};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+uint64_t        Benchmark_GetTime();
+uint64_t        Benchmark_GetCycles();
+const char     *Benchmark_GetCycleCounter();
+void            Benchmark_Run(const BenchmarkCase &benchmark, unsigned long iterations, BenchmarkState &state);
+BenchmarkResult Benchmark_Measure(const BenchmarkCase &benchmark, const BenchmarkOptions &options);
+void            Benchmark_PrintHeader(const BenchmarkOptions &options);
+void            Benchmark_PrintResult(const BenchmarkResult &result, const BenchmarkOptions &options, bool first);
+void            Benchmark_PrintFooter(const BenchmarkOptions &options);
+bool            Benchmark_ParseOptions(int argc, char *argv[], BenchmarkOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Starts (or resumes) timing a case
+ *
+ * @param state: The timer for the run
+ */
+void Benchmark_StartTimer(BenchmarkState &state) {
+  state.start_cycles = Benchmark_GetCycles();
+  state.start_ns = Benchmark_GetTime();
+}
+
+/**
+ * Stops timing a case, adding the time since it was started
+ *
+ * @param state: The timer for the run
+ */
+void Benchmark_StopTimer(BenchmarkState &state) {
+  uint64_t now = Benchmark_GetTime();
+  uint64_t cycles = Benchmark_GetCycles();
+
+  state.elapsed_ns += now - state.start_ns;
+  state.elapsed_cycles += cycles - state.start_cycles;
+}
+
+/**
+ * Advances a xorshift random number generator, which keeps the cases' inputs the same from run to run
+ *
+ * @param state: The state of the generator
+ * @return uint32_t: The next random number
+ */
+uint32_t Benchmark_Random(uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+int main(int argc, char *argv[]) {
+  BenchmarkOptions options;
+  if (!Benchmark_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s [-f filter] [-t min_time_ms] [-r repetitions] [-o text|csv|json] [-l]\n", argv[0]);
+    return 2;
+  }
+
+  bool first = true;
+  if (!options.list) {
+    Benchmark_PrintHeader(options);
+  }
+
+  for (unsigned int i = 0; i < sizeof(benchmark_suites) / sizeof(benchmark_suites[0]); i++) {
+    for (const BenchmarkCase *benchmark = benchmark_suites[i]; benchmark->name != 0; benchmark++) {
+      if (options.filter != 0 && strstr(benchmark->name, options.filter) == 0) {
+        continue;
+      }
+
+      if (options.list) {
+        printf("%s\n", benchmark->name);
+        continue;
+      }
+
+      BenchmarkResult result = Benchmark_Measure(*benchmark, options);
+      Benchmark_PrintResult(result, options, first);
+      fflush(stdout);
+      first = false;
+    }
+  }
+
+  if (!options.list) {
+    Benchmark_PrintFooter(options);
+  }
+
+  return 0;
+}
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return uint64_t: The time in ns
+ */
+uint64_t Benchmark_GetTime() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000ULL + time.tv_nsec;
+}
+
+/**
+ * Retrieves the CPU's cycle counter
+ *
+ * @return uint64_t: The cycle count (0 if the CPU has no cycle counter that can be read)
+ */
+uint64_t Benchmark_GetCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Retrieves the name of the cycle counter, for the results
+ *
+ * @return const char *: The name of the cycle counter
+ */
+const char *Benchmark_GetCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+  return "tsc";
+#else
+  return "none";
+#endif
+}
+
+/**
+ * Runs a case once
+ *
+ * @param benchmark: The case
+ * @param iterations: The number of operations to run
+ * @param state: The timer for the run, which is returned with the time the case measured
+ */
+void Benchmark_Run(const BenchmarkCase &benchmark, unsigned long iterations, BenchmarkState &state) {
+  state.iterations = iterations;
+  state.elapsed_ns = 0;
+  state.elapsed_cycles = 0;
+  state.wire_ns = 0;
+  benchmark.function(state);
+}
+
+/**
+ * Grows the iterations of a case until a run takes the minimum time, then repeats it and takes the median
+ *
+ * @param benchmark: The case
+ * @param options: The settings for the run
+ * @return BenchmarkResult: The result of the case
+ */
+BenchmarkResult Benchmark_Measure(const BenchmarkCase &benchmark, const BenchmarkOptions &options) {
+  uint64_t min_time = (uint64_t)(options.min_time * 1e9);
+  unsigned long iterations = 1;
+  BenchmarkState state;
+
+  /* The first runs also warm the caches and build any inputs the case keeps between runs */
+  Benchmark_Run(benchmark, iterations, state);
+  while (state.elapsed_ns < min_time && iterations < BENCHMARK_MAX_ITERATIONS) {
+    double growth = (state.elapsed_ns > 0) ? (1.4 * min_time / state.elapsed_ns) : BENCHMARK_MAX_GROWTH;
+    if (growth > BENCHMARK_MAX_GROWTH) {
+      growth = BENCHMARK_MAX_GROWTH;
+    }
+    if (growth < 2) {
+      growth = 2;
+    }
+
+    iterations = (unsigned long)(iterations * growth);
+    if (iterations > BENCHMARK_MAX_ITERATIONS) {
+      iterations = BENCHMARK_MAX_ITERATIONS;
+    }
+    Benchmark_Run(benchmark, iterations, state);
+  }
+
+  /* Repeat the case, sorting the repetitions by their time so the median can be taken */
+  double ns_per_op[BENCHMARK_MAX_REPETITIONS];
+  double cycles_per_op[BENCHMARK_MAX_REPETITIONS];
+  double wire_ns_per_op = (double)state.wire_ns / iterations;
+  for (int i = 0; i < options.repetitions; i++) {
+    if (i > 0) {
+      Benchmark_Run(benchmark, iterations, state);
+    }
+
+    double ns = (double)state.elapsed_ns / iterations;
+    double cycles = (double)state.elapsed_cycles / iterations;
+    int j = i;
+    while (j > 0 && ns_per_op[j - 1] > ns) {
+      ns_per_op[j] = ns_per_op[j - 1];
+      cycles_per_op[j] = cycles_per_op[j - 1];
+      j--;
+    }
+    ns_per_op[j] = ns;
+    cycles_per_op[j] = cycles;
+  }
+
+  BenchmarkResult result;
+  result.name = benchmark.name;
+  result.iterations = iterations;
+  result.ns_per_op = ns_per_op[options.repetitions / 2];
+  result.cycles_per_op = cycles_per_op[options.repetitions / 2];
+  result.wire_ns_per_op = wire_ns_per_op;
+  return result;
+}
+
+/**
+ * Prints what comes before the results
+ *
+ * @param options: The settings for the run
+ */
+void Benchmark_PrintHeader(const BenchmarkOptions &options) {
+  if (options.format == BENCHMARK_FORMAT_TEXT) {
+    printf("%-*s %12s %12s %12s %14s %12s\n", BENCHMARK_NAME_SIZE, "Benchmark", "Iterations", "ns/op", "cycles/op", "ops/s", "wire ns/op");
+  }
+  else if (options.format == BENCHMARK_FORMAT_CSV) {
+    printf("name,iterations,ns_per_op,cycles_per_op,ops_per_s,wire_ns_per_op\n");
+  }
+  else {
+    printf("{\n  \"context\": {\"cycle_counter\": \"%s\", \"min_time_ms\": %.0f, \"repetitions\": %d, \"cpus\": %ld},\n",
+           Benchmark_GetCycleCounter(), options.min_time * 1000, options.repetitions, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("  \"benchmarks\": [");
+  }
+}
+
+/**
+ * Prints the result of a case
+ *
+ * @param result: The result
+ * @param options: The settings for the run
+ * @param first: Indicator for if this is the first result printed
+ */
+void Benchmark_PrintResult(const BenchmarkResult &result, const BenchmarkOptions &options, bool first) {
+  double ops_per_s = (result.ns_per_op > 0) ? 1e9 / result.ns_per_op : 0;
+
+  if (options.format == BENCHMARK_FORMAT_TEXT) {
+    printf("%-*s %12lu %12.1f %12.1f %14.0f %12.0f\n", BENCHMARK_NAME_SIZE, result.name, result.iterations, result.ns_per_op,
+           result.cycles_per_op, ops_per_s, result.wire_ns_per_op);
+  }
+  else if (options.format == BENCHMARK_FORMAT_CSV) {
+    printf("%s,%lu,%.2f,%.2f,%.0f,%.0f\n", result.name, result.iterations, result.ns_per_op, result.cycles_per_op, ops_per_s,
+           result.wire_ns_per_op);
+  }
+  else {
+    printf("%s\n    {\"name\": \"%s\", \"iterations\": %lu, \"ns_per_op\": %.2f, \"cycles_per_op\": %.2f, \"ops_per_s\": %.0f, \"wire_ns_per_op\": %.0f}",
+           first ? "" : ",", result.name, result.iterations, result.ns_per_op, result.cycles_per_op, ops_per_s, result.wire_ns_per_op);
+  }
+}
+
+/**
+ * Prints what comes after the results
+ *
+ * @param options: The settings for the run
+ */
+void Benchmark_PrintFooter(const BenchmarkOptions &options) {
+  if (options.format == BENCHMARK_FORMAT_JSON) {
+    printf("\n  ]\n}\n");
+  }
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool Benchmark_ParseOptions(int argc, char *argv[], BenchmarkOptions &options) {
+  options.filter = 0;
+  options.min_time = 0.1;
+  options.repetitions = 5;
+  options.format = BENCHMARK_FORMAT_TEXT;
+  options.list = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "f:t:r:o:l")) != -1) {
+    switch (option) {
+      case 'f':
+        options.filter = optarg;
+        break;
+      case 't':
+        options.min_time = atof(optarg) / 1000;
+        break;
+      case 'r':
+        options.repetitions = atoi(optarg);
+        break;
+      case 'o':
+        if (strcmp(optarg, "text") == 0) {
+          options.format = BENCHMARK_FORMAT_TEXT;
+        }
+        else if (strcmp(optarg, "csv") == 0) {
+          options.format = BENCHMARK_FORMAT_CSV;
+        }
+        else if (strcmp(optarg, "json") == 0) {
+          options.format = BENCHMARK_FORMAT_JSON;
+        }
+        else {
+          return false;
+        }
+        break;
+      case 'l':
+        options.list = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return options.min_time > 0 && options.repetitions > 0 && options.repetitions <= BENCHMARK_MAX_REPETITIONS;
+}
@@ -0,0 +1,56 @@
+/************************************************************
+ * @file Benchmark.h
+ * @brief The header for the host benchmark harness, which times registered cases in ns and CPU cycles per operation
+ ************************************************************/
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdint.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define BENCHMARK_NAME_SIZE (48) /* The longest name a benchmark case can have */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The timer for one run of a benchmark case, which the case starts and stops around the code being measured */
+struct BenchmarkState {
+  unsigned long iterations;     /* The number of operations the case must run */
+  uint64_t      elapsed_ns;     /* The time measured so far in ns */
+  uint64_t      elapsed_cycles; /* The CPU cycles measured so far (0 if the CPU has no cycle counter) */
+  uint64_t      start_ns;       /* The time the timer was started at in ns */
+  uint64_t      start_cycles;   /* The cycle count the timer was started at */
+  uint64_t      wire_ns;        /* The time the operations would spend on the board's wires in ns, for cases that model it */
+};
+
+/* A benchmark case, which runs state.iterations operations */
+typedef void (*BenchmarkFunction)(BenchmarkState &state);
+
+/* A registered benchmark case */
+struct BenchmarkCase {
+  const char       *name;     /* The name of the case, as Group/Case */
+  BenchmarkFunction function; /* The function that runs the case */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+extern volatile uint32_t benchmark_sink; /* Cases add their results here so the compiler cannot drop the work */
+
+/* The cases of each suite, ending with a case with no name */
+extern const BenchmarkCase engine_benchmarks[];
+extern const BenchmarkCase io_benchmarks[];
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+void     Benchmark_StartTimer(BenchmarkState &state);
+void     Benchmark_StopTimer(BenchmarkState &state);
+uint32_t Benchmark_Random(uint32_t &state);
+
+#endif /* BENCHMARK_H */
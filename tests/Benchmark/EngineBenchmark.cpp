@@ -0,0 +1,446 @@
+/************************************************************
+ * @file EngineBenchmark.cpp
+ * @brief The benchmarks for the game algorithm's hot paths, run over a corpus of mid-game positions
+ * @note The positions come from seeded random games, so every run (and every engine change) times the same inputs
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Benchmark.h"
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define ENGINE_CORPUS_SIZE (256)    /* The number of positions in each corpus */
+#define ENGINE_BATCH_SIZE  (256)    /* The number of games copied, untimed, before each timed batch of turns */
+#define ENGINE_MAX_MOVES   (96)     /* The most legal moves a position can have (12 pieces with 8 targets each) */
+#define ENGINE_MAX_CHAIN   (12)     /* The most jumps a multi-jump can take */
+#define ENGINE_MIN_PLY     (10)     /* The first ply positions are taken from, past the opening */
+#define ENGINE_MAX_PLY     (120)    /* The last ply positions are taken from */
+#define ENGINE_SAMPLE_RATE (8)      /* One in this many positions is kept, so the corpus spans many games */
+#define ENGINE_MAX_GAMES   (100000) /* The most games played to fill the corpus */
+#define ENGINE_SEED        (12345)  /* The seed of the games */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A position with the moves to play from it */
+struct EnginePosition {
+  Checkers game;                    /* The game at the position */
+  Move     moves[ENGINE_MAX_CHAIN]; /* The moves played from the position, one per turn call */
+  int      move_count;              /* The number of moves */
+};
+
+/* A set of positions */
+struct EngineCorpus {
+  EnginePosition positions[ENGINE_CORPUS_SIZE]; /* The positions */
+  int            count;                         /* The number of positions */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The corpora, built on first use */
+bool         engine_corpus_loaded = false;
+EngineCorpus engine_mid_game;   /* Positions with a random piece of the active player as the move (for the checks) */
+EngineCorpus engine_valid;      /* Positions with a valid simple move */
+EngineCorpus engine_invalid;    /* Positions with an invalid move */
+EngineCorpus engine_jump;       /* Positions with a jump that ends the turn */
+EngineCorpus engine_multi_jump; /* Positions with a chain of two or more jumps */
+
+/* The games the turn cases play on, copied from the corpus before each timed batch */
+Checkers              engine_games[ENGINE_BATCH_SIZE];
+const EnginePosition *engine_batch[ENGINE_BATCH_SIZE];
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+int  Engine_GetLegalMoves(Checkers &game, Move (&moves)[ENGINE_MAX_MOVES]);
+bool Engine_IsJump(Move move);
+void Engine_AddPosition(EngineCorpus &corpus, Checkers &game, const Move *moves, int move_count);
+void Engine_SamplePosition(Checkers &game, Move (&moves)[ENGINE_MAX_MOVES], int move_count, uint32_t &random_state);
+void Engine_LoadCorpus();
+void Engine_RunTurns(BenchmarkState &state, const EngineCorpus &corpus);
+void Engine_BenchTurnValid(BenchmarkState &state);
+void Engine_BenchTurnInvalid(BenchmarkState &state);
+void Engine_BenchTurnJump(BenchmarkState &state);
+void Engine_BenchTurnMultiJump(BenchmarkState &state);
+void Engine_BenchCanJump(BenchmarkState &state);
+void Engine_BenchHasMove(BenchmarkState &state);
+void Engine_BenchTurnOver(BenchmarkState &state);
+void Engine_BenchCopy(BenchmarkState &state);
+void Engine_BenchLegalMoves(BenchmarkState &state);
+
+/**********************************
+ ** Benchmark Cases
+ **********************************/
+const BenchmarkCase engine_benchmarks[] = {
+  {"Checkers_Turn/Valid",     Engine_BenchTurnValid},
+  {"Checkers_Turn/Invalid",   Engine_BenchTurnInvalid},
+  {"Checkers_Turn/Jump",      Engine_BenchTurnJump},
+  {"Checkers_Turn/MultiJump", Engine_BenchTurnMultiJump},
+  {"Checkers_CanJump",        Engine_BenchCanJump},
+  {"Checkers_HasMove",        Engine_BenchHasMove},
+  {"Checkers_TurnOver",       Engine_BenchTurnOver},
+  {"Checkers/Copy",           Engine_BenchCopy},
+  {"Checkers/LegalMoves",     Engine_BenchLegalMoves},
+  {0, 0}
+};
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Finds every legal move by trying each diagonal step and jump on a copy of the game, the same as the Simulator
+ *
+ * @param game: The game
+ * @param moves: The legal moves found
+ * @return int: The number of legal moves
+ */
+int Engine_GetLegalMoves(Checkers &game, Move (&moves)[ENGINE_MAX_MOVES]) {
+  const int steps[8][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}, {-2, -2}, {-2, 2}, {2, -2}, {2, 2}};
+  int player = game.Checkers_GetActivePlayer();
+  int move_count = 0;
+
+  for (int row = 0; row < MOVE_BOARD_SIZE; row++) {
+    for (int col = 0; col < MOVE_BOARD_SIZE; col++) {
+      /* Player 1's pieces are 1 and 3, player 2's are 2 and 4 */
+      int piece = game.Checkers_GetBoardAt(row, col);
+      if (piece == 0 || (piece - 1) % 2 != player - 1) {
+        continue;
+      }
+
+      for (int i = 0; i < 8 && move_count < ENGINE_MAX_MOVES; i++) {
+        Square to = Move_MakeSquare(row + steps[i][0], col + steps[i][1]);
+        if (to == SQUARE_NONE) {
+          continue;
+        }
+
+        Checkers trial = game;
+        Move move = Move_Make(Move_MakeSquare(row, col), to);
+        if (trial.Checkers_Turn(move) == 1) {
+          moves[move_count++] = move;
+        }
+      }
+    }
+  }
+
+  return move_count;
+}
+
+/**
+ * Checks if a move is a jump
+ *
+ * @param move: The move
+ * @return bool: If the move goes two rows
+ */
+bool Engine_IsJump(Move move) {
+  return abs(Move_GetRow(move.to) - Move_GetRow(move.from)) == 2;
+}
+
+/**
+ * Adds a position to a corpus, if it has room
+ *
+ * @param corpus: The corpus
+ * @param game: The game at the position
+ * @param moves: The moves to play from the position
+ * @param move_count: The number of moves
+ */
+void Engine_AddPosition(EngineCorpus &corpus, Checkers &game, const Move *moves, int move_count) {
+  if (corpus.count >= ENGINE_CORPUS_SIZE) {
+    return;
+  }
+
+  EnginePosition &position = corpus.positions[corpus.count++];
+  position.game = game;
+  position.move_count = move_count;
+  for (int i = 0; i < move_count; i++) {
+    position.moves[i] = moves[i];
+  }
+}
+
+/**
+ * Sorts a position into the corpora its moves fit
+ *
+ * @param game: The game at the position
+ * @param moves: The legal moves of the position
+ * @param move_count: The number of legal moves
+ * @param random_state: The state of the random number generator
+ */
+void Engine_SamplePosition(Checkers &game, Move (&moves)[ENGINE_MAX_MOVES], int move_count, uint32_t &random_state) {
+  Move picked = moves[Benchmark_Random(random_state) % move_count];
+
+  /* Jumps are rare, so every one is kept until the jump corpora are full */
+  if (Engine_IsJump(picked)) {
+    Move chain[ENGINE_MAX_CHAIN];
+    int chain_length = 0;
+    Checkers trial = game;
+
+    /* Follow the jump with random jumps while the turn is locked to the jumping piece */
+    chain[chain_length++] = picked;
+    trial.Checkers_Turn(picked);
+    while (trial.jump_lock[2] == 1 && trial.Checkers_GetWin() == 0 && chain_length < ENGINE_MAX_CHAIN) {
+      Move next_moves[ENGINE_MAX_MOVES];
+      int next_count = Engine_GetLegalMoves(trial, next_moves);
+      chain[chain_length] = next_moves[Benchmark_Random(random_state) % next_count];
+      trial.Checkers_Turn(chain[chain_length++]);
+    }
+
+    if (chain_length == 1) {
+      Engine_AddPosition(engine_jump, game, chain, 1);
+    }
+    else if (trial.jump_lock[2] == 0) {
+      Engine_AddPosition(engine_multi_jump, game, chain, chain_length);
+    }
+  }
+
+  if (Benchmark_Random(random_state) % ENGINE_SAMPLE_RATE != 0) {
+    return;
+  }
+
+  /* The checks are timed against a random piece of the active player, as if it had just landed there */
+  Square pieces[ENGINE_MAX_MOVES];
+  Move check;
+  for (int i = 0; i < move_count; i++) {
+    pieces[i] = moves[i].from;
+  }
+  check.from = pieces[Benchmark_Random(random_state) % move_count];
+  check.to = check.from;
+  Engine_AddPosition(engine_mid_game, game, &check, 1);
+
+  if (!Engine_IsJump(picked)) {
+    Engine_AddPosition(engine_valid, game, &picked, 1);
+  }
+
+  /* An invalid move between two dark squares, which the game rejects */
+  Move invalid;
+  do {
+    int from = Benchmark_Random(random_state) % 32;
+    int to = Benchmark_Random(random_state) % 32;
+    invalid.from = Move_MakeSquare(from / 4, (from % 4) * 2 + (from / 4) % 2);
+    invalid.to = Move_MakeSquare(to / 4, (to % 4) * 2 + (to / 4) % 2);
+
+    Checkers trial = game;
+    if (invalid.from != invalid.to && trial.Checkers_Turn(invalid) == 0) {
+      break;
+    }
+  } while (true);
+  Engine_AddPosition(engine_invalid, game, &invalid, 1);
+}
+
+/**
+ * Builds the corpora from seeded random games, the first time a case needs them
+ *
+ */
+void Engine_LoadCorpus() {
+  if (engine_corpus_loaded) {
+    return;
+  }
+
+  uint32_t random_state = ENGINE_SEED;
+  int games = 0;
+
+  while ((engine_mid_game.count < ENGINE_CORPUS_SIZE || engine_valid.count < ENGINE_CORPUS_SIZE ||
+          engine_invalid.count < ENGINE_CORPUS_SIZE || engine_jump.count < ENGINE_CORPUS_SIZE ||
+          engine_multi_jump.count < ENGINE_CORPUS_SIZE) && games < ENGINE_MAX_GAMES) {
+    Checkers game;
+    games++;
+
+    for (int ply = 0; ply <= ENGINE_MAX_PLY && game.Checkers_GetWin() == 0; ply++) {
+      Move moves[ENGINE_MAX_MOVES];
+      int move_count = Engine_GetLegalMoves(game, moves);
+      if (move_count == 0) {
+        break;
+      }
+
+      if (ply >= ENGINE_MIN_PLY) {
+        Engine_SamplePosition(game, moves, move_count, random_state);
+      }
+
+      game.Checkers_Turn(moves[Benchmark_Random(random_state) % move_count]);
+    }
+  }
+
+  /* Every case needs at least one position, or the corpus settings are wrong */
+  if (engine_mid_game.count == 0 || engine_valid.count == 0 || engine_invalid.count == 0 ||
+      engine_jump.count == 0 || engine_multi_jump.count == 0) {
+    fprintf(stderr, "the engine corpus could not be filled from %d games\n", games);
+    exit(2);
+  }
+
+  engine_corpus_loaded = true;
+}
+
+/**
+ * Times the turns of a corpus, copying each position before its batch so every turn starts from the corpus
+ *
+ * @param state: The timer for the run
+ * @param corpus: The positions and the moves to play from them
+ */
+void Engine_RunTurns(BenchmarkState &state, const EngineCorpus &corpus) {
+  unsigned long done = 0;
+  int next = 0;
+
+  while (done < state.iterations) {
+    int batch = (state.iterations - done < ENGINE_BATCH_SIZE) ? (int)(state.iterations - done) : ENGINE_BATCH_SIZE;
+
+    for (int i = 0; i < batch; i++) {
+      engine_games[i] = corpus.positions[next].game;
+      engine_batch[i] = &corpus.positions[next];
+      next = (next + 1) % corpus.count;
+    }
+
+    Benchmark_StartTimer(state);
+    for (int i = 0; i < batch; i++) {
+      for (int j = 0; j < engine_batch[i]->move_count; j++) {
+        benchmark_sink += engine_games[i].Checkers_Turn(engine_batch[i]->moves[j]);
+      }
+    }
+    Benchmark_StopTimer(state);
+
+    done += batch;
+  }
+}
+
+/**
+ * Times a valid simple move
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchTurnValid(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  Engine_RunTurns(state, engine_valid);
+}
+
+/**
+ * Times a move the game rejects
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchTurnInvalid(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  Engine_RunTurns(state, engine_invalid);
+}
+
+/**
+ * Times a jump that ends the turn
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchTurnJump(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  Engine_RunTurns(state, engine_jump);
+}
+
+/**
+ * Times a whole multi-jump, so one operation is every jump of the chain
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchTurnMultiJump(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  Engine_RunTurns(state, engine_multi_jump);
+}
+
+/**
+ * Times the check for a jump anywhere on the board
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchCanJump(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  int next = 0;
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    benchmark_sink += engine_mid_game.positions[next].game.Checkers_CanJump();
+    next = (next + 1 == engine_mid_game.count) ? 0 : next + 1;
+  }
+  Benchmark_StopTimer(state);
+}
+
+/**
+ * Times the check for the other player having a move
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchHasMove(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  int next = 0;
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    benchmark_sink += engine_mid_game.positions[next].game.Checkers_HasMove();
+    next = (next + 1 == engine_mid_game.count) ? 0 : next + 1;
+  }
+  Benchmark_StopTimer(state);
+}
+
+/**
+ * Times the check for a piece having another jump
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchTurnOver(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  int squares[ENGINE_CORPUS_SIZE][2];
+  int next = 0;
+
+  for (int i = 0; i < engine_mid_game.count; i++) {
+    squares[i][0] = Move_GetRow(engine_mid_game.positions[i].moves[0].to);
+    squares[i][1] = Move_GetCol(engine_mid_game.positions[i].moves[0].to);
+  }
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    benchmark_sink += engine_mid_game.positions[next].game.Checkers_TurnOver(squares[next]);
+    next = (next + 1 == engine_mid_game.count) ? 0 : next + 1;
+  }
+  Benchmark_StopTimer(state);
+}
+
+/**
+ * Times copying a game, which the handoff snapshot and every trial move do
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchCopy(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  int next = 0;
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    engine_games[i % ENGINE_BATCH_SIZE] = engine_mid_game.positions[next].game;
+    next = (next + 1 == engine_mid_game.count) ? 0 : next + 1;
+  }
+  Benchmark_StopTimer(state);
+
+  benchmark_sink += engine_games[0].Checkers_GetActivePlayer();
+}
+
+/**
+ * Times finding every legal move of a position, which the game algorithm can only do by trying each one
+ *
+ * @param state: The timer for the run
+ */
+void Engine_BenchLegalMoves(BenchmarkState &state) {
+  Engine_LoadCorpus();
+  Move moves[ENGINE_MAX_MOVES];
+  int next = 0;
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    benchmark_sink += Engine_GetLegalMoves(engine_mid_game.positions[next].game, moves);
+    next = (next + 1 == engine_mid_game.count) ? 0 : next + 1;
+  }
+  Benchmark_StopTimer(state);
+}
@@ -0,0 +1,330 @@
+/************************************************************
+ * @file IoBenchmark.cpp
+ * @brief The benchmarks for the I/O pipeline (LED render, button scan and voice command parse) on mocked hardware
+ * @note Io.cpp runs on the counting HAL backend, whose counts are turned into the time the same calls would spend on
+ *       the board's wires. The costs are typical for the ESP32 Arduino core, so they are for comparing drivers with
+ *       each other rather than a stand in for a logic analyzer.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Benchmark.h"
+#include "Checkers.h"
+#include "Hal.h"
+#include "Io.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "circular_queue/circular_queue.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+/* ESP32 costs the wire time is modelled with (ns) */
+#define IO_DIGITAL_WRITE_NS (250)   /* A digitalWrite through the Arduino core */
+#define IO_ANALOG_READ_NS   (10000) /* An analogRead, most of which is the ADC conversion */
+#define IO_BLE_SPI_BIT_NS   (250)   /* A bit on the hardware SPI bus to the Bluefruit module at 4 MHz */
+
+/* Wire costs of the drivers */
+#define IO_SHIFT_WRITES_PER_BIT (3)  /* LedControl's shiftOut writes the data pin and both clock edges for each bit */
+#define IO_SPI_CS_WRITES        (2)  /* LedControl pulls the chip select low and back high around each opcode */
+#define IO_SDEP_PAYLOAD_SIZE    (16) /* The most command bytes in one Bluefruit SDEP packet */
+#define IO_SDEP_HEADER_SIZE     (4)  /* The bytes of each SDEP packet's header */
+
+/* Button array wiring and readings, the same as the PCB */
+#define BUTTON_ARRAY_PIN1 (36)
+#define BUTTON_ARRAY_PIN2 (39)
+#define BUTTON_ARRAY_PIN3 (34)
+#define BUTTON_ARRAY_PIN4 (35)
+
+/* Voice command corpus */
+#define IO_VOICE_COMMANDS     (64)    /* The number of commands */
+#define IO_VOICE_COMMAND_SIZE (8)     /* The longest command, with its terminator */
+#define IO_VOICE_SEED         (54321) /* The seed of the commands */
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The private I/O and voice recognition state */
+extern HalLedChip                    red_lc;
+extern HalLedChip                    blue_lc;
+extern HalLedChip                    green_lc;
+extern circular_queue<Move>          voice_moves;
+extern circular_queue<unsigned long> voice_move_times;
+
+/* The voice commands, as the app sends them */
+bool io_voice_loaded = false;
+char io_voice_commands[IO_VOICE_COMMANDS][IO_VOICE_COMMAND_SIZE];
+int  io_voice_lengths[IO_VOICE_COMMANDS];
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+/* Private functions of Io.cpp and VoiceRecognition.cpp */
+void IO_MapToMaxChip(int row, int col, int &max_row, int &max_col);
+void VoiceRecognition_ParseBytes(const char *received_data, int length);
+
+uint64_t Io_GetWireTime(const HalCounters &counters);
+void     Io_SetHWGameMapRows(Checkers &checker_game);
+bool     Io_LedsMatch(Checkers &checker_game);
+void     Io_LoadVoiceCommands();
+void     Io_BenchSetHWGameMap(BenchmarkState &state);
+void     Io_BenchSetHWGameMapRows(BenchmarkState &state);
+void     Io_BenchGetButtonInputNoPress(BenchmarkState &state);
+void     Io_BenchGetButtonInputPress(BenchmarkState &state);
+void     Io_BenchParseVoiceCommand(BenchmarkState &state);
+
+/**********************************
+ ** Benchmark Cases
+ **********************************/
+const BenchmarkCase io_benchmarks[] = {
+  {"IO_SetHWGameMap",             Io_BenchSetHWGameMap},
+  {"IO_SetHWGameMap/RowDriver",   Io_BenchSetHWGameMapRows},
+  {"IO_GetButtonInput/NoPress",   Io_BenchGetButtonInputNoPress},
+  {"IO_GetButtonInput/Press",     Io_BenchGetButtonInputPress},
+  {"VoiceRecognition_ParseBytes", Io_BenchParseVoiceCommand},
+  {0, 0}
+};
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Works out the time the counted calls would spend on the board's wires
+ *
+ * @param counters: The calls counted by the HAL
+ * @return uint64_t: The wire time in ns
+ */
+uint64_t Io_GetWireTime(const HalCounters &counters) {
+  /* Every LED chip opcode is bit-banged, so each bit (two clock edges) costs three pin writes */
+  uint64_t writes = counters.digital_write_calls + counters.spi_bytes * 8 * IO_SHIFT_WRITES_PER_BIT +
+                    counters.spi_transfers * IO_SPI_CS_WRITES;
+
+  return writes * IO_DIGITAL_WRITE_NS + counters.analog_read_calls * IO_ANALOG_READ_NS;
+}
+
+/**
+ * An alternative game map driver, which sends each MAX chip row once instead of one opcode per LED
+ *
+ * @param checker_game: The checker game that the board is being retrieved from
+ */
+void Io_SetHWGameMapRows(Checkers &checker_game) {
+  uint8_t red_rows[8] = {0};
+  uint8_t green_rows[8] = {0};
+  uint8_t blue_rows[8] = {0};
+  int max_row = -1;
+  int max_col = -1;
+
+  for (int row = 0; row < 8; row++) {
+    for (int col = (row % 2); col < 8; col = col + 2) {
+      IO_MapToMaxChip(row, col, max_row, max_col);
+      uint8_t bit = 0x80 >> max_col;
+
+      /* Player 1 is red, player 2 is blue, player 1's kings are yellow and player 2's kings are light blue */
+      switch (checker_game.Checkers_GetBoardAt(row, col)) {
+        case 1:
+          red_rows[max_row] |= bit;
+          break;
+        case 2:
+          blue_rows[max_row] |= bit;
+          break;
+        case 3:
+          red_rows[max_row] |= bit;
+          green_rows[max_row] |= bit;
+          break;
+        case 4:
+          green_rows[max_row] |= bit;
+          blue_rows[max_row] |= bit;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  for (int i = 0; i < 8; i++) {
+    red_lc.setRow(0, i, red_rows[i]);
+    green_lc.setRow(0, i, green_rows[i]);
+    blue_lc.setRow(0, i, blue_rows[i]);
+  }
+}
+
+/**
+ * Checks the two game map drivers light the same LEDs, so they are only compared if they do the same thing
+ *
+ * @param checker_game: The game to draw
+ * @return bool: If both drivers lit the same LEDs
+ */
+bool Io_LedsMatch(Checkers &checker_game) {
+  bool leds[3][8][8];
+
+  IO_SetHWGameMap(checker_game);
+  memcpy(leds[0], red_lc.leds, sizeof(leds[0]));
+  memcpy(leds[1], green_lc.leds, sizeof(leds[1]));
+  memcpy(leds[2], blue_lc.leds, sizeof(leds[2]));
+
+  IO_InitHWGameMap();
+  Io_SetHWGameMapRows(checker_game);
+  return memcmp(leds[0], red_lc.leds, sizeof(leds[0])) == 0 && memcmp(leds[1], green_lc.leds, sizeof(leds[1])) == 0 &&
+         memcmp(leds[2], blue_lc.leds, sizeof(leds[2])) == 0;
+}
+
+/**
+ * Builds the voice commands from seeded random squares, the first time a case needs them
+ *
+ * @note Rows come in either case and commands end with a newline, semicolon or space, as the app sends them. One in
+ *       eight is malformed, so the parser's discard path is timed as well.
+ */
+void Io_LoadVoiceCommands() {
+  if (io_voice_loaded) {
+    return;
+  }
+
+  const char terminators[3] = {'\n', ';', ' '};
+  uint32_t random_state = IO_VOICE_SEED;
+
+  for (int i = 0; i < IO_VOICE_COMMANDS; i++) {
+    char *command = io_voice_commands[i];
+    char base = (Benchmark_Random(random_state) % 2 == 0) ? 'A' : 'a';
+
+    command[0] = base + Benchmark_Random(random_state) % 8;
+    command[1] = '1' + Benchmark_Random(random_state) % 8;
+    command[2] = ' ';
+    command[3] = base + Benchmark_Random(random_state) % 8;
+    command[4] = '1' + Benchmark_Random(random_state) % 8;
+    command[5] = terminators[Benchmark_Random(random_state) % 3];
+    command[6] = '\0';
+
+    if (i % 8 == 7) {
+      command[1] = '9';
+      command[5] = '\n';
+    }
+
+    io_voice_lengths[i] = strlen(command);
+  }
+
+  io_voice_loaded = true;
+}
+
+/**
+ * Times a full redraw of the game map by the shipped driver, so ops/s is its frame rate
+ *
+ * @note The driver sends every LED whatever is on the board, so the starting position is as good as any
+ * @param state: The timer for the run
+ */
+void Io_BenchSetHWGameMap(BenchmarkState &state) {
+  Checkers checkers_game;
+
+  IO_InitHWGameMap();
+  Hal_ResetCounters();
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    IO_SetHWGameMap(checkers_game);
+  }
+  Benchmark_StopTimer(state);
+
+  state.wire_ns = Io_GetWireTime(hal_counters);
+  benchmark_sink += red_lc.leds[0][0];
+}
+
+/**
+ * Times a full redraw of the game map by the row driver
+ *
+ * @param state: The timer for the run
+ */
+void Io_BenchSetHWGameMapRows(BenchmarkState &state) {
+  Checkers checkers_game;
+
+  IO_InitHWGameMap();
+  if (!Io_LedsMatch(checkers_game)) {
+    fprintf(stderr, "the row driver does not light the same LEDs as IO_SetHWGameMap\n");
+    exit(2);
+  }
+  Hal_ResetCounters();
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    Io_SetHWGameMapRows(checkers_game);
+  }
+  Benchmark_StopTimer(state);
+
+  state.wire_ns = Io_GetWireTime(hal_counters);
+  benchmark_sink += red_lc.leds[0][0];
+}
+
+/**
+ * Times a scan of the buttons with none pressed, which is almost every scan
+ *
+ * @param state: The timer for the run
+ */
+void Io_BenchGetButtonInputNoPress(BenchmarkState &state) {
+  Hal_Reset();
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    benchmark_sink += IO_GetButtonInput();
+  }
+  Benchmark_StopTimer(state);
+
+  state.wire_ns = Io_GetWireTime(hal_counters);
+}
+
+/**
+ * Times a scan of the buttons while one is pressed, going through every button in turn
+ *
+ * @param state: The timer for the run
+ */
+void Io_BenchGetButtonInputPress(BenchmarkState &state) {
+  const int pins[4] = {BUTTON_ARRAY_PIN1, BUTTON_ARRAY_PIN2, BUTTON_ARRAY_PIN3, BUTTON_ARRAY_PIN4};
+  const int readings[8] = {20, 145, 525, 1100, 1625, 2050, 2475, 3000};
+  int button = 0;
+
+  Hal_Reset();
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    hal_analog_readings[pins[button / 8]] = readings[button % 8];
+    benchmark_sink += IO_GetButtonInput();
+    hal_analog_readings[pins[button / 8]] = HAL_ANALOG_READ_MAX;
+    button = (button + 1) % 32;
+  }
+  Benchmark_StopTimer(state);
+
+  state.wire_ns = Io_GetWireTime(hal_counters);
+}
+
+/**
+ * Times parsing a voice command from the BLE module and taking the move it queued
+ *
+ * @note The wire time is the command's bytes, with their SDEP packet headers, on the SPI bus from the module
+ * @param state: The timer for the run
+ */
+void Io_BenchParseVoiceCommand(BenchmarkState &state) {
+  Io_LoadVoiceCommands();
+  uint64_t wire_bytes = 0;
+  int next = 0;
+
+  Benchmark_StartTimer(state);
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    VoiceRecognition_ParseBytes(io_voice_commands[next], io_voice_lengths[next]);
+    while (voice_moves.available() > 0) {
+      benchmark_sink += voice_moves.pop().to;
+      voice_move_times.pop();
+    }
+    next = (next + 1) % IO_VOICE_COMMANDS;
+  }
+  Benchmark_StopTimer(state);
+
+  for (unsigned long i = 0; i < state.iterations; i++) {
+    int length = io_voice_lengths[i % IO_VOICE_COMMANDS];
+    wire_bytes += length + ((length + IO_SDEP_PAYLOAD_SIZE - 1) / IO_SDEP_PAYLOAD_SIZE) * IO_SDEP_HEADER_SIZE;
+  }
+  state.wire_ns = wire_bytes * 8 * IO_BLE_SPI_BIT_NS;
+}
@@ -0,0 +1,804 @@
+/************************************************************
+ * @file Simulator.cpp
+ * @brief Runs full games through the unchanged firmware on a virtual board, checking the LEDs against a reference game
+ * @note Each game runs in its own forked process, which gives the firmware fresh globals the same as a reset
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Battery.h"
+#include "Checkers.h"
+#include "Handoff.h"
+#include "Journal.h"
+#include "Latency.h"
+#include "Memory.h"
+#include "Move.h"
+#include "Power.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "VirtualHardware.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+/* Timing of the simulated players (ms) */
+#define SIMULATOR_TICK           (1)    /* The virtual time between calls to loop() */
+#define SIMULATOR_THINK_TIME     (500)  /* The time between moves, longer than the turn switch button lockout */
+#define SIMULATOR_PRESS_TIME     (60)   /* The time a button is held, and then released, for each press */
+#define SIMULATOR_SETTLE_TIMEOUT (1000) /* The longest a move can take to show up on the game map LEDs */
+#define SIMULATOR_INVALID_TIME   (300)  /* The time given for an invalid move to start blinking the turn indicator */
+#define SIMULATOR_WINNER_TIME    (2500) /* The time given for the winner's turn indicator to flash */
+#define SIMULATOR_SERIAL_TIME    (700)  /* The time given for the firmware to answer the Serial commands */
+#define SIMULATOR_GAME_TIMEOUT   (60)   /* The wall time a game process gets before it is treated as hung (s) */
+#define SIMULATOR_BATTERY_TIME   (60000) /* The time given for the battery governor to settle once the batteries stop draining */
+
+/* Battery settings (mV) */
+#define SIMULATOR_FRESH_BATTERY (6400) /* The voltage of fresh batteries */
+#define SIMULATOR_BATTERY_MAX   (6600) /* The battery voltage that reads VIRTUAL_ANALOG_MAX through the divider */
+#define SIMULATOR_DRAIN_PLIES   (40)   /* The number of moves the batteries take to drain to the requested voltage */
+
+/* Game settings */
+#define SIMULATOR_MAX_PLIES   (300) /* The number of moves before a game is called off as a draw */
+#define SIMULATOR_MAX_MOVES   (96)  /* The most legal moves a position can have (12 pieces with 8 targets each) */
+#define SIMULATOR_REASON_SIZE (96)  /* The size of a failure message */
+
+/* Board wiring, the same as the PCB */
+#define BUTTON_ARRAY_PIN1              (36)
+#define BUTTON_ARRAY_PIN2              (39)
+#define BUTTON_ARRAY_PIN3              (34)
+#define BUTTON_ARRAY_PIN4              (35)
+#define PLAYER1_TURN_INDICATOR_LED_PIN (12)
+#define PLAYER2_TURN_INDICATOR_LED_PIN (13)
+#define LED_MAX_CHIP_RED_PIN           (33)
+#define LED_MAX_CHIP_GREEN_PIN         (25)
+#define LED_MAX_CHIP_BLUE_PIN          (26)
+#define BATTERY_PIN                    (4)
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* How the simulated players enter their moves */
+enum SimulatorInput {
+  SIMULATOR_INPUT_BUTTON, /* Every move is two button presses */
+  SIMULATOR_INPUT_VOICE,  /* Every move is sent from the voice recognition app */
+  SIMULATOR_INPUT_MIXED   /* Each move picks one of the two at random */
+};
+
+/* How a game ended */
+enum SimulatorStatus {
+  SIMULATOR_STATUS_WIN,        /* A player won */
+  SIMULATOR_STATUS_MOVE_LIMIT, /* The game was called off after SIMULATOR_MAX_PLIES */
+  SIMULATOR_STATUS_FAIL,       /* The firmware did not do what the reference game expected */
+  SIMULATOR_STATUS_CRASH       /* The game process crashed or hung */
+};
+
+/* The outcome of one game, passed from the game process back to the main process */
+struct SimulatorResult {
+  unsigned long seed;                          /* The seed the game was played with */
+  int           status;                        /* The SimulatorStatus of the game */
+  int           winner;                        /* The player who won (0 if nobody did) */
+  int           plies;                         /* The number of valid moves made */
+  int           invalid_moves;                 /* The number of invalid moves tried */
+  unsigned long virtual_time;                  /* The virtual time the game took in ms */
+  unsigned long ble_requests;                  /* The number of BLE read requests the firmware made */
+  char          reason[SIMULATOR_REASON_SIZE]; /* What went wrong if the game failed */
+};
+
+/* The settings for a run of games */
+struct SimulatorOptions {
+  unsigned long games;           /* The number of games to play */
+  unsigned long seed;            /* The seed of the first game, each game after uses the next seed */
+  int           jobs;            /* The number of games played at once */
+  int           input;           /* The SimulatorInput of the players */
+  int           invalid_percent; /* The chance of a player trying an invalid move before each move */
+  unsigned long ble_stall;       /* The time one BLE reply collection hangs for at the start of each game (ms, 0 for none) */
+  unsigned long idle_wait;       /* The time the players leave the board alone before the first move (s, 0 for none) */
+  unsigned long battery_drain;   /* The voltage the batteries drain to over the first moves of each game (mV, 0 for fresh batteries) */
+  bool          verbose;         /* Indicator for if every move is printed */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* Button ladder readings in the middle of each threshold band, in the order the buttons are wired on each array */
+const int  simulator_button_pins[4] = {BUTTON_ARRAY_PIN1, BUTTON_ARRAY_PIN2, BUTTON_ARRAY_PIN3, BUTTON_ARRAY_PIN4};
+const int  simulator_button_readings[8] = {20, 145, 525, 1100, 1625, 2050, 2475, 3000};
+
+/* The firmware, compiled from MicrocontrollerProcess.ino */
+extern void setup();
+extern void loop();
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+uint32_t        Simulator_Random(uint32_t &state);
+void            Simulator_RunFor(unsigned long duration);
+void            Simulator_Wait(unsigned long duration);
+unsigned long   Simulator_SetBattery(unsigned long voltage);
+void            Simulator_PressButton(Square square);
+void            Simulator_EnterMove(Move move, bool voice);
+int             Simulator_GetLegalMoves(Checkers &referee, Move (&moves)[SIMULATOR_MAX_MOVES]);
+Move            Simulator_GetInvalidMove(Checkers &referee, uint32_t &random_state);
+bool            Simulator_UseVoice(const SimulatorOptions &options, uint32_t &random_state);
+int             Simulator_ReadMapLed(int row, int col);
+bool            Simulator_MapMatches(Checkers &referee);
+bool            Simulator_WaitForMap(Checkers &referee, unsigned long timeout);
+int             Simulator_GetTurnIndicatorPin(int player);
+SimulatorResult Simulator_PlayGame(unsigned long seed, const SimulatorOptions &options);
+void            Simulator_Fail(SimulatorResult &result, const char *reason);
+void            Simulator_FormatMove(Move move, char (&text)[8]);
+bool            Simulator_ParseOptions(int argc, char *argv[], SimulatorOptions &options);
+double          Simulator_GetWallTime();
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Advances a xorshift random number generator, which keeps every game reproducible from its seed
+ *
+ * @param state: The state of the generator
+ * @return uint32_t: The next random number
+ */
+uint32_t Simulator_Random(uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/**
+ * Runs the firmware's loop() once per tick of virtual time
+ *
+ * @param duration: The virtual time to run for in ms
+ */
+void Simulator_RunFor(unsigned long duration) {
+  for (unsigned long i = 0; i < duration; i += SIMULATOR_TICK) {
+    loop();
+    VirtualHardware_Advance(SIMULATOR_TICK * 1000);
+  }
+}
+
+/**
+ * Leaves the board alone, running the firmware until the virtual clock has moved on by the duration
+ *
+ * @param duration: The virtual time to wait in ms
+ * @note Unlike Simulator_RunFor this counts the time the firmware sleeps for inside loop()
+ */
+void Simulator_Wait(unsigned long duration) {
+  unsigned long long end_time = VirtualHardware_GetTime() + (unsigned long long)duration * 1000;
+  while (VirtualHardware_GetTime() < end_time) {
+    loop();
+    VirtualHardware_Advance(SIMULATOR_TICK * 1000);
+  }
+}
+
+/**
+ * Sets the battery voltage, as read through the divider on the battery pin
+ *
+ * @param voltage: The battery voltage in mV
+ * @return unsigned long: The voltage the firmware reads back after the ADC rounds it down, in mV
+ */
+unsigned long Simulator_SetBattery(unsigned long voltage) {
+  int reading = (int)(voltage * VIRTUAL_ANALOG_MAX / SIMULATOR_BATTERY_MAX);
+  VirtualHardware_SetAnalog(BATTERY_PIN, reading);
+  return (unsigned long)reading * SIMULATOR_BATTERY_MAX / VIRTUAL_ANALOG_MAX;
+}
+
+/**
+ * Presses and releases the button of a square
+ *
+ * @param square: The square of the button
+ */
+void Simulator_PressButton(Square square) {
+  int row = Move_GetRow(square);
+  int col = Move_GetCol(square);
+  int pin = simulator_button_pins[row / 2];
+
+  /* Each array has the even row's buttons on its first four readings and the odd row's on its last four */
+  VirtualHardware_SetAnalog(pin, simulator_button_readings[(row % 2) * 4 + col / 2]);
+  Simulator_RunFor(SIMULATOR_PRESS_TIME);
+  VirtualHardware_SetAnalog(pin, VIRTUAL_ANALOG_MAX);
+  Simulator_RunFor(SIMULATOR_PRESS_TIME);
+}
+
+/**
+ * Enters a move the way a player would
+ *
+ * @param move: The move
+ * @param voice: If the move is sent from the voice recognition app instead of pressed on the buttons
+ */
+void Simulator_EnterMove(Move move, bool voice) {
+  if (voice) {
+    char text[8];
+    Simulator_FormatMove(move, text);
+    strcat(text, "\n");
+    VirtualHardware_BleSend(text);
+  }
+  else {
+    Simulator_PressButton(move.from);
+    Simulator_PressButton(move.to);
+  }
+}
+
+/**
+ * Finds every legal move by trying each diagonal step and jump on a copy of the reference game
+ *
+ * @param referee: The reference game
+ * @param moves: The legal moves found
+ * @return int: The number of legal moves
+ */
+int Simulator_GetLegalMoves(Checkers &referee, Move (&moves)[SIMULATOR_MAX_MOVES]) {
+  const int steps[8][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}, {-2, -2}, {-2, 2}, {2, -2}, {2, 2}};
+  int player = referee.Checkers_GetActivePlayer();
+  int move_count = 0;
+
+  for (int row = 0; row < MOVE_BOARD_SIZE; row++) {
+    for (int col = 0; col < MOVE_BOARD_SIZE; col++) {
+      /* Player 1's pieces are 1 and 3, player 2's are 2 and 4 */
+      int piece = referee.Checkers_GetBoardAt(row, col);
+      if (piece == 0 || (piece - 1) % 2 != player - 1) {
+        continue;
+      }
+
+      for (int i = 0; i < 8 && move_count < SIMULATOR_MAX_MOVES; i++) {
+        Square to = Move_MakeSquare(row + steps[i][0], col + steps[i][1]);
+        if (to == SQUARE_NONE) {
+          continue;
+        }
+
+        Checkers trial = referee;
+        Move move = Move_Make(Move_MakeSquare(row, col), to);
+        if (trial.Checkers_Turn(move) == 1) {
+          moves[move_count++] = move;
+        }
+      }
+    }
+  }
+
+  return move_count;
+}
+
+/**
+ * Picks a random move between two squares that have buttons, which the reference game rejects
+ *
+ * @param referee: The reference game
+ * @param random_state: The state of the players' random number generator
+ * @return Move: The invalid move
+ */
+Move Simulator_GetInvalidMove(Checkers &referee, uint32_t &random_state) {
+  Square squares[2];
+  Move move;
+
+  do {
+    /* Only the 32 dark squares have buttons */
+    for (int i = 0; i < 2; i++) {
+      int index = Simulator_Random(random_state) % 32;
+      int row = index / 4;
+      squares[i] = Move_MakeSquare(row, (index % 4) * 2 + (row % 2));
+    }
+    move = Move_Make(squares[0], squares[1]);
+
+    /* The reference game has the final say, as it also accepts any quirks of the game algorithm */
+    Checkers trial = referee;
+    if (move.from != move.to && trial.Checkers_Turn(move) == 0) {
+      return move;
+    }
+  } while (true);
+}
+
+/**
+ * Picks how the next move is entered
+ *
+ * @param options: The settings for the run
+ * @param random_state: The state of the players' random number generator
+ * @return bool: If the move is sent from the voice recognition app instead of pressed on the buttons
+ */
+bool Simulator_UseVoice(const SimulatorOptions &options, uint32_t &random_state) {
+  if (options.input == SIMULATOR_INPUT_MIXED) {
+    return Simulator_Random(random_state) % 2 == 0;
+  }
+
+  return options.input == SIMULATOR_INPUT_VOICE;
+}
+
+/**
+ * Reads the color of a square's RGB LED back into the piece it shows
+ *
+ * @param row: The row of the square
+ * @param col: The column of the square
+ * @return int: The piece (0 to 4), or -1 if the color is not one the firmware uses
+ */
+int Simulator_ReadMapLed(int row, int col) {
+  /* Each MAX chip column holds two board rows, the even row on chip rows 0 to 3 and the odd row on chip rows 4 to 7 */
+  int max_row = (row % 2) * 4 + col / 2;
+  int max_col = row / 2;
+  int color = (VirtualHardware_GetLed(LED_MAX_CHIP_RED_PIN, max_row, max_col) << 2) |
+              (VirtualHardware_GetLed(LED_MAX_CHIP_GREEN_PIN, max_row, max_col) << 1) |
+              VirtualHardware_GetLed(LED_MAX_CHIP_BLUE_PIN, max_row, max_col);
+
+  switch (color) {
+    case 0x0: /* Off */
+      return 0;
+    case 0x4: /* Red */
+      return 1;
+    case 0x1: /* Blue */
+      return 2;
+    case 0x6: /* Yellow */
+      return 3;
+    case 0x3: /* Light blue */
+      return 4;
+    default:
+      return -1;
+  }
+}
+
+/**
+ * Checks if the game map LEDs show the reference game
+ *
+ * @param referee: The reference game
+ * @return bool: If every square matches
+ */
+bool Simulator_MapMatches(Checkers &referee) {
+  for (int row = 0; row < MOVE_BOARD_SIZE; row++) {
+    for (int col = 0; col < MOVE_BOARD_SIZE; col++) {
+      if ((row + col) % 2 == 0 && Simulator_ReadMapLed(row, col) != referee.Checkers_GetBoardAt(row, col)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Runs the firmware until the game map LEDs show the reference game
+ *
+ * @param referee: The reference game
+ * @param timeout: The longest virtual time to wait in ms
+ * @return bool: If the LEDs matched before the timeout
+ */
+bool Simulator_WaitForMap(Checkers &referee, unsigned long timeout) {
+  for (unsigned long waited = 0; waited < timeout; waited += SIMULATOR_TICK) {
+    if (Simulator_MapMatches(referee)) {
+      return true;
+    }
+    Simulator_RunFor(SIMULATOR_TICK);
+  }
+
+  return Simulator_MapMatches(referee);
+}
+
+/**
+ * Retrieves the turn indicator LED pin of a player
+ *
+ * @param player: The player
+ * @return int: The pin
+ */
+int Simulator_GetTurnIndicatorPin(int player) {
+  return (player == 1) ? PLAYER1_TURN_INDICATOR_LED_PIN : PLAYER2_TURN_INDICATOR_LED_PIN;
+}
+
+/**
+ * Plays a game from power on, with both players choosing random legal moves and sometimes trying an invalid one
+ *
+ * @param seed: The seed for the players' choices
+ * @param options: The settings for the run
+ * @return SimulatorResult: The outcome of the game
+ */
+SimulatorResult Simulator_PlayGame(unsigned long seed, const SimulatorOptions &options) {
+  SimulatorResult result;
+  memset(&result, 0, sizeof(result));
+  result.seed = seed;
+
+  /* A seed of 0 would keep the generator at 0 */
+  uint32_t random_state = (uint32_t)(seed * 2654435761UL) | 1;
+  Checkers referee;
+  Move moves[SIMULATOR_MAX_MOVES];
+  char text[8];
+
+  VirtualHardware_Reset();
+  VirtualHardware_BleConnect(options.input != SIMULATOR_INPUT_BUTTON);
+  unsigned long battery = Simulator_SetBattery(SIMULATOR_FRESH_BATTERY);
+  setup();
+  VirtualHardware_BleStall(options.ble_stall * 1000);
+  Simulator_RunFor(SIMULATOR_THINK_TIME);
+
+  if (!Simulator_WaitForMap(referee, SIMULATOR_SETTLE_TIMEOUT)) {
+    Simulator_Fail(result, "the starting board was not shown");
+    return result;
+  }
+
+  /* Nobody touching the board should put it to sleep between its tasks with the game map dimmed */
+  bool waking = options.idle_wait * 1000 > POWER_IDLE_TIMEOUT;
+  Simulator_Wait(options.idle_wait * 1000);
+  if (waking && (!Power_IsIdle() || Power_GetSleeps() == 0)) {
+    Simulator_Fail(result, "the board did not sleep while idle");
+    return result;
+  }
+  int awake_intensity = Battery_GetBudget(Battery_GetMode()).led_intensity;
+  if (waking && VirtualHardware_GetIntensity(LED_MAX_CHIP_RED_PIN) >= awake_intensity) {
+    Simulator_Fail(result, "the game map was not dimmed while idle");
+    return result;
+  }
+
+  while (referee.Checkers_GetWin() == 0) {
+    if (result.plies == SIMULATOR_MAX_PLIES) {
+      result.status = SIMULATOR_STATUS_MOVE_LIMIT;
+      break;
+    }
+
+    int player = referee.Checkers_GetActivePlayer();
+    int move_count = Simulator_GetLegalMoves(referee, moves);
+    if (move_count == 0) {
+      Simulator_Fail(result, "the active player has no legal moves but there is no winner");
+      return result;
+    }
+
+    /* Sometimes try a move that is not legal, which should blink the turn indicator and leave the board alone */
+    if ((int)(Simulator_Random(random_state) % 100) < options.invalid_percent) {
+      Move invalid_move = Simulator_GetInvalidMove(referee, random_state);
+      unsigned long blinks = VirtualHardware_GetFallingEdges(Simulator_GetTurnIndicatorPin(player));
+      Simulator_EnterMove(invalid_move, Simulator_UseVoice(options, random_state));
+      Simulator_RunFor(SIMULATOR_INVALID_TIME);
+      result.invalid_moves++;
+
+      if (options.verbose) {
+        Simulator_FormatMove(invalid_move, text);
+        printf("seed %lu: player %d tried %s (invalid)\n", seed, player, text);
+      }
+
+      if (VirtualHardware_GetFallingEdges(Simulator_GetTurnIndicatorPin(player)) == blinks) {
+        Simulator_Fail(result, "an invalid move did not blink the turn indicator");
+        return result;
+      }
+      if (!Simulator_MapMatches(referee)) {
+        Simulator_Fail(result, "an invalid move changed the board");
+        return result;
+      }
+      Simulator_RunFor(SIMULATOR_THINK_TIME);
+    }
+
+    /* Play a random legal move on the reference game and the firmware */
+    Move move = moves[Simulator_Random(random_state) % move_count];
+    bool voice = Simulator_UseVoice(options, random_state);
+    referee.Checkers_Turn(move);
+    Simulator_EnterMove(move, voice);
+    result.plies++;
+
+    if (options.verbose) {
+      Simulator_FormatMove(move, text);
+      printf("seed %lu: player %d played %s by %s\n", seed, player, text, voice ? "voice" : "buttons");
+    }
+
+    if (!Simulator_WaitForMap(referee, SIMULATOR_SETTLE_TIMEOUT)) {
+      Simulator_Fail(result, "the board did not show the move");
+      return result;
+    }
+
+    /* The first move after idling should have woken the board back up */
+    if (waking && (Power_IsIdle() || VirtualHardware_GetIntensity(LED_MAX_CHIP_RED_PIN) != awake_intensity)) {
+      Simulator_Fail(result, "a move did not wake the board");
+      return result;
+    }
+    waking = false;
+
+    /* Drain the batteries a step with each move, so the governor changes mode during the game */
+    if (options.battery_drain != 0 && result.plies <= SIMULATOR_DRAIN_PLIES) {
+      battery = Simulator_SetBattery(SIMULATOR_FRESH_BATTERY - (SIMULATOR_FRESH_BATTERY - options.battery_drain) * result.plies / SIMULATOR_DRAIN_PLIES);
+    }
+
+    /* Give the turn indicator a moment to catch up, then check it is lit for the player to move */
+    Simulator_RunFor(SIMULATOR_THINK_TIME);
+    if (referee.Checkers_GetWin() == 0) {
+      int next_player = referee.Checkers_GetActivePlayer();
+      if (VirtualHardware_GetLevel(Simulator_GetTurnIndicatorPin(next_player)) != HIGH ||
+          VirtualHardware_GetLevel(Simulator_GetTurnIndicatorPin(3 - next_player)) != LOW) {
+        Simulator_Fail(result, "the turn indicator does not show the active player");
+        return result;
+      }
+    }
+  }
+
+  /* The winner's turn indicator should flash until the game is reset */
+  if (referee.Checkers_GetWin() != 0) {
+    result.winner = referee.Checkers_GetActivePlayer();
+    unsigned long flashes = VirtualHardware_GetFallingEdges(Simulator_GetTurnIndicatorPin(result.winner));
+    Simulator_RunFor(SIMULATOR_WINNER_TIME);
+
+    if (Handoff_GetSnapshot().Checkers_GetWin() == 0) {
+      Simulator_Fail(result, "the firmware did not see the win");
+      return result;
+    }
+    if (VirtualHardware_GetFallingEdges(Simulator_GetTurnIndicatorPin(result.winner)) == flashes) {
+      Simulator_Fail(result, "the winner's turn indicator did not flash");
+      return result;
+    }
+    result.status = SIMULATOR_STATUS_WIN;
+  }
+
+  result.virtual_time = millis();
+  result.ble_requests = VirtualHardware_GetBleRequests();
+
+  /* A stall past the loop deadline should have dumped the trace (only the voice input talks to the BLE module) */
+  if (options.ble_stall * 1000 > TRACE_LOOP_DEADLINE && options.input != SIMULATOR_INPUT_BUTTON &&
+      VirtualHardware_GetSerialOutput().find("OVERRUN,") == std::string::npos) {
+    Simulator_Fail(result, "a BLE stall did not dump the trace");
+    return result;
+  }
+
+  /* An AT command sent while a read request waits would corrupt the voice command in its reply */
+  if (VirtualHardware_GetBleCollisions() != 0) {
+    Simulator_Fail(result, "an AT command was sent to the BLE module while a read request was waiting");
+    return result;
+  }
+
+  /* Once the batteries settle the governor should be in the mode their voltage calls for, having only stepped down */
+  if (options.battery_drain != 0) {
+    Simulator_RunFor(SIMULATOR_BATTERY_TIME);
+    BatteryMode expected = (battery < BATTERY_CRITICAL_ENTER) ? BATTERY_MODE_CRITICAL :
+                           (battery < BATTERY_SAVER_ENTER) ? BATTERY_MODE_SAVER : BATTERY_MODE_NORMAL;
+    if (Battery_GetMode() != expected || Battery_GetModeChanges() != (unsigned long)expected) {
+      Simulator_Fail(result, "the battery governor did not step down to the mode of the batteries");
+      return result;
+    }
+    if (VirtualHardware_GetIntensity(LED_MAX_CHIP_RED_PIN) != Battery_GetBudget(expected).led_intensity) {
+      Simulator_Fail(result, "the game map brightness does not match the battery mode");
+      return result;
+    }
+    if (VirtualHardware_GetBleBatteryLevel() != Battery_GetPercent()) {
+      Simulator_Fail(result, "the app was not sent the battery level");
+      return result;
+    }
+  }
+
+  /* Ask for the loop timing histograms, the latency traces, the memory readings, the power and battery state and the journal state,
+     and show everything the firmware printed */
+  if (options.verbose) {
+    char command[7] = {PROFILER_COMMAND, LATENCY_COMMAND, MEMORY_COMMAND, POWER_COMMAND, BATTERY_COMMAND, JOURNAL_COMMAND, '\0'};
+    VirtualHardware_SerialSend(command);
+    Simulator_RunFor(SIMULATOR_SERIAL_TIME);
+    printf("seed %lu: serial output\n%s", seed, VirtualHardware_GetSerialOutput().c_str());
+  }
+  return result;
+}
+
+/**
+ * Entry point, plays the games across the requested number of processes and prints a summary
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if every game passed, 1 if any failed
+ */
+int main(int argc, char *argv[]) {
+  SimulatorOptions options;
+  if (!Simulator_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s [-g games] [-s seed] [-j jobs] [-i button|voice|mixed] [-p invalid_percent] [-b ble_stall_ms] [-w idle_wait_s] [-e battery_drain_mv] [-v]\n", argv[0]);
+    return 2;
+  }
+
+  /* Every game process writes its result to one pipe, which is atomic as the result is smaller than PIPE_BUF */
+  int result_pipe[2];
+  if (pipe(result_pipe) != 0) {
+    perror("pipe");
+    return 2;
+  }
+
+  pid_t *pids = new pid_t[options.jobs];
+  unsigned long *pid_seeds = new unsigned long[options.jobs];
+  for (int i = 0; i < options.jobs; i++) {
+    pids[i] = 0;
+  }
+
+  unsigned long started = 0;
+  unsigned long finished = 0;
+  unsigned long wins[2] = {0, 0};
+  unsigned long move_limits = 0;
+  unsigned long failures = 0;
+  unsigned long total_plies = 0;
+  unsigned long total_invalid = 0;
+  unsigned long total_ble_requests = 0;
+  unsigned long long total_virtual_time = 0;
+  double start_time = Simulator_GetWallTime();
+
+  while (finished < options.games) {
+    /* Start games until every job slot is busy */
+    for (int i = 0; i < options.jobs && started < options.games; i++) {
+      if (pids[i] != 0) {
+        continue;
+      }
+
+      unsigned long seed = options.seed + started;
+      fflush(stdout);
+      pid_t pid = fork();
+      if (pid == 0) {
+        alarm(SIMULATOR_GAME_TIMEOUT);
+        SimulatorResult result = Simulator_PlayGame(seed, options);
+        fflush(stdout);
+        _exit(write(result_pipe[1], &result, sizeof(result)) == sizeof(result) ? 0 : 1);
+      }
+      if (pid < 0) {
+        perror("fork");
+        return 2;
+      }
+
+      pids[i] = pid;
+      pid_seeds[i] = seed;
+      started++;
+    }
+
+    /* Collect the next game to finish */
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0) {
+      perror("wait");
+      return 2;
+    }
+
+    for (int i = 0; i < options.jobs; i++) {
+      if (pids[i] != pid) {
+        continue;
+      }
+
+      SimulatorResult result;
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && read(result_pipe[0], &result, sizeof(result)) == sizeof(result)) {
+        total_plies += result.plies;
+        total_invalid += result.invalid_moves;
+        total_ble_requests += result.ble_requests;
+        total_virtual_time += result.virtual_time;
+      }
+      else {
+        memset(&result, 0, sizeof(result));
+        result.seed = pid_seeds[i];
+        result.status = SIMULATOR_STATUS_CRASH;
+        snprintf(result.reason, sizeof(result.reason), "the game process %s", WIFSIGNALED(status) ? strsignal(WTERMSIG(status)) : "exited early");
+      }
+
+      if (result.status == SIMULATOR_STATUS_WIN) {
+        wins[result.winner - 1]++;
+      }
+      else if (result.status == SIMULATOR_STATUS_MOVE_LIMIT) {
+        move_limits++;
+      }
+      else {
+        failures++;
+        printf("FAIL seed %lu after %d moves: %s (rerun with -s %lu -g 1 -v)\n", result.seed, result.plies, result.reason, result.seed);
+      }
+
+      pids[i] = 0;
+      finished++;
+    }
+  }
+
+  double wall_time = Simulator_GetWallTime() - start_time;
+  printf("games %lu, player 1 wins %lu, player 2 wins %lu, move limit %lu, failures %lu\n",
+         options.games, wins[0], wins[1], move_limits, failures);
+  printf("moves %lu, invalid moves %lu, BLE read requests %lu\n", total_plies, total_invalid, total_ble_requests);
+  printf("virtual time %.1f s, wall time %.2f s, %.0fx real time\n", total_virtual_time / 1000.0, wall_time,
+         (wall_time > 0) ? total_virtual_time / 1000.0 / wall_time : 0.0);
+
+  delete[] pids;
+  delete[] pid_seeds;
+  return (failures == 0) ? 0 : 1;
+}
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Marks a game as failed
+ *
+ * @param result: The result of the game
+ * @param reason: What went wrong
+ */
+void Simulator_Fail(SimulatorResult &result, const char *reason) {
+  result.status = SIMULATOR_STATUS_FAIL;
+  result.virtual_time = millis();
+  result.ble_requests = VirtualHardware_GetBleRequests();
+  strncpy(result.reason, reason, SIMULATOR_REASON_SIZE - 1);
+}
+
+/**
+ * Writes a move the way the voice recognition app sends it, such as "F2 E1"
+ *
+ * @param move: The move
+ * @param text: The text of the move
+ */
+void Simulator_FormatMove(Move move, char (&text)[8]) {
+  text[0] = 'A' + Move_GetRow(move.from);
+  text[1] = '1' + Move_GetCol(move.from);
+  text[2] = ' ';
+  text[3] = 'A' + Move_GetRow(move.to);
+  text[4] = '1' + Move_GetCol(move.to);
+  text[5] = '\0';
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool Simulator_ParseOptions(int argc, char *argv[], SimulatorOptions &options) {
+  options.games = 1000;
+  options.seed = 1;
+  options.jobs = 1;
+  options.input = SIMULATOR_INPUT_MIXED;
+  options.invalid_percent = 5;
+  options.ble_stall = 0;
+  options.idle_wait = 0;
+  options.battery_drain = 0;
+  options.verbose = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "g:s:j:i:p:b:w:e:v")) != -1) {
+    switch (option) {
+      case 'g':
+        options.games = strtoul(optarg, 0, 10);
+        break;
+      case 's':
+        options.seed = strtoul(optarg, 0, 10);
+        break;
+      case 'j':
+        options.jobs = atoi(optarg);
+        break;
+      case 'i':
+        if (strcmp(optarg, "button") == 0) {
+          options.input = SIMULATOR_INPUT_BUTTON;
+        }
+        else if (strcmp(optarg, "voice") == 0) {
+          options.input = SIMULATOR_INPUT_VOICE;
+        }
+        else if (strcmp(optarg, "mixed") == 0) {
+          options.input = SIMULATOR_INPUT_MIXED;
+        }
+        else {
+          return false;
+        }
+        break;
+      case 'p':
+        options.invalid_percent = atoi(optarg);
+        break;
+      case 'b':
+        options.ble_stall = strtoul(optarg, 0, 10);
+        break;
+      case 'w':
+        options.idle_wait = strtoul(optarg, 0, 10);
+        break;
+      case 'e':
+        options.battery_drain = strtoul(optarg, 0, 10);
+        break;
+      case 'v':
+        options.verbose = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return options.jobs > 0 && options.invalid_percent >= 0 && options.invalid_percent <= 100;
+}
+
+/**
+ * Retrieves the wall clock time
+ *
+ * @return double: The time in s
+ */
+double Simulator_GetWallTime() {
+  struct timeval time;
+  gettimeofday(&time, 0);
+  return time.tv_sec + time.tv_usec / 1000000.0;
+}
@@ -0,0 +1,574 @@
+/************************************************************
+ * @file VirtualHardware.cpp
+ * @brief The implementation for the simulated board (clock, pins, LED matrices and BLE module) behind the host mocks
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "VirtualHardware.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <sstream>
+#include <string>
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define VIRTUAL_LED_CHIP_COUNT (4) /* The number of MAX chips that can be wired up */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A MAX chip's LED matrix, found by the data pin it is wired to */
+struct VirtualLedChip {
+  int  data_pin;                                  /* The data pin of the chip (0 when the slot is free) */
+  bool leds[VIRTUAL_LED_SIZE][VIRTUAL_LED_SIZE]; /* The state of each LED */
+  int  intensity;                                 /* The brightness from 0 to 15 */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The Serial port, which is kept off stdout so the firmware's prints don't get mixed into the simulator's */
+std::istringstream virtual_serial_input;  /* Bytes sent to the firmware */
+std::ostringstream virtual_serial_output; /* Bytes the firmware has printed */
+CppIOStream        Serial(virtual_serial_input, virtual_serial_output);
+
+/* The virtual clock in us, only moved forward by the simulator and delay() */
+unsigned long long virtual_time;
+
+/* GPIO state */
+int           virtual_levels[VIRTUAL_PIN_COUNT];         /* The level last written to or driven on each pin */
+int           virtual_analog[VIRTUAL_PIN_COUNT];         /* The voltage reading of each analog pin */
+unsigned long virtual_falling_edges[VIRTUAL_PIN_COUNT];  /* The number of HIGH to LOW writes on each pin */
+void        (*virtual_handlers[VIRTUAL_PIN_COUNT])(void); /* The interrupt handler attached to each pin */
+int           virtual_handler_modes[VIRTUAL_PIN_COUNT];  /* The edge each interrupt handler runs on */
+
+/* MAX chip LED matrices */
+VirtualLedChip virtual_led_chips[VIRTUAL_LED_CHIP_COUNT];
+
+/* BLE module state */
+bool               virtual_ble_connected;                     /* Indicator for if the app is connected */
+char               virtual_ble_app_data[VIRTUAL_BLE_FIFO_SIZE]; /* Bytes sent by the app, waiting for a read request */
+int                virtual_ble_app_length;                    /* The number of bytes waiting in virtual_ble_app_data */
+uint8_t            virtual_ble_fifo[VIRTUAL_BLE_FIFO_SIZE];    /* Bytes the driver has pulled off the module */
+int                virtual_ble_fifo_length;                   /* The number of bytes in the driver's FIFO */
+bool               virtual_ble_request_pending;               /* Indicator for if a read request is waiting on its reply */
+unsigned long long virtual_ble_reply_time;                    /* The time the pending reply will be ready */
+int                virtual_ble_irq_pin;                       /* The pin the module raises when a reply is ready */
+unsigned long      virtual_ble_requests;                      /* The number of read requests sent to the module */
+unsigned long      virtual_ble_stall;                         /* The time the next reply collection hangs for in us */
+int                virtual_ble_battery_level;                 /* The level last set on the battery service (-1 if never) */
+unsigned long      virtual_ble_collisions;                    /* The number of AT commands sent while a read request was waiting */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+VirtualLedChip *VirtualHardware_FindLedChip(int data_pin);
+void            VirtualHardware_Drive(int pin, int level);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Puts the board in its power on state, with no buttons pressed, every LED off and no BLE connection
+ *
+ */
+void VirtualHardware_Reset() {
+  virtual_time = 0;
+
+  for (int i = 0; i < VIRTUAL_PIN_COUNT; i++) {
+    virtual_levels[i] = LOW;
+    virtual_analog[i] = VIRTUAL_ANALOG_MAX;
+    virtual_falling_edges[i] = 0;
+    virtual_handlers[i] = 0;
+    virtual_handler_modes[i] = 0;
+  }
+
+  for (int i = 0; i < VIRTUAL_LED_CHIP_COUNT; i++) {
+    virtual_led_chips[i].data_pin = 0;
+  }
+
+  virtual_ble_connected = false;
+  virtual_ble_app_length = 0;
+  virtual_ble_fifo_length = 0;
+  virtual_ble_request_pending = false;
+  virtual_ble_reply_time = 0;
+  virtual_ble_irq_pin = -1;
+  virtual_ble_requests = 0;
+  virtual_ble_stall = 0;
+  virtual_ble_battery_level = -1;
+  virtual_ble_collisions = 0;
+
+  virtual_serial_input.clear();
+  virtual_serial_input.str("");
+  virtual_serial_output.str("");
+}
+
+/**
+ * Moves the virtual clock forward, raising the BLE IRQ line at the point a pending reply becomes ready
+ *
+ * @param duration: The time to move forward in us
+ */
+void VirtualHardware_Advance(unsigned long duration) {
+  unsigned long long end_time = virtual_time + duration;
+
+  if (virtual_ble_request_pending && virtual_ble_reply_time <= end_time && virtual_levels[virtual_ble_irq_pin] == LOW) {
+    if (virtual_ble_reply_time > virtual_time) {
+      virtual_time = virtual_ble_reply_time;
+    }
+    VirtualHardware_Drive(virtual_ble_irq_pin, HIGH);
+  }
+
+  virtual_time = end_time;
+}
+
+/**
+ * Retrieves the virtual clock
+ *
+ * @return unsigned long long: The time since power on in us
+ */
+unsigned long long VirtualHardware_GetTime() {
+  return virtual_time;
+}
+
+/**
+ * Sets the voltage reading of an analog pin, which is how a press on the button resistor ladders is simulated
+ *
+ * @param pin: The analog pin
+ * @param value: The reading from 0 to VIRTUAL_ANALOG_MAX
+ */
+void VirtualHardware_SetAnalog(int pin, int value) {
+  virtual_analog[pin] = value;
+}
+
+/**
+ * Retrieves the level of a pin
+ *
+ * @param pin: The pin
+ * @return int: HIGH or LOW
+ */
+int VirtualHardware_GetLevel(int pin) {
+  return virtual_levels[pin];
+}
+
+/**
+ * Retrieves how many times a pin has been written from HIGH to LOW, which is how LED blinks are counted
+ *
+ * @param pin: The pin
+ * @return unsigned long: The number of falling edges
+ */
+unsigned long VirtualHardware_GetFallingEdges(int pin) {
+  return virtual_falling_edges[pin];
+}
+
+/**
+ * Sets an LED on a MAX chip
+ *
+ * @param data_pin: The data pin of the chip
+ * @param row: The row on the chip
+ * @param col: The column on the chip
+ * @param state: If the LED is on
+ */
+void VirtualHardware_SetLed(int data_pin, int row, int col, bool state) {
+  VirtualLedChip *chip = VirtualHardware_FindLedChip(data_pin);
+
+  if (chip != 0 && row >= 0 && row < VIRTUAL_LED_SIZE && col >= 0 && col < VIRTUAL_LED_SIZE) {
+    chip->leds[row][col] = state;
+  }
+}
+
+/**
+ * Turns off every LED on a MAX chip
+ *
+ * @param data_pin: The data pin of the chip
+ */
+void VirtualHardware_ClearLeds(int data_pin) {
+  VirtualLedChip *chip = VirtualHardware_FindLedChip(data_pin);
+
+  if (chip != 0) {
+    memset(chip->leds, 0, sizeof(chip->leds));
+  }
+}
+
+/**
+ * Retrieves an LED on a MAX chip
+ *
+ * @param data_pin: The data pin of the chip
+ * @param row: The row on the chip
+ * @param col: The column on the chip
+ * @return bool: If the LED is on
+ */
+bool VirtualHardware_GetLed(int data_pin, int row, int col) {
+  VirtualLedChip *chip = VirtualHardware_FindLedChip(data_pin);
+
+  if (chip == 0 || row < 0 || row >= VIRTUAL_LED_SIZE || col < 0 || col >= VIRTUAL_LED_SIZE) {
+    return false;
+  }
+
+  return chip->leds[row][col];
+}
+
+/**
+ * Sets the brightness of a MAX chip
+ *
+ * @param data_pin: The data pin of the chip
+ * @param intensity: The brightness from 0 to 15
+ */
+void VirtualHardware_SetIntensity(int data_pin, int intensity) {
+  VirtualLedChip *chip = VirtualHardware_FindLedChip(data_pin);
+
+  if (chip != 0) {
+    chip->intensity = intensity;
+  }
+}
+
+/**
+ * Retrieves the brightness of a MAX chip
+ *
+ * @param data_pin: The data pin of the chip
+ * @return int: The brightness from 0 to 15 (0 for a chip that was never set up)
+ */
+int VirtualHardware_GetIntensity(int data_pin) {
+  VirtualLedChip *chip = VirtualHardware_FindLedChip(data_pin);
+
+  return (chip != 0) ? chip->intensity : 0;
+}
+
+/**
+ * Retrieves whether the app is connected to the BLE module
+ *
+ * @return bool: If the app is connected
+ */
+bool VirtualHardware_BleIsConnected() {
+  /* An AT command's reply would be mixed into the reply to a waiting read request */
+  if (virtual_ble_request_pending) {
+    virtual_ble_collisions++;
+  }
+  return virtual_ble_connected;
+}
+
+/**
+ * Sends a read request to the BLE module, which raises IRQ once its reply is ready
+ *
+ * @param irq_pin: The pin the module raises
+ * @return bool: If the request was sent
+ */
+bool VirtualHardware_BleRequestRx(int irq_pin) {
+  virtual_ble_irq_pin = irq_pin;
+  virtual_ble_request_pending = true;
+  virtual_ble_reply_time = virtual_time + VIRTUAL_BLE_REPLY_TIME;
+  virtual_ble_requests++;
+  return true;
+}
+
+/**
+ * Collects the reply to a read request into the driver's FIFO, only if IRQ is raised
+ *
+ * @param irq_pin: The pin the module raises
+ * @return bool: If a reply was collected
+ */
+bool VirtualHardware_BlePollRx(int irq_pin) {
+  /* A stalled SPI transaction holds up the caller, the same as the driver waiting out a timeout */
+  if (virtual_ble_stall != 0) {
+    unsigned long stall = virtual_ble_stall;
+    virtual_ble_stall = 0;
+    VirtualHardware_Advance(stall);
+  }
+
+  if (virtual_levels[irq_pin] == LOW) {
+    return false;
+  }
+
+  /* The reply holds whatever the app has sent that fits in the FIFO */
+  int length = virtual_ble_app_length;
+  if (length > VIRTUAL_BLE_FIFO_SIZE - virtual_ble_fifo_length) {
+    length = VIRTUAL_BLE_FIFO_SIZE - virtual_ble_fifo_length;
+  }
+  memcpy(virtual_ble_fifo + virtual_ble_fifo_length, virtual_ble_app_data, length);
+  memmove(virtual_ble_app_data, virtual_ble_app_data + length, virtual_ble_app_length - length);
+  virtual_ble_fifo_length += length;
+  virtual_ble_app_length -= length;
+
+  virtual_ble_request_pending = false;
+  VirtualHardware_Drive(irq_pin, LOW);
+  return true;
+}
+
+/**
+ * Takes bytes out of the driver's FIFO
+ *
+ * @param buffer: The buffer to copy the bytes to
+ * @param size: The size of the buffer
+ * @return uint16_t: The number of bytes copied
+ */
+uint16_t VirtualHardware_BleReadBuffered(uint8_t *buffer, uint16_t size) {
+  int length = (virtual_ble_fifo_length < size) ? virtual_ble_fifo_length : size;
+
+  memcpy(buffer, virtual_ble_fifo, length);
+  memmove(virtual_ble_fifo, virtual_ble_fifo + length, virtual_ble_fifo_length - length);
+  virtual_ble_fifo_length -= length;
+  return length;
+}
+
+/**
+ * Connects or disconnects the app from the BLE module
+ *
+ * @param connected: If the app is connected
+ */
+void VirtualHardware_BleConnect(bool connected) {
+  virtual_ble_connected = connected;
+}
+
+/**
+ * Sends bytes from the app, which the module holds until the next read request
+ *
+ * @param data: The null terminated bytes to send, anything past the module's buffer is dropped
+ */
+void VirtualHardware_BleSend(const char *data) {
+  while (*data != '\0' && virtual_ble_app_length < VIRTUAL_BLE_FIFO_SIZE) {
+    virtual_ble_app_data[virtual_ble_app_length++] = *data++;
+  }
+}
+
+/**
+ * Makes the next reply collection hang, to check the firmware catches stalls
+ *
+ * @param duration: The time the collection hangs for in us
+ */
+void VirtualHardware_BleStall(unsigned long duration) {
+  virtual_ble_stall = duration;
+}
+
+/**
+ * Sets the level on the BLE module's battery service
+ *
+ * @param percent: The battery level in %
+ * @return bool: If the module took the level
+ */
+bool VirtualHardware_BleUpdateBattery(uint8_t percent) {
+  /* This is an AT command as well */
+  if (virtual_ble_request_pending) {
+    virtual_ble_collisions++;
+  }
+  virtual_ble_battery_level = percent;
+  return true;
+}
+
+/**
+ * Retrieves the level the firmware last set on the BLE module's battery service
+ *
+ * @return int: The battery level in %, -1 if it was never set
+ */
+int VirtualHardware_GetBleBatteryLevel() {
+  return virtual_ble_battery_level;
+}
+
+/**
+ * Retrieves how many AT commands were sent to the BLE module while a read request was waiting on its reply
+ *
+ * @return unsigned long: The number of AT commands that would have corrupted a reply
+ */
+unsigned long VirtualHardware_GetBleCollisions() {
+  return virtual_ble_collisions;
+}
+
+/**
+ * Retrieves how many read requests have been sent to the BLE module
+ *
+ * @return unsigned long: The number of read requests
+ */
+unsigned long VirtualHardware_GetBleRequests() {
+  return virtual_ble_requests;
+}
+
+/**
+ * Sends bytes to the firmware over Serial, replacing any it has not read yet
+ *
+ * @param data: The null terminated bytes to send
+ */
+void VirtualHardware_SerialSend(const char *data) {
+  virtual_serial_input.clear();
+  virtual_serial_input.str(data);
+}
+
+/**
+ * Retrieves everything the firmware has printed over Serial since the last reset
+ *
+ * @return std::string: The printed bytes
+ */
+std::string VirtualHardware_GetSerialOutput() {
+  return virtual_serial_output.str();
+}
+
+/**********************************
+ ** Arduino Core Mock Definitions
+ **********************************/
+/**
+ * Sets the mode of a pin, which the virtual pins do not need
+ *
+ * @param pin: The pin
+ * @param mode: INPUT or OUTPUT
+ */
+void pinMode(uint8_t pin, uint8_t mode) {
+  return;
+}
+
+/**
+ * Writes the level of an output pin
+ *
+ * @param pin: The pin
+ * @param level: HIGH or LOW
+ */
+void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin < VIRTUAL_PIN_COUNT) {
+    VirtualHardware_Drive(pin, level);
+  }
+}
+
+/**
+ * Reads the level of a pin
+ *
+ * @param pin: The pin
+ * @return int: HIGH or LOW
+ */
+int digitalRead(uint8_t pin) {
+  return (pin < VIRTUAL_PIN_COUNT) ? virtual_levels[pin] : LOW;
+}
+
+/**
+ * Reads the voltage of an analog pin
+ *
+ * @param pin: The pin
+ * @return int: The reading from 0 to VIRTUAL_ANALOG_MAX
+ */
+int analogRead(uint8_t pin) {
+  return (pin < VIRTUAL_PIN_COUNT) ? virtual_analog[pin] : VIRTUAL_ANALOG_MAX;
+}
+
+/**
+ * Retrieves the interrupt number of a pin, which is the pin itself on the ESP32
+ *
+ * @param pin: The pin
+ * @return int: The interrupt number
+ */
+int digitalPinToInterrupt(uint8_t pin) {
+  return pin;
+}
+
+/**
+ * Attaches a handler that runs when the virtual hardware drives an edge on a pin
+ *
+ * @param interrupt: The interrupt number
+ * @param handler: The function to run
+ * @param mode: The edge to run on (RISING, FALLING or CHANGE)
+ */
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode) {
+  if (interrupt < VIRTUAL_PIN_COUNT) {
+    virtual_handlers[interrupt] = handler;
+    virtual_handler_modes[interrupt] = mode;
+  }
+}
+
+/**
+ * Detaches the handler from a pin
+ *
+ * @param interrupt: The interrupt number
+ */
+void detachInterrupt(uint8_t interrupt) {
+  if (interrupt < VIRTUAL_PIN_COUNT) {
+    virtual_handlers[interrupt] = 0;
+  }
+}
+
+/**
+ * Retrieves the virtual time
+ *
+ * @return unsigned long: The time since power on in ms
+ */
+unsigned long millis() {
+  return (unsigned long)(virtual_time / 1000);
+}
+
+/**
+ * Retrieves the virtual time
+ *
+ * @return unsigned long: The time since power on in us
+ */
+unsigned long micros() {
+  return (unsigned long)virtual_time;
+}
+
+/**
+ * Moves the virtual clock forward instead of waiting
+ *
+ * @param duration: The time to wait in ms
+ */
+void delay(unsigned long duration) {
+  VirtualHardware_Advance(duration * 1000);
+}
+
+/**
+ * Moves the virtual clock forward instead of waiting
+ *
+ * @param duration: The time to wait in us
+ */
+void delayMicroseconds(unsigned int duration) {
+  VirtualHardware_Advance(duration);
+}
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Finds the LED matrix of a MAX chip, wiring up a free one the first time its data pin is used
+ *
+ * @param data_pin: The data pin of the chip
+ * @return VirtualLedChip *: The chip, or 0 if every chip is taken
+ */
+VirtualLedChip *VirtualHardware_FindLedChip(int data_pin) {
+  for (int i = 0; i < VIRTUAL_LED_CHIP_COUNT; i++) {
+    if (virtual_led_chips[i].data_pin == data_pin) {
+      return &virtual_led_chips[i];
+    }
+  }
+
+  for (int i = 0; i < VIRTUAL_LED_CHIP_COUNT; i++) {
+    if (virtual_led_chips[i].data_pin == 0) {
+      virtual_led_chips[i].data_pin = data_pin;
+      memset(virtual_led_chips[i].leds, 0, sizeof(virtual_led_chips[i].leds));
+      virtual_led_chips[i].intensity = 0;
+      return &virtual_led_chips[i];
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * Drives a pin to a level, running its interrupt handler if the edge matches
+ *
+ * @param pin: The pin
+ * @param level: HIGH or LOW
+ */
+void VirtualHardware_Drive(int pin, int level) {
+  int previous_level = virtual_levels[pin];
+  virtual_levels[pin] = level;
+
+  if (previous_level == level) {
+    return;
+  }
+
+  if (level == LOW) {
+    virtual_falling_edges[pin]++;
+  }
+
+  int mode = virtual_handler_modes[pin];
+  if (virtual_handlers[pin] != 0 && (mode == CHANGE || (mode == RISING && level == HIGH) || (mode == FALLING && level == LOW))) {
+    virtual_handlers[pin]();
+  }
+}
@@ -0,0 +1,64 @@
+/************************************************************
+ * @file VirtualHardware.h
+ * @brief The header for the simulated board (clock, pins, LED matrices and BLE module) behind the host mocks
+ ************************************************************/
+#ifndef VIRTUALHARDWARE_H
+#define VIRTUALHARDWARE_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdint.h>
+#include <string>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define VIRTUAL_PIN_COUNT      (40)   /* The number of GPIO pins on the ESP32 */
+#define VIRTUAL_ANALOG_MAX     (4095) /* The reading of an analog pin that nothing is pulling down */
+#define VIRTUAL_LED_SIZE       (8)    /* The number of rows and columns on a MAX chip */
+#define VIRTUAL_BLE_REPLY_TIME (2000) /* The time the BLE module takes to raise IRQ after a read request in us */
+#define VIRTUAL_BLE_FIFO_SIZE  (64)   /* The number of bytes the BLE driver can buffer */
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Setup functions */
+void VirtualHardware_Reset();
+
+/* Clock functions */
+void               VirtualHardware_Advance(unsigned long duration);
+unsigned long long VirtualHardware_GetTime();
+
+/* Pin functions */
+void          VirtualHardware_SetAnalog(int pin, int value);
+int           VirtualHardware_GetLevel(int pin);
+unsigned long VirtualHardware_GetFallingEdges(int pin);
+
+/* LED matrix functions (called by the LedControl mock) */
+void VirtualHardware_SetLed(int data_pin, int row, int col, bool state);
+void VirtualHardware_ClearLeds(int data_pin);
+bool VirtualHardware_GetLed(int data_pin, int row, int col);
+void VirtualHardware_SetIntensity(int data_pin, int intensity);
+int  VirtualHardware_GetIntensity(int data_pin);
+
+/* BLE module functions (called by the Bluefruit mock) */
+bool     VirtualHardware_BleIsConnected();
+bool     VirtualHardware_BleRequestRx(int irq_pin);
+bool     VirtualHardware_BlePollRx(int irq_pin);
+uint16_t VirtualHardware_BleReadBuffered(uint8_t *buffer, uint16_t size);
+bool     VirtualHardware_BleUpdateBattery(uint8_t percent);
+
+/* BLE app functions (called by the simulator) */
+void          VirtualHardware_BleConnect(bool connected);
+void          VirtualHardware_BleSend(const char *data);
+void          VirtualHardware_BleStall(unsigned long duration);
+unsigned long VirtualHardware_GetBleRequests();
+int           VirtualHardware_GetBleBatteryLevel();
+unsigned long VirtualHardware_GetBleCollisions();
+
+/* Serial functions (called by the simulator) */
+void        VirtualHardware_SerialSend(const char *data);
+std::string VirtualHardware_GetSerialOutput();
+
+#endif /* VIRTUALHARDWARE_H */
@@ -0,0 +1,19 @@
+/************************************************************
+ * @file Adafruit_BLE.h
+ * @brief The host mock of the Bluefruit base library, only the definitions the firmware uses
+ ************************************************************/
+#ifndef ADAFRUIT_BLE_H
+#define ADAFRUIT_BLE_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define BLUEFRUIT_MODE_COMMAND (1)
+#define BLUEFRUIT_MODE_DATA    (0)
+
+#endif /* ADAFRUIT_BLE_H */
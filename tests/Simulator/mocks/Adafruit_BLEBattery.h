@@ -0,0 +1,25 @@
+/************************************************************
+ * @file Adafruit_BLEBattery.h
+ * @brief The host mock of the Bluefruit battery service helper, which sets the level on the simulator's virtual BLE module
+ ************************************************************/
+#ifndef ADAFRUIT_BLEBATTERY_H
+#define ADAFRUIT_BLEBATTERY_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Adafruit_BluefruitLE_SPI.h"
+#include "VirtualHardware.h"
+
+/**********************************
+ ** Class Declarations
+ **********************************/
+class Adafruit_BLEBattery {
+  public:
+    /* Functions */
+    Adafruit_BLEBattery(Adafruit_BluefruitLE_SPI &ble) {}
+    bool begin(bool reset = true) { return true; }
+    bool update(uint8_t percent) { return VirtualHardware_BleUpdateBattery(percent); }
+};
+
+#endif /* ADAFRUIT_BLEBATTERY_H */
@@ -0,0 +1,36 @@
+/************************************************************
+ * @file Adafruit_BluefruitLE_SPI.h
+ * @brief The host mock of the Bluefruit SPI driver, which talks to the simulator's virtual BLE module
+ ************************************************************/
+#ifndef ADAFRUIT_BLUEFRUITLE_SPI_H
+#define ADAFRUIT_BLUEFRUITLE_SPI_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Adafruit_BLE.h"
+#include "VirtualHardware.h"
+
+/**********************************
+ ** Class Declarations
+ **********************************/
+class Adafruit_BluefruitLE_SPI {
+  public:
+    /* Functions */
+    Adafruit_BluefruitLE_SPI(int8_t cs_pin, int8_t irq_pin, int8_t rst_pin = -1) : irq_pin(irq_pin) {}
+    bool     begin(bool verbose = false, bool blocking = true) { return true; }
+    bool     factoryReset(bool blocking = true) { return true; }
+    bool     echo(bool enable) { return true; }
+    void     info() {}
+    bool     setMode(uint8_t mode) { return true; }
+    bool     isConnected() { return VirtualHardware_BleIsConnected(); }
+    int8_t   irqPin() { return irq_pin; }
+    bool     requestRx() { return VirtualHardware_BleRequestRx(irq_pin); }
+    bool     pollRx() { return VirtualHardware_BlePollRx(irq_pin); }
+    uint16_t readBuffered(uint8_t *buffer, uint16_t size) { return VirtualHardware_BleReadBuffered(buffer, size); }
+  private:
+    /* Members */
+    int8_t irq_pin; /* The pin the module raises when a reply is ready */
+};
+
+#endif /* ADAFRUIT_BLUEFRUITLE_SPI_H */
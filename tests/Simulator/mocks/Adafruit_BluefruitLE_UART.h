@@ -0,0 +1,13 @@
+/************************************************************
+ * @file Adafruit_BluefruitLE_UART.h
+ * @brief The host mock of the Bluefruit UART driver, which the firmware includes but does not use
+ ************************************************************/
+#ifndef ADAFRUIT_BLUEFRUITLE_UART_H
+#define ADAFRUIT_BLUEFRUITLE_UART_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Adafruit_BLE.h"
+
+#endif /* ADAFRUIT_BLUEFRUITLE_UART_H */
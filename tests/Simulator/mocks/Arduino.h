@@ -0,0 +1,63 @@
+/************************************************************
+ * @file Arduino.h
+ * @brief The host mock of the Arduino core, backed by the simulator's virtual hardware
+ ************************************************************/
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ArduinoUnitMockWString.h"
+#include "ArduinoUnitMockPrint.h"
+#include "ArduinoUnitMockStream.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+/* Pin modes and levels */
+#define INPUT  (0x0)
+#define OUTPUT (0x1)
+#define LOW    (0x0)
+#define HIGH   (0x1)
+
+/* Interrupt modes */
+#define CHANGE  (0x1)
+#define FALLING (0x2)
+#define RISING  (0x3)
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+typedef bool    boolean;
+typedef uint8_t byte;
+
+/**********************************
+ ** Global Variables
+ **********************************/
+extern CppIOStream Serial;
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* GPIO and ADC functions */
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int  digitalRead(uint8_t pin);
+int  analogRead(uint8_t pin);
+
+/* Interrupt functions */
+int  digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+/* Timing functions, which read and advance the virtual clock */
+unsigned long millis();
+unsigned long micros();
+void          delay(unsigned long duration);
+void          delayMicroseconds(unsigned int duration);
+
+#endif /* ARDUINO_H */
@@ -0,0 +1,31 @@
+/************************************************************
+ * @file LedControl.h
+ * @brief The host mock of the MAX7219 LedControl library, which writes to the simulator's virtual LED matrices
+ ************************************************************/
+#ifndef LEDCONTROL_H
+#define LEDCONTROL_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "VirtualHardware.h"
+
+/**********************************
+ ** Class Declarations
+ **********************************/
+class LedControl {
+  public:
+    /* Functions */
+    LedControl(int data_pin, int clk_pin, int cs_pin, int num_devices = 1) : data_pin(data_pin) {}
+    int  getDeviceCount() { return 1; }
+    void shutdown(int addr, bool status) {}
+    void setScanLimit(int addr, int limit) {}
+    void setIntensity(int addr, int intensity) { VirtualHardware_SetIntensity(data_pin, intensity); }
+    void clearDisplay(int addr) { VirtualHardware_ClearLeds(data_pin); }
+    void setLed(int addr, int row, int col, boolean state) { VirtualHardware_SetLed(data_pin, row, col, state); }
+  private:
+    /* Members */
+    int data_pin; /* The data pin the chip is wired to, which identifies its matrix */
+};
+
+#endif /* LEDCONTROL_H */
@@ -0,0 +1,13 @@
+/************************************************************
+ * @file SPI.h
+ * @brief The host mock of the Arduino SPI library, the virtual BLE module does not need a bus
+ ************************************************************/
+#ifndef SPI_H
+#define SPI_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+#endif /* SPI_H */
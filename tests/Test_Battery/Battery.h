@@ -0,0 +1,72 @@
+/************************************************************
+ * @file Battery.h
+ * @brief The header for the battery governor, which picks how much work the board does from the battery voltage
+ * @note The charge left is sent to the app through the BLE battery service, between read requests and only when it changes.
+ *       Send BATTERY_COMMAND over Serial for one line: BATTERY,<normal|saver|critical|none>,<filtered mV>,<percent>,<mode changes>
+ ************************************************************/
+#ifndef BATTERY_H
+#define BATTERY_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+/* The battery is read through a divider of two equal resistors into GPIO 4, which boards built before it do not have */
+#ifndef BATTERY_SENSE_ENABLED
+#define BATTERY_SENSE_ENABLED (0) /* 1 to read the battery, only on a board with the divider fitted */
+#endif
+
+/* Battery voltages for 4 AA cells (mV), the ESP32 dev board's regulator drops out below about 4400 mV */
+#define BATTERY_FULL_VOLTAGE   (6000) /* Reported as 100%, fresh alkaline cells read a little above it */
+#define BATTERY_EMPTY_VOLTAGE  (4400) /* Reported as 0% */
+#define BATTERY_SAVER_ENTER    (5000) /* Below this the board saves power */
+#define BATTERY_SAVER_EXIT     (5200) /* Above this the board goes back to normal */
+#define BATTERY_CRITICAL_ENTER (4700) /* Below this the board does as little as it can and still play */
+#define BATTERY_CRITICAL_EXIT  (4900) /* Above this the board goes back to saving power */
+#define BATTERY_NO_SENSOR      (3000) /* A first reading below this is an unconnected pin, not a battery */
+
+#define BATTERY_FILTER_SHIFT (3)     /* Each reading moves the filtered voltage 1/8 of the way, riding out the sag of a busy moment */
+#define BATTERY_COMMAND      ('b')   /* The byte sent over Serial to ask for the battery state */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The modes, from the most work to the least */
+enum BatteryMode {
+  BATTERY_MODE_NORMAL,   /* Full brightness and scan rates */
+  BATTERY_MODE_SAVER,    /* Dimmer game map and slower voice polls */
+  BATTERY_MODE_CRITICAL, /* Dim game map and slower scans, so the game can finish before the board browns out */
+  BATTERY_MODE_COUNT
+};
+
+/* The work each mode allows */
+struct BatteryBudget {
+  int led_intensity; /* The game map brightness, from 0 to 15 */
+  int voice_scale;   /* How many times longer the voice polls are apart */
+  int button_scale;  /* How many times longer the button scans are apart */
+  int render_scale;  /* How many times longer the game map updates are apart */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Governor functions (only called from the core reading the battery, the mode can be read from either) */
+void                 Battery_Reset(int voltage);
+bool                 Battery_IsSensed();
+bool                 Battery_Update(int voltage);
+BatteryMode          Battery_GetMode();
+const BatteryBudget &Battery_GetBudget(BatteryMode mode);
+
+/* Reading functions */
+int           Battery_GetVoltage();
+int           Battery_GetPercent();
+unsigned long Battery_GetModeChanges();
+
+/* Reporting functions */
+void Battery_Dump(Print &out);
+
+#endif /* BATTERY_H */
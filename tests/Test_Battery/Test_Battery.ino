@@ -0,0 +1,191 @@
+/************************************************************
+ * @file Test_Battery.ino
+ * @brief The tests for the battery governor
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Battery.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+#include "FakeStream.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+FakeStream fake_serial; /* The Serial port the battery state is printed to */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Feeds the governor the same reading a number of times, the way it is read once a second
+ *
+ * @param voltage: The battery voltage in mV
+ * @param count: The number of readings
+ * @return int: The number of readings that changed the mode
+ */
+int UpdateBattery(int voltage, int count) {
+  int changes = 0;
+  for (int i = 0; i < count; i++) {
+    changes += Battery_Update(voltage) ? 1 : 0;
+  }
+  return changes;
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Battery_Reset tests
+ **/
+test(Battery_Reset_Success) {
+  /* The first reading picks the mode straight away */
+  Battery_Reset(BATTERY_FULL_VOLTAGE);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_NORMAL);
+  assertEqual(Battery_GetVoltage(), BATTERY_FULL_VOLTAGE);
+
+  Battery_Reset(BATTERY_SAVER_ENTER - 1);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_SAVER);
+
+  Battery_Reset(BATTERY_CRITICAL_ENTER - 1);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_CRITICAL);
+  assertEqual(Battery_GetModeChanges(), 0UL);
+}
+
+test(Battery_Reset_NoSensor) {
+  /* An unconnected pin reads near 0 mV, which is no battery rather than a flat one, so nothing is saved for it */
+  Battery_Reset(40);
+  assertEqual(Battery_IsSensed(), false);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_NORMAL);
+  assertEqual(UpdateBattery(0, 40), 0);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_NORMAL);
+
+  fake_serial.reset();
+  Battery_Dump(fake_serial);
+  assertEqual(fake_serial.bytesWritten(), String("BATTERY,none,40,0,0\r\n"));
+
+  Battery_Reset(BATTERY_NO_SENSOR);
+  assertEqual(Battery_IsSensed(), true);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_CRITICAL);
+}
+
+/**
+ * Battery_Update tests
+ **/
+test(Battery_Update_StepsDown_Success) {
+  Battery_Reset(BATTERY_FULL_VOLTAGE);
+
+  /* A drained battery steps down one mode at a time */
+  assertEqual(UpdateBattery(BATTERY_SAVER_ENTER - 50, 40), 1);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_SAVER);
+  assertEqual(UpdateBattery(BATTERY_CRITICAL_ENTER - 50, 40), 1);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_CRITICAL);
+  assertEqual(Battery_GetModeChanges(), 2UL);
+}
+
+test(Battery_Update_Sag_Success) {
+  Battery_Reset(BATTERY_SAVER_ENTER + 100);
+
+  /* A few readings taken while the LEDs draw the most do not change the mode */
+  assertEqual(UpdateBattery(BATTERY_SAVER_ENTER - 300, 2), 0);
+  assertEqual(UpdateBattery(BATTERY_SAVER_ENTER + 100, 20), 0);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_NORMAL);
+}
+
+test(Battery_Update_Hysteresis_Success) {
+  Battery_Reset(BATTERY_SAVER_ENTER - 10);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_SAVER);
+
+  /* The cells recovering under the lighter load does not bring the board straight back */
+  assertEqual(UpdateBattery(BATTERY_SAVER_ENTER + 10, 100), 0);
+  assertEqual(UpdateBattery(BATTERY_SAVER_EXIT, 100), 0);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_SAVER);
+
+  /* Only fresh batteries do */
+  assertEqual(UpdateBattery(BATTERY_SAVER_EXIT + 100, 100), 1);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_NORMAL);
+}
+
+test(Battery_Update_NoFlapping_Success) {
+  Battery_Reset(BATTERY_CRITICAL_ENTER + 10);
+
+  /* A reading wandering around a threshold changes the mode once */
+  int changes = 0;
+  for (int i = 0; i < 200; i++) {
+    changes += UpdateBattery((i % 2 == 0) ? BATTERY_CRITICAL_ENTER + 40 : BATTERY_CRITICAL_ENTER - 90, 1);
+  }
+  assertEqual(changes, 1);
+  assertEqual(Battery_GetMode(), BATTERY_MODE_CRITICAL);
+}
+
+/**
+ * Battery_GetBudget tests
+ **/
+test(Battery_GetBudget_Success) {
+  /* Each mode down does less work */
+  for (int mode = 1; mode < BATTERY_MODE_COUNT; mode++) {
+    const BatteryBudget &more = Battery_GetBudget((BatteryMode)(mode - 1));
+    const BatteryBudget &less = Battery_GetBudget((BatteryMode)mode);
+    assertLess(less.led_intensity, more.led_intensity);
+    assertMoreOrEqual(less.voice_scale, more.voice_scale);
+    assertMoreOrEqual(less.button_scale, more.button_scale);
+    assertMoreOrEqual(less.render_scale, more.render_scale);
+  }
+
+  /* The normal mode does not hold anything back */
+  assertEqual(Battery_GetBudget(BATTERY_MODE_NORMAL).led_intensity, 15);
+  assertEqual(Battery_GetBudget(BATTERY_MODE_NORMAL).button_scale, 1);
+}
+
+/**
+ * Battery_GetPercent tests
+ **/
+test(Battery_GetPercent_Success) {
+  Battery_Reset(BATTERY_FULL_VOLTAGE + 400);
+  assertEqual(Battery_GetPercent(), 100);
+
+  Battery_Reset((BATTERY_FULL_VOLTAGE + BATTERY_EMPTY_VOLTAGE) / 2);
+  assertEqual(Battery_GetPercent(), 50);
+
+  Battery_Reset(BATTERY_EMPTY_VOLTAGE - 400);
+  assertEqual(Battery_GetPercent(), 0);
+}
+
+/**
+ * Battery_Dump tests
+ **/
+test(Battery_Dump_Success) {
+  Battery_Reset(BATTERY_FULL_VOLTAGE);
+  UpdateBattery(BATTERY_SAVER_ENTER - 200, 100);
+  fake_serial.reset();
+  Battery_Dump(fake_serial);
+
+  assertEqual(fake_serial.bytesWritten(), String("BATTERY,saver,4800,25,1\r\n"));
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
@@ -357,10 +357,12 @@ bool Checkers::Checkers_HasMove()
 /**
  * A turn (or a partial turn) for a player, where a piece will move from one spot to another
  *
- * @param from: The square where the desired piece to move is
- * @param to:   The square to move the desired piece to
+ * @param move: The move from the square where the desired piece to move is to the square to move it to
  */
-int Checkers::Checkers_Turn(int from[2], int to[2]) {
+int Checkers::Checkers_Turn(Move move) {
+  int from[2] = {Move_GetRow(move.from), Move_GetCol(move.from)};
+  int to[2] = {Move_GetRow(move.to), Move_GetCol(move.to)};
+
   /* If the jump lock indicates a jump but doesn't match the square, return that move was invalid */
   if (jump_lock[2] == 1 && (from[0] != jump_lock[0] || from[1] != jump_lock[1])) {
     return 0;
@@ -398,6 +400,12 @@ int Checkers::Checkers_Turn(int from[2], int to[2]) {
     
     /* Clear the original square */
     board[from[0]][from[1]] = 0;
+
+    /* If the other player is left without a move, then the game ends (with the winner variable being set and the active player being the winner) and return the move is valid */
+    if (Checkers_HasMove() == 0) {
+      won = 1;
+      return 1;
+    }
   }
   /* If there is a jump available for a regular piece (with the proper conditions met where an empty square follows an opposing piece), then the move can be valid */
   else if (board[to[0]][to[1]] == 0 && /* Checks if the desired space is empty */
@@ -448,8 +456,8 @@ int Checkers::Checkers_Turn(int from[2], int to[2]) {
   /* If there is a jump available for a king piece (with the proper conditions met where an empty square follows an opposing piece), then the move can be valid */
   else if (board[to[0]][to[1]] == 0 && /* Checks if the desired space is empty */
            (to[0] == from[0] - 2 || to[0] == from[0] + 2) && (to[1] == from[1] - 2 || to[1] == from[1] + 2) && /* Checks if the space is a valid jump space */
-           (board[from[0]][from[1]] == 3 && (board[(to[0] + from[0]) / 2][(to[1] + from[1]) / 2] == 2 || board[(to[0] + from[0]) / 2][(to[1] + from[1]) / 2] == 4)) || /* Checks if there is an opposing piece in between (player 1) */
-           (board[from[0]][from[1]] == 4 && (board[(to[0] + from[0]) / 2][(to[1] + from[1]) / 2] == 1 || board[(to[0] + from[0]) / 2][(to[1] + from[1]) / 2] == 3))) { /* Checks if there is an opposing piece in between (player 2) */
+           ((board[from[0]][from[1]] == 3 && (board[(to[0] + from[0]) / 2][(to[1] + from[1]) / 2] == 2 || board[(to[0] + from[0]) / 2][(to[1] + from[1]) / 2] == 4)) || /* Checks if there is an opposing piece in between (player 1) */
+            (board[from[0]][from[1]] == 4 && (board[(to[0] + from[0]) / 2][(to[1] + from[1]) / 2] == 1 || board[(to[0] + from[0]) / 2][(to[1] + from[1]) / 2] == 3)))) { /* Checks if there is an opposing piece in between (player 2) */
     /* Update the new square with the current piece */
     board[to[0]][to[1]] = board[from[0]][from[1]];
 
@@ -491,4 +499,78 @@ int Checkers::Checkers_Turn(int from[2], int to[2]) {
   jump_lock[2] = 0;
   active_player = 3 - active_player;
   return 1;
+}
+
+/**
+ * Packs the game into a snapshot
+ *
+ * @param snapshot: The snapshot to fill in
+ */
+void Checkers::Checkers_Save(CheckersSnapshot &snapshot) {
+  /* Only the dark squares can hold a piece, which is every other square starting from column 0 on even rows and column 1 on odd rows */
+  for (int i = 0; i < CHECKERS_SNAPSHOT_SQUARES; i++) {
+    int row = i / 4;
+    int col = (i % 4) * 2 + (row % 2);
+    if (i % 2 == 0) {
+      snapshot.squares[i / 2] = (uint8_t)board[row][col];
+    }
+    else {
+      snapshot.squares[i / 2] |= (uint8_t)(board[row][col] << 4);
+    }
+  }
+
+  snapshot.active_player = (uint8_t)active_player;
+  snapshot.jump = (jump_lock[2] == 1) ? Move_MakeSquare(jump_lock[0], jump_lock[1]) : SQUARE_NONE;
+  snapshot.won = won ? 1 : 0;
+  snapshot.reserved = 0;
+}
+
+/**
+ * Replaces the game with the one packed into a snapshot, leaving the game unchanged if the snapshot does not hold a game
+ *
+ * @param snapshot: The snapshot to unpack
+ * @return bool: If the snapshot held a game and was loaded
+ */
+bool Checkers::Checkers_Load(const CheckersSnapshot &snapshot) {
+  int squares[CHECKERS_SNAPSHOT_SQUARES];
+  int counts[5] = {0, 0, 0, 0, 0};
+
+  /* Checks every field before touching the game, so a damaged snapshot can't leave half a game behind */
+  for (int i = 0; i < CHECKERS_SNAPSHOT_SQUARES; i++) {
+    squares[i] = (i % 2 == 0) ? (snapshot.squares[i / 2] & 0x0F) : (snapshot.squares[i / 2] >> 4);
+    if (squares[i] > 4) {
+      return false;
+    }
+    counts[squares[i]]++;
+  }
+  if ((snapshot.active_player != 1 && snapshot.active_player != 2) || snapshot.won > 1 || counts[1] + counts[3] > 12 || counts[2] + counts[4] > 12) {
+    return false;
+  }
+
+  /* The square to keep jumping from has to be a dark square holding one of the active player's pieces */
+  int jump_row = Move_GetRow(snapshot.jump);
+  int jump_col = Move_GetCol(snapshot.jump);
+  if (snapshot.jump != SQUARE_NONE) {
+    if (jump_row >= 8 || (jump_row + jump_col) % 2 != 0) {
+      return false;
+    }
+    int piece = squares[jump_row * 4 + jump_col / 2];
+    if (piece != snapshot.active_player && piece != snapshot.active_player + 2) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < 8; i++) {   /* For iterating through the rows */
+    for (int j = 0; j < 8; j++) { /* For iterating through the columns */
+      board[i][j] = ((i + j) % 2 == 0) ? squares[i * 4 + j / 2] : 0;
+    }
+  }
+  p1_count = counts[1] + counts[3];
+  p2_count = counts[2] + counts[4];
+  active_player = snapshot.active_player;
+  jump_lock[0] = jump_row;
+  jump_lock[1] = jump_col;
+  jump_lock[2] = (snapshot.jump != SQUARE_NONE) ? 1 : 0;
+  won = snapshot.won;
+  return true;
 }
\ No newline at end of file
@@ -13,6 +13,20 @@
  **********************************/
 #include "ArduinoUnit.h"
 
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Packs a move from row and column arrays
+ *
+ * @param from: The row and column to move the piece from
+ * @param to: The row and column to move the piece to
+ * @return Move: The move
+ */
+Move CreateMove(int from[2], int to[2]) {
+  return Move_Make(Move_MakeSquare(from[0], from[1]), Move_MakeSquare(to[0], to[1]));
+}
+
 /**********************************
  ** Tests
  **********************************/
@@ -456,7 +470,7 @@ test(Checkers_Turn_JumpLock_Fail) {
   int from[2] = {5, 1};
   int to[2] = {4, 0};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 0);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 0);
 }
 
 test(Checkers_Turn_OutOfBounds_Fail) {
@@ -465,7 +479,7 @@ test(Checkers_Turn_OutOfBounds_Fail) {
   int from[2] = {8, 8};
   int to[2] = {10, 10};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 0);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 0);
 }
 
 test(Checkers_Turn_InvalidSquare_Fail) {
@@ -474,7 +488,7 @@ test(Checkers_Turn_InvalidSquare_Fail) {
   int from[2] = {5, 2};
   int to[2] = {4, 3};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 0);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 0);
 }
 
 test(Checkers_Turn_InvalidMove_Fail) {
@@ -483,7 +497,7 @@ test(Checkers_Turn_InvalidMove_Fail) {
   int from[2] = {2, 2};
   int to[2] = {1, 1};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 0);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 0);
 }
 
 test(Checkers_Turn_IllegalMove_Fail) {
@@ -492,7 +506,7 @@ test(Checkers_Turn_IllegalMove_Fail) {
   int from[2] = {5, 3};
   int to[2] = {2, 2};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 0);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 0);
 }
 
 test(Checkers_Turn_NormalMove_NoKinging_Success) {
@@ -501,7 +515,7 @@ test(Checkers_Turn_NormalMove_NoKinging_Success) {
   int from[2] = {5, 3};
   int to[2] = {4, 4};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 1);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
   assertEqual(checkers_game.Checkers_GetActivePlayer(), 2);
   assertEqual(checkers_game.Checkers_GetBoardAt(5, 3), 0);
   assertEqual(checkers_game.Checkers_GetBoardAt(4, 4), 1);
@@ -516,12 +530,35 @@ test(Checkers_Turn_NormalMove_Kinging_Success) {
   int from[2] = {1, 1};
   int to[2] = {0, 0};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 1);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
   assertEqual(checkers_game.Checkers_GetActivePlayer(), 2);
   assertEqual(checkers_game.Checkers_GetBoardAt(1, 1), 0);
   assertEqual(checkers_game.Checkers_GetBoardAt(0, 0), 3);
 }
 
+test(Checkers_Turn_NormalMove_Player2Blocked_Success) {
+  Checkers checkers_game;
+
+  /* Player 2's only piece is stuck behind player 1's pieces once the move is made */
+  for (int i = 0; i < 8; i++) {
+    for (int j = 0; j < 8; j++) {
+      checkers_game.board[i][j] = 0;
+    }
+  }
+  checkers_game.board[6][0] = 2;
+  checkers_game.board[7][1] = 3;
+  checkers_game.board[5][3] = 1;
+  checkers_game.p1_count = 2;
+  checkers_game.p2_count = 1;
+
+  int from[2] = {5, 3};
+  int to[2] = {4, 4};
+
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
+  assertEqual(checkers_game.Checkers_GetActivePlayer(), 1);
+  assertEqual(checkers_game.Checkers_GetWin(), 1);
+}
+
 test(Checkers_Turn_NormalJump_Player1_Success) {
   Checkers checkers_game;
 
@@ -530,7 +567,7 @@ test(Checkers_Turn_NormalJump_Player1_Success) {
   int from[2] = {5, 3};
   int to[2] = {3, 1};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 1);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
   assertEqual(checkers_game.Checkers_GetActivePlayer(), 2);
   assertEqual(checkers_game.Checkers_GetBoardAt(5, 3), 0);
   assertEqual(checkers_game.Checkers_GetBoardAt(3, 1), 1);
@@ -547,7 +584,7 @@ test(Checkers_Turn_NormalJump_King1_Success) {
   int from[2] = {5, 3};
   int to[2] = {3, 1};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 1);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
   assertEqual(checkers_game.Checkers_GetActivePlayer(), 2);
   assertEqual(checkers_game.Checkers_GetBoardAt(5, 3), 0);
   assertEqual(checkers_game.Checkers_GetBoardAt(3, 1), 3);
@@ -564,7 +601,7 @@ test(Checkers_Turn_NormalJump_Player2_Success) {
   int from[2] = {2, 2};
   int to[2] = {4, 0};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 1);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
   assertEqual(checkers_game.Checkers_GetActivePlayer(), 1);
   assertEqual(checkers_game.Checkers_GetBoardAt(2, 2), 0);
   assertEqual(checkers_game.Checkers_GetBoardAt(4, 0), 2);
@@ -581,7 +618,7 @@ test(Checkers_Turn_NormalJump_Player1Win_Success) {
   int from[2] = {5, 3};
   int to[2] = {3, 1};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 1);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
   assertEqual(checkers_game.Checkers_GetActivePlayer(), 1);
   assertEqual(checkers_game.Checkers_GetBoardAt(5, 3), 0);
   assertEqual(checkers_game.Checkers_GetBoardAt(3, 1), 1);
@@ -599,7 +636,7 @@ test(Checkers_Turn_NormalJump_Player1JumpLock_Success) {
   int from[2] = {5, 3};
   int to[2] = {3, 1};
 
-  assertEqual(checkers_game.Checkers_Turn(from, to), 1);
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
   assertEqual(checkers_game.Checkers_GetActivePlayer(), 1);
   assertEqual(checkers_game.Checkers_GetBoardAt(5, 3), 0);
   assertEqual(checkers_game.Checkers_GetBoardAt(3, 1), 1);
@@ -607,6 +644,103 @@ test(Checkers_Turn_NormalJump_Player1JumpLock_Success) {
   assertEqual(checkers_game.Checkers_GetP2Count(), 11);
 }
 
+test(Checkers_Turn_KingJump_Player2_NotJumpSpace_Fail) {
+  Checkers checkers_game;
+
+  checkers_game.board[1][1] = 4;
+  checkers_game.board[3][3] = 1;
+  checkers_game.active_player = 2;
+
+  /* The piece in between the squares is an opposing one, but the squares are not a jump apart and the square is taken */
+  int from[2] = {1, 1};
+  int to[2] = {5, 5};
+
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 0);
+  assertEqual(checkers_game.Checkers_GetBoardAt(1, 1), 4);
+  assertEqual(checkers_game.Checkers_GetBoardAt(5, 5), 1);
+  assertEqual(checkers_game.Checkers_GetP1Count(), 12);
+}
+
+/**
+ * Checkers_Save and Checkers_Load tests
+ **/
+test(Checkers_Save_NewGame_Success) {
+  Checkers checkers_game;
+  CheckersSnapshot snapshot;
+
+  checkers_game.Checkers_Save(snapshot);
+
+  /* The first 3 rows are player 2's men and the last 3 are player 1's, 4 dark squares and 2 bytes to a row */
+  assertEqual(snapshot.squares[0], 0x22);
+  assertEqual(snapshot.squares[5], 0x22);
+  assertEqual(snapshot.squares[6], 0x00);
+  assertEqual(snapshot.squares[9], 0x00);
+  assertEqual(snapshot.squares[10], 0x11);
+  assertEqual(snapshot.squares[15], 0x11);
+  assertEqual(snapshot.active_player, 1);
+  assertEqual(snapshot.jump, SQUARE_NONE);
+  assertEqual(snapshot.won, 0);
+}
+
+test(Checkers_Load_JumpLock_Success) {
+  Checkers checkers_game;
+  Checkers loaded_game;
+  CheckersSnapshot snapshot;
+
+  /* Takes one jump of a double jump so the jump lock is kept */
+  checkers_game.board[4][2] = 2;
+  checkers_game.board[1][3] = 0;
+  checkers_game.board[6][4] = 3;
+  int from[2] = {5, 3};
+  int to[2] = {3, 1};
+  assertEqual(checkers_game.Checkers_Turn(CreateMove(from, to)), 1);
+
+  checkers_game.Checkers_Save(snapshot);
+  assertEqual(loaded_game.Checkers_Load(snapshot), true);
+
+  for (int i = 0; i < 8; i++) {
+    for (int j = 0; j < 8; j++) {
+      assertEqual(loaded_game.Checkers_GetBoardAt(i, j), checkers_game.Checkers_GetBoardAt(i, j));
+    }
+  }
+  assertEqual(loaded_game.Checkers_GetP1Count(), 12);
+  assertEqual(loaded_game.Checkers_GetP2Count(), 11);
+  assertEqual(loaded_game.Checkers_GetActivePlayer(), 1);
+  assertEqual(loaded_game.jump_lock[2], 1);
+  assertEqual(loaded_game.jump_lock[0], 3);
+  assertEqual(loaded_game.jump_lock[1], 1);
+
+  /* The loaded game still has to finish the jump from the same piece */
+  int other_from[2] = {5, 1};
+  int other_to[2] = {4, 0};
+  assertEqual(loaded_game.Checkers_Turn(CreateMove(other_from, other_to)), 0);
+}
+
+test(Checkers_Load_InvalidSquare_Fail) {
+  Checkers checkers_game;
+  CheckersSnapshot snapshot;
+
+  checkers_game.Checkers_Save(snapshot);
+  snapshot.squares[6] = 0x05;
+  snapshot.active_player = 2;
+
+  assertEqual(checkers_game.Checkers_Load(snapshot), false);
+  assertEqual(checkers_game.Checkers_GetActivePlayer(), 1);
+  assertEqual(checkers_game.Checkers_GetBoardAt(3, 1), 0);
+}
+
+test(Checkers_Load_InvalidJump_Fail) {
+  Checkers checkers_game;
+  CheckersSnapshot snapshot;
+
+  /* The square to keep jumping from holds the other player's piece */
+  checkers_game.Checkers_Save(snapshot);
+  snapshot.jump = Move_MakeSquare(0, 0);
+
+  assertEqual(checkers_game.Checkers_Load(snapshot), false);
+  assertEqual(checkers_game.jump_lock[2], 0);
+}
+
 /**********************************
  ** Function Definitions
  **********************************/
@@ -0,0 +1,55 @@
+/************************************************************
+ * @file Handoff.h
+ * @brief The header for passing moves and game state between the input and game cores
+ * @note This file is copied over from src and modified for testing
+ ************************************************************/
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <atomic>
+#include "circular_queue/circular_queue.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define HANDOFF_MOVE_QUEUE_SIZE (8) /* The number of moves that can wait for the game core */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A move waiting for the game core */
+struct HandoffMove {
+  Move          move;  /* The move */
+  unsigned long trace; /* The latency trace ID that follows the move to the LEDs */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* All globals are made visible so tests can directly check these values */
+extern circular_queue<HandoffMove> handoff_moves;
+extern Checkers                    handoff_snapshots[2];
+extern std::atomic<int>            handoff_front;
+extern std::atomic<unsigned long>  handoff_sequence;
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Move queue functions (one producer on the input core, one consumer on the game core) */
+bool Handoff_PushMove(const Move &move, unsigned long trace);
+bool Handoff_PopMove(Move &move, unsigned long &trace);
+
+/* Game snapshot functions (written by the game core, read from either core) */
+void     Handoff_PublishSnapshot(const Checkers &checker_game);
+Checkers Handoff_GetSnapshot();
+
+#endif /* HANDOFF_H */
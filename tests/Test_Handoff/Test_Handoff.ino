@@ -0,0 +1,153 @@
+/************************************************************
+ * @file Test_Handoff.ino
+ * @brief The tests for passing moves and game state between the input and game cores
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Handoff.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Takes every move out of the queue so each test starts with it empty
+ *
+ */
+void ResetMoveQueue() {
+  Move move;
+  unsigned long trace;
+  while (Handoff_PopMove(move, trace)) {}
+}
+
+/**
+ * Creates a move to queue
+ *
+ * @param from_row: The row to move the piece from
+ * @param from_col: The column to move the piece from
+ * @param to_row: The row to move the piece to
+ * @param to_col: The column to move the piece to
+ * @return Move: The move
+ */
+Move CreateMove(int from_row, int from_col, int to_row, int to_col) {
+  return Move_Make(Move_MakeSquare(from_row, from_col), Move_MakeSquare(to_row, to_col));
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Handoff_PushMove and Handoff_PopMove tests
+ **/
+test(Handoff_PopMove_Empty_Failure) {
+  ResetMoveQueue();
+  Move move;
+  unsigned long trace;
+
+  assertEqual(Handoff_PopMove(move, trace), false);
+}
+
+test(Handoff_PushMove_Order_Success) {
+  ResetMoveQueue();
+  Move move;
+  unsigned long trace;
+
+  assertEqual(Handoff_PushMove(CreateMove(5, 1, 4, 0), 7), true);
+  assertEqual(Handoff_PushMove(CreateMove(2, 0, 3, 1), 8), true);
+
+  /* Moves come out in the order they were queued, each with its trace ID */
+  assertEqual(Handoff_PopMove(move, trace), true);
+  assertEqual(move.from, Move_MakeSquare(5, 1));
+  assertEqual(move.to, Move_MakeSquare(4, 0));
+  assertEqual(trace, 7);
+
+  assertEqual(Handoff_PopMove(move, trace), true);
+  assertEqual(move.from, Move_MakeSquare(2, 0));
+  assertEqual(move.to, Move_MakeSquare(3, 1));
+  assertEqual(trace, 8);
+
+  assertEqual(Handoff_PopMove(move, trace), false);
+}
+
+test(Handoff_PushMove_Full_Failure) {
+  ResetMoveQueue();
+  Move move;
+  unsigned long trace;
+
+  for (int i = 0; i < HANDOFF_MOVE_QUEUE_SIZE; i++) {
+    assertEqual(Handoff_PushMove(CreateMove(i, 0, i, 1), i + 1), true);
+  }
+
+  /* The newest move is dropped when the game core falls behind */
+  assertEqual(Handoff_PushMove(CreateMove(7, 7, 6, 6), HANDOFF_MOVE_QUEUE_SIZE + 1), false);
+
+  assertEqual(Handoff_PopMove(move, trace), true);
+  assertEqual(move.from, Move_MakeSquare(0, 0));
+  ResetMoveQueue();
+}
+
+/**
+ * Handoff_PublishSnapshot and Handoff_GetSnapshot tests
+ **/
+test(Handoff_GetSnapshot_Success) {
+  Checkers checkers_game;
+  checkers_game.Checkers_Turn(CreateMove(5, 1, 4, 0));
+  Handoff_PublishSnapshot(checkers_game);
+
+  Checkers snapshot = Handoff_GetSnapshot();
+  assertEqual(snapshot.Checkers_GetActivePlayer(), 2);
+  assertEqual(snapshot.Checkers_GetBoardAt(5, 1), 0);
+  assertEqual(snapshot.Checkers_GetBoardAt(4, 0), 1);
+
+  /* Later changes to the game are not seen until they are published */
+  checkers_game.Checkers_Turn(CreateMove(2, 0, 3, 1));
+  assertEqual(Handoff_GetSnapshot().Checkers_GetActivePlayer(), 2);
+
+  Handoff_PublishSnapshot(checkers_game);
+  assertEqual(Handoff_GetSnapshot().Checkers_GetActivePlayer(), 1);
+}
+
+test(Handoff_PublishSnapshot_Swap_Success) {
+  Checkers checkers_game;
+  int front = handoff_front.load();
+  unsigned long sequence = handoff_sequence.load();
+
+  /* Each publish writes the back buffer then swaps it to the front */
+  Handoff_PublishSnapshot(checkers_game);
+  assertEqual(handoff_front.load(), 1 - front);
+  assertEqual(handoff_sequence.load(), sequence + 1);
+
+  Handoff_PublishSnapshot(checkers_game);
+  assertEqual(handoff_front.load(), front);
+  assertEqual(handoff_sequence.load(), sequence + 2);
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
@@ -0,0 +1,60 @@
+/************************************************************
+ * @file Checkers.h
+ * @brief The header for the Checkers game algorithm
+ ************************************************************/
+#ifndef CHECKERS_H
+#define CHECKERS_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Move.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define CHECKERS_SNAPSHOT_SQUARES (32) /* The number of dark squares, the only ones a piece can stand on */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A game packed into 20 bytes, for keeping it somewhere small such as flash */
+struct CheckersSnapshot {
+  uint8_t squares[CHECKERS_SNAPSHOT_SQUARES / 2]; /* The state of each dark square in row order, two to a byte (low nibble first) */
+  uint8_t active_player;                          /* The active player's turn */
+  Square  jump;                                   /* The square the active player has to keep jumping from, or SQUARE_NONE */
+  uint8_t won;                                    /* Indicator for if there is a winner */
+  uint8_t reserved;                               /* Unused, keeps the size a multiple of 4 bytes */
+};
+
+/*********************************************
+ ** Class Declarations and Function Prototypes
+ *********************************************/
+class Checkers {
+  public:
+    /* Functions */
+    Checkers();
+    int  Checkers_GetBoardAt(int row, int col);
+    int  Checkers_GetP1Count();
+    int  Checkers_GetP2Count();
+    int  Checkers_GetActivePlayer();
+    int  Checkers_GetWin();
+    int  Checkers_Turn(Move move);
+    void Checkers_Save(CheckersSnapshot &snapshot);
+    bool Checkers_Load(const CheckersSnapshot &snapshot);
+  private:
+    /* Members */
+    int  board[8][8];     /* The active game map */
+    int  p1_count;        /* The piece count for player 1 */
+    int  p2_count;        /* The piece count for player 2 */
+    int  active_player;   /* The active player's turn */
+    int  jump_lock[3];    /* Indicator for if there is a jump available (First two indicies are the move and the third index indicates if there is a jump) */
+    bool won;             /* Indicator for if there is a winner */
+    
+    /* Functions */
+    bool Checkers_TurnOver(int to[2]);
+    bool Checkers_CanJump();
+    bool Checkers_HasMove();
+};
+
+#endif /* CHECKERS_H */
\ No newline at end of file
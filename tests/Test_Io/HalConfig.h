@@ -0,0 +1,16 @@
+/************************************************************
+ * @file HalConfig.h
+ * @brief The backend selection for the hardware abstraction layer
+ *
+ * @note This file is the only one not copied over from src, so the I/O tests run the shipped code on the
+ *       counting backend instead of the board
+ ************************************************************/
+#ifndef HALCONFIG_H
+#define HALCONFIG_H
+
+/**********************************
+ ** Defines
+ **********************************/
+#define HAL_COUNTING /* Swaps the board for the counting backend */
+
+#endif /* HALCONFIG_H */
@@ -1,18 +1,136 @@
 /************************************************************
  * @file Test_Io.ino
  * @brief The tests for the I/O module
+ *
+ * @note Io.cpp is the shipped source, built against the counting HAL backend so the tests can check the
+ *       pins it drives and how much I/O each call costs
  ************************************************************/
 
 /**********************************
  ** Library Includes
  **********************************/
+#include "Checkers.h"
+#include "Hal.h"
 #include "Io.h"
+#include "Move.h"
 
 /**********************************
  ** Third Party Libraries Includes
  **********************************/
 #include "ArduinoUnit.h"
 
+/**********************************
+ ** Defines
+ **********************************/
+/* Pins */
+#define BUTTON_ARRAY_PIN1              (36)
+#define BUTTON_ARRAY_PIN2              (39)
+#define BUTTON_ARRAY_PIN3              (34)
+#define BUTTON_ARRAY_PIN4              (35)
+#define BUTTON_POWER_PIN               (32)
+#define PLAYER1_TURN_INDICATOR_LED_PIN (12)
+#define PLAYER2_TURN_INDICATOR_LED_PIN (13)
+#define BATTERY_PIN                    (4)
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The private I/O state, so tests can reset and check it */
+extern HalLedChip    red_lc;
+extern HalLedChip    blue_lc;
+extern HalLedChip    green_lc;
+extern int           blink_player;
+extern unsigned long blink_start;
+extern int           turn_indicator_levels[2];
+
+/* Variables for the faked Voice Recognition module */
+bool voice_has_move; /* Indicator for if the faked Voice Recognition module has a move */
+Move voice_move;     /* The move the faked Voice Recognition module returns */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+void IO_MapToMaxChip(int row, int col, int &max_row, int &max_col);
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * This function fakes VoiceRecognition_GetInput, which IO_GetVoiceRecognitionInput passes straight through
+ *
+ * @param checker_move: The move being returned
+ * @return bool: If there was a move
+ */
+bool VoiceRecognition_GetInput(Move &checker_move) {
+  if (voice_has_move == true) {
+    checker_move = voice_move;
+  }
+
+  return voice_has_move;
+}
+
+/**
+ * Resets the turn indicator state so each test starts from unknown LED levels
+ *
+ */
+void ResetTurnIndicator() {
+  blink_player = 0;
+  blink_start = 0;
+  turn_indicator_levels[0] = -1;
+  turn_indicator_levels[1] = -1;
+  Hal_Reset();
+}
+
+/**
+ * Counts the LEDs lit on a MAX chip
+ *
+ * @param chip: The chip to count
+ * @return int: The number of LEDs lit
+ */
+int CountLeds(HalLedChip &chip) {
+  int count = 0;
+
+  for (int row = 0; row < 8; row++) {
+    for (int col = 0; col < 8; col++) {
+      if (chip.leds[row][col] == true) {
+        count++;
+      }
+    }
+  }
+
+  return count;
+}
+
+/**
+ * Presses each button of a button array in turn and checks the square and the number of ADC reads
+ *
+ * @param pin: The analog pin of the button array
+ * @param row: The even row the button array starts on
+ * @return bool: If every button gave the right square with one read per button array
+ */
+bool CheckButtonArray(int pin, int row) {
+  int intervals[8] = {0, 125, 670, 1250, 1700, 2100, 2550, 2930};
+  Square expected_move = SQUARE_NONE;
+
+  for (int i = 0; i < 8; i++) {
+    Hal_Reset();
+    hal_analog_readings[pin] = intervals[i];
+
+    if (i < 4) {
+      expected_move = Move_MakeSquare(row, i * 2);
+    }
+    else {
+      expected_move = Move_MakeSquare(row + 1, (i * 2) - 7);
+    }
+
+    if (IO_GetButtonInput() != expected_move || hal_counters.analog_read_calls != 4) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 /**********************************
  ** Tests
  **********************************/
@@ -52,346 +170,211 @@ test(IO_MapToMaxChip_Success) {
   }
 }
 
-/**
- * IO_ConvertMapToIndices tests
- **/
-test(IO_ConvertMapToIndices_Success) {
-  String move_string_1[2] = {"A1", "B2"};
-  String move_string_2[2] = {"C8", "C7"};
-  String move_string_3[2] = {"D4", "H1"};
-  String move_string_4[2] = {"E5", "G3"};
-  String move_string_5[2] = {"B6", "F3"};
-
-  int move_int_1[2][2];
-  int move_int_2[2][2];
-  int move_int_3[2][2];
-  int move_int_4[2][2];
-  int move_int_5[2][2];
-
-  IO_ConvertMapToIndices(move_string_1, move_int_1);
-  IO_ConvertMapToIndices(move_string_2, move_int_2);
-  IO_ConvertMapToIndices(move_string_3, move_int_3);
-  IO_ConvertMapToIndices(move_string_4, move_int_4);
-  IO_ConvertMapToIndices(move_string_5, move_int_5);
-
-  /* Verify integer array is equivalent to expected values */
-  assertEqual(move_int_1[0][0], 0);
-  assertEqual(move_int_1[0][1], 0);
-  assertEqual(move_int_1[1][0], 1);
-  assertEqual(move_int_1[1][1], 1);
-  assertEqual(move_int_2[0][0], 2);
-  assertEqual(move_int_2[0][1], 7);
-  assertEqual(move_int_2[1][0], 2);
-  assertEqual(move_int_2[1][1], 6);
-  assertEqual(move_int_3[0][0], 3);
-  assertEqual(move_int_3[0][1], 3);
-  assertEqual(move_int_3[1][0], 7);
-  assertEqual(move_int_3[1][1], 0);
-  assertEqual(move_int_4[0][0], 4);
-  assertEqual(move_int_4[0][1], 4);
-  assertEqual(move_int_4[1][0], 6);
-  assertEqual(move_int_4[1][1], 2);
-  assertEqual(move_int_5[0][0], 1);
-  assertEqual(move_int_5[0][1], 5);
-  assertEqual(move_int_5[1][0], 5);
-  assertEqual(move_int_5[1][1], 2);
-}
-
 /**
  * IO_GetVoiceRecognitionInput tests
  **/
 test(IO_GetVoiceRecognitionInput_Success) {
-  String test_input_1 = "A1 B2";
-  String test_input_2 = "E";
-  String test_input_3 = "C6 E4";
-  String test_input_4 = "";
+  Move move_command = Move_Make(SQUARE_NONE, SQUARE_NONE);
 
-  String move_command_1[2];
-  String move_command_2[2];
-  String move_command_3[2];
-  String move_command_4[2];
+  voice_has_move = true;
+  voice_move = Move_Make(Move_MakeSquare(2, 5), Move_MakeSquare(4, 3));
 
-  IO_GetVoiceRecognitionInput(test_input_1, move_command_1);
-  IO_GetVoiceRecognitionInput(test_input_2, move_command_2);
-  IO_GetVoiceRecognitionInput(test_input_3, move_command_3);
-  IO_GetVoiceRecognitionInput(test_input_4, move_command_4);
+  assertEqual(IO_GetVoiceRecognitionInput(move_command), true);
 
   /* Verify outputted move command is equivalent to expected values */
-  assertEqual(move_command_1[0], "A1");
-  assertEqual(move_command_1[1], "B2");
-  assertEqual(move_command_2[0], "");
-  assertEqual(move_command_2[1], "");
-  assertEqual(move_command_3[0], "C6");
-  assertEqual(move_command_3[1], "E4");
-  assertEqual(move_command_4[0], "");
-  assertEqual(move_command_4[1], "");
+  assertEqual(move_command.from, Move_MakeSquare(2, 5));
+  assertEqual(move_command.to, Move_MakeSquare(4, 3));
+}
+
+test(IO_GetVoiceRecognitionInput_NoMove_Success) {
+  Move move_command = Move_Make(SQUARE_NONE, SQUARE_NONE);
+
+  voice_has_move = false;
+  voice_move = Move_Make(Move_MakeSquare(0, 0), Move_MakeSquare(1, 1));
+
+  assertEqual(IO_GetVoiceRecognitionInput(move_command), false);
+  assertEqual(move_command.from, SQUARE_NONE);
 }
 
 /**
  * IO_InitButton tests
  **/
 test(IO_InitButton_Success) {
-  int pin_adder = 0;
-  int input_counter = 0;
-  int output_counter = 0;
-  int low_counter = 0;
-  int high_counter = 0;
-
-  IO_InitButton(pin_adder, input_counter, output_counter, low_counter, high_counter);
-
-  /* Verify the pins called and the inputs and outputs set are correct, along with the low and high */
-  assertEqual(pin_adder, 208);
-  assertEqual(input_counter, 4);
-  assertEqual(output_counter, 1);
-  assertEqual(low_counter, 0);
-  assertEqual(high_counter, 1);
+  Hal_Reset();
+
+  IO_InitButton();
+
+  /* Verify the button arrays are inputs and the button power pin is driven high */
+  assertEqual(hal_pin_modes[BUTTON_ARRAY_PIN1], INPUT);
+  assertEqual(hal_pin_modes[BUTTON_ARRAY_PIN2], INPUT);
+  assertEqual(hal_pin_modes[BUTTON_ARRAY_PIN3], INPUT);
+  assertEqual(hal_pin_modes[BUTTON_ARRAY_PIN4], INPUT);
+  assertEqual(hal_pin_modes[BUTTON_POWER_PIN], OUTPUT);
+  assertEqual(hal_pin_levels[BUTTON_POWER_PIN], HIGH);
+  assertEqual(hal_counters.pin_mode_calls, 5);
+  assertEqual(hal_counters.digital_write_calls, 1);
+}
+
+/**
+ * IO_InitButtonWakeUp tests
+ **/
+test(IO_InitButtonWakeUp_Success) {
+  Hal_Reset();
+
+  IO_InitButtonWakeUp();
+
+  /* Verify a press pulling any button array low wakes the board, and nothing else does */
+  assertEqual(hal_wake_levels[BUTTON_ARRAY_PIN1], LOW);
+  assertEqual(hal_wake_levels[BUTTON_ARRAY_PIN2], LOW);
+  assertEqual(hal_wake_levels[BUTTON_ARRAY_PIN3], LOW);
+  assertEqual(hal_wake_levels[BUTTON_ARRAY_PIN4], LOW);
+  assertEqual(hal_wake_levels[BUTTON_POWER_PIN], -1);
+  assertEqual(hal_counters.pin_mode_calls, 0);
 }
 
 /**
  * IO_GetButtonInput tests
  **/
 test(IO_GetButtonInput_MultiplePress_Success) {
-  int pin_adder = 0;
-  int reading_adder = 0;
-  int delay_adder = 0;
+  Hal_Reset();
+  hal_analog_readings[BUTTON_ARRAY_PIN1] = 25;
+  hal_analog_readings[BUTTON_ARRAY_PIN2] = 25;
 
-  int reading[4] = {25, 25, 4095, 4095};
+  Square move_queue = IO_GetButtonInput();
 
-  String move_queue = IO_GetButtonInput(reading, pin_adder, reading_adder, delay_adder);
-
-  assertEqual(move_queue, "");
-  assertEqual(pin_adder, 144);
-  assertEqual(reading_adder, 8240);
-  assertEqual(delay_adder, 25);
+  assertEqual(move_queue, SQUARE_NONE);
+  assertEqual(hal_counters.analog_read_calls, 4);
 }
 
 test(IO_GetButtonInput_NoPress_Success) {
-  int pin_adder = 0;
-  int reading_adder = 0;
-  int delay_adder = 0;
-
-  int reading[4] = {4095, 4095, 4095, 4095};
+  Hal_Reset();
 
-  String move_queue = IO_GetButtonInput(reading, pin_adder, reading_adder, delay_adder);
+  Square move_queue = IO_GetButtonInput();
 
-  assertEqual(move_queue, "");
-  assertEqual(pin_adder, 144);
-  assertEqual(reading_adder, 16380);
-  assertEqual(delay_adder, 25);
+  /* Each button array is read once per scan, no matter how many thresholds it is checked against */
+  assertEqual(move_queue, SQUARE_NONE);
+  assertEqual(hal_counters.analog_read_calls, 4);
+  assertEqual(hal_counters.digital_write_calls, 0);
 }
 
-test(IO_GetButtonInput_RegularPress1_Success) {
-  int pin_adder = 0;
-  int reading_adder = 0;
-  int delay_adder = 0;
-  String expected_move = "";
-
-  int reading[4] = {4095, 4095, 4095, 4095};
-  int intervals[8] = {0, 125, 670, 1250, 1700, 2100, 2550, 2930};
+test(IO_GetButtonInput_OnThreshold_Success) {
+  int thresholds[8] = {40, 250, 800, 1400, 1850, 2250, 2700, 3300};
 
+  /* A reading right on a threshold is between two buttons, so it is not a press */
   for (int i = 0; i < 8; i++) {
-    pin_adder = 0;
-    reading_adder = 0;
-    delay_adder = 0;
-    expected_move = "";
+    Hal_Reset();
+    hal_analog_readings[BUTTON_ARRAY_PIN1] = thresholds[i];
 
-    reading[0] = intervals[i];
-    String move_queue = IO_GetButtonInput(reading, pin_adder, reading_adder, delay_adder);
-
-    if (i < 4) {
-      expected_move += 'A';
-      expected_move += (char)((i * 2) + 49);
-    }
-    else {
-      expected_move += 'B';
-      expected_move += (char)((i * 2) + 42);
-    }
-
-    assertEqual(move_queue, expected_move);
-    assertEqual(pin_adder, 144);
-    assertEqual(reading_adder, 12285 + intervals[i]);
-    assertEqual(delay_adder, 25);
+    assertEqual(IO_GetButtonInput(), SQUARE_NONE);
   }
 }
 
-test(IO_GetButtonInput_RegularPress2_Success) {
-  int pin_adder = 0;
-  int reading_adder = 0;
-  int delay_adder = 0;
-  String expected_move = "";
-
-  int reading[4] = {4095, 4095, 4095, 4095};
-  int intervals[8] = {0, 125, 670, 1250, 1700, 2100, 2550, 2930};
-
-  for (int i = 0; i < 8; i++) {
-    pin_adder = 0;
-    reading_adder = 0;
-    delay_adder = 0;
-    expected_move = "";
-
-    reading[1] = intervals[i];
-    String move_queue = IO_GetButtonInput(reading, pin_adder, reading_adder, delay_adder);
-
-    if (i < 4) {
-      expected_move += 'C';
-      expected_move += (char)((i * 2) + 49);
-    }
-    else {
-      expected_move += 'D';
-      expected_move += (char)((i * 2) + 42);
-    }
+test(IO_GetButtonInput_RegularPress1_Success) {
+  assertTrue(CheckButtonArray(BUTTON_ARRAY_PIN1, 0));
+}
 
-    assertEqual(move_queue, expected_move);
-    assertEqual(pin_adder, 144);
-    assertEqual(reading_adder, 12285 + intervals[i]);
-    assertEqual(delay_adder, 25);
-  }
+test(IO_GetButtonInput_RegularPress2_Success) {
+  assertTrue(CheckButtonArray(BUTTON_ARRAY_PIN2, 2));
 }
 
 test(IO_GetButtonInput_RegularPress3_Success) {
-  int pin_adder = 0;
-  int reading_adder = 0;
-  int delay_adder = 0;
-  String expected_move = "";
-
-  int reading[4] = {4095, 4095, 4095, 4095};
-  int intervals[8] = {0, 125, 670, 1250, 1700, 2100, 2550, 2930};
-
-  for (int i = 0; i < 8; i++) {
-    pin_adder = 0;
-    reading_adder = 0;
-    delay_adder = 0;
-    expected_move = "";
-
-    reading[2] = intervals[i];
-    String move_queue = IO_GetButtonInput(reading, pin_adder, reading_adder, delay_adder);
-
-    if (i < 4) {
-      expected_move += 'E';
-      expected_move += (char)((i * 2) + 49);
-    }
-    else {
-      expected_move += 'F';
-      expected_move += (char)((i * 2) + 42);
-    }
-
-    assertEqual(move_queue, expected_move);
-    assertEqual(pin_adder, 144);
-    assertEqual(reading_adder, 12285 + intervals[i]);
-    assertEqual(delay_adder, 25);
-  }
+  assertTrue(CheckButtonArray(BUTTON_ARRAY_PIN3, 4));
 }
 
 test(IO_GetButtonInput_RegularPress4_Success) {
-  int pin_adder = 0;
-  int reading_adder = 0;
-  int delay_adder = 0;
-  String expected_move = "";
-
-  int reading[4] = {4095, 4095, 4095, 4095};
-  int intervals[8] = {0, 125, 670, 1250, 1700, 2100, 2550, 2930};
-
-  for (int i = 0; i < 8; i++) {
-    pin_adder = 0;
-    reading_adder = 0;
-    delay_adder = 0;
-    expected_move = "";
-
-    reading[3] = intervals[i];
-    String move_queue = IO_GetButtonInput(reading, pin_adder, reading_adder, delay_adder);
-
-    if (i < 4) {
-      expected_move += 'G';
-      expected_move += (char)((i * 2) + 49);
-    }
-    else {
-      expected_move += 'H';
-      expected_move += (char)((i * 2) + 42);
-    }
-
-    assertEqual(move_queue, expected_move);
-    assertEqual(pin_adder, 144);
-    assertEqual(reading_adder, 12285 + intervals[i]);
-    assertEqual(delay_adder, 25);
-  }
+  assertTrue(CheckButtonArray(BUTTON_ARRAY_PIN4, 6));
 }
 
 /**
  * IO_InitTurnIndicator tests
  **/
 test(IO_InitTurnIndicator_Success) {
-  int pin_adder = 0;
-  int input_counter = 0;
-  int output_counter = 0;
+  Hal_Reset();
 
-  IO_InitTurnIndicator(pin_adder, input_counter, output_counter);
+  IO_InitTurnIndicator();
 
-  /* Verify the pins called and the inputs and outputs set are correct */
-  assertEqual(pin_adder, 25);
-  assertEqual(input_counter, 0);
-  assertEqual(output_counter, 2);
+  /* Verify both turn indicator pins are outputs */
+  assertEqual(hal_pin_modes[PLAYER1_TURN_INDICATOR_LED_PIN], OUTPUT);
+  assertEqual(hal_pin_modes[PLAYER2_TURN_INDICATOR_LED_PIN], OUTPUT);
+  assertEqual(hal_counters.pin_mode_calls, 2);
 }
 
 /**
  * IO_SetTurnIndicator tests
  **/
 test(IO_SetTurnIndicator_Success) {
+  ResetTurnIndicator();
+
   /* For player 1 */
-  int pin_adder = 0;
-  int low_counter = 0;
-  int high_counter = 0;
+  IO_SetTurnIndicator(1, 0);
 
-  IO_SetTurnIndicator(1, pin_adder, low_counter, high_counter);
+  assertEqual(hal_pin_levels[PLAYER1_TURN_INDICATOR_LED_PIN], HIGH);
+  assertEqual(hal_pin_levels[PLAYER2_TURN_INDICATOR_LED_PIN], LOW);
+  assertEqual(hal_counters.digital_write_calls, 2);
 
-  /* Verify the pins called and the lows and highs set are correct */
-  assertEqual(pin_adder, 25);
-  assertEqual(low_counter, 1);
-  assertEqual(high_counter, 1);
+  /* Pins already at the right level are not written again */
+  Hal_ResetCounters();
 
-  /* For player 2 */
-  pin_adder = 0;
-  low_counter = 0;
-  high_counter = 0;
+  IO_SetTurnIndicator(1, 10);
 
-  IO_SetTurnIndicator(2, pin_adder, low_counter, high_counter);
+  assertEqual(hal_counters.digital_write_calls, 0);
 
-  /* Verify the pins called and the lows and highs set are correct */
-  assertEqual(pin_adder, 25);
-  assertEqual(low_counter, 1);
-  assertEqual(high_counter, 1);
+  /* For player 2 */
+  IO_SetTurnIndicator(2, 20);
+
+  assertEqual(hal_pin_levels[PLAYER1_TURN_INDICATOR_LED_PIN], LOW);
+  assertEqual(hal_pin_levels[PLAYER2_TURN_INDICATOR_LED_PIN], HIGH);
+  assertEqual(hal_counters.digital_write_calls, 2);
 }
 
 /**
  * IO_BlinkTurnIndicator tests
  **/
 test(IO_BlinkTurnIndicator_Success) {
-  /* For player 1 */
-  int pin_adder = 0;
-  int low_counter = 0;
-  int high_counter = 0;
-  int delay_adder = 0;
+  /* For player 1, with the turn indicator already showing player 1 */
+  ResetTurnIndicator();
+  IO_SetTurnIndicator(1, 0);
+  Hal_ResetCounters();
+
+  /* The blink returns right away, the rest of it happens as the turn indicator gets updated */
+  IO_BlinkTurnIndicator(1, 1000);
+  assertEqual(hal_pin_levels[PLAYER1_TURN_INDICATOR_LED_PIN], LOW);
+  assertEqual(hal_counters.digital_write_calls, 1);
+
+  for (unsigned long now = 1000; now <= 1700; now = now + 10) {
+    IO_SetTurnIndicator(1, now);
+  }
 
-  IO_BlinkTurnIndicator(1, pin_adder, low_counter, high_counter, delay_adder);
+  /* Verify the LED went off, on, off and back on with one write for each change */
+  assertEqual(hal_pin_levels[PLAYER1_TURN_INDICATOR_LED_PIN], HIGH);
+  assertEqual(hal_counters.digital_write_calls, 4);
+  assertEqual(blink_player, 0);
 
-  /* Verify the pins called and the lows and highs set are correct with the delays set to the correct times */
-  assertEqual(pin_adder, 48);
-  assertEqual(low_counter, 2);
-  assertEqual(high_counter, 2);
-  assertEqual(delay_adder, 600);
+  /* For player 2, with the turn indicator already showing player 2 */
+  ResetTurnIndicator();
+  IO_SetTurnIndicator(2, 0);
+  Hal_ResetCounters();
 
-  /* For player 2 */
-  pin_adder = 0;
-  low_counter = 0;
-  high_counter = 0;
-  delay_adder = 0;
-
-  IO_BlinkTurnIndicator(2, pin_adder, low_counter, high_counter, delay_adder);
-
-  /* Verify the pins called and the lows and highs set are correct with the delays set to the correct times */
-  assertEqual(pin_adder, 52);
-  assertEqual(low_counter, 2);
-  assertEqual(high_counter, 2);
-  assertEqual(delay_adder, 600);
+  IO_BlinkTurnIndicator(2, 1000);
+
+  for (unsigned long now = 1000; now <= 1700; now = now + 10) {
+    IO_SetTurnIndicator(2, now);
+  }
+
+  assertEqual(hal_pin_levels[PLAYER2_TURN_INDICATOR_LED_PIN], HIGH);
+  assertEqual(hal_counters.digital_write_calls, 4);
+  assertEqual(blink_player, 0);
+}
+
+test(IO_BlinkTurnIndicator_TurnChange_Success) {
+  ResetTurnIndicator();
+  IO_BlinkTurnIndicator(1, 0);
+
+  /* The blink stops if the turn changes part way through */
+  IO_SetTurnIndicator(2, 100);
+  assertEqual(blink_player, 0);
+  assertEqual(hal_pin_levels[PLAYER1_TURN_INDICATOR_LED_PIN], LOW);
+  assertEqual(hal_pin_levels[PLAYER2_TURN_INDICATOR_LED_PIN], HIGH);
 }
 
 /**
@@ -399,91 +382,160 @@ test(IO_BlinkTurnIndicator_Success) {
  **/
 test(IO_WinnerTurnIndicator_Success) {
   /* For player 1 */
-  int pin_adder = 0;
-  int low_counter = 0;
-  int high_counter = 0;
-  int delay_adder = 0;
-
-  IO_WinnerTurnIndicator(1, pin_adder, low_counter, high_counter, delay_adder);
+  ResetTurnIndicator();
+  for (unsigned long now = 0; now < 2000; now = now + 10) {
+    IO_WinnerTurnIndicator(1, now);
+  }
 
-  /* Verify the pins called and the lows and highs set are correct with the delays set to the correct times */
-  assertEqual(pin_adder, 37);
-  assertEqual(low_counter, 2);
-  assertEqual(high_counter, 1);
-  assertEqual(delay_adder, 2000);
+  /* Verify the pins are only written when they change over one on/off cycle */
+  assertEqual(hal_pin_levels[PLAYER1_TURN_INDICATOR_LED_PIN], LOW);
+  assertEqual(hal_pin_levels[PLAYER2_TURN_INDICATOR_LED_PIN], LOW);
+  assertEqual(hal_counters.digital_write_calls, 3);
 
   /* For player 2 */
-  pin_adder = 0;
-  low_counter = 0;
-  high_counter = 0;
-  delay_adder = 0;
-
-  IO_WinnerTurnIndicator(2, pin_adder, low_counter, high_counter, delay_adder);
-
-  /* Verify the pins called and the lows and highs set are correct with the delays set to the correct times */
-  assertEqual(pin_adder, 38);
-  assertEqual(low_counter, 2);
-  assertEqual(high_counter, 1);
-  assertEqual(delay_adder, 2000);
+  ResetTurnIndicator();
+  for (unsigned long now = 0; now < 1000; now = now + 10) {
+    IO_WinnerTurnIndicator(2, now);
+  }
+
+  assertEqual(hal_pin_levels[PLAYER1_TURN_INDICATOR_LED_PIN], LOW);
+  assertEqual(hal_pin_levels[PLAYER2_TURN_INDICATOR_LED_PIN], HIGH);
+  assertEqual(hal_counters.digital_write_calls, 2);
 }
 
 /**
  * IO_InitHWGameMap tests
  **/
 test(IO_InitHWGameMap_Success) {
-  bool function_called_correctly = false;
-  int red_counter = 0;
-  int blue_counter = 0;
-  int green_counter = 0;
-  
-  IO_InitHWGameMap(function_called_correctly, red_counter, blue_counter, green_counter);
-
-  assertEqual(function_called_correctly, true);
-  assertEqual(red_counter, 3);
-  assertEqual(blue_counter, 3);
-  assertEqual(green_counter, 3);
+  Hal_Reset();
+  red_lc.setLed(0, 1, 1, true);
+  Hal_ResetCounters();
+
+  IO_InitHWGameMap();
+
+  /* Verify each chip is turned on at full brightness and cleared */
+  assertEqual(red_lc.shut_down, false);
+  assertEqual(blue_lc.shut_down, false);
+  assertEqual(green_lc.shut_down, false);
+  assertEqual(red_lc.intensity, 15);
+  assertEqual(blue_lc.intensity, 15);
+  assertEqual(green_lc.intensity, 15);
+  assertEqual(CountLeds(red_lc), 0);
+
+  /* Verify the SPI cost, a shutdown, intensity and eight row clears for each of the three chips */
+  assertEqual(hal_counters.spi_transfers, 30);
+  assertEqual(hal_counters.spi_bytes, 60);
 }
 
 /**
  * IO_SetHWGameMap tests
  **/
 test(IO_SetHWGameMap_Success) {
-  int board[8][8];
-  
-  for (int i = 0; i < 8; i++) {   /* For iterating through the rows */
-    for (int j = 0; j < 8; j++) { /* For iterating through the columns */
-      /* Initializes player 1's pieces */
-      if (i > 4 && ((i % 2 == 0 && j % 2 == 0) || (i % 2 == 1 && j % 2 == 1))) {
-        board[i][j] = 1;
-      }
-      /* Initializes player 2's pieces */
-      else if (i < 3 && ((i % 2 == 0 && j % 2 == 0) || (i % 2 == 1 && j % 2 == 1))) {
-        board[i][j] = 2;
-      }
-      /* Initializes empty squares */
-      else {
-        board[i][j] = 0;
-      }
-    }
-  }
+  Checkers checkers_game;
+  int max_row = -1;
+  int max_col = -1;
+
+  Hal_Reset();
+  IO_InitHWGameMap();
+  Hal_ResetCounters();
+
+  IO_SetHWGameMap(checkers_game);
+
+  /* Verify player 1's pieces are red, player 2's pieces are blue and nothing is green */
+  assertEqual(CountLeds(red_lc), 12);
+  assertEqual(CountLeds(blue_lc), 12);
+  assertEqual(CountLeds(green_lc), 0);
 
-  bool function_called_correctly = false;
-  int red_counter = 0;
-  int blue_counter = 0;
-  int green_counter = 0;
-  int true_counter = 0;
-  int row_adder = 0;
-  int col_adder = 0;
-
-  IO_SetHWGameMap(board, function_called_correctly, red_counter, blue_counter, green_counter, true_counter, row_adder, col_adder);
-
-  assertEqual(function_called_correctly, true);
-  assertEqual(red_counter, 32);
-  assertEqual(blue_counter, 32);
-  assertEqual(green_counter, 32);
-  assertEqual(true_counter, 24);
-  assertEqual(row_adder, 336);
-  assertEqual(col_adder, 144);
+  IO_MapToMaxChip(5, 1, max_row, max_col);
+  assertEqual(red_lc.leds[max_row][max_col], true);
+  assertEqual(blue_lc.leds[max_row][max_col], false);
+
+  IO_MapToMaxChip(0, 0, max_row, max_col);
+  assertEqual(red_lc.leds[max_row][max_col], false);
+  assertEqual(blue_lc.leds[max_row][max_col], true);
+
+  /* Verify the SPI cost of a full redraw, one opcode per dark square on each chip */
+  assertEqual(hal_counters.spi_transfers, 96);
+  assertEqual(hal_counters.spi_bytes, 192);
+  assertEqual(hal_counters.digital_write_calls, 0);
+}
+
+/**
+ * IO_DimHWGameMap tests
+ **/
+test(IO_DimHWGameMap_Success) {
+  Hal_Reset();
+  IO_InitHWGameMap();
+  red_lc.setLed(0, 1, 1, true);
+  Hal_ResetCounters();
+
+  IO_DimHWGameMap(true);
+
+  /* Verify the chips are dimmed without touching the LEDs, one intensity opcode each */
+  assertLess(red_lc.intensity, 15);
+  assertEqual(blue_lc.intensity, red_lc.intensity);
+  assertEqual(green_lc.intensity, red_lc.intensity);
+  assertMore(red_lc.intensity, 0);
+  assertEqual(CountLeds(red_lc), 1);
+  assertEqual(hal_counters.spi_transfers, 3);
+
+  IO_DimHWGameMap(false);
+  assertEqual(red_lc.intensity, 15);
+  assertEqual(blue_lc.intensity, 15);
+  assertEqual(green_lc.intensity, 15);
+}
+
+/**
+ * IO_LimitHWGameMap tests
+ **/
+test(IO_LimitHWGameMap_Success) {
+  Hal_Reset();
+  IO_InitHWGameMap();
+  Hal_ResetCounters();
+
+  IO_LimitHWGameMap(6);
+
+  /* Verify the chips are capped, one intensity opcode each */
+  assertEqual(red_lc.intensity, 6);
+  assertEqual(blue_lc.intensity, 6);
+  assertEqual(green_lc.intensity, 6);
+  assertEqual(hal_counters.spi_transfers, 3);
+
+  /* The cap holds when the game map wakes up, and dimming still dims below it */
+  IO_DimHWGameMap(true);
+  assertLess(red_lc.intensity, 6);
+  IO_DimHWGameMap(false);
+  assertEqual(red_lc.intensity, 6);
+
+  /* A cap dimmer than the idle brightness wins over it */
+  IO_LimitHWGameMap(1);
+  IO_DimHWGameMap(true);
+  assertEqual(red_lc.intensity, 1);
+
+  /* A reset chip comes back at the cap */
+  IO_DimHWGameMap(false);
+  IO_LimitHWGameMap(9);
+  IO_InitHWGameMap();
+  assertEqual(green_lc.intensity, 9);
+
+  IO_LimitHWGameMap(15);
+  assertEqual(red_lc.intensity, 15);
+}
+
+/**
+ * IO_GetBatteryVoltage tests
+ **/
+test(IO_GetBatteryVoltage_Success) {
+  Hal_Reset();
+
+  /* The pin reads half of the battery voltage, 3.3 V at full scale */
+  hal_analog_readings[BATTERY_PIN] = 4095;
+  assertEqual(IO_GetBatteryVoltage(), 6600);
+  hal_analog_readings[BATTERY_PIN] = 3102;
+  assertEqual(IO_GetBatteryVoltage(), 4999);
+  hal_analog_readings[BATTERY_PIN] = 0;
+  assertEqual(IO_GetBatteryVoltage(), 0);
+  assertEqual(hal_counters.analog_read_calls, 3);
 }
 
 /**********************************
@@ -0,0 +1,31 @@
+/************************************************************
+ * @file VoiceRecognition.h
+ * @brief The header for the Voice Recognition algorithm
+ ************************************************************/
+#ifndef VOICERECOGNITION_H
+#define VOICERECOGNITION_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define VOICE_MOVE_QUEUE_SIZE (4) /* The number of parsed moves that can wait to be taken */
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+void          VoiceRecognition_Init();
+bool          VoiceRecognition_GetInput(Move &checker_move);
+unsigned long VoiceRecognition_GetInputTime();
+void          VoiceRecognition_SetBatteryLevel(int percent);
+
+#endif /* VOICERECOGNITION_H */
@@ -0,0 +1,327 @@
+/************************************************************
+ * @file Hal.h
+ * @brief The hardware abstraction layer for GPIO, ADC, SPI, timing, memory, sleep and flash
+ *
+ * @note The backend is picked at compile time by HalConfig.h. The board backend is inline forwarding to the
+ *       Arduino core and LedControl, so it costs nothing over calling them directly. The counting backend
+ *       keeps the pin state in memory and counts every call, so tests can check the I/O a function does.
+ ************************************************************/
+#ifndef HAL_H
+#define HAL_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "HalConfig.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+#if defined(HAL_COUNTING)
+
+/**********************************
+ ** Defines
+ **********************************/
+#define HAL_PIN_COUNT         (40)   /* The number of GPIO pins on the ESP32 */
+#define HAL_ANALOG_READ_MAX   (4095) /* The reading of an ADC pin that nothing is pulling down */
+#define HAL_LED_CHIP_SIZE     (8)    /* The number of rows and columns on a MAX chip */
+#define HAL_LED_CHIP_OP_BYTES (2)    /* The bytes sent to each chip on the chain for one opcode */
+#define HAL_FLASH_SECTOR_SIZE (4096) /* The bytes in the smallest piece of flash that can be erased */
+#define HAL_FLASH_SIZE        (4 * HAL_FLASH_SECTOR_SIZE) /* The bytes in the in-memory flash partition */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The number of calls made through the HAL since the last reset */
+struct HalCounters {
+  unsigned long pin_mode_calls;      /* The number of pinMode calls */
+  unsigned long digital_write_calls; /* The number of digitalWrite calls (not counting the LED chip select) */
+  unsigned long digital_read_calls;  /* The number of digitalRead calls */
+  unsigned long analog_read_calls;   /* The number of analogRead calls */
+  unsigned long spi_transfers;       /* The number of opcodes shifted out to the LED chips */
+  unsigned long spi_bytes;           /* The number of bytes shifted out to the LED chips */
+  unsigned long time_calls;          /* The number of millis and micros calls */
+  unsigned long sleep_calls;         /* The number of light sleeps */
+  unsigned long flash_reads;         /* The number of flash reads */
+  unsigned long flash_writes;        /* The number of flash writes */
+  unsigned long flash_erases;        /* The number of flash sectors erased */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+extern HalCounters   hal_counters;                       /* The calls made since Hal_ResetCounters */
+extern int           hal_pin_modes[HAL_PIN_COUNT];       /* The last mode set on each pin (-1 if never set) */
+extern int           hal_pin_levels[HAL_PIN_COUNT];      /* The level on each pin, written or read */
+extern int           hal_analog_readings[HAL_PIN_COUNT]; /* The reading each ADC pin returns */
+extern unsigned long hal_time;                           /* The time millis and micros return in us */
+extern unsigned long hal_free_heap;                      /* The free heap the memory functions report in bytes */
+extern unsigned long hal_largest_free_block;             /* The largest free heap block in bytes */
+extern unsigned long hal_min_free_heap;                  /* The lowest free heap since power on in bytes */
+extern unsigned long hal_free_stack;                     /* The lowest free stack of the running task in bytes */
+extern int           hal_wake_levels[HAL_PIN_COUNT];     /* The level that wakes the board from light sleep on each pin (-1 if none) */
+extern uint8_t       hal_flash[HAL_FLASH_SIZE];          /* The flash partition, which starts out erased */
+extern unsigned long hal_flash_size;                     /* The size the flash functions report in bytes (0 for no partition) */
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+void Hal_Reset();
+void Hal_ResetCounters();
+
+/* GPIO functions */
+inline void Hal_PinMode(uint8_t pin, uint8_t mode) {
+  hal_counters.pin_mode_calls++;
+  hal_pin_modes[pin] = mode;
+}
+
+inline void Hal_DigitalWrite(uint8_t pin, uint8_t level) {
+  hal_counters.digital_write_calls++;
+  hal_pin_levels[pin] = level;
+}
+
+inline int Hal_DigitalRead(uint8_t pin) {
+  hal_counters.digital_read_calls++;
+  return hal_pin_levels[pin];
+}
+
+/* ADC functions */
+inline int Hal_AnalogRead(uint8_t pin) {
+  hal_counters.analog_read_calls++;
+  return hal_analog_readings[pin];
+}
+
+/* Timing functions */
+inline unsigned long Hal_Millis() {
+  hal_counters.time_calls++;
+  return hal_time / 1000;
+}
+
+inline unsigned long Hal_Micros() {
+  hal_counters.time_calls++;
+  return hal_time;
+}
+
+/* Memory functions */
+inline unsigned long Hal_GetFreeHeap() { return hal_free_heap; }
+inline unsigned long Hal_GetLargestFreeBlock() { return hal_largest_free_block; }
+inline unsigned long Hal_GetMinFreeHeap() { return hal_min_free_heap; }
+inline unsigned long Hal_GetFreeStack() { return hal_free_stack; }
+
+/* Sleep functions, a light sleep passes its whole duration at once */
+inline void Hal_EnableWakePin(uint8_t pin, uint8_t level) {
+  hal_wake_levels[pin] = level;
+}
+
+inline bool Hal_LightSleep(unsigned long duration) {
+  hal_counters.sleep_calls++;
+  hal_time += duration;
+  return false;
+}
+
+/* Flash functions, which work like NOR flash: a write can only clear bits and an erase sets a whole sector back to 0xFF */
+inline unsigned long Hal_FlashSize() { return hal_flash_size; }
+
+inline bool Hal_FlashRead(unsigned long offset, void *data, unsigned long length) {
+  hal_counters.flash_reads++;
+  if (offset + length > hal_flash_size) {
+    return false;
+  }
+  memcpy(data, &hal_flash[offset], length);
+  return true;
+}
+
+inline bool Hal_FlashWrite(unsigned long offset, const void *data, unsigned long length) {
+  hal_counters.flash_writes++;
+  if (offset + length > hal_flash_size) {
+    return false;
+  }
+  for (unsigned long i = 0; i < length; i++) {
+    hal_flash[offset + i] &= ((const uint8_t *)data)[i];
+  }
+  return true;
+}
+
+inline bool Hal_FlashErase(unsigned long offset) {
+  hal_counters.flash_erases++;
+  if (offset % HAL_FLASH_SECTOR_SIZE != 0 || offset + HAL_FLASH_SECTOR_SIZE > hal_flash_size) {
+    return false;
+  }
+  memset(&hal_flash[offset], 0xFF, HAL_FLASH_SECTOR_SIZE);
+  return true;
+}
+
+/*********************************************
+ ** Class Declarations and Function Prototypes
+ *********************************************/
+/* A MAX chip on the SPI chain, with the LedControl interface, which counts the bytes LedControl would send */
+class HalLedChip {
+  public:
+    /* Functions */
+    HalLedChip(int data_pin, int clk_pin, int cs_pin, int num_devices = 1);
+    void shutdown(int addr, bool status);
+    void setIntensity(int addr, int intensity);
+    void clearDisplay(int addr);
+    void setLed(int addr, int row, int col, bool state);
+    void setRow(int addr, int row, uint8_t value);
+
+    /* Members */
+    int  data_pin;                                    /* The data pin the chip is wired to */
+    int  num_devices;                                 /* The number of chips on the chain */
+    bool shut_down;                                   /* Indicator for if the chip is in shutdown */
+    int  intensity;                                   /* The last intensity set */
+    bool leds[HAL_LED_CHIP_SIZE][HAL_LED_CHIP_SIZE]; /* The LEDs lit on the chip */
+  private:
+    /* Functions */
+    void HalLedChip_Transfer(int count);
+};
+
+#else
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "LedControl.h"
+
+#if defined(ESP32)
+#include "driver/gpio.h"
+#include "esp_heap_caps.h"
+#include "esp_sleep.h"
+#include "esp_partition.h"
+#endif
+
+/**********************************
+ ** Defines
+ **********************************/
+#define HAL_FLASH_SECTOR_SIZE (4096)      /* The bytes in the smallest piece of flash that can be erased */
+#define HAL_FLASH_PARTITION   ("journal") /* The label of the data partition in partitions.csv the flash functions use */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+typedef LedControl HalLedChip; /* A MAX chip on the SPI chain */
+
+#if defined(__AVR__)
+/* A block on the avr-libc free list, the same walk as FreeMemory in ArduinoUnit */
+struct __freelist {
+  size_t sz;
+  struct __freelist *nx;
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+extern char              __heap_start; /* The bottom of the heap, set by the linker */
+extern char              *__brkval;    /* The top of the heap (NULL until the first malloc) */
+extern struct __freelist *__flp;       /* The head of the free list */
+#endif
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* GPIO functions */
+inline void Hal_PinMode(uint8_t pin, uint8_t mode) { pinMode(pin, mode); }
+inline void Hal_DigitalWrite(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+inline int  Hal_DigitalRead(uint8_t pin) { return digitalRead(pin); }
+
+/* ADC functions */
+inline int Hal_AnalogRead(uint8_t pin) { return analogRead(pin); }
+
+/* Timing functions */
+inline unsigned long Hal_Millis() { return millis(); }
+inline unsigned long Hal_Micros() { return micros(); }
+
+/* Memory functions, from the ESP-IDF heap and FreeRTOS on the ESP32 and the avr-libc free list on AVR (other boards report 0) */
+#if defined(ESP32)
+inline unsigned long Hal_GetFreeHeap() { return heap_caps_get_free_size(MALLOC_CAP_8BIT); }
+inline unsigned long Hal_GetLargestFreeBlock() { return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); }
+inline unsigned long Hal_GetMinFreeHeap() { return heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT); }
+inline unsigned long Hal_GetFreeStack() { return uxTaskGetStackHighWaterMark(NULL); }
+#elif defined(__AVR__)
+/* The heap and stack grow towards each other, so the gap between them is free to both */
+inline unsigned long Hal_GetFreeStack() {
+  char top;
+  return &top - ((__brkval == NULL) ? &__heap_start : __brkval);
+}
+
+inline unsigned long Hal_GetFreeHeap() {
+  unsigned long free_heap = Hal_GetFreeStack();
+  for (struct __freelist *block = __flp; block != NULL; block = block->nx) {
+    free_heap += block->sz + 2; /* Each block has a two byte header */
+  }
+  return free_heap;
+}
+
+inline unsigned long Hal_GetLargestFreeBlock() {
+  unsigned long largest = Hal_GetFreeStack();
+  for (struct __freelist *block = __flp; block != NULL; block = block->nx) {
+    largest = (block->sz > largest) ? block->sz : largest;
+  }
+  return largest;
+}
+
+/* avr-libc does not keep a low-water mark, so Memory keeps its own from the readings */
+inline unsigned long Hal_GetMinFreeHeap() { return Hal_GetFreeHeap(); }
+#else
+inline unsigned long Hal_GetFreeHeap() { return 0; }
+inline unsigned long Hal_GetLargestFreeBlock() { return 0; }
+inline unsigned long Hal_GetMinFreeHeap() { return 0; }
+inline unsigned long Hal_GetFreeStack() { return 0; }
+#endif
+
+/* Sleep functions, light sleep on the ESP32 keeps RAM and the pins as they are (other boards stay awake) */
+#if defined(ESP32)
+inline void Hal_EnableWakePin(uint8_t pin, uint8_t level) {
+  gpio_wakeup_enable((gpio_num_t)pin, (level == LOW) ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+}
+
+inline bool Hal_LightSleep(unsigned long duration) {
+  esp_sleep_enable_timer_wakeup(duration);
+  esp_light_sleep_start();
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+}
+#else
+inline void Hal_EnableWakePin(uint8_t pin, uint8_t level) {}
+
+/* Waiting it out saves no power, but keeps the same timing as a sleep */
+inline bool Hal_LightSleep(unsigned long duration) {
+  delay(duration / 1000);
+  return false;
+}
+#endif
+
+/* Flash functions, on the ESP32 a data partition found by its label (other boards have no partition, so a size of 0) */
+#if defined(ESP32)
+inline const esp_partition_t *Hal_FlashPartition() {
+  static const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, HAL_FLASH_PARTITION);
+  return partition;
+}
+
+inline unsigned long Hal_FlashSize() {
+  return (Hal_FlashPartition() == NULL) ? 0 : Hal_FlashPartition()->size;
+}
+
+inline bool Hal_FlashRead(unsigned long offset, void *data, unsigned long length) {
+  return Hal_FlashPartition() != NULL && esp_partition_read(Hal_FlashPartition(), offset, data, length) == ESP_OK;
+}
+
+inline bool Hal_FlashWrite(unsigned long offset, const void *data, unsigned long length) {
+  return Hal_FlashPartition() != NULL && esp_partition_write(Hal_FlashPartition(), offset, data, length) == ESP_OK;
+}
+
+inline bool Hal_FlashErase(unsigned long offset) {
+  return Hal_FlashPartition() != NULL && esp_partition_erase_range(Hal_FlashPartition(), offset, HAL_FLASH_SECTOR_SIZE) == ESP_OK;
+}
+#else
+inline unsigned long Hal_FlashSize() { return 0; }
+inline bool Hal_FlashRead(unsigned long offset, void *data, unsigned long length) { return false; }
+inline bool Hal_FlashWrite(unsigned long offset, const void *data, unsigned long length) { return false; }
+inline bool Hal_FlashErase(unsigned long offset) { return false; }
+#endif
+
+#endif /* HAL_COUNTING */
+
+#endif /* HAL_H */
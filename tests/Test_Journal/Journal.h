@@ -0,0 +1,70 @@
+/************************************************************
+ * @file Journal.h
+ * @brief The header for the journal of moves and game snapshots in flash, so a game survives the batteries being taken out
+ ************************************************************/
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Hal.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define JOURNAL_RECORD_SIZE       (32)  /* The bytes in a record, a multiple of the flash's 4 byte write size */
+#define JOURNAL_SECTOR_RECORDS    (HAL_FLASH_SECTOR_SIZE / JOURNAL_RECORD_SIZE) /* The records in a flash sector */
+#define JOURNAL_SNAPSHOT_PERIOD   (16)  /* The most moves between snapshots, so a resume replays fewer than this many */
+#define JOURNAL_COMMAND           ('j') /* The byte sent over Serial to ask for the journal state */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* What a record holds, neither is 0xFF so an erased record is never taken for one */
+enum JournalRecordType {
+  JOURNAL_RECORD_SNAPSHOT = 1, /* The whole game after a move, or at the start of a game */
+  JOURNAL_RECORD_MOVE     = 2  /* A valid move, played on the game left by the records before it */
+};
+
+/* One record in flash */
+struct JournalRecord {
+  uint32_t sequence;              /* Counts up from the first record ever written, so the newest sector can be found */
+  uint8_t  type;                  /* The JournalRecordType */
+  uint8_t  reserved[3];           /* Unused, left at 0 */
+  union {
+    CheckersSnapshot snapshot;    /* The game, for a snapshot */
+    Move             move;        /* The move, for a move */
+  } payload;
+  uint32_t crc;                   /* The CRC-32 of every byte before it, so a record torn by a power loss is skipped */
+};
+
+static_assert(sizeof(JournalRecord) == JOURNAL_RECORD_SIZE, "A journal record must fill its slot exactly");
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Journal functions (only called from the game core) */
+bool Journal_Restore(Checkers &game);
+void Journal_NewGame(Checkers &game);
+void Journal_RecordMove(Checkers &game, Move move);
+void Journal_Maintain();
+
+/* Reading functions */
+bool          Journal_IsEnabled();
+unsigned long Journal_GetSequence();
+unsigned long Journal_GetErases();
+unsigned long Journal_GetReplayed();
+unsigned long Journal_GetRestoreTime();
+
+/* Reporting functions */
+void Journal_Dump(Print &out);
+
+#endif /* JOURNAL_H */
@@ -0,0 +1,292 @@
+/************************************************************
+ * @file Test_Journal.ino
+ * @brief The tests for the journal of moves and game snapshots in flash
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Hal.h"
+#include "Journal.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+#include "FakeStream.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+FakeStream fake_serial; /* The Serial port the journal state is printed to */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Erases the flash and finds the empty journal in it, the same as the first power on
+ *
+ */
+void ResetJournal() {
+  Checkers game;
+  Hal_Reset();
+  Journal_Restore(game);
+}
+
+/**
+ * Finds the first valid move in a game, trying every pair of squares in order
+ *
+ * @param game: The game
+ * @param move: The move found
+ * @return bool: If there is a valid move
+ */
+bool FindMove(Checkers &game, Move &move) {
+  for (int from = 0; from < MOVE_BOARD_SIZE * MOVE_BOARD_SIZE; from++) {
+    for (int to = 0; to < MOVE_BOARD_SIZE * MOVE_BOARD_SIZE; to++) {
+      Checkers copy = game;
+      if (copy.Checkers_Turn(Move_Make(from, to)) != 0) {
+        move = Move_Make(from, to);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Plays and journals moves the way the game core does, starting a new game whenever one ends
+ *
+ * @param game: The game to play on
+ * @param count: The number of moves
+ */
+void PlayMoves(Checkers &game, int count) {
+  Move move;
+  for (int i = 0; i < count; i++) {
+    if (game.Checkers_GetWin() != 0 || !FindMove(game, move)) {
+      game = Checkers();
+      Journal_NewGame(game);
+      FindMove(game, move);
+    }
+    game.Checkers_Turn(move);
+    Journal_RecordMove(game, move);
+  }
+}
+
+/**
+ * Compares two games
+ *
+ * @param first: The first game
+ * @param second: The second game
+ * @return bool: If every square and the active player are the same
+ */
+bool SameGame(Checkers &first, Checkers &second) {
+  for (int i = 0; i < MOVE_BOARD_SIZE; i++) {
+    for (int j = 0; j < MOVE_BOARD_SIZE; j++) {
+      if (first.Checkers_GetBoardAt(i, j) != second.Checkers_GetBoardAt(i, j)) {
+        return false;
+      }
+    }
+  }
+  return first.Checkers_GetActivePlayer() == second.Checkers_GetActivePlayer() &&
+         first.Checkers_GetP1Count() == second.Checkers_GetP1Count() && first.Checkers_GetP2Count() == second.Checkers_GetP2Count();
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Journal_Restore tests
+ **/
+test(Journal_Restore_NoPartition_Fail) {
+  Checkers game;
+  Hal_Reset();
+  hal_flash_size = 0;
+
+  assertEqual(Journal_Restore(game), false);
+  assertEqual(Journal_IsEnabled(), false);
+
+  /* Nothing is written without a partition */
+  Journal_NewGame(game);
+  PlayMoves(game, 3);
+  Journal_Maintain();
+  assertEqual(hal_counters.flash_writes, 0UL);
+  assertEqual(hal_counters.flash_erases, 0UL);
+}
+
+test(Journal_Restore_Empty_Fail) {
+  Checkers game;
+  Hal_Reset();
+
+  assertEqual(Journal_Restore(game), false);
+  assertEqual(Journal_IsEnabled(), true);
+  assertEqual(Journal_GetSequence(), 0UL);
+
+  /* The first game erases the first sector and writes its snapshot */
+  Journal_NewGame(game);
+  assertEqual(hal_counters.flash_erases, 1UL);
+  assertEqual(hal_counters.flash_writes, 1UL);
+  assertEqual(Journal_GetSequence(), 1UL);
+}
+
+test(Journal_Restore_Resume_Success) {
+  Checkers game;
+  Checkers restored;
+  ResetJournal();
+  Journal_NewGame(game);
+  PlayMoves(game, JOURNAL_SNAPSHOT_PERIOD + 4);
+
+  /* One record per move, and only the moves after the last snapshot are replayed */
+  assertEqual(Journal_GetSequence(), (unsigned long)JOURNAL_SNAPSHOT_PERIOD + 5);
+  assertEqual(Journal_Restore(restored), true);
+  assertTrue(SameGame(game, restored));
+  assertEqual(Journal_GetReplayed(), 4UL);
+  assertEqual(Journal_GetSequence(), (unsigned long)JOURNAL_SNAPSHOT_PERIOD + 5);
+
+  /* The resumed game carries on journaling after the last record */
+  PlayMoves(restored, 3);
+  assertEqual(Journal_Restore(game), true);
+  assertTrue(SameGame(game, restored));
+  assertEqual(Journal_GetReplayed(), 7UL);
+}
+
+test(Journal_Restore_TornRecord_Success) {
+  Checkers game;
+  Checkers restored;
+  ResetJournal();
+  Journal_NewGame(game);
+  PlayMoves(game, 5);
+  Checkers before = game;
+  PlayMoves(game, 1);
+
+  /* The power is lost halfway through writing the last move, so its second half is still erased */
+  unsigned long offset = 6 * JOURNAL_RECORD_SIZE;
+  memset(&hal_flash[offset + JOURNAL_RECORD_SIZE / 2], 0xFF, JOURNAL_RECORD_SIZE / 2);
+
+  assertEqual(Journal_Restore(restored), true);
+  assertTrue(SameGame(before, restored));
+  assertEqual(Journal_GetSequence(), 6UL);
+
+  /* The torn record is skipped over rather than written over */
+  PlayMoves(restored, 1);
+  assertEqual(hal_flash[offset + JOURNAL_RECORD_SIZE], 6);
+  assertEqual(Journal_Restore(before), true);
+  assertTrue(SameGame(game, before));
+}
+
+test(Journal_Restore_Won_Fail) {
+  Checkers game;
+  CheckersSnapshot snapshot;
+  ResetJournal();
+
+  /* A won game is not carried on */
+  game.Checkers_Save(snapshot);
+  snapshot.won = 1;
+  assertEqual(game.Checkers_Load(snapshot), true);
+  Journal_NewGame(game);
+  assertEqual(Journal_Restore(game), false);
+}
+
+/**
+ * Journal_RecordMove tests
+ **/
+test(Journal_RecordMove_Snapshot_Success) {
+  Checkers game;
+  JournalRecord record;
+  ResetJournal();
+  Journal_NewGame(game);
+  PlayMoves(game, JOURNAL_SNAPSHOT_PERIOD);
+
+  /* The move that would make the snapshot period is written as a snapshot instead */
+  memcpy(&record, &hal_flash[(JOURNAL_SNAPSHOT_PERIOD - 1) * JOURNAL_RECORD_SIZE], sizeof(record));
+  assertEqual(record.type, JOURNAL_RECORD_MOVE);
+  memcpy(&record, &hal_flash[JOURNAL_SNAPSHOT_PERIOD * JOURNAL_RECORD_SIZE], sizeof(record));
+  assertEqual(record.type, JOURNAL_RECORD_SNAPSHOT);
+  assertEqual(record.sequence, (uint32_t)JOURNAL_SNAPSHOT_PERIOD);
+}
+
+test(Journal_RecordMove_WearLevelling_Success) {
+  Checkers game;
+  Checkers restored;
+  JournalRecord record;
+  ResetJournal();
+  Journal_NewGame(game);
+
+  /* Three laps of the ring erase every sector three times, a game ending writes the next game's snapshot as well */
+  int sectors = HAL_FLASH_SIZE / HAL_FLASH_SECTOR_SIZE;
+  while (Journal_GetSequence() < (unsigned long)(3 * sectors * JOURNAL_SECTOR_RECORDS)) {
+    PlayMoves(game, 1);
+  }
+  assertEqual(Journal_GetErases(), (unsigned long)(3 * sectors));
+
+  /* Every sector starts with a snapshot, so the newest sector is all a resume reads */
+  for (int sector = 0; sector < sectors; sector++) {
+    memcpy(&record, &hal_flash[sector * HAL_FLASH_SECTOR_SIZE], sizeof(record));
+    assertEqual(record.type, JOURNAL_RECORD_SNAPSHOT);
+  }
+
+  PlayMoves(game, 5);
+  Hal_ResetCounters();
+  assertEqual(Journal_Restore(restored), true);
+  assertTrue(SameGame(game, restored));
+  assertLess(Journal_GetReplayed(), (unsigned long)JOURNAL_SNAPSHOT_PERIOD);
+  assertLessOrEqual(hal_counters.flash_reads, (unsigned long)(sectors + 2 * JOURNAL_SECTOR_RECORDS));
+}
+
+/**
+ * Journal_Maintain tests
+ **/
+test(Journal_Maintain_Success) {
+  Checkers game;
+  ResetJournal();
+  Journal_NewGame(game);
+
+  /* The next sector is erased ahead of time, once */
+  Hal_ResetCounters();
+  Journal_Maintain();
+  Journal_Maintain();
+  assertEqual(hal_counters.flash_erases, 1UL);
+
+  /* So the move that moves into it does not wait on an erase */
+  PlayMoves(game, JOURNAL_SECTOR_RECORDS);
+  assertEqual(hal_counters.flash_erases, 1UL);
+  assertEqual(Journal_GetErases(), 2UL);
+}
+
+/**
+ * Journal_Dump tests
+ **/
+test(Journal_Dump_Success) {
+  Checkers game;
+  ResetJournal();
+  Journal_NewGame(game);
+  PlayMoves(game, 2);
+  assertEqual(Journal_Restore(game), true);
+  fake_serial.reset();
+  Journal_Dump(fake_serial);
+
+  assertEqual(fake_serial.bytesWritten(), String("JOURNAL,enabled,3,96,0,2,0\r\n"));
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
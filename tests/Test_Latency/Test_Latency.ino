@@ -0,0 +1,179 @@
+/************************************************************
+ * @file Test_Latency.ino
+ * @brief The tests for tracing moves from their input to the LEDs
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Latency.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+#include "FakeStream.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+FakeStream fake_serial; /* The Serial port the traces are printed to */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Clears the traces and the fake Serial port
+ *
+ */
+void ResetLatency() {
+  Latency_Reset();
+  fake_serial.reset();
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Latency_Start tests
+ **/
+test(Latency_Start_Success) {
+  ResetLatency();
+  LatencyTrace trace;
+
+  unsigned long first = Latency_Start(LATENCY_SOURCE_BUTTON, 100, 150);
+  unsigned long second = Latency_Start(LATENCY_SOURCE_VOICE, 200, 260);
+  assertEqual(first, 1);
+  assertEqual(second, 2);
+
+  assertEqual(Latency_GetTrace(second, trace), true);
+  assertEqual(trace.source, LATENCY_SOURCE_VOICE);
+  assertEqual(trace.stage, LATENCY_STAGE_QUEUED);
+  assertEqual(trace.input_time, 200);
+  assertEqual(trace.queued_time, 260);
+}
+
+test(Latency_GetTrace_NoTrace_Failure) {
+  ResetLatency();
+  LatencyTrace trace;
+
+  assertEqual(Latency_GetTrace(LATENCY_NO_TRACE, trace), false);
+  assertEqual(Latency_GetTrace(1, trace), false);
+}
+
+test(Latency_Start_Overwrite_Success) {
+  ResetLatency();
+  LatencyTrace trace;
+
+  unsigned long oldest = Latency_Start(LATENCY_SOURCE_BUTTON, 0, 0);
+  for (int i = 0; i < LATENCY_TRACE_COUNT; i++) {
+    Latency_Start(LATENCY_SOURCE_BUTTON, i, i);
+  }
+
+  /* The oldest trace has been overwritten, so moves still carrying its ID are ignored */
+  assertEqual(Latency_GetTrace(oldest, trace), false);
+  Latency_Turn(oldest, true, 10);
+  assertEqual(Latency_GetTrace(oldest + LATENCY_TRACE_COUNT, trace), true);
+  assertEqual(trace.stage, LATENCY_STAGE_QUEUED);
+}
+
+/**
+ * Latency_Turn, Latency_Done and Latency_Render tests
+ **/
+test(Latency_Render_Success) {
+  ResetLatency();
+  LatencyTrace trace;
+
+  unsigned long turned = Latency_Start(LATENCY_SOURCE_BUTTON, 100, 110);
+  unsigned long queued = Latency_Start(LATENCY_SOURCE_VOICE, 120, 130);
+  Latency_Turn(turned, true, 500);
+  Latency_Render(20000);
+
+  assertEqual(Latency_GetTrace(turned, trace), true);
+  assertEqual(trace.stage, LATENCY_STAGE_DONE);
+  assertEqual(trace.valid, true);
+  assertEqual(trace.turn_time, 500);
+  assertEqual(trace.done_time, 20000);
+
+  /* A move the game core has not run yet is left for a later render */
+  assertEqual(Latency_GetTrace(queued, trace), true);
+  assertEqual(trace.stage, LATENCY_STAGE_QUEUED);
+}
+
+test(Latency_Done_Invalid_Success) {
+  ResetLatency();
+  LatencyTrace trace;
+
+  unsigned long id = Latency_Start(LATENCY_SOURCE_VOICE, 100, 110);
+  Latency_Turn(id, false, 400);
+  Latency_Done(id, 450);
+
+  /* A later render does not move the time the blink started */
+  Latency_Render(30000);
+
+  assertEqual(Latency_GetTrace(id, trace), true);
+  assertEqual(trace.stage, LATENCY_STAGE_DONE);
+  assertEqual(trace.valid, false);
+  assertEqual(trace.done_time, 450);
+}
+
+test(Latency_Done_NotTurned_Failure) {
+  ResetLatency();
+  LatencyTrace trace;
+
+  unsigned long id = Latency_Start(LATENCY_SOURCE_BUTTON, 100, 110);
+  Latency_Done(id, 450);
+
+  assertEqual(Latency_GetTrace(id, trace), true);
+  assertEqual(trace.stage, LATENCY_STAGE_QUEUED);
+}
+
+/**
+ * Latency_Dump tests
+ **/
+test(Latency_Dump_Success) {
+  ResetLatency();
+
+  unsigned long button = Latency_Start(LATENCY_SOURCE_BUTTON, 1000, 1010);
+  unsigned long voice = Latency_Start(LATENCY_SOURCE_VOICE, 2000, 2100);
+  Latency_Start(LATENCY_SOURCE_BUTTON, 3000, 3010);
+  Latency_Turn(voice, false, 2600);
+  Latency_Done(voice, 2650);
+  Latency_Turn(button, true, 1500);
+  Latency_Render(41000);
+  Latency_Dump(fake_serial);
+
+  /* Only finished traces are printed, oldest first */
+  assertEqual(fake_serial.bytesWritten(),
+              "LATENCY,1,button,1,10,500,40000\r\n"
+              "LATENCY,2,voice,0,100,600,650\r\n");
+}
+
+test(Latency_Dump_Empty_Success) {
+  ResetLatency();
+  Latency_Dump(fake_serial);
+
+  assertEqual(fake_serial.bytesWritten(), "");
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
@@ -0,0 +1,235 @@
+/************************************************************
+ * @file Memory.cpp
+ * @brief The implementation for tracking the heap and stack each stage of the loop leaves behind and the heap's trend over a long run
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Hal.h"
+#include "Memory.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The readings at the end of each stage, kept from power on so a dump always covers the whole run */
+unsigned long memory_runs[PROFILER_STAGE_COUNT];      /* The number of times each stage was recorded */
+unsigned long memory_low_heap[PROFILER_STAGE_COUNT];  /* The lowest free heap after each stage in bytes */
+unsigned long memory_low_block[PROFILER_STAGE_COUNT]; /* The smallest largest free block after each stage in bytes */
+unsigned long memory_low_stack[PROFILER_STAGE_COUNT]; /* The lowest free stack of the task running each stage in bytes */
+long          memory_held[PROFILER_STAGE_COUNT];      /* The heap each stage has allocated and not freed in bytes */
+
+/* The ring buffer of heap samples, a sample lives in the slot of its number modulo MEMORY_TREND_COUNT */
+MemorySample  memory_trend[MEMORY_TREND_COUNT];
+unsigned long memory_trend_taken; /* The number of samples taken since power on */
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Clears every stage's readings and the trend
+ *
+ */
+void Memory_Reset() {
+  for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++) {
+    memory_runs[stage] = 0;
+    memory_low_heap[stage] = 0;
+    memory_low_block[stage] = 0;
+    memory_low_stack[stage] = 0;
+    memory_held[stage] = 0;
+  }
+  memory_trend_taken = 0;
+}
+
+/**
+ * Reads the free heap before a stage runs
+ *
+ * @return unsigned long: The free heap in bytes, to pass to Memory_EndStage
+ */
+unsigned long Memory_BeginStage() {
+  return Hal_GetFreeHeap();
+}
+
+/**
+ * Records the heap and stack left after a stage ran, blaming the stage for any heap it did not give back
+ *
+ * @param stage: The stage that ran
+ * @param heap_before: The free heap Memory_BeginStage read before the stage
+ * @note Allocations made and freed within the stage only show in the low-water mark of the trend, and the other core can move the heap while a stage runs
+ */
+void Memory_EndStage(ProfilerStage stage, unsigned long heap_before) {
+  unsigned long free_heap = Hal_GetFreeHeap();
+  unsigned long largest_block = Hal_GetLargestFreeBlock();
+  unsigned long free_stack = Hal_GetFreeStack();
+  bool first = (memory_runs[stage] == 0);
+
+  memory_held[stage] += (long)(heap_before - free_heap);
+  if (first || free_heap < memory_low_heap[stage]) {
+    memory_low_heap[stage] = free_heap;
+  }
+  if (first || largest_block < memory_low_block[stage]) {
+    memory_low_block[stage] = largest_block;
+  }
+  if (first || free_stack < memory_low_stack[stage]) {
+    memory_low_stack[stage] = free_stack;
+  }
+  memory_runs[stage]++;
+}
+
+/**
+ * Adds a sample of the heap to the trend, overwriting the oldest once the ring buffer is full
+ *
+ * @param now: The current millis() time
+ */
+void Memory_Sample(unsigned long now) {
+  MemorySample &sample = memory_trend[memory_trend_taken % MEMORY_TREND_COUNT];
+  sample.time = now;
+  sample.free_heap = Hal_GetFreeHeap();
+  sample.largest_block = Hal_GetLargestFreeBlock();
+  sample.min_free_heap = Hal_GetMinFreeHeap();
+  memory_trend_taken++;
+}
+
+/**
+ * Retrieves the number of times a stage was recorded
+ *
+ * @param stage: The stage
+ * @return unsigned long: The number of runs
+ */
+unsigned long Memory_GetRuns(ProfilerStage stage) {
+  return memory_runs[stage];
+}
+
+/**
+ * Retrieves the lowest free heap seen after a stage
+ *
+ * @param stage: The stage
+ * @return unsigned long: The free heap in bytes (0 if the stage never ran)
+ */
+unsigned long Memory_GetLowFreeHeap(ProfilerStage stage) {
+  return memory_low_heap[stage];
+}
+
+/**
+ * Retrieves the smallest largest free block seen after a stage, the biggest allocation that was sure to succeed
+ *
+ * @param stage: The stage
+ * @return unsigned long: The block size in bytes (0 if the stage never ran)
+ */
+unsigned long Memory_GetLowLargestBlock(ProfilerStage stage) {
+  return memory_low_block[stage];
+}
+
+/**
+ * Retrieves the lowest free stack seen of the task running a stage
+ *
+ * @param stage: The stage
+ * @return unsigned long: The free stack in bytes (0 if the stage never ran)
+ */
+unsigned long Memory_GetLowFreeStack(ProfilerStage stage) {
+  return memory_low_stack[stage];
+}
+
+/**
+ * Retrieves the heap a stage has allocated and not freed since power on
+ *
+ * @param stage: The stage
+ * @return long: The held heap in bytes, negative if the stage freed more than it allocated
+ */
+long Memory_GetHeldBytes(ProfilerStage stage) {
+  return memory_held[stage];
+}
+
+/**
+ * Copies out the trend, oldest sample first
+ *
+ * @param samples: Where to copy the samples, with room for MEMORY_TREND_COUNT of them
+ * @return int: The number of samples copied
+ */
+int Memory_GetSamples(MemorySample *samples) {
+  unsigned long first = (memory_trend_taken > MEMORY_TREND_COUNT) ? memory_trend_taken - MEMORY_TREND_COUNT : 0;
+  int count = 0;
+  for (unsigned long i = first; i < memory_trend_taken; i++) {
+    samples[count++] = memory_trend[i % MEMORY_TREND_COUNT];
+  }
+  return count;
+}
+
+/**
+ * Works out how fragmented the free heap is, the share of it outside the largest free block
+ *
+ * @param free_heap: The free heap in bytes
+ * @param largest_block: The largest free heap block in bytes
+ * @return int: The fragmentation in percent, 0 when the free heap is one block (or unknown)
+ */
+int Memory_GetFragmentation(unsigned long free_heap, unsigned long largest_block) {
+  if (free_heap == 0 || largest_block >= free_heap) {
+    return 0;
+  }
+  return 100 - (int)((largest_block * 100) / free_heap);
+}
+
+/**
+ * Prints one CSV line per stage, MEMORY,<stage>,<runs>,<low free heap>,<low largest block>,<low free stack>,<held bytes>,
+ * then one per trend sample, HEAP,<minutes since power on>,<free heap>,<largest block>,<fragmentation %>,<min free heap>
+ *
+ * @param out: Where to print the lines, normally Serial
+ * @note The input core keeps recording while the game core dumps, so a stage line can be one run behind
+ */
+void Memory_Dump(Print &out) {
+  for (int stage = 0; stage < PROFILER_STAGE_COUNT; stage++) {
+    out.print("MEMORY,");
+    out.print(Profiler_GetStageName((ProfilerStage)stage));
+    out.print(',');
+    out.print(memory_runs[stage]);
+    out.print(',');
+    out.print(memory_low_heap[stage]);
+    out.print(',');
+    out.print(memory_low_block[stage]);
+    out.print(',');
+    out.print(memory_low_stack[stage]);
+    out.print(',');
+    out.println(memory_held[stage]);
+  }
+
+  /* Printed straight from the ring buffer, a copy of the trend would take a lot of the task's stack */
+  unsigned long first = (memory_trend_taken > MEMORY_TREND_COUNT) ? memory_trend_taken - MEMORY_TREND_COUNT : 0;
+  for (unsigned long i = first; i < memory_trend_taken; i++) {
+    const MemorySample &sample = memory_trend[i % MEMORY_TREND_COUNT];
+    out.print("HEAP,");
+    out.print(sample.time / 60000);
+    out.print(',');
+    out.print(sample.free_heap);
+    out.print(',');
+    out.print(sample.largest_block);
+    out.print(',');
+    out.print(Memory_GetFragmentation(sample.free_heap, sample.largest_block));
+    out.print(',');
+    out.println(sample.min_free_heap);
+  }
+}
+
+/**
+ * Samples the heap for the trend when the first sample or the next MEMORY_TREND_PERIOD is due, and dumps if MEMORY_COMMAND was received
+ *
+ * @param out: Where to print the lines, normally Serial
+ * @param command: The byte received over Serial (-1 if there was none)
+ * @param now: The current millis() time
+ * @return bool: If the readings were dumped
+ */
+bool Memory_Poll(Print &out, int command, unsigned long now) {
+  if (memory_trend_taken == 0 || now - memory_trend[(memory_trend_taken - 1) % MEMORY_TREND_COUNT].time >= MEMORY_TREND_PERIOD) {
+    Memory_Sample(now);
+  }
+
+  if (command == MEMORY_COMMAND) {
+    Memory_Dump(out);
+    return true;
+  }
+  return false;
+}
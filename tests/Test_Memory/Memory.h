@@ -0,0 +1,60 @@
+/************************************************************
+ * @file Memory.h
+ * @brief The header for tracking the heap and stack each stage of the loop leaves behind and the heap's trend over a long run
+ ************************************************************/
+#ifndef MEMORY_H
+#define MEMORY_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Profiler.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define MEMORY_TREND_COUNT  (48)      /* The number of heap samples kept, the oldest is overwritten by a new one */
+#define MEMORY_TREND_PERIOD (1800000) /* How often the heap is sampled for the trend (ms), so the samples cover a day */
+#define MEMORY_COMMAND      ('m')     /* The byte sent over Serial to ask for a dump */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The heap at one point in the run, all sizes are bytes */
+struct MemorySample {
+  unsigned long time;          /* The millis() time of the sample */
+  unsigned long free_heap;     /* The free heap */
+  unsigned long largest_block; /* The largest free heap block, the biggest allocation that could succeed */
+  unsigned long min_free_heap; /* The lowest free heap since power on */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Recording functions (each stage is only recorded from one core) */
+void          Memory_Reset();
+unsigned long Memory_BeginStage();
+void          Memory_EndStage(ProfilerStage stage, unsigned long heap_before);
+void          Memory_Sample(unsigned long now);
+
+/* Stage functions */
+unsigned long Memory_GetRuns(ProfilerStage stage);
+unsigned long Memory_GetLowFreeHeap(ProfilerStage stage);
+unsigned long Memory_GetLowLargestBlock(ProfilerStage stage);
+unsigned long Memory_GetLowFreeStack(ProfilerStage stage);
+long          Memory_GetHeldBytes(ProfilerStage stage);
+
+/* Trend functions */
+int Memory_GetSamples(MemorySample *samples);
+int Memory_GetFragmentation(unsigned long free_heap, unsigned long largest_block);
+
+/* Reporting functions */
+void Memory_Dump(Print &out);
+bool Memory_Poll(Print &out, int command, unsigned long now);
+
+#endif /* MEMORY_H */
@@ -0,0 +1,51 @@
+/************************************************************
+ * @file Profiler.h
+ * @brief The header for timing each stage of the loop into log-scale histograms and dumping them over Serial
+ ************************************************************/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define PROFILER_BUCKET_COUNT (16)    /* Bucket 0 holds 0 us, bucket i holds 2^(i-1) to 2^i - 1 us and the last holds the rest */
+#define PROFILER_COMMAND      ('p')   /* The byte sent over Serial to ask for a dump */
+#define PROFILER_DUMP_PERIOD  (60000) /* How often the histograms are dumped without being asked (ms, 0 to only dump on request) */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The stages of the loop that are timed */
+enum ProfilerStage {
+  PROFILER_STAGE_VOICE,     /* Polling the BLE module for a voice command */
+  PROFILER_STAGE_BUTTON,    /* Scanning the button arrays */
+  PROFILER_STAGE_TURN,      /* Checkers_Turn */
+  PROFILER_STAGE_INDICATOR, /* Updating the turn indicator LEDs */
+  PROFILER_STAGE_RENDER,    /* Updating the game map LEDs */
+  PROFILER_STAGE_COUNT
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Recording functions (each stage is only recorded from one core) */
+void Profiler_Reset();
+void Profiler_Record(ProfilerStage stage, unsigned long duration);
+
+/* Histogram functions */
+unsigned long Profiler_GetCount(ProfilerStage stage);
+unsigned long Profiler_GetMax(ProfilerStage stage);
+unsigned long Profiler_GetBucket(ProfilerStage stage, int bucket);
+int           Profiler_GetBucketIndex(unsigned long duration);
+const char    *Profiler_GetStageName(ProfilerStage stage);
+
+/* Reporting functions */
+void Profiler_Dump(Print &out);
+bool Profiler_Poll(Print &out, int command, unsigned long now);
+
+#endif /* PROFILER_H */
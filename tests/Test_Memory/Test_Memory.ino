@@ -0,0 +1,200 @@
+/************************************************************
+ * @file Test_Memory.ino
+ * @brief The tests for the heap and stack tracking
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Hal.h"
+#include "Memory.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+#include "FakeStream.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+FakeStream fake_serial; /* The Serial port the readings are printed to */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Clears the readings and the fake Serial port, starting with an unfragmented heap
+ *
+ */
+void ResetMemory() {
+  Hal_Reset();
+  Memory_Reset();
+  fake_serial.reset();
+  hal_free_heap = 200000;
+  hal_largest_free_block = 200000;
+  hal_min_free_heap = 200000;
+  hal_free_stack = 3000;
+}
+
+/**
+ * Runs a stage that allocates or frees heap
+ *
+ * @param stage: The stage to record
+ * @param allocated: The heap the stage takes in bytes, negative to free it
+ */
+void RunStage(ProfilerStage stage, long allocated) {
+  unsigned long heap = Memory_BeginStage();
+  hal_free_heap -= allocated;
+  Memory_EndStage(stage, heap);
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Memory_EndStage tests
+ **/
+test(Memory_EndStage_Flat_Success) {
+  ResetMemory();
+
+  for (int i = 0; i < 10; i++) {
+    RunStage(PROFILER_STAGE_RENDER, 0);
+  }
+
+  assertEqual(Memory_GetRuns(PROFILER_STAGE_RENDER), 10UL);
+  assertEqual(Memory_GetHeldBytes(PROFILER_STAGE_RENDER), 0L);
+  assertEqual(Memory_GetLowFreeHeap(PROFILER_STAGE_RENDER), 200000UL);
+  assertEqual(Memory_GetLowLargestBlock(PROFILER_STAGE_RENDER), 200000UL);
+  assertEqual(Memory_GetLowFreeStack(PROFILER_STAGE_RENDER), 3000UL);
+
+  /* Stages that never ran have no readings */
+  assertEqual(Memory_GetRuns(PROFILER_STAGE_VOICE), 0UL);
+  assertEqual(Memory_GetLowFreeHeap(PROFILER_STAGE_VOICE), 0UL);
+}
+
+test(Memory_EndStage_HeldBytes_Success) {
+  ResetMemory();
+
+  /* The heap a stage keeps is blamed on that stage, not the one that runs next */
+  RunStage(PROFILER_STAGE_VOICE, 64);
+  RunStage(PROFILER_STAGE_VOICE, 32);
+  RunStage(PROFILER_STAGE_TURN, 0);
+  assertEqual(Memory_GetHeldBytes(PROFILER_STAGE_VOICE), 96L);
+  assertEqual(Memory_GetHeldBytes(PROFILER_STAGE_TURN), 0L);
+  assertEqual(Memory_GetLowFreeHeap(PROFILER_STAGE_VOICE), 199904UL);
+
+  /* Giving it back brings the stage back to flat, while the low-water mark stays */
+  RunStage(PROFILER_STAGE_VOICE, -96);
+  assertEqual(Memory_GetHeldBytes(PROFILER_STAGE_VOICE), 0L);
+  assertEqual(Memory_GetLowFreeHeap(PROFILER_STAGE_VOICE), 199904UL);
+}
+
+test(Memory_EndStage_LowWater_Success) {
+  ResetMemory();
+
+  RunStage(PROFILER_STAGE_BUTTON, 0);
+  hal_largest_free_block = 120000;
+  hal_free_stack = 2500;
+  RunStage(PROFILER_STAGE_BUTTON, 0);
+  hal_largest_free_block = 150000;
+  hal_free_stack = 2800;
+  RunStage(PROFILER_STAGE_BUTTON, 0);
+
+  assertEqual(Memory_GetLowLargestBlock(PROFILER_STAGE_BUTTON), 120000UL);
+  assertEqual(Memory_GetLowFreeStack(PROFILER_STAGE_BUTTON), 2500UL);
+}
+
+/**
+ * Memory_GetFragmentation tests
+ **/
+test(Memory_GetFragmentation_Success) {
+  assertEqual(Memory_GetFragmentation(200000, 200000), 0);
+  assertEqual(Memory_GetFragmentation(200000, 150000), 25);
+  assertEqual(Memory_GetFragmentation(200000, 1000), 100);
+
+  /* Boards without a heap reading report none */
+  assertEqual(Memory_GetFragmentation(0, 0), 0);
+}
+
+/**
+ * Memory_Poll tests
+ **/
+test(Memory_Poll_Trend_Success) {
+  ResetMemory();
+  MemorySample samples[MEMORY_TREND_COUNT];
+
+  /* The first poll samples straight away, then once per period */
+  assertEqual(Memory_Poll(fake_serial, -1, 100), false);
+  Memory_Poll(fake_serial, -1, 100 + MEMORY_TREND_PERIOD - 1);
+  assertEqual(Memory_GetSamples(samples), 1);
+
+  hal_free_heap = 190000;
+  hal_largest_free_block = 95000;
+  Memory_Poll(fake_serial, -1, 100 + MEMORY_TREND_PERIOD);
+  assertEqual(Memory_GetSamples(samples), 2);
+  assertEqual(samples[0].free_heap, 200000UL);
+  assertEqual(samples[1].time, 100UL + MEMORY_TREND_PERIOD);
+  assertEqual(samples[1].free_heap, 190000UL);
+  assertEqual(samples[1].largest_block, 95000UL);
+  assertEqual(fake_serial.bytesWritten(), String(""));
+}
+
+test(Memory_Poll_TrendWrap_Success) {
+  ResetMemory();
+  MemorySample samples[MEMORY_TREND_COUNT];
+
+  /* Only the newest samples are kept, oldest first */
+  for (int i = 0; i < MEMORY_TREND_COUNT + 5; i++) {
+    hal_free_heap = 200000 - i;
+    Memory_Poll(fake_serial, -1, (unsigned long)i * MEMORY_TREND_PERIOD);
+  }
+
+  assertEqual(Memory_GetSamples(samples), MEMORY_TREND_COUNT);
+  assertEqual(samples[0].free_heap, 199995UL);
+  assertEqual(samples[MEMORY_TREND_COUNT - 1].free_heap, 200000UL - MEMORY_TREND_COUNT - 4);
+}
+
+test(Memory_Poll_Dump_Success) {
+  ResetMemory();
+
+  RunStage(PROFILER_STAGE_TURN, 48);
+  hal_largest_free_block = 150000;
+  Memory_Poll(fake_serial, -1, 120000);
+  fake_serial.reset();
+
+  /* Only the dump command prints */
+  assertEqual(Memory_Poll(fake_serial, 'x', 120100), false);
+  assertEqual(fake_serial.bytesWritten(), String(""));
+  assertEqual(Memory_Poll(fake_serial, MEMORY_COMMAND, 120200), true);
+
+  String expected = "MEMORY,voice,0,0,0,0,0\r\n";
+  expected += "MEMORY,button,0,0,0,0,0\r\n";
+  expected += "MEMORY,turn,1,199952,200000,3000,48\r\n";
+  expected += "MEMORY,indicator,0,0,0,0,0\r\n";
+  expected += "MEMORY,render,0,0,0,0,0\r\n";
+  expected += "HEAP,2,199952,150000,25,200000\r\n";
+  assertEqual(fake_serial.bytesWritten(), expected);
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
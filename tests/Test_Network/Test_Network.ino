@@ -0,0 +1,191 @@
+/************************************************************
+ * @file Test_Network.ino
+ * @brief The tests for the learned evaluation, its weight files, accumulators and output layer
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+#include "Network.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+Network network;                     /* The weights tested, too big for the stack */
+Network loaded;                      /* The weights loaded back */
+uint8_t file[NETWORK_FILE_SIZE + 1]; /* A weight file, with a byte to spare */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Fills the network with weights that look random, the same every time and in range for a weight file
+ *
+ * @param seed: Picks the weights
+ */
+void MakeNetwork(uint32_t seed) {
+  for (int i = 0; i < NETWORK_INPUTS; i++) {
+    for (int j = 0; j < NETWORK_HIDDEN; j++) {
+      seed = seed * 1103515245UL + 12345UL;
+      network.feature_weights[i][j] = (int16_t)((int)((seed >> 16) % 129) - 64);
+    }
+  }
+  for (int j = 0; j < NETWORK_HIDDEN; j++) {
+    seed = seed * 1103515245UL + 12345UL;
+    network.hidden_biases[j] = (int16_t)((int)((seed >> 16) % 129) - 64);
+  }
+  for (int j = 0; j < 2 * NETWORK_HIDDEN; j++) {
+    seed = seed * 1103515245UL + 12345UL;
+    network.output_weights[j] = (int16_t)((int)((seed >> 16) % 255) - 127);
+  }
+  network.output_bias = -321;
+  network.output_shift = 4;
+}
+
+/**
+ * Finds the first valid move in a game, trying every pair of squares in order
+ *
+ * @param game: The game
+ * @param move: The move found
+ * @return bool: If there is a valid move
+ */
+bool FindMove(Checkers &game, Move &move) {
+  for (int from = 0; from < MOVE_BOARD_SIZE * MOVE_BOARD_SIZE; from++) {
+    for (int to = 0; to < MOVE_BOARD_SIZE * MOVE_BOARD_SIZE; to++) {
+      Checkers copy = game;
+      if (copy.Checkers_Turn(Move_Make(from, to)) != 0) {
+        move = Move_Make(from, to);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Network_Load tests
+ **/
+test(Network_Load_Success) {
+  MakeNetwork(1);
+  assertEqual(Network_Save(network, file, sizeof(file)), (size_t)NETWORK_FILE_SIZE);
+  assertEqual(Network_Load(loaded, file, NETWORK_FILE_SIZE), true);
+  assertEqual(memcmp(&loaded, &network, sizeof(network)), 0);
+}
+
+test(Network_Load_Failure) {
+  MakeNetwork(2);
+  Network_Save(network, file, sizeof(file));
+  memset(&loaded, 0, sizeof(loaded));
+
+  /* Too short, too long and damaged files are all refused and leave the weights alone */
+  assertEqual(Network_Load(loaded, file, NETWORK_FILE_SIZE - 1), false);
+  assertEqual(Network_Load(loaded, file, NETWORK_FILE_SIZE + 1), false);
+  file[100] ^= 0x01;
+  assertEqual(Network_Load(loaded, file, NETWORK_FILE_SIZE), false);
+  file[100] ^= 0x01;
+  file[0] ^= 0x01;
+  assertEqual(Network_Load(loaded, file, NETWORK_FILE_SIZE), false);
+  assertEqual(loaded.output_shift, 0);
+  assertEqual(loaded.feature_weights[0][0], 0);
+}
+
+/**
+ * Network_Save tests
+ **/
+test(Network_Save_Failure) {
+  MakeNetwork(3);
+  assertEqual(Network_Save(network, file, NETWORK_FILE_SIZE - 1), (size_t)0);
+
+  network.feature_weights[5][7] = NETWORK_MAX_WEIGHT + 1;
+  assertEqual(Network_Save(network, file, sizeof(file)), (size_t)0);
+  network.feature_weights[5][7] = 0;
+  network.output_weights[3] = 128;
+  assertEqual(Network_Save(network, file, sizeof(file)), (size_t)0);
+  network.output_weights[3] = 0;
+  network.output_shift = NETWORK_MAX_SHIFT + 1;
+  assertEqual(Network_Save(network, file, sizeof(file)), (size_t)0);
+}
+
+/**
+ * Network_Make tests
+ **/
+test(Network_Make_Success) {
+  Checkers game;
+  Move move;
+  NetworkAccumulator accumulator;
+  NetworkAccumulator expected;
+  MakeNetwork(4);
+  Network_Refresh(network, game, accumulator);
+
+  /* Each move made has to give the accumulators of the whole board after it, and taken back the ones before it */
+  for (int i = 0; i < 40 && FindMove(game, move); i++) {
+    Checkers next = game;
+    NetworkChange change;
+    NetworkAccumulator start = accumulator;
+    next.Checkers_Turn(move);
+    Network_Make(network, accumulator, game, next, move, change);
+    Network_Refresh(network, next, expected);
+    assertEqual(memcmp(&accumulator, &expected, sizeof(expected)), 0);
+    assertLessOrEqual(change.count, NETWORK_MAX_CHANGE);
+
+    Network_Unmake(network, accumulator, change);
+    assertEqual(memcmp(&accumulator, &start, sizeof(start)), 0);
+    Network_Make(network, accumulator, game, next, move, change);
+    game = next;
+  }
+}
+
+/**
+ * Network_Evaluate tests
+ **/
+test(Network_Evaluate_Success) {
+  Checkers game;
+  NetworkAccumulator accumulator;
+  MakeNetwork(5);
+  Network_Refresh(network, game, accumulator);
+  assertEqual(Network_Evaluate(network, accumulator, 1), Network_EvaluatePlain(network, accumulator, 1));
+  assertEqual(Network_Evaluate(network, accumulator, 2), Network_EvaluatePlain(network, accumulator, 2));
+
+  /* Counting the player's men, 12 each at the start, and clipping the count of the other player's */
+  memset(&network, 0, sizeof(network));
+  for (int square = 0; square < CHECKERS_SNAPSHOT_SQUARES; square++) {
+    network.feature_weights[square][0] = 3;
+    network.feature_weights[2 * CHECKERS_SNAPSHOT_SQUARES + square][1] = 20;
+  }
+  network.output_weights[0] = 10;
+  network.output_weights[1] = -1;
+  network.output_bias = 4;
+  network.output_shift = 1;
+  Network_Refresh(network, game, accumulator);
+  assertEqual(Network_Evaluate(network, accumulator, 1), (12 * 3 * 10 - NETWORK_CLIP + 4) / 2);
+  assertEqual(Network_EvaluatePlain(network, accumulator, 2), (12 * 3 * 10 - NETWORK_CLIP + 4) / 2);
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
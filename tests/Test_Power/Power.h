@@ -0,0 +1,49 @@
+/************************************************************
+ * @file Power.h
+ * @brief The header for the idle governor, which notices when nobody is playing and measures how much of the idle time is slept
+ * @note After POWER_IDLE_TIMEOUT without a move, button press or Serial byte the game map is dimmed, each task slows to its idle period
+ *       and the ESP32 light sleeps between tasks. A button press wakes it at once, a voice command waits for the next voice poll
+ *       and Serial bytes sent while it sleeps are lost. Send POWER_COMMAND over Serial for one line:
+ *       POWER,<active|idle>,<times gone idle>,<active ms>,<idle ms>,<asleep ms>,<sleeps>,<sleeps woken by a button>,<idle duty cycle>
+ *       where the duty cycle is the share of the idle time spent awake, in tenths of a percent
+ ************************************************************/
+#ifndef POWER_H
+#define POWER_H
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "Arduino.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define POWER_IDLE_TIMEOUT (120000) /* The time without any input before the board goes idle (ms) */
+#define POWER_MIN_SLEEP    (5)      /* The shortest sleep worth taking, entering and leaving light sleep costs about 1 ms (ms) */
+#define POWER_MAX_SLEEP    (1000)   /* The longest sleep, so the board still checks in with nothing scheduled (ms) */
+#define POWER_COMMAND      ('d')    /* The byte sent over Serial to ask for the duty cycle */
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Governor functions (activity can come from either core, the rest is only called from the game core) */
+void          Power_Reset(unsigned long now);
+void          Power_Activity(unsigned long now);
+bool          Power_Update(unsigned long now);
+bool          Power_IsIdle();
+unsigned long Power_GetSleepTime(unsigned long time_to_next);
+void          Power_RecordSleep(unsigned long duration, bool pin_wake);
+
+/* Duty cycle functions */
+unsigned long Power_GetIdleEntries();
+unsigned long Power_GetActiveTime();
+unsigned long Power_GetIdleTime();
+unsigned long Power_GetSleepTotal();
+unsigned long Power_GetSleeps();
+unsigned long Power_GetPinWakes();
+int           Power_GetIdleDutyCycle();
+
+/* Reporting functions */
+void Power_Dump(Print &out);
+
+#endif /* POWER_H */
@@ -0,0 +1,168 @@
+/************************************************************
+ * @file Test_Power.ino
+ * @brief The tests for the idle governor
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Power.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+#include "FakeStream.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+FakeStream fake_serial; /* The Serial port the duty cycle is printed to */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Starts the governor active at a time of 0 and clears the fake Serial port
+ *
+ */
+void ResetPower() {
+  Power_Reset(0);
+  fake_serial.reset();
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Power_Update tests
+ **/
+test(Power_Update_GoesIdle_Success) {
+  ResetPower();
+
+  assertEqual(Power_Update(POWER_IDLE_TIMEOUT - 1), false);
+  assertEqual(Power_IsIdle(), false);
+
+  /* The board goes idle once, when the timeout passes */
+  assertEqual(Power_Update(POWER_IDLE_TIMEOUT), true);
+  assertEqual(Power_IsIdle(), true);
+  assertEqual(Power_Update(POWER_IDLE_TIMEOUT + 1000), false);
+  assertEqual(Power_GetIdleEntries(), 1UL);
+}
+
+test(Power_Update_Activity_Success) {
+  ResetPower();
+
+  /* Input keeps the board awake */
+  Power_Activity(POWER_IDLE_TIMEOUT - 1);
+  assertEqual(Power_Update(POWER_IDLE_TIMEOUT), false);
+
+  /* And wakes it on the next update once it is idle */
+  Power_Update(2 * POWER_IDLE_TIMEOUT);
+  assertEqual(Power_IsIdle(), true);
+  Power_Activity(2 * POWER_IDLE_TIMEOUT + 10);
+  assertEqual(Power_IsIdle(), true);
+  assertEqual(Power_Update(2 * POWER_IDLE_TIMEOUT + 20), true);
+  assertEqual(Power_IsIdle(), false);
+}
+
+test(Power_Update_Wraparound_Success) {
+  Power_Reset(0UL - 256);
+
+  /* The timeout still passes when millis() wraps around */
+  assertEqual(Power_Update(256), false);
+  assertEqual(Power_Update(POWER_IDLE_TIMEOUT - 256), true);
+}
+
+test(Power_Update_Time_Success) {
+  ResetPower();
+
+  /* Each update counts the time since the last one in the state the board was in */
+  Power_Update(POWER_IDLE_TIMEOUT);
+  Power_Update(POWER_IDLE_TIMEOUT + 5000);
+  Power_Activity(POWER_IDLE_TIMEOUT + 5000);
+  Power_Update(POWER_IDLE_TIMEOUT + 6000);
+  Power_Update(POWER_IDLE_TIMEOUT + 8000);
+  assertEqual(Power_GetActiveTime(), POWER_IDLE_TIMEOUT + 2000UL);
+  assertEqual(Power_GetIdleTime(), 6000UL);
+}
+
+/**
+ * Power_GetSleepTime tests
+ **/
+test(Power_GetSleepTime_Success) {
+  assertEqual(Power_GetSleepTime(0), 0UL);
+  assertEqual(Power_GetSleepTime(POWER_MIN_SLEEP - 1), 0UL);
+  assertEqual(Power_GetSleepTime(POWER_MIN_SLEEP), (unsigned long)POWER_MIN_SLEEP);
+  assertEqual(Power_GetSleepTime(250), 250UL);
+
+  /* The board still wakes up now and then with nothing scheduled */
+  assertEqual(Power_GetSleepTime(0xFFFFFFFFUL), (unsigned long)POWER_MAX_SLEEP);
+}
+
+/**
+ * Power_RecordSleep tests
+ **/
+test(Power_RecordSleep_DutyCycle_Success) {
+  ResetPower();
+  assertEqual(Power_GetIdleDutyCycle(), 0);
+
+  /* 9.8 s asleep out of 10 s idle is awake 2% of the time */
+  Power_Update(POWER_IDLE_TIMEOUT);
+  for (int i = 0; i < 98; i++) {
+    Power_RecordSleep(100000, false);
+  }
+  Power_RecordSleep(0, true);
+  Power_Update(POWER_IDLE_TIMEOUT + 10000);
+
+  assertEqual(Power_GetSleepTotal(), 9800UL);
+  assertEqual(Power_GetSleeps(), 99UL);
+  assertEqual(Power_GetPinWakes(), 1UL);
+  assertEqual(Power_GetIdleDutyCycle(), 20);
+}
+
+test(Power_RecordSleep_LongRun_Success) {
+  ResetPower();
+
+  /* Two hours of sleep, more us than an unsigned long holds */
+  for (int i = 0; i < 7200; i++) {
+    Power_RecordSleep(1000000, false);
+  }
+  assertEqual(Power_GetSleepTotal(), 7200000UL);
+}
+
+/**
+ * Power_Dump tests
+ **/
+test(Power_Dump_Success) {
+  ResetPower();
+
+  Power_Update(POWER_IDLE_TIMEOUT);
+  Power_RecordSleep(900000, false);
+  Power_Update(POWER_IDLE_TIMEOUT + 1000);
+  Power_Dump(fake_serial);
+
+  assertEqual(fake_serial.bytesWritten(), String("POWER,idle,1,120000,1000,900,1,0,100\r\n"));
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
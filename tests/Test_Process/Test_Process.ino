@@ -6,22 +6,40 @@
 /**********************************
  ** Library Includes
  **********************************/
+#include "Move.h"
 
 /**********************************
  ** Third Party Libraries Includes
  **********************************/
 #include "ArduinoUnit.h"
 
+/**********************************
+ ** Defines
+ **********************************/
+/* Time the buttons are ignored after the turn switches (ms) */
+#define TURN_SWITCH_LOCKOUT (400)
+
 /**********************************
  ** Global Variables
  **********************************/
 /* Variables for storing potential moves */
-String first_button_input; /* The string if there is only one button input */
-String move_command[2]; /* The move command broken down into a string array */
-String move_queue;
-int move_int[2][2]; /* 2D array for storing the move to send to the game algorithm */
+Square first_button_input; /* The square if there is only one button input */
+Move move_command; /* The move command to send to the game algorithm */
+Square move_queue; /* The square of the most recent button input */
+Square last_button_input; /* The square read on the last button scan, so a held button only counts once */
+int active_player; /* The active player last seen by the input core */
+bool buttons_locked; /* Indicator for if button presses are being ignored after a turn switch */
+
+/* Game core variables */
 int valid_move;
 
+/* Variables for recording mocked calls */
+int blink_counter;              /* The number of times the turn indicator was blinked */
+unsigned long unlock_deadline;  /* The time the mocked one-shot unlock task was scheduled for */
+Move queued_moves[4];           /* The moves pushed to the mocked handoff queue */
+int queued_count;               /* The number of moves in the mocked handoff queue */
+int publish_counter;            /* The number of times a snapshot was published */
+
 /**********************************
  ** Helper Functions
  **********************************/
@@ -60,45 +78,37 @@ void IOInitHwGameMapMock() {
 /**
  * This function mocks IO_GetVoiceRecognitionInput in the process
  *
+ * @param has_move: Whether a move was received
  * @param move: The move to pass in
- * @return String: The move received
+ * @param move_command: The move received
+ * @return bool: If a move was received
  */
-String IOGetVoiceRecognitionInputMock(String move) {
-  return move;
-}
+bool IOGetVoiceRecognitionInputMock(bool has_move, Move move, Move &move_command) {
+  if (has_move) {
+    move_command = move;
+  }
 
-/**
- * This function mocks IO_GetButtonInput in the process
- *
- * @param move: The move to pass in
- * @return String: The move received
- */
-String IOGetButtonInputMock(String move) {
-  return move;
+  return has_move;
 }
 
 /**
- * Converts a move command string to a form of a 2d integer array
+ * This function mocks IO_GetButtonInput in the process
  *
- * @param move_string: The move command string being converted
- * @param move_int: The move command returned as a form of a 2d integer array
+ * @param square: The square to pass in
+ * @return Square: The square received
  */
-void IOConvertMapToIndicesMock(String (&move_string)[2], int (&move_int)[2][2]) {
-  move_int[0][0] = move_string[0].charAt(0) - 65; /* A is 65 in the ASCII code, corresponds with row 0 */
-  move_int[0][1] = move_string[0].charAt(1) - 49; /* 1 is 49 in the ASCII code, corresponds with column 0 */
-  move_int[1][0] = move_string[1].charAt(0) - 65; /* A is 65 in the ASCII code, corresponds with row 0 */
-  move_int[1][1] = move_string[1].charAt(1) - 49; /* 1 is 49 in the ASCII code, corresponds with column 0 */
+Square IOGetButtonInputMock(Square square) {
+  return square;
 }
 
 /**
  * This function mocks Checkers_Turn in the process
  *
- * @param from: Where to move the piece from
- * @param to: Where to move the piece to
- * @return int: 1 if the move was in bounds, 0 if not
+ * @param move: The move to make
+ * @return int: 1 if both squares are ones the pieces can be on, 0 if not
  */
-int CheckersTurnMock(int from[2], int to[2]) {
-  if (from[0] >= 0 && from[0] < 8 && from[1] >= 0 && from[1] < 8 && to[0] >= 0 && to[0] < 8 && to[1] >= 0 && to[1] < 8) {
+int CheckersTurnMock(Move move) {
+  if ((Move_GetRow(move.from) + Move_GetCol(move.from)) % 2 == 0 && (Move_GetRow(move.to) + Move_GetCol(move.to)) % 2 == 0) {
     return 1;
   }
 
@@ -119,8 +129,9 @@ int CheckersGetActivePlayerMock(int active_player) {
  * This function mocks IO_SetTurnIndicator in the process
  *
  * @param active_player: The active player to pass in
+ * @param now: The mocked millis() time
  */
-void IOSetTurnIndicatorMock(int active_player) {
+void IOSetTurnIndicatorMock(int active_player, unsigned long now) {
   return;
 }
 
@@ -128,21 +139,57 @@ void IOSetTurnIndicatorMock(int active_player) {
  * This function mocks IO_BlinkTurnIndicator in the process
  *
  * @param active_player: The active player to pass in
+ * @param now: The mocked millis() time
  */
-void IOBlinkTurnIndicatorMock(int active_player) {
-  return;
+void IOBlinkTurnIndicatorMock(int active_player, unsigned long now) {
+  blink_counter++;
 }
 
 /**
  * This function mocks IO_WinnerTurnIndicator in the process
  *
  * @param active_player: The active player to pass in
+ * @param now: The mocked millis() time
  * @return int: The winner
  */
-int IOWinnerTurnIndicatorMock(int active_player) {
+int IOWinnerTurnIndicatorMock(int active_player, unsigned long now) {
   return active_player;
 }
 
+/**
+ * This function mocks Scheduler_AddOneShot in the process
+ *
+ * @param delay_time: The time to wait before running the task
+ * @param now: The mocked millis() time
+ */
+void SchedulerAddOneShotMock(unsigned long delay_time, unsigned long now) {
+  unlock_deadline = now + delay_time;
+}
+
+/**
+ * This function mocks Handoff_PushMove in the process
+ *
+ * @param move: The move to queue
+ * @return bool: If the move was queued
+ */
+bool HandoffPushMoveMock(const Move &move) {
+  if (queued_count == 4) {
+    return false;
+  }
+
+  queued_moves[queued_count] = move;
+  queued_count++;
+  return true;
+}
+
+/**
+ * This function mocks Handoff_PublishSnapshot in the process
+ *
+ */
+void HandoffPublishSnapshotMock() {
+  publish_counter++;
+}
+
 /**
  * This function mocks IO_SetHWGameMap in the process
  *
@@ -168,82 +215,174 @@ void Process_Setup() {
   IOInitHwGameMapMock();
 
   /* Global variable initializations */
-  first_button_input = "";
-  move_command[0] = "";
-  move_command[1] = "";
-  move_queue = "";
+  first_button_input = SQUARE_NONE;
+  move_command = Move_Make(SQUARE_NONE, SQUARE_NONE);
+  move_queue = SQUARE_NONE;
+  last_button_input = SQUARE_NONE;
+  active_player = 1;
+  buttons_locked = false;
+
+  /* Mock recording initializations */
+  blink_counter = 0;
+  unlock_deadline = 0;
+  queued_count = 0;
+  publish_counter = 0;
 }
 
 /**
- * Will loop through the processes and update modules accordingly
+ * Re-enables the buttons once the turn switch lockout is over
  *
- * @param win: Whether there is a winner in the game, mocking Checkers_GetWin
- * @param voice_rec: Whether to use the voice recognition or the button
+ * @param now: The mocked millis() time
+ */
+void Process_UnlockButtonsTask(unsigned long now) {
+  buttons_locked = false;
+}
+
+/**
+ * Locks the buttons for a moment if the game core has switched the turn, so the first player doesn't accidentally button press for the second player
+ *
+ * @param snapshot_player: The mocked active player of the latest snapshot
+ * @param now: The mocked millis() time
+ */
+void Process_CheckTurnSwitch(int snapshot_player, unsigned long now) {
+  if (active_player != CheckersGetActivePlayerMock(snapshot_player)) {
+    active_player = CheckersGetActivePlayerMock(snapshot_player);
+    buttons_locked = true;
+    SchedulerAddOneShotMock(TURN_SWITCH_LOCKOUT, now);
+  }
+}
+
+/**
+ * Queues the move command for the game core
+ *
+ */
+void Process_QueueMove() {
+  /* If the game core is too far behind the move is dropped, the same as a missed button press */
+  HandoffPushMoveMock(move_command);
+}
+
+/**
+ * Checks the voice recognition module for a move
+ *
+ * @param now: The mocked millis() time
+ * @param win: Whether there is a winner in the snapshot, mocking Checkers_GetWin
+ * @param has_move: Whether the mocked voice recognition module received a move
  * @param move: The mocked received move
- * @param active_player: The mocked active player
- * @param winner: The winner of the game (if there is one)
  */
-void Process_Loop(bool win, bool voice_rec, String (&move)[2], int active_player, int &winner) {
-  /* Check if there is a winner: when there is no winner, the game goes on */
-  if (win == false) {
-    /* Check the voice recognition module for a move */
-    if (first_button_input == "" && voice_rec == true){
-      move_command[0] = IOGetVoiceRecognitionInputMock(move[0]);
-      move_command[1] = IOGetVoiceRecognitionInputMock(move[1]);
-    }
+void Process_VoiceTask(unsigned long now, bool win, bool has_move, Move move) {
+  /* Voice commands are ignored once there is a winner or while a button move is half entered */
+  if (win == true || first_button_input != SQUARE_NONE) {
+    return;
+  }
 
-    /* If no voice command has been received */
-    if ((move_command[0] == "" || move_command[1] == "") && voice_rec == false) {
-      move_queue = IOGetButtonInputMock(move[0]);
-      if (first_button_input == "" && move_queue != "") {
-        /* Store first button input */
-        first_button_input = move_queue;
-        move_queue = "";
-      }
-
-      move_queue = IOGetButtonInputMock(move[1]);
-      if (first_button_input != "" && move_queue != "") {
-        /* If read button is the same as the first move, ignore as debouncing may not be detected yet */
-        if (first_button_input != move_queue) {
-          /* Store move in array */
-          move_command[0] = first_button_input;
-          move_command[1] = move_queue;
-          first_button_input = "";
-          move_queue = "";
-        }
-      }
-    }
-    /* Clear the first button move (first_button_input) if a voice command gets received */
-    else {
-      first_button_input = "";
+  /* If there is a move command */
+  if (IOGetVoiceRecognitionInputMock(has_move, move, move_command)) {
+    Process_QueueMove();
+  }
+}
+
+/**
+ * Scans the buttons for a move, which takes two different button presses
+ *
+ * @param now: The mocked millis() time
+ * @param win: Whether there is a winner in the snapshot, mocking Checkers_GetWin
+ * @param square: The mocked button press
+ * @param snapshot_player: The mocked active player of the latest snapshot
+ */
+void Process_ButtonTask(unsigned long now, bool win, Square square, int snapshot_player) {
+  Process_CheckTurnSwitch(snapshot_player, now);
+
+  /* A button only counts when it is first pressed, so one still held down from the last move does not start another */
+  move_queue = IOGetButtonInputMock(square);
+  if (move_queue == last_button_input) {
+    move_queue = SQUARE_NONE;
+  }
+  else {
+    last_button_input = move_queue;
+  }
+
+  /* Button presses are ignored once there is a winner or right after a turn switch */
+  if (win == true || buttons_locked) {
+    move_queue = SQUARE_NONE;
+    return;
+  }
+
+  if (first_button_input == SQUARE_NONE && move_queue != SQUARE_NONE) {
+    /* Store first button input */
+    first_button_input = move_queue;
+  }
+  else if (first_button_input != SQUARE_NONE && move_queue != SQUARE_NONE) {
+    /* If read button is the same as the first move, ignore as debouncing may not be detected yet */
+    if (move_queue != first_button_input) {
+      /* Store the move */
+      move_command = Move_Make(first_button_input, move_queue);
+      first_button_input = SQUARE_NONE;
+      Process_QueueMove();
     }
+  }
+  move_queue = SQUARE_NONE;
+}
 
-    /* If there is a move command */
-    if (move_command[0] != "" && move_command[1] != "") {
-      /* Convert the string to a 2D integer array to send to the game algorithm */
-      IOConvertMapToIndicesMock(move_command, move_int);
-  
-      /* Make a call to the game algorithm to pass in moves */
-      valid_move = CheckersTurnMock(move_int[0], move_int[1]);
-
-      /* Blink the turn indicator LED if the move is invalid */
-      if (valid_move == 0) {
-        IOBlinkTurnIndicatorMock(CheckersGetActivePlayerMock(active_player));
-      }
+/**
+ * Sends any queued moves to the game algorithm and publishes the result for the input core
+ *
+ * @param now: The mocked millis() time
+ * @param win: Whether there is a winner in the game, mocking Checkers_GetWin
+ */
+void Process_GameTask(unsigned long now, bool win) {
+  bool game_changed = false;
+
+  for (int i = 0; i < queued_count; i++) {
+    /* Moves that were queued before the game was won are dropped */
+    if (win == true) {
+      continue;
     }
 
-    /* Set the turn indicator LEDs */
-    IOSetTurnIndicatorMock(CheckersGetActivePlayerMock(active_player));
+    /* Make a call to the game algorithm to pass in moves */
+    valid_move = CheckersTurnMock(queued_moves[i]);
 
-    /* Set the game map LEDs */
-    IOSetHwGameMapMock();
+    /* Blink the turn indicator LED if the move is invalid */
+    if (valid_move == 0) {
+      IOBlinkTurnIndicatorMock(CheckersGetActivePlayerMock(active_player), now);
+    }
+    else {
+      game_changed = true;
+    }
   }
-  else {
-    /* Flash the turn indicator LED based on the winner until restarted */
-    winner = IOWinnerTurnIndicatorMock(CheckersGetActivePlayerMock(active_player));
+  queued_count = 0;
+
+  if (game_changed) {
+    HandoffPublishSnapshotMock();
   }
 }
 
+/**
+ * Updates the turn indicator LEDs, flashing the winner's LED once there is one
+ *
+ * @param now: The mocked millis() time
+ * @param win: Whether there is a winner in the game, mocking Checkers_GetWin
+ * @param active_player: The mocked active player
+ * @return int: The winner of the game (if there is one)
+ */
+int Process_IndicatorTask(unsigned long now, bool win, int active_player) {
+  if (win == false) {
+    IOSetTurnIndicatorMock(CheckersGetActivePlayerMock(active_player), now);
+    return 0;
+  }
+
+  /* Flash the turn indicator LED based on the winner until restarted */
+  return IOWinnerTurnIndicatorMock(CheckersGetActivePlayerMock(active_player), now);
+}
+
+/**
+ * Updates the game map LEDs
+ *
+ * @param now: The mocked millis() time
+ */
+void Process_RenderTask(unsigned long now) {
+  IOSetHwGameMapMock();
+}
+
 /**********************************
  ** Tests
  **********************************/
@@ -253,61 +392,183 @@ void Process_Loop(bool win, bool voice_rec, String (&move)[2], int active_player
 test(Process_Setup_Success) {
   Process_Setup();
 
-  assertEqual(first_button_input, "");
-  assertEqual(move_command[0], "");
-  assertEqual(move_command[1], "");
-  assertEqual(move_queue, "");
+  assertEqual(first_button_input, SQUARE_NONE);
+  assertEqual(move_command.from, SQUARE_NONE);
+  assertEqual(move_command.to, SQUARE_NONE);
+  assertEqual(move_queue, SQUARE_NONE);
+  assertEqual(last_button_input, SQUARE_NONE);
+  assertEqual(active_player, 1);
+  assertEqual(buttons_locked, false);
 }
 
 /**
- * Process_Loop tests
+ * Process_VoiceTask tests
  **/
-test(Process_Loop_VoiceRec_Success) {
-  int winner = 0;
-  String move_command[2] = {"A1", "B2"};
+test(Process_VoiceTask_Success) {
+  Process_Setup();
+  Move move = Move_Make(Move_MakeSquare(0, 0), Move_MakeSquare(1, 1));
 
-  Process_Loop(false, true, move_command, 1, winner);
-  assertEqual(winner, 0);
+  Process_VoiceTask(0, false, true, move);
+  assertEqual(queued_count, 1);
+  assertEqual(queued_moves[0].from, Move_MakeSquare(0, 0));
+  assertEqual(queued_moves[0].to, Move_MakeSquare(1, 1));
 }
 
-test(Process_Loop_ButtonInput_Different_Success) {
-  int winner = 0;
-  String move_command[2] = {"A1", "B2"};
+test(Process_VoiceTask_NoMove_Success) {
+  Process_Setup();
+  Move move = Move_Make(Move_MakeSquare(0, 0), Move_MakeSquare(1, 1));
 
-  Process_Loop(false, false, move_command, 1, winner);
-  assertEqual(winner, 0);
+  Process_VoiceTask(0, false, false, move);
+  assertEqual(queued_count, 0);
 }
 
-test(Process_Loop_ButtonInput_Same_Success) {
-  int winner = 0;
-  String move_command[2]  = {"A1", "A1"};
+test(Process_VoiceTask_ButtonInProgress_Success) {
+  Process_Setup();
+  Move move = Move_Make(Move_MakeSquare(0, 0), Move_MakeSquare(1, 1));
+  first_button_input = Move_MakeSquare(2, 2);
 
-  Process_Loop(false, false, move_command, 1, winner);
-  assertEqual(winner, 0);
+  Process_VoiceTask(0, false, true, move);
+  assertEqual(queued_count, 0);
+  assertEqual(first_button_input, Move_MakeSquare(2, 2));
 }
 
-test(Process_Loop_InvalidMove_Success) {
-  int winner = 0;
-  String move_command[2] = {"D9", "I3"};
+test(Process_VoiceTask_Winner_Success) {
+  Process_Setup();
+  Move move = Move_Make(Move_MakeSquare(0, 0), Move_MakeSquare(1, 1));
 
-  Process_Loop(false, false, move_command, 1, winner);
-  assertEqual(winner, 0);
+  Process_VoiceTask(0, true, true, move);
+  assertEqual(queued_count, 0);
 }
 
-test(Process_Loop_Player1Win_Success) {
-  int winner = 0;
-  String move_command[2] = {"A1", "B2"};
+/**
+ * Process_ButtonTask tests
+ **/
+test(Process_ButtonTask_Different_Success) {
+  Process_Setup();
+
+  Process_ButtonTask(0, false, Move_MakeSquare(0, 0), 1);
+  assertEqual(first_button_input, Move_MakeSquare(0, 0));
+  assertEqual(queued_count, 0);
 
-  Process_Loop(true, false, move_command, 1, winner);
-  assertEqual(winner, 1);
+  Process_ButtonTask(25, false, Move_MakeSquare(1, 1), 1);
+  assertEqual(first_button_input, SQUARE_NONE);
+  assertEqual(queued_count, 1);
+  assertEqual(queued_moves[0].from, Move_MakeSquare(0, 0));
+  assertEqual(queued_moves[0].to, Move_MakeSquare(1, 1));
 }
 
-test(Process_Loop_Player2Win_Success) {
-  int winner = 0;
-  String move_command[2] = {"A1", "B2"};
+test(Process_ButtonTask_Same_Success) {
+  Process_Setup();
+
+  Process_ButtonTask(0, false, Move_MakeSquare(0, 0), 1);
+  Process_ButtonTask(25, false, Move_MakeSquare(0, 0), 1);
+  assertEqual(first_button_input, Move_MakeSquare(0, 0));
+  assertEqual(queued_count, 0);
+}
+
+test(Process_ButtonTask_Held_Success) {
+  Process_Setup();
+
+  Process_ButtonTask(0, false, Move_MakeSquare(0, 0), 1);
+  Process_ButtonTask(25, false, SQUARE_NONE, 1);
+  Process_ButtonTask(50, false, Move_MakeSquare(1, 1), 1);
+  assertEqual(queued_count, 1);
+
+  /* The second button is still held down on the next scans, which should not start another move */
+  Process_ButtonTask(75, false, Move_MakeSquare(1, 1), 1);
+  Process_ButtonTask(100, false, Move_MakeSquare(1, 1), 1);
+  assertEqual(first_button_input, SQUARE_NONE);
+
+  Process_ButtonTask(125, false, SQUARE_NONE, 1);
+  Process_ButtonTask(150, false, Move_MakeSquare(1, 1), 1);
+  assertEqual(first_button_input, Move_MakeSquare(1, 1));
+  assertEqual(queued_count, 1);
+}
+
+test(Process_ButtonTask_TurnSwitchLockout_Success) {
+  Process_Setup();
+
+  Process_ButtonTask(1000, false, Move_MakeSquare(5, 1), 1);
+  Process_ButtonTask(1025, false, Move_MakeSquare(4, 0), 1);
+  Process_GameTask(1030, false);
+
+  /* The input core sees the turn switch in the next snapshot */
+  Process_ButtonTask(1050, false, Move_MakeSquare(2, 0), 2);
+  assertEqual(active_player, 2);
+  assertEqual(buttons_locked, true);
+  assertEqual(unlock_deadline, 1050 + TURN_SWITCH_LOCKOUT);
+  assertEqual(first_button_input, SQUARE_NONE);
+
+  /* Button presses are ignored until the unlock task runs */
+  Process_ButtonTask(1075, false, Move_MakeSquare(2, 0), 2);
+  assertEqual(first_button_input, SQUARE_NONE);
+
+  /* The button has to be released and pressed again once the unlock task runs */
+  Process_ButtonTask(1100, false, SQUARE_NONE, 2);
+  Process_UnlockButtonsTask(unlock_deadline);
+  Process_ButtonTask(unlock_deadline, false, Move_MakeSquare(2, 0), 2);
+  assertEqual(first_button_input, Move_MakeSquare(2, 0));
+}
+
+/**
+ * Process_GameTask tests
+ **/
+test(Process_GameTask_ValidMove_Success) {
+  Process_Setup();
+  Move move = Move_Make(Move_MakeSquare(5, 1), Move_MakeSquare(4, 0));
+
+  Process_VoiceTask(0, false, true, move);
+  Process_GameTask(5, false);
+  assertEqual(valid_move, 1);
+  assertEqual(blink_counter, 0);
+  assertEqual(publish_counter, 1);
+  assertEqual(queued_count, 0);
+}
+
+test(Process_GameTask_InvalidMove_Success) {
+  Process_Setup();
+
+  Process_ButtonTask(0, false, Move_MakeSquare(3, 0), 1);
+  Process_ButtonTask(25, false, Move_MakeSquare(2, 2), 1);
+  Process_GameTask(30, false);
+  assertEqual(valid_move, 0);
+  assertEqual(blink_counter, 1);
+  assertEqual(publish_counter, 0);
+}
+
+test(Process_GameTask_Empty_Success) {
+  Process_Setup();
+  valid_move = -1;
+
+  Process_GameTask(0, false);
+  assertEqual(valid_move, -1);
+  assertEqual(publish_counter, 0);
+}
+
+test(Process_GameTask_Winner_Success) {
+  Process_Setup();
+  Move move = Move_Make(Move_MakeSquare(5, 1), Move_MakeSquare(4, 0));
+  valid_move = -1;
+
+  Process_VoiceTask(0, false, true, move);
+  Process_GameTask(5, true);
+  assertEqual(valid_move, -1);
+  assertEqual(queued_count, 0);
+}
+
+/**
+ * Process_IndicatorTask tests
+ **/
+test(Process_IndicatorTask_NoWinner_Success) {
+  assertEqual(Process_IndicatorTask(0, false, 1), 0);
+}
+
+test(Process_IndicatorTask_Player1Win_Success) {
+  assertEqual(Process_IndicatorTask(0, true, 1), 1);
+}
 
-  Process_Loop(true, false, move_command, 2, winner);
-  assertEqual(winner, 2);
+test(Process_IndicatorTask_Player2Win_Success) {
+  assertEqual(Process_IndicatorTask(0, true, 2), 2);
 }
 
 /**********************************
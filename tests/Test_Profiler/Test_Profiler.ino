@@ -0,0 +1,177 @@
+/************************************************************
+ * @file Test_Profiler.ino
+ * @brief The tests for the loop timing histograms
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Profiler.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+#include "FakeStream.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+FakeStream fake_serial; /* The Serial port the profiler prints to */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Clears the histograms and the fake Serial port
+ *
+ */
+void ResetProfiler() {
+  Profiler_Reset();
+  fake_serial.reset();
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Profiler_GetBucketIndex tests
+ **/
+test(Profiler_GetBucketIndex_Success) {
+  assertEqual(Profiler_GetBucketIndex(0), 0);
+  assertEqual(Profiler_GetBucketIndex(1), 1);
+  assertEqual(Profiler_GetBucketIndex(2), 2);
+  assertEqual(Profiler_GetBucketIndex(3), 2);
+  assertEqual(Profiler_GetBucketIndex(4), 3);
+  assertEqual(Profiler_GetBucketIndex(1023), 10);
+  assertEqual(Profiler_GetBucketIndex(1024), 11);
+}
+
+test(Profiler_GetBucketIndex_Overflow) {
+  /* Everything from 2^14 us up shares the last bucket */
+  assertEqual(Profiler_GetBucketIndex(16383), 14);
+  assertEqual(Profiler_GetBucketIndex(16384), PROFILER_BUCKET_COUNT - 1);
+  assertEqual(Profiler_GetBucketIndex(4000000000UL), PROFILER_BUCKET_COUNT - 1);
+}
+
+/**
+ * Profiler_GetStageName tests
+ **/
+test(Profiler_GetStageName_Success) {
+  assertEqual(Profiler_GetStageName(PROFILER_STAGE_VOICE), "voice");
+  assertEqual(Profiler_GetStageName(PROFILER_STAGE_RENDER), "render");
+}
+
+/**
+ * Profiler_Record tests
+ **/
+test(Profiler_Record_Success) {
+  ResetProfiler();
+
+  Profiler_Record(PROFILER_STAGE_TURN, 0);
+  Profiler_Record(PROFILER_STAGE_TURN, 900);
+  Profiler_Record(PROFILER_STAGE_TURN, 600);
+  Profiler_Record(PROFILER_STAGE_TURN, 20000);
+
+  assertEqual(Profiler_GetCount(PROFILER_STAGE_TURN), 4);
+  assertEqual(Profiler_GetMax(PROFILER_STAGE_TURN), 20000);
+  assertEqual(Profiler_GetBucket(PROFILER_STAGE_TURN, 0), 1);
+  assertEqual(Profiler_GetBucket(PROFILER_STAGE_TURN, 10), 2);
+  assertEqual(Profiler_GetBucket(PROFILER_STAGE_TURN, PROFILER_BUCKET_COUNT - 1), 1);
+}
+
+test(Profiler_Record_StagesSeparate) {
+  ResetProfiler();
+
+  Profiler_Record(PROFILER_STAGE_VOICE, 3000);
+  Profiler_Record(PROFILER_STAGE_RENDER, 5);
+
+  assertEqual(Profiler_GetCount(PROFILER_STAGE_VOICE), 1);
+  assertEqual(Profiler_GetMax(PROFILER_STAGE_VOICE), 3000);
+  assertEqual(Profiler_GetCount(PROFILER_STAGE_RENDER), 1);
+  assertEqual(Profiler_GetMax(PROFILER_STAGE_RENDER), 5);
+  assertEqual(Profiler_GetCount(PROFILER_STAGE_BUTTON), 0);
+  assertEqual(Profiler_GetCount(PROFILER_STAGE_TURN), 0);
+  assertEqual(Profiler_GetCount(PROFILER_STAGE_INDICATOR), 0);
+}
+
+/**
+ * Profiler_Reset tests
+ **/
+test(Profiler_Reset_Success) {
+  ResetProfiler();
+  Profiler_Record(PROFILER_STAGE_BUTTON, 40);
+  Profiler_Reset();
+
+  assertEqual(Profiler_GetCount(PROFILER_STAGE_BUTTON), 0);
+  assertEqual(Profiler_GetMax(PROFILER_STAGE_BUTTON), 0);
+}
+
+/**
+ * Profiler_Dump tests
+ **/
+test(Profiler_Dump_Success) {
+  ResetProfiler();
+  Profiler_Record(PROFILER_STAGE_TURN, 100);
+  Profiler_Record(PROFILER_STAGE_TURN, 0);
+  Profiler_Dump(fake_serial);
+
+  assertEqual(fake_serial.bytesWritten(),
+              "PROFILE,voice,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\r\n"
+              "PROFILE,button,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\r\n"
+              "PROFILE,turn,2,100,1,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0\r\n"
+              "PROFILE,indicator,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\r\n"
+              "PROFILE,render,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\r\n");
+}
+
+/**
+ * Profiler_Poll tests
+ **/
+test(Profiler_Poll_Command) {
+  ResetProfiler();
+
+  assertEqual(Profiler_Poll(fake_serial, PROFILER_COMMAND, 1), true);
+  assertTrue(fake_serial.bytesWritten().startsWith("PROFILE,voice,"));
+
+  fake_serial.reset();
+  assertEqual(Profiler_Poll(fake_serial, -1, 2), false);
+  assertEqual(fake_serial.bytesWritten(), "");
+}
+
+test(Profiler_Poll_OtherByte) {
+  ResetProfiler();
+
+  assertEqual(Profiler_Poll(fake_serial, 'x', 1), false);
+  assertEqual(fake_serial.bytesWritten(), "");
+}
+
+test(Profiler_Poll_Periodic) {
+  ResetProfiler();
+
+  assertEqual(Profiler_Poll(fake_serial, -1, PROFILER_DUMP_PERIOD - 1), false);
+  assertEqual(Profiler_Poll(fake_serial, -1, PROFILER_DUMP_PERIOD), true);
+  assertEqual(Profiler_Poll(fake_serial, -1, PROFILER_DUMP_PERIOD + 1), false);
+  assertEqual(Profiler_Poll(fake_serial, -1, 2 * PROFILER_DUMP_PERIOD), true);
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
@@ -0,0 +1,58 @@
+/************************************************************
+ * @file Scheduler.h
+ * @brief The header for the cooperative task scheduler
+ * @note This file is copied over from src and modified for testing
+ ************************************************************/
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/**********************************
+ ** Defines
+ **********************************/
+#define SCHEDULER_MAX_TASKS (8)            /* The number of task slots available in a scheduler */
+#define SCHEDULER_NO_TASK   (-1)           /* Returned when a task could not be added */
+#define SCHEDULER_NO_WAIT   (0xFFFFFFFFUL) /* Returned as the time to the next task when there are none */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A task callback, which is passed the millis() time the scheduler is running at */
+typedef void (*SchedulerCallback)(unsigned long now);
+
+/* A task slot in the scheduler */
+struct SchedulerTask {
+  SchedulerCallback callback;      /* The function to run when the task is due */
+  unsigned long     period;        /* The time between runs in ms (0 for a one-shot task) */
+  unsigned long     deadline;      /* The millis() time the task is next due */
+  bool              active;        /* Indicator for if the slot holds a task */
+  unsigned long     run_count;     /* The number of times the task has run */
+  unsigned long     run_time;      /* The total time spent in the task in us */
+  unsigned long     max_run_time;  /* The longest single run of the task in us */
+};
+
+/*********************************************
+ ** Class Declarations and Function Prototypes
+ *********************************************/
+/* All functions are made public so tests can directly modify these values */
+class Scheduler {
+  public:
+    /* Originally Public Functions */
+    Scheduler();
+    int           Scheduler_AddPeriodic(SchedulerCallback callback, unsigned long period, unsigned long now);
+    int           Scheduler_AddOneShot(SchedulerCallback callback, unsigned long delay_time, unsigned long now);
+    void          Scheduler_Cancel(int task_id);
+    void          Scheduler_SetPeriod(int task_id, unsigned long period, unsigned long now);
+    void          Scheduler_Run(unsigned long now);
+    unsigned long Scheduler_GetTimeToNext(unsigned long now);
+    unsigned long Scheduler_GetRunCount(int task_id);
+    unsigned long Scheduler_GetRunTime(int task_id);
+    unsigned long Scheduler_GetMaxRunTime(int task_id);
+
+    /* Originally Private Functions */
+    int Scheduler_Add(SchedulerCallback callback, unsigned long period, unsigned long deadline);
+
+    /* Originally Private Members */
+    SchedulerTask tasks[SCHEDULER_MAX_TASKS]; /* The task slots */
+};
+
+#endif /* SCHEDULER_H */
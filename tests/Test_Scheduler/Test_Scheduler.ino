@@ -0,0 +1,313 @@
+/************************************************************
+ * @file Test_Scheduler.ino
+ * @brief The tests for the cooperative task scheduler
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Scheduler.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+int           task_a_runs = 0;     /* The number of times the first mock task ran */
+int           task_b_runs = 0;     /* The number of times the second mock task ran */
+unsigned long task_last_now = 0;   /* The time the most recent mock task was passed */
+Scheduler    *chained_scheduler;   /* The scheduler the chaining mock task adds to */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * This function mocks a task, counting its runs
+ *
+ * @param now: The time passed in by the scheduler
+ */
+void TaskAMock(unsigned long now) {
+  task_a_runs++;
+  task_last_now = now;
+}
+
+/**
+ * This function mocks a second task, counting its runs
+ *
+ * @param now: The time passed in by the scheduler
+ */
+void TaskBMock(unsigned long now) {
+  task_b_runs++;
+  task_last_now = now;
+}
+
+/**
+ * This function mocks a one-shot task that schedules another one-shot task
+ *
+ * @param now: The time passed in by the scheduler
+ */
+void TaskChainMock(unsigned long now) {
+  task_a_runs++;
+  chained_scheduler->Scheduler_AddOneShot(TaskBMock, 10, now);
+}
+
+/**
+ * Resets the mock task counters
+ *
+ */
+void ResetTaskMocks() {
+  task_a_runs = 0;
+  task_b_runs = 0;
+  task_last_now = 0;
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Scheduler constructor tests
+ **/
+test(Scheduler_Constructor_Success) {
+  Scheduler scheduler;
+
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    assertEqual(scheduler.tasks[i].active, false);
+    assertEqual(scheduler.tasks[i].run_count, 0);
+  }
+}
+
+/**
+ * Scheduler_AddPeriodic tests
+ **/
+test(Scheduler_AddPeriodic_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  assertEqual(scheduler.Scheduler_AddPeriodic(TaskAMock, 25, 1000), 0);
+  assertEqual(scheduler.Scheduler_AddPeriodic(TaskBMock, 50, 1000), 1);
+
+  /* Both tasks run right away */
+  scheduler.Scheduler_Run(1000);
+  assertEqual(task_a_runs, 1);
+  assertEqual(task_b_runs, 1);
+
+  /* Nothing is due yet */
+  scheduler.Scheduler_Run(1024);
+  assertEqual(task_a_runs, 1);
+  assertEqual(task_b_runs, 1);
+
+  /* Only the shorter period is due */
+  scheduler.Scheduler_Run(1025);
+  assertEqual(task_a_runs, 2);
+  assertEqual(task_b_runs, 1);
+  assertEqual(task_last_now, 1025);
+
+  /* Both are due */
+  scheduler.Scheduler_Run(1050);
+  assertEqual(task_a_runs, 3);
+  assertEqual(task_b_runs, 2);
+}
+
+test(Scheduler_AddPeriodic_SkipsMissedRuns_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  scheduler.Scheduler_AddPeriodic(TaskAMock, 10, 0);
+  scheduler.Scheduler_Run(0);
+
+  /* A long gap runs the task once instead of once per missed period */
+  scheduler.Scheduler_Run(100);
+  assertEqual(task_a_runs, 2);
+  scheduler.Scheduler_Run(105);
+  assertEqual(task_a_runs, 2);
+  scheduler.Scheduler_Run(110);
+  assertEqual(task_a_runs, 3);
+}
+
+test(Scheduler_AddPeriodic_Full_Failure) {
+  Scheduler scheduler;
+
+  for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+    assertEqual(scheduler.Scheduler_AddPeriodic(TaskAMock, 10, 0), i);
+  }
+
+  assertEqual(scheduler.Scheduler_AddPeriodic(TaskAMock, 10, 0), SCHEDULER_NO_TASK);
+}
+
+/**
+ * Scheduler_AddOneShot tests
+ **/
+test(Scheduler_AddOneShot_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  int task_id = scheduler.Scheduler_AddOneShot(TaskAMock, 400, 100);
+  assertEqual(task_id, 0);
+
+  scheduler.Scheduler_Run(499);
+  assertEqual(task_a_runs, 0);
+
+  scheduler.Scheduler_Run(500);
+  assertEqual(task_a_runs, 1);
+  assertEqual(scheduler.tasks[task_id].active, false);
+
+  /* The task does not run again */
+  scheduler.Scheduler_Run(900);
+  assertEqual(task_a_runs, 1);
+}
+
+test(Scheduler_AddOneShot_Chained_Success) {
+  Scheduler scheduler;
+  chained_scheduler = &scheduler;
+  ResetTaskMocks();
+
+  scheduler.Scheduler_AddOneShot(TaskChainMock, 0, 0);
+  scheduler.Scheduler_Run(0);
+  assertEqual(task_a_runs, 1);
+  assertEqual(task_b_runs, 0);
+
+  scheduler.Scheduler_Run(10);
+  assertEqual(task_b_runs, 1);
+}
+
+test(Scheduler_AddOneShot_Wraparound_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  /* The deadline wraps past the largest millis() value */
+  scheduler.Scheduler_AddOneShot(TaskAMock, 20, 0UL - 16);
+
+  scheduler.Scheduler_Run(0UL - 1);
+  assertEqual(task_a_runs, 0);
+
+  scheduler.Scheduler_Run(4);
+  assertEqual(task_a_runs, 1);
+}
+
+/**
+ * Scheduler_Cancel tests
+ **/
+test(Scheduler_Cancel_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  int task_id = scheduler.Scheduler_AddPeriodic(TaskAMock, 10, 0);
+  scheduler.Scheduler_Cancel(task_id);
+  scheduler.Scheduler_Run(0);
+  assertEqual(task_a_runs, 0);
+
+  /* The slot can be used again */
+  assertEqual(scheduler.Scheduler_AddPeriodic(TaskBMock, 10, 0), task_id);
+}
+
+/**
+ * Scheduler_SetPeriod tests
+ **/
+test(Scheduler_SetPeriod_Slower_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  int task_id = scheduler.Scheduler_AddPeriodic(TaskAMock, 10, 0);
+  scheduler.Scheduler_Run(0);
+
+  /* The run already due keeps its time, the ones after it use the new period */
+  scheduler.Scheduler_SetPeriod(task_id, 100, 5);
+  scheduler.Scheduler_Run(10);
+  assertEqual(task_a_runs, 2);
+  scheduler.Scheduler_Run(100);
+  assertEqual(task_a_runs, 2);
+  scheduler.Scheduler_Run(110);
+  assertEqual(task_a_runs, 3);
+}
+
+test(Scheduler_SetPeriod_Faster_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  int task_id = scheduler.Scheduler_AddPeriodic(TaskAMock, 1000, 0);
+  scheduler.Scheduler_Run(0);
+
+  /* A faster period brings the next run forward instead of waiting out the old one */
+  scheduler.Scheduler_SetPeriod(task_id, 10, 500);
+  scheduler.Scheduler_Run(509);
+  assertEqual(task_a_runs, 1);
+  scheduler.Scheduler_Run(510);
+  assertEqual(task_a_runs, 2);
+
+  /* One-shot tasks and invalid IDs are left alone */
+  int one_shot_id = scheduler.Scheduler_AddOneShot(TaskBMock, 100, 510);
+  scheduler.Scheduler_SetPeriod(one_shot_id, 10, 510);
+  scheduler.Scheduler_SetPeriod(SCHEDULER_NO_TASK, 10, 510);
+  scheduler.Scheduler_Run(520);
+  assertEqual(task_b_runs, 0);
+  scheduler.Scheduler_Run(610);
+  assertEqual(task_b_runs, 1);
+}
+
+/**
+ * Scheduler_GetTimeToNext tests
+ **/
+test(Scheduler_GetTimeToNext_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  assertEqual(scheduler.Scheduler_GetTimeToNext(0), SCHEDULER_NO_WAIT);
+
+  scheduler.Scheduler_AddPeriodic(TaskAMock, 50, 0);
+  scheduler.Scheduler_AddOneShot(TaskBMock, 30, 0);
+  assertEqual(scheduler.Scheduler_GetTimeToNext(0), 0UL);
+
+  scheduler.Scheduler_Run(0);
+  assertEqual(scheduler.Scheduler_GetTimeToNext(0), 30UL);
+  assertEqual(scheduler.Scheduler_GetTimeToNext(20), 10UL);
+  assertEqual(scheduler.Scheduler_GetTimeToNext(40), 0UL);
+
+  /* Once the one-shot task has run only the periodic task is waited on */
+  scheduler.Scheduler_Run(40);
+  assertEqual(scheduler.Scheduler_GetTimeToNext(40), 10UL);
+}
+
+/**
+ * Scheduler run time accounting tests
+ **/
+test(Scheduler_RunTimeAccounting_Success) {
+  Scheduler scheduler;
+  ResetTaskMocks();
+
+  int task_id = scheduler.Scheduler_AddPeriodic(TaskAMock, 10, 0);
+  scheduler.Scheduler_Run(0);
+  scheduler.Scheduler_Run(10);
+  scheduler.Scheduler_Run(20);
+
+  assertEqual(scheduler.Scheduler_GetRunCount(task_id), 3);
+  assertMoreOrEqual(scheduler.Scheduler_GetRunTime(task_id), scheduler.Scheduler_GetMaxRunTime(task_id));
+
+  /* Invalid IDs have no runs */
+  assertEqual(scheduler.Scheduler_GetRunCount(SCHEDULER_NO_TASK), 0);
+  assertEqual(scheduler.Scheduler_GetRunTime(SCHEDULER_MAX_TASKS), 0);
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
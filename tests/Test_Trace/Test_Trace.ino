@@ -0,0 +1,155 @@
+/************************************************************
+ * @file Test_Trace.ino
+ * @brief The tests for the trace ring buffer and the loop deadline
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Trace.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include "ArduinoUnit.h"
+#include "FakeStream.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+FakeStream fake_serial;                  /* The Serial port the trace is printed to */
+TraceEvent trace_copy[TRACE_EVENT_COUNT]; /* The events copied out of the ring buffer */
+
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Clears the trace and the fake Serial port
+ *
+ */
+void ResetTrace() {
+  Trace_Reset();
+  fake_serial.reset();
+}
+
+/**********************************
+ ** Tests
+ **********************************/
+/**
+ * Trace_Record tests
+ **/
+test(Trace_Record_Success) {
+  ResetTrace();
+
+  Trace_Record(TRACE_CHECKERS_TURN, TRACE_ENTER, 100);
+  Trace_Record(TRACE_CHECKERS_TURN, TRACE_EXIT, 150);
+
+  assertEqual(Trace_GetEvents(trace_copy), 2);
+  assertEqual(trace_copy[0].id, TRACE_CHECKERS_TURN);
+  assertEqual(trace_copy[0].kind, TRACE_ENTER);
+  assertEqual(trace_copy[0].time, 100);
+  assertEqual(trace_copy[1].kind, TRACE_EXIT);
+  assertEqual(trace_copy[1].time, 150);
+}
+
+test(Trace_Record_Wrap_Success) {
+  ResetTrace();
+
+  for (int i = 0; i < TRACE_EVENT_COUNT + 5; i++) {
+    Trace_Record(TRACE_IO_GET_BUTTON_INPUT, TRACE_ENTER, i);
+  }
+
+  /* Only the newest events are kept, oldest first */
+  assertEqual(Trace_GetEvents(trace_copy), TRACE_EVENT_COUNT);
+  assertEqual(trace_copy[0].time, 5);
+  assertEqual(trace_copy[TRACE_EVENT_COUNT - 1].time, TRACE_EVENT_COUNT + 4);
+}
+
+/**
+ * Trace_CheckDeadline tests
+ **/
+test(Trace_CheckDeadline_InTime_Success) {
+  ResetTrace();
+
+  assertEqual(Trace_CheckDeadline(1000, 1000 + TRACE_LOOP_DEADLINE), false);
+  assertEqual(Trace_IsFrozen(), false);
+}
+
+test(Trace_CheckDeadline_Overrun_Success) {
+  ResetTrace();
+
+  Trace_Record(TRACE_BLE_POLL_RX, TRACE_ENTER, 1000);
+  assertEqual(Trace_CheckDeadline(1000, 1001 + TRACE_LOOP_DEADLINE), true);
+  assertEqual(Trace_IsFrozen(), true);
+
+  /* Nothing is recorded over the events leading up to the overrun until the dump */
+  Trace_Record(TRACE_BLE_POLL_RX, TRACE_EXIT, 2000000);
+  assertEqual(Trace_GetEvents(trace_copy), 1);
+
+  /* A second overrun before the dump is already covered by it */
+  assertEqual(Trace_CheckDeadline(5000, 6000 + TRACE_LOOP_DEADLINE), false);
+}
+
+test(Trace_CheckDeadline_Wrap_Success) {
+  ResetTrace();
+
+  /* An iteration running over the micros() wrap is still measured */
+  assertEqual(Trace_CheckDeadline((unsigned long)-1000, TRACE_LOOP_DEADLINE), true);
+}
+
+test(Trace_Thaw_Success) {
+  ResetTrace();
+
+  assertEqual(Trace_CheckDeadline(1000, 1001 + TRACE_LOOP_DEADLINE), true);
+  Trace_Thaw(500000);
+  assertEqual(Trace_IsFrozen(), false);
+
+  /* The iteration that printed the dump is not checked, the next one is */
+  assertEqual(Trace_CheckDeadline(400000, 520000), false);
+  assertEqual(Trace_CheckDeadline(520000, 521000 + TRACE_LOOP_DEADLINE), true);
+}
+
+/**
+ * Trace_Dump tests
+ **/
+test(Trace_Dump_Success) {
+  ResetTrace();
+
+  Trace_Record(TRACE_IO_GET_VOICE_INPUT, TRACE_ENTER, 1000);
+  Trace_Record(TRACE_BLE_POLL_RX, TRACE_ENTER, 1010);
+  Trace_Record(TRACE_BLE_POLL_RX, TRACE_EXIT, 2001010);
+  Trace_Record(TRACE_IO_GET_VOICE_INPUT, TRACE_EXIT, 2001020);
+  Trace_CheckDeadline(1000, 2001030);
+  Trace_Dump(fake_serial);
+
+  String expected = "OVERRUN,0,2000030,";
+  expected += TRACE_LOOP_DEADLINE;
+  expected += "\r\n"
+              "TRACE,0,2000020,enter,IO_GetVoiceRecognitionInput\r\n"
+              "TRACE,0,2000010,enter,BLE_PollRx\r\n"
+              "TRACE,0,10,exit,BLE_PollRx\r\n"
+              "TRACE,0,0,exit,IO_GetVoiceRecognitionInput\r\n";
+  assertEqual(fake_serial.bytesWritten(), expected);
+}
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Set up serial to receive test results
+ *
+ * @note Must be named "setup" so the MCU knows to run this first before running the loop
+ */
+void setup() {
+  Serial.begin(115200);
+  while(!Serial) {}
+}
+
+/**
+ * Will loop through and run the tests, printing the results
+ *
+ * @note Must be named "loop" so it will repeatedly run on the MCU
+ */
+void loop() {
+  Test::run();
+}
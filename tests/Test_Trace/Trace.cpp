@@ -0,0 +1,203 @@
+/************************************************************
+ * @file Trace.cpp
+ * @brief The implementation for the ring buffer of recent function entries and exits, frozen and dumped when a loop runs past its deadline
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Trace.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <atomic>
+#include "Arduino.h"
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The names of the functions in a dump, in TraceId order */
+const char *trace_names[TRACE_ID_COUNT] = {
+  "IO_GetVoiceRecognitionInput", "IO_GetButtonInput", "IO_SetTurnIndicator", "IO_BlinkTurnIndicator",
+  "IO_WinnerTurnIndicator", "IO_SetHWGameMap", "Checkers_Turn", "BLE_PollRx", "BLE_RequestRx", "BLE_IsConnected",
+  "BLE_UpdateBattery", "Journal_RecordMove"
+};
+
+/* The ring buffer of events, both cores claim slots from the same counter */
+TraceEvent                 trace_events[TRACE_EVENT_COUNT];
+std::atomic<unsigned long> trace_next(0); /* The number of events that have been recorded */
+
+/* The deadline state */
+std::atomic<bool> trace_frozen(false); /* Indicator for if recording is stopped until the buffer is dumped */
+unsigned long     trace_overrun_time;  /* The length of the iteration that froze the buffer in us */
+int               trace_overrun_core;  /* The core that ran past its deadline */
+bool              trace_thawed;        /* Indicator for if the buffer has been thawed since the reset */
+unsigned long     trace_thaw_time;     /* The micros() time the buffer was last thawed */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+uint8_t Trace_GetCore();
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves the core the caller is running on
+ *
+ * @return uint8_t: The core (always 0 on single core boards)
+ */
+uint8_t Trace_GetCore() {
+#if defined(ESP32)
+  return (uint8_t)xPortGetCoreID();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Clears every event and thaws the buffer
+ *
+ */
+void Trace_Reset() {
+  trace_next.store(0);
+  trace_overrun_time = 0;
+  trace_overrun_core = 0;
+  trace_thawed = false;
+  trace_thaw_time = 0;
+  trace_frozen.store(false);
+}
+
+/**
+ * Adds an event to the ring buffer, unless it is frozen waiting to be dumped
+ *
+ * @param id: The function
+ * @param kind: If the function is starting or returning
+ * @param now: The current micros() time
+ */
+void Trace_Record(TraceId id, TraceKind kind, unsigned long now) {
+  if (trace_frozen.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  TraceEvent &event = trace_events[trace_next.fetch_add(1, std::memory_order_relaxed) % TRACE_EVENT_COUNT];
+  event.time = now;
+  event.id = (uint8_t)id;
+  event.kind = (uint8_t)kind;
+  event.core = Trace_GetCore();
+}
+
+/**
+ * Records a traced function starting
+ *
+ * @param id: The function
+ */
+void Trace_Enter(TraceId id) {
+  Trace_Record(id, TRACE_ENTER, micros());
+}
+
+/**
+ * Records a traced function returning
+ *
+ * @param id: The function
+ */
+void Trace_Exit(TraceId id) {
+  Trace_Record(id, TRACE_EXIT, micros());
+}
+
+/**
+ * Freezes the ring buffer if a loop iteration ran past TRACE_LOOP_DEADLINE, so the events leading up to it are kept for the dump
+ *
+ * @param start: The micros() time the iteration started
+ * @param now: The current micros() time
+ * @return bool: If this iteration froze the buffer
+ * @note Iterations that started before the last dump finished are not checked, since the dump itself holds up the loop
+ */
+bool Trace_CheckDeadline(unsigned long start, unsigned long now) {
+  if (TRACE_LOOP_DEADLINE == 0 || now - start <= TRACE_LOOP_DEADLINE) {
+    return false;
+  }
+
+  /* The buffer was thawed during this iteration */
+  if (trace_thawed && trace_thaw_time - start <= now - start) {
+    return false;
+  }
+
+  /* Only the first core to overrun freezes the buffer, the other's overrun is in the same dump */
+  bool frozen = false;
+  if (!trace_frozen.compare_exchange_strong(frozen, true, std::memory_order_acq_rel)) {
+    return false;
+  }
+
+  trace_overrun_time = now - start;
+  trace_overrun_core = Trace_GetCore();
+  return true;
+}
+
+/**
+ * Checks if the ring buffer is frozen waiting to be dumped
+ *
+ * @return bool: If the buffer is frozen
+ */
+bool Trace_IsFrozen() {
+  return trace_frozen.load(std::memory_order_acquire);
+}
+
+/**
+ * Starts recording again after a dump
+ *
+ * @param now: The current micros() time
+ */
+void Trace_Thaw(unsigned long now) {
+  trace_thaw_time = now;
+  trace_thawed = true;
+  trace_frozen.store(false, std::memory_order_release);
+}
+
+/**
+ * Copies the events in the ring buffer, oldest first
+ *
+ * @param events: Where to copy the events, with room for TRACE_EVENT_COUNT of them
+ * @return int: The number of events copied
+ */
+int Trace_GetEvents(TraceEvent *events) {
+  unsigned long next = trace_next.load(std::memory_order_acquire);
+  unsigned long count = (next < TRACE_EVENT_COUNT) ? next : TRACE_EVENT_COUNT;
+
+  for (unsigned long i = 0; i < count; i++) {
+    events[i] = trace_events[(next - count + i) % TRACE_EVENT_COUNT];
+  }
+  return (int)count;
+}
+
+/**
+ * Prints the overrun and the events leading up to it, oldest first
+ *
+ * @param out: Where to print the lines, normally Serial
+ * @note Prints OVERRUN,<core>,<iteration us>,<deadline us> and then TRACE,<core>,<us before the last event>,<enter|exit>,<function> per event
+ */
+void Trace_Dump(Print &out) {
+  TraceEvent events[TRACE_EVENT_COUNT];
+  int count = Trace_GetEvents(events);
+
+  out.print("OVERRUN,");
+  out.print(trace_overrun_core);
+  out.print(',');
+  out.print(trace_overrun_time);
+  out.print(',');
+  out.print((unsigned long)TRACE_LOOP_DEADLINE);
+  out.println();
+
+  for (int i = 0; i < count; i++) {
+    out.print("TRACE,");
+    out.print(events[i].core);
+    out.print(',');
+    out.print(events[count - 1].time - events[i].time);
+    out.print(',');
+    out.print((events[i].kind == TRACE_ENTER) ? "enter" : "exit");
+    out.print(',');
+    out.print((events[i].id < TRACE_ID_COUNT) ? trace_names[events[i].id] : "?");
+    out.println();
+  }
+}
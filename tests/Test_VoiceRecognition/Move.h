@@ -0,0 +1,83 @@
+/************************************************************
+ * @file Move.h
+ * @brief The header for the board square and move types shared by every module
+ ************************************************************/
+#ifndef MOVE_H
+#define MOVE_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include <stdint.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define MOVE_BOARD_SIZE (8)    /* The number of rows and columns on the board */
+#define SQUARE_NONE     (0xFF) /* The square used when there is no square, such as no button being pressed */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A board square packed into one byte as row * 8 + column (row 0 is A, column 0 is 1) */
+typedef uint8_t Square;
+
+/* A move packed into two bytes */
+struct Move {
+  Square from; /* The square to move the piece from */
+  Square to;   /* The square to move the piece to */
+};
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Packs a row and column into a square
+ *
+ * @param row: The row of the square
+ * @param col: The column of the square
+ * @return Square: The square, or SQUARE_NONE if the row or column is off the board
+ */
+inline Square Move_MakeSquare(int row, int col) {
+  if (row < 0 || row >= MOVE_BOARD_SIZE || col < 0 || col >= MOVE_BOARD_SIZE) {
+    return SQUARE_NONE;
+  }
+
+  return (Square)(row * MOVE_BOARD_SIZE + col);
+}
+
+/**
+ * Retrieves the row of a square
+ *
+ * @param square: The square
+ * @return int: The row (8 for SQUARE_NONE, which is off the board)
+ */
+inline int Move_GetRow(Square square) {
+  return (square == SQUARE_NONE) ? MOVE_BOARD_SIZE : square / MOVE_BOARD_SIZE;
+}
+
+/**
+ * Retrieves the column of a square
+ *
+ * @param square: The square
+ * @return int: The column (8 for SQUARE_NONE, which is off the board)
+ */
+inline int Move_GetCol(Square square) {
+  return (square == SQUARE_NONE) ? MOVE_BOARD_SIZE : square % MOVE_BOARD_SIZE;
+}
+
+/**
+ * Packs two squares into a move
+ *
+ * @param from: The square to move the piece from
+ * @param to: The square to move the piece to
+ * @return Move: The move
+ */
+inline Move Move_Make(Square from, Square to) {
+  Move move;
+  move.from = from;
+  move.to = to;
+  return move;
+}
+
+#endif /* MOVE_H */
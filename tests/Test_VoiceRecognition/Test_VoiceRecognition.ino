@@ -1,11 +1,12 @@
 /************************************************************
  * @file Test_VoiceRecognition.ino
- * @brief The tests for the I/O module
+ * @brief The tests for the Voice Recognition module
  ************************************************************/
 
 /**********************************
  ** Library Includes
  **********************************/
+#include "Move.h"
 #include "VoiceRecognition.h"
 
 /**********************************
@@ -13,6 +14,49 @@
  **********************************/
 #include "ArduinoUnit.h"
 
+/**********************************
+ ** Helper Functions
+ **********************************/
+/**
+ * Clears the parser state and any parsed moves so each test starts fresh
+ *
+ */
+void ResetParser() {
+  voice_parse_state = VOICE_PARSE_FROM_ROW;
+  while (voice_moves.available() != 0) {
+    voice_moves.pop();
+  }
+  while (voice_move_times.available() != 0) {
+    voice_move_times.pop();
+  }
+}
+
+/**
+ * Clears the BLE polling state, starting connected with no read request sent
+ *
+ */
+void ResetPolling() {
+  voice_irq_flag = false;
+  voice_rx_pending = false;
+  voice_connected = true;
+  voice_connection_check_time = 0;
+  ble_rx_fifo_mock = "";
+  ble_request_counter = 0;
+  voice_battery_enabled = true;
+  voice_battery_level = -1;
+  ble_battery_counter = 0;
+  ble_battery_mock = -1;
+}
+
+/**
+ * Runs a string through the parser
+ *
+ * @param received_data: The string to parse
+ */
+void ParseString(const char *received_data) {
+  VoiceRecognition_ParseBytes(received_data, strlen(received_data));
+}
+
 /**********************************
  ** Tests
  **********************************/
@@ -29,18 +73,98 @@ test(VoiceRecognition_OutputError_Success) {
 }
 
 /**
- * VoiceRecognition_ParseMoves tests
+ * VoiceRecognition_ParseBytes tests
  **/
-test(VoiceRecognition_ParseMoves_Success) {
-  String stored_result = "";
-  VoiceRecognition_ParseMoves("A2 B3 C4", stored_result);
-  assertEqual(stored_result, "A2 B3");
+test(VoiceRecognition_ParseBytes_Success) {
+  ResetParser();
+  Move move;
+
+  ParseString("A2 B3\n");
+  assertEqual((int)voice_moves.available(), 1);
+
+  move = voice_moves.pop();
+  assertEqual(Move_GetRow(move.from), 0);
+  assertEqual(Move_GetCol(move.from), 1);
+  assertEqual(Move_GetRow(move.to), 1);
+  assertEqual(Move_GetCol(move.to), 2);
+}
+
+test(VoiceRecognition_ParseBytes_SplitReads_Success) {
+  ResetParser();
+  Move move;
+
+  /* A command split across reads is only queued once it is complete */
+  ParseString("C");
+  ParseString("6 ");
+  assertEqual((int)voice_moves.available(), 0);
+  ParseString("E4;");
+  assertEqual((int)voice_moves.available(), 1);
+
+  move = voice_moves.pop();
+  assertEqual(Move_GetRow(move.from), 2);
+  assertEqual(Move_GetCol(move.from), 5);
+  assertEqual(Move_GetRow(move.to), 4);
+  assertEqual(Move_GetCol(move.to), 3);
+}
+
+test(VoiceRecognition_ParseBytes_MultipleCommands_Success) {
+  ResetParser();
+
+  ParseString("A1 B2;C3 D4\r\nE5 F6");
+  assertEqual((int)voice_moves.available(), 3);
+  assertEqual(Move_GetRow(voice_moves.pop().from), 0);
+  assertEqual(Move_GetRow(voice_moves.pop().from), 2);
+  assertEqual(Move_GetRow(voice_moves.pop().from), 4);
+}
+
+test(VoiceRecognition_ParseBytes_Lowercase_Success) {
+  ResetParser();
+  Move move;
+
+  ParseString("h8 g7\n");
+  assertEqual((int)voice_moves.available(), 1);
+
+  move = voice_moves.pop();
+  assertEqual(Move_GetRow(move.from), 7);
+  assertEqual(Move_GetCol(move.to), 6);
+}
+
+test(VoiceRecognition_ParseBytes_Malformed_Failure) {
+  ResetParser();
+
+  /* Malformed commands are skipped up to the next newline or semicolon */
+  ParseString("E12 F3F;A2A\nI1 B2;A9 B2;move A1 B2\n");
+  assertEqual((int)voice_moves.available(), 0);
+
+  /* The parser recovers for the next command */
+  ParseString("A1 B2;");
+  assertEqual((int)voice_moves.available(), 1);
+}
+
+test(VoiceRecognition_ParseBytes_TrailingData_Success) {
+  ResetParser();
+
+  /* The move is taken from the first five characters, the same as the old format check */
+  ParseString("A2 B3 C4");
+  assertEqual((int)voice_moves.available(), 1);
 
-  VoiceRecognition_ParseMoves("E1 F5", stored_result);
-  assertEqual(stored_result, "E1 F5");
+  /* The rest is the start of the next command */
+  assertEqual(voice_parse_state, VOICE_PARSE_GAP);
 
-  VoiceRecognition_ParseMoves("E12 F3F A2A", stored_result);
-  assertEqual(stored_result, "E12 F3F");
+  ResetParser();
+  ParseString("A2 B3C4;D5 E6;");
+  assertEqual((int)voice_moves.available(), 2);
+}
+
+test(VoiceRecognition_ParseBytes_QueueFull_Failure) {
+  ResetParser();
+
+  for (int i = 0; i < VOICE_MOVE_QUEUE_SIZE + 1; i++) {
+    ParseString("A1 B2;");
+  }
+
+  /* Moves that do not fit are dropped */
+  assertEqual((int)voice_moves.available(), VOICE_MOVE_QUEUE_SIZE);
 }
 
 /**
@@ -113,18 +237,157 @@ test(VoiceRecognition_Init_Success) {
  * VoiceRecognition_GetInput tests
  **/
 test(VoiceRecognition_GetInput_NotConnected) {
-  String parsed_checker_move = "";
-  VoiceRecognition_GetInput(parsed_checker_move, false, "A3 B6");
-  assertEqual(parsed_checker_move, "");
+  ResetParser();
+  ResetPolling();
+  Move checker_move;
+  voice_connected = false;
+
+  /* No read requests are sent without a connection */
+  assertEqual(VoiceRecognition_GetInput(checker_move, 0, false, false, ""), false);
+  assertEqual(ble_request_counter, 0);
 }
 
 test(VoiceRecognition_GetInput_Success) {
-  String parsed_checker_move = "";
-  VoiceRecognition_GetInput(parsed_checker_move, true, "A3 B6");
-  assertEqual(parsed_checker_move, "A3 B6");
+  ResetParser();
+  ResetPolling();
+  Move checker_move;
+
+  /* The first call only sends the read request */
+  assertEqual(VoiceRecognition_GetInput(checker_move, 0, true, false, "A3 B6"), false);
+  assertEqual(ble_request_counter, 1);
+  assertEqual(voice_rx_pending, true);
+
+  /* Nothing is read until the module raises IRQ */
+  assertEqual(VoiceRecognition_GetInput(checker_move, 50, true, true, "A3 B6"), false);
+  assertEqual(ble_request_counter, 1);
+
+  VoiceRecognition_IrqHandler();
+  assertEqual(VoiceRecognition_GetInput(checker_move, 60, true, true, "A3 B6"), true);
+  assertEqual(Move_GetRow(checker_move.from), 0);
+  assertEqual(Move_GetCol(checker_move.from), 2);
+  assertEqual(Move_GetRow(checker_move.to), 1);
+  assertEqual(Move_GetCol(checker_move.to), 5);
+
+  /* The next read request goes out once the reply is collected */
+  assertEqual(ble_request_counter, 2);
+
+  VoiceRecognition_IrqHandler();
+  assertEqual(VoiceRecognition_GetInput(checker_move, 110, true, true, "AD3 B16 CAT"), false);
+}
+
+test(VoiceRecognition_GetInput_Timeout_Success) {
+  ResetParser();
+  ResetPolling();
+  Move checker_move;
+
+  VoiceRecognition_GetInput(checker_move, 0, true, false, "");
+  VoiceRecognition_GetInput(checker_move, 99, true, false, "");
+  assertEqual(ble_request_counter, 1);
+
+  /* The request is sent again if the reply never comes */
+  VoiceRecognition_GetInput(checker_move, 100, true, false, "");
+  assertEqual(ble_request_counter, 2);
+
+  /* A missed IRQ edge is still caught by the timeout */
+  assertEqual(VoiceRecognition_GetInput(checker_move, 200, true, true, "E3 F4\n"), true);
+  assertEqual(Move_GetRow(checker_move.from), 4);
+}
+
+test(VoiceRecognition_GetInput_ConnectionCache_Success) {
+  ResetParser();
+  ResetPolling();
+  Move checker_move;
+
+  /* The connection state is not checked again until the refresh time */
+  VoiceRecognition_GetInput(checker_move, 999, false, false, "");
+  assertEqual(ble_request_counter, 1);
+  assertEqual(voice_connected, true);
+
+  voice_rx_pending = false;
+  VoiceRecognition_GetInput(checker_move, 1000, false, false, "");
+  assertEqual(voice_connected, false);
+  assertEqual(voice_connection_check_time, 1000);
+  assertEqual(ble_request_counter, 1);
+}
+
+test(VoiceRecognition_GetInput_LongRead_Success) {
+  ResetParser();
+  ResetPolling();
+  Move checker_move;
+
+  /* Replies longer than the buffer are parsed in pieces */
+  VoiceRecognition_GetInput(checker_move, 0, true, false, "");
+  VoiceRecognition_IrqHandler();
+  assertEqual(VoiceRecognition_GetInput(checker_move, 10, true, true, "this is a longer message than the buffer;C1 D2\nE3 F4\n"), true);
+  assertEqual(Move_GetRow(checker_move.from), 2);
+  assertEqual(VoiceRecognition_GetInput(checker_move, 20, true, false, ""), true);
+  assertEqual(Move_GetRow(checker_move.from), 4);
+  assertEqual(VoiceRecognition_GetInput(checker_move, 30, true, false, ""), false);
+}
+
+test(VoiceRecognition_GetInputTime_Success) {
+  ResetParser();
+  ResetPolling();
+  Move checker_move;
+
+  VoiceRecognition_GetInput(checker_move, 0, true, false, "");
+  VoiceRecognition_IrqHandler();
+  unsigned long before = micros();
+  assertEqual(VoiceRecognition_GetInput(checker_move, 10, true, true, "A1 B2;C3 D4\n"), true);
+  unsigned long arrival = VoiceRecognition_GetInputTime();
+  assertMoreOrEqual(arrival, before);
+
+  /* A move taken on a later call keeps the time its bytes arrived */
+  delay(2);
+  assertEqual(VoiceRecognition_GetInput(checker_move, 20, true, false, ""), true);
+  assertEqual(Move_GetRow(checker_move.from), 2);
+  assertEqual(VoiceRecognition_GetInputTime(), arrival);
+}
+
+/**
+ * VoiceRecognition_SetBatteryLevel tests
+ **/
+test(VoiceRecognition_SetBatteryLevel_Success) {
+  ResetParser();
+  ResetPolling();
+  Move checker_move;
+
+  /* The level waits while a read request is waiting on its reply */
+  VoiceRecognition_GetInput(checker_move, 0, true, false, "");
+  VoiceRecognition_SetBatteryLevel(80);
+  VoiceRecognition_GetInput(checker_move, 10, true, false, "");
+  assertEqual(ble_battery_counter, 0);
+
+  /* And is sent once the reply is collected, before the next read request */
+  VoiceRecognition_IrqHandler();
+  VoiceRecognition_GetInput(checker_move, 20, true, true, "");
+  assertEqual(ble_battery_counter, 1);
+  assertEqual(ble_battery_mock, 80);
+  assertEqual(voice_rx_pending, true);
+
+  /* It is only sent once */
+  VoiceRecognition_IrqHandler();
+  VoiceRecognition_GetInput(checker_move, 30, true, true, "");
+  assertEqual(ble_battery_counter, 1);
+}
+
+test(VoiceRecognition_SetBatteryLevel_NotConnected_Success) {
+  ResetParser();
+  ResetPolling();
+  Move checker_move;
+  voice_connected = false;
+
+  /* The battery service keeps its level for when the app connects */
+  VoiceRecognition_SetBatteryLevel(35);
+  VoiceRecognition_GetInput(checker_move, 0, false, false, "");
+  assertEqual(ble_battery_mock, 35);
 
-  VoiceRecognition_GetInput(parsed_checker_move, true, "AD3 B16 CAT");
-  assertEqual(parsed_checker_move, "AD3 B16");
+  /* Nothing is sent if the module has no battery service */
+  voice_battery_enabled = false;
+  VoiceRecognition_SetBatteryLevel(30);
+  VoiceRecognition_GetInput(checker_move, 10, false, false, "");
+  assertEqual(ble_battery_counter, 1);
+  assertEqual(voice_battery_level, -1);
 }
 
 /**********************************
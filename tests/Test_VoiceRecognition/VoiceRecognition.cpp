@@ -6,19 +6,55 @@
 /**********************************
  ** Library Includes
  **********************************/
+#include "Move.h"
 #include "VoiceRecognition.h"
 
 /**********************************
  ** Third Party Libraries Includes
  **********************************/
+#include "circular_queue/circular_queue.h"
 
 /**********************************
  ** Defines
  **********************************/
+/* Parser settings */
+#define VOICE_RX_BUFFER_SIZE (32) /* The number of bytes read from the BLE module at a time */
+
+/* BLE polling settings (ms) */
+#define VOICE_RX_TIMEOUT            (100)  /* Time to wait for the reply to a read request before asking again */
+#define VOICE_CONNECTION_CHECK_TIME (1000) /* How often the cached connection state is refreshed */
 
 /**********************************
  ** Global Variables
  **********************************/
+/* Parser state, kept between reads so a command can be split across them */
+VoiceParseState      voice_parse_state = VOICE_PARSE_FROM_ROW;
+int                  voice_parse_row = 0;                    /* The row of the square being parsed */
+Move                 voice_parse_move;                       /* The move being parsed */
+char                 voice_rx_buffer[VOICE_RX_BUFFER_SIZE];  /* The bytes most recently read from the BLE module */
+
+/* Moves that have been parsed but not taken yet, along with the micros() time their bytes were read off the module */
+circular_queue<Move>          voice_moves(VOICE_MOVE_QUEUE_SIZE);
+circular_queue<unsigned long> voice_move_times(VOICE_MOVE_QUEUE_SIZE);
+unsigned long                 voice_rx_time = 0;    /* The micros() time of the bytes being parsed */
+unsigned long                 voice_input_time = 0; /* The micros() time of the move last taken */
+
+/* BLE polling state, so no call waits on the module */
+volatile bool voice_irq_flag = false;          /* Set by the IRQ line when the module has a reply ready */
+bool          voice_rx_pending = false;        /* Indicator for if a read request is waiting on its reply */
+unsigned long voice_rx_request_time = 0;       /* The millis() time the read request was sent */
+bool          voice_connected = false;         /* The cached connection state */
+unsigned long voice_connection_check_time = 0; /* The millis() time the connection state was last refreshed */
+
+/* Battery service state */
+bool voice_battery_enabled = false; /* Indicator for if the module's battery service is running */
+int  voice_battery_level = -1;      /* The level in % waiting to be sent, -1 once it has been */
+
+/* Mocked BLE module state */
+String ble_rx_fifo_mock = ""; /* The data in the mocked RX FIFO */
+int    ble_request_counter;   /* The number of read requests sent to the mocked module */
+int    ble_battery_counter;   /* The number of battery levels sent to the mocked module */
+int    ble_battery_mock = -1; /* The battery level last sent to the mocked module */
 
 /**********************************
  ** Helper Functions
@@ -116,28 +152,69 @@ bool BleIsConnectedMock(bool connected) {
 }
 
 /**
- * This function will mock a BLE available call
+ * This function will mock turning on the BLE battery service
+ *
+ * @return bool: Whether the battery service is running
+ */
+bool BleBatteryBeginMock() {
+  return true;
+}
+
+/**
+ * This function will mock a BLE battery level update, counting how many are sent
+ *
+ * @param level: The battery level in %
+ * @return bool: Whether the level was taken
+ */
+bool BleBatteryUpdateMock(int level) {
+  ble_battery_counter++;
+  ble_battery_mock = level;
+  return true;
+}
+
+/**
+ * This function will mock a BLE read request
+ *
+ * @return bool: Whether the request was sent
+ */
+bool BleRequestRxMock() {
+  ble_request_counter++;
+  return true;
+}
+
+/**
+ * This function will mock collecting a reply from BLE into the RX FIFO
  *
- * @param input: The input to check whether there is still a string to parse through
- * @return bool: Whether there is data to parse through
+ * @param irq: The mocked IRQ line level
+ * @param input: The data the mocked module replies with
+ * @return bool: Whether a reply was collected
  */
-bool BleAvailableMock(String input) {
-  if (input.length() == 0) {
+bool BlePollRxMock(bool irq, String input) {
+  if (irq == false) {
     return false;
   }
 
+  ble_rx_fifo_mock += input;
   return true;
 }
 
-char BleReadMock(String &input) {
-  char ret_val;
+/**
+ * This function will mock copying data out of the RX FIFO
+ *
+ * @param buffer: The buffer to copy to
+ * @param size: The size of the buffer
+ * @return int: The number of bytes copied
+ */
+int BleReadBufferedMock(char *buffer, int size) {
+  int length = 0;
 
-  if (input.length() != 0) {
-    ret_val = input.charAt(0);
-    input.remove(0, 1);
+  while (length < size && ble_rx_fifo_mock.length() != 0) {
+    buffer[length] = ble_rx_fifo_mock.charAt(0);
+    ble_rx_fifo_mock.remove(0, 1);
+    length++;
   }
 
-  return ret_val;
+  return length;
 }
 
 /**********************************
@@ -154,28 +231,102 @@ void VoiceRecognition_OutputError(String error, String &recent_error) {
 }
 
 /**
- * Parses a command from the BLE application into a move array of length 2
+ * Flags that the BLE module has a reply ready, the reply is read outside of the interrupt
  *
- * @param moves: The moves from the BLE application to parse
- * @param result: The result of the move to send back
  */
-void VoiceRecognition_ParseMoves(String moves, String &result) {
-  /* Vector to store parsed moves */
-  int index = 0;
-  int start = 0;
-  int space_index = moves.indexOf(' '); /* Find the first space */
+void VoiceRecognition_IrqHandler() {
+  voice_irq_flag = true;
+}
 
-  /* Only stores the first five characters and parses for spaces */
-  while ((space_index != -1) && (index < 1)) {
-    /* Get the substring from start to the next space */
-    if (start != space_index) {
-      result = moves.substring(start, moves.indexOf(' ', space_index + 1));
-      index += 1;
-    }
+/**
+ * Steps the command parser by one byte, queueing the move once both squares are received
+ *
+ * @param received_data: The byte received from the BLE application
+ */
+void VoiceRecognition_ParseByte(char received_data) {
+  bool terminator = (received_data == '\n' || received_data == '\r' || received_data == ';');
+  bool separator = (terminator || received_data == ' ');
 
-    /* Move to the next space */
-    start = space_index + 1;
-    space_index = moves.indexOf(' ', start);
+  /* Row letters may come in lowercase from the speech to text */
+  if (received_data >= 'a' && received_data <= 'h') {
+    received_data = received_data - 'a' + 'A';
+  }
+  bool row = (received_data >= 'A' && received_data <= 'H');
+  bool col = (received_data >= '1' && received_data <= '8');
+
+  switch (voice_parse_state) {
+    case VOICE_PARSE_FROM_ROW:
+      /* Skip anything between commands */
+      if (row) {
+        voice_parse_row = received_data - 'A';
+        voice_parse_state = VOICE_PARSE_FROM_COL;
+      }
+      else if (!separator) {
+        voice_parse_state = VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_FROM_COL:
+      if (col) {
+        voice_parse_move.from = Move_MakeSquare(voice_parse_row, received_data - '1');
+        voice_parse_state = VOICE_PARSE_GAP;
+      }
+      else {
+        voice_parse_state = terminator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_GAP:
+      if (received_data == ' ') {
+        voice_parse_state = VOICE_PARSE_TO_ROW;
+      }
+      else {
+        voice_parse_state = terminator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_TO_ROW:
+      if (row) {
+        voice_parse_row = received_data - 'A';
+        voice_parse_state = VOICE_PARSE_TO_COL;
+      }
+      else if (received_data != ' ') {
+        voice_parse_state = terminator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_TO_COL:
+      if (col) {
+        voice_parse_move.to = Move_MakeSquare(voice_parse_row, received_data - '1');
+
+        /* The move is queued right away since the app may not end the last command, if the queue is full it is dropped the same as a missed button press */
+        if (voice_moves.push(voice_parse_move)) {
+          voice_move_times.push(voice_rx_time);
+        }
+        voice_parse_state = VOICE_PARSE_END;
+      }
+      else {
+        voice_parse_state = terminator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      }
+      break;
+    case VOICE_PARSE_END:
+      /* Anything run into the end of the move is skipped until the next command */
+      voice_parse_state = separator ? VOICE_PARSE_FROM_ROW : VOICE_PARSE_DISCARD;
+      break;
+    case VOICE_PARSE_DISCARD:
+    default:
+      if (terminator) {
+        voice_parse_state = VOICE_PARSE_FROM_ROW;
+      }
+      break;
+  }
+}
+
+/**
+ * Runs a block of received bytes through the command parser
+ *
+ * @param received_data: The bytes received from the BLE application
+ * @param length: The number of bytes received
+ */
+void VoiceRecognition_ParseBytes(const char *received_data, int length) {
+  for (int i = 0; i < length; i++) {
+    VoiceRecognition_ParseByte(received_data[i]);
   }
 }
 
@@ -211,6 +362,9 @@ void VoiceRecognition_Init(bool &correct_functions_called, String &recent_error,
     }
   }
 
+  /* Turn on the battery service, which resets the module so it is done before any other setting, the game runs without it if it fails */
+  voice_battery_enabled = BleBatteryBeginMock();
+
   /* Disable command echo from Bluefruit */
   if (correct_functions_called == true) {
     correct_functions_called = BleEchoMock(echo);
@@ -226,23 +380,85 @@ void VoiceRecognition_Init(bool &correct_functions_called, String &recent_error,
 }
 
 /**
- * Receives checker move from BLE and parse to return to IO
+ * Receives any new data from BLE and returns the oldest parsed checker move
  *
- * @param parsed_checker_move: The String that returns a checker move
+ * @param checker_move: The parsed checker move
+ * @param now: The mocked millis() time
  * @param connection: The mocked BLE connection status
+ * @param irq: The mocked IRQ line level
+ * @param input_data: The mocked data the BLE module replies with
+ * @return bool: If there was a checker move
  */
-void VoiceRecognition_GetInput(String &parsed_checker_move, bool connection, String input_data) {
-  String checker_move = "";
-  String input_reading = input_data;
+bool VoiceRecognition_GetInput(Move &checker_move, unsigned long now, bool connection, bool irq, String input_data) {
+  /* Collect the reply to the read request once the module raises IRQ, pulling all of its packets into the RX FIFO at once */
+  if (voice_rx_pending) {
+    if (voice_irq_flag) {
+      voice_irq_flag = false;
+      voice_rx_pending = !BlePollRxMock(irq, input_data);
+    }
+
+    /* Ask again if the reply never came, checking the IRQ line in case the edge was missed */
+    if (voice_rx_pending && now - voice_rx_request_time >= VOICE_RX_TIMEOUT) {
+      BlePollRxMock(irq, input_data);
+      voice_rx_pending = false;
+    }
+  }
+
+  /* Parse whatever is in the RX FIFO, which needs no SPI transfer */
+  int length;
+  voice_rx_time = micros();
+  while ((length = BleReadBufferedMock(voice_rx_buffer, VOICE_RX_BUFFER_SIZE)) > 0) {
+    /* Receiving data means there is a connection */
+    voice_connected = true;
+    VoiceRecognition_ParseBytes(voice_rx_buffer, length);
+  }
+
+  if (!voice_rx_pending) {
+    /* A new battery level is only sent with no read request waiting, since the reply to the AT command would be mixed into the reply to the read */
+    if (voice_battery_level >= 0) {
+      if (voice_battery_enabled) {
+        BleBatteryUpdateMock(voice_battery_level);
+      }
+      voice_battery_level = -1;
+    }
+
+    /* Refresh the cached connection state every so often instead of on every call, since it is a full AT command round trip */
+    if (now - voice_connection_check_time >= VOICE_CONNECTION_CHECK_TIME) {
+      voice_connected = BleIsConnectedMock(connection);
+      voice_connection_check_time = now;
+    }
 
-  /* Check for data if BLE is connected */
-  if (BleIsConnectedMock(connection)) {
-    while (BleAvailableMock(input_reading)) {
-      /* Read and process incoming data */
-      char received_data = BleReadMock(input_reading);
-      checker_move += received_data;
+    /* Ask for the next data, only while there is a connection to receive it from */
+    if (voice_connected && BleRequestRxMock()) {
+      voice_rx_pending = true;
+      voice_rx_request_time = now;
     }
   }
 
-  VoiceRecognition_ParseMoves(checker_move, parsed_checker_move);
+  if (voice_moves.available() == 0) {
+    return false;
+  }
+
+  checker_move = voice_moves.pop();
+  voice_input_time = voice_move_times.pop();
+  return true;
+}
+
+/**
+ * Queues the battery level to be sent to the app over the BLE battery service
+ *
+ * @param percent: The battery level from 0 to 100%
+ * @note Sent by the next VoiceRecognition_GetInput call that has no read request waiting, only call from the core polling voice input
+ */
+void VoiceRecognition_SetBatteryLevel(int percent) {
+  voice_battery_level = percent;
+}
+
+/**
+ * Retrieves when the move last returned by VoiceRecognition_GetInput arrived
+ *
+ * @return unsigned long: The micros() time its bytes were read off the BLE module
+ */
+unsigned long VoiceRecognition_GetInputTime() {
+  return voice_input_time;
 }
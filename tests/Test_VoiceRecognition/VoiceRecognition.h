@@ -6,10 +6,53 @@
 #ifndef VOICERECOGNITION_H
 #define VOICERECOGNITION_H
 
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Move.h"
+
 /**********************************
  ** Third Party Libraries Includes
  **********************************/
 #include "Arduino.h"
+#include "circular_queue/circular_queue.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define VOICE_MOVE_QUEUE_SIZE (4) /* The number of parsed moves that can wait to be taken */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The parser states, a command looks like "A1 B2" and ends with a newline, semicolon or space */
+enum VoiceParseState {
+  VOICE_PARSE_FROM_ROW, /* Waiting for the row letter of the square to move from */
+  VOICE_PARSE_FROM_COL, /* Waiting for the column number of the square to move from */
+  VOICE_PARSE_GAP,      /* Waiting for the space between the two squares */
+  VOICE_PARSE_TO_ROW,   /* Waiting for the row letter of the square to move to */
+  VOICE_PARSE_TO_COL,   /* Waiting for the column number of the square to move to */
+  VOICE_PARSE_END,      /* A move was just parsed, waiting for the space or end after it */
+  VOICE_PARSE_DISCARD   /* Skipping a malformed command until the next newline or semicolon */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* All parser state is made visible so tests can directly check these values */
+extern VoiceParseState                      voice_parse_state;
+extern circular_queue<Move>                 voice_moves;
+extern circular_queue<unsigned long>        voice_move_times;
+extern volatile bool                        voice_irq_flag;
+extern bool                                 voice_rx_pending;
+extern bool                                 voice_connected;
+extern unsigned long                        voice_connection_check_time;
+extern String                               ble_rx_fifo_mock;
+extern int                                  ble_request_counter;
+extern bool                                 voice_battery_enabled;
+extern int                                  voice_battery_level;
+extern int                                  ble_battery_counter;
+extern int                                  ble_battery_mock;
 
 /**********************************
  ** Function Prototypes
@@ -17,11 +60,17 @@
 /* Helper function to print (store for testing) string to output */
 void VoiceRecognition_OutputError(String error, String &recent_error);
 
-/* Helper function to parse moves into the correct format from received data */
-void VoiceRecognition_ParseMoves(String moves, String &result);
+/* Helper function for the BLE IRQ line */
+void VoiceRecognition_IrqHandler();
+
+/* Helper functions to parse moves from received data */
+void VoiceRecognition_ParseByte(char received_data);
+void VoiceRecognition_ParseBytes(const char *received_data, int length);
 
 /* Public functions in the source */
 void VoiceRecognition_Init(bool &correct_functions_called, String &recent_error, int baud_rate, bool verbose_mode, bool factory_reset_en, bool factory_reset, bool echo, bool data);
-void VoiceRecognition_GetInput(String &parsed_checker_move, bool connection, String input_data);
+bool VoiceRecognition_GetInput(Move &checker_move, unsigned long now, bool connection, bool irq, String input_data);
+unsigned long VoiceRecognition_GetInputTime();
+void          VoiceRecognition_SetBatteryLevel(int percent);
 
 #endif /* VOICERECOGNITION_H */
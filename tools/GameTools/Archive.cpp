@@ -0,0 +1,573 @@
+/************************************************************
+ * @file Archive.cpp
+ * @brief The implementation for the binary game archive, which stores each move as its index in the list of legal moves
+ *
+ * @note The range coder is a carryless one (Subbotin's), which keeps the coder to 32-bit integers at the cost of a
+ *       fraction of a bit at each renormalisation that would otherwise carry
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Archive.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <string.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define ARCHIVE_CODER_TOP   (1UL << 24) /* A byte is shifted out once the top byte of the range can no longer change */
+#define ARCHIVE_CODER_BOT   (1UL << 16) /* The smallest range, so the largest total a symbol can be coded against */
+#define ARCHIVE_MODEL_STEP  (24)        /* How much each index seen adds to its frequency */
+#define ARCHIVE_MODEL_LIMIT (1UL << 13) /* A model's frequencies are halved once their total passes this, so it keeps adapting */
+#define ARCHIVE_RESULTS     (4)         /* The number of results, from RULES_RESULT_NONE to RULES_RESULT_DRAW */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+void     Archive_EncoderReset(ArchiveCoder &coder, std::vector<uint8_t> &bytes);
+void     Archive_Encode(ArchiveCoder &coder, uint32_t cumulative, uint32_t frequency, uint32_t total);
+void     Archive_EncoderFlush(ArchiveCoder &coder);
+void     Archive_DecoderReset(ArchiveCoder &coder, std::vector<uint8_t> &bytes);
+uint32_t Archive_DecodeFrequency(ArchiveCoder &coder, uint32_t total);
+void     Archive_Decode(ArchiveCoder &coder, uint32_t cumulative, uint32_t frequency);
+uint32_t Archive_DecodeUniform(ArchiveCoder &coder, uint32_t total);
+void     Archive_ModelReset(ArchiveModel &model);
+void     Archive_ModelUpdate(ArchiveModel &model, int count, int index);
+void     Archive_EncodeIndex(ArchiveCoder &coder, ArchiveModel &model, int index, int count);
+int      Archive_DecodeIndex(ArchiveCoder &coder, ArchiveModel &model, int count);
+bool     Archive_FlushChunk(ArchiveWriter &writer);
+bool     Archive_LoadChunk(ArchiveReader &reader, uint32_t chunk);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Starts coding a new stream of bytes
+ *
+ * @param coder: The coder
+ * @param bytes: Where the coded bytes go
+ */
+void Archive_EncoderReset(ArchiveCoder &coder, std::vector<uint8_t> &bytes) {
+  coder.low = 0;
+  coder.range = 0xFFFFFFFF;
+  coder.code = 0;
+  coder.bytes = &bytes;
+  coder.position = 0;
+  bytes.clear();
+}
+
+/**
+ * Codes a symbol
+ *
+ * @param coder: The coder
+ * @param cumulative: The total frequency of the symbols before it
+ * @param frequency: The frequency of the symbol
+ * @param total: The total frequency of every symbol (at most ARCHIVE_CODER_BOT)
+ */
+void Archive_Encode(ArchiveCoder &coder, uint32_t cumulative, uint32_t frequency, uint32_t total) {
+  coder.range /= total;
+  coder.low += cumulative * coder.range;
+  coder.range *= frequency;
+
+  /* Shifts out the top byte once it is settled, or shrinks a range too small to code the next symbol so it is */
+  while ((coder.low ^ (coder.low + coder.range)) < ARCHIVE_CODER_TOP ||
+         (coder.range < ARCHIVE_CODER_BOT && ((coder.range = (0 - coder.low) & (ARCHIVE_CODER_BOT - 1)), true))) {
+    coder.bytes->push_back((uint8_t)(coder.low >> 24));
+    coder.low <<= 8;
+    coder.range <<= 8;
+  }
+}
+
+/**
+ * Shifts out the rest of the coded bytes
+ *
+ * @param coder: The coder
+ */
+void Archive_EncoderFlush(ArchiveCoder &coder) {
+  for (int i = 0; i < 4; i++) {
+    coder.bytes->push_back((uint8_t)(coder.low >> 24));
+    coder.low <<= 8;
+  }
+}
+
+/**
+ * Starts decoding a stream of bytes
+ *
+ * @param coder: The coder
+ * @param bytes: The coded bytes
+ */
+void Archive_DecoderReset(ArchiveCoder &coder, std::vector<uint8_t> &bytes) {
+  coder.low = 0;
+  coder.range = 0xFFFFFFFF;
+  coder.code = 0;
+  coder.bytes = &bytes;
+  coder.position = 0;
+  for (int i = 0; i < 4; i++) {
+    coder.code = (coder.code << 8) | ((coder.position < bytes.size()) ? bytes[coder.position++] : 0);
+  }
+}
+
+/**
+ * Finds where the next symbol falls in its total frequency, which Archive_Decode must follow
+ *
+ * @param coder: The coder
+ * @param total: The total frequency of every symbol
+ * @return uint32_t: A frequency that falls in the symbol's range
+ */
+uint32_t Archive_DecodeFrequency(ArchiveCoder &coder, uint32_t total) {
+  coder.range /= total;
+  uint32_t frequency = (coder.code - coder.low) / coder.range;
+
+  /* Only a damaged archive can land past the end */
+  return (frequency < total) ? frequency : total - 1;
+}
+
+/**
+ * Removes a decoded symbol from the stream
+ *
+ * @param coder: The coder
+ * @param cumulative: The total frequency of the symbols before it
+ * @param frequency: The frequency of the symbol
+ */
+void Archive_Decode(ArchiveCoder &coder, uint32_t cumulative, uint32_t frequency) {
+  coder.low += cumulative * coder.range;
+  coder.range *= frequency;
+
+  while ((coder.low ^ (coder.low + coder.range)) < ARCHIVE_CODER_TOP ||
+         (coder.range < ARCHIVE_CODER_BOT && ((coder.range = (0 - coder.low) & (ARCHIVE_CODER_BOT - 1)), true))) {
+    uint8_t next = (coder.position < coder.bytes->size()) ? (*coder.bytes)[coder.position++] : 0;
+    coder.code = (coder.code << 8) | next;
+    coder.low <<= 8;
+    coder.range <<= 8;
+  }
+}
+
+/**
+ * Decodes a symbol coded with every value equally likely
+ *
+ * @param coder: The coder
+ * @param total: The number of values
+ * @return uint32_t: The value
+ */
+uint32_t Archive_DecodeUniform(ArchiveCoder &coder, uint32_t total) {
+  uint32_t value = Archive_DecodeFrequency(coder, total);
+  Archive_Decode(coder, value, 1);
+  return value;
+}
+
+/**
+ * Starts every model over with each index equally likely
+ *
+ * @param model: The models
+ */
+void Archive_ModelReset(ArchiveModel &model) {
+  for (int i = 0; i < ARCHIVE_MODEL_SIZE; i++) {
+    model.frequencies[i] = 1;
+  }
+  for (int count = 0; count <= ARCHIVE_MODEL_MAX; count++) {
+    model.totals[count] = count;
+  }
+}
+
+/**
+ * Makes an index more likely in the model for its number of legal moves
+ *
+ * @param model: The models
+ * @param count: The number of legal moves
+ * @param index: The index seen
+ */
+void Archive_ModelUpdate(ArchiveModel &model, int count, int index) {
+  uint16_t *frequencies = &model.frequencies[count * (count - 1) / 2];
+  frequencies[index] += ARCHIVE_MODEL_STEP;
+  model.totals[count] += ARCHIVE_MODEL_STEP;
+
+  if (model.totals[count] > ARCHIVE_MODEL_LIMIT) {
+    model.totals[count] = 0;
+    for (int i = 0; i < count; i++) {
+      frequencies[i] = (frequencies[i] + 1) / 2;
+      model.totals[count] += frequencies[i];
+    }
+  }
+}
+
+/**
+ * Codes a move's index in its list of legal moves, which takes no bytes at all when the move is forced
+ *
+ * @param coder: The coder
+ * @param model: The models
+ * @param index: The index of the move
+ * @param count: The number of legal moves
+ */
+void Archive_EncodeIndex(ArchiveCoder &coder, ArchiveModel &model, int index, int count) {
+  if (count <= 1) {
+    return;
+  }
+  if (count > ARCHIVE_MODEL_MAX) {
+    Archive_Encode(coder, index, 1, count);
+    return;
+  }
+
+  const uint16_t *frequencies = &model.frequencies[count * (count - 1) / 2];
+  uint32_t cumulative = 0;
+  for (int i = 0; i < index; i++) {
+    cumulative += frequencies[i];
+  }
+  Archive_Encode(coder, cumulative, frequencies[index], model.totals[count]);
+  Archive_ModelUpdate(model, count, index);
+}
+
+/**
+ * Decodes a move's index in its list of legal moves
+ *
+ * @param coder: The coder
+ * @param model: The models
+ * @param count: The number of legal moves
+ * @return int: The index of the move
+ */
+int Archive_DecodeIndex(ArchiveCoder &coder, ArchiveModel &model, int count) {
+  if (count <= 1) {
+    return 0;
+  }
+  if (count > ARCHIVE_MODEL_MAX) {
+    return Archive_DecodeUniform(coder, count);
+  }
+
+  const uint16_t *frequencies = &model.frequencies[count * (count - 1) / 2];
+  uint32_t target = Archive_DecodeFrequency(coder, model.totals[count]);
+  uint32_t cumulative = 0;
+  int index = 0;
+  while (index < count - 1 && cumulative + frequencies[index] <= target) {
+    cumulative += frequencies[index];
+    index++;
+  }
+  Archive_Decode(coder, cumulative, frequencies[index]);
+  Archive_ModelUpdate(model, count, index);
+  return index;
+}
+
+/**
+ * Sets up the position a game starts from
+ *
+ * @param game: The game
+ * @param start: The position, a new game unless the game was set up
+ */
+void Archive_StartGame(const ArchiveGame &game, Checkers &start) {
+  start = Checkers();
+  if (game.has_start) {
+    start.Checkers_Load(game.start);
+  }
+}
+
+/**
+ * Creates an archive, replacing any file already at the path
+ *
+ * @param writer: The writer
+ * @param path: The path of the file
+ * @param chunk_games: The games in each chunk (0 for ARCHIVE_CHUNK_GAMES)
+ * @return bool: If the file was created
+ */
+bool Archive_Create(ArchiveWriter &writer, const char *path, uint32_t chunk_games) {
+  memset(&writer.header, 0, sizeof(writer.header));
+  writer.header.magic = ARCHIVE_MAGIC;
+  writer.header.version = ARCHIVE_VERSION;
+  writer.header.chunk_games = (chunk_games == 0) ? ARCHIVE_CHUNK_GAMES : chunk_games;
+  writer.chunks.clear();
+
+  writer.file = fopen(path, "wb");
+  if (writer.file == NULL) {
+    return false;
+  }
+
+  /* The header is written again with the counts once the archive is closed */
+  memset(&writer.chunk, 0, sizeof(writer.chunk));
+  writer.chunk.offset = sizeof(writer.header);
+  Archive_EncoderReset(writer.coder, writer.bytes);
+  Archive_ModelReset(writer.model);
+  return fwrite(&writer.header, sizeof(writer.header), 1, writer.file) == 1;
+}
+
+/**
+ * Writes the chunk being coded to the file and starts the next one
+ *
+ * @param writer: The writer
+ * @return bool: If the chunk was written
+ */
+bool Archive_FlushChunk(ArchiveWriter &writer) {
+  if (writer.chunk.game_count == 0) {
+    return true;
+  }
+
+  Archive_EncoderFlush(writer.coder);
+  writer.chunk.size = writer.bytes.size();
+  if (fwrite(writer.bytes.data(), 1, writer.bytes.size(), writer.file) != writer.bytes.size()) {
+    return false;
+  }
+  writer.chunks.push_back(writer.chunk);
+
+  /* Each chunk starts its models over, so it can be read without the ones before it */
+  writer.chunk.offset += writer.chunk.size;
+  writer.chunk.first_game += writer.chunk.game_count;
+  writer.chunk.size = 0;
+  writer.chunk.game_count = 0;
+  writer.chunk.ply_count = 0;
+  Archive_EncoderReset(writer.coder, writer.bytes);
+  Archive_ModelReset(writer.model);
+  return true;
+}
+
+/**
+ * Finds each move of a game in its list of legal moves, which is all the archive stores of it
+ *
+ * @param game: The game
+ * @param indexes: The index of each move in its list
+ * @param counts: The number of legal moves at each move
+ * @return bool: If every move is legal, a game with a move Checkers_Turn rejects or a bad set up position is not
+ * @note Only reads the game, so games can be indexed on many threads and written in order on one
+ */
+bool Archive_IndexGame(const ArchiveGame &game, uint8_t *indexes, uint8_t *counts) {
+  Checkers replay;
+  Move moves[RULES_MAX_MOVES];
+
+  if (game.ply_count < 0 || game.ply_count > ARCHIVE_MAX_PLIES || game.result < RULES_RESULT_NONE || game.result > RULES_RESULT_DRAW ||
+      (game.has_start && !replay.Checkers_Load(game.start))) {
+    return false;
+  }
+
+  for (int i = 0; i < game.ply_count; i++) {
+    int move_count = Rules_GetLegalMoves(replay, moves);
+    int index = Rules_FindMove(moves, move_count, game.plies[i]);
+    if (index < 0) {
+      return false;
+    }
+    indexes[i] = (uint8_t)index;
+    counts[i] = (uint8_t)move_count;
+    replay.Checkers_Turn(game.plies[i]);
+  }
+  return true;
+}
+
+/**
+ * Writes a game to the end of an archive
+ *
+ * @param writer: The writer
+ * @param game: The game
+ * @return bool: If the game was written, a game with a move Checkers_Turn rejects or a bad set up position is not
+ */
+bool Archive_WriteGame(ArchiveWriter &writer, const ArchiveGame &game) {
+  /* Every move is found in its list of legal moves before anything is coded, so a bad game leaves the chunk as it was */
+  return Archive_IndexGame(game, writer.indexes, writer.counts) && Archive_WriteIndexedGame(writer, game, writer.indexes, writer.counts);
+}
+
+/**
+ * Writes a game that Archive_IndexGame has already found the moves of to the end of an archive
+ *
+ * @param writer: The writer
+ * @param game: The game
+ * @param indexes: The index of each move in its list of legal moves
+ * @param counts: The number of legal moves at each move
+ * @return bool: If the game was written
+ */
+bool Archive_WriteIndexedGame(ArchiveWriter &writer, const ArchiveGame &game, const uint8_t *indexes, const uint8_t *counts) {
+  Checkers replay;
+  CheckersSnapshot start;
+
+  /* The set up position is written as Checkers_Save packs it, the same bytes a reader's Checkers_Load gets back */
+  Archive_StartGame(game, replay);
+  replay.Checkers_Save(start);
+
+  Archive_Encode(writer.coder, game.has_start ? 1 : 0, 1, 2);
+  if (game.has_start) {
+    const uint8_t *bytes = (const uint8_t *)&start;
+    for (unsigned int i = 0; i < sizeof(start); i++) {
+      Archive_Encode(writer.coder, bytes[i], 1, 256);
+    }
+  }
+  Archive_Encode(writer.coder, game.result, 1, ARCHIVE_RESULTS);
+  Archive_Encode(writer.coder, game.ply_count, 1, ARCHIVE_MAX_PLIES + 1);
+  for (int i = 0; i < game.ply_count; i++) {
+    Archive_EncodeIndex(writer.coder, writer.model, indexes[i], counts[i]);
+  }
+
+  writer.chunk.game_count++;
+  writer.chunk.ply_count += game.ply_count;
+  writer.header.game_count++;
+  writer.header.ply_count += game.ply_count;
+  if (writer.chunk.game_count >= writer.header.chunk_games) {
+    return Archive_FlushChunk(writer);
+  }
+  return true;
+}
+
+/**
+ * Writes the last chunk, the chunk index and the finished header, and closes the file
+ *
+ * @param writer: The writer
+ * @return bool: If everything was written
+ */
+bool Archive_Close(ArchiveWriter &writer) {
+  bool written = Archive_FlushChunk(writer);
+
+  writer.header.chunk_count = writer.chunks.size();
+  writer.header.index_offset = writer.chunk.offset;
+  if (!writer.chunks.empty()) {
+    written = written && fwrite(writer.chunks.data(), sizeof(ArchiveChunk), writer.chunks.size(), writer.file) == writer.chunks.size();
+  }
+  written = written && fseek(writer.file, 0, SEEK_SET) == 0 && fwrite(&writer.header, sizeof(writer.header), 1, writer.file) == 1;
+  written = (fclose(writer.file) == 0) && written;
+  writer.file = NULL;
+  return written;
+}
+
+/**
+ * Opens an archive and reads its chunk index, ready to read the first game
+ *
+ * @param reader: The reader
+ * @param path: The path of the file
+ * @return bool: If the file is an archive this version can read
+ */
+bool Archive_Open(ArchiveReader &reader, const char *path) {
+  reader.file = fopen(path, "rb");
+  if (reader.file == NULL) {
+    return false;
+  }
+
+  if (fread(&reader.header, sizeof(reader.header), 1, reader.file) != 1 || reader.header.magic != ARCHIVE_MAGIC ||
+      reader.header.version != ARCHIVE_VERSION) {
+    Archive_CloseReader(reader);
+    return false;
+  }
+
+  reader.chunks.resize(reader.header.chunk_count);
+  if (reader.header.chunk_count > 0 &&
+      (fseek(reader.file, reader.header.index_offset, SEEK_SET) != 0 ||
+       fread(reader.chunks.data(), sizeof(ArchiveChunk), reader.chunks.size(), reader.file) != reader.chunks.size())) {
+    Archive_CloseReader(reader);
+    return false;
+  }
+
+  reader.chunk = 0;
+  reader.games_left = 0;
+  reader.next_game = 0;
+  return reader.header.chunk_count == 0 || Archive_LoadChunk(reader, 0);
+}
+
+/**
+ * Reads a chunk into memory and starts decoding it
+ *
+ * @param reader: The reader
+ * @param chunk: The chunk
+ * @return bool: If the chunk was read
+ */
+bool Archive_LoadChunk(ArchiveReader &reader, uint32_t chunk) {
+  const ArchiveChunk &entry = reader.chunks[chunk];
+  reader.bytes.resize(entry.size);
+  if (fseek(reader.file, entry.offset, SEEK_SET) != 0 || fread(reader.bytes.data(), 1, entry.size, reader.file) != entry.size) {
+    return false;
+  }
+
+  reader.chunk = chunk;
+  reader.games_left = entry.game_count;
+  reader.next_game = entry.first_game;
+  Archive_DecoderReset(reader.coder, reader.bytes);
+  Archive_ModelReset(reader.model);
+  return true;
+}
+
+/**
+ * Moves to a game, so it is the next one read, decoding only the games before it in its chunk
+ *
+ * @param reader: The reader
+ * @param game_id: The number of the game
+ * @return bool: If the archive has the game
+ */
+bool Archive_Seek(ArchiveReader &reader, uint64_t game_id) {
+  if (game_id >= reader.header.game_count) {
+    return false;
+  }
+
+  /* Finds the last chunk starting at or before the game */
+  uint32_t low = 0;
+  uint32_t high = reader.header.chunk_count;
+  while (high - low > 1) {
+    uint32_t middle = (low + high) / 2;
+    if (reader.chunks[middle].first_game <= game_id) {
+      low = middle;
+    }
+    else {
+      high = middle;
+    }
+  }
+
+  if ((reader.chunk != low || reader.next_game > game_id) && !Archive_LoadChunk(reader, low)) {
+    return false;
+  }
+
+  ArchiveGame skipped;
+  bool found = true;
+  while (found && reader.next_game < game_id) {
+    found = Archive_ReadGame(reader, skipped);
+  }
+  return found;
+}
+
+/**
+ * Reads the next game, replaying it through Checkers_Turn to turn each index back into its move
+ *
+ * @param reader: The reader
+ * @param game: The game read
+ * @return bool: If there was another game, a damaged archive is caught by the replay and ends the read
+ */
+bool Archive_ReadGame(ArchiveReader &reader, ArchiveGame &game) {
+  Checkers replay;
+  Move moves[RULES_MAX_MOVES];
+
+  if (reader.games_left == 0) {
+    if (reader.chunk + 1 >= reader.header.chunk_count || !Archive_LoadChunk(reader, reader.chunk + 1)) {
+      return false;
+    }
+  }
+
+  game.id = reader.next_game;
+  game.has_start = Archive_DecodeUniform(reader.coder, 2) != 0;
+  if (game.has_start) {
+    uint8_t *bytes = (uint8_t *)&game.start;
+    for (unsigned int i = 0; i < sizeof(game.start); i++) {
+      bytes[i] = (uint8_t)Archive_DecodeUniform(reader.coder, 256);
+    }
+  }
+  game.result = Archive_DecodeUniform(reader.coder, ARCHIVE_RESULTS);
+  game.ply_count = Archive_DecodeUniform(reader.coder, ARCHIVE_MAX_PLIES + 1);
+
+  if (game.has_start && !replay.Checkers_Load(game.start)) {
+    return false;
+  }
+  for (int i = 0; i < game.ply_count; i++) {
+    int move_count = Rules_GetLegalMoves(replay, moves);
+    if (move_count == 0) {
+      return false;
+    }
+    game.plies[i] = moves[Archive_DecodeIndex(reader.coder, reader.model, move_count)];
+    replay.Checkers_Turn(game.plies[i]);
+  }
+
+  reader.games_left--;
+  reader.next_game++;
+  return true;
+}
+
+/**
+ * Closes an archive
+ *
+ * @param reader: The reader
+ */
+void Archive_CloseReader(ArchiveReader &reader) {
+  if (reader.file != NULL) {
+    fclose(reader.file);
+    reader.file = NULL;
+  }
+}
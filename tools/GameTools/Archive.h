@@ -0,0 +1,130 @@
+/************************************************************
+ * @file Archive.h
+ * @brief The header for the binary game archive, which stores each move as its index in the list of legal moves
+ *
+ * @note An archive is a header, then chunks of games, then an index of the chunks. Each chunk is range coded on its own,
+ *       with the move indexes modelled by how many legal moves there were, so a chunk can be read without the ones
+ *       before it. Every game is replayed through Checkers_Turn when it is written and read, so an archive only ever
+ *       holds legal games. The numbers in the header and index are little-endian, the same as every host it runs on.
+ ************************************************************/
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define ARCHIVE_MAGIC       (0x52414B43UL) /* "CKAR" at the start of the file */
+#define ARCHIVE_VERSION     (1)            /* The version of the format written */
+#define ARCHIVE_MAX_PLIES   (1024)         /* The most moves (Checkers_Turn calls) a game can have */
+#define ARCHIVE_CHUNK_GAMES (256)          /* The games in each chunk unless asked for otherwise, the most read to reach one game */
+#define ARCHIVE_MODEL_MAX   (32)           /* Move counts up to this get an adaptive model, the rare larger ones are coded evenly */
+#define ARCHIVE_MODEL_SIZE  (ARCHIVE_MODEL_MAX * (ARCHIVE_MODEL_MAX + 1) / 2) /* The frequencies in every model together */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A game, as written to and read from an archive */
+struct ArchiveGame {
+  uint64_t         id;                       /* The game's number in the archive, counting from 0 (set when read) */
+  bool             has_start;                /* Indicator for if the game starts from a set up position instead of a new game */
+  CheckersSnapshot start;                    /* The set up position, if there is one */
+  int              result;                   /* RULES_RESULT_NONE, the winning player or RULES_RESULT_DRAW */
+  int              ply_count;                /* The number of moves */
+  Move             plies[ARCHIVE_MAX_PLIES]; /* The moves, one per Checkers_Turn call */
+};
+
+/* The start of the file */
+struct ArchiveHeader {
+  uint32_t magic;        /* ARCHIVE_MAGIC */
+  uint16_t version;      /* ARCHIVE_VERSION */
+  uint16_t reserved;     /* Unused, left at 0 */
+  uint32_t chunk_games;  /* The games in each chunk but the last */
+  uint32_t chunk_count;  /* The number of chunks */
+  uint64_t game_count;   /* The number of games */
+  uint64_t ply_count;    /* The number of moves in every game */
+  uint64_t index_offset; /* Where the chunk index starts in the file */
+};
+
+/* An entry in the chunk index */
+struct ArchiveChunk {
+  uint64_t offset;     /* Where the chunk starts in the file */
+  uint64_t first_game; /* The number of the chunk's first game */
+  uint32_t size;       /* The bytes in the chunk */
+  uint32_t game_count; /* The number of games in the chunk */
+  uint64_t ply_count;  /* The number of moves in the chunk's games */
+};
+
+/* The state of the range coder */
+struct ArchiveCoder {
+  uint32_t              low;      /* The bottom of the range */
+  uint32_t              range;    /* The size of the range */
+  uint32_t              code;     /* The bytes being decoded */
+  std::vector<uint8_t> *bytes;    /* The bytes coded so far, or being decoded */
+  size_t                position; /* The next byte to decode */
+};
+
+/* The adaptive models of the move indexes, one per number of legal moves */
+struct ArchiveModel {
+  uint16_t frequencies[ARCHIVE_MODEL_SIZE]; /* How often each index was seen, the model for n moves starts at n * (n - 1) / 2 */
+  uint32_t totals[ARCHIVE_MODEL_MAX + 1];   /* The sum of each model's frequencies */
+};
+
+/* An archive being written, one game at a time */
+struct ArchiveWriter {
+  FILE                     *file;                       /* The archive file */
+  ArchiveHeader             header;                     /* The header, written again once the archive is closed */
+  std::vector<ArchiveChunk> chunks;                     /* The index of the chunks written */
+  ArchiveChunk              chunk;                      /* The chunk being coded */
+  std::vector<uint8_t>      bytes;                      /* The coded bytes of the chunk */
+  ArchiveCoder              coder;                      /* The range coder of the chunk */
+  ArchiveModel              model;                      /* The models of the chunk */
+  uint8_t                   indexes[ARCHIVE_MAX_PLIES]; /* The move indexes of the game being written */
+  uint8_t                   counts[ARCHIVE_MAX_PLIES];  /* The number of legal moves at each move of the game being written */
+};
+
+/* An archive being read, one game at a time from any game onwards */
+struct ArchiveReader {
+  FILE                     *file;       /* The archive file */
+  ArchiveHeader             header;     /* The header */
+  std::vector<ArchiveChunk> chunks;     /* The index of the chunks */
+  uint32_t                  chunk;      /* The chunk being decoded */
+  uint32_t                  games_left; /* The games left to decode in the chunk */
+  uint64_t                  next_game;  /* The number of the next game read */
+  std::vector<uint8_t>      bytes;      /* The coded bytes of the chunk */
+  ArchiveCoder              coder;      /* The range coder of the chunk */
+  ArchiveModel              model;      /* The models of the chunk */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Writing functions */
+bool Archive_Create(ArchiveWriter &writer, const char *path, uint32_t chunk_games);
+bool Archive_IndexGame(const ArchiveGame &game, uint8_t *indexes, uint8_t *counts);
+bool Archive_WriteGame(ArchiveWriter &writer, const ArchiveGame &game);
+bool Archive_WriteIndexedGame(ArchiveWriter &writer, const ArchiveGame &game, const uint8_t *indexes, const uint8_t *counts);
+bool Archive_Close(ArchiveWriter &writer);
+
+/* Reading functions */
+bool Archive_Open(ArchiveReader &reader, const char *path);
+bool Archive_Seek(ArchiveReader &reader, uint64_t game_id);
+bool Archive_ReadGame(ArchiveReader &reader, ArchiveGame &game);
+void Archive_CloseReader(ArchiveReader &reader);
+
+/* Game functions */
+void Archive_StartGame(const ArchiveGame &game, Checkers &start);
+
+#endif /* ARCHIVE_H */
@@ -0,0 +1,530 @@
+/************************************************************
+ * @file Batch.cpp
+ * @brief The implementation for the batch engine, which steps many independent games at once for bulk simulation
+ *
+ * @note The kernel is written once as a template over the type holding the games' words: uint32_t for the scalar
+ *       fallback, or a GCC vector of them, which the compiler turns into AVX2 or NEON instructions. Every step is a
+ *       bitboard shift, mask or compare, with no branch on a game's state, so the games of a vector never diverge.
+ *       A neighbouring square is 4 bits on with 1 more or less depending on the row, so each diagonal shift is two
+ *       shifts masked by row and column.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Batch.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <string.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define BATCH_EVEN_ROWS  (0x0F0F0F0FU) /* The squares on rows 0, 2, 4 and 6 */
+#define BATCH_ODD_ROWS   (0xF0F0F0F0U) /* The squares on rows 1, 3, 5 and 7 */
+#define BATCH_LEFT       (0x11111111U) /* The first square of each row */
+#define BATCH_RIGHT      (0x88888888U) /* The last square of each row */
+#define BATCH_ROW_0      (0x0000000FU) /* The squares player 1's men are crowned on */
+#define BATCH_ROW_7      (0xF0000000U) /* The squares player 2's men are crowned on */
+#define BATCH_P1_START   (0xFFF00000U) /* Player 1's men in a new game, rows 5 to 7 */
+#define BATCH_P2_START   (0x00000FFFU) /* Player 2's men in a new game, rows 0 to 2 */
+
+/* The vector the build can use, 0 lanes if it has none */
+#if defined(__AVX2__)
+typedef uint32_t BatchVector __attribute__((vector_size(32)));
+#define BATCH_SIMD_LANES (8)
+#define BATCH_SIMD_NAME  "AVX2"
+#elif defined(__ARM_NEON)
+typedef uint32_t BatchVector __attribute__((vector_size(16)));
+#define BATCH_SIMD_LANES (4)
+#define BATCH_SIMD_NAME  "NEON"
+#else
+#define BATCH_SIMD_LANES (0)
+#define BATCH_SIMD_NAME  "none"
+#endif
+#define BATCH_PADDING (8) /* The games the arrays are padded to a multiple of, the most lanes of any vector */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+inline uint32_t Batch_IsZero(uint32_t bits);
+inline uint32_t Batch_Count(uint32_t bits);
+inline int      Batch_Lowest(uint32_t bits);
+Square          Batch_GetSquare(int bit);
+int             Batch_GetBit(Square square);
+template <typename V> inline V    Batch_Select(V mask, V chosen, V other);
+template <typename V> inline V    Batch_Shift(V bits, int direction);
+template <typename V> inline void Batch_FindMovers(V up, V down, V opponent, V empty, V (&movers)[BATCH_DIRECTIONS]);
+template <typename V> inline V    Batch_LoadWords(const std::vector<uint32_t> &array, size_t first);
+template <typename V> inline void Batch_StoreWords(std::vector<uint32_t> &array, size_t first, V value);
+template <typename V> void        Batch_GenerateGames(BatchGames &batch, size_t first);
+template <typename V> void        Batch_PlayGames(BatchGames &batch, size_t first);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Makes a mask of a word being 0
+ *
+ * @param bits: The word
+ * @return uint32_t: All ones if it is 0, or else 0
+ */
+inline uint32_t Batch_IsZero(uint32_t bits) {
+  return (bits == 0) ? 0xFFFFFFFFUL : 0;
+}
+
+#if BATCH_SIMD_LANES > 0
+/**
+ * Makes a mask of each word of a vector being 0
+ *
+ * @param bits: The words
+ * @return BatchVector: All ones in each word that is 0, or else 0
+ */
+inline BatchVector Batch_IsZero(BatchVector bits) {
+  return (BatchVector)(bits == 0);
+}
+#endif
+
+/**
+ * Counts the squares in a bitboard
+ *
+ * @param bits: The bitboard
+ * @return uint32_t: The number of squares
+ */
+inline uint32_t Batch_Count(uint32_t bits) {
+  return (uint32_t)__builtin_popcount(bits);
+}
+
+/**
+ * Finds the first square in a bitboard
+ *
+ * @param bits: The bitboard, not 0
+ * @return int: The bit of the square
+ */
+inline int Batch_Lowest(uint32_t bits) {
+  return __builtin_ctz(bits);
+}
+
+/**
+ * Converts a bit of a bitboard to a board square
+ *
+ * @param bit: The bit, 0 to 31
+ * @return Square: The square
+ */
+Square Batch_GetSquare(int bit) {
+  int row = bit / 4;
+  return Move_MakeSquare(row, (bit % 4) * 2 + row % 2);
+}
+
+/**
+ * Converts a board square to a bit of a bitboard
+ *
+ * @param square: The square
+ * @return int: The bit, or -1 if the square is light or off the board
+ */
+int Batch_GetBit(Square square) {
+  int row = Move_GetRow(square);
+  int col = Move_GetCol(square);
+  return (row < MOVE_BOARD_SIZE && (row + col) % 2 == 0) ? row * 4 + col / 2 : -1;
+}
+
+/**
+ * Picks between two words by a mask
+ *
+ * @param mask: All ones to pick the first, 0 to pick the second
+ * @param chosen: The first word
+ * @param other: The second word
+ * @return V: The word picked
+ */
+template <typename V> inline V Batch_Select(V mask, V chosen, V other) {
+  return (chosen & mask) | (other & ~mask);
+}
+
+/**
+ * Moves every square of a bitboard one step diagonally, dropping the squares that step off the board
+ *
+ * @param bits: The bitboard
+ * @param direction: 0 for up left, 1 up right, 2 down left and 3 down right (up is towards row 0)
+ * @return V: The bitboard stepped
+ */
+template <typename V> inline V Batch_Shift(V bits, int direction) {
+  switch (direction) {
+    case 0:
+      return ((bits & (BATCH_EVEN_ROWS & ~BATCH_LEFT)) >> 5) | ((bits & BATCH_ODD_ROWS) >> 4);
+    case 1:
+      return ((bits & BATCH_EVEN_ROWS) >> 4) | ((bits & (BATCH_ODD_ROWS & ~BATCH_RIGHT)) >> 3);
+    case 2:
+      return ((bits & (BATCH_EVEN_ROWS & ~BATCH_LEFT)) << 3) | ((bits & BATCH_ODD_ROWS) << 4);
+    default:
+      return ((bits & BATCH_EVEN_ROWS) << 4) | ((bits & (BATCH_ODD_ROWS & ~BATCH_RIGHT)) << 5);
+  }
+}
+
+/**
+ * Finds the squares of one side with a move in each direction, whether or not a jump elsewhere rules it out
+ *
+ * @param up: The side's pieces that can move up (all of player 1's, kings of player 2's)
+ * @param down: The side's pieces that can move down
+ * @param opponent: The other side's pieces
+ * @param empty: The empty squares
+ * @param movers: The squares with a move in each direction, the steps then the jumps
+ */
+template <typename V> inline void Batch_FindMovers(V up, V down, V opponent, V empty, V (&movers)[BATCH_DIRECTIONS]) {
+  /* A square steps up left onto an empty square if that square steps down right onto it, and so on */
+  movers[0] = up & Batch_Shift(empty, 3);
+  movers[1] = up & Batch_Shift(empty, 2);
+  movers[2] = down & Batch_Shift(empty, 1);
+  movers[3] = down & Batch_Shift(empty, 0);
+  movers[4] = up & Batch_Shift(opponent & Batch_Shift(empty, 3), 3);
+  movers[5] = up & Batch_Shift(opponent & Batch_Shift(empty, 2), 2);
+  movers[6] = down & Batch_Shift(opponent & Batch_Shift(empty, 1), 1);
+  movers[7] = down & Batch_Shift(opponent & Batch_Shift(empty, 0), 0);
+}
+
+/**
+ * Reads the words of the games a kernel call works on
+ *
+ * @param array: The array
+ * @param first: The first game
+ * @return V: The words
+ */
+template <typename V> inline V Batch_LoadWords(const std::vector<uint32_t> &array, size_t first) {
+  V value;
+  memcpy(&value, &array[first], sizeof(value));
+  return value;
+}
+
+/**
+ * Writes the words of the games a kernel call works on
+ *
+ * @param array: The array
+ * @param first: The first game
+ * @param value: The words
+ */
+template <typename V> inline void Batch_StoreWords(std::vector<uint32_t> &array, size_t first, V value) {
+  memcpy(&array[first], &value, sizeof(value));
+}
+
+/**
+ * Finds the legal moves of the games from the first on, as many as the word type holds
+ *
+ * @param batch: The games
+ * @param first: The first game
+ * @note A jump anywhere rules out every step, and a jump that has to carry on rules out every other piece's jumps
+ */
+template <typename V> void Batch_GenerateGames(BatchGames &batch, size_t first) {
+  V p1 = Batch_LoadWords<V>(batch.p1, first);
+  V p2 = Batch_LoadWords<V>(batch.p2, first);
+  V kings = Batch_LoadWords<V>(batch.kings, first);
+  V turn = Batch_LoadWords<V>(batch.turn, first);
+  V jump = Batch_LoadWords<V>(batch.jump, first);
+  V playing = ~Batch_LoadWords<V>(batch.won, first);
+  V movers[BATCH_DIRECTIONS];
+
+  V own = Batch_Select(turn, p2, p1);
+  V opponent = Batch_Select(turn, p1, p2);
+  Batch_FindMovers(own & (kings | ~turn), own & (kings | turn), opponent, ~(p1 | p2), movers);
+
+  V no_jump = Batch_IsZero(movers[4] | movers[5] | movers[6] | movers[7]);
+  V not_locked = Batch_IsZero(jump);
+  for (int i = 0; i < BATCH_DIRECTIONS; i++) {
+    movers[i] &= playing & ((i < 4) ? no_jump & not_locked : jump | not_locked);
+    Batch_StoreWords(batch.movers[i], first, movers[i]);
+  }
+}
+
+/**
+ * Plays the moves of the games from the first on, as many as the word type holds, each only if it is legal
+ *
+ * @param batch: The games, with their moves in from and to, which are left as all ones for the games it played
+ * @param first: The first game
+ */
+template <typename V> void Batch_PlayGames(BatchGames &batch, size_t first) {
+  V p1 = Batch_LoadWords<V>(batch.p1, first);
+  V p2 = Batch_LoadWords<V>(batch.p2, first);
+  V kings = Batch_LoadWords<V>(batch.kings, first);
+  V turn = Batch_LoadWords<V>(batch.turn, first);
+  V jump = Batch_LoadWords<V>(batch.jump, first);
+  V won = Batch_LoadWords<V>(batch.won, first);
+  V from = Batch_LoadWords<V>(batch.from, first);
+  V to = Batch_LoadWords<V>(batch.to, first);
+
+  /* A move is legal if its square has a legal move in the direction that lands on its target */
+  V played = from & 0;
+  V captured = from & 0;
+  for (int i = 0; i < BATCH_DIRECTIONS; i++) {
+    V step = Batch_Shift(from, i % 4);
+    V landing = (i < 4) ? step : Batch_Shift(step, i % 4);
+    V matched = ~Batch_IsZero(from & Batch_LoadWords<V>(batch.movers[i], first)) & Batch_IsZero(landing ^ to);
+    played |= matched;
+    captured |= (i < 4) ? from & 0 : step & matched;
+  }
+  from &= played;
+  to &= played;
+
+  /* Moves the piece, crowning a man that reaches the far row, and takes the piece jumped */
+  V own = Batch_Select(turn, p2, p1);
+  V opponent = Batch_Select(turn, p1, p2) & ~captured;
+  V was_king = ~Batch_IsZero(kings & from);
+  V far_row = Batch_Select(turn, (from & 0) | BATCH_ROW_7, (from & 0) | BATCH_ROW_0);
+  own = (own & ~from) | to;
+  kings = (kings & ~(from | captured)) | (to & (was_king | far_row));
+  V empty = ~(own | opponent);
+
+  /* The game is won once the other player is left without a move, before any jump carries on */
+  V movers[BATCH_DIRECTIONS];
+  Batch_FindMovers(opponent & (kings | turn), opponent & (kings | ~turn), own, empty, movers);
+  V stuck = Batch_IsZero(movers[0] | movers[1] | movers[2] | movers[3] | movers[4] | movers[5] | movers[6] | movers[7]);
+  V won_now = played & stuck;
+
+  /* A jump carries on if the piece, crowned or not, has another jump from where it landed */
+  Batch_FindMovers(to & (kings | ~turn), to & (kings | turn), opponent, empty, movers);
+  V carries_on = ~Batch_IsZero(captured) & ~Batch_IsZero(movers[4] | movers[5] | movers[6] | movers[7]) & ~won_now;
+
+  Batch_StoreWords(batch.p1, first, Batch_Select(turn, opponent, own));
+  Batch_StoreWords(batch.p2, first, Batch_Select(turn, own, opponent));
+  Batch_StoreWords(batch.kings, first, kings);
+  Batch_StoreWords(batch.jump, first, Batch_Select(played & ~won_now, to & carries_on, jump));
+  Batch_StoreWords(batch.turn, first, turn ^ (played & ~won_now & ~carries_on));
+  Batch_StoreWords(batch.won, first, won | won_now);
+  Batch_StoreWords(batch.from, first, played);
+}
+
+/**
+ * Sets up new games
+ *
+ * @param batch: The games
+ * @param count: The number of games
+ */
+void Batch_Init(BatchGames &batch, size_t count) {
+  size_t padded = (count + BATCH_PADDING - 1) / BATCH_PADDING * BATCH_PADDING;
+  batch.count = count;
+  batch.generated = false;
+
+  /* The padding games are won, so they never have a move */
+  batch.p1.assign(padded, 0);
+  batch.p2.assign(padded, 0);
+  batch.kings.assign(padded, 0);
+  batch.turn.assign(padded, 0);
+  batch.jump.assign(padded, 0);
+  batch.won.assign(padded, 0xFFFFFFFFUL);
+  for (int i = 0; i < BATCH_DIRECTIONS; i++) {
+    batch.movers[i].assign(padded, 0);
+  }
+  batch.from.assign(padded, 0);
+  batch.to.assign(padded, 0);
+
+  for (size_t i = 0; i < count; i++) {
+    Batch_Reset(batch, i);
+  }
+}
+
+/**
+ * Sets a game back to a new game
+ *
+ * @param batch: The games
+ * @param game: The game
+ */
+void Batch_Reset(BatchGames &batch, size_t game) {
+  batch.p1[game] = BATCH_P1_START;
+  batch.p2[game] = BATCH_P2_START;
+  batch.kings[game] = 0;
+  batch.turn[game] = 0;
+  batch.jump[game] = 0;
+  batch.won[game] = 0;
+  batch.generated = false;
+}
+
+/**
+ * Sets a game from a snapshot
+ *
+ * @param batch: The games
+ * @param game: The game
+ * @param snapshot: The snapshot, as from Checkers_Save
+ * @return bool: If the snapshot held a game, the game is left unchanged if not
+ */
+bool Batch_Load(BatchGames &batch, size_t game, const CheckersSnapshot &snapshot) {
+  Checkers check;
+  if (!check.Checkers_Load(snapshot)) {
+    return false;
+  }
+
+  uint32_t pieces[5] = {0, 0, 0, 0, 0};
+  for (int i = 0; i < CHECKERS_SNAPSHOT_SQUARES; i++) {
+    pieces[(snapshot.squares[i / 2] >> ((i % 2) * 4)) & 0x0F] |= 1UL << i;
+  }
+  batch.p1[game] = pieces[1] | pieces[3];
+  batch.p2[game] = pieces[2] | pieces[4];
+  batch.kings[game] = pieces[3] | pieces[4];
+  batch.turn[game] = (snapshot.active_player == 2) ? 0xFFFFFFFFUL : 0;
+  batch.jump[game] = (snapshot.jump != SQUARE_NONE) ? 1UL << Batch_GetBit(snapshot.jump) : 0;
+  batch.won[game] = (snapshot.won != 0) ? 0xFFFFFFFFUL : 0;
+  batch.generated = false;
+  return true;
+}
+
+/**
+ * Packs a game into a snapshot, the same as Checkers_Save would for the same game
+ *
+ * @param batch: The games
+ * @param game: The game
+ * @param snapshot: The snapshot to fill in
+ */
+void Batch_Save(const BatchGames &batch, size_t game, CheckersSnapshot &snapshot) {
+  memset(&snapshot, 0, sizeof(snapshot));
+  for (int i = 0; i < CHECKERS_SNAPSHOT_SQUARES; i++) {
+    uint32_t bit = 1UL << i;
+    int piece = ((batch.p1[game] & bit) != 0) ? 1 : ((batch.p2[game] & bit) != 0) ? 2 : 0;
+    piece += (piece != 0 && (batch.kings[game] & bit) != 0) ? 2 : 0;
+    snapshot.squares[i / 2] |= (uint8_t)(piece << ((i % 2) * 4));
+  }
+  snapshot.active_player = (batch.turn[game] != 0) ? 2 : 1;
+  snapshot.jump = (batch.jump[game] != 0) ? Batch_GetSquare(Batch_Lowest(batch.jump[game])) : SQUARE_NONE;
+  snapshot.won = (batch.won[game] != 0) ? 1 : 0;
+}
+
+/**
+ * Retrieves if the build has a vector kernel
+ *
+ * @return bool: If it has one, otherwise asking for it runs the scalar kernel
+ */
+bool Batch_HasSimd() {
+  return BATCH_SIMD_LANES > 0;
+}
+
+/**
+ * Retrieves the name of the vector kernel the build has
+ *
+ * @return const char *: The name, "none" if it has none
+ */
+const char *Batch_GetSimdName() {
+  return BATCH_SIMD_NAME;
+}
+
+/**
+ * Finds the legal moves of every game
+ *
+ * @param batch: The games, given their movers
+ * @param simd: Indicator for if the vector kernel is used, if the build has one
+ */
+void Batch_Generate(BatchGames &batch, bool simd) {
+  size_t i = 0;
+#if BATCH_SIMD_LANES > 0
+  for (; simd && i < batch.count; i += BATCH_SIMD_LANES) {
+    Batch_GenerateGames<BatchVector>(batch, i);
+  }
+#else
+  (void)simd;
+#endif
+  for (; i < batch.count; i++) {
+    Batch_GenerateGames<uint32_t>(batch, i);
+  }
+  batch.generated = true;
+}
+
+/**
+ * Plays a move in every game
+ *
+ * @param batch: The games, with their movers from Batch_Generate
+ * @param moves: The move for each game, SQUARE_NONE to SQUARE_NONE to leave a game as it is
+ * @param played: Filled in with 1 for each game the move was played in, 0 if it was not legal
+ * @param simd: Indicator for if the vector kernel is used, if the build has one
+ * @return bool: If the movers were up to date, no move is played if not
+ */
+bool Batch_Play(BatchGames &batch, const Move *moves, uint8_t *played, bool simd) {
+  if (!batch.generated) {
+    return false;
+  }
+
+  for (size_t i = 0; i < batch.count; i++) {
+    int from = Batch_GetBit(moves[i].from);
+    int to = Batch_GetBit(moves[i].to);
+    batch.from[i] = (from >= 0 && to >= 0) ? 1UL << from : 0;
+    batch.to[i] = (from >= 0 && to >= 0) ? 1UL << to : 0;
+  }
+
+  size_t i = 0;
+#if BATCH_SIMD_LANES > 0
+  for (; simd && i < batch.count; i += BATCH_SIMD_LANES) {
+    Batch_PlayGames<BatchVector>(batch, i);
+  }
+#else
+  (void)simd;
+#endif
+  for (; i < batch.count; i++) {
+    Batch_PlayGames<uint32_t>(batch, i);
+  }
+
+  for (size_t i = 0; i < batch.count; i++) {
+    played[i] = (batch.from[i] != 0) ? 1 : 0;
+  }
+  batch.generated = false;
+  return true;
+}
+
+/**
+ * Counts the legal moves of a game
+ *
+ * @param batch: The games, with their movers from Batch_Generate
+ * @param game: The game
+ * @return int: The number of legal moves
+ */
+int Batch_CountMoves(const BatchGames &batch, size_t game) {
+  uint32_t count = 0;
+  for (int i = 0; i < BATCH_DIRECTIONS; i++) {
+    count += Batch_Count(batch.movers[i][game]);
+  }
+  return (int)count;
+}
+
+/**
+ * Retrieves one of the legal moves of a game, quicker than listing them all
+ *
+ * @param batch: The games, with their movers from Batch_Generate
+ * @param game: The game
+ * @param index: The number of the move, 0 to Batch_CountMoves less 1, counted by direction then square
+ * @return Move: The move, SQUARE_NONE to SQUARE_NONE if there are not that many
+ */
+Move Batch_GetMove(const BatchGames &batch, size_t game, int index) {
+  for (int i = 0; i < BATCH_DIRECTIONS; i++) {
+    uint32_t movers = batch.movers[i][game];
+    int count = (int)Batch_Count(movers);
+    if (index >= count) {
+      index -= count;
+      continue;
+    }
+    while (index-- > 0) {
+      movers &= movers - 1;
+    }
+    uint32_t from = movers & (0 - movers);
+    uint32_t to = Batch_Shift(from, i % 4);
+    to = (i < 4) ? to : Batch_Shift(to, i % 4);
+    return Move_Make(Batch_GetSquare(Batch_Lowest(from)), Batch_GetSquare(Batch_Lowest(to)));
+  }
+  return Move_Make(SQUARE_NONE, SQUARE_NONE);
+}
+
+/**
+ * Lists the legal moves of a game in the same order as Rules_GetLegalMoves (by square, then by step)
+ *
+ * @param batch: The games, with their movers from Batch_Generate
+ * @param game: The game
+ * @param moves: The legal moves
+ * @return int: The number of legal moves
+ */
+int Batch_GetMoves(const BatchGames &batch, size_t game, Move (&moves)[RULES_MAX_MOVES]) {
+  int move_count = 0;
+  for (int bit = 0; bit < CHECKERS_SNAPSHOT_SQUARES; bit++) {
+    uint32_t from = 1UL << bit;
+    for (int i = 0; i < BATCH_DIRECTIONS && move_count < RULES_MAX_MOVES; i++) {
+      if ((batch.movers[i][game] & from) != 0) {
+        uint32_t to = Batch_Shift(from, i % 4);
+        to = (i < 4) ? to : Batch_Shift(to, i % 4);
+        moves[move_count++] = Move_Make(Batch_GetSquare(bit), Batch_GetSquare(Batch_Lowest(to)));
+      }
+    }
+  }
+  return move_count;
+}
@@ -0,0 +1,70 @@
+/************************************************************
+ * @file Batch.h
+ * @brief The header for the batch engine, which steps many independent games at once for bulk simulation
+ *
+ * @note The games are kept as structure of arrays bitboards: one array per bitboard, one 32-bit word per game, with
+ *       bit n for dark square n in row order (the same order as a CheckersSnapshot). The same kernel runs a vector of
+ *       games at a time (AVX2 or NEON, when the build targets them) or one game at a time as the scalar fallback, and
+ *       plays by the same rules as Checkers_Turn, down to a won game keeping the square it was jumping from.
+ ************************************************************/
+#ifndef BATCH_H
+#define BATCH_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define BATCH_DIRECTIONS (8) /* The steps then the jumps, up left, up right, down left and down right, as in Rules_GetLegalMoves */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* Many games, each array holds one word per game and is padded to a whole number of vectors */
+struct BatchGames {
+  size_t                count;                     /* The number of games */
+  bool                  generated;                 /* Indicator for if movers is up to date with the games */
+  std::vector<uint32_t> p1;                        /* Player 1's pieces */
+  std::vector<uint32_t> p2;                        /* Player 2's pieces */
+  std::vector<uint32_t> kings;                     /* Both players' kings */
+  std::vector<uint32_t> turn;                      /* 0 if player 1 is the active player, all ones if player 2 is */
+  std::vector<uint32_t> jump;                      /* The square the active player has to keep jumping from, 0 if there is none */
+  std::vector<uint32_t> won;                       /* All ones once the game is won, with the active player the winner */
+  std::vector<uint32_t> movers[BATCH_DIRECTIONS];  /* The squares with a legal move in each direction, from Batch_Generate */
+  std::vector<uint32_t> from;                      /* The square each game's move is from, for Batch_Play */
+  std::vector<uint32_t> to;                        /* The square each game's move is to, for Batch_Play */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Set up functions */
+void Batch_Init(BatchGames &batch, size_t count);
+void Batch_Reset(BatchGames &batch, size_t game);
+bool Batch_Load(BatchGames &batch, size_t game, const CheckersSnapshot &snapshot);
+void Batch_Save(const BatchGames &batch, size_t game, CheckersSnapshot &snapshot);
+
+/* Stepping functions, simd picks the vector kernel when the build has one */
+bool        Batch_HasSimd();
+const char *Batch_GetSimdName();
+void        Batch_Generate(BatchGames &batch, bool simd);
+bool        Batch_Play(BatchGames &batch, const Move *moves, uint8_t *played, bool simd);
+
+/* Move list functions, from the movers Batch_Generate found */
+int  Batch_CountMoves(const BatchGames &batch, size_t game);
+Move Batch_GetMove(const BatchGames &batch, size_t game, int index);
+int  Batch_GetMoves(const BatchGames &batch, size_t game, Move (&moves)[RULES_MAX_MOVES]);
+
+#endif /* BATCH_H */
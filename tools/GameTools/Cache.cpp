@@ -0,0 +1,230 @@
+/************************************************************
+ * @file Cache.cpp
+ * @brief The implementation for the analysis cache, a memory mapped file of search results kept by position hash
+ *
+ * @note A result for a position already in its bucket only replaces it if it is at least as deep, and at the same
+ *       depth an exact score is never replaced by a bound. A new position takes the empty or shallowest slot. Two
+ *       threads storing at once can lose one of the results, never mix them up.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Cache.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define CACHE_SCORE_OFFSET (32768) /* Added to a score so it packs into 16 bits unsigned */
+
+/* Where each part of a result is packed in a slot's data */
+#define CACHE_FROM_SHIFT  (0)  /* The square moved from, 6 bits */
+#define CACHE_TO_SHIFT    (6)  /* The square moved to, 6 bits */
+#define CACHE_MOVE_SHIFT  (12) /* Indicator for if there is a best move, 1 bit */
+#define CACHE_BOUND_SHIFT (13) /* The bound, 2 bits, CACHE_BOUND_NONE for an empty slot */
+#define CACHE_DEPTH_SHIFT (15) /* The depth, 7 bits */
+#define CACHE_SCORE_SHIFT (22) /* The score and CACHE_SCORE_OFFSET, 16 bits */
+#define CACHE_NODES_SHIFT (38) /* The nodes, 26 bits */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+uint64_t Cache_Pack(const CacheEntry &entry);
+void     Cache_Unpack(uint64_t data, CacheEntry &entry);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Packs a result into a slot's data
+ *
+ * @param entry: The result, its depth, score and nodes are clamped to what fits
+ * @return uint64_t: The data
+ */
+uint64_t Cache_Pack(const CacheEntry &entry) {
+  int depth = (entry.depth < 0) ? 0 : (entry.depth > CACHE_MAX_DEPTH) ? CACHE_MAX_DEPTH : entry.depth;
+  int score = (entry.score < -CACHE_SCORE_OFFSET) ? -CACHE_SCORE_OFFSET : (entry.score >= CACHE_SCORE_OFFSET) ? CACHE_SCORE_OFFSET - 1 : entry.score;
+  uint64_t nodes = (entry.nodes > CACHE_MAX_NODES) ? CACHE_MAX_NODES : entry.nodes;
+  uint64_t data = ((uint64_t)(entry.bound & 3) << CACHE_BOUND_SHIFT) | ((uint64_t)depth << CACHE_DEPTH_SHIFT) |
+                  ((uint64_t)(score + CACHE_SCORE_OFFSET) << CACHE_SCORE_SHIFT) | (nodes << CACHE_NODES_SHIFT);
+  if (entry.best.from != SQUARE_NONE && entry.best.to != SQUARE_NONE) {
+    data |= ((uint64_t)(entry.best.from & 63) << CACHE_FROM_SHIFT) | ((uint64_t)(entry.best.to & 63) << CACHE_TO_SHIFT) |
+            (1ULL << CACHE_MOVE_SHIFT);
+  }
+  return data;
+}
+
+/**
+ * Unpacks a slot's data into a result
+ *
+ * @param data: The data
+ * @param entry: The result
+ */
+void Cache_Unpack(uint64_t data, CacheEntry &entry) {
+  bool has_move = ((data >> CACHE_MOVE_SHIFT) & 1) != 0;
+  entry.best.from = has_move ? (Square)((data >> CACHE_FROM_SHIFT) & 63) : SQUARE_NONE;
+  entry.best.to = has_move ? (Square)((data >> CACHE_TO_SHIFT) & 63) : SQUARE_NONE;
+  entry.bound = (int)((data >> CACHE_BOUND_SHIFT) & 3);
+  entry.depth = (int)((data >> CACHE_DEPTH_SHIFT) & 127);
+  entry.score = (int)((data >> CACHE_SCORE_SHIFT) & 0xFFFF) - CACHE_SCORE_OFFSET;
+  entry.nodes = data >> CACHE_NODES_SHIFT;
+}
+
+/**
+ * Maps a cache file into memory, making it if it does not exist
+ *
+ * @param cache: The cache
+ * @param path: The path of the file
+ * @param megabytes: The size of a new file, a file that already exists keeps its size
+ * @return bool: If the cache was mapped
+ */
+bool Cache_Open(CacheFile &cache, const char *path, unsigned long megabytes) {
+  struct stat file;
+  memset(&cache, 0, sizeof(cache));
+
+  int descriptor = open(path, O_RDWR | O_CREAT, 0644);
+  if (descriptor < 0 || fstat(descriptor, &file) != 0) {
+    if (descriptor >= 0) {
+      close(descriptor);
+    }
+    return false;
+  }
+
+  /* A new file gets as many buckets as fit, a power of 2 so the hash's low bits pick one */
+  bool created = file.st_size == 0;
+  if (created) {
+    uint64_t bucket_count = 1;
+    while (CACHE_HEADER_SIZE + bucket_count * 2 * CACHE_BUCKET_SLOTS * sizeof(CacheSlot) <= (uint64_t)megabytes << 20) {
+      bucket_count *= 2;
+    }
+    file.st_size = CACHE_HEADER_SIZE + bucket_count * CACHE_BUCKET_SLOTS * sizeof(CacheSlot);
+    if (ftruncate(descriptor, file.st_size) != 0) {
+      close(descriptor);
+      return false;
+    }
+  }
+
+  cache.size = (size_t)file.st_size;
+  cache.map = mmap(0, cache.size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+  close(descriptor);
+  if (cache.map == MAP_FAILED) {
+    memset(&cache, 0, sizeof(cache));
+    return false;
+  }
+
+  CacheHeader *header = (CacheHeader *)cache.map;
+  if (created) {
+    header->magic = CACHE_MAGIC;
+    header->version = CACHE_VERSION;
+    header->slot_size = sizeof(CacheSlot);
+    header->bucket_count = (cache.size - CACHE_HEADER_SIZE) / (CACHE_BUCKET_SLOTS * sizeof(CacheSlot));
+  }
+  if (cache.size < CACHE_HEADER_SIZE || header->magic != CACHE_MAGIC || header->version != CACHE_VERSION ||
+      header->slot_size != sizeof(CacheSlot) || header->bucket_count == 0 || (header->bucket_count & (header->bucket_count - 1)) != 0 ||
+      CACHE_HEADER_SIZE + header->bucket_count * CACHE_BUCKET_SLOTS * sizeof(CacheSlot) != cache.size) {
+    Cache_Close(cache);
+    return false;
+  }
+
+  cache.slots = (CacheSlot *)((uint8_t *)cache.map + CACHE_HEADER_SIZE);
+  cache.bucket_count = header->bucket_count;
+  return true;
+}
+
+/**
+ * Writes a cache back to its file and unmaps it
+ *
+ * @param cache: The cache
+ */
+void Cache_Close(CacheFile &cache) {
+  if (cache.map != 0) {
+    msync(cache.map, cache.size, MS_SYNC);
+    munmap(cache.map, cache.size);
+  }
+  memset(&cache, 0, sizeof(cache));
+}
+
+/**
+ * Counts the slots holding a result
+ *
+ * @param cache: The cache
+ * @return uint64_t: The number of results
+ */
+uint64_t Cache_CountEntries(const CacheFile &cache) {
+  uint64_t count = 0;
+  for (uint64_t i = 0; i < cache.bucket_count * CACHE_BUCKET_SLOTS; i++) {
+    count += (((cache.slots[i].data >> CACHE_BOUND_SHIFT) & 3) != CACHE_BOUND_NONE) ? 1 : 0;
+  }
+  return count;
+}
+
+/**
+ * Looks up a position's result
+ *
+ * @param cache: The cache
+ * @param hash: The hash of the position, from Rules_Hash
+ * @param entry: The result found
+ * @return bool: If there was a result for the position
+ */
+bool Cache_Probe(const CacheFile &cache, uint64_t hash, CacheEntry &entry) {
+  CacheSlot *bucket = cache.slots + (hash & (cache.bucket_count - 1)) * CACHE_BUCKET_SLOTS;
+  for (int i = 0; i < CACHE_BUCKET_SLOTS; i++) {
+    uint64_t check = __atomic_load_n(&bucket[i].check, __ATOMIC_RELAXED);
+    uint64_t data = __atomic_load_n(&bucket[i].data, __ATOMIC_RELAXED);
+    if (((data >> CACHE_BOUND_SHIFT) & 3) != CACHE_BOUND_NONE && (check ^ data) == hash) {
+      Cache_Unpack(data, entry);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Stores a position's result, unless a deeper one is already kept
+ *
+ * @param cache: The cache
+ * @param hash: The hash of the position, from Rules_Hash
+ * @param entry: The result
+ * @return bool: If the result was stored
+ */
+bool Cache_Store(CacheFile &cache, uint64_t hash, const CacheEntry &entry) {
+  CacheSlot *bucket = cache.slots + (hash & (cache.bucket_count - 1)) * CACHE_BUCKET_SLOTS;
+  CacheSlot *replaced = 0;
+  int replaced_depth = CACHE_MAX_DEPTH + 1;
+
+  for (int i = 0; i < CACHE_BUCKET_SLOTS; i++) {
+    uint64_t check = __atomic_load_n(&bucket[i].check, __ATOMIC_RELAXED);
+    uint64_t data = __atomic_load_n(&bucket[i].data, __ATOMIC_RELAXED);
+    CacheEntry kept;
+    Cache_Unpack(data, kept);
+
+    if (kept.bound != CACHE_BOUND_NONE && (check ^ data) == hash) {
+      if (entry.depth < kept.depth || (entry.depth == kept.depth && kept.bound == CACHE_BOUND_EXACT && entry.bound != CACHE_BOUND_EXACT)) {
+        return false;
+      }
+      replaced = &bucket[i];
+      break;
+    }
+
+    /* An empty slot, or one torn by two writers, is the shallowest there is */
+    int depth = (kept.bound == CACHE_BOUND_NONE || ((check ^ data) & (cache.bucket_count - 1)) != (hash & (cache.bucket_count - 1))) ? -1 : kept.depth;
+    if (depth < replaced_depth) {
+      replaced = &bucket[i];
+      replaced_depth = depth;
+    }
+  }
+
+  uint64_t data = Cache_Pack(entry);
+  __atomic_store_n(&replaced->data, data, __ATOMIC_RELAXED);
+  __atomic_store_n(&replaced->check, hash ^ data, __ATOMIC_RELAXED);
+  return true;
+}
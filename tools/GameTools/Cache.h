@@ -0,0 +1,83 @@
+/************************************************************
+ * @file Cache.h
+ * @brief The header for the analysis cache, a memory mapped file of search results kept by position hash
+ *
+ * @note The file is a header then buckets of slots, one bucket per cache line. A slot is two 64-bit words: the packed
+ *       result and the position's hash XORed with it. Threads and processes write slots with plain atomic stores and
+ *       no locks, and a slot torn by two writers no longer matches its hash, so it reads as empty instead of wrong.
+ ************************************************************/
+#ifndef CACHE_H
+#define CACHE_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stddef.h>
+#include <stdint.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define CACHE_MAGIC        (0x43414B43UL)     /* "CKAC" at the start of the file */
+#define CACHE_VERSION      (1)                /* The version of the format written */
+#define CACHE_BUCKET_SLOTS (4)                /* The slots in a bucket, 64 bytes */
+#define CACHE_HEADER_SIZE  (64)               /* The bytes before the first bucket, so buckets stay on cache lines */
+#define CACHE_MAX_DEPTH    (127)              /* The deepest result a slot holds */
+#define CACHE_MAX_NODES    ((1ULL << 26) - 1) /* The most nodes a slot counts, more are kept as this */
+#define CACHE_BOUND_NONE   (0)                /* An empty slot */
+#define CACHE_BOUND_LOWER  (1)                /* The score is at least the one kept (the search failed high) */
+#define CACHE_BOUND_UPPER  (2)                /* The score is at most the one kept (the search failed low) */
+#define CACHE_BOUND_EXACT  (3)                /* The score is the one kept */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The start of the file */
+struct CacheHeader {
+  uint32_t magic;        /* CACHE_MAGIC */
+  uint16_t version;      /* CACHE_VERSION */
+  uint16_t slot_size;    /* The bytes in a slot */
+  uint64_t bucket_count; /* The number of buckets, a power of 2 */
+};
+
+/* A slot in the file */
+struct CacheSlot {
+  uint64_t check; /* The position's hash XORed with the data */
+  uint64_t data;  /* The packed result */
+};
+
+/* A search result */
+struct CacheEntry {
+  Move     best;  /* The best move, SQUARE_NONE to SQUARE_NONE if there is none */
+  int      score; /* The score for the active player */
+  int      depth; /* The depth searched to */
+  int      bound; /* CACHE_BOUND_LOWER, CACHE_BOUND_UPPER or CACHE_BOUND_EXACT */
+  uint64_t nodes; /* The positions searched to find it */
+};
+
+/* A cache mapped into memory, shared by every thread using it */
+struct CacheFile {
+  void      *map;          /* The mapped file */
+  size_t     size;         /* The bytes in the file */
+  CacheSlot *slots;        /* The slots */
+  uint64_t   bucket_count; /* The number of buckets */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* File functions */
+bool     Cache_Open(CacheFile &cache, const char *path, unsigned long megabytes);
+void     Cache_Close(CacheFile &cache);
+uint64_t Cache_CountEntries(const CacheFile &cache);
+
+/* Entry functions (safe to call from any thread) */
+bool Cache_Probe(const CacheFile &cache, uint64_t hash, CacheEntry &entry);
+bool Cache_Store(CacheFile &cache, uint64_t hash, const CacheEntry &entry);
+
+#endif /* CACHE_H */
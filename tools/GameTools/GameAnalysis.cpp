@@ -0,0 +1,545 @@
+/************************************************************
+ * @file GameAnalysis.cpp
+ * @brief Analyses every position of a game on many threads, keeping the results in a persistent analysis cache
+ *
+ * @note The positions are analysed from the last one back to the first, so the later positions' results are in the
+ *       cache by the time the earlier positions' searches reach them. Analysing the game again, or a game that shares
+ *       lines with one analysed before, starts from the depth the cache already has instead of from scratch
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Archive.h"
+#include "Cache.h"
+#include "Checkers.h"
+#include "Move.h"
+#include "Pdn.h"
+#include "Rules.h"
+#include "Search.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define GAME_ANALYSIS_DEPTH         (8)      /* The depth searched unless asked for otherwise */
+#define GAME_ANALYSIS_CACHE_MB      (64)     /* The size of a new cache unless asked for otherwise (MB) */
+#define GAME_ANALYSIS_MAX_THREADS   (256)    /* The most threads asked for */
+#define GAME_ANALYSIS_STRESS_STORES (200000) /* The results each thread stores in the check of the cache's concurrent stores */
+#define GAME_ANALYSIS_STRESS_KEYS   (65536)  /* The different positions the threads store results for in that check */
+#define GAME_ANALYSIS_STRESS_MB     (1)      /* The size of the cache that check stores into, small so slots are fought over (MB) */
+#define GAME_ANALYSIS_RESTART_RATIO (10)     /* The times fewer positions analysing again after a restart has to search */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct GameAnalysisOptions {
+  const char   *cache_path;   /* The cache to use, made if it does not exist */
+  unsigned long cache_mb;     /* The size of a new cache (MB) */
+  int           depth;        /* The depth to analyse each position to */
+  unsigned int  threads;      /* The threads analysing positions */
+  const char   *archive_path; /* The archive to take the game from (0 to set up the game from the FEN and moves) */
+  uint64_t      game_id;      /* The game in the archive */
+  const char   *fen;          /* The position to start from as a FEN (0 for a new game) */
+  const char   *moves;        /* The moves to play from it, such as "F2 E3,C1 D2" (0 for none) */
+  bool          check;        /* Indicator for if the cache is checked before the analysis */
+};
+
+/* A position of the game and its analysis */
+struct GameAnalysisPosition {
+  Checkers     game;   /* The position */
+  int          ply;    /* The moves played before it */
+  Move         played; /* The move played from it, SQUARE_NONE to SQUARE_NONE if the game ended there */
+  SearchResult result; /* The analysis */
+};
+
+/* The positions shared between the threads */
+struct GameAnalysisWork {
+  std::vector<GameAnalysisPosition> *positions; /* The positions */
+  CacheFile                         *cache;     /* The cache */
+  int                                depth;     /* The depth to analyse to */
+  unsigned int                       next;      /* The number of positions taken so far, from the last one back */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double   GameAnalysis_GetTime();
+bool     GameAnalysis_SetUp(const GameAnalysisOptions &options, std::vector<GameAnalysisPosition> &positions);
+void     GameAnalysis_Worker(GameAnalysisWork *work);
+uint64_t GameAnalysis_Run(std::vector<GameAnalysisPosition> &positions, CacheFile &cache, int depth, unsigned int threads);
+void     GameAnalysis_StressEntry(uint64_t hash, CacheEntry &entry);
+void     GameAnalysis_StressWorker(CacheFile *cache, unsigned int thread, bool *consistent);
+bool     GameAnalysis_CheckStores(const GameAnalysisOptions &options);
+bool     GameAnalysis_CheckRestart(const GameAnalysisOptions &options, const std::vector<GameAnalysisPosition> &start);
+bool     GameAnalysis_Analyse(const GameAnalysisOptions &options, std::vector<GameAnalysisPosition> &positions);
+bool     GameAnalysis_ParseOptions(int argc, char *argv[], GameAnalysisOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double GameAnalysis_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Sets up the positions of the game, from the archive or from the FEN and moves
+ *
+ * @param options: The options
+ * @param positions: Every position of the game, from the start to the end
+ * @return bool: If the game could be read and every move was legal
+ */
+bool GameAnalysis_SetUp(const GameAnalysisOptions &options, std::vector<GameAnalysisPosition> &positions) {
+  static ArchiveReader reader;
+  static ArchiveGame game;
+  GameAnalysisPosition position;
+
+  game.has_start = false;
+  game.ply_count = 0;
+  if (options.archive_path != 0) {
+    if (!Archive_Open(reader, options.archive_path) || !Archive_Seek(reader, options.game_id) || !Archive_ReadGame(reader, game)) {
+      fprintf(stderr, "could not read game %llu of %s\n", (unsigned long long)options.game_id, options.archive_path);
+      Archive_CloseReader(reader);
+      return false;
+    }
+    Archive_CloseReader(reader);
+  }
+  else if (options.fen != 0) {
+    Checkers trial;
+    if (!Pdn_ReadFen(options.fen, options.fen + strlen(options.fen), game.start) || !trial.Checkers_Load(game.start)) {
+      fprintf(stderr, "could not set up %s\n", options.fen);
+      return false;
+    }
+    game.has_start = true;
+  }
+
+  /* The moves are separated by commas, in the same "A1 B2" syntax as the voice commands */
+  const char *text = (options.archive_path == 0) ? options.moves : 0;
+  while (text != 0 && *text != '\0' && game.ply_count < ARCHIVE_MAX_PLIES) {
+    const char *end = strchr(text, ',');
+    char move_text[RULES_MOVE_TEXT + 1];
+    size_t length = (end != 0) ? (size_t)(end - text) : strlen(text);
+    while (length > 0 && *text == ' ') {
+      text++;
+      length--;
+    }
+    if (length > RULES_MOVE_TEXT) {
+      fprintf(stderr, "could not read %.*s\n", (int)length, text);
+      return false;
+    }
+    memcpy(move_text, text, length);
+    move_text[length] = '\0';
+    if (!Rules_ParseMove(move_text, game.plies[game.ply_count])) {
+      fprintf(stderr, "could not read %s\n", move_text);
+      return false;
+    }
+    game.ply_count++;
+    text = (end != 0) ? end + 1 : 0;
+  }
+
+  Archive_StartGame(game, position.game);
+  positions.clear();
+  for (int ply = 0; ply <= game.ply_count; ply++) {
+    position.ply = ply;
+    position.played = (ply < game.ply_count) ? game.plies[ply] : Move_Make(SQUARE_NONE, SQUARE_NONE);
+    positions.push_back(position);
+    if (ply < game.ply_count && position.game.Checkers_Turn(game.plies[ply]) != 1) {
+      char move_text[RULES_MOVE_TEXT];
+      Rules_FormatMove(game.plies[ply], move_text);
+      fprintf(stderr, "could not play %s at ply %d\n", move_text, ply);
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Analyses positions until there are none left
+ *
+ * @param work: The positions shared between the threads
+ */
+void GameAnalysis_Worker(GameAnalysisWork *work) {
+  unsigned int count = (unsigned int)work->positions->size();
+  unsigned int taken;
+  while ((taken = __atomic_fetch_add(&work->next, 1, __ATOMIC_RELAXED)) < count) {
+    GameAnalysisPosition &position = (*work->positions)[count - 1 - taken];
+    Search_Analyse(position.game, work->depth, work->cache, 0, position.result);
+  }
+}
+
+/**
+ * Analyses every position on many threads, sharing the cache
+ *
+ * @param positions: The positions, each given its analysis
+ * @param cache: The cache
+ * @param depth: The depth to analyse to
+ * @param threads: The threads to analyse with
+ * @return uint64_t: The positions searched
+ */
+uint64_t GameAnalysis_Run(std::vector<GameAnalysisPosition> &positions, CacheFile &cache, int depth, unsigned int threads) {
+  GameAnalysisWork work;
+  std::vector<std::thread> workers;
+  uint64_t nodes = 0;
+
+  work.positions = &positions;
+  work.cache = &cache;
+  work.depth = depth;
+  work.next = 0;
+  for (unsigned int i = 0; i < threads; i++) {
+    workers.push_back(std::thread(GameAnalysis_Worker, &work));
+  }
+  for (unsigned int i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+
+  for (unsigned int i = 0; i < positions.size(); i++) {
+    nodes += positions[i].result.nodes;
+  }
+  return nodes;
+}
+
+/**
+ * Makes the result the check of concurrent stores stores for a position, so any result read back can be checked
+ *
+ * @param hash: The hash of the position
+ * @param entry: The result for it
+ */
+void GameAnalysis_StressEntry(uint64_t hash, CacheEntry &entry) {
+  uint64_t bits = Rules_Mix(hash);
+  entry.best = Move_Make((Square)(bits & 63), (Square)((bits >> 6) & 63));
+  entry.score = (int)((bits >> 12) % 2001) - 1000;
+  entry.depth = 1 + (int)((bits >> 24) % SEARCH_MAX_DEPTH);
+  entry.bound = CACHE_BOUND_EXACT;
+  entry.nodes = (bits >> 32) & CACHE_MAX_NODES;
+}
+
+/**
+ * Stores and probes results for random positions as fast as it can, checking every result read back
+ *
+ * @param cache: The cache, shared with the other threads doing the same
+ * @param thread: The number of the thread, which seeds its positions
+ * @param consistent: Indicator for if every result read back was the one stored for its position
+ */
+void GameAnalysis_StressWorker(CacheFile *cache, unsigned int thread, bool *consistent) {
+  uint32_t random_state = 1 + thread;
+  *consistent = true;
+
+  for (int i = 0; i < GAME_ANALYSIS_STRESS_STORES; i++) {
+    /* The threads share their positions, so they store to the same slots at once */
+    CacheEntry entry;
+    CacheEntry found;
+    uint64_t hash = Rules_Mix(Rules_Random(random_state) % GAME_ANALYSIS_STRESS_KEYS);
+    GameAnalysis_StressEntry(hash, entry);
+    Cache_Store(*cache, hash, entry);
+
+    hash = Rules_Mix(Rules_Random(random_state) % GAME_ANALYSIS_STRESS_KEYS);
+    GameAnalysis_StressEntry(hash, entry);
+    if (Cache_Probe(*cache, hash, found) &&
+        (found.best.from != entry.best.from || found.best.to != entry.best.to || found.score != entry.score ||
+         found.depth != entry.depth || found.bound != entry.bound || found.nodes != entry.nodes)) {
+      *consistent = false;
+    }
+  }
+}
+
+/**
+ * Checks the cache's stores: a result is only replaced by one as deep or deeper, and many threads storing to the
+ * same slots at once never leave a result that was not stored for its position
+ *
+ * @param options: The options
+ * @return bool: If the stores behaved
+ */
+bool GameAnalysis_CheckStores(const GameAnalysisOptions &options) {
+  CacheFile cache;
+  CacheEntry entry;
+  CacheEntry found;
+  char path[] = "/tmp/GameAnalysisXXXXXX";
+
+  int descriptor = mkstemp(path);
+  if (descriptor < 0) {
+    fprintf(stderr, "could not make a cache to check\n");
+    return false;
+  }
+  close(descriptor);
+  if (!Cache_Open(cache, path, GAME_ANALYSIS_STRESS_MB)) {
+    fprintf(stderr, "could not open %s\n", path);
+    unlink(path);
+    return false;
+  }
+
+  /* Deeper results replace shallower ones, and at the same depth a bound never replaces an exact score */
+  uint64_t hash = Rules_Mix(0);
+  entry.best = Move_Make(SQUARE_NONE, SQUARE_NONE);
+  entry.score = 10;
+  entry.nodes = 100;
+  entry.depth = 6;
+  entry.bound = CACHE_BOUND_EXACT;
+  bool passed = Cache_Store(cache, hash, entry);
+  entry.depth = 4;
+  passed = passed && !Cache_Store(cache, hash, entry);
+  entry.depth = 6;
+  entry.bound = CACHE_BOUND_LOWER;
+  passed = passed && !Cache_Store(cache, hash, entry);
+  entry.depth = 7;
+  entry.score = -20;
+  passed = passed && Cache_Store(cache, hash, entry) && Cache_Probe(cache, hash, found) && found.depth == 7 && found.score == -20 &&
+           found.bound == CACHE_BOUND_LOWER;
+  if (!passed) {
+    fprintf(stderr, "a result was replaced by a shallower one\n");
+  }
+  memset(cache.slots, 0, cache.bucket_count * CACHE_BUCKET_SLOTS * sizeof(CacheSlot));
+
+  std::vector<std::thread> threads;
+  static bool consistent[GAME_ANALYSIS_MAX_THREADS * 2];
+  double start = GameAnalysis_GetTime();
+  for (unsigned int i = 0; i < options.threads * 2; i++) {
+    threads.push_back(std::thread(GameAnalysis_StressWorker, &cache, i, &consistent[i]));
+  }
+  for (unsigned int i = 0; i < threads.size(); i++) {
+    threads[i].join();
+    if (!consistent[i]) {
+      fprintf(stderr, "thread %u read back a result that was not stored for its position\n", i);
+      passed = false;
+    }
+  }
+  double elapsed = GameAnalysis_GetTime() - start;
+
+  /* Every result left has to be the one stored for its position */
+  uint64_t entries = 0;
+  for (uint64_t i = 0; i < GAME_ANALYSIS_STRESS_KEYS && passed; i++) {
+    hash = Rules_Mix(i);
+    GameAnalysis_StressEntry(hash, entry);
+    if (Cache_Probe(cache, hash, found)) {
+      entries++;
+      passed = found.best.from == entry.best.from && found.best.to == entry.best.to && found.score == entry.score &&
+               found.depth == entry.depth && found.nodes == entry.nodes;
+      if (!passed) {
+        fprintf(stderr, "position %llu was left with a result that was not stored for it\n", (unsigned long long)i);
+      }
+    }
+  }
+  passed = passed && entries > 0 && entries == Cache_CountEntries(cache);
+  Cache_Close(cache);
+  unlink(path);
+
+  if (passed) {
+    printf("check passed: %u threads stored and probed %u results in %.2f s, %llu positions left cached, none torn\n",
+           options.threads * 2, options.threads * 2 * GAME_ANALYSIS_STRESS_STORES, elapsed, (unsigned long long)entries);
+  }
+  return passed;
+}
+
+/**
+ * Checks that the cache lasts: the game is analysed into a new cache, which is closed and opened again as a restarted
+ * process would, then analysed again, which has to give the same results from far fewer positions searched
+ *
+ * @param options: The options
+ * @param start: The positions of the game, not yet analysed
+ * @return bool: If the analysis after the restart started from the cache
+ */
+bool GameAnalysis_CheckRestart(const GameAnalysisOptions &options, const std::vector<GameAnalysisPosition> &start) {
+  std::vector<GameAnalysisPosition> first = start;
+  std::vector<GameAnalysisPosition> second = start;
+  CacheFile cache;
+  char path[] = "/tmp/GameAnalysisXXXXXX";
+
+  int descriptor = mkstemp(path);
+  if (descriptor < 0) {
+    fprintf(stderr, "could not make a cache to check\n");
+    return false;
+  }
+  close(descriptor);
+  if (!Cache_Open(cache, path, options.cache_mb)) {
+    fprintf(stderr, "could not open %s\n", path);
+    unlink(path);
+    return false;
+  }
+  uint64_t first_nodes = GameAnalysis_Run(first, cache, options.depth, options.threads);
+  Cache_Close(cache);
+
+  bool passed = Cache_Open(cache, path, 0);
+  uint64_t second_nodes = passed ? GameAnalysis_Run(second, cache, options.depth, options.threads) : 0;
+  Cache_Close(cache);
+  unlink(path);
+  if (!passed) {
+    fprintf(stderr, "could not open %s again\n", path);
+    return false;
+  }
+
+  /* A game that is over has nothing to cache, it is settled without searching */
+  for (unsigned int i = 0; i < first.size() && passed; i++) {
+    passed = second[i].result.depth >= options.depth && second[i].result.score == first[i].result.score &&
+             (second[i].result.cached_depth >= options.depth || second[i].result.best.from == SQUARE_NONE);
+    if (!passed) {
+      fprintf(stderr, "ply %d was analysed to depth %d (cached %d) scoring %d after the restart, %d before\n", first[i].ply,
+              second[i].result.depth, second[i].result.cached_depth, second[i].result.score, first[i].result.score);
+    }
+  }
+  if (passed && second_nodes * GAME_ANALYSIS_RESTART_RATIO > first_nodes) {
+    fprintf(stderr, "analysing again after a restart searched %llu positions, the first time %llu\n", (unsigned long long)second_nodes,
+            (unsigned long long)first_nodes);
+    passed = false;
+  }
+
+  if (passed) {
+    printf("check passed: %lu positions analysed to depth %d from %llu positions searched, %llu after a restart\n",
+           (unsigned long)first.size(), options.depth, (unsigned long long)first_nodes, (unsigned long long)second_nodes);
+  }
+  return passed;
+}
+
+/**
+ * Analyses the game into the cache, printing each position's best move and how much the cache saved
+ *
+ * @param options: The options
+ * @param positions: The positions of the game
+ * @return bool: If the cache could be opened
+ */
+bool GameAnalysis_Analyse(const GameAnalysisOptions &options, std::vector<GameAnalysisPosition> &positions) {
+  CacheFile cache;
+  char best_text[RULES_MOVE_TEXT];
+  char played_text[RULES_MOVE_TEXT];
+
+  if (!Cache_Open(cache, options.cache_path, options.cache_mb)) {
+    fprintf(stderr, "could not open %s\n", options.cache_path);
+    return false;
+  }
+
+  double start = GameAnalysis_GetTime();
+  uint64_t nodes = GameAnalysis_Run(positions, cache, options.depth, options.threads);
+  double elapsed = GameAnalysis_GetTime() - start;
+
+  unsigned int cached = 0;
+  printf(" ply  player  played  best   score  depth  cached      nodes\n");
+  for (unsigned int i = 0; i < positions.size(); i++) {
+    const SearchResult &result = positions[i].result;
+    if (positions[i].played.from == SQUARE_NONE) {
+      snprintf(played_text, sizeof(played_text), "end");
+    }
+    else {
+      Rules_FormatMove(positions[i].played, played_text);
+    }
+    if (result.best.from == SQUARE_NONE) {
+      snprintf(best_text, sizeof(best_text), "-");
+    }
+    else {
+      Rules_FormatMove(result.best, best_text);
+    }
+    printf("%4d  %6d  %-6s  %-5s  %6d  %5d  %6d  %9llu\n", positions[i].ply, positions[i].game.Checkers_GetActivePlayer(), played_text,
+           best_text, result.score, result.depth, result.cached_depth, (unsigned long long)result.nodes);
+    cached += (result.cached_depth >= options.depth) ? 1 : 0;
+  }
+
+  printf("analysed %lu positions to depth %d with %u threads in %.2f s, %llu positions searched (%.0f per s), %u already cached as deep\n",
+         (unsigned long)positions.size(), options.depth, options.threads, elapsed, (unsigned long long)nodes,
+         (elapsed > 0) ? nodes / elapsed : 0.0, cached);
+  printf("cache %s %lu MB, %llu results in %llu slots\n", options.cache_path, (unsigned long)(cache.size >> 20),
+         (unsigned long long)Cache_CountEntries(cache), (unsigned long long)(cache.bucket_count * CACHE_BUCKET_SLOTS));
+
+  Cache_Close(cache);
+  return true;
+}
+
+/**
+ * Entry point, analyses a game into the cache
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if everything asked for worked, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  GameAnalysisOptions options;
+  std::vector<GameAnalysisPosition> positions;
+  if (!GameAnalysis_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s -c <cache> [-s cache MB] [-d depth] [-j threads] (-a <archive> -g <game> | [-f fen] [-m \"F2 E3,C1 D2\"]) [-t]\n",
+            argv[0]);
+    return 2;
+  }
+
+  bool passed = GameAnalysis_SetUp(options, positions);
+  if (passed && options.check) {
+    passed = GameAnalysis_CheckStores(options) && GameAnalysis_CheckRestart(options, positions);
+  }
+  passed = passed && GameAnalysis_Analyse(options, positions);
+  return passed ? 0 : 1;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool GameAnalysis_ParseOptions(int argc, char *argv[], GameAnalysisOptions &options) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  bool has_game = false;
+  options.cache_path = 0;
+  options.cache_mb = GAME_ANALYSIS_CACHE_MB;
+  options.depth = GAME_ANALYSIS_DEPTH;
+  options.threads = (cores > 0) ? (unsigned int)cores : 1;
+  options.archive_path = 0;
+  options.game_id = 0;
+  options.fen = 0;
+  options.moves = 0;
+  options.check = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "c:s:d:j:a:g:f:m:t")) != -1) {
+    switch (option) {
+      case 'c':
+        options.cache_path = optarg;
+        break;
+      case 's':
+        options.cache_mb = strtoul(optarg, 0, 10);
+        break;
+      case 'd':
+        options.depth = atoi(optarg);
+        break;
+      case 'j':
+        options.threads = strtoul(optarg, 0, 10);
+        break;
+      case 'a':
+        options.archive_path = optarg;
+        break;
+      case 'g':
+        options.game_id = strtoull(optarg, 0, 10);
+        has_game = true;
+        break;
+      case 'f':
+        options.fen = optarg;
+        break;
+      case 'm':
+        options.moves = optarg;
+        break;
+      case 't':
+        options.check = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return options.cache_path != 0 && options.cache_mb > 0 && options.depth >= 1 && options.depth <= SEARCH_MAX_DEPTH &&
+         options.threads > 0 && options.threads <= GAME_ANALYSIS_MAX_THREADS && (options.archive_path != 0) == has_game &&
+         (options.archive_path == 0 || (options.fen == 0 && options.moves == 0));
+}
@@ -0,0 +1,397 @@
+/************************************************************
+ * @file GameArchive.cpp
+ * @brief Writes seeded random games to a game archive, and reads an archive back, printing its size per move and read speed
+ *        or writing its games out as PDN text
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Archive.h"
+#include "Checkers.h"
+#include "Move.h"
+#include "Pdn.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define GAME_ARCHIVE_MAX_PLIES   (300) /* The moves a random game gets before it is called a draw */
+#define GAME_ARCHIVE_TEXT_BYTES  (6)   /* The bytes a move takes as PDN text, such as "11-15 ", to compare the archive with */
+#define GAME_ARCHIVE_SEEK_CHECKS (100) /* The games read out of order by a check */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct GameArchiveOptions {
+  const char   *write_path;  /* The archive to write random games to (0 to not write one) */
+  const char   *read_path;   /* The archive to read (0 to not read one) */
+  const char   *pdn_path;    /* The PDN file to write the archive read to (0 to not write one) */
+  unsigned long games;       /* The number of random games to write */
+  uint32_t      seed;        /* The seed of the random games */
+  uint32_t      chunk_games; /* The games in each chunk */
+  long          show_game;   /* The game to print the moves of (-1 for none) */
+  bool          check;       /* Indicator for if the archive written is read back and compared with the games */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double GameArchive_GetTime();
+void   GameArchive_PlayGame(uint32_t seed, uint64_t id, ArchiveGame &game);
+bool   GameArchive_SameGame(const ArchiveGame &first, const ArchiveGame &second);
+bool   GameArchive_Write(const GameArchiveOptions &options);
+bool   GameArchive_Check(const GameArchiveOptions &options);
+bool   GameArchive_Read(const char *path);
+bool   GameArchive_Show(const char *path, long game_id);
+bool   GameArchive_Export(const char *path, const char *pdn_path);
+bool   GameArchive_ParseOptions(int argc, char *argv[], GameArchiveOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double GameArchive_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Plays a random game, the same one every time for a seed and game number
+ *
+ * @param seed: The seed of the run
+ * @param id: The number of the game
+ * @param game: The game played
+ */
+void GameArchive_PlayGame(uint32_t seed, uint64_t id, ArchiveGame &game) {
+  Checkers board;
+  uint32_t random_state = (seed * 2654435761UL) ^ (uint32_t)(id * 40503UL + 1);
+  if (random_state == 0) {
+    random_state = 1;
+  }
+
+  game.id = id;
+  game.has_start = false;
+  game.ply_count = Rules_PlayRandomGame(board, random_state, game.plies, GAME_ARCHIVE_MAX_PLIES, game.result);
+}
+
+/**
+ * Compares two games
+ *
+ * @param first: The first game
+ * @param second: The second game
+ * @return bool: If they have the same result and moves
+ */
+bool GameArchive_SameGame(const ArchiveGame &first, const ArchiveGame &second) {
+  if (first.result != second.result || first.ply_count != second.ply_count || first.has_start != second.has_start) {
+    return false;
+  }
+  for (int i = 0; i < first.ply_count; i++) {
+    if (first.plies[i].from != second.plies[i].from || first.plies[i].to != second.plies[i].to) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Writes the random games to an archive
+ *
+ * @param options: The options
+ * @return bool: If every game was written
+ */
+bool GameArchive_Write(const GameArchiveOptions &options) {
+  static ArchiveWriter writer;
+  static ArchiveGame game;
+
+  if (!Archive_Create(writer, options.write_path, options.chunk_games)) {
+    fprintf(stderr, "could not create %s\n", options.write_path);
+    return false;
+  }
+
+  double start = GameArchive_GetTime();
+  for (unsigned long i = 0; i < options.games; i++) {
+    GameArchive_PlayGame(options.seed, i, game);
+    if (!Archive_WriteGame(writer, game)) {
+      fprintf(stderr, "game %lu was not written\n", i);
+      Archive_Close(writer);
+      return false;
+    }
+  }
+  if (!Archive_Close(writer)) {
+    fprintf(stderr, "could not write %s\n", options.write_path);
+    return false;
+  }
+
+  printf("wrote %lu games with seed %lu in %.2f s\n", options.games, (unsigned long)options.seed, GameArchive_GetTime() - start);
+  return true;
+}
+
+/**
+ * Reads back the archive written, comparing every game with the one that was played, then reads games out of order
+ *
+ * @param options: The options
+ * @return bool: If every game read matched
+ */
+bool GameArchive_Check(const GameArchiveOptions &options) {
+  static ArchiveReader reader;
+  static ArchiveGame expected;
+  static ArchiveGame game;
+
+  if (!Archive_Open(reader, options.write_path)) {
+    fprintf(stderr, "could not open %s\n", options.write_path);
+    return false;
+  }
+
+  unsigned long read = 0;
+  while (Archive_ReadGame(reader, game)) {
+    GameArchive_PlayGame(options.seed, read, expected);
+    if (game.id != read || !GameArchive_SameGame(game, expected)) {
+      fprintf(stderr, "game %lu does not match the game written\n", read);
+      Archive_CloseReader(reader);
+      return false;
+    }
+    read++;
+  }
+  if (read != options.games) {
+    fprintf(stderr, "read %lu games of %lu\n", read, options.games);
+    Archive_CloseReader(reader);
+    return false;
+  }
+
+  /* Random access lands on the right game from any chunk, forwards or backwards */
+  uint32_t random_state = options.seed | 1;
+  for (int i = 0; i < GAME_ARCHIVE_SEEK_CHECKS && options.games > 0; i++) {
+    uint64_t id = Rules_Random(random_state) % options.games;
+    GameArchive_PlayGame(options.seed, id, expected);
+    if (!Archive_Seek(reader, id) || !Archive_ReadGame(reader, game) || game.id != id || !GameArchive_SameGame(game, expected)) {
+      fprintf(stderr, "seeking to game %lu did not read it back\n", (unsigned long)id);
+      Archive_CloseReader(reader);
+      return false;
+    }
+  }
+
+  Archive_CloseReader(reader);
+  printf("check passed: %lu games read back in order and %d out of order\n", read, (options.games > 0) ? GAME_ARCHIVE_SEEK_CHECKS : 0);
+  return true;
+}
+
+/**
+ * Reads every game in an archive, printing its size per move, its read speed and the results
+ *
+ * @param path: The path of the archive
+ * @return bool: If every game was read
+ */
+bool GameArchive_Read(const char *path) {
+  static ArchiveReader reader;
+  static ArchiveGame game;
+  struct stat file;
+  unsigned long results[RULES_RESULT_DRAW + 1] = {0, 0, 0, 0};
+
+  if (!Archive_Open(reader, path) || stat(path, &file) != 0) {
+    fprintf(stderr, "could not open %s\n", path);
+    return false;
+  }
+
+  double start = GameArchive_GetTime();
+  unsigned long games = 0;
+  unsigned long long plies = 0;
+  while (Archive_ReadGame(reader, game)) {
+    results[game.result]++;
+    plies += game.ply_count;
+    games++;
+  }
+  double elapsed = GameArchive_GetTime() - start;
+  Archive_CloseReader(reader);
+
+  /* The chunk bytes are only the moves, the header and index are the rest of the file */
+  unsigned long long chunk_bytes = 0;
+  for (unsigned int i = 0; i < reader.chunks.size(); i++) {
+    chunk_bytes += reader.chunks[i].size;
+  }
+
+  printf("games %lu, moves %llu, chunks %lu\n", games, plies, (unsigned long)reader.header.chunk_count);
+  printf("archive %lld bytes, %.2f bits per move, %.1f bytes per game, %.1fx smaller than PDN move text\n", (long long)file.st_size,
+         (plies > 0) ? chunk_bytes * 8.0 / plies : 0.0, (games > 0) ? (double)file.st_size / games : 0.0,
+         (file.st_size > 0) ? (double)plies * GAME_ARCHIVE_TEXT_BYTES / file.st_size : 0.0);
+  printf("read in %.2f s, %.0f games/s, %.0f moves/s\n", elapsed, (elapsed > 0) ? games / elapsed : 0.0,
+         (elapsed > 0) ? plies / elapsed : 0.0);
+  printf("player 1 wins %lu, player 2 wins %lu, draws %lu, unfinished %lu\n", results[1], results[2], results[RULES_RESULT_DRAW],
+         results[RULES_RESULT_NONE]);
+
+  if (games != reader.header.game_count) {
+    fprintf(stderr, "read %lu games of %llu, the archive is damaged\n", games, (unsigned long long)reader.header.game_count);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Prints the moves of one game
+ *
+ * @param path: The path of the archive
+ * @param game_id: The number of the game
+ * @return bool: If the archive has the game
+ */
+bool GameArchive_Show(const char *path, long game_id) {
+  static ArchiveReader reader;
+  static ArchiveGame game;
+  char text[RULES_MOVE_TEXT];
+
+  if (!Archive_Open(reader, path)) {
+    fprintf(stderr, "could not open %s\n", path);
+    return false;
+  }
+  if (!Archive_Seek(reader, game_id) || !Archive_ReadGame(reader, game)) {
+    fprintf(stderr, "%s has no game %ld\n", path, game_id);
+    Archive_CloseReader(reader);
+    return false;
+  }
+  Archive_CloseReader(reader);
+
+  printf("game %ld, result %d, moves %d\n", game_id, game.result, game.ply_count);
+  for (int i = 0; i < game.ply_count; i++) {
+    Rules_FormatMove(game.plies[i], text);
+    printf("%s\n", text);
+  }
+  return true;
+}
+
+/**
+ * Writes every game in an archive as PDN text
+ *
+ * @param path: The path of the archive
+ * @param pdn_path: The path of the PDN file
+ * @return bool: If every game was written
+ */
+bool GameArchive_Export(const char *path, const char *pdn_path) {
+  static ArchiveReader reader;
+  static ArchiveGame game;
+
+  if (!Archive_Open(reader, path)) {
+    fprintf(stderr, "could not open %s\n", path);
+    return false;
+  }
+  FILE *file = fopen(pdn_path, "w");
+  if (file == 0) {
+    fprintf(stderr, "could not create %s\n", pdn_path);
+    Archive_CloseReader(reader);
+    return false;
+  }
+
+  unsigned long games = 0;
+  bool written = true;
+  while (written && Archive_ReadGame(reader, game)) {
+    written = Pdn_WriteGame(file, game);
+    games++;
+  }
+  Archive_CloseReader(reader);
+  written = (fclose(file) == 0) && written;
+
+  if (!written || games != reader.header.game_count) {
+    fprintf(stderr, "could not write game %lu to %s\n", games - (written ? 0 : 1), pdn_path);
+    return false;
+  }
+  printf("wrote %lu games to %s\n", games, pdn_path);
+  return true;
+}
+
+/**
+ * Entry point, writes and checks an archive of random games or reads one
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if everything asked for worked, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  GameArchiveOptions options;
+  if (!GameArchive_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s -w <archive> [-g games] [-s seed] [-c chunk games] [-t]\n", argv[0]);
+    fprintf(stderr, "       %s -r <archive> [-x game | -p pdn]\n", argv[0]);
+    return 2;
+  }
+
+  bool passed = true;
+  if (options.write_path != 0) {
+    passed = GameArchive_Write(options) && (!options.check || GameArchive_Check(options));
+  }
+  if (passed && options.read_path != 0) {
+    if (options.pdn_path != 0) {
+      passed = GameArchive_Export(options.read_path, options.pdn_path);
+    }
+    else {
+      passed = (options.show_game >= 0) ? GameArchive_Show(options.read_path, options.show_game) : GameArchive_Read(options.read_path);
+    }
+  }
+  return passed ? 0 : 1;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool GameArchive_ParseOptions(int argc, char *argv[], GameArchiveOptions &options) {
+  options.write_path = 0;
+  options.read_path = 0;
+  options.pdn_path = 0;
+  options.games = 1000;
+  options.seed = 1;
+  options.chunk_games = ARCHIVE_CHUNK_GAMES;
+  options.show_game = -1;
+  options.check = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "w:r:p:g:s:c:x:t")) != -1) {
+    switch (option) {
+      case 'w':
+        options.write_path = optarg;
+        break;
+      case 'r':
+        options.read_path = optarg;
+        break;
+      case 'p':
+        options.pdn_path = optarg;
+        break;
+      case 'g':
+        options.games = strtoul(optarg, 0, 10);
+        break;
+      case 's':
+        options.seed = strtoul(optarg, 0, 10);
+        break;
+      case 'c':
+        options.chunk_games = strtoul(optarg, 0, 10);
+        break;
+      case 'x':
+        options.show_game = atol(optarg);
+        break;
+      case 't':
+        options.check = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return (options.write_path != 0 || options.read_path != 0) && options.chunk_games > 0 && (!options.check || options.write_path != 0) &&
+         (options.pdn_path == 0 || options.read_path != 0);
+}
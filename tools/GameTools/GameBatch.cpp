@@ -0,0 +1,327 @@
+/************************************************************
+ * @file GameBatch.cpp
+ * @brief Plays many random games at once with the batch engine, and compares its speed with playing one game at a time
+ *
+ * @note Every game picks a random legal move each step, and starts again once it is won or reaches the most moves. The
+ *       same games are played by a loop over Checkers objects (the way the other tools play), by the batch engine's
+ *       scalar kernel and by its vector kernel, each for the same time. The check plays the batch engine in lockstep
+ *       with Checkers objects, with some moves that are not legal mixed in, and fails on any difference.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Batch.h"
+#include "Checkers.h"
+#include "Move.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define GAME_BATCH_GAMES       (4096) /* The games played at once unless asked for otherwise */
+#define GAME_BATCH_MAX_PLIES   (200)  /* The most moves in a game unless asked for otherwise */
+#define GAME_BATCH_SECONDS     (2)    /* The time each way of playing runs for unless asked for otherwise (s) */
+#define GAME_BATCH_SEED        (1)    /* The seed for the random moves unless asked for otherwise */
+#define GAME_BATCH_CHECK_STEPS (1000) /* The steps the check plays */
+#define GAME_BATCH_JUNK        (8)    /* One in this many moves the check plays is a random pair of squares */
+#define GAME_BATCH_RELOAD      (64)   /* One in this many games the check reloads from a snapshot each step */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct GameBatchOptions {
+  size_t   games;     /* The games played at once */
+  int      max_plies; /* The most moves in a game */
+  double   seconds;   /* The time each way of playing runs for (s) */
+  uint32_t seed;      /* The seed for the random moves */
+  bool     check;     /* Indicator for if the batch engine is checked against Checkers objects */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double GameBatch_GetTime();
+double GameBatch_PlayObjects(const GameBatchOptions &options, uint64_t &positions);
+double GameBatch_PlayBatch(const GameBatchOptions &options, bool simd, uint64_t &positions);
+bool   GameBatch_Compare(const BatchGames &batch, size_t game, Checkers &check);
+bool   GameBatch_Check(const GameBatchOptions &options, bool simd);
+bool   GameBatch_ParseOptions(int argc, char *argv[], GameBatchOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double GameBatch_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Plays random games one Checkers object at a time
+ *
+ * @param options: The settings
+ * @param positions: The moves played
+ * @return double: The time taken (s)
+ */
+double GameBatch_PlayObjects(const GameBatchOptions &options, uint64_t &positions) {
+  std::vector<Checkers> games(options.games);
+  std::vector<int> plies(options.games, 0);
+  uint32_t state = options.seed;
+  Move moves[RULES_MAX_MOVES];
+
+  positions = 0;
+  double start = GameBatch_GetTime();
+  double elapsed;
+  do {
+    for (size_t i = 0; i < options.games; i++) {
+      int move_count = Rules_GetLegalMoves(games[i], moves);
+      if (move_count == 0 || plies[i] >= options.max_plies) {
+        games[i] = Checkers();
+        plies[i] = 0;
+        continue;
+      }
+      games[i].Checkers_Turn(moves[Rules_Random(state) % move_count]);
+      plies[i]++;
+      positions++;
+    }
+    elapsed = GameBatch_GetTime() - start;
+  } while (elapsed < options.seconds);
+  return elapsed;
+}
+
+/**
+ * Plays random games with the batch engine
+ *
+ * @param options: The settings
+ * @param simd: Indicator for if the vector kernel is used
+ * @param positions: The moves played
+ * @return double: The time taken (s)
+ */
+double GameBatch_PlayBatch(const GameBatchOptions &options, bool simd, uint64_t &positions) {
+  BatchGames batch;
+  std::vector<Move> moves(options.games);
+  std::vector<uint8_t> played(options.games);
+  std::vector<int> plies(options.games, 0);
+  uint32_t state = options.seed;
+
+  Batch_Init(batch, options.games);
+  positions = 0;
+  double start = GameBatch_GetTime();
+  double elapsed;
+  do {
+    Batch_Generate(batch, simd);
+    for (size_t i = 0; i < options.games; i++) {
+      int move_count = Batch_CountMoves(batch, i);
+      bool over = move_count == 0 || plies[i] >= options.max_plies;
+      moves[i] = over ? Move_Make(SQUARE_NONE, SQUARE_NONE) : Batch_GetMove(batch, i, Rules_Random(state) % move_count);
+    }
+    Batch_Play(batch, &moves[0], &played[0], simd);
+
+    /* The games that were over start again, once the moves are played so the movers stay up to date until then */
+    for (size_t i = 0; i < options.games; i++) {
+      if (moves[i].from == SQUARE_NONE) {
+        Batch_Reset(batch, i);
+        plies[i] = 0;
+      }
+      plies[i] += played[i];
+      positions += played[i];
+    }
+    elapsed = GameBatch_GetTime() - start;
+  } while (elapsed < options.seconds);
+  return elapsed;
+}
+
+/**
+ * Compares a game of the batch with a Checkers object
+ *
+ * @param batch: The games
+ * @param game: The game
+ * @param check: The object playing the same game
+ * @return bool: If they are the same
+ */
+bool GameBatch_Compare(const BatchGames &batch, size_t game, Checkers &check) {
+  CheckersSnapshot expected;
+  CheckersSnapshot actual;
+  check.Checkers_Save(expected);
+  Batch_Save(batch, game, actual);
+  return memcmp(&expected, &actual, sizeof(expected)) == 0;
+}
+
+/**
+ * Plays the batch engine in lockstep with Checkers objects and compares them every step
+ *
+ * @param options: The settings
+ * @param simd: Indicator for if the vector kernel is used
+ * @return bool: If they never differed
+ */
+bool GameBatch_Check(const GameBatchOptions &options, bool simd) {
+  BatchGames batch;
+  std::vector<Checkers> games(options.games);
+  std::vector<Move> moves(options.games);
+  std::vector<uint8_t> played(options.games);
+  std::vector<int> plies(options.games, 0);
+  uint32_t state = options.seed;
+  uint64_t move_total = 0;
+  uint64_t rejected = 0;
+  uint64_t differences = 0;
+  Move expected[RULES_MAX_MOVES];
+  Move actual[RULES_MAX_MOVES];
+
+  Batch_Init(batch, options.games);
+  for (int step = 0; step < GAME_BATCH_CHECK_STEPS; step++) {
+    /* The legal moves have to be the same, in the same order */
+    Batch_Generate(batch, simd);
+    for (size_t i = 0; i < options.games; i++) {
+      int move_count = Rules_GetLegalMoves(games[i], expected);
+      bool same = Batch_GetMoves(batch, i, actual) == move_count && Batch_CountMoves(batch, i) == move_count;
+      for (int j = 0; same && j < move_count; j++) {
+        same = actual[j].from == expected[j].from && actual[j].to == expected[j].to;
+      }
+      if (move_count > 0) {
+        same = same && Rules_FindMove(expected, move_count, Batch_GetMove(batch, i, Rules_Random(state) % move_count)) >= 0;
+      }
+      differences += same ? 0 : 1;
+
+      /* Some moves are any two squares, which the batch engine has to reject exactly when Checkers_Turn does */
+      if (move_count == 0 || plies[i] >= options.max_plies) {
+        moves[i] = Move_Make(SQUARE_NONE, SQUARE_NONE);
+      }
+      else if (Rules_Random(state) % GAME_BATCH_JUNK == 0) {
+        moves[i] = Move_Make((Square)(Rules_Random(state) % 64), (Square)(Rules_Random(state) % 64));
+      }
+      else {
+        moves[i] = expected[Rules_Random(state) % move_count];
+      }
+    }
+
+    Batch_Play(batch, &moves[0], &played[0], simd);
+    for (size_t i = 0; i < options.games; i++) {
+      if (moves[i].from == SQUARE_NONE) {
+        games[i] = Checkers();
+        Batch_Reset(batch, i);
+        plies[i] = 0;
+      }
+      else {
+        int valid = games[i].Checkers_Turn(moves[i]);
+        differences += (valid == played[i]) ? 0 : 1;
+        move_total += played[i];
+        rejected += 1 - played[i];
+        plies[i] += played[i];
+      }
+      differences += GameBatch_Compare(batch, i, games[i]) ? 0 : 1;
+
+      /* Some games go through a snapshot, which has to give back the same game if Checkers_Load takes it (a game won
+         by a jump keeps a square to jump from that no longer holds a piece, which it does not take) */
+      if (Rules_Random(state) % GAME_BATCH_RELOAD == 0) {
+        CheckersSnapshot snapshot;
+        Checkers reloaded;
+        games[i].Checkers_Save(snapshot);
+        bool loaded = reloaded.Checkers_Load(snapshot);
+        differences += (Batch_Load(batch, i, snapshot) == loaded && GameBatch_Compare(batch, i, games[i])) ? 0 : 1;
+      }
+    }
+  }
+
+  printf("checked %d steps of %zu games with the %s kernel: %llu moves, %llu rejected, %llu differences\n",
+         GAME_BATCH_CHECK_STEPS, options.games, (simd && Batch_HasSimd()) ? Batch_GetSimdName() : "scalar",
+         (unsigned long long)move_total, (unsigned long long)rejected, (unsigned long long)differences);
+  return differences == 0 && move_total > 0 && rejected > 0;
+}
+
+/**
+ * Entry point, checks the batch engine or measures how fast it plays
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if everything asked for worked, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  GameBatchOptions options;
+  if (!GameBatch_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s [-n games] [-m most moves] [-d seconds] [-s seed] [-t]\n", argv[0]);
+    return 2;
+  }
+
+  if (options.check) {
+    bool passed = GameBatch_Check(options, false);
+    passed = GameBatch_Check(options, true) && passed;
+    return passed ? 0 : 1;
+  }
+
+  /* The rates are compared with the loop over objects, on one core */
+  uint64_t positions;
+  double objects_rate = GameBatch_PlayObjects(options, positions);
+  objects_rate = positions / objects_rate;
+  printf("objects: %llu positions, %.0f positions/s\n", (unsigned long long)positions, objects_rate);
+
+  double scalar_rate = GameBatch_PlayBatch(options, false, positions);
+  scalar_rate = positions / scalar_rate;
+  printf("batch scalar: %llu positions, %.0f positions/s, %.1fx\n", (unsigned long long)positions, scalar_rate, scalar_rate / objects_rate);
+
+  if (Batch_HasSimd()) {
+    double simd_rate = GameBatch_PlayBatch(options, true, positions);
+    simd_rate = positions / simd_rate;
+    printf("batch %s: %llu positions, %.0f positions/s, %.1fx\n", Batch_GetSimdName(), (unsigned long long)positions, simd_rate,
+           simd_rate / objects_rate);
+  }
+  return 0;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool GameBatch_ParseOptions(int argc, char *argv[], GameBatchOptions &options) {
+  options.games = GAME_BATCH_GAMES;
+  options.max_plies = GAME_BATCH_MAX_PLIES;
+  options.seconds = GAME_BATCH_SECONDS;
+  options.seed = GAME_BATCH_SEED;
+  options.check = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "n:m:d:s:t")) != -1) {
+    switch (option) {
+      case 'n':
+        options.games = strtoul(optarg, 0, 10);
+        break;
+      case 'm':
+        options.max_plies = atoi(optarg);
+        break;
+      case 'd':
+        options.seconds = atof(optarg);
+        break;
+      case 's':
+        options.seed = strtoul(optarg, 0, 10);
+        break;
+      case 't':
+        options.check = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  /* The random numbers are xorshift, which never leaves 0 */
+  return options.games > 0 && options.max_plies > 0 && options.seconds > 0 && options.seed != 0;
+}
@@ -0,0 +1,435 @@
+/************************************************************
+ * @file GameIndex.cpp
+ * @brief Builds a position index over game archives, and queries it for the games that reached a position
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Archive.h"
+#include "Checkers.h"
+#include "Index.h"
+#include "Move.h"
+#include "Pdn.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define GAME_INDEX_SHOWN          (10)  /* The games printed by a query unless asked for otherwise */
+#define GAME_INDEX_POSTING_CHECKS (200) /* The random positions a check finds in the index */
+#define GAME_INDEX_COUNT_CHECKS   (20)  /* The random positions a check counts every posting of by reading every game */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct GameIndexOptions {
+  const char               *build_path; /* The index to build (0 to not build one) */
+  const char               *query_path; /* The index to query (0 to not query one) */
+  std::vector<const char *> archives;   /* The archives to build the index over */
+  unsigned int              threads;    /* The threads to build with */
+  const char               *fen;        /* The position to query as a FEN (0 for a new game) */
+  const char               *moves;      /* The moves to play before the query, such as "F2 E3,C1 D2" (0 for none) */
+  unsigned long             shown;      /* The games printed by a query */
+  bool                      check;      /* Indicator for if the index built is checked against the archives */
+};
+
+/* The games that played a move from the position queried */
+struct GameIndexMove {
+  Move     move;       /* The move, SQUARE_NONE to SQUARE_NONE for games that ended there */
+  uint64_t count;      /* The times it was played */
+  uint64_t results[4]; /* The results of the games it was played in */
+};
+
+/* A position picked for a check */
+struct GameIndexSample {
+  uint32_t game;     /* The index's number of the game */
+  int      ply;      /* The moves played before the position */
+  Move     next;     /* The move played next */
+  uint64_t hash;     /* The hash of the position */
+  uint64_t postings; /* The times the position was reached, counted by reading every game */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double GameIndex_GetTime();
+bool   GameIndex_CompareMoves(const GameIndexMove &first, const GameIndexMove &second);
+bool   GameIndex_Build(const GameIndexOptions &options);
+bool   GameIndex_Check(const GameIndexOptions &options);
+bool   GameIndex_SetUp(const GameIndexOptions &options, Checkers &game);
+bool   GameIndex_Query(const GameIndexOptions &options);
+bool   GameIndex_ParseOptions(int argc, char *argv[], GameIndexOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double GameIndex_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Orders moves by how often they were played
+ *
+ * @param first: The first move
+ * @param second: The second move
+ * @return bool: If the first was played more often
+ */
+bool GameIndex_CompareMoves(const GameIndexMove &first, const GameIndexMove &second) {
+  return first.count > second.count;
+}
+
+/**
+ * Builds the index, printing its size and how long each step took
+ *
+ * @param options: The options
+ * @return bool: If the index was written
+ */
+bool GameIndex_Build(const GameIndexOptions &options) {
+  IndexBuildStats stats;
+  struct stat file;
+
+  double start = GameIndex_GetTime();
+  if (!Index_Build(options.build_path, options.archives, options.threads, stats) || stat(options.build_path, &file) != 0) {
+    fprintf(stderr, "could not build %s\n", options.build_path);
+    return false;
+  }
+  double elapsed = GameIndex_GetTime() - start;
+
+  printf("indexed %llu games, %llu positions, %llu different, with %u threads in %.2f s (read %.2f s, sort %.2f s, write %.2f s)\n",
+         (unsigned long long)stats.games, (unsigned long long)stats.postings, (unsigned long long)stats.positions, options.threads,
+         elapsed, stats.read_time, stats.sort_time, stats.write_time);
+  printf("index %lld bytes, %.1f bytes per position reached\n", (long long)file.st_size,
+         (stats.postings > 0) ? (double)file.st_size / stats.postings : 0.0);
+  return true;
+}
+
+/**
+ * Checks the index built against the archives: random positions from their games have to be found with the game, ply
+ * and move played, and the times some of them were reached have to match a count made by reading every game
+ *
+ * @param options: The options
+ * @return bool: If the index matched
+ */
+bool GameIndex_Check(const GameIndexOptions &options) {
+  static ArchiveReader reader;
+  static ArchiveGame game;
+  IndexReader index;
+  std::vector<GameIndexSample> samples;
+  uint32_t random_state = 1;
+
+  if (!Index_Open(index, options.build_path)) {
+    fprintf(stderr, "could not open %s\n", options.build_path);
+    return false;
+  }
+
+  /* Picks the positions, from random games of every archive */
+  for (int i = 0; i < GAME_INDEX_POSTING_CHECKS && index.header->game_count > 0; i++) {
+    GameIndexSample sample;
+    uint64_t archive_game;
+    sample.game = Rules_Random(random_state) % index.header->game_count;
+    int archive = Index_GetArchive(index, sample.game, archive_game);
+    if (archive < 0 || !Archive_Open(reader, options.archives[archive]) || !Archive_Seek(reader, archive_game) ||
+        !Archive_ReadGame(reader, game)) {
+      fprintf(stderr, "could not read game %lu\n", (unsigned long)sample.game);
+      Index_Close(index);
+      return false;
+    }
+    Archive_CloseReader(reader);
+
+    Checkers replay;
+    Archive_StartGame(game, replay);
+    sample.ply = Rules_Random(random_state) % (game.ply_count + 1);
+    for (int ply = 0; ply < sample.ply; ply++) {
+      replay.Checkers_Turn(game.plies[ply]);
+    }
+    sample.next = (sample.ply < game.ply_count) ? game.plies[sample.ply] : Move_Make(SQUARE_NONE, SQUARE_NONE);
+    sample.hash = Rules_Hash(replay);
+    sample.postings = 0;
+
+    const IndexPosting *postings;
+    uint64_t posting_count;
+    bool found = false;
+    if (Index_Find(index, replay, postings, posting_count)) {
+      for (uint64_t j = 0; j < posting_count && !found; j++) {
+        found = postings[j].game == sample.game && postings[j].ply == sample.ply && postings[j].next.from == sample.next.from &&
+                postings[j].next.to == sample.next.to;
+      }
+    }
+    if (!found) {
+      fprintf(stderr, "game %lu ply %d is not in the index\n", (unsigned long)sample.game, sample.ply);
+      Index_Close(index);
+      return false;
+    }
+    samples.push_back(sample);
+  }
+
+  /* Counts the times the first few were reached by reading every game */
+  size_t counted = std::min(samples.size(), (size_t)GAME_INDEX_COUNT_CHECKS);
+  for (unsigned int i = 0; i < options.archives.size(); i++) {
+    if (!Archive_Open(reader, options.archives[i])) {
+      fprintf(stderr, "could not open %s\n", options.archives[i]);
+      Index_Close(index);
+      return false;
+    }
+    while (Archive_ReadGame(reader, game)) {
+      Checkers replay;
+      Archive_StartGame(game, replay);
+      for (int ply = 0; ply <= game.ply_count; ply++) {
+        uint64_t hash = Rules_Hash(replay);
+        for (size_t j = 0; j < counted; j++) {
+          samples[j].postings += (samples[j].hash == hash) ? 1 : 0;
+        }
+        if (ply < game.ply_count) {
+          replay.Checkers_Turn(game.plies[ply]);
+        }
+      }
+    }
+    Archive_CloseReader(reader);
+  }
+  for (size_t i = 0; i < counted; i++) {
+    Checkers replay;
+    IndexStats stats;
+    const IndexPosting *postings;
+    uint64_t posting_count;
+    uint64_t archive_game;
+    int archive = Index_GetArchive(index, samples[i].game, archive_game);
+    Archive_Open(reader, options.archives[archive]);
+    Archive_Seek(reader, archive_game);
+    Archive_ReadGame(reader, game);
+    Archive_CloseReader(reader);
+    Archive_StartGame(game, replay);
+    for (int ply = 0; ply < samples[i].ply; ply++) {
+      replay.Checkers_Turn(game.plies[ply]);
+    }
+    Index_Find(index, replay, postings, posting_count);
+    Index_GetStats(index, postings, posting_count, stats);
+    if (posting_count != samples[i].postings || stats.games == 0 || stats.games > posting_count) {
+      fprintf(stderr, "game %lu ply %d was reached %llu times, the index has %llu\n", (unsigned long)samples[i].game, samples[i].ply,
+              (unsigned long long)samples[i].postings, (unsigned long long)posting_count);
+      Index_Close(index);
+      return false;
+    }
+  }
+
+  Index_Close(index);
+  printf("check passed: %lu positions found with their game and move, %lu counted against every game\n", (unsigned long)samples.size(),
+         (unsigned long)counted);
+  return true;
+}
+
+/**
+ * Sets up the position to query
+ *
+ * @param options: The options
+ * @param game: The position, from the FEN or a new game, with the moves played
+ * @return bool: If the FEN could be read and every move was legal
+ */
+bool GameIndex_SetUp(const GameIndexOptions &options, Checkers &game) {
+  if (options.fen != 0) {
+    CheckersSnapshot snapshot;
+    if (!Pdn_ReadFen(options.fen, options.fen + strlen(options.fen), snapshot) || !game.Checkers_Load(snapshot)) {
+      fprintf(stderr, "could not set up %s\n", options.fen);
+      return false;
+    }
+  }
+
+  /* The moves are separated by commas, in the same "A1 B2" syntax as the voice commands */
+  const char *text = options.moves;
+  while (text != 0 && *text != '\0') {
+    const char *end = strchr(text, ',');
+    char move_text[RULES_MOVE_TEXT + 1];
+    size_t length = (end != 0) ? (size_t)(end - text) : strlen(text);
+    while (length > 0 && *text == ' ') {
+      text++;
+      length--;
+    }
+
+    Move move;
+    bool played = length <= RULES_MOVE_TEXT;
+    if (played) {
+      memcpy(move_text, text, length);
+      move_text[length] = '\0';
+      played = Rules_ParseMove(move_text, move) && game.Checkers_Turn(move) == 1;
+    }
+    if (!played) {
+      fprintf(stderr, "could not play %.*s\n", (int)length, text);
+      return false;
+    }
+    text = (end != 0) ? end + 1 : 0;
+  }
+  return true;
+}
+
+/**
+ * Prints the games that reached a position, their results and the moves played next
+ *
+ * @param options: The options
+ * @return bool: If the position could be set up and the index read, a position no game reached is still a query
+ */
+bool GameIndex_Query(const GameIndexOptions &options) {
+  IndexReader index;
+  Checkers game;
+  IndexStats stats;
+  std::vector<GameIndexMove> moves;
+  char text[RULES_MOVE_TEXT];
+
+  if (!GameIndex_SetUp(options, game)) {
+    return false;
+  }
+  if (!Index_Open(index, options.query_path)) {
+    fprintf(stderr, "could not open %s\n", options.query_path);
+    return false;
+  }
+
+  /* The query is timed from the board to the moves played next, the file already mapped */
+  double start = GameIndex_GetTime();
+  const IndexPosting *postings;
+  uint64_t posting_count;
+  Index_Find(index, game, postings, posting_count);
+  Index_GetStats(index, postings, posting_count, stats);
+  for (uint64_t i = 0; i < posting_count; i++) {
+    unsigned int j = 0;
+    while (j < moves.size() && (moves[j].move.from != postings[i].next.from || moves[j].move.to != postings[i].next.to)) {
+      j++;
+    }
+    if (j == moves.size()) {
+      GameIndexMove move;
+      memset(&move, 0, sizeof(move));
+      move.move = postings[i].next;
+      moves.push_back(move);
+    }
+    moves[j].count++;
+    moves[j].results[index.results[postings[i].game] & 3]++;
+  }
+  std::sort(moves.begin(), moves.end(), GameIndex_CompareMoves);
+  double elapsed = GameIndex_GetTime() - start;
+
+  printf("position %016llx reached %llu times in %llu games of %llu\n", (unsigned long long)Rules_Hash(game),
+         (unsigned long long)stats.postings, (unsigned long long)stats.games, (unsigned long long)index.header->game_count);
+  if (stats.games > 0) {
+    printf("player 1 wins %llu (%.1f%%), player 2 wins %llu (%.1f%%), draws %llu, unfinished %llu\n", (unsigned long long)stats.results[1],
+           100.0 * stats.results[1] / stats.games, (unsigned long long)stats.results[2], 100.0 * stats.results[2] / stats.games,
+           (unsigned long long)stats.results[RULES_RESULT_DRAW], (unsigned long long)stats.results[RULES_RESULT_NONE]);
+  }
+  for (unsigned int i = 0; i < moves.size(); i++) {
+    if (moves[i].move.from == SQUARE_NONE) {
+      snprintf(text, sizeof(text), "end");
+    }
+    else {
+      Rules_FormatMove(moves[i].move, text);
+    }
+    printf("  %-5s %8llu times, player 1 wins %5.1f%%, player 2 wins %5.1f%%\n", text, (unsigned long long)moves[i].count,
+           100.0 * moves[i].results[1] / moves[i].count, 100.0 * moves[i].results[2] / moves[i].count);
+  }
+  for (uint64_t i = 0; i < posting_count && i < options.shown; i++) {
+    uint64_t archive_game;
+    int archive = Index_GetArchive(index, postings[i].game, archive_game);
+    printf("  %s game %llu ply %u\n", (archive >= 0) ? index.archives[archive].name : "?", (unsigned long long)archive_game,
+           (unsigned int)postings[i].ply);
+  }
+  printf("found in %.3f ms\n", elapsed * 1000);
+
+  Index_Close(index);
+  return true;
+}
+
+/**
+ * Entry point, builds a position index or queries one
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if everything asked for worked, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  GameIndexOptions options;
+  if (!GameIndex_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s -b <index> -a <archive> [-a archive...] [-j threads] [-t]\n", argv[0]);
+    fprintf(stderr, "       %s -q <index> [-f fen] [-m \"F2 E3,C1 D2\"] [-l games shown]\n", argv[0]);
+    return 2;
+  }
+
+  bool passed = true;
+  if (options.build_path != 0) {
+    passed = GameIndex_Build(options) && (!options.check || GameIndex_Check(options));
+  }
+  if (passed && options.query_path != 0) {
+    passed = GameIndex_Query(options);
+  }
+  return passed ? 0 : 1;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool GameIndex_ParseOptions(int argc, char *argv[], GameIndexOptions &options) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  options.build_path = 0;
+  options.query_path = 0;
+  options.archives.clear();
+  options.threads = (cores > 0) ? (unsigned int)cores : 1;
+  options.fen = 0;
+  options.moves = 0;
+  options.shown = GAME_INDEX_SHOWN;
+  options.check = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "b:q:a:j:f:m:l:t")) != -1) {
+    switch (option) {
+      case 'b':
+        options.build_path = optarg;
+        break;
+      case 'q':
+        options.query_path = optarg;
+        break;
+      case 'a':
+        options.archives.push_back(optarg);
+        break;
+      case 'j':
+        options.threads = strtoul(optarg, 0, 10);
+        break;
+      case 'f':
+        options.fen = optarg;
+        break;
+      case 'm':
+        options.moves = optarg;
+        break;
+      case 'l':
+        options.shown = strtoul(optarg, 0, 10);
+        break;
+      case 't':
+        options.check = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return (options.build_path != 0 || options.query_path != 0) && (options.build_path == 0 || !options.archives.empty()) &&
+         options.threads > 0 && options.archives.size() <= INDEX_MAX_ARCHIVES;
+}
@@ -0,0 +1,421 @@
+/************************************************************
+ * @file GameMcts.cpp
+ * @brief Searches a position with the Monte Carlo tree search on many threads, or plays it against the alpha-beta search
+ *
+ * @note A search prints its best move, the playouts per second and the memory its tree took. A match plays the two
+ *       searches against each other from a few random opening moves, each side of every opening in turn, so their
+ *       playing styles can be compared on the same positions. The check grows trees on many threads and walks them
+ *       for nodes that do not add up, then plays the tree search against random moves
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Mcts.h"
+#include "Move.h"
+#include "Pdn.h"
+#include "Rules.h"
+#include "Search.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define GAME_MCTS_POOL_MB        (64)    /* The size of the node pool unless asked for otherwise (MB) */
+#define GAME_MCTS_SECONDS        (1)     /* The time each search takes unless asked for otherwise (s) */
+#define GAME_MCTS_DEPTH          (5)     /* The depth the alpha-beta search plays a match at unless asked for otherwise */
+#define GAME_MCTS_OPENING_PLIES  (4)     /* The random moves each match game starts with */
+#define GAME_MCTS_MAX_PLIES      (200)   /* The most moves of a match game, a draw if it gets that far */
+#define GAME_MCTS_CHECK_PLAYOUTS (20000) /* The playouts of the check's searches on many threads */
+#define GAME_MCTS_CHECK_THREADS  (8)     /* The threads of those searches */
+#define GAME_MCTS_CHECK_NODES    (100)   /* The nodes of the small pool the check fills up */
+#define GAME_MCTS_CHECK_GAMES    (6)     /* The games the check plays against random moves */
+#define GAME_MCTS_CHECK_WINS     (5)     /* The least of them the tree search has to win */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct GameMctsOptions {
+  MctsSettings  settings; /* The settings of each search */
+  unsigned long pool_mb;  /* The size of the node pool (MB) */
+  const char   *fen;      /* The position to search as a FEN (0 for a new game) */
+  const char   *moves;    /* The moves to play from it, such as "F2 E3,C1 D2" (0 for none) */
+  int           games;    /* The games to play against the alpha-beta search (0 to search the position) */
+  int           depth;    /* The depth the alpha-beta search plays at */
+  bool          check;    /* Indicator for if the search is checked instead */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+bool GameMcts_SetUp(const GameMctsOptions &options, Checkers &game);
+void GameMcts_Print(const MctsResult &result, unsigned int threads);
+int  GameMcts_PlayGame(MctsTree &tree, const MctsSettings &settings, int depth, int mcts_player, uint32_t &state, MctsResult &total);
+bool GameMcts_Match(const GameMctsOptions &options, MctsTree &tree);
+bool GameMcts_CheckNode(const MctsTree &tree, uint32_t index, Checkers &game, int depth);
+bool GameMcts_CheckTree(const MctsTree &tree, Checkers &game, uint64_t playouts);
+bool GameMcts_Check(const GameMctsOptions &options, MctsTree &tree);
+bool GameMcts_ParseOptions(int argc, char *argv[], GameMctsOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Sets up the position to search from the FEN and moves given
+ *
+ * @param options: The settings
+ * @param game: The position
+ * @return bool: If the FEN and every move could be read and played
+ */
+bool GameMcts_SetUp(const GameMctsOptions &options, Checkers &game) {
+  game = Checkers();
+  if (options.fen != 0) {
+    CheckersSnapshot snapshot;
+    if (!Pdn_ReadFen(options.fen, options.fen + strlen(options.fen), snapshot) || !game.Checkers_Load(snapshot)) {
+      fprintf(stderr, "could not set up %s\n", options.fen);
+      return false;
+    }
+  }
+
+  /* The moves are separated by commas, in the same "A1 B2" syntax as the voice commands */
+  const char *text = options.moves;
+  while (text != 0 && *text != '\0') {
+    const char *end = strchr(text, ',');
+    char move_text[RULES_MOVE_TEXT + 1];
+    size_t length = (end != 0) ? (size_t)(end - text) : strlen(text);
+    while (length > 0 && *text == ' ') {
+      text++;
+      length--;
+    }
+    Move move;
+    if (length > RULES_MOVE_TEXT) {
+      fprintf(stderr, "could not read %.*s\n", (int)length, text);
+      return false;
+    }
+    memcpy(move_text, text, length);
+    move_text[length] = '\0';
+    if (!Rules_ParseMove(move_text, move) || game.Checkers_Turn(move) != 1) {
+      fprintf(stderr, "could not play %s\n", move_text);
+      return false;
+    }
+    text = (end != 0) ? end + 1 : 0;
+  }
+  return true;
+}
+
+/**
+ * Prints the result of a search
+ *
+ * @param result: The result
+ * @param threads: The threads it ran on
+ */
+void GameMcts_Print(const MctsResult &result, unsigned int threads) {
+  char move_text[RULES_MOVE_TEXT];
+  Rules_FormatMove(result.best, move_text);
+  printf("best %s, scored %.3f over %llu of %llu playouts\n", move_text, result.value, (unsigned long long)result.best_visits,
+         (unsigned long long)result.playouts);
+  printf("%.2f s on %u threads: %.0f playouts per s, %.1f moves each\n", result.seconds, threads, result.playouts / result.seconds,
+         (result.playouts != 0) ? (double)result.playout_plies / result.playouts : 0.0);
+  printf("tree: %u nodes of %u bytes, %.1f MB of a %.1f MB pool\n", result.nodes, (unsigned int)sizeof(MctsNode), result.memory / 1048576.0,
+         result.pool_memory / 1048576.0);
+}
+
+/**
+ * Plays a game of the tree search against the alpha-beta search, or against random moves
+ *
+ * @param tree: The tree search's node pool
+ * @param settings: The tree search's settings
+ * @param depth: The depth of the alpha-beta search, 0 for random moves
+ * @param mcts_player: The player the tree search plays, 1 or 2
+ * @param state: The state of the random number generator, for the opening and random moves
+ * @param total: The tree search's playouts and time are added to this
+ * @return int: The winner, 1 or 2, 0 for a draw
+ */
+int GameMcts_PlayGame(MctsTree &tree, const MctsSettings &settings, int depth, int mcts_player, uint32_t &state, MctsResult &total) {
+  Move moves[RULES_MAX_MOVES];
+  Checkers game;
+
+  for (int ply = 0; ply < GAME_MCTS_MAX_PLIES; ply++) {
+    int move_count = Rules_GetLegalMoves(game, moves);
+    if (move_count == 0) {
+      /* Once a game is won the active player is the winner, and a player left without a move has lost */
+      return (game.Checkers_GetWin() != 0) ? game.Checkers_GetActivePlayer() : 3 - game.Checkers_GetActivePlayer();
+    }
+
+    Move move = moves[Rules_Random(state) % move_count];
+    if (ply >= GAME_MCTS_OPENING_PLIES && game.Checkers_GetActivePlayer() == mcts_player) {
+      MctsResult result;
+      Mcts_Analyse(tree, game, settings, result);
+      move = result.best;
+      total.playouts += result.playouts;
+      total.playout_plies += result.playout_plies;
+      total.seconds += result.seconds;
+    }
+    else if (ply >= GAME_MCTS_OPENING_PLIES && depth > 0) {
+      SearchResult result;
+      Search_Analyse(game, depth, 0, 0, result);
+      move = result.best;
+    }
+    game.Checkers_Turn(move);
+  }
+  return 0;
+}
+
+/**
+ * Plays the tree search against the alpha-beta search, each side of every opening in turn
+ *
+ * @param options: The settings
+ * @param tree: The tree search's node pool
+ * @return bool: If the tree search did not lose more games than it won
+ */
+bool GameMcts_Match(const GameMctsOptions &options, MctsTree &tree) {
+  MctsResult total;
+  int outcomes[3] = {0, 0, 0};
+  memset(&total, 0, sizeof(total));
+
+  for (int i = 0; i < options.games; i++) {
+    /* Both games of a pair start from the same opening */
+    uint32_t state = (uint32_t)Rules_Mix(((uint64_t)options.settings.seed << 16) + i / 2) | 1;
+    int mcts_player = 1 + i % 2;
+    int winner = GameMcts_PlayGame(tree, options.settings, options.depth, mcts_player, state, total);
+    int outcome = (winner == 0) ? 1 : (winner == mcts_player) ? 0 : 2;
+    outcomes[outcome]++;
+    printf("game %d: the tree search as player %d %s\n", i + 1, mcts_player, (outcome == 0) ? "won" : (outcome == 1) ? "drew" : "lost");
+    fflush(stdout);
+  }
+
+  printf("the tree search won %d, drew %d and lost %d against depth %d, at %.0f playouts per s\n", outcomes[0], outcomes[1], outcomes[2],
+         options.depth, (total.seconds > 0) ? total.playouts / total.seconds : 0.0);
+  return outcomes[0] >= outcomes[2];
+}
+
+/**
+ * Checks a node of a tree and everything below it
+ *
+ * @param tree: The tree
+ * @param index: The node
+ * @param game: The node's position
+ * @param depth: The moves from the root
+ * @return bool: If the children are the legal moves and the visits and points add up
+ */
+bool GameMcts_CheckNode(const MctsTree &tree, uint32_t index, Checkers &game, int depth) {
+  Move moves[RULES_MAX_MOVES];
+  const MctsNode &node = tree.nodes[index];
+  if (node.visits < 0 || node.points > 2 * (uint32_t)node.visits || depth > MCTS_MAX_DEPTH) {
+    return false;
+  }
+  if (node.first_child == MCTS_NODE_NONE) {
+    return node.child_count == 0;
+  }
+
+  int move_count = Rules_GetLegalMoves(game, moves);
+  if (move_count != node.child_count || node.first_child + node.child_count > tree.nodes.size()) {
+    return false;
+  }
+  int64_t child_visits = 0;
+  for (int i = 0; i < move_count; i++) {
+    const MctsNode &child = tree.nodes[node.first_child + i];
+    Checkers next = game;
+    next.Checkers_Turn(child.move);
+    if (child.move.from != moves[i].from || child.move.to != moves[i].to || child.mover != game.Checkers_GetActivePlayer() ||
+        !GameMcts_CheckNode(tree, node.first_child + i, next, depth + 1)) {
+      return false;
+    }
+    child_visits += child.visits;
+  }
+  return child_visits <= node.visits;
+}
+
+/**
+ * Checks a whole tree after a search
+ *
+ * @param tree: The tree
+ * @param game: The position searched
+ * @param playouts: The playouts the search played
+ * @return bool: If every virtual loss was taken back and every node adds up
+ */
+bool GameMcts_CheckTree(const MctsTree &tree, Checkers &game, uint64_t playouts) {
+  Checkers root = game;
+  return (uint64_t)tree.nodes[0].visits == playouts && GameMcts_CheckNode(tree, 0, root, 0);
+}
+
+/**
+ * Checks the search against the known answers
+ *
+ * @param options: The settings
+ * @param tree: The node pool
+ * @return bool: If every check passed
+ */
+bool GameMcts_Check(const GameMctsOptions &options, MctsTree &tree) {
+  MctsSettings settings = options.settings;
+  MctsResult first;
+  MctsResult second;
+  Checkers game;
+  if (!GameMcts_SetUp(options, game)) {
+    return false;
+  }
+
+  /* One thread grows the same tree every time */
+  settings.threads = 1;
+  settings.playouts = GAME_MCTS_CHECK_PLAYOUTS / 4;
+  settings.seconds = 0;
+  bool repeated = Mcts_Analyse(tree, game, settings, first) && Mcts_Analyse(tree, game, settings, second) &&
+                  first.best.from == second.best.from && first.best.to == second.best.to && first.best_visits == second.best_visits &&
+                  first.nodes == second.nodes && first.playout_plies == second.playout_plies && GameMcts_CheckTree(tree, game, settings.playouts);
+
+  /* Many threads play exactly the playouts asked for, and take back every virtual loss */
+  settings.threads = GAME_MCTS_CHECK_THREADS;
+  settings.playouts = GAME_MCTS_CHECK_PLAYOUTS;
+  bool threaded = true;
+  for (int policy = MCTS_POLICY_RANDOM; policy <= MCTS_POLICY_LIGHT; policy++) {
+    settings.policy = policy;
+    threaded = threaded && Mcts_Analyse(tree, game, settings, first) && first.playouts == settings.playouts && !tree.full &&
+               GameMcts_CheckTree(tree, game, settings.playouts);
+  }
+
+  /* A pool too small for the search fills up, and the search still finishes */
+  MctsTree small;
+  Mcts_Init(small, GAME_MCTS_CHECK_NODES);
+  bool full = Mcts_Analyse(small, game, settings, first) && first.playouts == settings.playouts && small.full &&
+              first.nodes <= GAME_MCTS_CHECK_NODES && GameMcts_CheckTree(small, game, settings.playouts);
+
+  /* And it has to beat random moves */
+  MctsResult total;
+  memset(&total, 0, sizeof(total));
+  settings.threads = 1;
+  settings.playouts = 300;
+  int wins = 0;
+  for (int i = 0; i < GAME_MCTS_CHECK_GAMES; i++) {
+    uint32_t state = (uint32_t)Rules_Mix(i + 1) | 1;
+    wins += (GameMcts_PlayGame(tree, settings, 0, 1 + i % 2, state, total) == 1 + i % 2) ? 1 : 0;
+  }
+  bool strong = wins >= GAME_MCTS_CHECK_WINS;
+
+  printf("check %s: repeated searches %s, threaded searches %s, full pool %s, won %d of %d games against random moves\n",
+         (repeated && threaded && full && strong) ? "passed" : "failed", repeated ? "match" : "differ", threaded ? "add up" : "do not add up",
+         full ? "handled" : "not handled", wins, GAME_MCTS_CHECK_GAMES);
+  return repeated && threaded && full && strong;
+}
+
+/**
+ * Entry point, searches a position, plays a match or checks the search
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if everything asked for worked, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  GameMctsOptions options;
+  if (!GameMcts_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s [-f fen] [-m \"F2 E3,C1 D2\"] [-j threads] [-n playouts] [-l seconds] [-p random|light] [-c exploration]\n",
+            argv[0]);
+    fprintf(stderr, "       %*s [-k pool MB] [-s seed] [-g games -d depth] [-t]\n", (int)strlen(argv[0]), "");
+    return 2;
+  }
+
+  MctsTree tree;
+  Mcts_Init(tree, options.pool_mb * 1048576 / sizeof(MctsNode));
+  if (options.check) {
+    return GameMcts_Check(options, tree) ? 0 : 1;
+  }
+  if (options.games > 0) {
+    return GameMcts_Match(options, tree) ? 0 : 1;
+  }
+
+  Checkers game;
+  MctsResult result;
+  if (!GameMcts_SetUp(options, game)) {
+    return 1;
+  }
+  if (!Mcts_Analyse(tree, game, options.settings, result)) {
+    fprintf(stderr, "the game is over, there is no move to search\n");
+    return 1;
+  }
+  GameMcts_Print(result, options.settings.threads);
+  return 0;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool GameMcts_ParseOptions(int argc, char *argv[], GameMctsOptions &options) {
+  Mcts_InitSettings(options.settings);
+  options.settings.threads = std::thread::hardware_concurrency();
+  options.settings.seconds = GAME_MCTS_SECONDS;
+  options.pool_mb = GAME_MCTS_POOL_MB;
+  options.fen = 0;
+  options.moves = 0;
+  options.games = 0;
+  options.depth = GAME_MCTS_DEPTH;
+  options.check = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "f:m:j:n:l:p:c:k:s:g:d:t")) != -1) {
+    switch (option) {
+      case 'f':
+        options.fen = optarg;
+        break;
+      case 'm':
+        options.moves = optarg;
+        break;
+      case 'j':
+        options.settings.threads = strtoul(optarg, 0, 10);
+        break;
+      case 'n':
+        /* A limit of playouts is the only limit, unless a time is given too */
+        options.settings.playouts = strtoull(optarg, 0, 10);
+        options.settings.seconds = 0;
+        break;
+      case 'l':
+        options.settings.seconds = atof(optarg);
+        break;
+      case 'p':
+        if (strcmp(optarg, "random") != 0 && strcmp(optarg, "light") != 0) {
+          return false;
+        }
+        options.settings.policy = (strcmp(optarg, "random") == 0) ? MCTS_POLICY_RANDOM : MCTS_POLICY_LIGHT;
+        break;
+      case 'c':
+        options.settings.exploration = atof(optarg);
+        break;
+      case 'k':
+        options.pool_mb = strtoul(optarg, 0, 10);
+        break;
+      case 's':
+        options.settings.seed = strtoul(optarg, 0, 10);
+        break;
+      case 'g':
+        options.games = atoi(optarg);
+        break;
+      case 'd':
+        options.depth = atoi(optarg);
+        break;
+      case 't':
+        options.check = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  /* The node count is 32 bits, so the pool holds at most 4G nodes */
+  options.settings.threads = (options.settings.threads < 1) ? 1 : options.settings.threads;
+  return options.settings.threads <= MCTS_MAX_THREADS && options.pool_mb >= 1 && options.pool_mb * 1048576 / sizeof(MctsNode) < 0xFFFFFFFFUL &&
+         options.settings.exploration >= 0 && (options.settings.playouts > 0 || options.settings.seconds > 0) && options.games >= 0 &&
+         options.depth >= 1 && options.depth <= SEARCH_MAX_DEPTH;
+}
@@ -0,0 +1,502 @@
+/************************************************************
+ * @file GameNetwork.cpp
+ * @brief Writes, checks and times the learned evaluation, the small quantized network the host search can score with
+ *
+ * @note The material network scores exactly as Search_Evaluate does (men, kings and how far each man has come), from
+ *       a few first layer outputs, so it is a starting point for tuning and a known answer for the checks. The timing
+ *       plays seeded random games and compares working out the accumulators from the whole board with updating them
+ *       move by move, the vector output layer with the plain C one, and the search with and without the network.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+#include "Network.h"
+#include "Rules.h"
+#include "Search.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define GAME_NETWORK_POSITIONS     (4096) /* The positions timed unless asked for otherwise */
+#define GAME_NETWORK_DEPTH         (7)    /* The depth the search is timed at unless asked for otherwise */
+#define GAME_NETWORK_SEED          (1)    /* The seed of the random games unless asked for otherwise */
+#define GAME_NETWORK_MAX_PLIES     (200)  /* The most moves in each random game */
+#define GAME_NETWORK_ROUNDS        (64)   /* The times each position is evaluated when timing */
+#define GAME_NETWORK_SEARCHES      (16)   /* The positions searched when timing the search */
+#define GAME_NETWORK_CHECK_GAMES   (200)  /* The random games the check plays for each network */
+#define GAME_NETWORK_CHECK_RANDOMS (8)    /* The random networks the check tries */
+#define GAME_NETWORK_CHECK_DEPTH   (5)    /* The depth the check compares searches at */
+#define GAME_NETWORK_RANDOM_WEIGHT (64)   /* The largest first layer weight of a random network */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct GameNetworkOptions {
+  const char *weights_path; /* The weight file to time (0 for the material network) */
+  const char *output_path;  /* The file to write the material network to (0 to time instead) */
+  int         positions;    /* The positions timed */
+  int         depth;        /* The depth the search is timed at */
+  uint32_t    seed;         /* The seed of the random games */
+  bool        check;        /* Indicator for if the network code is checked instead of timed */
+};
+
+/* A position with a legal move from it */
+struct GameNetworkPosition {
+  Checkers before; /* The position */
+  Checkers after;  /* The position after the move */
+  Move     move;   /* The move */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double GameNetwork_GetTime();
+void   GameNetwork_MakeMaterial(Network &network);
+void   GameNetwork_MakeRandom(Network &network, uint32_t &state);
+bool   GameNetwork_ReadFile(const char *path, Network &network);
+bool   GameNetwork_WriteFile(const char *path, const Network &network);
+void   GameNetwork_MakePositions(uint32_t seed, int count, std::vector<GameNetworkPosition> &positions);
+bool   GameNetwork_CheckGames(const Network &network, uint32_t &state, bool material);
+bool   GameNetwork_CheckFile(const Network &network);
+bool   GameNetwork_Check(const GameNetworkOptions &options);
+void   GameNetwork_Time(const GameNetworkOptions &options, const Network &network);
+bool   GameNetwork_ParseOptions(int argc, char *argv[], GameNetworkOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double GameNetwork_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Makes the network that scores the same as Search_Evaluate
+ *
+ * @param network: The weights made
+ * @note Its first six outputs count the player's men and kings, the other player's men and kings (10 each), then how
+ *       far the player's men and the other player's men have come (a row each), and the output weighs them as
+ *       Search_Evaluate does. Seen from the player's side, their men are crowned on row 0 and the other men on row 7
+ */
+void GameNetwork_MakeMaterial(Network &network) {
+  memset(&network, 0, sizeof(network));
+  for (int square = 0; square < CHECKERS_SNAPSHOT_SQUARES; square++) {
+    int row = square / 4;
+    network.feature_weights[0 * CHECKERS_SNAPSHOT_SQUARES + square][0] = 10;
+    network.feature_weights[1 * CHECKERS_SNAPSHOT_SQUARES + square][1] = 10;
+    network.feature_weights[2 * CHECKERS_SNAPSHOT_SQUARES + square][2] = 10;
+    network.feature_weights[3 * CHECKERS_SNAPSHOT_SQUARES + square][3] = 10;
+    network.feature_weights[0 * CHECKERS_SNAPSHOT_SQUARES + square][4] = (int16_t)(MOVE_BOARD_SIZE - 1 - row);
+    network.feature_weights[2 * CHECKERS_SNAPSHOT_SQUARES + square][5] = (int16_t)row;
+  }
+
+  const int16_t output_weights[6] = {10, 15, -10, -15, 2, -2};
+  memcpy(network.output_weights, output_weights, sizeof(output_weights));
+}
+
+/**
+ * Makes a network of random weights, which clip often enough to test every path
+ *
+ * @param network: The weights made
+ * @param state: The state of the random number generator
+ */
+void GameNetwork_MakeRandom(Network &network, uint32_t &state) {
+  for (int i = 0; i < NETWORK_INPUTS; i++) {
+    for (int j = 0; j < NETWORK_HIDDEN; j++) {
+      network.feature_weights[i][j] = (int16_t)((int)(Rules_Random(state) % (2 * GAME_NETWORK_RANDOM_WEIGHT + 1)) - GAME_NETWORK_RANDOM_WEIGHT);
+    }
+  }
+  for (int j = 0; j < NETWORK_HIDDEN; j++) {
+    network.hidden_biases[j] = (int16_t)((int)(Rules_Random(state) % (2 * GAME_NETWORK_RANDOM_WEIGHT + 1)) - GAME_NETWORK_RANDOM_WEIGHT);
+  }
+  for (int j = 0; j < 2 * NETWORK_HIDDEN; j++) {
+    network.output_weights[j] = (int16_t)((int)(Rules_Random(state) % 255) - 127);
+  }
+  network.output_bias = (int32_t)(Rules_Random(state) % 2001) - 1000;
+  network.output_shift = 4;
+}
+
+/**
+ * Loads a network from a weight file
+ *
+ * @param path: The path of the weight file
+ * @param network: The weights loaded
+ * @return bool: If it was read and was a weight file
+ */
+bool GameNetwork_ReadFile(const char *path, Network &network) {
+  uint8_t bytes[NETWORK_FILE_SIZE + 1];
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  size_t size = fread(bytes, 1, sizeof(bytes), file);
+  fclose(file);
+  return Network_Load(network, bytes, size);
+}
+
+/**
+ * Writes a network as a weight file
+ *
+ * @param path: The path of the weight file
+ * @param network: The weights
+ * @return bool: If it was written
+ */
+bool GameNetwork_WriteFile(const char *path, const Network &network) {
+  uint8_t bytes[NETWORK_FILE_SIZE];
+  size_t size = Network_Save(network, bytes, sizeof(bytes));
+  FILE *file = fopen(path, "wb");
+  if (size == 0 || file == NULL) {
+    if (file != NULL) {
+      fclose(file);
+    }
+    return false;
+  }
+  bool written = fwrite(bytes, 1, size, file) == size;
+  return (fclose(file) == 0) && written;
+}
+
+/**
+ * Takes positions with a legal move from seeded random games
+ *
+ * @param seed: The seed of the games
+ * @param count: The number of positions
+ * @param positions: The positions taken
+ */
+void GameNetwork_MakePositions(uint32_t seed, int count, std::vector<GameNetworkPosition> &positions) {
+  Move moves[RULES_MAX_MOVES];
+  uint32_t state = seed;
+  Checkers game;
+  int ply = 0;
+
+  positions.clear();
+  while ((int)positions.size() < count) {
+    int move_count = Rules_GetLegalMoves(game, moves);
+    if (move_count == 0 || ply >= GAME_NETWORK_MAX_PLIES) {
+      game = Checkers();
+      ply = 0;
+      continue;
+    }
+
+    GameNetworkPosition position;
+    position.before = game;
+    position.move = moves[Rules_Random(state) % move_count];
+    game.Checkers_Turn(position.move);
+    position.after = game;
+    positions.push_back(position);
+    ply++;
+  }
+}
+
+/**
+ * Plays random games, checking the accumulators updated move by move and taken back against ones worked out from the
+ * whole board, and the vector output layer against the plain C one
+ *
+ * @param network: The weights
+ * @param state: The state of the random number generator
+ * @param material: Indicator for if it is the material network, which also has to score the same as Search_Evaluate
+ * @return bool: If everything matched
+ */
+bool GameNetwork_CheckGames(const Network &network, uint32_t &state, bool material) {
+  Move moves[RULES_MAX_MOVES];
+  bool passed = true;
+
+  for (int i = 0; passed && i < GAME_NETWORK_CHECK_GAMES; i++) {
+    Checkers game;
+    NetworkAccumulator accumulator;
+    NetworkAccumulator expected;
+    Network_Refresh(network, game, accumulator);
+
+    for (int ply = 0; passed && ply < GAME_NETWORK_MAX_PLIES; ply++) {
+      int move_count = Rules_GetLegalMoves(game, moves);
+      if (move_count == 0) {
+        break;
+      }
+
+      /* Every move is made and taken back first, which has to give back the accumulators it started from */
+      Move move = moves[Rules_Random(state) % move_count];
+      Checkers next = game;
+      NetworkChange change;
+      NetworkAccumulator start = accumulator;
+      next.Checkers_Turn(move);
+      Network_Make(network, accumulator, game, next, move, change);
+      Network_Unmake(network, accumulator, change);
+      passed = memcmp(&start, &accumulator, sizeof(start)) == 0;
+      Network_Make(network, accumulator, game, next, move, change);
+      game = next;
+
+      Network_Refresh(network, game, expected);
+      int player = game.Checkers_GetActivePlayer();
+      int score = Network_Evaluate(network, accumulator, player);
+      passed = passed && memcmp(&expected, &accumulator, sizeof(expected)) == 0 && score == Network_EvaluatePlain(network, accumulator, player) &&
+               score == Network_Evaluate(network, accumulator, player);
+      passed = passed && (!material || score == Search_Evaluate(game));
+    }
+  }
+  return passed;
+}
+
+/**
+ * Checks the weight file: a network has to load back the same, and a damaged or wrong file must not load
+ *
+ * @param network: The weights, which have to be in range for the file
+ * @return bool: If every file was loaded or refused as it should have been
+ */
+bool GameNetwork_CheckFile(const Network &network) {
+  static uint8_t bytes[NETWORK_FILE_SIZE];
+  static Network loaded;
+  static Network unchanged;
+
+  bool passed = Network_Save(network, bytes, sizeof(bytes)) == NETWORK_FILE_SIZE && Network_Load(loaded, bytes, sizeof(bytes)) &&
+                memcmp(&loaded, &network, sizeof(network)) == 0;
+  passed = passed && Network_Save(network, bytes, sizeof(bytes) - 1) == 0 && !Network_Load(loaded, bytes, sizeof(bytes) - 1);
+
+  /* A flipped bit anywhere is caught, and leaves the weights as they were */
+  unchanged = loaded;
+  for (size_t i = 0; passed && i < sizeof(bytes); i += 97) {
+    bytes[i] ^= 0x10;
+    passed = !Network_Load(loaded, bytes, sizeof(bytes)) && memcmp(&loaded, &unchanged, sizeof(loaded)) == 0;
+    bytes[i] ^= 0x10;
+  }
+
+  /* A weight out of range is not written */
+  loaded = network;
+  loaded.feature_weights[NETWORK_INPUTS - 1][NETWORK_HIDDEN - 1] = NETWORK_MAX_WEIGHT + 1;
+  passed = passed && Network_Save(loaded, bytes, sizeof(bytes)) == 0;
+  loaded = network;
+  loaded.output_weights[0] = 128;
+  passed = passed && Network_Save(loaded, bytes, sizeof(bytes)) == 0;
+  return passed;
+}
+
+/**
+ * Checks the network code against the known answers
+ *
+ * @param options: The settings
+ * @return bool: If every check passed
+ */
+bool GameNetwork_Check(const GameNetworkOptions &options) {
+  static Network material;
+  static Network random;
+  uint32_t state = options.seed;
+
+  GameNetwork_MakeMaterial(material);
+  bool games = GameNetwork_CheckGames(material, state, true);
+  bool files = GameNetwork_CheckFile(material);
+  for (int i = 0; i < GAME_NETWORK_CHECK_RANDOMS; i++) {
+    GameNetwork_MakeRandom(random, state);
+    games = GameNetwork_CheckGames(random, state, false) && games;
+    files = GameNetwork_CheckFile(random) && files;
+  }
+
+  /* The search scoring with the material network has to search exactly the same tree as scoring by the pieces */
+  std::vector<GameNetworkPosition> positions;
+  GameNetwork_MakePositions(options.seed, GAME_NETWORK_SEARCHES * 8, positions);
+  bool searches = true;
+  for (size_t i = 0; i < positions.size(); i += 8) {
+    SearchResult pieces;
+    SearchResult network;
+    Search_Analyse(positions[i].before, GAME_NETWORK_CHECK_DEPTH, 0, 0, pieces);
+    Search_Analyse(positions[i].before, GAME_NETWORK_CHECK_DEPTH, 0, &material, network);
+    searches = searches && pieces.score == network.score && pieces.nodes == network.nodes && pieces.best.from == network.best.from &&
+               pieces.best.to == network.best.to;
+  }
+
+  printf("check %s (%s): accumulators and evaluations %s, weight files %s, searches %s\n", (games && files && searches) ? "passed" : "failed",
+         Network_GetSimdName(), games ? "match" : "differ", files ? "load as they should" : "do not load as they should",
+         searches ? "match" : "differ");
+  return games && files && searches;
+}
+
+/**
+ * Times the network against scoring by the pieces
+ *
+ * @param options: The settings
+ * @param network: The weights
+ */
+void GameNetwork_Time(const GameNetworkOptions &options, const Network &network) {
+  std::vector<GameNetworkPosition> positions;
+  std::vector<NetworkAccumulator> accumulators(options.positions);
+  long long total = 0;
+  double start;
+
+  GameNetwork_MakePositions(options.seed, options.positions, positions);
+  for (int i = 0; i < options.positions; i++) {
+    Network_Refresh(network, positions[i].before, accumulators[i]);
+  }
+  double count = (double)options.positions * GAME_NETWORK_ROUNDS;
+
+  start = GameNetwork_GetTime();
+  for (int round = 0; round < GAME_NETWORK_ROUNDS; round++) {
+    for (int i = 0; i < options.positions; i++) {
+      total += Search_Evaluate(positions[i].after);
+    }
+  }
+  double pieces = count / (GameNetwork_GetTime() - start);
+
+  start = GameNetwork_GetTime();
+  for (int round = 0; round < GAME_NETWORK_ROUNDS; round++) {
+    for (int i = 0; i < options.positions; i++) {
+      NetworkAccumulator accumulator;
+      Network_Refresh(network, positions[i].after, accumulator);
+      total += Network_Evaluate(network, accumulator, positions[i].after.Checkers_GetActivePlayer());
+    }
+  }
+  double refresh = count / (GameNetwork_GetTime() - start);
+
+  start = GameNetwork_GetTime();
+  for (int round = 0; round < GAME_NETWORK_ROUNDS; round++) {
+    for (int i = 0; i < options.positions; i++) {
+      NetworkChange change;
+      Network_Make(network, accumulators[i], positions[i].before, positions[i].after, positions[i].move, change);
+      total += Network_Evaluate(network, accumulators[i], positions[i].after.Checkers_GetActivePlayer());
+      Network_Unmake(network, accumulators[i], change);
+    }
+  }
+  double incremental = count / (GameNetwork_GetTime() - start);
+
+  start = GameNetwork_GetTime();
+  for (int round = 0; round < GAME_NETWORK_ROUNDS; round++) {
+    for (int i = 0; i < options.positions; i++) {
+      total += Network_EvaluatePlain(network, accumulators[i], positions[i].before.Checkers_GetActivePlayer());
+    }
+  }
+  double plain = count / (GameNetwork_GetTime() - start);
+
+  start = GameNetwork_GetTime();
+  for (int round = 0; round < GAME_NETWORK_ROUNDS; round++) {
+    for (int i = 0; i < options.positions; i++) {
+      total += Network_Evaluate(network, accumulators[i], positions[i].before.Checkers_GetActivePlayer());
+    }
+  }
+  double simd = count / (GameNetwork_GetTime() - start);
+
+  printf("pieces: %.0f evaluations per s\n", pieces);
+  printf("network from the whole board: %.0f evaluations per s\n", refresh);
+  printf("network move by move: %.0f evaluations per s (make, evaluate and unmake)\n", incremental);
+  printf("output layer: %.0f per s in plain C, %.0f per s with %s\n", plain, simd, Network_GetSimdName());
+
+  /* The search is timed from positions spread through the games */
+  uint64_t nodes[2] = {0, 0};
+  double elapsed[2] = {0, 0};
+  for (int i = 0; i < GAME_NETWORK_SEARCHES; i++) {
+    Checkers &game = positions[(size_t)i * positions.size() / GAME_NETWORK_SEARCHES].before;
+    for (int with_network = 0; with_network < 2; with_network++) {
+      SearchResult result;
+      start = GameNetwork_GetTime();
+      Search_Analyse(game, options.depth, 0, with_network ? &network : 0, result);
+      elapsed[with_network] += GameNetwork_GetTime() - start;
+      nodes[with_network] += result.nodes;
+      total += result.score;
+    }
+  }
+  printf("search to depth %d: %.0f positions per s by the pieces, %.0f with the network\n", options.depth, nodes[0] / elapsed[0],
+         nodes[1] / elapsed[1]);
+  printf("(checksum %lld)\n", total);
+}
+
+/**
+ * Entry point, writes the material network, times a network or checks the network code
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if everything asked for worked, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  static Network network;
+  GameNetworkOptions options;
+  if (!GameNetwork_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s -o <weights>\n", argv[0]);
+    fprintf(stderr, "       %s [-w weights] [-n positions] [-d depth] [-s seed]\n", argv[0]);
+    fprintf(stderr, "       %s -t [-s seed]\n", argv[0]);
+    return 2;
+  }
+
+  if (options.check) {
+    return GameNetwork_Check(options) ? 0 : 1;
+  }
+  if (options.output_path != 0) {
+    GameNetwork_MakeMaterial(network);
+    if (!GameNetwork_WriteFile(options.output_path, network)) {
+      fprintf(stderr, "could not write %s\n", options.output_path);
+      return 1;
+    }
+    printf("wrote the material network to %s (%d bytes)\n", options.output_path, NETWORK_FILE_SIZE);
+    return 0;
+  }
+
+  if (options.weights_path == 0) {
+    GameNetwork_MakeMaterial(network);
+  }
+  else if (!GameNetwork_ReadFile(options.weights_path, network)) {
+    fprintf(stderr, "could not load %s, or it is not a weight file for this network\n", options.weights_path);
+    return 1;
+  }
+  GameNetwork_Time(options, network);
+  return 0;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool GameNetwork_ParseOptions(int argc, char *argv[], GameNetworkOptions &options) {
+  options.weights_path = 0;
+  options.output_path = 0;
+  options.positions = GAME_NETWORK_POSITIONS;
+  options.depth = GAME_NETWORK_DEPTH;
+  options.seed = GAME_NETWORK_SEED;
+  options.check = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "w:o:n:d:s:t")) != -1) {
+    switch (option) {
+      case 'w':
+        options.weights_path = optarg;
+        break;
+      case 'o':
+        options.output_path = optarg;
+        break;
+      case 'n':
+        options.positions = atoi(optarg);
+        break;
+      case 'd':
+        options.depth = atoi(optarg);
+        break;
+      case 's':
+        options.seed = strtoul(optarg, 0, 10);
+        break;
+      case 't':
+        options.check = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  /* The random numbers are xorshift, which never leaves 0 */
+  return options.positions > 0 && options.depth >= 1 && options.depth <= SEARCH_MAX_DEPTH && options.seed != 0;
+}
@@ -0,0 +1,539 @@
+/************************************************************
+ * @file GameSelfPlay.cpp
+ * @brief Plays the host search against itself on every core and writes sampled positions with their scores and results
+ *
+ * @note Each game starts with a few random moves, so the games differ, then every move is the search's best move. One
+ *       in so many of the searched positions is sampled, with the search's score and best move, and once the game is
+ *       over with its result. Every game's random numbers come from the seed and the game's number alone, and a shard
+ *       is only ever written by one thread at a time, so the same settings give the same shards byte for byte however
+ *       many threads play them, and a run that was stopped carries on where each shard left off.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+#include "Rules.h"
+#include "Samples.h"
+#include "Search.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define GAME_SELF_PLAY_GAMES        (1000) /* The games played unless asked for otherwise */
+#define GAME_SELF_PLAY_SHARDS       (64)   /* The shards the games are dealt between unless asked for otherwise */
+#define GAME_SELF_PLAY_DEPTH        (6)    /* The depth each position is searched to unless asked for otherwise */
+#define GAME_SELF_PLAY_RANDOM_PLIES (8)    /* The random moves each game starts with unless asked for otherwise */
+#define GAME_SELF_PLAY_SAMPLE_RATE  (4)    /* One in this many searched positions is sampled unless asked for otherwise */
+#define GAME_SELF_PLAY_MAX_PLIES    (300)  /* The most moves in a game unless asked for otherwise */
+#define GAME_SELF_PLAY_MAX_THREADS  (256)  /* The most threads asked for */
+#define GAME_SELF_PLAY_MAX_SHARDS   (4096) /* The most shards asked for */
+#define GAME_SELF_PLAY_REPORT       (10)   /* The time between progress reports (s) */
+#define GAME_SELF_PLAY_PATH_SIZE    (4096) /* The longest path of a shard */
+#define GAME_SELF_PLAY_CHECK_GAMES  (40)   /* The games the check plays */
+#define GAME_SELF_PLAY_CHECK_STOP   (13)   /* The games the check's interrupted run plays before it stops */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct GameSelfPlayOptions {
+  const char   *prefix;       /* The start of the shards' paths, which end in -NNNN.cksp */
+  uint32_t      games;        /* The games the shards hold once the run is over */
+  uint32_t      shards;       /* The shards the games are dealt between */
+  unsigned int  threads;      /* The threads playing games */
+  int           depth;        /* The depth each position is searched to */
+  int           random_plies; /* The random moves each game starts with */
+  int           sample_rate;  /* One in this many searched positions is sampled */
+  int           max_plies;    /* The most moves in a game */
+  uint64_t      seed;         /* The seed every game's random numbers come from */
+  bool          check;        /* Indicator for if the pipeline is checked instead of run */
+};
+
+/* The work shared between the threads */
+struct GameSelfPlayWork {
+  const GameSelfPlayOptions *options;    /* The settings */
+  uint32_t                   next_shard; /* The number of shards taken so far */
+  uint32_t                   budget;     /* The games left to play before stopping, however many are left to do */
+  uint64_t                   games;      /* The games played */
+  uint64_t                   resumed;    /* The games the shards already held */
+  uint64_t                   samples;    /* The positions sampled */
+  uint64_t                   positions;  /* The positions played */
+  uint64_t                   nodes;      /* The positions searched */
+  bool                       failed;     /* Indicator for if a shard could not be opened or written */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+volatile sig_atomic_t game_self_play_stop = 0; /* Set by SIGINT or SIGTERM, the threads stop after their games */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double GameSelfPlay_GetTime();
+void   GameSelfPlay_Signal(int signal_number);
+void   GameSelfPlay_ShardPath(const GameSelfPlayOptions &options, uint32_t shard, char (&path)[GAME_SELF_PLAY_PATH_SIZE]);
+void   GameSelfPlay_PlayGame(const GameSelfPlayOptions &options, uint32_t game_id, std::vector<SampleRecord> &records, uint64_t &positions, uint64_t &nodes);
+void   GameSelfPlay_Worker(GameSelfPlayWork *work);
+bool   GameSelfPlay_Run(const GameSelfPlayOptions &options, uint32_t budget, bool report);
+bool   GameSelfPlay_Compare(const GameSelfPlayOptions &first, const GameSelfPlayOptions &second);
+bool   GameSelfPlay_Verify(const GameSelfPlayOptions &options, uint64_t &records);
+bool   GameSelfPlay_Check(GameSelfPlayOptions &options);
+bool   GameSelfPlay_ParseOptions(int argc, char *argv[], GameSelfPlayOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double GameSelfPlay_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Asks the threads to stop, on SIGINT or SIGTERM
+ *
+ * @param signal_number: The signal
+ */
+void GameSelfPlay_Signal(int signal_number) {
+  (void)signal_number;
+  game_self_play_stop = 1;
+}
+
+/**
+ * Makes the path of a shard
+ *
+ * @param options: The settings
+ * @param shard: The shard's number
+ * @param path: The path made
+ */
+void GameSelfPlay_ShardPath(const GameSelfPlayOptions &options, uint32_t shard, char (&path)[GAME_SELF_PLAY_PATH_SIZE]) {
+  snprintf(path, sizeof(path), "%s-%04u.cksp", options.prefix, (unsigned int)shard);
+}
+
+/**
+ * Plays a game of the search against itself, sampling positions as it goes
+ *
+ * @param options: The settings
+ * @param game_id: The number of the game, which seeds it
+ * @param records: The positions sampled
+ * @param positions: The positions played, added to
+ * @param nodes: The positions searched, added to
+ */
+void GameSelfPlay_PlayGame(const GameSelfPlayOptions &options, uint32_t game_id, std::vector<SampleRecord> &records, uint64_t &positions, uint64_t &nodes) {
+  Checkers game;
+  Move moves[RULES_MAX_MOVES];
+  SearchResult result;
+  int ply = 0;
+
+  /* xorshift never leaves 0, so it is kept out of it */
+  uint32_t state = (uint32_t)Rules_Mix(options.seed ^ Rules_Mix(game_id));
+  state = (state == 0) ? 1 : state;
+  records.clear();
+
+  while (ply < options.max_plies) {
+    int move_count = Rules_GetLegalMoves(game, moves);
+    if (move_count == 0) {
+      break;
+    }
+
+    Move move = moves[Rules_Random(state) % move_count];
+    if (ply >= options.random_plies) {
+      Search_Analyse(game, options.depth, 0, 0, result);
+      nodes += result.nodes;
+      move = result.best;
+
+      if (Rules_Random(state) % options.sample_rate == 0) {
+        SampleRecord record;
+        memset(&record, 0, sizeof(record));
+        game.Checkers_Save(record.position);
+        record.score = (int16_t)result.score;
+        record.best_from = result.best.from;
+        record.best_to = result.best.to;
+        record.ply = (uint16_t)ply;
+        records.push_back(record);
+      }
+    }
+    game.Checkers_Turn(move);
+    ply++;
+  }
+
+  /* A game that runs out of moves is a draw */
+  int winner = Rules_GetResult(game);
+  for (size_t i = 0; i < records.size(); i++) {
+    records[i].result = (uint8_t)((winner == RULES_RESULT_NONE) ? RULES_RESULT_DRAW : winner);
+  }
+  positions += ply;
+}
+
+/**
+ * Takes shards and plays their games until there are none left, the budget runs out or it is asked to stop
+ *
+ * @param work: The work shared between the threads
+ */
+void GameSelfPlay_Worker(GameSelfPlayWork *work) {
+  const GameSelfPlayOptions &options = *work->options;
+  std::vector<SampleRecord> records;
+  char path[GAME_SELF_PLAY_PATH_SIZE];
+  uint32_t shard;
+
+  while ((shard = __atomic_fetch_add(&work->next_shard, 1, __ATOMIC_RELAXED)) < options.shards) {
+    SamplesHeader settings;
+    SamplesWriter writer;
+    memset(&settings, 0, sizeof(settings));
+    settings.seed = options.seed;
+    settings.shard = shard;
+    settings.shard_count = options.shards;
+    settings.depth = (uint16_t)options.depth;
+    settings.random_plies = (uint16_t)options.random_plies;
+    settings.sample_rate = (uint16_t)options.sample_rate;
+    settings.max_plies = (uint16_t)options.max_plies;
+
+    GameSelfPlay_ShardPath(options, shard, path);
+    if (!Samples_Create(writer, path, settings)) {
+      fprintf(stderr, "could not open %s, or it was made with other settings\n", path);
+      work->failed = true;
+      continue;
+    }
+    __atomic_fetch_add(&work->resumed, (writer.next_game - shard) / options.shards, __ATOMIC_RELAXED);
+
+    /* Every game is paid for out of the budget before it is played, so an interrupted run stops at a set number of games */
+    bool written = true;
+    for (uint32_t game_id = writer.next_game; written && game_id < options.games && game_self_play_stop == 0; game_id += options.shards) {
+      uint32_t budget = __atomic_load_n(&work->budget, __ATOMIC_RELAXED);
+      while (budget > 0 && !__atomic_compare_exchange_n(&work->budget, &budget, budget - 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      }
+      if (budget == 0) {
+        break;
+      }
+
+      uint64_t positions = 0;
+      uint64_t nodes = 0;
+      GameSelfPlay_PlayGame(options, game_id, records, positions, nodes);
+      written = Samples_WriteGame(writer, game_id, records);
+      __atomic_fetch_add(&work->games, 1, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&work->samples, records.size(), __ATOMIC_RELAXED);
+      __atomic_fetch_add(&work->positions, positions, __ATOMIC_RELAXED);
+      __atomic_fetch_add(&work->nodes, nodes, __ATOMIC_RELAXED);
+    }
+    if (!Samples_Close(writer) || !written) {
+      fprintf(stderr, "could not write %s\n", path);
+      work->failed = true;
+    }
+  }
+}
+
+/**
+ * Plays the games the shards do not hold yet on many threads, reporting the throughput as it goes
+ *
+ * @param options: The settings
+ * @param budget: The most games to play before stopping
+ * @param report: Indicator for if progress is printed while it runs
+ * @return bool: If every shard was written
+ */
+bool GameSelfPlay_Run(const GameSelfPlayOptions &options, uint32_t budget, bool report) {
+  GameSelfPlayWork work;
+  std::vector<std::thread> workers;
+
+  memset(&work, 0, sizeof(work));
+  work.options = &options;
+  work.budget = budget;
+  double start = GameSelfPlay_GetTime();
+  for (unsigned int i = 0; i < options.threads; i++) {
+    workers.push_back(std::thread(GameSelfPlay_Worker, &work));
+  }
+
+  /* The threads are only waited on once they have all taken their last shard, which is when the run is nearly over */
+  double last = start;
+  while (report && __atomic_load_n(&work.next_shard, __ATOMIC_RELAXED) < options.shards + options.threads) {
+    usleep(100000);
+    double now = GameSelfPlay_GetTime();
+    if (now - last >= GAME_SELF_PLAY_REPORT) {
+      uint64_t samples = __atomic_load_n(&work.samples, __ATOMIC_RELAXED);
+      printf("%llu games, %llu samples, %.0f samples per hour\n", (unsigned long long)__atomic_load_n(&work.games, __ATOMIC_RELAXED),
+             (unsigned long long)samples, samples * 3600.0 / (now - start));
+      fflush(stdout);
+      last = now;
+    }
+  }
+  for (unsigned int i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+
+  double elapsed = GameSelfPlay_GetTime() - start;
+  printf("played %llu games (%llu already in the shards) in %.1f s with %u threads: %llu samples, %.0f samples per hour, %.0f positions per hour, %.0f positions searched per s\n",
+         (unsigned long long)work.games, (unsigned long long)work.resumed, elapsed, options.threads, (unsigned long long)work.samples,
+         work.samples * 3600.0 / elapsed, work.positions * 3600.0 / elapsed, work.nodes / elapsed);
+  return !work.failed;
+}
+
+/**
+ * Compares the shards of two runs byte for byte
+ *
+ * @param first: The settings of the first run
+ * @param second: The settings of the second run, the same but for the prefix
+ * @return bool: If every shard is the same
+ */
+bool GameSelfPlay_Compare(const GameSelfPlayOptions &first, const GameSelfPlayOptions &second) {
+  char first_path[GAME_SELF_PLAY_PATH_SIZE];
+  char second_path[GAME_SELF_PLAY_PATH_SIZE];
+  bool same = true;
+
+  for (uint32_t shard = 0; same && shard < first.shards; shard++) {
+    GameSelfPlay_ShardPath(first, shard, first_path);
+    GameSelfPlay_ShardPath(second, shard, second_path);
+    FILE *first_file = fopen(first_path, "rb");
+    FILE *second_file = fopen(second_path, "rb");
+    same = first_file != NULL && second_file != NULL;
+
+    int first_byte = 0;
+    int second_byte = 0;
+    while (same && first_byte != EOF) {
+      first_byte = fgetc(first_file);
+      second_byte = fgetc(second_file);
+      same = first_byte == second_byte;
+    }
+    if (first_file != NULL) {
+      fclose(first_file);
+    }
+    if (second_file != NULL) {
+      fclose(second_file);
+    }
+  }
+  return same;
+}
+
+/**
+ * Reads every record of a run's shards back and checks them against the rules
+ *
+ * @param options: The settings of the run
+ * @param records: The records read
+ * @return bool: If every record is a legal position with a legal best move, and every game's records agree and end flagged
+ */
+bool GameSelfPlay_Verify(const GameSelfPlayOptions &options, uint64_t &records) {
+  char path[GAME_SELF_PLAY_PATH_SIZE];
+  Move moves[RULES_MAX_MOVES];
+  bool valid = true;
+  records = 0;
+
+  for (uint32_t shard = 0; valid && shard < options.shards; shard++) {
+    SamplesReader reader;
+    SampleRecord record;
+    SampleRecord previous;
+    GameSelfPlay_ShardPath(options, shard, path);
+    if (!Samples_Open(reader, path)) {
+      return false;
+    }
+    valid = reader.header.shard == shard && reader.header.shard_count == options.shards;
+
+    memset(&previous, 0, sizeof(previous));
+    bool in_game = false;
+    bool has_previous = false;
+    while (valid && Samples_ReadRecord(reader, record)) {
+      Checkers game;
+      valid = game.Checkers_Load(record.position) && record.game % options.shards == shard && record.game < options.games;
+      valid = valid && record.result >= 1 && record.result <= RULES_RESULT_DRAW && record.ply >= options.random_plies;
+      valid = valid && Rules_FindMove(moves, Rules_GetLegalMoves(game, moves), Move_Make(record.best_from, record.best_to)) >= 0;
+
+      /* A game's records are in order with one result, and a new game only starts once the last one was flagged */
+      if (in_game) {
+        valid = valid && record.game == previous.game && record.ply > previous.ply && record.result == previous.result;
+      }
+      else if (has_previous) {
+        valid = valid && record.game > previous.game;
+      }
+      in_game = (record.flags & SAMPLES_FLAG_LAST) == 0;
+      has_previous = true;
+      previous = record;
+      records++;
+    }
+    valid = valid && !in_game;
+    Samples_CloseReader(reader);
+  }
+  return valid;
+}
+
+/**
+ * Checks the pipeline: an interrupted run with a shard cut off part way, carried on with other threads, has to give
+ * the same shards as an uninterrupted run, and every record has to follow the rules
+ *
+ * @param options: The settings, the games, shards, depth, sample rate and prefix are replaced with small ones in a temporary directory
+ * @return bool: If every check passed
+ */
+bool GameSelfPlay_Check(GameSelfPlayOptions &options) {
+  char directory[] = "/tmp/GameSelfPlayXXXXXX";
+  char whole_prefix[GAME_SELF_PLAY_PATH_SIZE];
+  char resumed_prefix[GAME_SELF_PLAY_PATH_SIZE];
+  char path[GAME_SELF_PLAY_PATH_SIZE];
+
+  if (mkdtemp(directory) == 0) {
+    fprintf(stderr, "could not make a directory for the shards\n");
+    return false;
+  }
+  snprintf(whole_prefix, sizeof(whole_prefix), "%s/whole", directory);
+  snprintf(resumed_prefix, sizeof(resumed_prefix), "%s/resumed", directory);
+  options.games = GAME_SELF_PLAY_CHECK_GAMES;
+  options.shards = 4;
+  options.depth = (options.depth > 3) ? 3 : options.depth;
+  options.sample_rate = 2;
+
+  GameSelfPlayOptions whole = options;
+  GameSelfPlayOptions resumed = options;
+  whole.prefix = whole_prefix;
+  whole.threads = 2;
+  resumed.prefix = resumed_prefix;
+  resumed.threads = 3;
+  bool passed = GameSelfPlay_Run(whole, GAME_SELF_PLAY_CHECK_GAMES, false) && GameSelfPlay_Run(resumed, GAME_SELF_PLAY_CHECK_STOP, false);
+
+  /* Cuts the longest shard off part way through a record, as a crash could, before carrying on with one thread */
+  struct stat file;
+  off_t longest = 0;
+  for (uint32_t shard = 0; shard < options.shards; shard++) {
+    GameSelfPlay_ShardPath(resumed, shard, path);
+    longest = (stat(path, &file) == 0 && file.st_size > longest) ? file.st_size : longest;
+  }
+  for (uint32_t shard = 0; stat(path, &file) != 0 || file.st_size != longest; shard++) {
+    GameSelfPlay_ShardPath(resumed, shard, path);
+  }
+  passed = passed && longest > SAMPLES_HEADER_SIZE + (off_t)sizeof(SampleRecord) &&
+           truncate(path, longest - sizeof(SampleRecord) - sizeof(SampleRecord) / 2) == 0;
+  resumed.threads = 1;
+  passed = passed && GameSelfPlay_Run(resumed, GAME_SELF_PLAY_CHECK_GAMES, false);
+  bool same = passed && GameSelfPlay_Compare(whole, resumed);
+
+  /* A shard is not carried on with other settings */
+  SamplesReader reader;
+  SamplesWriter writer;
+  bool refused = false;
+  if (Samples_Open(reader, path)) {
+    SamplesHeader settings = reader.header;
+    Samples_CloseReader(reader);
+    settings.seed++;
+    refused = !Samples_Create(writer, path, settings);
+    if (!refused) {
+      Samples_Close(writer);
+    }
+  }
+
+  uint64_t records = 0;
+  bool valid = passed && GameSelfPlay_Verify(whole, records);
+  for (uint32_t shard = 0; shard < options.shards; shard++) {
+    GameSelfPlay_ShardPath(whole, shard, path);
+    unlink(path);
+    GameSelfPlay_ShardPath(resumed, shard, path);
+    unlink(path);
+  }
+  rmdir(directory);
+
+  printf("check %s: %llu records, resumed run %s, other settings %s, records %s\n", (passed && same && refused && valid && records > 0) ? "passed" : "failed",
+         (unsigned long long)records, same ? "the same" : "different", refused ? "refused" : "accepted", valid ? "legal" : "not legal");
+  return passed && same && refused && valid && records > 0;
+}
+
+/**
+ * Entry point, plays games into the shards or checks the pipeline
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if everything asked for worked, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  GameSelfPlayOptions options;
+  if (!GameSelfPlay_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s -o <prefix> [-g games] [-k shards] [-j threads] [-d depth] [-r random moves] [-e sample one in] [-m most moves] [-s seed]\n", argv[0]);
+    fprintf(stderr, "       %s -t [-j threads] [-d depth]\n", argv[0]);
+    return 2;
+  }
+
+  if (options.check) {
+    return GameSelfPlay_Check(options) ? 0 : 1;
+  }
+  signal(SIGINT, GameSelfPlay_Signal);
+  signal(SIGTERM, GameSelfPlay_Signal);
+  return GameSelfPlay_Run(options, options.games, true) ? 0 : 1;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool GameSelfPlay_ParseOptions(int argc, char *argv[], GameSelfPlayOptions &options) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  options.prefix = 0;
+  options.games = GAME_SELF_PLAY_GAMES;
+  options.shards = GAME_SELF_PLAY_SHARDS;
+  options.threads = (cores > 0) ? (unsigned int)cores : 1;
+  options.depth = GAME_SELF_PLAY_DEPTH;
+  options.random_plies = GAME_SELF_PLAY_RANDOM_PLIES;
+  options.sample_rate = GAME_SELF_PLAY_SAMPLE_RATE;
+  options.max_plies = GAME_SELF_PLAY_MAX_PLIES;
+  options.seed = 1;
+  options.check = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "o:g:k:j:d:r:e:m:s:t")) != -1) {
+    switch (option) {
+      case 'o':
+        options.prefix = optarg;
+        break;
+      case 'g':
+        options.games = strtoul(optarg, 0, 10);
+        break;
+      case 'k':
+        options.shards = strtoul(optarg, 0, 10);
+        break;
+      case 'j':
+        options.threads = strtoul(optarg, 0, 10);
+        break;
+      case 'd':
+        options.depth = atoi(optarg);
+        break;
+      case 'r':
+        options.random_plies = atoi(optarg);
+        break;
+      case 'e':
+        options.sample_rate = atoi(optarg);
+        break;
+      case 'm':
+        options.max_plies = atoi(optarg);
+        break;
+      case 's':
+        options.seed = strtoull(optarg, 0, 10);
+        break;
+      case 't':
+        options.check = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return (options.check || options.prefix != 0) && options.games > 0 && options.shards > 0 && options.shards <= GAME_SELF_PLAY_MAX_SHARDS &&
+         options.threads > 0 && options.threads <= GAME_SELF_PLAY_MAX_THREADS && options.depth >= 1 && options.depth <= SEARCH_MAX_DEPTH &&
+         options.random_plies >= 0 && options.random_plies <= options.max_plies && options.sample_rate > 0 && options.sample_rate <= 65535 &&
+         options.max_plies > 0 && options.max_plies <= 65535;
+}
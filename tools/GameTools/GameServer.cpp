@@ -0,0 +1,613 @@
+/************************************************************
+ * @file GameServer.cpp
+ * @brief Hosts many games at once on a socket, or puts a load of virtual players on a server and reports its latency
+ *
+ * @note The load is a number of connections, each playing many games at once with one command in flight per game.
+ *       The games replay seeded random games, so every move sent is legal and any error is the server's. A move's
+ *       latency is from the write that sent it to the read that brought its reply.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+#include "Rules.h"
+#include "Server.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <algorithm>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define GAME_SERVER_SESSIONS    (65536) /* The most games hosted at once unless asked for otherwise */
+#define GAME_SERVER_CONNECTIONS (4)     /* The connections the load makes unless asked for otherwise */
+#define GAME_SERVER_PLAYERS     (256)   /* The games each connection plays at once unless asked for otherwise */
+#define GAME_SERVER_SECONDS     (5)     /* The time the load runs for unless asked for otherwise (s) */
+#define GAME_SERVER_SCRIPTS     (256)   /* The seeded random games the load replays */
+#define GAME_SERVER_MAX_PLIES   (200)   /* The most moves in each of them */
+#define GAME_SERVER_MAX_LOAD    (1024)  /* The most connections the load makes */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct GameServerOptions {
+  const char   *unix_path;   /* The Unix socket to listen or connect on (0 for the TCP port) */
+  int           port;        /* The TCP port on the loopback address to listen or connect on (0 for the Unix socket) */
+  unsigned int  workers;     /* The threads playing moves in the server */
+  unsigned long sessions;    /* The most games the server hosts at once */
+  bool          load;        /* Indicator for if this is the load instead of the server */
+  unsigned int  connections; /* The connections the load makes */
+  unsigned int  players;     /* The games each of them plays at once */
+  double        seconds;     /* The time the load runs for (s) */
+  bool          check;       /* Indicator for if the server is checked against the load in this process */
+};
+
+/* A seeded random game the load replays */
+struct GameServerScript {
+  int  ply_count;                    /* The number of moves */
+  Move plies[GAME_SERVER_MAX_PLIES]; /* The moves */
+};
+
+/* A game the load is playing */
+struct GameServerPlayer {
+  uint32_t id;     /* The server's id of the game */
+  int      script; /* The game it replays */
+  int      ply;    /* The next move of it to send */
+  double   sent;   /* When the move in flight was sent (s) */
+};
+
+/* What one of the load's connections did */
+struct GameServerLoad {
+  const GameServerOptions *options;   /* The options */
+  unsigned int             number;    /* The number of the connection */
+  uint64_t                 moves;     /* The moves played */
+  uint64_t                 games;     /* The games played to the end */
+  uint64_t                 errors;    /* The replies that were errors, or not expected */
+  std::vector<float>       latencies; /* The latency of each move (ms) */
+  bool                     connected; /* Indicator for if it connected */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+std::vector<GameServerScript> game_server_scripts;  /* The games the load replays, shared by its connections */
+volatile sig_atomic_t         game_server_stop = 0; /* Set by SIGINT or SIGTERM to stop the server */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double GameServer_GetTime();
+void   GameServer_Signal(int signal_number);
+int    GameServer_Connect(const GameServerOptions &options);
+void   GameServer_SendMove(std::string &out, GameServerPlayer &player, double now);
+void   GameServer_Player(GameServerLoad *load);
+bool   GameServer_Load(const GameServerOptions &options, uint64_t &moves);
+bool   GameServer_Ask(int socket, const char *command, const char *expected);
+bool   GameServer_Check(GameServerOptions &options);
+bool   GameServer_Serve(const GameServerOptions &options);
+bool   GameServer_ParseOptions(int argc, char *argv[], GameServerOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double GameServer_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Asks the server to stop, on SIGINT or SIGTERM
+ *
+ * @param signal_number: The signal
+ */
+void GameServer_Signal(int signal_number) {
+  (void)signal_number;
+  game_server_stop = 1;
+}
+
+/**
+ * Connects to the server
+ *
+ * @param options: The options, with the Unix socket or TCP port
+ * @return int: The socket, or -1 if it could not connect
+ */
+int GameServer_Connect(const GameServerOptions &options) {
+  int connection;
+  if (options.unix_path != 0) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, options.unix_path, sizeof(address.sun_path) - 1);
+    connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection >= 0 && connect(connection, (struct sockaddr *)&address, sizeof(address)) != 0) {
+      close(connection);
+      connection = -1;
+    }
+  }
+  else {
+    struct sockaddr_in address;
+    int enable = 1;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(options.port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    connection = socket(AF_INET, SOCK_STREAM, 0);
+    if (connection >= 0 && connect(connection, (struct sockaddr *)&address, sizeof(address)) != 0) {
+      close(connection);
+      connection = -1;
+    }
+    if (connection >= 0) {
+      setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+  }
+  return connection;
+}
+
+/**
+ * Adds a game's next move, or its end once it has no more, to the commands to send
+ *
+ * @param out: The commands to send
+ * @param player: The game
+ * @param now: The time the commands will be sent (s)
+ */
+void GameServer_SendMove(std::string &out, GameServerPlayer &player, double now) {
+  char text[SERVER_LINE_SIZE];
+  const GameServerScript &script = game_server_scripts[player.script];
+  if (player.ply < script.ply_count) {
+    char move_text[RULES_MOVE_TEXT];
+    Rules_FormatMove(script.plies[player.ply], move_text);
+    snprintf(text, sizeof(text), "%lu %s\n", (unsigned long)player.id, move_text);
+  }
+  else {
+    snprintf(text, sizeof(text), "%lu END\n", (unsigned long)player.id);
+  }
+  player.sent = now;
+  out += text;
+}
+
+/**
+ * Plays games on one connection until the time is up, then ends them and waits for their last replies
+ *
+ * @param load: The connection's settings, and what it did
+ */
+void GameServer_Player(GameServerLoad *load) {
+  const GameServerOptions &options = *load->options;
+  std::vector<GameServerPlayer> players(options.players);
+  std::unordered_map<uint32_t, unsigned int> playing;
+  std::vector<unsigned int> starting;
+  std::vector<char> buffer(SERVER_READ_SIZE + 1);
+  std::string out;
+  size_t started = 0;
+  size_t kept = 0;
+
+  load->moves = 0;
+  load->games = 0;
+  load->errors = 0;
+  int connection = GameServer_Connect(options);
+  load->connected = connection >= 0;
+  if (!load->connected) {
+    return;
+  }
+
+  /* Every game starts at once, its NEW replies come back in the order they were sent */
+  for (unsigned int i = 0; i < options.players; i++) {
+    players[i].script = (load->number * options.players + i) % GAME_SERVER_SCRIPTS;
+    starting.push_back(i);
+    out += "NEW\n";
+  }
+  unsigned int in_flight = options.players;
+  double end = GameServer_GetTime() + options.seconds;
+
+  while (in_flight > 0) {
+    if (!out.empty()) {
+      if (send(connection, out.data(), out.size(), MSG_NOSIGNAL) != (ssize_t)out.size()) {
+        load->errors++;
+        break;
+      }
+      out.clear();
+    }
+
+    ssize_t count = recv(connection, &buffer[kept], SERVER_READ_SIZE - kept, 0);
+    if (count <= 0) {
+      load->errors++;
+      break;
+    }
+    double now = GameServer_GetTime();
+    bool stopping = now >= end;
+    count += kept;
+
+    char *line = &buffer[0];
+    char *buffer_end = line + count;
+    char *next;
+    while ((next = (char *)memchr(line, '\n', buffer_end - line)) != 0) {
+      char kind[8];
+      unsigned long id = 0;
+      *next = '\0';
+      int fields = sscanf(line, "%7s %lu", kind, &id);
+      if (fields < 1) {
+        kind[0] = '\0';
+      }
+      line = next + 1;
+
+      std::unordered_map<uint32_t, unsigned int>::iterator found = (fields == 2) ? playing.find((uint32_t)id) : playing.end();
+      if (strcmp(kind, "NEW") == 0 && started < starting.size()) {
+        GameServerPlayer &player = players[starting[started++]];
+        player.id = (uint32_t)id;
+        player.ply = 0;
+        playing[player.id] = (unsigned int)(&player - &players[0]);
+        GameServer_SendMove(out, player, now);
+      }
+      else if (strcmp(kind, "OK") == 0 && found != playing.end()) {
+        GameServerPlayer &player = players[found->second];
+        load->latencies.push_back((float)((now - player.sent) * 1000));
+        load->moves++;
+        player.ply++;
+        if (stopping) {
+          player.ply = game_server_scripts[player.script].ply_count;
+        }
+        GameServer_SendMove(out, player, now);
+      }
+      else if (strcmp(kind, "END") == 0 && found != playing.end()) {
+        GameServerPlayer &player = players[found->second];
+        playing.erase(found);
+        load->games += (player.ply == game_server_scripts[player.script].ply_count) ? 1 : 0;
+
+        /* The next game replays the next script, until the time is up */
+        if (stopping) {
+          in_flight--;
+        }
+        else {
+          player.script = (player.script + 1) % GAME_SERVER_SCRIPTS;
+          starting.push_back((unsigned int)(&player - &players[0]));
+          out += "NEW\n";
+        }
+      }
+      else {
+        /* A move that was not legal, or a reply to something not sent, ends the game */
+        load->errors++;
+        if (found != playing.end()) {
+          GameServerPlayer &player = players[found->second];
+          player.ply = game_server_scripts[player.script].ply_count;
+          GameServer_SendMove(out, player, now);
+        }
+        else if (fields == 1 && strcmp(kind, "ERR") == 0 && started < starting.size()) {
+          /* The server is full, so the game that was to start does not */
+          started++;
+          in_flight--;
+        }
+      }
+    }
+
+    /* The games started are only kept until their reply comes */
+    if (started == starting.size()) {
+      starting.clear();
+      started = 0;
+    }
+    kept = buffer_end - line;
+    memmove(&buffer[0], line, kept);
+  }
+  close(connection);
+}
+
+/**
+ * Puts the load on the server, printing its throughput and latency
+ *
+ * @param options: The options
+ * @param moves: The moves the load played
+ * @return bool: If every connection connected and no reply was an error
+ */
+bool GameServer_Load(const GameServerOptions &options, uint64_t &moves) {
+  std::vector<GameServerLoad> loads(options.connections);
+  std::vector<std::thread> threads;
+  std::vector<float> latencies;
+  uint64_t games = 0;
+  uint64_t errors = 0;
+  bool connected = true;
+
+  /* The seeded games are the same from run to run */
+  uint32_t random_state = 1;
+  game_server_scripts.resize(GAME_SERVER_SCRIPTS);
+  for (int i = 0; i < GAME_SERVER_SCRIPTS; i++) {
+    Checkers game;
+    int result;
+    game_server_scripts[i].ply_count = Rules_PlayRandomGame(game, random_state, game_server_scripts[i].plies, GAME_SERVER_MAX_PLIES, result);
+  }
+
+  double start = GameServer_GetTime();
+  for (unsigned int i = 0; i < options.connections; i++) {
+    loads[i].options = &options;
+    loads[i].number = i;
+    threads.push_back(std::thread(GameServer_Player, &loads[i]));
+  }
+  for (unsigned int i = 0; i < options.connections; i++) {
+    threads[i].join();
+  }
+  double elapsed = GameServer_GetTime() - start;
+
+  moves = 0;
+  for (unsigned int i = 0; i < options.connections; i++) {
+    connected = connected && loads[i].connected;
+    moves += loads[i].moves;
+    games += loads[i].games;
+    errors += loads[i].errors;
+    latencies.insert(latencies.end(), loads[i].latencies.begin(), loads[i].latencies.end());
+  }
+  if (!connected) {
+    fprintf(stderr, "could not connect to the server\n");
+    return false;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  size_t count = latencies.size();
+  printf("%u connections playing %u games each: %llu moves in %.2f s (%.0f moves per s), %llu games finished, %llu errors\n",
+         options.connections, options.players, (unsigned long long)moves, elapsed, (elapsed > 0) ? moves / elapsed : 0.0,
+         (unsigned long long)games, (unsigned long long)errors);
+  if (count > 0) {
+    printf("latency ms: p50 %.3f, p90 %.3f, p99 %.3f, p99.9 %.3f, max %.3f\n", latencies[count / 2], latencies[count * 9 / 10],
+           latencies[count * 99 / 100], latencies[count * 999 / 1000], latencies[count - 1]);
+  }
+  return errors == 0;
+}
+
+/**
+ * Sends a command and checks its reply
+ *
+ * @param socket: The connection
+ * @param command: The command, with its line end
+ * @param expected: The reply expected, without its line end
+ * @return bool: If the reply was the one expected
+ */
+bool GameServer_Ask(int socket, const char *command, const char *expected) {
+  char reply[SERVER_LINE_SIZE];
+  size_t length = 0;
+
+  if (send(socket, command, strlen(command), MSG_NOSIGNAL) != (ssize_t)strlen(command)) {
+    return false;
+  }
+  while (length < sizeof(reply) - 1 && recv(socket, &reply[length], 1, 0) == 1 && reply[length] != '\n') {
+    length++;
+  }
+  reply[length] = '\0';
+  if (strcmp(reply, expected) != 0) {
+    fprintf(stderr, "%.*s was replied to with %s, expected %s\n", (int)strcspn(command, "\n"), command, reply, expected);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Checks a server in this process: each command is replied to as the protocol says, then the load plays against it
+ * and every move has to be legal, played once and counted by the server
+ *
+ * @param options: The options, given a Unix socket to use
+ * @return bool: If the server behaved
+ */
+bool GameServer_Check(GameServerOptions &options) {
+  static Server server;
+  ServerStats stats;
+  char directory[] = "/tmp/GameServerXXXXXX";
+  char path[sizeof(directory) + 16];
+  char expected[SERVER_LINE_SIZE];
+  char command[SERVER_LINE_SIZE];
+
+  if (mkdtemp(directory) == 0) {
+    fprintf(stderr, "could not make a directory for the socket\n");
+    return false;
+  }
+  snprintf(path, sizeof(path), "%s/socket", directory);
+  options.unix_path = path;
+  options.port = 0;
+  if (!Server_Start(server, path, 0, options.workers, options.sessions)) {
+    fprintf(stderr, "could not listen on %s\n", path);
+    rmdir(directory);
+    return false;
+  }
+
+  /* A game is started, played, refused a move that is not legal and ended, then is gone */
+  int connection = GameServer_Connect(options);
+  bool passed = connection >= 0 && GameServer_Ask(connection, "NEW\n", "NEW 0");
+  passed = passed && GameServer_Ask(connection, "0 F2 E3\n", "OK 0 2 0") && GameServer_Ask(connection, "0 F4 E5\n", "ERR 0 ILLEGAL");
+  passed = passed && GameServer_Ask(connection, "0 C3 D4\n", "OK 0 1 0") && GameServer_Ask(connection, "1 F2 E3\n", "ERR 1 SESSION");
+  passed = passed && GameServer_Ask(connection, "0 F2\n", "ERR - SYNTAX") && GameServer_Ask(connection, "0 END\n", "END 0");
+  passed = passed && GameServer_Ask(connection, "0 F4 E5\n", "ERR 0 SESSION");
+
+  /* The slot is reused with a new id, and the game is ended by closing the connection */
+  snprintf(expected, sizeof(expected), "NEW %lu", 1UL << SERVER_INDEX_BITS);
+  passed = passed && GameServer_Ask(connection, "NEW\n", expected);
+  snprintf(command, sizeof(command), "%lu F2 E3\n", 1UL << SERVER_INDEX_BITS);
+  snprintf(expected, sizeof(expected), "OK %lu 2 0", 1UL << SERVER_INDEX_BITS);
+  passed = passed && GameServer_Ask(connection, command, expected);
+  if (connection >= 0) {
+    close(connection);
+  }
+  if (!passed) {
+    fprintf(stderr, "the server did not reply as the protocol says\n");
+  }
+
+  uint64_t moves = 0;
+  passed = passed && GameServer_Load(options, moves);
+  Server_Stop(server);
+  Server_GetStats(server, stats);
+  unlink(path);
+  rmdir(directory);
+
+  printf("server played %llu moves in %llu games on %llu connections with %u workers, at most %llu games at once\n",
+         (unsigned long long)stats.moves, (unsigned long long)stats.games, (unsigned long long)stats.connections, options.workers,
+         (unsigned long long)stats.peak_sessions);
+  if (passed && (stats.moves != moves + 3 || stats.illegal != 1 || stats.errors != 3 || stats.sessions != 0)) {
+    fprintf(stderr, "the server counted %llu moves, %llu not legal, %llu errors and %llu games left, the load played %llu moves\n",
+            (unsigned long long)stats.moves, (unsigned long long)stats.illegal, (unsigned long long)stats.errors,
+            (unsigned long long)stats.sessions, (unsigned long long)moves);
+    passed = false;
+  }
+  if (passed) {
+    printf("check passed: every command replied to as the protocol says, every move of the load played in order\n");
+  }
+  return passed;
+}
+
+/**
+ * Hosts games until SIGINT or SIGTERM, printing what was played each second
+ *
+ * @param options: The options
+ * @return bool: If the server could listen
+ */
+bool GameServer_Serve(const GameServerOptions &options) {
+  static Server server;
+  ServerStats stats;
+  uint64_t last_moves = 0;
+
+  signal(SIGINT, GameServer_Signal);
+  signal(SIGTERM, GameServer_Signal);
+  if (!Server_Start(server, options.unix_path, options.port, options.workers, options.sessions)) {
+    fprintf(stderr, "could not listen on %s\n", (options.unix_path != 0) ? options.unix_path : "the port");
+    return false;
+  }
+  printf("hosting up to %lu games (%.1f MB) with %u workers\n", options.sessions,
+         options.sessions * sizeof(ServerSession) / 1048576.0, options.workers);
+  fflush(stdout);
+
+  double last = GameServer_GetTime();
+  while (game_server_stop == 0) {
+    usleep(100000);
+    double now = GameServer_GetTime();
+    if (now - last < 1) {
+      continue;
+    }
+    Server_GetStats(server, stats);
+    if (stats.moves != last_moves) {
+      printf("%.0f moves per s, %llu games being played, %llu connections so far\n", (stats.moves - last_moves) / (now - last),
+             (unsigned long long)stats.sessions, (unsigned long long)stats.connections);
+      fflush(stdout);
+    }
+    last_moves = stats.moves;
+    last = now;
+  }
+
+  Server_Stop(server);
+  Server_GetStats(server, stats);
+  printf("played %llu moves in %llu games on %llu connections, %llu not legal, %llu errors, at most %llu games at once\n",
+         (unsigned long long)stats.moves, (unsigned long long)stats.games, (unsigned long long)stats.connections,
+         (unsigned long long)stats.illegal, (unsigned long long)stats.errors, (unsigned long long)stats.peak_sessions);
+  if (options.unix_path != 0) {
+    unlink(options.unix_path);
+  }
+  return true;
+}
+
+/**
+ * Entry point, hosts games, puts a load on a server or checks a server against the load
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if everything asked for worked, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  GameServerOptions options;
+  if (!GameServer_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s (-u <socket> | -p <port>) [-j workers] [-s most games]\n", argv[0]);
+    fprintf(stderr, "       %s -l (-u <socket> | -p <port>) [-c connections] [-n games per connection] [-d seconds]\n", argv[0]);
+    fprintf(stderr, "       %s -t [-j workers] [-s most games] [-c connections] [-n games per connection] [-d seconds]\n", argv[0]);
+    return 2;
+  }
+
+  uint64_t moves;
+  bool passed;
+  if (options.check) {
+    passed = GameServer_Check(options);
+  }
+  else if (options.load) {
+    passed = GameServer_Load(options, moves);
+  }
+  else {
+    passed = GameServer_Serve(options);
+  }
+  return passed ? 0 : 1;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool GameServer_ParseOptions(int argc, char *argv[], GameServerOptions &options) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  options.unix_path = 0;
+  options.port = 0;
+  options.workers = (cores > 0) ? (unsigned int)cores : 1;
+  options.sessions = GAME_SERVER_SESSIONS;
+  options.load = false;
+  options.connections = GAME_SERVER_CONNECTIONS;
+  options.players = GAME_SERVER_PLAYERS;
+  options.seconds = GAME_SERVER_SECONDS;
+  options.check = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "u:p:j:s:lc:n:d:t")) != -1) {
+    switch (option) {
+      case 'u':
+        options.unix_path = optarg;
+        break;
+      case 'p':
+        options.port = atoi(optarg);
+        break;
+      case 'j':
+        options.workers = strtoul(optarg, 0, 10);
+        break;
+      case 's':
+        options.sessions = strtoul(optarg, 0, 10);
+        break;
+      case 'l':
+        options.load = true;
+        break;
+      case 'c':
+        options.connections = strtoul(optarg, 0, 10);
+        break;
+      case 'n':
+        options.players = strtoul(optarg, 0, 10);
+        break;
+      case 'd':
+        options.seconds = atof(optarg);
+        break;
+      case 't':
+        options.check = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  bool has_address = (options.unix_path != 0) != (options.port > 0 && options.port < 65536);
+  return (options.check ? !options.load : has_address) && options.workers > 0 && options.workers <= SERVER_MAX_WORKERS &&
+         options.sessions > 0 && options.sessions <= SERVER_MAX_SESSIONS && options.connections > 0 &&
+         options.connections <= GAME_SERVER_MAX_LOAD && options.players > 0 && options.seconds > 0;
+}
@@ -0,0 +1,503 @@
+/************************************************************
+ * @file Index.cpp
+ * @brief The implementation for the position index, which finds every archived game that reached a position
+ *
+ * @note An index is built in three steps. Threads take archive chunks and replay their games, hashing every position
+ *       and sorting the postings into partitions by the top bits of their hash. Then threads take partitions and sort
+ *       them, which leaves the positions in hash order from one partition to the next. Then the file is written.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Index.h"
+#include "Archive.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define INDEX_PARTITION_BITS   (8) /* The top bits of a hash that pick its partition, INDEX_PARTITIONS of them */
+#define INDEX_BUCKET_POSITIONS (4) /* The positions in each bucket on average, at most */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A posting with its hash, as it is sorted */
+struct IndexRecord {
+  uint64_t hash; /* The hash of the position */
+  uint32_t game; /* The index's number of the game */
+  uint16_t ply;  /* The moves played before the position was reached */
+  Move     next; /* The move played next */
+};
+
+/* A chunk of an archive to read */
+struct IndexChunk {
+  int      archive;    /* The archive */
+  uint64_t first_game; /* The archive's number of the chunk's first game */
+  uint32_t game_count; /* The number of games in the chunk */
+  uint64_t index_game; /* The index's number of the chunk's first game */
+};
+
+/* The postings one thread read, by partition */
+struct IndexThreadRecords {
+  std::vector<IndexRecord> partitions[INDEX_PARTITIONS]; /* The postings of each partition */
+  bool                     failed;                       /* Indicator for if an archive could not be read */
+};
+
+/* A sorted partition */
+struct IndexPartition {
+  std::vector<IndexPosition> positions; /* The positions, with the postings numbered from the partition's first */
+  std::vector<IndexPosting>  postings;  /* The postings */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double Index_GetTime();
+bool   Index_CompareRecords(const IndexRecord &first, const IndexRecord &second);
+void   Index_ReadChunks(const std::vector<IndexArchive> *archives, const std::vector<IndexChunk> *chunks, std::atomic<size_t> *next,
+                        IndexThreadRecords *records, uint8_t *results);
+void   Index_SortPartitions(std::vector<IndexThreadRecords> *records, std::vector<IndexPartition> *partitions, std::atomic<size_t> *next);
+bool   Index_Write(const char *path, const std::vector<IndexArchive> &archives, const std::vector<IndexPartition> &partitions,
+                   const std::vector<uint8_t> &results, IndexBuildStats &stats);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double Index_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Orders postings by hash, then by game and ply
+ *
+ * @param first: The first posting
+ * @param second: The second posting
+ * @return bool: If the first goes before the second
+ */
+bool Index_CompareRecords(const IndexRecord &first, const IndexRecord &second) {
+  if (first.hash != second.hash) {
+    return first.hash < second.hash;
+  }
+  return (first.game != second.game) ? first.game < second.game : first.ply < second.ply;
+}
+
+/**
+ * Reads chunks until there are none left, replaying each game and adding a posting for every position it reached
+ *
+ * @param archives: The archives
+ * @param chunks: The chunks of every archive
+ * @param next: The next chunk to read, shared between the threads
+ * @param records: The postings read by this thread
+ * @param results: The result of each game, each thread sets its own games'
+ */
+void Index_ReadChunks(const std::vector<IndexArchive> *archives, const std::vector<IndexChunk> *chunks, std::atomic<size_t> *next,
+                      IndexThreadRecords *records, uint8_t *results) {
+  std::vector<ArchiveReader *> readers(archives->size(), (ArchiveReader *)0);
+  ArchiveGame *game = new ArchiveGame;
+  size_t chunk;
+
+  records->failed = false;
+  while (!records->failed && (chunk = (*next)++) < chunks->size()) {
+    const IndexChunk &read = (*chunks)[chunk];
+
+    /* Each thread reads the archives through its own readers, opened the first time they are needed */
+    if (readers[read.archive] == 0) {
+      readers[read.archive] = new ArchiveReader;
+      if (!Archive_Open(*readers[read.archive], (*archives)[read.archive].name)) {
+        delete readers[read.archive];
+        readers[read.archive] = 0;
+        records->failed = true;
+        break;
+      }
+    }
+    ArchiveReader &reader = *readers[read.archive];
+
+    if (!Archive_Seek(reader, read.first_game)) {
+      records->failed = true;
+      break;
+    }
+    for (uint32_t i = 0; i < read.game_count; i++) {
+      if (!Archive_ReadGame(reader, *game)) {
+        records->failed = true;
+        break;
+      }
+
+      /* Every position from the start to the end of the game, the last one with no move after it */
+      Checkers replay;
+      IndexRecord record;
+      record.game = (uint32_t)(read.index_game + i);
+      Archive_StartGame(*game, replay);
+      for (int ply = 0; ply <= game->ply_count; ply++) {
+        record.hash = Rules_Hash(replay);
+        record.ply = (uint16_t)ply;
+        record.next = (ply < game->ply_count) ? game->plies[ply] : Move_Make(SQUARE_NONE, SQUARE_NONE);
+        records->partitions[record.hash >> (64 - INDEX_PARTITION_BITS)].push_back(record);
+        if (ply < game->ply_count) {
+          replay.Checkers_Turn(game->plies[ply]);
+        }
+      }
+      results[record.game] = (uint8_t)game->result;
+    }
+  }
+
+  for (unsigned int i = 0; i < readers.size(); i++) {
+    if (readers[i] != 0) {
+      Archive_CloseReader(*readers[i]);
+      delete readers[i];
+    }
+  }
+  delete game;
+}
+
+/**
+ * Sorts partitions until there are none left, gathering each from every thread's postings and freeing them
+ *
+ * @param records: The postings read by every thread
+ * @param partitions: The sorted partitions
+ * @param next: The next partition to sort, shared between the threads
+ */
+void Index_SortPartitions(std::vector<IndexThreadRecords> *records, std::vector<IndexPartition> *partitions, std::atomic<size_t> *next) {
+  std::vector<IndexRecord> sorted;
+  size_t partition;
+
+  while ((partition = (*next)++) < INDEX_PARTITIONS) {
+    sorted.clear();
+    for (unsigned int i = 0; i < records->size(); i++) {
+      std::vector<IndexRecord> &read = (*records)[i].partitions[partition];
+      sorted.insert(sorted.end(), read.begin(), read.end());
+      std::vector<IndexRecord>().swap(read);
+    }
+    std::sort(sorted.begin(), sorted.end(), Index_CompareRecords);
+
+    IndexPartition &out = (*partitions)[partition];
+    out.postings.resize(sorted.size());
+    for (size_t i = 0; i < sorted.size(); i++) {
+      if (i == 0 || sorted[i].hash != sorted[i - 1].hash) {
+        IndexPosition position = {sorted[i].hash, i};
+        out.positions.push_back(position);
+      }
+      IndexPosting posting = {sorted[i].game, sorted[i].ply, sorted[i].next};
+      out.postings[i] = posting;
+    }
+  }
+}
+
+/**
+ * Writes the index file
+ *
+ * @param path: The path of the index
+ * @param archives: The archives covered
+ * @param partitions: The sorted partitions
+ * @param results: The result of each game
+ * @param stats: The stats of the build, the positions and postings are filled in
+ * @return bool: If the file was written
+ */
+bool Index_Write(const char *path, const std::vector<IndexArchive> &archives, const std::vector<IndexPartition> &partitions,
+                 const std::vector<uint8_t> &results, IndexBuildStats &stats) {
+  IndexHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = INDEX_MAGIC;
+  header.version = INDEX_VERSION;
+  header.archive_count = archives.size();
+  header.game_count = results.size();
+  for (unsigned int i = 0; i < partitions.size(); i++) {
+    header.position_count += partitions[i].positions.size();
+    header.posting_count += partitions[i].postings.size();
+  }
+
+  /* Enough buckets for a few positions each, so a query searches a handful */
+  header.bucket_bits = 1;
+  while (header.bucket_bits < 32 && ((uint64_t)INDEX_BUCKET_POSITIONS << header.bucket_bits) < header.position_count) {
+    header.bucket_bits++;
+  }
+  uint64_t bucket_count = 1ULL << header.bucket_bits;
+  header.buckets_offset = sizeof(IndexHeader) + archives.size() * sizeof(IndexArchive);
+  header.positions_offset = header.buckets_offset + (bucket_count + 1) * sizeof(uint64_t);
+  header.postings_offset = header.positions_offset + (header.position_count + 1) * sizeof(IndexPosition);
+  header.results_offset = header.postings_offset + header.posting_count * sizeof(IndexPosting);
+
+  FILE *file = fopen(path, "wb");
+  if (file == 0) {
+    return false;
+  }
+  fwrite(&header, sizeof(header), 1, file);
+  fwrite(archives.data(), sizeof(IndexArchive), archives.size(), file);
+
+  /* The first position of each bucket, a bucket with none starts where the next one does */
+  uint64_t position = 0;
+  uint64_t bucket = 0;
+  for (unsigned int i = 0; i < partitions.size(); i++) {
+    for (size_t j = 0; j < partitions[i].positions.size(); j++, position++) {
+      uint64_t position_bucket = partitions[i].positions[j].hash >> (64 - header.bucket_bits);
+      for (; bucket <= position_bucket; bucket++) {
+        fwrite(&position, sizeof(position), 1, file);
+      }
+    }
+  }
+  for (; bucket <= bucket_count; bucket++) {
+    fwrite(&position, sizeof(position), 1, file);
+  }
+
+  /* The positions, with their postings numbered from the first of every partition */
+  uint64_t first_posting = 0;
+  for (unsigned int i = 0; i < partitions.size(); i++) {
+    for (size_t j = 0; j < partitions[i].positions.size(); j++) {
+      IndexPosition written = partitions[i].positions[j];
+      written.first_posting += first_posting;
+      fwrite(&written, sizeof(written), 1, file);
+    }
+    first_posting += partitions[i].postings.size();
+  }
+  IndexPosition end = {0, first_posting};
+  fwrite(&end, sizeof(end), 1, file);
+
+  for (unsigned int i = 0; i < partitions.size(); i++) {
+    fwrite(partitions[i].postings.data(), sizeof(IndexPosting), partitions[i].postings.size(), file);
+  }
+  fwrite(results.data(), 1, results.size(), file);
+
+  bool written = !ferror(file);
+  written = (fclose(file) == 0) && written;
+  stats.positions = header.position_count;
+  stats.postings = header.posting_count;
+  return written;
+}
+
+/**
+ * Builds an index of every position reached by the games of some archives
+ *
+ * @param path: The path of the index to write
+ * @param archive_paths: The paths of the archives, their games are numbered on from one to the next
+ * @param threads: The threads to read and sort with
+ * @param stats: The stats of the build
+ * @return bool: If the index was written
+ */
+bool Index_Build(const char *path, const std::vector<const char *> &archive_paths, unsigned int threads, IndexBuildStats &stats) {
+  static ArchiveReader reader;
+  std::vector<IndexArchive> archives;
+  std::vector<IndexChunk> chunks;
+
+  memset(&stats, 0, sizeof(stats));
+  if (archive_paths.empty() || archive_paths.size() > INDEX_MAX_ARCHIVES || threads == 0) {
+    return false;
+  }
+
+  /* The chunks of every archive, each read on its own */
+  uint64_t game_count = 0;
+  for (unsigned int i = 0; i < archive_paths.size(); i++) {
+    if (strlen(archive_paths[i]) >= INDEX_NAME_SIZE || !Archive_Open(reader, archive_paths[i])) {
+      return false;
+    }
+
+    IndexArchive archive;
+    memset(&archive, 0, sizeof(archive));
+    archive.first_game = game_count;
+    archive.game_count = reader.header.game_count;
+    archive.ply_count = reader.header.ply_count;
+    strcpy(archive.name, archive_paths[i]);
+    archives.push_back(archive);
+
+    for (unsigned int j = 0; j < reader.chunks.size(); j++) {
+      IndexChunk chunk = {(int)i, reader.chunks[j].first_game, reader.chunks[j].game_count, game_count + reader.chunks[j].first_game};
+      chunks.push_back(chunk);
+    }
+    game_count += reader.header.game_count;
+    Archive_CloseReader(reader);
+  }
+  if (game_count > INDEX_MAX_GAMES) {
+    return false;
+  }
+
+  double start = Index_GetTime();
+  std::vector<uint8_t> results(game_count, RULES_RESULT_NONE);
+  std::vector<IndexThreadRecords> records(threads);
+  std::vector<std::thread> workers;
+  std::atomic<size_t> next(0);
+  for (unsigned int i = 0; i < threads; i++) {
+    workers.push_back(std::thread(Index_ReadChunks, &archives, &chunks, &next, &records[i], results.data()));
+  }
+  bool failed = false;
+  for (unsigned int i = 0; i < threads; i++) {
+    workers[i].join();
+    failed = failed || records[i].failed;
+  }
+  if (failed) {
+    return false;
+  }
+  stats.games = game_count;
+  stats.read_time = Index_GetTime() - start;
+
+  start = Index_GetTime();
+  std::vector<IndexPartition> partitions(INDEX_PARTITIONS);
+  workers.clear();
+  next = 0;
+  for (unsigned int i = 0; i < threads; i++) {
+    workers.push_back(std::thread(Index_SortPartitions, &records, &partitions, &next));
+  }
+  for (unsigned int i = 0; i < threads; i++) {
+    workers[i].join();
+  }
+  stats.sort_time = Index_GetTime() - start;
+
+  start = Index_GetTime();
+  bool written = Index_Write(path, archives, partitions, results, stats);
+  stats.write_time = Index_GetTime() - start;
+  return written;
+}
+
+/**
+ * Maps an index into memory for queries
+ *
+ * @param reader: The reader
+ * @param path: The path of the index
+ * @return bool: If the index was mapped and its parts fit in the file
+ */
+bool Index_Open(IndexReader &reader, const char *path) {
+  struct stat file;
+  memset(&reader, 0, sizeof(reader));
+
+  int input = open(path, O_RDONLY);
+  if (input < 0) {
+    return false;
+  }
+  if (fstat(input, &file) != 0 || (size_t)file.st_size < sizeof(IndexHeader)) {
+    close(input);
+    return false;
+  }
+  reader.size = (size_t)file.st_size;
+  reader.map = mmap(0, reader.size, PROT_READ, MAP_SHARED, input, 0);
+  close(input);
+  if (reader.map == MAP_FAILED) {
+    reader.map = 0;
+    return false;
+  }
+
+  const uint8_t *bytes = (const uint8_t *)reader.map;
+  const IndexHeader &header = *(const IndexHeader *)bytes;
+  uint64_t bucket_count = 1ULL << header.bucket_bits;
+  if (header.magic != INDEX_MAGIC || header.version != INDEX_VERSION || header.bucket_bits < 1 || header.bucket_bits > 32 ||
+      header.archive_count > INDEX_MAX_ARCHIVES ||
+      header.buckets_offset != sizeof(IndexHeader) + header.archive_count * sizeof(IndexArchive) ||
+      header.positions_offset != header.buckets_offset + (bucket_count + 1) * sizeof(uint64_t) ||
+      header.postings_offset != header.positions_offset + (header.position_count + 1) * sizeof(IndexPosition) ||
+      header.results_offset != header.postings_offset + header.posting_count * sizeof(IndexPosting) ||
+      header.results_offset + header.game_count != reader.size) {
+    Index_Close(reader);
+    return false;
+  }
+
+  reader.header = &header;
+  reader.archives = (const IndexArchive *)(bytes + sizeof(IndexHeader));
+  reader.buckets = (const uint64_t *)(bytes + header.buckets_offset);
+  reader.positions = (const IndexPosition *)(bytes + header.positions_offset);
+  reader.postings = (const IndexPosting *)(bytes + header.postings_offset);
+  reader.results = bytes + header.results_offset;
+  return true;
+}
+
+/**
+ * Unmaps an index
+ *
+ * @param reader: The reader
+ */
+void Index_Close(IndexReader &reader) {
+  if (reader.map != 0) {
+    munmap(reader.map, reader.size);
+  }
+  memset(&reader, 0, sizeof(reader));
+}
+
+/**
+ * Finds the games that reached a position
+ *
+ * @param reader: The reader
+ * @param game: The position, such as a game replayed to it or the live board
+ * @param postings: The position's postings, sorted by game
+ * @param posting_count: The number of postings
+ * @return bool: If any game reached the position
+ */
+bool Index_Find(const IndexReader &reader, Checkers &game, const IndexPosting *&postings, uint64_t &posting_count) {
+  uint64_t hash = Rules_Hash(game);
+  uint64_t bucket = hash >> (64 - reader.header->bucket_bits);
+  uint64_t low = reader.buckets[bucket];
+  uint64_t high = reader.buckets[bucket + 1];
+
+  postings = 0;
+  posting_count = 0;
+  while (low < high) {
+    uint64_t middle = low + (high - low) / 2;
+    if (reader.positions[middle].hash < hash) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+  if (low >= reader.buckets[bucket + 1] || reader.positions[low].hash != hash) {
+    return false;
+  }
+
+  postings = reader.postings + reader.positions[low].first_posting;
+  posting_count = reader.positions[low + 1].first_posting - reader.positions[low].first_posting;
+  return true;
+}
+
+/**
+ * Works out the games and results of a position's postings
+ *
+ * @param reader: The reader
+ * @param postings: The postings, sorted by game
+ * @param posting_count: The number of postings
+ * @param stats: The stats, a game that reached the position more than once is counted once
+ */
+void Index_GetStats(const IndexReader &reader, const IndexPosting *postings, uint64_t posting_count, IndexStats &stats) {
+  memset(&stats, 0, sizeof(stats));
+  stats.postings = posting_count;
+  for (uint64_t i = 0; i < posting_count; i++) {
+    if (i == 0 || postings[i].game != postings[i - 1].game) {
+      stats.games++;
+      stats.results[reader.results[postings[i].game] & 3]++;
+    }
+  }
+}
+
+/**
+ * Finds which archive a game of the index is in
+ *
+ * @param reader: The reader
+ * @param game: The index's number of the game
+ * @param archive_game: The archive's number of the game
+ * @return int: The archive, or -1 if the index has no such game
+ */
+int Index_GetArchive(const IndexReader &reader, uint32_t game, uint64_t &archive_game) {
+  for (uint32_t i = 0; i < reader.header->archive_count; i++) {
+    if (game >= reader.archives[i].first_game && game < reader.archives[i].first_game + reader.archives[i].game_count) {
+      archive_game = game - reader.archives[i].first_game;
+      return (int)i;
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,119 @@
+/************************************************************
+ * @file Index.h
+ * @brief The header for the position index, which finds every archived game that reached a position
+ *
+ * @note An index file is a header, the archives it covers, a bucket directory, the positions sorted by hash, the
+ *       postings of each position and the result of each game. A position's postings are every (game, ply) it was
+ *       reached at, with the move played next, sorted by game. The top bits of a hash pick its bucket, so a query is
+ *       a short binary search in the memory mapped file. Game numbers run on from one archive to the next. Positions
+ *       are only told apart by their 64-bit hash, two positions sharing one is too unlikely to check for.
+ ************************************************************/
+#ifndef INDEX_H
+#define INDEX_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define INDEX_MAGIC        (0x58494B43UL) /* "CKIX" at the start of the file */
+#define INDEX_VERSION      (1)            /* The version of the format written */
+#define INDEX_MAX_ARCHIVES (64)           /* The most archives an index covers */
+#define INDEX_NAME_SIZE    (104)          /* The bytes kept of each archive's path, with its terminator */
+#define INDEX_PARTITIONS   (256)          /* The hash ranges the postings are sorted in, one thread to each at a time */
+#define INDEX_MAX_GAMES    (0xFFFFFFFFUL) /* The most games an index covers, as a posting numbers its game in 32 bits */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The start of the file, the offsets are from the start of the file and 8 byte aligned */
+struct IndexHeader {
+  uint32_t magic;            /* INDEX_MAGIC */
+  uint16_t version;          /* INDEX_VERSION */
+  uint16_t bucket_bits;      /* The top bits of a hash that pick its bucket */
+  uint32_t archive_count;    /* The number of archives covered */
+  uint32_t reserved;         /* Unused, left at 0 */
+  uint64_t game_count;       /* The number of games in every archive */
+  uint64_t position_count;   /* The number of different positions */
+  uint64_t posting_count;    /* The number of postings, one per position of every game */
+  uint64_t buckets_offset;   /* Where the bucket directory starts, (1 << bucket_bits) + 1 position numbers */
+  uint64_t positions_offset; /* Where the positions start, position_count + 1 of them with the last ending the postings */
+  uint64_t postings_offset;  /* Where the postings start */
+  uint64_t results_offset;   /* Where the result of each game starts, one byte a game */
+};
+
+/* An archive covered by the index */
+struct IndexArchive {
+  uint64_t first_game;            /* The index's number of the archive's first game */
+  uint64_t game_count;            /* The number of games in the archive */
+  uint64_t ply_count;             /* The number of moves in the archive, to tell if it has changed since */
+  char     name[INDEX_NAME_SIZE]; /* The archive's path, as it was given */
+};
+
+/* A position */
+struct IndexPosition {
+  uint64_t hash;          /* The hash of the position, from Rules_Hash */
+  uint64_t first_posting; /* Where its postings start, they end where the next position's start */
+};
+
+/* A game reaching a position */
+struct IndexPosting {
+  uint32_t game; /* The index's number of the game */
+  uint16_t ply;  /* The moves played before the position was reached */
+  Move     next; /* The move played next, SQUARE_NONE to SQUARE_NONE if the game ended there */
+};
+
+/* The games reaching a position */
+struct IndexStats {
+  uint64_t postings;   /* The times the position was reached */
+  uint64_t games;      /* The games that reached it */
+  uint64_t results[4]; /* The games by result, RULES_RESULT_NONE to RULES_RESULT_DRAW */
+};
+
+/* What building an index did */
+struct IndexBuildStats {
+  uint64_t games;      /* The games read */
+  uint64_t postings;   /* The postings written */
+  uint64_t positions;  /* The different positions written */
+  double   read_time;  /* The time spent reading the archives (s) */
+  double   sort_time;  /* The time spent sorting the postings (s) */
+  double   write_time; /* The time spent writing the file (s) */
+};
+
+/* An index mapped into memory for queries */
+struct IndexReader {
+  void                *map;       /* The mapped file */
+  size_t               size;      /* The bytes in the file */
+  const IndexHeader   *header;    /* The header */
+  const IndexArchive  *archives;  /* The archives covered */
+  const uint64_t      *buckets;   /* The first position of each bucket */
+  const IndexPosition *positions; /* The positions */
+  const IndexPosting  *postings;  /* The postings */
+  const uint8_t       *results;   /* The result of each game */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Building functions */
+bool Index_Build(const char *path, const std::vector<const char *> &archive_paths, unsigned int threads, IndexBuildStats &stats);
+
+/* Query functions */
+bool Index_Open(IndexReader &reader, const char *path);
+void Index_Close(IndexReader &reader);
+bool Index_Find(const IndexReader &reader, Checkers &game, const IndexPosting *&postings, uint64_t &posting_count);
+void Index_GetStats(const IndexReader &reader, const IndexPosting *postings, uint64_t posting_count, IndexStats &stats);
+int  Index_GetArchive(const IndexReader &reader, uint32_t game, uint64_t &archive_game);
+
+#endif /* INDEX_H */
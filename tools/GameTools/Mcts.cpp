@@ -0,0 +1,380 @@
+/************************************************************
+ * @file Mcts.cpp
+ * @brief The implementation for the host Monte Carlo tree search, a UCT search of the best move grown by many threads at once
+ *
+ * @note No node is ever locked. Its visits and points are only added to atomically, and its children are made by
+ *       the one thread that moves it from MCTS_STATE_LEAF to MCTS_STATE_EXPANDING: a thread that finds it being
+ *       expanded plays out from it instead of waiting. Visits count virtual losses as soon as a thread passes, and
+ *       points only once its playout is over, so a line with threads below it looks worse until they come back
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Mcts.h"
+#include "Batch.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <math.h>
+#include <thread>
+#include <time.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define MCTS_STATE_LEAF      (0)            /* The node's children have not been made */
+#define MCTS_STATE_EXPANDING (1)            /* A thread is making the node's children */
+#define MCTS_STATE_EXPANDED  (2)            /* The node's children are made (a node with no legal move has none) */
+#define MCTS_NEAR_CROWN_P1   (0x00000FF0UL) /* The squares of rows 1 and 2, player 1's men can be crowned from */
+#define MCTS_NEAR_CROWN_P2   (0x0FF00000UL) /* The squares of rows 5 and 6, player 2's men can be crowned from */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The state shared by the threads of one search */
+struct MctsContext {
+  MctsTree           *tree;          /* The tree */
+  Checkers            root;          /* The position searched */
+  const MctsSettings *settings;      /* The settings */
+  double              end;           /* The time to stop at (0 for no limit) */
+  uint64_t            claimed;       /* The playouts the threads have taken on */
+  uint64_t            playouts;      /* The playouts played */
+  uint64_t            playout_plies; /* The moves played in them */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double   Mcts_GetTime();
+uint32_t Mcts_Select(MctsTree &tree, const MctsNode &node, double exploration);
+bool     Mcts_Expand(MctsTree &tree, MctsNode &node, Checkers &game);
+int      Mcts_GetWinner(Checkers &game);
+int      Mcts_Playout(BatchGames &batch, Checkers &game, const MctsSettings &settings, uint32_t &state, int &plies);
+void     Mcts_Worker(MctsContext *context, unsigned int index);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double Mcts_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Allocates the node pool
+ *
+ * @param tree: The tree
+ * @param max_nodes: The most nodes a search can make
+ */
+void Mcts_Init(MctsTree &tree, size_t max_nodes) {
+  tree.nodes.assign((max_nodes < 1) ? 1 : max_nodes, MctsNode());
+  tree.node_count = 0;
+  tree.full = false;
+}
+
+/**
+ * Fills in the settings a search uses unless asked for otherwise
+ *
+ * @param settings: The settings
+ */
+void Mcts_InitSettings(MctsSettings &settings) {
+  settings.threads = 1;
+  settings.playouts = 0;
+  settings.seconds = 1;
+  settings.exploration = MCTS_EXPLORATION;
+  settings.policy = MCTS_POLICY_LIGHT;
+  settings.playout_plies = MCTS_PLAYOUT_PLIES;
+  settings.seed = 1;
+}
+
+/**
+ * Picks the child of an expanded node to go down, by UCT
+ *
+ * @param tree: The tree
+ * @param node: The node, with at least one child
+ * @param exploration: The weight of the exploration term
+ * @return uint32_t: The child, the first not yet visited if there is one
+ */
+uint32_t Mcts_Select(MctsTree &tree, const MctsNode &node, double exploration) {
+  int32_t parent_visits = __atomic_load_n(&node.visits, __ATOMIC_RELAXED);
+  double log_visits = log((double)((parent_visits > 1) ? parent_visits : 1));
+  uint32_t best = node.first_child;
+  double best_score = -1;
+
+  for (uint32_t i = node.first_child; i < node.first_child + node.child_count; i++) {
+    int32_t visits = __atomic_load_n(&tree.nodes[i].visits, __ATOMIC_RELAXED);
+    if (visits <= 0) {
+      return i;
+    }
+    uint32_t points = __atomic_load_n(&tree.nodes[i].points, __ATOMIC_RELAXED);
+    double score = points / (2.0 * visits) + exploration * sqrt(log_visits / visits);
+    if (score > best_score) {
+      best_score = score;
+      best = i;
+    }
+  }
+  return best;
+}
+
+/**
+ * Makes a leaf's children, one for each legal move, if no other thread is
+ *
+ * @param tree: The tree
+ * @param node: The leaf
+ * @param game: The leaf's position
+ * @return bool: If this thread made them, not if another thread is or the pool is full
+ */
+bool Mcts_Expand(MctsTree &tree, MctsNode &node, Checkers &game) {
+  uint8_t expected = MCTS_STATE_LEAF;
+  if (__atomic_load_n(&tree.full, __ATOMIC_RELAXED) ||
+      !__atomic_compare_exchange_n(&node.state, &expected, MCTS_STATE_EXPANDING, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+    return false;
+  }
+
+  Move moves[RULES_MAX_MOVES];
+  int move_count = Rules_GetLegalMoves(game, moves);
+  uint32_t first = __atomic_fetch_add(&tree.node_count, (uint32_t)move_count, __ATOMIC_RELAXED);
+
+  /* Once the pool is full every leaf stays one, the count past its end is never handed out */
+  if (first + (uint64_t)move_count > tree.nodes.size()) {
+    __atomic_store_n(&tree.full, true, __ATOMIC_RELAXED);
+    __atomic_store_n(&node.state, MCTS_STATE_LEAF, __ATOMIC_RELEASE);
+    return false;
+  }
+
+  int player = game.Checkers_GetActivePlayer();
+  for (int i = 0; i < move_count; i++) {
+    MctsNode &child = tree.nodes[first + i];
+    child.move = moves[i];
+    child.mover = (uint8_t)player;
+    child.state = MCTS_STATE_LEAF;
+    child.child_count = 0;
+    child.first_child = MCTS_NODE_NONE;
+    child.visits = 0;
+    child.points = 0;
+  }
+  node.first_child = (move_count > 0) ? first : MCTS_NODE_NONE;
+  node.child_count = (uint16_t)move_count;
+  __atomic_store_n(&node.state, MCTS_STATE_EXPANDED, __ATOMIC_RELEASE);
+  return true;
+}
+
+/**
+ * Finds the winner of a position the game is over in
+ *
+ * @param game: The game
+ * @return int: The winner, 1 or 2, 0 if the game goes on
+ * @note A player left without a legal move has lost, the same as in the alpha-beta search
+ */
+int Mcts_GetWinner(Checkers &game) {
+  Move moves[RULES_MAX_MOVES];
+  if (game.Checkers_GetWin() != 0) {
+    return game.Checkers_GetActivePlayer();
+  }
+  return (Rules_GetLegalMoves(game, moves) == 0) ? 3 - game.Checkers_GetActivePlayer() : 0;
+}
+
+/**
+ * Plays a game on from a position to the end, or to the most moves of a playout
+ *
+ * @param batch: A batch of one game to play it in
+ * @param game: The position
+ * @param settings: The settings, for the policy and the most moves
+ * @param state: The state of the random number generator
+ * @param plies: The moves played
+ * @return int: The winner, 1 or 2, 0 for a draw
+ */
+int Mcts_Playout(BatchGames &batch, Checkers &game, const MctsSettings &settings, uint32_t &state, int &plies) {
+  CheckersSnapshot snapshot;
+  Move moves[RULES_MAX_MOVES];
+  uint8_t played;
+
+  plies = 0;
+  game.Checkers_Save(snapshot);
+  if (!Batch_Load(batch, 0, snapshot)) {
+    return 0;
+  }
+
+  while (plies < settings.playout_plies) {
+    /* Once a game is won the active player is the winner, and a player left without a move has lost */
+    int player = (batch.turn[0] != 0) ? 2 : 1;
+    if (batch.won[0] != 0) {
+      return player;
+    }
+    Batch_Generate(batch, false);
+    int move_count = Batch_CountMoves(batch, 0);
+    if (move_count == 0) {
+      return 3 - player;
+    }
+
+    /* A man is crowned on the far row, row 0 for player 1 and the last row for player 2, so only one two rows away
+       or less can be, and the moves are only listed when there is one */
+    Move move = Batch_GetMove(batch, 0, Rules_Random(state) % move_count);
+    uint32_t men = ((player == 1) ? batch.p1[0] : batch.p2[0]) & ~batch.kings[0];
+    if (settings.policy == MCTS_POLICY_LIGHT && (men & ((player == 1) ? MCTS_NEAR_CROWN_P1 : MCTS_NEAR_CROWN_P2)) != 0) {
+      int crown_row = (player == 1) ? 0 : MOVE_BOARD_SIZE - 1;
+      Batch_GetMoves(batch, 0, moves);
+      for (int i = 0; i < move_count; i++) {
+        int from_row = Move_GetRow(moves[i].from);
+        uint32_t from_bit = 1UL << (from_row * 4 + Move_GetCol(moves[i].from) / 2);
+        if (Move_GetRow(moves[i].to) == crown_row && (batch.kings[0] & from_bit) == 0) {
+          move = moves[i];
+          break;
+        }
+      }
+    }
+    Batch_Play(batch, &move, &played, false);
+    plies++;
+  }
+
+  /* A playout cut off goes to the player a man ahead, counting a king as one and a half */
+  int lead = 2 * __builtin_popcount(batch.p1[0]) + __builtin_popcount(batch.p1[0] & batch.kings[0]) -
+             2 * __builtin_popcount(batch.p2[0]) - __builtin_popcount(batch.p2[0] & batch.kings[0]);
+  return (lead >= 2) ? 1 : (lead <= -2) ? 2 : 0;
+}
+
+/**
+ * Grows the tree a playout at a time until the search is over
+ *
+ * @param context: The search
+ * @param index: The thread's number, which picks its random numbers
+ */
+void Mcts_Worker(MctsContext *context, unsigned int index) {
+  MctsTree &tree = *context->tree;
+  const MctsSettings &settings = *context->settings;
+  uint32_t path[MCTS_MAX_DEPTH + 1];
+  uint32_t state = (uint32_t)Rules_Mix(((uint64_t)settings.seed << 16) + index) | 1;
+  BatchGames batch;
+  Batch_Init(batch, 1);
+
+  while (true) {
+    if (settings.playouts != 0 && __atomic_fetch_add(&context->claimed, 1, __ATOMIC_RELAXED) >= settings.playouts) {
+      break;
+    }
+    if (context->end != 0 && Mcts_GetTime() >= context->end) {
+      break;
+    }
+
+    /* Goes down the tree to a leaf, adding a virtual loss to every node on the way */
+    Checkers game = context->root;
+    int depth = 0;
+    path[0] = 0;
+    __atomic_add_fetch(&tree.nodes[0].visits, MCTS_VIRTUAL_LOSS, __ATOMIC_RELAXED);
+    while (depth < MCTS_MAX_DEPTH) {
+      MctsNode &node = tree.nodes[path[depth]];
+      if (__atomic_load_n(&node.state, __ATOMIC_ACQUIRE) != MCTS_STATE_EXPANDED || node.child_count == 0) {
+        break;
+      }
+      uint32_t child = Mcts_Select(tree, node, settings.exploration);
+      __atomic_add_fetch(&tree.nodes[child].visits, MCTS_VIRTUAL_LOSS, __ATOMIC_RELAXED);
+      game.Checkers_Turn(tree.nodes[child].move);
+      path[++depth] = child;
+    }
+
+    /* Then plays out from the leaf, the first thread to reach it making its children on the way */
+    int winner = Mcts_GetWinner(game);
+    int plies = 0;
+    if (winner == 0) {
+      Mcts_Expand(tree, tree.nodes[path[depth]], game);
+      winner = Mcts_Playout(batch, game, settings, state, plies);
+    }
+    else if (__atomic_load_n(&tree.nodes[path[depth]].state, __ATOMIC_RELAXED) == MCTS_STATE_LEAF) {
+      Mcts_Expand(tree, tree.nodes[path[depth]], game);
+    }
+
+    /* And takes the virtual losses back, scoring the playout for the player who made each move */
+    for (int i = depth; i >= 0; i--) {
+      MctsNode &node = tree.nodes[path[i]];
+      uint32_t points = (winner == 0) ? 1 : (winner == node.mover) ? 2 : 0;
+      __atomic_add_fetch(&node.points, points, __ATOMIC_RELAXED);
+      __atomic_add_fetch(&node.visits, 1 - MCTS_VIRTUAL_LOSS, __ATOMIC_RELAXED);
+    }
+    __atomic_add_fetch(&context->playouts, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&context->playout_plies, (uint64_t)plies, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * Searches a position from scratch, growing a tree in the pool
+ *
+ * @param tree: The tree, anything in it from an earlier search is thrown away
+ * @param game: The game
+ * @param settings: The settings, with a limit of playouts, time or both
+ * @param result: The result
+ * @return bool: If it was searched, not if it has no legal move or there is no limit
+ */
+bool Mcts_Analyse(MctsTree &tree, Checkers &game, const MctsSettings &settings, MctsResult &result) {
+  MctsContext context;
+  double start = Mcts_GetTime();
+
+  result.best = Move_Make(SQUARE_NONE, SQUARE_NONE);
+  result.value = 0;
+  result.best_visits = 0;
+  result.playouts = 0;
+  result.playout_plies = 0;
+  result.nodes = 0;
+  result.memory = 0;
+  result.pool_memory = tree.nodes.size() * sizeof(MctsNode);
+  result.seconds = 0;
+  if (tree.nodes.empty() || (settings.playouts == 0 && settings.seconds <= 0) || Mcts_GetWinner(game) != 0) {
+    return false;
+  }
+
+  /* The root is the first node, and its children are made before the threads start so they all share them */
+  MctsNode &root = tree.nodes[0];
+  root.move = Move_Make(SQUARE_NONE, SQUARE_NONE);
+  root.mover = 0;
+  root.state = MCTS_STATE_LEAF;
+  root.child_count = 0;
+  root.first_child = MCTS_NODE_NONE;
+  root.visits = 0;
+  root.points = 0;
+  tree.node_count = 1;
+  tree.full = false;
+  if (!Mcts_Expand(tree, root, game)) {
+    return false;
+  }
+
+  context.tree = &tree;
+  context.root = game;
+  context.settings = &settings;
+  context.end = (settings.seconds > 0) ? start + settings.seconds : 0;
+  context.claimed = 0;
+  context.playouts = 0;
+  context.playout_plies = 0;
+
+  unsigned int thread_count = (settings.threads < 1) ? 1 : (settings.threads > MCTS_MAX_THREADS) ? MCTS_MAX_THREADS : settings.threads;
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < thread_count; i++) {
+    threads.push_back(std::thread(Mcts_Worker, &context, i));
+  }
+  Mcts_Worker(&context, 0);
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+
+  /* The best move is the one the search spent the most playouts on */
+  for (uint32_t i = root.first_child; i < root.first_child + root.child_count; i++) {
+    const MctsNode &child = tree.nodes[i];
+    if (result.best_visits == 0 || (uint64_t)child.visits > result.best_visits) {
+      result.best = child.move;
+      result.best_visits = child.visits;
+      result.value = (child.visits > 0) ? child.points / (2.0 * child.visits) : 0;
+    }
+  }
+  result.playouts = context.playouts;
+  result.playout_plies = context.playout_plies;
+  result.nodes = (tree.node_count < tree.nodes.size()) ? tree.node_count : (uint32_t)tree.nodes.size();
+  result.memory = (uint64_t)result.nodes * sizeof(MctsNode);
+  result.seconds = Mcts_GetTime() - start;
+  return true;
+}
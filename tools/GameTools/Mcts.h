@@ -0,0 +1,91 @@
+/************************************************************
+ * @file Mcts.h
+ * @brief The header for the host Monte Carlo tree search, a UCT search of the best move grown by many threads at once
+ *
+ * @note The nodes are kept in a pool allocated once, and a node's children are handed out from it together, so the
+ *       tree is only ever added to with an atomic count. Threads going down the tree add a virtual loss to each node
+ *       they pass, which steers the other threads to other lines until the playout's result takes it back. Each
+ *       playout plays on from the leaf with the batch engine's scalar kernel, and one cut off by the most moves goes
+ *       to the player a man ahead, if either is, and is a draw otherwise
+ ************************************************************/
+#ifndef MCTS_H
+#define MCTS_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define MCTS_POLICY_RANDOM (0)            /* Playouts pick a random legal move */
+#define MCTS_POLICY_LIGHT  (1)            /* Playouts crown a man when they can, and pick a random legal move otherwise */
+#define MCTS_MAX_THREADS   (256)          /* The most threads asked for */
+#define MCTS_MAX_DEPTH     (256)          /* The most moves a line is followed down the tree */
+#define MCTS_VIRTUAL_LOSS  (3)            /* The visits a thread going down the tree adds to each node it passes, as losses */
+#define MCTS_EXPLORATION   (1.0)          /* The weight of the UCT exploration term unless asked for otherwise */
+#define MCTS_PLAYOUT_PLIES (150)          /* The most moves of a playout unless asked for otherwise */
+#define MCTS_NODE_NONE     (0xFFFFFFFFUL) /* The first child of a node without children */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A position of the tree, reached by a move from its parent */
+struct MctsNode {
+  Move     move;        /* The move from the parent */
+  uint8_t  mover;       /* The player who made the move (0 for the root) */
+  uint8_t  state;       /* If the node's children have been made, are being made or not yet */
+  uint16_t child_count; /* The number of children, one for each legal move */
+  uint32_t first_child; /* The first child, the others follow it in the pool (MCTS_NODE_NONE for none) */
+  int32_t  visits;      /* The playouts through the node, with the virtual losses of the threads below it */
+  uint32_t points;      /* The points the mover scored in them, 2 for a win and 1 for a draw */
+};
+
+/* The node pool, kept between searches */
+struct MctsTree {
+  std::vector<MctsNode> nodes;      /* The pool, allocated once */
+  uint32_t              node_count; /* The nodes handed out by the search, past the end once it is full */
+  bool                  full;       /* Indicator for if the search ran out of nodes, leaves then stay leaves */
+};
+
+/* The settings for a search */
+struct MctsSettings {
+  unsigned int threads;       /* The threads growing the tree */
+  uint64_t     playouts;      /* The playouts to stop after (0 for no limit) */
+  double       seconds;       /* The time to stop after (0 for no limit, s) */
+  double       exploration;   /* The weight of the UCT exploration term */
+  int          policy;        /* The way playouts pick moves, MCTS_POLICY_RANDOM or MCTS_POLICY_LIGHT */
+  int          playout_plies; /* The most moves of a playout */
+  uint32_t     seed;          /* The seed of the playouts, one thread with the same seed always grows the same tree */
+};
+
+/* The result of a search */
+struct MctsResult {
+  Move     best;          /* The most visited move, SQUARE_NONE to SQUARE_NONE if there is none */
+  double   value;         /* The share of the points the best move scored, for the active player */
+  uint64_t best_visits;   /* The playouts through the best move */
+  uint64_t playouts;      /* The playouts played */
+  uint64_t playout_plies; /* The moves played in them */
+  uint32_t nodes;         /* The nodes in the tree */
+  uint64_t memory;        /* The bytes of the nodes in the tree */
+  uint64_t pool_memory;   /* The bytes of the whole node pool */
+  double   seconds;       /* The time the search took (s) */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+void Mcts_Init(MctsTree &tree, size_t max_nodes);
+void Mcts_InitSettings(MctsSettings &settings);
+bool Mcts_Analyse(MctsTree &tree, Checkers &game, const MctsSettings &settings, MctsResult &result);
+
+#endif /* MCTS_H */
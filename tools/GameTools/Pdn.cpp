@@ -0,0 +1,668 @@
+/************************************************************
+ * @file Pdn.cpp
+ * @brief The implementation for reading and writing games as PDN text, the usual format of checkers game collections
+ *
+ * @note Every move read is replayed through Checkers_Turn, one call per jump, so a game is only read if it is legal by
+ *       the board's rules. A capture written with only its first and last squares ("15x29") has the squares between
+ *       found by trying the jumps. Comments, variations and annotations are skipped.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Pdn.h"
+#include "Checkers.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define PDN_LINE_WIDTH (79) /* The longest line of moves written */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* A result as PDN writes it */
+struct PdnResult {
+  const char *text;   /* The result's text */
+  int         result; /* RULES_RESULT_NONE, the winning player or RULES_RESULT_DRAW */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The results read, the first of each result is the one written. The draughts scores (2-0, 1-1, 0-2) are read as well */
+const PdnResult pdn_results[] = {
+  {"*", RULES_RESULT_NONE}, {"1-0", 1}, {"0-1", 2}, {"1/2-1/2", RULES_RESULT_DRAW},
+  {"2-0", 1}, {"0-2", 2}, {"1-1", RULES_RESULT_DRAW}, {"0-0", RULES_RESULT_NONE}
+};
+
+/* The names of each PdnStatus */
+const char *const pdn_status_names[PDN_STATUS_COUNT] = {"ok", "end", "syntax", "setup", "illegal", "variant", "too long"};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+int       Pdn_ReadNumber(const char *&text, const char *end);
+bool      Pdn_ReadResult(const char *text, const char *end, int &result);
+PdnStatus Pdn_ReadTag(const char *&text, const char *end, ArchiveGame &game, int &result);
+bool      Pdn_ReadMove(const char *text, const char *end, int (&numbers)[PDN_MOVE_SQUARES], int &count);
+bool      Pdn_IsTurnOver(Checkers &game, int player);
+bool      Pdn_PlayJumps(Checkers &game, Square from, Square to, int player, bool end_turn, ArchiveGame &record, bool &full);
+PdnStatus Pdn_PlayMove(Checkers &game, const int *numbers, int count, ArchiveGame &record);
+void      Pdn_WriteFen(FILE *file, Checkers &game);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves the PDN number of a square
+ *
+ * @param square: The square
+ * @return int: The number (1 to 32), or 0 for a light square or SQUARE_NONE
+ */
+int Pdn_GetNumber(Square square) {
+  int row = Move_GetRow(square);
+  int col = Move_GetCol(square);
+  if (square == SQUARE_NONE || (row + col) % 2 != 0) {
+    return 0;
+  }
+
+  /* PDN counts the rows down from player 1's side, with the dark squares of its even rows on the odd columns */
+  int pdn_row = MOVE_BOARD_SIZE - 1 - row;
+  return pdn_row * 4 + (col - (pdn_row + 1) % 2) / 2 + 1;
+}
+
+/**
+ * Retrieves the square with a PDN number
+ *
+ * @param number: The number
+ * @return Square: The square, or SQUARE_NONE if the number is not 1 to 32
+ */
+Square Pdn_GetSquare(int number) {
+  if (number < 1 || number > PDN_SQUARES) {
+    return SQUARE_NONE;
+  }
+  int pdn_row = (number - 1) / 4;
+  return Move_MakeSquare(MOVE_BOARD_SIZE - 1 - pdn_row, (number - 1) % 4 * 2 + (pdn_row + 1) % 2);
+}
+
+/**
+ * Skips white space
+ *
+ * @param text: The text
+ * @param end: The end of the text
+ * @return const char *: The first character that is not white space, or the end
+ */
+const char *Pdn_SkipSpace(const char *text, const char *end) {
+  while (text < end && isspace((unsigned char)*text)) {
+    text++;
+  }
+  return text;
+}
+
+/**
+ * Finds the first game that starts on a line at or after a point in some text, so the text can be split between games
+ *
+ * @param begin: The start of the whole text
+ * @param text: The point to look from
+ * @param end: The end of the whole text
+ * @return const char *: The start of the first tag line of the game, or the end if no game starts after the point
+ * @note A game starts at a tag line, [Name "value"], that does not follow another tag line. A game without tags can't
+ *       be found, so it stays with the game before it.
+ */
+const char *Pdn_FindGame(const char *begin, const char *text, const char *end) {
+  /* Starts from the next whole line */
+  if (text > begin && text[-1] != '\n') {
+    while (text < end && *text != '\n') {
+      text++;
+    }
+    text += (text < end) ? 1 : 0;
+  }
+
+  while (text < end) {
+    const char *first = text;
+    while (first < end && (*first == ' ' || *first == '\t')) {
+      first++;
+    }
+
+    /* A tag's name is followed by its quoted value, which a '[' in a comment is unlikely to be */
+    const char *value = first + 1;
+    while (value < end && (isalnum((unsigned char)*value) || *value == '_')) {
+      value++;
+    }
+    while (value < end && (*value == ' ' || *value == '\t')) {
+      value++;
+    }
+
+    if (first < end && *first == '[' && value > first + 1 && value < end && *value == '"') {
+      /* The last line with text before this one */
+      const char *previous = text;
+      while (previous > begin && isspace((unsigned char)previous[-1])) {
+        previous--;
+      }
+      while (previous > begin && previous[-1] != '\n') {
+        previous--;
+      }
+      while (previous < text && (*previous == ' ' || *previous == '\t')) {
+        previous++;
+      }
+      if (previous == text || *previous != '[') {
+        return text;
+      }
+    }
+
+    while (text < end && *text != '\n') {
+      text++;
+    }
+    text += (text < end) ? 1 : 0;
+  }
+  return end;
+}
+
+/**
+ * Reads a number
+ *
+ * @param text: The text, moved past the number
+ * @param end: The end of the text
+ * @return int: The number, or -1 if the text does not start with a digit
+ */
+int Pdn_ReadNumber(const char *&text, const char *end) {
+  if (text >= end || !isdigit((unsigned char)*text)) {
+    return -1;
+  }
+  int number = 0;
+  while (text < end && isdigit((unsigned char)*text)) {
+    number = (number < 1000) ? number * 10 + (*text - '0') : number;
+    text++;
+  }
+  return number;
+}
+
+/**
+ * Reads a result, such as "1-0"
+ *
+ * @param text: The text
+ * @param end: The end of the text, which the result has to fill
+ * @param result: The result read
+ * @return bool: If the text is a result
+ */
+bool Pdn_ReadResult(const char *text, const char *end, int &result) {
+  for (unsigned int i = 0; i < sizeof(pdn_results) / sizeof(pdn_results[0]); i++) {
+    size_t length = strlen(pdn_results[i].text);
+    if ((size_t)(end - text) == length && memcmp(text, pdn_results[i].text, length) == 0) {
+      result = pdn_results[i].result;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Reads a FEN set up position, such as "W:W18,24,K27:B12,16-20"
+ *
+ * @param text: The FEN text
+ * @param end: The end of the text
+ * @param snapshot: The position read, which Checkers_Load still has to check
+ * @return bool: If the FEN could be read
+ */
+bool Pdn_ReadFen(const char *text, const char *end, CheckersSnapshot &snapshot) {
+  memset(&snapshot, 0, sizeof(snapshot));
+  snapshot.jump = SQUARE_NONE;
+
+  /* Black is player 1, as in the square numbers */
+  text = Pdn_SkipSpace(text, end);
+  if (text >= end || (toupper(*text) != 'B' && toupper(*text) != 'W')) {
+    return false;
+  }
+  snapshot.active_player = (toupper(*text) == 'B') ? 1 : 2;
+  text++;
+
+  while ((text = Pdn_SkipSpace(text, end)) < end && *text != '.') {
+    if (*text != ':' || ++text >= end || (toupper(*text) != 'B' && toupper(*text) != 'W')) {
+      return false;
+    }
+    int player = (toupper(*text) == 'B') ? 1 : 2;
+    text++;
+
+    /* The pieces, one square or a range of them at a time, kings marked with a K */
+    while ((text = Pdn_SkipSpace(text, end)) < end && *text != ':' && *text != '.') {
+      if (*text == ',') {
+        text++;
+        continue;
+      }
+      int piece = player;
+      if (toupper(*text) == 'K') {
+        piece += 2;
+        text++;
+      }
+      int first = Pdn_ReadNumber(text, end);
+      int last = first;
+      if (text < end && *text == '-') {
+        text++;
+        last = Pdn_ReadNumber(text, end);
+      }
+      if (first < 1 || last > PDN_SQUARES || first > last) {
+        return false;
+      }
+
+      /* The snapshot holds the dark squares in row order, two to a byte */
+      for (int number = first; number <= last; number++) {
+        Square square = Pdn_GetSquare(number);
+        int index = Move_GetRow(square) * 4 + Move_GetCol(square) / 2;
+        int shift = (index % 2) * 4;
+        snapshot.squares[index / 2] = (uint8_t)((snapshot.squares[index / 2] & ~(0x0F << shift)) | (piece << shift));
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Reads a tag, such as [Result "1-0"], using the ones that change how the game is read
+ *
+ * @param text: The text at the tag's '[', moved past its ']'
+ * @param end: The end of the text
+ * @param game: The game, which a FEN tag sets up
+ * @param result: The result, set by a Result tag
+ * @return PdnStatus: PDN_OK, or the trouble the tag had
+ */
+PdnStatus Pdn_ReadTag(const char *&text, const char *end, ArchiveGame &game, int &result) {
+  const char *line_end = text;
+  while (line_end < end && *line_end != '\n') {
+    line_end++;
+  }
+
+  const char *name = ++text;
+  while (text < line_end && (isalnum((unsigned char)*text) || *text == '_')) {
+    text++;
+  }
+  size_t name_length = text - name;
+  text = Pdn_SkipSpace(text, line_end);
+  if (text >= line_end || *text != '"') {
+    text = line_end;
+    return PDN_SYNTAX;
+  }
+
+  /* The value, in quotes, with \" for a quote in it */
+  const char *value = ++text;
+  while (text < line_end && *text != '"') {
+    text += (*text == '\\' && text + 1 < line_end) ? 2 : 1;
+  }
+  const char *value_end = text;
+  while (text < line_end && *text != ']') {
+    text++;
+  }
+  if (text >= line_end) {
+    text = line_end;
+    return PDN_SYNTAX;
+  }
+  text++;
+
+  if (name_length == 6 && memcmp(name, "Result", 6) == 0) {
+    Pdn_ReadResult(value, value_end, result);
+  }
+  else if (name_length == 8 && memcmp(name, "GameType", 8) == 0) {
+    /* The game type can be followed by the board's details, such as "21,B,8,8,N1,0" */
+    const char *type = value;
+    if (Pdn_ReadNumber(type, value_end) != PDN_GAME_TYPE) {
+      return PDN_VARIANT;
+    }
+  }
+  else if (name_length == 3 && memcmp(name, "FEN", 3) == 0) {
+    Checkers start;
+    if (!Pdn_ReadFen(value, value_end, game.start) || !start.Checkers_Load(game.start)) {
+      return PDN_SETUP;
+    }
+    game.has_start = true;
+  }
+  return PDN_OK;
+}
+
+/**
+ * Reads a move, such as "11-15", "15x24", "15x24x31" or "12.11-15!"
+ *
+ * @param text: The move's text
+ * @param end: The end of the move's text
+ * @param numbers: The squares of the move
+ * @param count: The number of squares, 0 if the text was only a move number
+ * @return bool: If the text was a move or move number
+ */
+bool Pdn_ReadMove(const char *text, const char *end, int (&numbers)[PDN_MOVE_SQUARES], int &count) {
+  count = 0;
+
+  /* A move number, such as "12." or "12...", can be joined to its move */
+  const char *digits = text;
+  Pdn_ReadNumber(digits, end);
+  if (digits < end && *digits == '.') {
+    text = digits;
+    while (text < end && *text == '.') {
+      text++;
+    }
+    if (text == end) {
+      return true;
+    }
+  }
+
+  /* Annotations, such as "!" or "?!", can follow the move */
+  while (end > text && (end[-1] == '!' || end[-1] == '?')) {
+    end--;
+  }
+
+  while (count < PDN_MOVE_SQUARES) {
+    numbers[count] = Pdn_ReadNumber(text, end);
+    if (numbers[count++] < 0) {
+      return false;
+    }
+    if (text == end) {
+      return count >= 2;
+    }
+    if (*text != '-' && *text != 'x' && *text != 'X' && *text != ':') {
+      return false;
+    }
+    text++;
+  }
+  return false;
+}
+
+/**
+ * Checks if a player's turn is over
+ *
+ * @param game: The game
+ * @param player: The player whose turn it was
+ * @return bool: If the game is won or it is the other player's turn
+ */
+bool Pdn_IsTurnOver(Checkers &game, int player) {
+  return game.Checkers_GetWin() != 0 || game.Checkers_GetActivePlayer() != player;
+}
+
+/**
+ * Plays the moves from one square to another within a turn, a step or as many jumps as it takes
+ *
+ * @param game: The game, left after the moves if they are found
+ * @param from: The square moved from
+ * @param to: The square moved to
+ * @param player: The player whose turn it is
+ * @param end_turn: Indicator for if the moves have to end the turn, or have to leave more jumps to make
+ * @param record: The game read, the moves are added to it
+ * @param full: Set if the moves did not fit in the game read
+ * @return bool: If the moves were found
+ * @note Where two routes of jumps join the same squares, the first found is taken, which PDN leaves ambiguous too
+ */
+bool Pdn_PlayJumps(Checkers &game, Square from, Square to, int player, bool end_turn, ArchiveGame &record, bool &full) {
+  if (from == SQUARE_NONE || to == SQUARE_NONE) {
+    return false;
+  }
+  if (record.ply_count >= ARCHIVE_MAX_PLIES) {
+    full = true;
+    return false;
+  }
+
+  /* The move as it is written, a step or one jump */
+  Checkers trial = game;
+  Move move = Move_Make(from, to);
+  if (trial.Checkers_Turn(move) == 1 && Pdn_IsTurnOver(trial, player) == end_turn) {
+    record.plies[record.ply_count++] = move;
+    game = trial;
+    return true;
+  }
+
+  /* Otherwise the squares jumped through were left out, which can pass the last square on the way round a king's loop.
+     Each jump takes a piece, so this ends. */
+  for (int i = 0; i < 4; i++) {
+    Square next = Move_MakeSquare(Move_GetRow(from) + ((i < 2) ? -2 : 2), Move_GetCol(from) + ((i % 2 == 0) ? -2 : 2));
+    if (next == SQUARE_NONE) {
+      continue;
+    }
+
+    trial = game;
+    move = Move_Make(from, next);
+    if (trial.Checkers_Turn(move) != 1 || Pdn_IsTurnOver(trial, player)) {
+      continue;
+    }
+    record.plies[record.ply_count++] = move;
+    if (Pdn_PlayJumps(trial, next, to, player, end_turn, record, full)) {
+      game = trial;
+      return true;
+    }
+    record.ply_count--;
+    if (full) {
+      return false;
+    }
+  }
+  return false;
+}
+
+/**
+ * Plays a move read from the text
+ *
+ * @param game: The game, left after the move if it is legal
+ * @param numbers: The squares of the move
+ * @param count: The number of squares
+ * @param record: The game read, the move's jumps are added to it
+ * @return PdnStatus: PDN_OK, PDN_ILLEGAL or PDN_TOO_LONG
+ */
+PdnStatus Pdn_PlayMove(Checkers &game, const int *numbers, int count, ArchiveGame &record) {
+  int player = game.Checkers_GetActivePlayer();
+  bool full = false;
+  if (game.Checkers_GetWin() != 0) {
+    return PDN_ILLEGAL;
+  }
+
+  for (int i = 0; i + 1 < count; i++) {
+    Square from = Pdn_GetSquare(numbers[i]);
+    Square to = Pdn_GetSquare(numbers[i + 1]);
+
+    /* The last square ends the turn, unless the game stopped part way through its jumps */
+    bool last = i + 2 == count;
+    if (!Pdn_PlayJumps(game, from, to, player, last, record, full) &&
+        (!last || full || !Pdn_PlayJumps(game, from, to, player, false, record, full))) {
+      return full ? PDN_TOO_LONG : PDN_ILLEGAL;
+    }
+  }
+  return PDN_OK;
+}
+
+/**
+ * Reads the next game, replaying its moves
+ *
+ * @param text: The text, moved past the game
+ * @param end: The end of the text
+ * @param game: The game read (its id is left as it was)
+ * @return PdnStatus: PDN_OK, PDN_END if there was only white space left, or the first trouble the game had
+ * @note A game ends at its result, or at the next line starting with a tag, so a game with trouble is still skipped whole
+ */
+PdnStatus Pdn_ReadGame(const char *&text, const char *end, ArchiveGame &game) {
+  Checkers replay;
+  PdnStatus status = PDN_OK;
+  bool started = false;
+  int tag_result = RULES_RESULT_NONE;
+  int numbers[PDN_MOVE_SQUARES];
+  int count;
+
+  game.has_start = false;
+  game.result = RULES_RESULT_NONE;
+  game.ply_count = 0;
+
+  text = Pdn_SkipSpace(text, end);
+  if (text == end) {
+    return PDN_END;
+  }
+
+  /* The tags, the first trouble is the one kept */
+  while (text < end && *text == '[') {
+    PdnStatus tag_status = Pdn_ReadTag(text, end, game, tag_result);
+    status = (status == PDN_OK) ? tag_status : status;
+    text = Pdn_SkipSpace(text, end);
+  }
+  game.result = tag_result;
+
+  /* The moves, up to the result or the next game's tags */
+  while (text < end) {
+    char next = *text;
+    if (isspace((unsigned char)next)) {
+      text++;
+    }
+    else if (next == '[' && (text[-1] == '\n' || text[-1] == '\r')) {
+      break;
+    }
+    else if (next == '{') {
+      const char *close = (const char *)memchr(text, '}', end - text);
+      text = (close != 0) ? close + 1 : end;
+    }
+    else if (next == ';') {
+      const char *line_end = (const char *)memchr(text, '\n', end - text);
+      text = (line_end != 0) ? line_end : end;
+    }
+    else if (next == '(') {
+      for (int depth = 0; text < end; text++) {
+        depth += (*text == '(') ? 1 : (*text == ')') ? -1 : 0;
+        if (depth == 0) {
+          text++;
+          break;
+        }
+      }
+    }
+    else if (next == '$' || next == ')' || next == '}' || next == '[' || next == ']') {
+      /* An annotation glyph such as $1, or a stray bracket */
+      text++;
+      while (text < end && isdigit((unsigned char)*text)) {
+        text++;
+      }
+    }
+    else {
+      const char *token = text;
+      while (text < end && !isspace((unsigned char)*text) && strchr("{}();[]$", *text) == 0) {
+        text++;
+      }
+
+      if (Pdn_ReadResult(token, text, game.result)) {
+        break;
+      }
+      if (status != PDN_OK) {
+        continue;
+      }
+      if (!Pdn_ReadMove(token, text, numbers, count)) {
+        status = PDN_SYNTAX;
+      }
+      else if (count > 0) {
+        if (!started) {
+          Archive_StartGame(game, replay);
+          started = true;
+        }
+        status = Pdn_PlayMove(replay, numbers, count, game);
+      }
+    }
+  }
+
+  /* A game the rules say is won is won, whatever the result says */
+  if (status == PDN_OK && started && replay.Checkers_GetWin() != 0) {
+    game.result = Rules_GetResult(replay);
+  }
+  return status;
+}
+
+/**
+ * Retrieves the name of a status
+ *
+ * @param status: The status
+ * @return const char *: The name
+ */
+const char *Pdn_GetStatusName(PdnStatus status) {
+  return (status >= PDN_OK && status < PDN_STATUS_COUNT) ? pdn_status_names[status] : "unknown";
+}
+
+/**
+ * Writes a game's position as a FEN
+ *
+ * @param file: The file
+ * @param game: The game
+ */
+void Pdn_WriteFen(FILE *file, Checkers &game) {
+  fprintf(file, "%c", (game.Checkers_GetActivePlayer() == 1) ? 'B' : 'W');
+  for (int player = 2; player >= 1; player--) {
+    fprintf(file, ":%c", (player == 1) ? 'B' : 'W');
+    bool first = true;
+    for (int number = 1; number <= PDN_SQUARES; number++) {
+      Square square = Pdn_GetSquare(number);
+      int piece = game.Checkers_GetBoardAt(Move_GetRow(square), Move_GetCol(square));
+      if (piece != 0 && (piece - 1) % 2 == player - 1) {
+        fprintf(file, "%s%s%d", first ? "" : ",", (piece > 2) ? "K" : "", number);
+        first = false;
+      }
+    }
+  }
+}
+
+/**
+ * Writes a game as PDN text, a turn's jumps written together as one move
+ *
+ * @param file: The file
+ * @param game: The game
+ * @return bool: If the game could be written, a set up position part way through a jump or an illegal move can't be
+ */
+bool Pdn_WriteGame(FILE *file, const ArchiveGame &game) {
+  Checkers replay;
+  char line[PDN_LINE_WIDTH + 1];
+  char move[PDN_MOVE_SQUARES * 3 + 16];
+  int line_length = 0;
+
+  if ((game.has_start && game.start.jump != SQUARE_NONE) || game.result < RULES_RESULT_NONE || game.result > RULES_RESULT_DRAW) {
+    return false;
+  }
+  Archive_StartGame(game, replay);
+
+  fprintf(file, "[Event \"Game %llu\"]\n", (unsigned long long)game.id);
+  fprintf(file, "[GameType \"%d\"]\n", PDN_GAME_TYPE);
+  if (game.has_start) {
+    fprintf(file, "[FEN \"");
+    Pdn_WriteFen(file, replay);
+    fprintf(file, "\"]\n");
+  }
+  fprintf(file, "[Result \"%s\"]\n\n", pdn_results[game.result].text);
+
+  int turn = 1;
+  bool first = true;
+  for (int i = 0; i <= game.ply_count; ) {
+    int length;
+    if (i == game.ply_count) {
+      length = snprintf(move, sizeof(move), "%s", pdn_results[game.result].text);
+      i++;
+    }
+    else {
+      /* The turn number goes before player 1's moves, and a game started by player 2 marks the move it skipped */
+      int player = replay.Checkers_GetActivePlayer();
+      length = 0;
+      if (player == 1 || first) {
+        length = snprintf(move, sizeof(move), (player == 1) ? "%d. " : "%d... ", turn);
+      }
+      turn += (player == 2) ? 1 : 0;
+      first = false;
+
+      bool jump = abs(Move_GetRow(game.plies[i].from) - Move_GetRow(game.plies[i].to)) == 2;
+      length += snprintf(move + length, sizeof(move) - length, "%d", Pdn_GetNumber(game.plies[i].from));
+      do {
+        if (replay.Checkers_Turn(game.plies[i]) != 1) {
+          return false;
+        }
+        length += snprintf(move + length, sizeof(move) - length, "%c%d", jump ? 'x' : '-', Pdn_GetNumber(game.plies[i].to));
+        i++;
+      } while (i < game.ply_count && !Pdn_IsTurnOver(replay, player) && length < (int)sizeof(move) - 4);
+    }
+
+    if (line_length > 0 && line_length + 1 + length > PDN_LINE_WIDTH) {
+      fprintf(file, "%.*s\n", line_length, line);
+      line_length = 0;
+    }
+    line_length += snprintf(line + line_length, sizeof(line) - line_length, "%s%.*s", (line_length > 0) ? " " : "", length, move);
+  }
+  fprintf(file, "%.*s\n\n", line_length, line);
+  return !ferror(file);
+}
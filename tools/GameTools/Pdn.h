@@ -0,0 +1,62 @@
+/************************************************************
+ * @file Pdn.h
+ * @brief The header for reading and writing games as PDN text, the usual format of checkers game collections
+ *
+ * @note Squares are numbered 1 to 32 the standard way, with player 1 (the first to move) as black on 1 to 12. That is the
+ *       standard board seen in a mirror, since this board has a light square in its bottom left corner, which changes
+ *       nothing about the game. "1-0" is a win for player 1, as PDN lists the first player to move first.
+ ************************************************************/
+#ifndef PDN_H
+#define PDN_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Archive.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdio.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define PDN_SQUARES       (32) /* The numbered squares */
+#define PDN_MOVE_SQUARES  (16) /* The most squares a move's text can list, more than the longest jump needs */
+#define PDN_GAME_TYPE     (21) /* The GameType tag of English draughts, the only one these rules play */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* What came of reading a game */
+enum PdnStatus {
+  PDN_OK = 0,       /* The game was read and every move replayed */
+  PDN_END,          /* There was no game left in the text */
+  PDN_SYNTAX,       /* A tag or move could not be read */
+  PDN_SETUP,        /* The FEN set up position could not be read or Checkers_Load rejects it */
+  PDN_ILLEGAL,      /* A move Checkers_Turn rejects, or one that stops before its jumps are done */
+  PDN_VARIANT,      /* The game is not English draughts */
+  PDN_TOO_LONG,     /* The game has more than ARCHIVE_MAX_PLIES moves */
+  PDN_STATUS_COUNT  /* The number of statuses */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Square functions */
+int    Pdn_GetNumber(Square square);
+Square Pdn_GetSquare(int number);
+
+/* Reading functions */
+const char *Pdn_SkipSpace(const char *text, const char *end);
+const char *Pdn_FindGame(const char *begin, const char *text, const char *end);
+PdnStatus   Pdn_ReadGame(const char *&text, const char *end, ArchiveGame &game);
+bool        Pdn_ReadFen(const char *text, const char *end, CheckersSnapshot &snapshot);
+const char *Pdn_GetStatusName(PdnStatus status);
+
+/* Writing functions */
+bool Pdn_WriteGame(FILE *file, const ArchiveGame &game);
+
+#endif /* PDN_H */
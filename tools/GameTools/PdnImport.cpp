@@ -0,0 +1,479 @@
+/************************************************************
+ * @file PdnImport.cpp
+ * @brief Imports a PDN game collection into a game archive, reading and replaying the games on many threads
+ *
+ * @note The PDN file is mapped into memory and cut into batches that end between games. Each thread takes the next
+ *       batch, reads and replays its games and finds their legal move indexes, then this thread range codes the
+ *       batches into the archive in file order, so the archive's game numbers follow the file whatever the threads do.
+ *       Only a few batches per thread are read ahead of the one being written, which keeps the memory used flat.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Archive.h"
+#include "Move.h"
+#include "Pdn.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <condition_variable>
+#include <fcntl.h>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define PDN_IMPORT_BATCH_KB      (1024) /* The PDN text in each batch unless asked for otherwise (KB), cut at the next game */
+#define PDN_IMPORT_BATCHES_AHEAD (4)    /* The batches per thread that can be read ahead of the one being written */
+#define PDN_IMPORT_MAX_THREADS   (256)  /* The most threads asked for */
+#define PDN_IMPORT_ERRORS_SHOWN  (10)   /* The rejected games printed, unless every one is asked for */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The settings for a run, from the command line */
+struct PdnImportOptions {
+  const char   *input_path;  /* The PDN file to read */
+  const char   *output_path; /* The archive to write */
+  unsigned int  threads;     /* The threads reading games */
+  unsigned long batch_bytes; /* The PDN text in each batch */
+  uint32_t      chunk_games; /* The games in each archive chunk */
+  bool          all_errors;  /* Indicator for if every rejected game is printed */
+};
+
+/* A game read from a batch, its moves are kept with the batch's */
+struct PdnImportGame {
+  bool             has_start; /* Indicator for if the game starts from a set up position */
+  CheckersSnapshot start;     /* The set up position, if there is one */
+  int              result;    /* The result */
+  int              ply_count; /* The number of moves */
+  size_t           first_ply; /* Where the moves start in the batch's moves */
+};
+
+/* A game that was not imported */
+struct PdnImportError {
+  unsigned long long offset; /* Where the game starts in the file */
+  PdnStatus          status; /* What was wrong with it */
+};
+
+/* A piece of the PDN file, read by one thread */
+struct PdnImportBatch {
+  const char                 *begin;   /* The first byte */
+  const char                 *end;     /* The byte after the last */
+  std::vector<PdnImportGame>  games;   /* The games read */
+  std::vector<Move>           plies;   /* The moves of every game */
+  std::vector<uint8_t>        indexes; /* The legal move index of each move */
+  std::vector<uint8_t>        counts;  /* The number of legal moves at each move */
+  std::vector<PdnImportError> errors;  /* The games rejected, if they are to be printed */
+  bool                        read;    /* Indicator for if the batch has been read */
+};
+
+/* What a thread did */
+struct PdnImportStats {
+  unsigned long      batches;                    /* The batches read */
+  unsigned long long bytes;                      /* The PDN text read */
+  unsigned long      games;                      /* The games found */
+  unsigned long long plies;                      /* The moves of the games imported */
+  unsigned long      rejected[PDN_STATUS_COUNT]; /* The games rejected, by why */
+  double             busy;                       /* The time spent reading (s) */
+};
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The batches, shared between the threads */
+const char                 *pdn_import_text;       /* The start of the mapped file */
+std::vector<PdnImportBatch> pdn_import_batches;    /* The batches in file order */
+size_t                      pdn_import_next;       /* The next batch to be read */
+size_t                      pdn_import_written;    /* The batches written to the archive */
+size_t                      pdn_import_ahead;      /* The most batches read ahead of the one being written */
+bool                        pdn_import_all_errors; /* Indicator for if every rejected game is kept to be printed */
+std::mutex                  pdn_import_lock;       /* Guards the batch counters and read indicators */
+std::condition_variable     pdn_import_read;       /* Signalled when a batch has been read */
+std::condition_variable     pdn_import_freed;      /* Signalled when a batch has been written, so another can be read */
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+double PdnImport_GetTime();
+void   PdnImport_Split(const char *text, size_t size, unsigned long batch_bytes);
+void   PdnImport_ReadBatch(PdnImportBatch &batch, ArchiveGame &game, PdnImportStats &stats);
+void   PdnImport_Worker(PdnImportStats *stats);
+bool   PdnImport_WriteBatch(ArchiveWriter &writer, PdnImportBatch &batch, ArchiveGame &game, unsigned long &errors_shown);
+void   PdnImport_Release(PdnImportBatch &batch);
+bool   PdnImport_Run(const PdnImportOptions &options);
+bool   PdnImport_ParseOptions(int argc, char *argv[], PdnImportOptions &options);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Retrieves a monotonic time
+ *
+ * @return double: The time in s
+ */
+double PdnImport_GetTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/**
+ * Cuts the PDN text into batches that start at a game
+ *
+ * @param text: The text
+ * @param size: The bytes in the text
+ * @param batch_bytes: The bytes in each batch before it is cut at the next game
+ */
+void PdnImport_Split(const char *text, size_t size, unsigned long batch_bytes) {
+  const char *end = text + size;
+  const char *begin = text;
+
+  pdn_import_batches.clear();
+  while (begin < end) {
+    PdnImportBatch batch;
+    batch.begin = begin;
+    batch.end = ((size_t)(end - begin) > batch_bytes) ? Pdn_FindGame(text, begin + batch_bytes, end) : end;
+    batch.read = false;
+    pdn_import_batches.push_back(batch);
+    begin = batch.end;
+  }
+}
+
+/**
+ * Reads the games of a batch, replaying them and finding their legal move indexes
+ *
+ * @param batch: The batch
+ * @param game: Space for a game
+ * @param stats: The stats of the thread
+ */
+void PdnImport_ReadBatch(PdnImportBatch &batch, ArchiveGame &game, PdnImportStats &stats) {
+  const char *text = batch.begin;
+
+  while ((text = Pdn_SkipSpace(text, batch.end)) < batch.end) {
+    const char *start = text;
+    PdnStatus status = Pdn_ReadGame(text, batch.end, game);
+    if (status == PDN_END) {
+      break;
+    }
+    stats.games++;
+
+    /* The moves were legal as Checkers_Turn played them, so each is in its list of legal moves */
+    size_t first_ply = batch.plies.size();
+    if (status == PDN_OK) {
+      batch.indexes.resize(first_ply + game.ply_count);
+      batch.counts.resize(first_ply + game.ply_count);
+      if (!Archive_IndexGame(game, batch.indexes.data() + first_ply, batch.counts.data() + first_ply)) {
+        status = PDN_ILLEGAL;
+      }
+    }
+
+    if (status != PDN_OK) {
+      batch.indexes.resize(first_ply);
+      batch.counts.resize(first_ply);
+      stats.rejected[status]++;
+      if (pdn_import_all_errors || batch.errors.size() < PDN_IMPORT_ERRORS_SHOWN) {
+        PdnImportError error = {(unsigned long long)(start - pdn_import_text), status};
+        batch.errors.push_back(error);
+      }
+      continue;
+    }
+
+    PdnImportGame imported;
+    imported.has_start = game.has_start;
+    imported.start = game.start;
+    imported.result = game.result;
+    imported.ply_count = game.ply_count;
+    imported.first_ply = first_ply;
+    batch.games.push_back(imported);
+    batch.plies.insert(batch.plies.end(), game.plies, game.plies + game.ply_count);
+    stats.plies += game.ply_count;
+  }
+
+  stats.batches++;
+  stats.bytes += batch.end - batch.begin;
+}
+
+/**
+ * Reads batches until there are none left, keeping to the batches that can be read ahead
+ *
+ * @param stats: The stats of the thread
+ */
+void PdnImport_Worker(PdnImportStats *stats) {
+  ArchiveGame *game = new ArchiveGame;
+
+  while (true) {
+    size_t next;
+    {
+      std::unique_lock<std::mutex> lock(pdn_import_lock);
+      pdn_import_freed.wait(lock, [] {
+        return pdn_import_next >= pdn_import_batches.size() || pdn_import_next < pdn_import_written + pdn_import_ahead;
+      });
+      if (pdn_import_next >= pdn_import_batches.size()) {
+        break;
+      }
+      next = pdn_import_next++;
+    }
+
+    double start = PdnImport_GetTime();
+    PdnImport_ReadBatch(pdn_import_batches[next], *game, *stats);
+    stats->busy += PdnImport_GetTime() - start;
+
+    {
+      std::lock_guard<std::mutex> lock(pdn_import_lock);
+      pdn_import_batches[next].read = true;
+    }
+    pdn_import_read.notify_all();
+  }
+
+  delete game;
+}
+
+/**
+ * Writes a batch's games to the archive, and prints its rejected games
+ *
+ * @param writer: The archive
+ * @param batch: The batch, which has been read
+ * @param game: Space for a game
+ * @param errors_shown: The rejected games printed so far
+ * @return bool: If every game was written
+ */
+bool PdnImport_WriteBatch(ArchiveWriter &writer, PdnImportBatch &batch, ArchiveGame &game, unsigned long &errors_shown) {
+  for (size_t i = 0; i < batch.errors.size(); i++) {
+    if (pdn_import_all_errors || errors_shown < PDN_IMPORT_ERRORS_SHOWN) {
+      fprintf(stderr, "rejected the game at byte %llu: %s\n", batch.errors[i].offset, Pdn_GetStatusName(batch.errors[i].status));
+      errors_shown++;
+    }
+  }
+
+  for (size_t i = 0; i < batch.games.size(); i++) {
+    const PdnImportGame &imported = batch.games[i];
+    game.has_start = imported.has_start;
+    game.start = imported.start;
+    game.result = imported.result;
+    game.ply_count = imported.ply_count;
+    memcpy(game.plies, batch.plies.data() + imported.first_ply, imported.ply_count * sizeof(Move));
+    if (!Archive_WriteIndexedGame(writer, game, batch.indexes.data() + imported.first_ply, batch.counts.data() + imported.first_ply)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Frees a batch that has been written, its games and the pages of the file it was read from
+ *
+ * @param batch: The batch
+ */
+void PdnImport_Release(PdnImportBatch &batch) {
+  std::vector<PdnImportGame>().swap(batch.games);
+  std::vector<Move>().swap(batch.plies);
+  std::vector<uint8_t>().swap(batch.indexes);
+  std::vector<uint8_t>().swap(batch.counts);
+  std::vector<PdnImportError>().swap(batch.errors);
+
+  /* Only whole pages inside the batch are dropped, the file is read once */
+  uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+  uintptr_t first = ((uintptr_t)batch.begin + page - 1) / page * page;
+  uintptr_t last = (uintptr_t)batch.end / page * page;
+  if (last > first) {
+    madvise((void *)first, last - first, MADV_DONTNEED);
+  }
+}
+
+/**
+ * Imports the PDN file into the archive, printing what each thread did
+ *
+ * @param options: The options
+ * @return bool: If the file was read and the archive written, rejected games are only reported
+ */
+bool PdnImport_Run(const PdnImportOptions &options) {
+  static ArchiveWriter writer;
+  static ArchiveGame game;
+  struct stat file;
+
+  int input = open(options.input_path, O_RDONLY);
+  if (input < 0 || fstat(input, &file) != 0) {
+    fprintf(stderr, "could not open %s\n", options.input_path);
+    if (input >= 0) {
+      close(input);
+    }
+    return false;
+  }
+
+  /* An empty file can't be mapped, and has no games */
+  size_t size = (size_t)file.st_size;
+  void *map = 0;
+  if (size > 0) {
+    map = mmap(0, size, PROT_READ, MAP_PRIVATE, input, 0);
+    if (map == MAP_FAILED) {
+      fprintf(stderr, "could not map %s\n", options.input_path);
+      close(input);
+      return false;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+  }
+  close(input);
+
+  if (!Archive_Create(writer, options.output_path, options.chunk_games)) {
+    fprintf(stderr, "could not create %s\n", options.output_path);
+    if (map != 0) {
+      munmap(map, size);
+    }
+    return false;
+  }
+
+  double start = PdnImport_GetTime();
+  pdn_import_text = (const char *)map;
+  PdnImport_Split(pdn_import_text, size, options.batch_bytes);
+  pdn_import_next = 0;
+  pdn_import_written = 0;
+  pdn_import_ahead = (size_t)options.threads * PDN_IMPORT_BATCHES_AHEAD;
+  pdn_import_all_errors = options.all_errors;
+
+  std::vector<PdnImportStats> stats(options.threads);
+  std::vector<std::thread> threads;
+  memset(stats.data(), 0, stats.size() * sizeof(PdnImportStats));
+  for (unsigned int i = 0; i < options.threads; i++) {
+    threads.push_back(std::thread(PdnImport_Worker, &stats[i]));
+  }
+
+  /* Writes the batches in file order as they are read, a failed write still lets the threads finish */
+  bool written = true;
+  unsigned long errors_shown = 0;
+  double waiting = 0;
+  for (size_t i = 0; i < pdn_import_batches.size(); i++) {
+    double wait_start = PdnImport_GetTime();
+    {
+      std::unique_lock<std::mutex> lock(pdn_import_lock);
+      pdn_import_read.wait(lock, [i] { return pdn_import_batches[i].read; });
+    }
+    waiting += PdnImport_GetTime() - wait_start;
+
+    written = written && PdnImport_WriteBatch(writer, pdn_import_batches[i], game, errors_shown);
+    PdnImport_Release(pdn_import_batches[i]);
+    {
+      std::lock_guard<std::mutex> lock(pdn_import_lock);
+      pdn_import_written = i + 1;
+    }
+    pdn_import_freed.notify_all();
+  }
+  for (unsigned int i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+  written = Archive_Close(writer) && written;
+  double elapsed = PdnImport_GetTime() - start;
+  if (map != 0) {
+    munmap(map, size);
+  }
+  if (!written) {
+    fprintf(stderr, "could not write %s\n", options.output_path);
+    return false;
+  }
+
+  /* What each thread did, then the whole import */
+  PdnImportStats total;
+  memset(&total, 0, sizeof(total));
+  printf("thread  batches       MB    games  rejected        moves   busy s     MB/s\n");
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    unsigned long rejected = 0;
+    for (int status = 0; status < PDN_STATUS_COUNT; status++) {
+      rejected += stats[i].rejected[status];
+      total.rejected[status] += stats[i].rejected[status];
+    }
+    printf("%6u %8lu %8.1f %8lu %9lu %12llu %8.2f %8.1f\n", i, stats[i].batches, stats[i].bytes / 1e6, stats[i].games, rejected,
+           stats[i].plies, stats[i].busy, (stats[i].busy > 0) ? stats[i].bytes / 1e6 / stats[i].busy : 0.0);
+    total.batches += stats[i].batches;
+    total.bytes += stats[i].bytes;
+    total.games += stats[i].games;
+    total.plies += stats[i].plies;
+    total.busy += stats[i].busy;
+  }
+
+  unsigned long rejected = 0;
+  for (int status = 0; status < PDN_STATUS_COUNT; status++) {
+    rejected += total.rejected[status];
+  }
+  printf("imported %lu games (%llu moves) of %lu from %.1f MB in %.2f s, %.1f MB/s, %.0f games/s\n", total.games - rejected, total.plies,
+         total.games, size / 1e6, elapsed, (elapsed > 0) ? size / 1e6 / elapsed : 0.0, (elapsed > 0) ? total.games / elapsed : 0.0);
+  printf("rejected %lu: syntax %lu, setup %lu, illegal %lu, variant %lu, too long %lu\n", rejected, total.rejected[PDN_SYNTAX],
+         total.rejected[PDN_SETUP], total.rejected[PDN_ILLEGAL], total.rejected[PDN_VARIANT], total.rejected[PDN_TOO_LONG]);
+  printf("%u threads %.0f%% busy, writer waited %.2f s for batches\n", options.threads,
+         (elapsed > 0) ? 100.0 * total.busy / (elapsed * options.threads) : 0.0, waiting);
+  return true;
+}
+
+/**
+ * Entry point, imports a PDN file into a game archive
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @return int: 0 if the archive was written, 1 if not
+ */
+int main(int argc, char *argv[]) {
+  PdnImportOptions options;
+  if (!PdnImport_ParseOptions(argc, argv, options)) {
+    fprintf(stderr, "usage: %s -i <pdn> -o <archive> [-j threads] [-b batch KB] [-c chunk games] [-e]\n", argv[0]);
+    return 2;
+  }
+  return PdnImport_Run(options) ? 0 : 1;
+}
+
+/**
+ * Reads the command line options
+ *
+ * @param argc: The number of arguments
+ * @param argv: The arguments
+ * @param options: The options read
+ * @return bool: If the options were valid
+ */
+bool PdnImport_ParseOptions(int argc, char *argv[], PdnImportOptions &options) {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  options.input_path = 0;
+  options.output_path = 0;
+  options.threads = (cores > 0) ? (unsigned int)cores : 1;
+  options.batch_bytes = PDN_IMPORT_BATCH_KB * 1024UL;
+  options.chunk_games = ARCHIVE_CHUNK_GAMES;
+  options.all_errors = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "i:o:j:b:c:e")) != -1) {
+    switch (option) {
+      case 'i':
+        options.input_path = optarg;
+        break;
+      case 'o':
+        options.output_path = optarg;
+        break;
+      case 'j':
+        options.threads = strtoul(optarg, 0, 10);
+        break;
+      case 'b':
+        options.batch_bytes = strtoul(optarg, 0, 10) * 1024UL;
+        break;
+      case 'c':
+        options.chunk_games = strtoul(optarg, 0, 10);
+        break;
+      case 'e':
+        options.all_errors = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  return options.input_path != 0 && options.output_path != 0 && options.threads > 0 && options.threads <= PDN_IMPORT_MAX_THREADS &&
+         options.batch_bytes > 0 && options.chunk_games > 0;
+}
@@ -0,0 +1,236 @@
+/************************************************************
+ * @file Rules.cpp
+ * @brief The implementation for the host helpers shared by the game tools: listing legal moves, hashing positions, random games and move text
+ *
+ * @note The legal moves are found by trying each diagonal step and jump on a copy of the game, the same as the Simulator,
+ *       so they always agree with Checkers_Turn. Only the steps to an empty square in a direction the piece can go are
+ *       tried, which skips most copies. Their order is fixed (by square, then by step), which the archive relies on
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <ctype.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define RULES_HASH_PLAYER (0x100) /* The key number for player 2 being the active player, after the 32 squares' pieces */
+#define RULES_HASH_WON    (0x101) /* The key number for the game being won */
+#define RULES_HASH_JUMP   (0x200) /* The key numbers for the square a jump has to carry on from start here */
+
+/**********************************
+ ** Global Variables
+ **********************************/
+/* The diagonal steps a piece can take, then the jumps, in the order they are tried */
+const int rules_steps[8][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}, {-2, -2}, {-2, 2}, {2, -2}, {2, 2}};
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Finds every legal move of the active player, in a fixed order
+ *
+ * @param game: The game
+ * @param moves: The legal moves found
+ * @return int: The number of legal moves (0 once the game is won)
+ */
+int Rules_GetLegalMoves(Checkers &game, Move (&moves)[RULES_MAX_MOVES]) {
+  int player = game.Checkers_GetActivePlayer();
+  int move_count = 0;
+
+  if (game.Checkers_GetWin() != 0) {
+    return 0;
+  }
+
+  for (int row = 0; row < MOVE_BOARD_SIZE; row++) {
+    /* Only the dark squares hold pieces */
+    for (int col = row % 2; col < MOVE_BOARD_SIZE; col += 2) {
+      /* Player 1's pieces are 1 and 3, player 2's are 2 and 4 */
+      int piece = game.Checkers_GetBoardAt(row, col);
+      if (piece == 0 || (piece - 1) % 2 != player - 1) {
+        continue;
+      }
+
+      for (int i = 0; i < 8 && move_count < RULES_MAX_MOVES; i++) {
+        Square to = Move_MakeSquare(row + rules_steps[i][0], col + rules_steps[i][1]);
+        if (to == SQUARE_NONE || game.Checkers_GetBoardAt(Move_GetRow(to), Move_GetCol(to)) != 0) {
+          continue;
+        }
+
+        /* Men only move forwards (up the rows for player 1), and a jump has to have one of the other player's pieces to take */
+        if (piece <= 2 && (rules_steps[i][0] < 0) != (player == 1)) {
+          continue;
+        }
+        if (i >= 4) {
+          int taken = game.Checkers_GetBoardAt(row + rules_steps[i][0] / 2, col + rules_steps[i][1] / 2);
+          if (taken == 0 || (taken - 1) % 2 == player - 1) {
+            continue;
+          }
+        }
+
+        Checkers trial = game;
+        Move move = Move_Make(Move_MakeSquare(row, col), to);
+        if (trial.Checkers_Turn(move) == 1) {
+          moves[move_count++] = move;
+        }
+      }
+    }
+  }
+
+  return move_count;
+}
+
+/**
+ * Finds a move in a list of moves
+ *
+ * @param moves: The moves
+ * @param move_count: The number of moves
+ * @param move: The move to find
+ * @return int: The index of the move, or -1 if it is not in the list
+ */
+int Rules_FindMove(const Move *moves, int move_count, Move move) {
+  for (int i = 0; i < move_count; i++) {
+    if (moves[i].from == move.from && moves[i].to == move.to) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Retrieves the result of a game
+ *
+ * @param game: The game
+ * @return int: The winning player, or RULES_RESULT_NONE if the game is still being played
+ */
+int Rules_GetResult(Checkers &game) {
+  /* Once a game is won the active player is the winner */
+  return (game.Checkers_GetWin() != 0) ? game.Checkers_GetActivePlayer() : RULES_RESULT_NONE;
+}
+
+/**
+ * Works out a hash of a position: its pieces, the active player, the square a jump has to carry on from and if it is won
+ *
+ * @param game: The game
+ * @return uint64_t: The hash, the same for the same position however it was reached
+ * @note Each piece on each square adds its own random key, as Zobrist hashing does, but the keys are made by mixing
+ *       their number instead of being kept in a table
+ */
+uint64_t Rules_Hash(Checkers &game) {
+  CheckersSnapshot snapshot;
+  uint64_t hash = 0;
+
+  game.Checkers_Save(snapshot);
+  for (int i = 0; i < CHECKERS_SNAPSHOT_SQUARES; i++) {
+    int piece = (snapshot.squares[i / 2] >> ((i % 2) * 4)) & 0x0F;
+    if (piece != 0) {
+      hash ^= Rules_Mix(i * 8 + piece);
+    }
+  }
+  if (snapshot.active_player == 2) {
+    hash ^= Rules_Mix(RULES_HASH_PLAYER);
+  }
+  if (snapshot.won != 0) {
+    hash ^= Rules_Mix(RULES_HASH_WON);
+  }
+  if (snapshot.jump != SQUARE_NONE) {
+    hash ^= Rules_Mix(RULES_HASH_JUMP + snapshot.jump);
+  }
+  return hash;
+}
+
+/**
+ * Advances a xorshift random number generator, so seeded games are the same from run to run
+ *
+ * @param state: The state of the generator (not 0)
+ * @return uint32_t: The next random number
+ */
+uint32_t Rules_Random(uint32_t &state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/**
+ * Mixes the bits of a number, so numbers that differ by one bit give unrelated results (the splitmix64 finalizer)
+ *
+ * @param value: The number
+ * @return uint64_t: The mixed number
+ */
+uint64_t Rules_Mix(uint64_t value) {
+  value += 0x9E3779B97F4A7C15ULL;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+/**
+ * Plays random legal moves until the game is won or runs out of plies, which counts as a draw
+ *
+ * @param game: The game to play on, usually a new one
+ * @param state: The state of the random number generator
+ * @param plies: The moves played, one per Checkers_Turn call
+ * @param max_plies: The most moves to play
+ * @param result: The winning player, or RULES_RESULT_DRAW
+ * @return int: The number of moves played
+ */
+int Rules_PlayRandomGame(Checkers &game, uint32_t &state, Move *plies, int max_plies, int &result) {
+  Move moves[RULES_MAX_MOVES];
+  int ply_count = 0;
+
+  while (ply_count < max_plies) {
+    int move_count = Rules_GetLegalMoves(game, moves);
+    if (move_count == 0) {
+      break;
+    }
+    plies[ply_count] = moves[Rules_Random(state) % move_count];
+    game.Checkers_Turn(plies[ply_count]);
+    ply_count++;
+  }
+
+  result = Rules_GetResult(game);
+  if (result == RULES_RESULT_NONE) {
+    result = RULES_RESULT_DRAW;
+  }
+  return ply_count;
+}
+
+/**
+ * Writes a move as text, such as "A1 B2" (row 0 is A, column 0 is 1)
+ *
+ * @param move: The move
+ * @param text: The text written
+ */
+void Rules_FormatMove(Move move, char (&text)[RULES_MOVE_TEXT]) {
+  text[0] = 'A' + Move_GetRow(move.from);
+  text[1] = '1' + Move_GetCol(move.from);
+  text[2] = ' ';
+  text[3] = 'A' + Move_GetRow(move.to);
+  text[4] = '1' + Move_GetCol(move.to);
+  text[5] = '\0';
+}
+
+/**
+ * Reads a move from text, such as "A1 B2" or "a1 b2", which may be followed by white space
+ *
+ * @param text: The text
+ * @param move: The move read
+ * @return bool: If the text was a move between two squares on the board
+ */
+bool Rules_ParseMove(const char *text, Move &move) {
+  if (text[0] == '\0' || text[1] == '\0' || text[2] != ' ' || text[3] == '\0' || text[4] == '\0' ||
+      (text[5] != '\0' && !isspace((unsigned char)text[5]))) {
+    return false;
+  }
+
+  move.from = Move_MakeSquare(toupper(text[0]) - 'A', text[1] - '1');
+  move.to = Move_MakeSquare(toupper(text[3]) - 'A', text[4] - '1');
+  return move.from != SQUARE_NONE && move.to != SQUARE_NONE;
+}
@@ -0,0 +1,47 @@
+/************************************************************
+ * @file Rules.h
+ * @brief The header for the host helpers shared by the game tools: listing legal moves, hashing positions, random games and move text
+ ************************************************************/
+#ifndef RULES_H
+#define RULES_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdint.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define RULES_MAX_MOVES     (96)  /* The most legal moves a position can have (12 pieces with 8 targets each) */
+#define RULES_MOVE_TEXT     (6)   /* The bytes in a move's text, "A1 B2" and its terminator */
+#define RULES_RESULT_NONE   (0)   /* The result of a game that was not finished */
+#define RULES_RESULT_DRAW   (3)   /* The result of a drawn game, 1 and 2 are wins for that player */
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Move functions */
+int  Rules_GetLegalMoves(Checkers &game, Move (&moves)[RULES_MAX_MOVES]);
+int  Rules_FindMove(const Move *moves, int move_count, Move move);
+int  Rules_GetResult(Checkers &game);
+
+/* Position functions */
+uint64_t Rules_Hash(Checkers &game);
+
+/* Random game functions */
+uint32_t Rules_Random(uint32_t &state);
+uint64_t Rules_Mix(uint64_t value);
+int      Rules_PlayRandomGame(Checkers &game, uint32_t &state, Move *plies, int max_plies, int &result);
+
+/* Move text functions, the same "A1 B2" syntax as the voice commands */
+void Rules_FormatMove(Move move, char (&text)[RULES_MOVE_TEXT]);
+bool Rules_ParseMove(const char *text, Move &move);
+
+#endif /* RULES_H */
@@ -0,0 +1,218 @@
+/************************************************************
+ * @file Samples.cpp
+ * @brief The implementation for training sample shards, the positions self-play picks out with their search scores and results
+ *
+ * @note Each game's records go to the file in one write as soon as the game ends, so memory holds one game per shard
+ *       being written and nothing else. The file is only synced once it is closed: a shard cut off by a crash loses
+ *       at most the games since, which are played again the same way when it is opened again.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Samples.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+bool Samples_ReadAt(int descriptor, uint64_t record, SampleRecord &sample);
+bool Samples_WriteAll(int descriptor, const void *bytes, size_t size);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Reads a record of a shard by its number
+ *
+ * @param descriptor: The shard file
+ * @param record: The record's number
+ * @param sample: The record read
+ * @return bool: If it was read
+ */
+bool Samples_ReadAt(int descriptor, uint64_t record, SampleRecord &sample) {
+  off_t offset = SAMPLES_HEADER_SIZE + record * sizeof(SampleRecord);
+  return pread(descriptor, &sample, sizeof(sample), offset) == (ssize_t)sizeof(sample);
+}
+
+/**
+ * Writes bytes to the end of a file, however many calls it takes
+ *
+ * @param descriptor: The file
+ * @param bytes: The bytes
+ * @param size: The number of bytes
+ * @return bool: If every byte was written
+ */
+bool Samples_WriteAll(int descriptor, const void *bytes, size_t size) {
+  const uint8_t *next = (const uint8_t *)bytes;
+  while (size > 0) {
+    ssize_t written = write(descriptor, next, size);
+    if (written <= 0) {
+      return false;
+    }
+    next += written;
+    size -= written;
+  }
+  return true;
+}
+
+/**
+ * Opens a shard to add games to, making it if it does not exist and cutting it back to its last whole game if it does
+ *
+ * @param writer: The shard
+ * @param path: The path of the shard
+ * @param settings: The header it has to have (magic, version and record size are filled in)
+ * @return bool: If it was opened, not if it was made with other settings or is not a shard
+ */
+bool Samples_Create(SamplesWriter &writer, const char *path, const SamplesHeader &settings) {
+  struct stat file;
+  memset(&writer, 0, sizeof(writer));
+  writer.header = settings;
+  writer.header.magic = SAMPLES_MAGIC;
+  writer.header.version = SAMPLES_VERSION;
+  writer.header.record_size = sizeof(SampleRecord);
+  writer.next_game = settings.shard;
+
+  writer.descriptor = open(path, O_RDWR | O_CREAT, 0644);
+  if (writer.descriptor < 0 || fstat(writer.descriptor, &file) != 0) {
+    Samples_Close(writer);
+    return false;
+  }
+
+  /* A file too short to have its header was cut off as it was made, so it is made again */
+  if (file.st_size < SAMPLES_HEADER_SIZE) {
+    uint8_t header[SAMPLES_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, &writer.header, sizeof(writer.header));
+    if (ftruncate(writer.descriptor, 0) != 0 || !Samples_WriteAll(writer.descriptor, header, sizeof(header))) {
+      Samples_Close(writer);
+      return false;
+    }
+    return true;
+  }
+
+  SamplesHeader header;
+  if (pread(writer.descriptor, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+      memcmp(&header, &writer.header, sizeof(header)) != 0) {
+    Samples_Close(writer);
+    return false;
+  }
+
+  /* Drops a record cut off part way, then the records of a game cut off part way, found by its last record not being flagged */
+  SampleRecord last;
+  uint64_t record_count = (file.st_size - SAMPLES_HEADER_SIZE) / sizeof(SampleRecord);
+  uint64_t kept = record_count;
+  if (kept > 0 && Samples_ReadAt(writer.descriptor, kept - 1, last) && (last.flags & SAMPLES_FLAG_LAST) == 0) {
+    uint32_t game = last.game;
+    while (kept > 0 && Samples_ReadAt(writer.descriptor, kept - 1, last) && last.game == game) {
+      kept--;
+    }
+  }
+  if (kept > 0 && !Samples_ReadAt(writer.descriptor, kept - 1, last)) {
+    Samples_Close(writer);
+    return false;
+  }
+  if (kept > 0) {
+    writer.next_game = last.game + settings.shard_count;
+  }
+
+  off_t size = SAMPLES_HEADER_SIZE + kept * sizeof(SampleRecord);
+  if ((size != file.st_size && ftruncate(writer.descriptor, size) != 0) || lseek(writer.descriptor, size, SEEK_SET) != size) {
+    Samples_Close(writer);
+    return false;
+  }
+  writer.record_count = kept;
+  writer.dropped = record_count - kept;
+  return true;
+}
+
+/**
+ * Adds a game's samples to a shard
+ *
+ * @param writer: The shard
+ * @param game: The number of the game, the shard's next game
+ * @param records: The samples, their game and flags are filled in (there may be none)
+ * @return bool: If they were written
+ */
+bool Samples_WriteGame(SamplesWriter &writer, uint32_t game, std::vector<SampleRecord> &records) {
+  for (size_t i = 0; i < records.size(); i++) {
+    records[i].game = game;
+    records[i].flags = (i + 1 == records.size()) ? SAMPLES_FLAG_LAST : 0;
+  }
+  if (!records.empty() && !Samples_WriteAll(writer.descriptor, &records[0], records.size() * sizeof(SampleRecord))) {
+    return false;
+  }
+  writer.record_count += records.size();
+  writer.next_game = game + writer.header.shard_count;
+  return true;
+}
+
+/**
+ * Syncs a shard to disk and closes it
+ *
+ * @param writer: The shard
+ * @return bool: If it was synced
+ */
+bool Samples_Close(SamplesWriter &writer) {
+  bool synced = false;
+  if (writer.descriptor >= 0) {
+    synced = fsync(writer.descriptor) == 0;
+    synced = close(writer.descriptor) == 0 && synced;
+  }
+  writer.descriptor = -1;
+  return synced;
+}
+
+/**
+ * Opens a shard to read its records
+ *
+ * @param reader: The shard
+ * @param path: The path of the shard
+ * @return bool: If it was opened and is a shard
+ */
+bool Samples_Open(SamplesReader &reader, const char *path) {
+  reader.file = fopen(path, "rb");
+  if (reader.file == NULL) {
+    return false;
+  }
+
+  struct stat file;
+  if (fread(&reader.header, sizeof(reader.header), 1, reader.file) != 1 || reader.header.magic != SAMPLES_MAGIC ||
+      reader.header.version != SAMPLES_VERSION || reader.header.record_size != sizeof(SampleRecord) ||
+      fstat(fileno(reader.file), &file) != 0 || fseek(reader.file, SAMPLES_HEADER_SIZE, SEEK_SET) != 0) {
+    Samples_CloseReader(reader);
+    return false;
+  }
+  reader.record_count = (file.st_size - SAMPLES_HEADER_SIZE) / sizeof(SampleRecord);
+  return true;
+}
+
+/**
+ * Reads the next record of a shard
+ *
+ * @param reader: The shard
+ * @param record: The record read
+ * @return bool: If there was one
+ */
+bool Samples_ReadRecord(SamplesReader &reader, SampleRecord &record) {
+  return fread(&record, sizeof(record), 1, reader.file) == 1;
+}
+
+/**
+ * Closes a shard that was read
+ *
+ * @param reader: The shard
+ */
+void Samples_CloseReader(SamplesReader &reader) {
+  if (reader.file != NULL) {
+    fclose(reader.file);
+  }
+  reader.file = NULL;
+}
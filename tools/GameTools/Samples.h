@@ -0,0 +1,94 @@
+/************************************************************
+ * @file Samples.h
+ * @brief The header for training sample shards, the positions self-play picks out with their search scores and results
+ *
+ * @note A shard is a header, then fixed size records, one per position sampled, written a whole game at a time. A
+ *       shard holds the games whose number is its own number plus a multiple of the number of shards, in order, so
+ *       its contents only depend on the settings in its header and not on the threads that wrote it. The last record
+ *       of each game is flagged, so a shard cut off part way through a game (or a record) is cut back to the last
+ *       whole game when it is opened again, and carries on from the next one. The numbers are little-endian, the same
+ *       as every host it runs on.
+ ************************************************************/
+#ifndef SAMPLES_H
+#define SAMPLES_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define SAMPLES_MAGIC       (0x50534B43UL) /* "CKSP" at the start of the file */
+#define SAMPLES_VERSION     (1)            /* The version of the format written */
+#define SAMPLES_HEADER_SIZE (64)           /* The bytes before the first record */
+#define SAMPLES_FLAG_LAST   (0x01)         /* The record is the last one of its game */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The start of the file, everything that decides the games in the shard */
+struct SamplesHeader {
+  uint32_t magic;        /* SAMPLES_MAGIC */
+  uint16_t version;      /* SAMPLES_VERSION */
+  uint16_t record_size;  /* The bytes in a record */
+  uint64_t seed;         /* The seed every game's random numbers are made from */
+  uint32_t shard;        /* The shard's number */
+  uint32_t shard_count;  /* The number of shards the games are dealt between */
+  uint16_t depth;        /* The depth each position is searched to */
+  uint16_t random_plies; /* The random moves each game starts with, which are not sampled */
+  uint16_t sample_rate;  /* One in this many of the positions searched is sampled */
+  uint16_t max_plies;    /* The most moves in a game, it is a draw once they are played */
+};
+
+/* A position sampled from a game, 32 bytes */
+struct SampleRecord {
+  CheckersSnapshot position;  /* The position */
+  int16_t          score;     /* The search score for the active player, in hundredths of a man */
+  Square           best_from; /* The square the best move is from */
+  Square           best_to;   /* The square the best move is to */
+  uint16_t         ply;       /* The moves played before the position */
+  uint8_t          result;    /* The winning player or RULES_RESULT_DRAW */
+  uint8_t          flags;     /* SAMPLES_FLAG_LAST */
+  uint32_t         game;      /* The number of the game, unique across the shards */
+};
+
+/* A shard being written, one game at a time */
+struct SamplesWriter {
+  int           descriptor;   /* The shard file */
+  SamplesHeader header;       /* The header */
+  uint64_t      record_count; /* The records in the shard */
+  uint64_t      dropped;      /* The records of a game cut off part way that were dropped when it was opened */
+  uint32_t      next_game;    /* The number of the next game the shard holds */
+};
+
+/* A shard being read, one record at a time */
+struct SamplesReader {
+  FILE         *file;         /* The shard file */
+  SamplesHeader header;       /* The header */
+  uint64_t      record_count; /* The whole records in the shard */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+/* Writing functions */
+bool Samples_Create(SamplesWriter &writer, const char *path, const SamplesHeader &settings);
+bool Samples_WriteGame(SamplesWriter &writer, uint32_t game, std::vector<SampleRecord> &records);
+bool Samples_Close(SamplesWriter &writer);
+
+/* Reading functions */
+bool Samples_Open(SamplesReader &reader, const char *path);
+bool Samples_ReadRecord(SamplesReader &reader, SampleRecord &record);
+void Samples_CloseReader(SamplesReader &reader);
+
+#endif /* SAMPLES_H */
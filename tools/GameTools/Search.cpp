@@ -0,0 +1,247 @@
+/************************************************************
+ * @file Search.cpp
+ * @brief The implementation for the host search, an alpha-beta search of the best move that keeps its results in an analysis cache
+ *
+ * @note The search deepens one step at a time from the depth the cache already has for the position, so a position
+ *       analysed before, by this process or an earlier one, costs only the steps past what was kept. Every position
+ *       searched with depth left is looked up in the cache and stored back to it, so positions shared with other
+ *       games or other threads are only searched once
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Search.h"
+#include "Rules.h"
+
+/**********************************
+ ** Defines
+ **********************************/
+#define SEARCH_MAN_SCORE     (100) /* The score of a man */
+#define SEARCH_KING_SCORE    (150) /* The score of a king */
+#define SEARCH_ADVANCE_SCORE (2)   /* The score of each row a man has moved towards being crowned */
+#define SEARCH_WIN_BOUND     (SEARCH_WIN - SEARCH_MAX_PLY) /* Scores above this are wins, and below its negative losses */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The state of one search */
+struct SearchContext {
+  CacheFile          *cache;       /* The cache, 0 to search without one */
+  const Network      *network;     /* The learned evaluation, 0 to score by the pieces */
+  NetworkAccumulator  accumulator; /* The network's accumulators for the position being searched */
+  uint64_t            nodes;       /* The positions searched */
+};
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+int Search_ToCache(int score, int ply);
+int Search_FromCache(int score, int ply);
+int Search_Node(SearchContext &context, Checkers &game, int depth, int ply, int alpha, int beta, Move &best);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Scores a position by its pieces, from the active player's side
+ *
+ * @param game: The game
+ * @return int: The score, more for the active player being ahead
+ */
+int Search_Evaluate(Checkers &game) {
+  int score = 0;
+  for (int row = 0; row < MOVE_BOARD_SIZE; row++) {
+    for (int col = row % 2; col < MOVE_BOARD_SIZE; col += 2) {
+      /* Player 1's pieces are 1 and 3 and are crowned on row 0, player 2's are 2 and 4 and are crowned on the last row */
+      int piece = game.Checkers_GetBoardAt(row, col);
+      if (piece == 0) {
+        continue;
+      }
+      int value = (piece >= 3) ? SEARCH_KING_SCORE
+                  : SEARCH_MAN_SCORE + SEARCH_ADVANCE_SCORE * ((piece == 1) ? MOVE_BOARD_SIZE - 1 - row : row);
+      score += ((piece - 1) % 2 == 0) ? value : -value;
+    }
+  }
+  return (game.Checkers_GetActivePlayer() == 1) ? score : -score;
+}
+
+/**
+ * Makes a win or loss score relative to the position it is stored for, instead of the position searched
+ *
+ * @param score: The score
+ * @param ply: The moves from the position searched
+ * @return int: The score to store
+ */
+int Search_ToCache(int score, int ply) {
+  return (score > SEARCH_WIN_BOUND) ? score + ply : (score < -SEARCH_WIN_BOUND) ? score - ply : score;
+}
+
+/**
+ * Makes a win or loss score read from the cache relative to the position searched
+ *
+ * @param score: The score read
+ * @param ply: The moves from the position searched
+ * @return int: The score
+ */
+int Search_FromCache(int score, int ply) {
+  return (score > SEARCH_WIN_BOUND) ? score - ply : (score < -SEARCH_WIN_BOUND) ? score + ply : score;
+}
+
+/**
+ * Searches a position
+ *
+ * @param context: The state of the search
+ * @param game: The position
+ * @param depth: The moves by each player left to search
+ * @param ply: The moves from the position searched
+ * @param alpha: The score the active player is already sure of
+ * @param beta: The score the other player is already sure of
+ * @param best: The best move found, SQUARE_NONE to SQUARE_NONE if there is none
+ * @return int: The score, only exact between alpha and beta
+ */
+int Search_Node(SearchContext &context, Checkers &game, int depth, int ply, int alpha, int beta, Move &best) {
+  Move moves[RULES_MAX_MOVES];
+  uint64_t hash = 0;
+  uint64_t start_nodes = context.nodes;
+  int start_alpha = alpha;
+
+  context.nodes++;
+  best.from = SQUARE_NONE;
+  best.to = SQUARE_NONE;
+
+  /* Once a game is won the active player is the winner, and a player left without a move has lost */
+  if (game.Checkers_GetWin() != 0) {
+    return SEARCH_WIN - ply;
+  }
+  int move_count = Rules_GetLegalMoves(game, moves);
+  if (move_count == 0) {
+    return -(SEARCH_WIN - ply);
+  }
+  if (depth <= 0 || ply >= SEARCH_MAX_PLY) {
+    if (context.network != 0) {
+      return Network_Evaluate(*context.network, context.accumulator, game.Checkers_GetActivePlayer());
+    }
+    return Search_Evaluate(game);
+  }
+
+  /* A result at least as deep settles the position or narrows the window, and its best move is tried first either way */
+  if (context.cache != 0) {
+    CacheEntry entry;
+    hash = Rules_Hash(game);
+    if (Cache_Probe(*context.cache, hash, entry)) {
+      int score = Search_FromCache(entry.score, ply);
+      if (entry.depth >= depth && ply > 0) {
+        if (entry.bound == CACHE_BOUND_EXACT || (entry.bound == CACHE_BOUND_LOWER && score >= beta) ||
+            (entry.bound == CACHE_BOUND_UPPER && score <= alpha)) {
+          best = entry.best;
+          return score;
+        }
+      }
+      int index = Rules_FindMove(moves, move_count, entry.best);
+      if (index > 0) {
+        Move first = moves[index];
+        moves[index] = moves[0];
+        moves[0] = first;
+      }
+    }
+  }
+
+  int best_score = -SEARCH_WIN - 1;
+  for (int i = 0; i < move_count; i++) {
+    Checkers child = game;
+    NetworkChange change;
+    Move reply;
+    int score;
+    child.Checkers_Turn(moves[i]);
+    if (context.network != 0) {
+      Network_Make(*context.network, context.accumulator, game, child, moves[i], change);
+    }
+
+    /* A jump that has to carry on, or a win, leaves the same player to move, and does not use up the depth */
+    if (child.Checkers_GetActivePlayer() == game.Checkers_GetActivePlayer()) {
+      score = Search_Node(context, child, depth, ply + 1, alpha, beta, reply);
+    }
+    else {
+      score = -Search_Node(context, child, depth - 1, ply + 1, -beta, -alpha, reply);
+    }
+    if (context.network != 0) {
+      Network_Unmake(*context.network, context.accumulator, change);
+    }
+
+    if (score > best_score) {
+      best_score = score;
+      best = moves[i];
+    }
+    if (score > alpha) {
+      alpha = score;
+    }
+    if (alpha >= beta) {
+      break;
+    }
+  }
+
+  if (context.cache != 0) {
+    CacheEntry entry;
+    entry.best = best;
+    entry.score = Search_ToCache(best_score, ply);
+    entry.depth = depth;
+    entry.bound = (best_score <= start_alpha) ? CACHE_BOUND_UPPER : (best_score >= beta) ? CACHE_BOUND_LOWER : CACHE_BOUND_EXACT;
+    entry.nodes = context.nodes - start_nodes;
+    Cache_Store(*context.cache, hash, entry);
+  }
+  return best_score;
+}
+
+/**
+ * Analyses a position to a depth, starting from what the cache already has for it
+ *
+ * @param game: The position
+ * @param depth: The moves by each player to search, 1 to SEARCH_MAX_DEPTH
+ * @param cache: The cache shared with other searches, 0 to search without one
+ * @param network: The learned evaluation, 0 to score positions by their pieces
+ * @param result: The result
+ * @return bool: If the depth was valid
+ * @note A cached result as deep as asked for is returned as it is, without searching
+ */
+bool Search_Analyse(Checkers &game, int depth, CacheFile *cache, const Network *network, SearchResult &result) {
+  SearchContext context;
+  int start_depth = 1;
+
+  if (depth < 1 || depth > SEARCH_MAX_DEPTH) {
+    return false;
+  }
+  context.cache = cache;
+  context.network = network;
+  context.nodes = 0;
+  if (network != 0) {
+    Network_Refresh(*network, game, context.accumulator);
+  }
+  result.best.from = SQUARE_NONE;
+  result.best.to = SQUARE_NONE;
+  result.score = 0;
+  result.depth = 0;
+  result.cached_depth = 0;
+
+  CacheEntry entry;
+  if (cache != 0 && Cache_Probe(*cache, Rules_Hash(game), entry) && entry.bound == CACHE_BOUND_EXACT) {
+    result.best = entry.best;
+    result.score = entry.score;
+    result.depth = entry.depth;
+    result.cached_depth = entry.depth;
+    start_depth = entry.depth + 1;
+  }
+
+  for (int step = start_depth; step <= depth; step++) {
+    result.score = Search_Node(context, game, step, 0, -SEARCH_WIN - 1, SEARCH_WIN + 1, result.best);
+    result.depth = step;
+
+    /* A game that is over scores the same at any depth */
+    if (result.best.from == SQUARE_NONE) {
+      result.depth = depth;
+      break;
+    }
+  }
+  result.nodes = context.nodes;
+  return true;
+}
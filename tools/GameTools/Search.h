@@ -0,0 +1,52 @@
+/************************************************************
+ * @file Search.h
+ * @brief The header for the host search, an alpha-beta search of the best move that keeps its results in an analysis cache
+ *
+ * @note Scores are for the active player, in hundredths of a man. A won position scores SEARCH_WIN less the moves it
+ *       took to win, so the quickest win scores highest. Each move of a multi-jump is its own Checkers_Turn call, only
+ *       a move that passes the turn to the other player counts towards the depth. A search can score positions with
+ *       a learned network instead of by their pieces, and then its cache should only be shared with searches using the
+ *       same network
+ ************************************************************/
+#ifndef SEARCH_H
+#define SEARCH_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Cache.h"
+#include "Checkers.h"
+#include "Move.h"
+#include "Network.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <stdint.h>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define SEARCH_WIN       (30000) /* The score of winning now */
+#define SEARCH_MAX_DEPTH (64)    /* The deepest search asked for */
+#define SEARCH_MAX_PLY   (256)   /* The most moves from the position searched, wins within them score above SEARCH_WIN less this */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+/* The result of analysing a position */
+struct SearchResult {
+  Move     best;         /* The best move, SQUARE_NONE to SQUARE_NONE if there is none */
+  int      score;        /* The score for the active player */
+  int      depth;        /* The depth the result is from, at least the depth asked for */
+  int      cached_depth; /* The depth the cache already had for the position, 0 if it had none */
+  uint64_t nodes;        /* The positions searched this time */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+int  Search_Evaluate(Checkers &game);
+bool Search_Analyse(Checkers &game, int depth, CacheFile *cache, const Network *network, SearchResult &result);
+
+#endif /* SEARCH_H */
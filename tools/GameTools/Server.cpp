@@ -0,0 +1,589 @@
+/************************************************************
+ * @file Server.cpp
+ * @brief The implementation for the game server, which hosts many games at once for boards and virtual players on a socket
+ *
+ * @note Every game is a slot of one slab, allocated once when the server starts and linked into a free list, so
+ *       starting a game takes no allocation and the games sit next to each other in memory. Each connection has a
+ *       thread reading its commands, which starts games itself and hands moves and ends to the worker its game's slot
+ *       maps to. A game always maps to the same worker, so its commands are played in the order they were sent
+ *       without a lock per game. The reader hands over every command in what it read at once, and a worker replies
+ *       to everything it took from its queue with one write per connection.
+ ************************************************************/
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Server.h"
+#include "Rules.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**********************************
+ ** Private Function Prototypes
+ **********************************/
+void Server_Write(ServerConnection &connection, const std::string &text);
+void Server_Release(ServerConnection *connection, int references);
+bool Server_StartGame(Server &server, ServerConnection *connection, uint32_t &id);
+void Server_EndGame(Server &server, ServerSession &session);
+void Server_Play(Server &server, ServerTask &task, std::string &reply, ServerQueue &queue);
+void Server_Worker(Server *server, ServerQueue *queue);
+void Server_ReadLine(Server &server, ServerConnection *connection, char *line, std::vector<std::vector<ServerTask> > &tasks,
+                     std::string &reply);
+void Server_Dispatch(Server &server, ServerConnection *connection, std::vector<std::vector<ServerTask> > &tasks);
+void Server_Reader(Server *server, ServerConnection *connection);
+void Server_JoinReaders(Server &server);
+void Server_Acceptor(Server *server);
+
+/**********************************
+ ** Function Definitions
+ **********************************/
+/**
+ * Writes replies to a connection, the whole text or nothing once the client has gone
+ *
+ * @param connection: The connection
+ * @param text: The replies
+ */
+void Server_Write(ServerConnection &connection, const std::string &text) {
+  std::lock_guard<std::mutex> hold(connection.write_lock);
+  size_t written = 0;
+  while (written < text.size()) {
+    ssize_t sent = send(connection.socket, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return;
+    }
+    written += (size_t)sent;
+  }
+}
+
+/**
+ * Drops references to a connection, closing and freeing it with the last one
+ *
+ * @param connection: The connection
+ * @param references: The references dropped
+ */
+void Server_Release(ServerConnection *connection, int references) {
+  if (__atomic_sub_fetch(&connection->references, references, __ATOMIC_ACQ_REL) == 0) {
+    close(connection->socket);
+    delete connection;
+  }
+}
+
+/**
+ * Starts a game in a free slot of the slab
+ *
+ * @param server: The server
+ * @param connection: The connection playing it
+ * @param id: The game's id
+ * @return bool: If there was a free slot
+ */
+bool Server_StartGame(Server &server, ServerConnection *connection, uint32_t &id) {
+  std::lock_guard<std::mutex> hold(server.slab_lock);
+  if (server.free_head == SERVER_NO_SESSION) {
+    return false;
+  }
+
+  uint32_t index = server.free_head;
+  ServerSession &session = server.sessions[index];
+  server.free_head = session.next_free;
+  session.game = Checkers();
+  session.owner = connection;
+  id = (session.generation << SERVER_INDEX_BITS) | index;
+
+  server.games++;
+  server.in_use++;
+  server.peak = (server.in_use > server.peak) ? server.in_use : server.peak;
+  return true;
+}
+
+/**
+ * Ends a game, putting its slot back on the free list
+ *
+ * @param server: The server
+ * @param session: The game
+ */
+void Server_EndGame(Server &server, ServerSession &session) {
+  std::lock_guard<std::mutex> hold(server.slab_lock);
+  session.owner = 0;
+  session.generation = (session.generation + 1) & ((1UL << (32 - SERVER_INDEX_BITS)) - 1);
+  session.next_free = (uint32_t)(&session - &server.sessions[0]);
+  std::swap(session.next_free, server.free_head);
+  server.in_use--;
+}
+
+/**
+ * Plays a move or ends a game, on the worker its slot maps to
+ *
+ * @param server: The server
+ * @param task: The command
+ * @param reply: The replies to the command's connection, added to
+ * @param queue: The worker's queue, which counts what it did
+ */
+void Server_Play(Server &server, ServerTask &task, std::string &reply, ServerQueue &queue) {
+  char text[SERVER_LINE_SIZE];
+  uint32_t index = task.id & (SERVER_MAX_SESSIONS - 1);
+  ServerSession &session = server.sessions[(index < server.sessions.size()) ? index : 0];
+
+  /* The slot may have been ended and started again since, for this or another connection */
+  if (index >= server.sessions.size() || session.owner != task.connection || session.generation != task.id >> SERVER_INDEX_BITS) {
+    snprintf(text, sizeof(text), "ERR %lu SESSION\n", (unsigned long)task.id);
+    __atomic_add_fetch(&queue.errors, 1, __ATOMIC_RELAXED);
+  }
+  else if (task.move.from == SQUARE_NONE) {
+    Server_EndGame(server, session);
+    snprintf(text, sizeof(text), "END %lu\n", (unsigned long)task.id);
+  }
+  else if (session.game.Checkers_Turn(task.move) == 1) {
+    snprintf(text, sizeof(text), "OK %lu %d %d\n", (unsigned long)task.id, session.game.Checkers_GetActivePlayer(),
+             (session.game.Checkers_GetWin() != 0) ? 1 : 0);
+    __atomic_add_fetch(&queue.moves, 1, __ATOMIC_RELAXED);
+  }
+  else {
+    snprintf(text, sizeof(text), "ERR %lu ILLEGAL\n", (unsigned long)task.id);
+    __atomic_add_fetch(&queue.illegal, 1, __ATOMIC_RELAXED);
+  }
+  reply += text;
+}
+
+/**
+ * Plays the commands queued for a worker until the server stops
+ *
+ * @param server: The server
+ * @param queue: The worker's queue
+ */
+void Server_Worker(Server *server, ServerQueue *queue) {
+  std::vector<ServerTask> tasks;
+  std::vector<ServerConnection *> connections;
+  std::vector<std::string> replies;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> hold(queue->lock);
+      queue->ready.wait(hold, [&] { return !queue->tasks.empty() || queue->stopping; });
+      if (queue->tasks.empty()) {
+        return;
+      }
+      tasks.swap(queue->tasks);
+    }
+
+    /* The replies are gathered per connection, there are usually only a few in what was taken */
+    connections.clear();
+    for (size_t i = 0; i < tasks.size(); i++) {
+      size_t j = 0;
+      while (j < connections.size() && connections[j] != tasks[i].connection) {
+        j++;
+      }
+      if (j == connections.size()) {
+        connections.push_back(tasks[i].connection);
+        if (replies.size() < connections.size()) {
+          replies.resize(connections.size());
+        }
+        replies[j].clear();
+      }
+      Server_Play(*server, tasks[i], replies[j], *queue);
+    }
+
+    for (size_t j = 0; j < connections.size(); j++) {
+      int references = 0;
+      for (size_t i = 0; i < tasks.size(); i++) {
+        references += (tasks[i].connection == connections[j]) ? 1 : 0;
+      }
+      Server_Write(*connections[j], replies[j]);
+      Server_Release(connections[j], references);
+    }
+    tasks.clear();
+  }
+}
+
+/**
+ * Reads a command, starting a game itself or queueing the command for the worker its game maps to
+ *
+ * @param server: The server
+ * @param connection: The connection it came from
+ * @param line: The command, without its line end
+ * @param tasks: The commands for each worker, added to
+ * @param reply: The replies to the connection from this thread, added to
+ */
+void Server_ReadLine(Server &server, ServerConnection *connection, char *line, std::vector<std::vector<ServerTask> > &tasks,
+                     std::string &reply) {
+  char text[SERVER_LINE_SIZE];
+  size_t length = strlen(line);
+  while (length > 0 && (line[length - 1] == '\r' || line[length - 1] == ' ')) {
+    line[--length] = '\0';
+  }
+  if (length == 0) {
+    return;
+  }
+
+  if (strcmp(line, "NEW") == 0) {
+    uint32_t id;
+    if (Server_StartGame(server, connection, id)) {
+      connection->sessions.insert(id);
+      snprintf(text, sizeof(text), "NEW %lu\n", (unsigned long)id);
+    }
+    else {
+      snprintf(text, sizeof(text), "ERR - FULL\n");
+    }
+    reply += text;
+    return;
+  }
+
+  /* Every other command starts with the game's id */
+  char *rest;
+  unsigned long id = strtoul(line, &rest, 10);
+  ServerTask task;
+  task.connection = connection;
+  task.id = (uint32_t)id;
+  bool valid = rest != line && *rest == ' ' && id <= 0xFFFFFFFFUL;
+  if (valid && strcmp(rest + 1, "END") == 0) {
+    task.move = Move_Make(SQUARE_NONE, SQUARE_NONE);
+    connection->sessions.erase(task.id);
+  }
+  else {
+    valid = valid && Rules_ParseMove(rest + 1, task.move);
+  }
+
+  if (!valid) {
+    reply += "ERR - SYNTAX\n";
+    __atomic_add_fetch(&server.syntax_errors, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  tasks[task.id % tasks.size()].push_back(task);
+}
+
+/**
+ * Hands the commands read to their workers, each worker's at once
+ *
+ * @param server: The server
+ * @param connection: The connection they came from
+ * @param tasks: The commands for each worker, emptied
+ */
+void Server_Dispatch(Server &server, ServerConnection *connection, std::vector<std::vector<ServerTask> > &tasks) {
+  for (size_t i = 0; i < tasks.size(); i++) {
+    if (tasks[i].empty()) {
+      continue;
+    }
+    __atomic_add_fetch(&connection->references, (int)tasks[i].size(), __ATOMIC_RELAXED);
+
+    ServerQueue &queue = *server.queues[i];
+    bool was_empty;
+    {
+      std::lock_guard<std::mutex> hold(queue.lock);
+      was_empty = queue.tasks.empty();
+      queue.tasks.insert(queue.tasks.end(), tasks[i].begin(), tasks[i].end());
+    }
+    if (was_empty) {
+      queue.ready.notify_one();
+    }
+    tasks[i].clear();
+  }
+}
+
+/**
+ * Reads a connection's commands until it closes, then ends its games
+ *
+ * @param server: The server
+ * @param connection: The connection
+ */
+void Server_Reader(Server *server, ServerConnection *connection) {
+  std::vector<char> buffer(SERVER_READ_SIZE + 1);
+  std::vector<std::vector<ServerTask> > tasks(server->queues.size());
+  std::string reply;
+  size_t kept = 0;
+
+  while (true) {
+    ssize_t count = recv(connection->socket, &buffer[kept], SERVER_READ_SIZE - kept, 0);
+    if (count <= 0) {
+      break;
+    }
+    count += kept;
+
+    /* Every whole line is a command, a part of a line is kept for the next read */
+    char *line = &buffer[0];
+    char *end = line + count;
+    char *next;
+    while ((next = (char *)memchr(line, '\n', end - line)) != 0) {
+      *next = '\0';
+      Server_ReadLine(*server, connection, line, tasks, reply);
+      line = next + 1;
+    }
+    kept = end - line;
+    if (kept >= SERVER_LINE_SIZE) {
+      reply += "ERR - SYNTAX\n";
+      __atomic_add_fetch(&server->syntax_errors, 1, __ATOMIC_RELAXED);
+      kept = 0;
+    }
+    memmove(&buffer[0], line, kept);
+
+    Server_Dispatch(*server, connection, tasks);
+    if (!reply.empty()) {
+      Server_Write(*connection, reply);
+      reply.clear();
+    }
+  }
+
+  /* The games still being played end with the connection, after the commands already queued for them */
+  for (std::unordered_set<uint32_t>::iterator i = connection->sessions.begin(); i != connection->sessions.end(); i++) {
+    ServerTask task;
+    task.connection = connection;
+    task.id = *i;
+    task.move = Move_Make(SQUARE_NONE, SQUARE_NONE);
+    tasks[task.id % tasks.size()].push_back(task);
+  }
+  connection->sessions.clear();
+  Server_Dispatch(*server, connection, tasks);
+
+  {
+    std::lock_guard<std::mutex> hold(server->readers_lock);
+    for (size_t i = 0; i < server->readers.size(); i++) {
+      if (server->readers[i] == connection) {
+        server->readers[i] = server->readers.back();
+        server->readers.pop_back();
+        break;
+      }
+    }
+    Server_Release(connection, 1);
+
+    /* Notified with the lock held, as the server can be gone as soon as Server_Stop sees the last reader go */
+    server->readers_ended.push_back(std::this_thread::get_id());
+    server->readers_done.notify_all();
+  }
+}
+
+/**
+ * Joins the reader threads that have stopped reading, so a long running server does not keep every thread it started
+ *
+ * @param server: The server
+ */
+void Server_JoinReaders(Server &server) {
+  std::vector<std::thread> ended;
+  {
+    std::lock_guard<std::mutex> hold(server.readers_lock);
+    for (size_t i = 0; i < server.readers_ended.size(); i++) {
+      for (size_t j = 0; j < server.read_threads.size(); j++) {
+        if (server.read_threads[j].get_id() == server.readers_ended[i]) {
+          ended.push_back(std::move(server.read_threads[j]));
+          server.read_threads[j] = std::move(server.read_threads.back());
+          server.read_threads.pop_back();
+          break;
+        }
+      }
+    }
+    server.readers_ended.clear();
+  }
+  for (size_t i = 0; i < ended.size(); i++) {
+    ended[i].join();
+  }
+}
+
+/**
+ * Accepts connections until the server stops, starting a reader for each
+ *
+ * @param server: The server
+ */
+void Server_Acceptor(Server *server) {
+  while (true) {
+    int socket = accept(server->listener, 0, 0);
+    if (socket < 0) {
+      if (server->stopping) {
+        return;
+      }
+
+      /* Out of files or memory, accept fails again straight away until a connection closes, so it waits a while */
+      if (errno != EINTR && errno != ECONNABORTED) {
+        fprintf(stderr, "could not accept a connection: %s\n", strerror(errno));
+        usleep(SERVER_ACCEPT_PAUSE);
+      }
+      continue;
+    }
+    Server_JoinReaders(*server);
+    int enable = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    ServerConnection *connection = new ServerConnection;
+    connection->socket = socket;
+    connection->references = 1;
+
+    std::lock_guard<std::mutex> hold(server->readers_lock);
+    if (server->stopping) {
+      close(socket);
+      delete connection;
+      return;
+    }
+    server->readers.push_back(connection);
+    server->connections++;
+    server->read_threads.push_back(std::thread(Server_Reader, server, connection));
+  }
+}
+
+/**
+ * Starts a server listening on a Unix socket or a local TCP port
+ *
+ * @param server: The server
+ * @param unix_path: The path of the Unix socket, replaced if it exists (0 to listen on the port)
+ * @param port: The TCP port on the loopback address, if there is no Unix socket
+ * @param workers: The threads playing moves
+ * @param max_sessions: The most games hosted at once, the slab is this big from the start
+ * @return bool: If the server is listening
+ */
+bool Server_Start(Server &server, const char *unix_path, int port, unsigned int workers, unsigned long max_sessions) {
+  if (workers == 0 || workers > SERVER_MAX_WORKERS || max_sessions == 0 || max_sessions > SERVER_MAX_SESSIONS) {
+    return false;
+  }
+
+  if (unix_path != 0) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(unix_path) >= sizeof(address.sun_path)) {
+      return false;
+    }
+    strcpy(address.sun_path, unix_path);
+    unlink(unix_path);
+    server.listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server.listener < 0 || bind(server.listener, (struct sockaddr *)&address, sizeof(address)) != 0) {
+      if (server.listener >= 0) {
+        close(server.listener);
+      }
+      return false;
+    }
+  }
+  else {
+    struct sockaddr_in address;
+    int enable = 1;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    server.listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (server.listener < 0 || setsockopt(server.listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0 ||
+        bind(server.listener, (struct sockaddr *)&address, sizeof(address)) != 0) {
+      if (server.listener >= 0) {
+        close(server.listener);
+      }
+      return false;
+    }
+  }
+  if (listen(server.listener, SOMAXCONN) != 0) {
+    close(server.listener);
+    return false;
+  }
+
+  /* The slab, every slot free and linked in order */
+  server.sessions.assign(max_sessions, ServerSession());
+  for (unsigned long i = 0; i < max_sessions; i++) {
+    server.sessions[i].owner = 0;
+    server.sessions[i].generation = 0;
+    server.sessions[i].next_free = (i + 1 < max_sessions) ? (uint32_t)(i + 1) : SERVER_NO_SESSION;
+  }
+  server.free_head = 0;
+  server.games = 0;
+  server.in_use = 0;
+  server.peak = 0;
+  server.connections = 0;
+  server.syntax_errors = 0;
+  server.moves = 0;
+  server.illegal = 0;
+  server.errors = 0;
+  server.stopping = false;
+  server.readers.clear();
+  server.read_threads.clear();
+  server.readers_ended.clear();
+
+  server.queues.clear();
+  for (unsigned int i = 0; i < workers; i++) {
+    ServerQueue *queue = new ServerQueue;
+    queue->moves = 0;
+    queue->illegal = 0;
+    queue->errors = 0;
+    queue->stopping = false;
+    server.queues.push_back(queue);
+    queue->thread = std::thread(Server_Worker, &server, queue);
+  }
+  server.acceptor = std::thread(Server_Acceptor, &server);
+  return true;
+}
+
+/**
+ * Stops a server, closing every connection once the commands already read have been played
+ *
+ * @param server: The server
+ */
+void Server_Stop(Server &server) {
+  /* Stops accepting, then stops reading each connection and waits for the readers to hand over what they read */
+  {
+    std::lock_guard<std::mutex> hold(server.readers_lock);
+    server.stopping = true;
+    shutdown(server.listener, SHUT_RDWR);
+    for (size_t i = 0; i < server.readers.size(); i++) {
+      shutdown(server.readers[i]->socket, SHUT_RD);
+    }
+  }
+  server.acceptor.join();
+  close(server.listener);
+  std::vector<std::thread> read_threads;
+  {
+    std::unique_lock<std::mutex> hold(server.readers_lock);
+    server.readers_done.wait(hold, [&] { return server.readers.empty(); });
+    read_threads.swap(server.read_threads);
+    server.readers_ended.clear();
+  }
+  for (size_t i = 0; i < read_threads.size(); i++) {
+    read_threads[i].join();
+  }
+
+  /* The workers play what is left in their queues before they stop, and what they did is kept once they are gone */
+  for (size_t i = 0; i < server.queues.size(); i++) {
+    {
+      std::lock_guard<std::mutex> hold(server.queues[i]->lock);
+      server.queues[i]->stopping = true;
+    }
+    server.queues[i]->ready.notify_all();
+  }
+  for (size_t i = 0; i < server.queues.size(); i++) {
+    server.queues[i]->thread.join();
+    server.moves += server.queues[i]->moves;
+    server.illegal += server.queues[i]->illegal;
+    server.errors += server.queues[i]->errors;
+    delete server.queues[i];
+  }
+  server.queues.clear();
+}
+
+/**
+ * Retrieves what a server has done
+ *
+ * @param server: The server
+ * @param stats: What it has done
+ */
+void Server_GetStats(Server &server, ServerStats &stats) {
+  stats.moves = server.moves;
+  stats.illegal = server.illegal;
+  stats.errors = server.errors;
+  for (size_t i = 0; i < server.queues.size(); i++) {
+    stats.moves += __atomic_load_n(&server.queues[i]->moves, __ATOMIC_RELAXED);
+    stats.illegal += __atomic_load_n(&server.queues[i]->illegal, __ATOMIC_RELAXED);
+    stats.errors += __atomic_load_n(&server.queues[i]->errors, __ATOMIC_RELAXED);
+  }
+  stats.errors += __atomic_load_n(&server.syntax_errors, __ATOMIC_RELAXED);
+  {
+    std::lock_guard<std::mutex> hold(server.readers_lock);
+    stats.connections = server.connections;
+  }
+  std::lock_guard<std::mutex> hold(server.slab_lock);
+  stats.games = server.games;
+  stats.sessions = server.in_use;
+  stats.peak_sessions = server.peak;
+}
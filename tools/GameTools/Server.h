@@ -0,0 +1,127 @@
+/************************************************************
+ * @file Server.h
+ * @brief The header for the game server, which hosts many games at once for boards and virtual players on a socket
+ *
+ * @note The protocol is a line of text per command, and a line of text per reply:
+ *         NEW               starts a game, replied to with NEW <id>
+ *         <id> A1 B2        plays a move in the same "A1 B2" syntax as the voice commands, replied to with
+ *                           OK <id> <active player> <won>, or ERR <id> ILLEGAL
+ *         <id> END          ends a game, replied to with END <id>
+ *       Anything else is replied to with ERR <id> SESSION (a game this connection does not have) or ERR - SYNTAX. A
+ *       connection can send many commands without waiting, replies to one game come in the order its commands were
+ *       sent, but the replies to different games can come in any order. A connection's games end with it.
+ ************************************************************/
+#ifndef SERVER_H
+#define SERVER_H
+
+/**********************************
+ ** Library Includes
+ **********************************/
+#include "Checkers.h"
+#include "Move.h"
+
+/**********************************
+ ** Third Party Libraries Includes
+ **********************************/
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**********************************
+ ** Defines
+ **********************************/
+#define SERVER_INDEX_BITS   (20)                       /* The bits of a game's id that pick its slot, the rest count its reuses */
+#define SERVER_MAX_SESSIONS (1UL << SERVER_INDEX_BITS) /* The most games hosted at once */
+#define SERVER_MAX_WORKERS  (256)                      /* The most threads playing moves */
+#define SERVER_READ_SIZE    (65536)                    /* The bytes read from a connection at a time */
+#define SERVER_LINE_SIZE    (64)                       /* The longest command, longer lines are replied to with ERR - SYNTAX */
+#define SERVER_ACCEPT_PAUSE (100000)                   /* The time the acceptor waits after accept fails, such as out of files (us) */
+#define SERVER_NO_SESSION   (0xFFFFFFFFUL)             /* The end of the free list */
+
+/**********************************
+ ** Type Definitions
+ **********************************/
+struct ServerConnection;
+
+/* A game, one slot of the slab every game is kept in */
+struct ServerSession {
+  Checkers          game;       /* The game */
+  ServerConnection *owner;      /* The connection playing it, 0 if the slot is free */
+  uint32_t          generation; /* The times the slot has been used, the top bits of the game's id */
+  uint32_t          next_free;  /* The next free slot, while the slot is free */
+};
+
+/* A command for a worker */
+struct ServerTask {
+  ServerConnection *connection; /* The connection it came from */
+  uint32_t          id;         /* The game */
+  Move              move;       /* The move, SQUARE_NONE to SQUARE_NONE to end the game */
+};
+
+/* A worker's commands, every command for a game goes to the same worker so they are played in order */
+struct ServerQueue {
+  std::mutex              lock;     /* Guards the tasks */
+  std::condition_variable ready;    /* Signalled when tasks are added */
+  std::vector<ServerTask> tasks;    /* The commands waiting */
+  std::thread             thread;   /* The worker */
+  uint64_t                moves;    /* The moves played */
+  uint64_t                illegal;  /* The moves that were not legal */
+  uint64_t                errors;   /* The commands for a game the connection did not have */
+  bool                    stopping; /* Indicator for if the worker stops once its queue is empty */
+};
+
+/* A client connected to the server */
+struct ServerConnection {
+  int                          socket;     /* The connection's socket */
+  std::mutex                   write_lock; /* Guards writes to the socket, so replies are not mixed up */
+  int                          references; /* The reader and the tasks queued, the connection is freed when it reaches 0 */
+  std::unordered_set<uint32_t> sessions;   /* The games started and not ended, only used by the reader */
+};
+
+/* What the server has done */
+struct ServerStats {
+  uint64_t connections;   /* The connections accepted */
+  uint64_t games;         /* The games started */
+  uint64_t sessions;      /* The games being played */
+  uint64_t peak_sessions; /* The most games played at once */
+  uint64_t moves;         /* The moves played */
+  uint64_t illegal;       /* The moves that were not legal */
+  uint64_t errors;        /* The commands that could not be read or were for a game the connection did not have */
+};
+
+/* A running server */
+struct Server {
+  int                             listener;      /* The listening socket */
+  std::vector<ServerSession>      sessions;      /* The slab of games */
+  std::mutex                      slab_lock;     /* Guards the free list and the counts of games */
+  uint32_t                        free_head;     /* The first free slot */
+  uint64_t                        games;         /* The games started */
+  uint64_t                        in_use;        /* The games being played */
+  uint64_t                        peak;          /* The most games played at once */
+  std::vector<ServerQueue *>      queues;        /* The workers */
+  std::thread                     acceptor;      /* The thread accepting connections */
+  std::mutex                      readers_lock;  /* Guards the connections being read and their threads */
+  std::condition_variable         readers_done;  /* Signalled when a connection stops being read */
+  std::vector<ServerConnection *> readers;       /* The connections being read */
+  std::vector<std::thread>        read_threads;  /* The threads reading them, and the ones that stopped and are not joined yet */
+  std::vector<std::thread::id>    readers_ended; /* The threads that stopped reading since they were last joined */
+  uint64_t                        connections;   /* The connections accepted */
+  uint64_t                        syntax_errors; /* The lines that could not be read */
+  uint64_t                        moves;         /* The moves played by the workers, once they have stopped */
+  uint64_t                        illegal;       /* The moves that were not legal, once the workers have stopped */
+  uint64_t                        errors;        /* The commands for a game the connection did not have, once the workers have stopped */
+  std::atomic<bool>               stopping;      /* Indicator for if the server is stopping */
+};
+
+/**********************************
+ ** Function Prototypes
+ **********************************/
+bool Server_Start(Server &server, const char *unix_path, int port, unsigned int workers, unsigned long max_sessions);
+void Server_Stop(Server &server);
+void Server_GetStats(Server &server, ServerStats &stats);
+
+#endif /* SERVER_H */
@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+@file ProfileReport.py
+@brief Prints p50, p99 and max per loop stage and per input source, the memory each stage holds and the heap's trend,
+       and the time spent idle and asleep, from the PROFILE, LATENCY, MEMORY, HEAP and POWER lines the firmware dumps over Serial
+
+Send 'p' (loop stages), 'l' (input to LED latency), 'm' (memory) or 'd' (duty cycle) over the Serial monitor, save the output, then run
+    python3 tools/ProfileReport.py capture.txt
+or pipe a capture in on stdin. Only the last dump of each stage is used, as the histograms count from power on.
+The firmware only keeps its latest latency traces, so send 'l' every few moves, every trace in the capture is used once.
+The heap is sampled every 30 minutes, so send 'm' once at the end of a long run to see whether memory stayed flat.
+"""
+
+import math
+import sys
+
+# The number of histogram buckets in a PROFILE line, the same as PROFILER_BUCKET_COUNT
+BUCKET_COUNT = 16
+
+# The number of fields in a LATENCY line: LATENCY,<id>,<source>,<valid>,<queued us>,<turn us>,<done us>
+LATENCY_FIELD_COUNT = 7
+
+# The number of fields in a MEMORY line: MEMORY,<stage>,<runs>,<low free heap>,<low largest block>,<low free stack>,<held bytes>
+MEMORY_FIELD_COUNT = 7
+
+# The number of fields in a HEAP line: HEAP,<minutes>,<free heap>,<largest block>,<fragmentation %>,<min free heap>
+HEAP_FIELD_COUNT = 6
+
+# The number of fields in a POWER line:
+# POWER,<active|idle>,<idle entries>,<active ms>,<idle ms>,<asleep ms>,<sleeps>,<pin wakes>,<idle duty cycle in tenths of a percent>
+POWER_FIELD_COUNT = 9
+
+
+def bucket_upper_bound(bucket):
+    """
+    Retrieves the longest sample a bucket can hold
+
+    @param bucket: The bucket index
+    @return int: The bound in us, or None for the last bucket which has no bound
+    """
+    if bucket == BUCKET_COUNT - 1:
+        return None
+    return (1 << bucket) - 1
+
+
+def percentile(buckets, maximum, fraction):
+    """
+    Finds the bucket holding a percentile, reported as the bucket's upper bound so it never reads low
+
+    @param buckets: The number of samples in each bucket
+    @param maximum: The longest sample in us, which caps the result
+    @param fraction: The percentile as a fraction, such as 0.99
+    @return int: The percentile in us
+    """
+    target = fraction * sum(buckets)
+    seen = 0
+    for bucket, count in enumerate(buckets):
+        seen += count
+        if count > 0 and seen >= target:
+            bound = bucket_upper_bound(bucket)
+            return maximum if bound is None else min(bound, maximum)
+    return maximum
+
+
+def sample_percentile(samples, fraction):
+    """
+    Finds a percentile of a list of samples, using the nearest sample at or above it
+
+    @param samples: The sorted samples
+    @param fraction: The percentile as a fraction, such as 0.99
+    @return int: The percentile
+    """
+    return samples[max(0, math.ceil(len(samples) * fraction) - 1)]
+
+
+def heap_drift(samples):
+    """
+    Fits a line through the free heap of the trend samples
+
+    @param samples: The (minutes, free heap, largest block, fragmentation, min free heap) samples, oldest first
+    @return float: The change in free heap in bytes per hour, 0 with fewer than two samples
+    """
+    if len(samples) < 2:
+        return 0.0
+    times = [sample[0] for sample in samples]
+    heaps = [sample[1] for sample in samples]
+    time_mean = sum(times) / len(times)
+    heap_mean = sum(heaps) / len(heaps)
+    spread = sum((time - time_mean) ** 2 for time in times)
+    if spread == 0:
+        return 0.0
+    slope = sum((time - time_mean) * (heap - heap_mean) for time, heap in zip(times, heaps)) / spread
+    return slope * 60
+
+
+def read_dumps(lines):
+    """
+    Keeps the last PROFILE and MEMORY line of each stage, every distinct LATENCY and HEAP line and the last POWER line,
+    skipping anything else the firmware printed
+
+    @param lines: The captured Serial output
+    @return tuple: The stage name mapped to (count, max, buckets), in the order the stages first appeared,
+                   the input source mapped to its list of input to LED latencies in us,
+                   the stage name mapped to (runs, low free heap, low largest block, low free stack, held bytes),
+                   the heap trend samples, oldest first,
+                   and (state, idle entries, active ms, idle ms, asleep ms, sleeps, pin wakes) or None without a POWER line
+    """
+    stages = {}
+    traces = {}
+    memory = {}
+    heap = {}
+    power = None
+    for line in lines:
+        fields = line.strip().split(",")
+        try:
+            if len(fields) == 4 + BUCKET_COUNT and fields[0] == "PROFILE":
+                values = [int(field) for field in fields[2:]]
+                stages[fields[1]] = (values[0], values[1], values[2:])
+            elif len(fields) == LATENCY_FIELD_COUNT and fields[0] == "LATENCY":
+                # A trace shows up in every dump until it is overwritten, so it is keyed by its ID
+                traces[int(fields[1])] = (fields[2], int(fields[6]))
+            elif len(fields) == MEMORY_FIELD_COUNT and fields[0] == "MEMORY":
+                memory[fields[1]] = tuple(int(field) for field in fields[2:])
+            elif len(fields) == HEAP_FIELD_COUNT and fields[0] == "HEAP":
+                # A sample shows up in every dump until it is overwritten, so it is keyed by its time
+                values = tuple(int(field) for field in fields[1:])
+                heap[values[0]] = values
+            elif len(fields) == POWER_FIELD_COUNT and fields[0] == "POWER":
+                # The duty cycle is recomputed from the times, so only the counts are kept
+                power = (fields[1],) + tuple(int(field) for field in fields[2:8])
+        except ValueError:
+            continue
+
+    latencies = {}
+    for source, done in traces.values():
+        latencies.setdefault(source, []).append(done)
+    return stages, latencies, memory, [heap[minutes] for minutes in sorted(heap)], power
+
+
+def main(argv):
+    if len(argv) > 2:
+        print("usage: %s [capture]" % argv[0], file=sys.stderr)
+        return 2
+
+    if len(argv) == 2:
+        with open(argv[1], errors="replace") as capture:
+            stages, latencies, memory, heap, power = read_dumps(capture)
+    else:
+        stages, latencies, memory, heap, power = read_dumps(sys.stdin)
+
+    reports = []
+    if stages:
+        reports.append(lambda: print_stages(stages))
+    if latencies:
+        reports.append(lambda: print_latencies(latencies))
+    if memory:
+        reports.append(lambda: print_memory(memory))
+    if heap:
+        reports.append(lambda: print_heap(heap))
+    if power:
+        reports.append(lambda: print_power(power))
+    if not reports:
+        print("no PROFILE, LATENCY, MEMORY, HEAP or POWER lines found", file=sys.stderr)
+        return 1
+
+    for index, report in enumerate(reports):
+        if index > 0:
+            print()
+        report()
+    return 0
+
+
+def print_stages(stages):
+    """
+    Prints the percentiles of each loop stage
+
+    @param stages: The stage name mapped to (count, max, buckets)
+    """
+    print("%-10s %10s %10s %10s %10s" % ("stage", "samples", "p50 us", "p99 us", "max us"))
+    for name, (count, maximum, buckets) in stages.items():
+        if count == 0:
+            print("%-10s %10d %10s %10s %10s" % (name, 0, "-", "-", "-"))
+            continue
+        print("%-10s %10d %10d %10d %10d" % (name, count, percentile(buckets, maximum, 0.50),
+                                              percentile(buckets, maximum, 0.99), maximum))
+
+
+def print_latencies(latencies):
+    """
+    Prints the percentiles of the input to LED latency of each input source
+
+    @param latencies: The input source mapped to its list of latencies in us
+    """
+    print("%-10s %10s %10s %10s %10s" % ("input", "moves", "p50 us", "p99 us", "max us"))
+    for source in sorted(latencies):
+        samples = sorted(latencies[source])
+        print("%-10s %10d %10d %10d %10d" % (source, len(samples), sample_percentile(samples, 0.50),
+                                              sample_percentile(samples, 0.99), samples[-1]))
+
+
+
+def print_memory(memory):
+    """
+    Prints the heap and stack readings of each loop stage
+
+    @param memory: The stage name mapped to (runs, low free heap, low largest block, low free stack, held bytes)
+    """
+    print("%-10s %10s %10s %10s %10s %10s" % ("stage", "runs", "low heap", "low block", "low stack", "held"))
+    for name, (runs, low_heap, low_block, low_stack, held) in memory.items():
+        print("%-10s %10d %10d %10d %10d %10d" % (name, runs, low_heap, low_block, low_stack, held))
+
+
+def print_heap(samples):
+    """
+    Prints the heap's trend, from the first sample to the last, and how fast the free heap is drifting
+
+    @param samples: The (minutes, free heap, largest block, fragmentation, min free heap) samples, oldest first
+    """
+    first, last = samples[0], samples[-1]
+    print("heap over %.1f hours (%d samples)" % ((last[0] - first[0]) / 60, len(samples)))
+    print("%-10s %10s %10s %10s" % ("", "first", "last", "worst"))
+    print("%-10s %10d %10d %10d" % ("free", first[1], last[1], min(sample[4] for sample in samples)))
+    print("%-10s %10d %10d %10d" % ("block", first[2], last[2], min(sample[2] for sample in samples)))
+    print("%-10s %9d%% %9d%% %9d%%" % ("frag", first[3], last[3], max(sample[3] for sample in samples)))
+    print("drift %+.1f bytes/hour" % heap_drift(samples))
+
+
+def print_power(power):
+    """
+    Prints how the time since power on splits between playing, idling awake and sleeping
+
+    @param power: (state, idle entries, active ms, idle ms, asleep ms, sleeps, pin wakes)
+    """
+    state, entries, active, idle, asleep, sleeps, pin_wakes = power
+    total = max(active + idle, 1)
+    print("power %s, idle %d times, %d sleeps (%d woken by a button)" % (state, entries, sleeps, pin_wakes))
+    print("%-10s %10s %10s" % ("", "ms", "share"))
+    print("%-10s %10d %9.1f%%" % ("active", active, 100.0 * active / total))
+    print("%-10s %10d %9.1f%%" % ("idle awake", idle - asleep, 100.0 * (idle - asleep) / total))
+    print("%-10s %10d %9.1f%%" % ("asleep", asleep, 100.0 * asleep / total))
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))